@@ -0,0 +1,51 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+// Input vertex attributes (binding 0, per vertex) - same as simple.vert
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inNormal;
+layout(location = 2) in vec2 inTexCoord;
+layout(location = 3) in vec4 inColor;
+layout(location = 4) in vec3 inTangent;
+
+// Instance attributes (binding 1, per instance) - matches InstanceData
+layout(location = 5) in vec4 inInstanceRow0; // Rows of the affine instance matrix, translation in w
+layout(location = 6) in vec4 inInstanceRow1;
+layout(location = 7) in vec4 inInstanceRow2;
+layout(location = 8) in vec4 inInstanceColor;
+
+// Descriptor Set 0: Frame Data (Bound once per frame)
+layout(set = 0, binding = 0) uniform CameraMatrices {
+    mat4 view;
+    mat4 proj;
+} cameraData;
+
+// Push Constants: Per-Batch Data
+layout(push_constant) uniform PushConstants {
+    mat4 model; // Batch-to-World matrix (owning GameObject's transform)
+} pushConsts;
+
+// Output to fragment shader (same interface as simple.vert, so simple.frag is reused)
+layout(location = 0) out vec4 fragColor;
+layout(location = 1) out vec2 fragTexCoord;
+layout(location = 2) out vec3 fragNormalWorld;
+layout(location = 3) out vec3 fragPosWorld;
+layout(location = 4) out vec3 fragTangentWorld; // Read by normal-mapped material variants
+
+void main() {
+    // Rows -> column-major mat4
+    mat4 instanceMatrix = transpose(mat4(inInstanceRow0, inInstanceRow1, inInstanceRow2, vec4(0.0, 0.0, 0.0, 1.0)));
+    mat4 model = pushConsts.model * instanceMatrix;
+
+    vec4 worldPos = model * vec4(inPosition, 1.0);
+    fragPosWorld = worldPos.xyz;
+
+    gl_Position = cameraData.proj * cameraData.view * worldPos;
+
+    // Approximation for normal matrix (works for uniform scale/rotation)
+    fragNormalWorld = normalize(mat3(model) * inNormal);
+
+    fragColor = inColor * inInstanceColor;
+    fragTexCoord = inTexCoord;
+    fragTangentWorld = mat3(model) * inTangent;
+}
@@ -0,0 +1,34 @@
+#version 450
+
+// Resolves the weighted blended OIT targets over the opaque scene color (last subpass of the scene pass).
+// MULTISAMPLED is defined with MSAA: the targets then hold SAMPLE_COUNT samples, averaged here, and
+// the composite is blended into every covered sample of the scene color.
+#ifdef MULTISAMPLED
+layout(constant_id = 0) const int SAMPLE_COUNT = 4;
+layout(input_attachment_index = 0, set = 0, binding = 0) uniform subpassInputMS accumInput;
+layout(input_attachment_index = 1, set = 0, binding = 1) uniform subpassInputMS revealageInput;
+#else
+layout(input_attachment_index = 0, set = 0, binding = 0) uniform subpassInput accumInput;     // Weighted premultiplied color (rgb), weighted coverage (a)
+layout(input_attachment_index = 1, set = 0, binding = 1) uniform subpassInput revealageInput; // Product of (1 - alpha)
+#endif
+
+layout(location = 0) out vec4 outColor; // Blended SRC_ALPHA / ONE_MINUS_SRC_ALPHA
+
+void main() {
+#ifdef MULTISAMPLED
+    vec4 accum = vec4(0.0);
+    float revealage = 0.0;
+    for (int i = 0; i < SAMPLE_COUNT; ++i) {
+        accum += subpassLoad(accumInput, i);
+        revealage += subpassLoad(revealageInput, i).r;
+    }
+    accum /= float(SAMPLE_COUNT);
+    revealage /= float(SAMPLE_COUNT);
+#else
+    float revealage = subpassLoad(revealageInput).r;
+    vec4 accum = subpassLoad(accumInput);
+#endif
+    if (revealage >= 1.0) discard; // No transparent layer here
+
+    outColor = vec4(accum.rgb / max(accum.a, 1e-5), 1.0 - revealage);
+}
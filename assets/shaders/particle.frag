@@ -0,0 +1,14 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+layout(location = 0) in vec4 fragColor;
+layout(location = 1) in vec2 fragCorner;
+
+layout(location = 0) out vec4 outColor;
+
+void main() {
+    // Soft round sprite
+    float radiusSquared = dot(fragCorner, fragCorner);
+    if (radiusSquared > 1.0) discard;
+    outColor = vec4(fragColor.rgb, fragColor.a * (1.0 - radiusSquared));
+}
@@ -0,0 +1,60 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+// Camera-facing quads for the alive particles, drawn indirectly: six vertices per instance,
+// one instance per entry of the (sorted) alive list.
+
+struct Particle {
+    vec3 position;
+    float age;
+    vec3 velocity;
+    float lifetime;
+};
+
+// Descriptor Set 0: Frame Data (same set as the mesh pipelines)
+layout(set = 0, binding = 0) uniform CameraMatrices {
+    mat4 view;
+    mat4 proj;
+} cameraData;
+
+// Descriptor Set 1: The emitter's particle pool and the list simulated this frame
+layout(std430, set = 1, binding = 0) readonly buffer Particles { Particle particles[]; };
+layout(std430, set = 1, binding = 3) readonly buffer DrawList { uint count; uint pad; uvec2 entries[]; } drawList;
+
+// Matches ParticleEmitParams
+layout(push_constant) uniform EmitParams {
+    vec4 positionRadius;
+    vec4 velocitySpread;
+    vec4 gravityDrag;
+    vec4 lifeSize;
+    vec4 colorStart;
+    vec4 colorEnd;
+    uint emitCount;
+    uint randomSeed;
+    uint flags;
+    float restitution;
+    float deltaTime;
+    uint capacity;
+} params;
+
+layout(location = 0) out vec4 fragColor;
+layout(location = 1) out vec2 fragCorner; // -1..1 across the quad
+
+const vec2 corners[6] = vec2[](
+    vec2(-1.0, -1.0), vec2(1.0, -1.0), vec2(1.0, 1.0),
+    vec2(-1.0, -1.0), vec2(1.0, 1.0), vec2(-1.0, 1.0)
+);
+
+void main() {
+    Particle particle = particles[drawList.entries[gl_InstanceIndex].y];
+    float t = clamp(particle.age / particle.lifetime, 0.0, 1.0);
+    float size = mix(params.lifeSize.z, params.lifeSize.w, t);
+    vec2 corner = corners[gl_VertexIndex];
+
+    vec4 viewPos = cameraData.view * vec4(particle.position, 1.0);
+    viewPos.xy += corner * size * 0.5;
+    gl_Position = cameraData.proj * viewPos;
+
+    fragColor = mix(params.colorStart, params.colorEnd, t);
+    fragCorner = corner;
+}
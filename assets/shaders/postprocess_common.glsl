@@ -0,0 +1,15 @@
+// Shared by the post-processing passes (PostProcessStack).
+
+// Must match ExposureState in PostProcessStack.cpp. Written by postprocess_histogram.comp and
+// postprocess_exposure.comp, read by postprocess_resolve.comp.
+#define EXPOSURE_HISTOGRAM_BINS 256
+#define EXPOSURE_STATE_BLOCK                                                                    \
+    float adaptedLuminance; /* Average scene luminance, adapted over time */                   \
+    float exposure;         /* Multiplier applied to the scene color */                        \
+    uint pad0;                                                                                  \
+    uint pad1;                                                                                  \
+    uint histogram[EXPOSURE_HISTOGRAM_BINS]; /* Pixel counts by log2 luminance; bin 0 is black */
+
+float Luminance(vec3 color) {
+    return dot(color, vec3(0.2126, 0.7152, 0.0722));
+}
@@ -0,0 +1,22 @@
+#version 450
+
+// Copies the post-processed image into the swapchain image and composites the UI layer over it.
+layout(set = 0, binding = 0) uniform sampler2D sceneColor; // Same size as the swapchain
+layout(set = 0, binding = 1) uniform sampler2D uiLayer;    // Premultiplied alpha, same size
+
+// For swapchains without an sRGB format, which don't encode on write.
+layout(constant_id = 0) const bool ENCODE_SRGB = false;
+
+layout(location = 0) out vec4 outColor;
+
+void main() {
+    ivec2 texel = ivec2(gl_FragCoord.xy);
+    vec3 color = texelFetch(sceneColor, texel, 0).rgb;
+    if (ENCODE_SRGB) {
+        color = mix(color * 12.92, 1.055 * pow(color, vec3(1.0 / 2.4)) - 0.055, step(vec3(0.0031308), color));
+    }
+    // ImGui blends its alpha with (ONE, ONE_MINUS_SRC_ALPHA) into a transparent layer, leaving
+    // premultiplied color: this "over" matches drawing the UI straight onto the scene.
+    vec4 ui = texelFetch(uiLayer, texel, 0);
+    outColor = vec4(ui.rgb + color * (1.0 - ui.a), 1.0);
+}
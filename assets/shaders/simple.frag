@@ -1,53 +1,181 @@
 #version 450
 #extension GL_ARB_separate_shader_objects : enable
 
+// Material permutations: the renderer compiles a variant per combination of NORMAL_MAP,
+// METALLIC_ROUGHNESS_MAP, OCCLUSION_MAP, EMISSIVE_MAP and ALPHA_MASK (see MaterialFeature), so a
+// material without a map never samples it. OIT_WEIGHTED is added for blended materials drawn into
+// the weighted blended OIT targets instead of the scene color.
+
 // Input from vertex shader
 layout(location = 0) in vec4 fragColor;
 layout(location = 1) in vec2 fragTexCoord;
 layout(location = 2) in vec3 fragNormalWorld;
 layout(location = 3) in vec3 fragPosWorld;
+#ifdef NORMAL_MAP
+layout(location = 4) in vec3 fragTangentWorld;
+#endif
 
 // Descriptor Set 0: Frame Data (Bound once per frame)
+layout(set = 0, binding = 0) uniform CameraMatrices { // For the camera position (specular)
+    mat4 view;
+    mat4 proj;
+} cameraData;
 layout(set = 0, binding = 1) uniform LightData { // Binding 1 for Light
     vec4 direction; // Directional light direction (FROM light source to origin)
     vec4 color;     // Light color (rgb) + intensity (a)
+    vec4 ambient;   // Environment scale (rgb) + last specular mip (a)
 } lightData;
+layout(set = 0, binding = 2) uniform sampler2D brdfLut; // Split-sum scale (R) and bias (G) by (N.V, roughness)
+// Baked environment (IblBaker): cosine-weighted radiance, and radiance prefiltered per roughness along the mips.
+// Without an environment both are white and lightData.ambient is a flat ambient color.
+layout(set = 0, binding = 3) uniform samplerCube irradianceMap;
+layout(set = 0, binding = 4) uniform samplerCube specularMap;
 
-// Descriptor Set 1: Material Data (Bound per material)
+// Descriptor Set 1: Material Data (Bound per material; bindings match MaterialTextureBinding)
 layout(set = 1, binding = 0) uniform sampler2D texSampler; // Binding 0 for Diffuse Texture
+#ifdef NORMAL_MAP
+layout(set = 1, binding = 1) uniform sampler2D normalSampler;
+#endif
+#ifdef METALLIC_ROUGHNESS_MAP
+layout(set = 1, binding = 2) uniform sampler2D metallicRoughnessSampler; // glTF packing: G roughness, B metallic
+#endif
+#ifdef OCCLUSION_MAP
+layout(set = 1, binding = 3) uniform sampler2D occlusionSampler;
+#endif
+#ifdef EMISSIVE_MAP
+layout(set = 1, binding = 4) uniform sampler2D emissiveSampler;
+#endif
+
+// Must match MaterialParams in Material.h. The set binds this material's slot of the shared
+// material buffer, so the factors are one fetch with no per-draw updates.
+struct MaterialParams {
+    vec4 baseColorFactor;
+    vec4 emissiveFactor; // rgb
+    float metallicFactor;
+    float roughnessFactor;
+    float occlusionStrength;
+    float normalScale;
+};
+layout(std430, set = 1, binding = 5) readonly buffer MaterialParamsBuffer {
+    MaterialParams params;
+} material;
 
+#ifdef ALPHA_MASK
+layout(constant_id = 0) const float ALPHA_CUTOFF = 0.5; // Material::alphaCutoff
+#endif
+
+#ifdef OIT_WEIGHTED
+// Weighted blended OIT (McGuire & Bavoil): summed premultiplied color and coverage, and the product
+// of (1 - alpha), resolved by oit_composite.frag.
+layout(location = 0) out vec4 outAccum;
+layout(location = 1) out float outRevealage;
+#else
 // Output color
 layout(location = 0) out vec4 outColor;
+#endif
+
+const float PI = 3.14159265359;
+
+// GGX / Trowbridge-Reitz normal distribution (alpha = roughness^2)
+float DistributionGGX(float NdotH, float roughness) {
+    float alpha2 = roughness * roughness * roughness * roughness;
+    float denom = NdotH * NdotH * (alpha2 - 1.0) + 1.0;
+    return alpha2 / (PI * denom * denom);
+}
+
+// Smith-Schlick geometry term, k remapped for analytic lights
+float GeometrySmith(float NdotV, float NdotL, float roughness) {
+    float k = (roughness + 1.0) * (roughness + 1.0) / 8.0;
+    return (NdotV / (NdotV * (1.0 - k) + k)) * (NdotL / (NdotL * (1.0 - k) + k));
+}
+
+vec3 FresnelSchlick(float cosTheta, vec3 F0) {
+    return F0 + (1.0 - F0) * pow(1.0 - cosTheta, 5.0);
+}
+
+// Fresnel averaged over the specular lobe, for the ambient term
+vec3 FresnelSchlickRoughness(float cosTheta, vec3 F0, float roughness) {
+    return F0 + (max(vec3(1.0 - roughness), F0) - F0) * pow(1.0 - cosTheta, 5.0);
+}
 
 void main() {
+    MaterialParams params = material.params;
+
     // Surface Properties
-    vec4 albedoSample = texture(texSampler, fragTexCoord);
-    vec3 surfaceAlbedo = albedoSample.rgb * fragColor.rgb; // Modulate texture by vertex color
-    float surfaceAlpha = albedoSample.a * fragColor.a;
+    vec4 baseColor = texture(texSampler, fragTexCoord) * fragColor * params.baseColorFactor; // Modulate texture by vertex color and factor
+    vec3 surfaceAlbedo = baseColor.rgb;
+    float surfaceAlpha = baseColor.a;
+#ifdef ALPHA_MASK
+    if (surfaceAlpha < ALPHA_CUTOFF) discard;
+#endif
     vec3 N = normalize(fragNormalWorld); // Normalized surface normal
+#ifdef NORMAL_MAP
+    // Gram-Schmidt the interpolated tangent against N; meshes without tangents keep the vertex normal.
+    vec3 T = fragTangentWorld - dot(fragTangentWorld, N) * N;
+    if (dot(T, T) > 1e-8) {
+        T = normalize(T);
+        vec3 tangentNormal = texture(normalSampler, fragTexCoord).xyz * 2.0 - 1.0;
+        tangentNormal.xy *= params.normalScale;
+        N = normalize(mat3(T, cross(N, T), N) * tangentNormal);
+    }
+#endif
+
+    float metallic = params.metallicFactor;
+    float roughness = params.roughnessFactor;
+#ifdef METALLIC_ROUGHNESS_MAP
+    vec2 metallicRoughness = texture(metallicRoughnessSampler, fragTexCoord).bg;
+    metallic *= metallicRoughness.x;
+    roughness *= metallicRoughness.y;
+#endif
+    metallic = clamp(metallic, 0.0, 1.0);
+    roughness = clamp(roughness, 0.045, 1.0); // Keeps the GGX highlight from collapsing to a point
 
-    // Lighting
-    // Ambient term
-    float ambientStrength = 0.15;
-    vec3 ambient = ambientStrength * lightData.color.rgb;
+    vec3 cameraPosition = -transpose(mat3(cameraData.view)) * cameraData.view[3].xyz;
+    vec3 V = normalize(cameraPosition - fragPosWorld); // Vector TO the viewer/camera
+    float NdotV = max(dot(N, V), 1e-4);
+    vec3 F0 = mix(vec3(0.04), surfaceAlbedo, metallic); // Dielectrics reflect ~4% at normal incidence
 
-    // Diffuse term (Lambertian)
+    // Direct light: Cook-Torrance specular + Lambertian diffuse.
+    // The light color is treated as radiance premultiplied by PI, so a white Lambertian surface
+    // facing the light at intensity 1 is lit to its albedo.
     vec3 L = normalize(-lightData.direction.xyz); // Vector TO the light source
+    vec3 H = normalize(L + V);
     float NdotL = max(dot(N, L), 0.0);
-    vec3 diffuseLightColor = lightData.color.rgb * lightData.color.a; // Light color * intensity
-    vec3 diffuse = NdotL * diffuseLightColor;
+    vec3 lightRadiance = lightData.color.rgb * lightData.color.a; // Light color * intensity
+    vec3 F = FresnelSchlick(max(dot(H, V), 0.0), F0);
+    vec3 specularBrdf = DistributionGGX(max(dot(N, H), 0.0), roughness) * GeometrySmith(NdotV, NdotL, roughness) * F
+                      / (4.0 * NdotV * max(NdotL, 1e-4));
+    vec3 diffuseColor = (1.0 - F) * (1.0 - metallic) * surfaceAlbedo;
+    vec3 direct = (diffuseColor + PI * specularBrdf) * lightRadiance * NdotL;
 
-    // TODO: Add Specular term for more realistic lighting (e.g., Blinn-Phong or PBR Cook-Torrance)
-    // vec3 V = normalize(cameraData.cameraPosition_worldSpace - fragPosWorld); // Vector TO the viewer/camera
-    // vec3 R = reflect(-L, N);
-    // float spec = pow(max(dot(V, R), 0.0), material.shininess); // Example Blinn-Phong
-    // vec3 specular = material.specularColor * spec * diffuseLightColor;
+    // Ambient: image-based lighting, specular through the split-sum table
+    vec3 irradiance = texture(irradianceMap, N).rgb * lightData.ambient.rgb;
+    vec3 prefiltered = textureLod(specularMap, reflect(-V, N), roughness * lightData.ambient.a).rgb * lightData.ambient.rgb;
+    vec2 envBrdf = texture(brdfLut, vec2(NdotV, roughness)).rg;
+    vec3 ambientFresnel = FresnelSchlickRoughness(NdotV, F0, roughness);
+    vec3 ambient = (1.0 - ambientFresnel) * (1.0 - metallic) * surfaceAlbedo * irradiance + (F0 * envBrdf.x + envBrdf.y) * prefiltered;
+#ifdef OCCLUSION_MAP
+    ambient *= mix(1.0, texture(occlusionSampler, fragTexCoord).r, params.occlusionStrength);
+#endif
 
     // Combine lighting components
-    vec3 finalColor = (ambient + diffuse /* + specular */) * surfaceAlbedo;
+    vec3 finalColor = ambient + direct;
+    vec3 emissive = params.emissiveFactor.rgb;
+#ifdef EMISSIVE_MAP
+    emissive *= texture(emissiveSampler, fragTexCoord).rgb;
+#endif
+    finalColor += emissive;
 
+#ifdef OIT_WEIGHTED
+    // Depth weight favoring nearer layers; the upper clamp keeps HDR colors within fp16 range once summed.
+    float viewDistance = length(cameraPosition - fragPosWorld);
+    float weight = clamp(0.03 / (1e-5 + pow(viewDistance / 200.0, 4.0)), 1e-2, 3e2);
+    outAccum = vec4(finalColor * surfaceAlpha, surfaceAlpha) * weight;
+    outRevealage = surfaceAlpha;
+#else
     // Output final color
     outColor = vec4(finalColor, surfaceAlpha);
+#endif
 
     // Optional Gamma Correction (if swapchain is UNORM and linear workflow is used)
     // if using SRGB swapchain format, this is not needed as hardware handles it.
@@ -25,6 +25,7 @@ layout(location = 0) out vec4 fragColor;
 layout(location = 1) out vec2 fragTexCoord;
 layout(location = 2) out vec3 fragNormalWorld; // Normal in world space
 layout(location = 3) out vec3 fragPosWorld;   // Position in world space
+layout(location = 4) out vec3 fragTangentWorld; // Read by normal-mapped material variants
 
 void main() {
     vec4 worldPos = pushConsts.model * vec4(inPosition, 1.0);
@@ -39,4 +40,5 @@ void main() {
 
     fragColor = inColor;
     fragTexCoord = inTexCoord;
+    fragTangentWorld = normalMatrix * inTangent;
 }
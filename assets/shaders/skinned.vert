@@ -0,0 +1,58 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+// Input vertex attributes (binding 0, per vertex) - same as simple.vert
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inNormal;
+layout(location = 2) in vec2 inTexCoord;
+layout(location = 3) in vec4 inColor;
+layout(location = 4) in vec3 inTangent;
+
+// Skin attributes (binding 1, per vertex) - matches SkinVertex
+layout(location = 5) in uvec4 inJoints;  // Indices into this object's skinning matrices
+layout(location = 6) in vec4 inWeights;  // Sum to 1
+
+// Descriptor Set 0: Frame Data (Bound once per frame)
+layout(set = 0, binding = 0) uniform CameraMatrices {
+    mat4 view;
+    mat4 proj;
+} cameraData;
+
+// Descriptor Set 2: Skinning matrices of every skinned object this frame
+layout(std430, set = 2, binding = 0) readonly buffer BoneMatrices {
+    mat4 bones[];
+} boneData;
+
+// Push Constants: Per-Object Data
+layout(push_constant) uniform PushConstants {
+    mat4 model;        // Object-to-World matrix
+    uint jointOffset;  // First of this object's matrices in boneData.bones
+} pushConsts;
+
+// Output to fragment shader (same interface as simple.vert, so simple.frag is reused)
+layout(location = 0) out vec4 fragColor;
+layout(location = 1) out vec2 fragTexCoord;
+layout(location = 2) out vec3 fragNormalWorld;
+layout(location = 3) out vec3 fragPosWorld;
+layout(location = 4) out vec3 fragTangentWorld; // Read by normal-mapped material variants
+
+void main() {
+    uvec4 joints = inJoints + uvec4(pushConsts.jointOffset);
+    mat4 skin = boneData.bones[joints.x] * inWeights.x +
+                boneData.bones[joints.y] * inWeights.y +
+                boneData.bones[joints.z] * inWeights.z +
+                boneData.bones[joints.w] * inWeights.w;
+    mat4 model = pushConsts.model * skin;
+
+    vec4 worldPos = model * vec4(inPosition, 1.0);
+    fragPosWorld = worldPos.xyz;
+
+    gl_Position = cameraData.proj * cameraData.view * worldPos;
+
+    // Approximation for normal matrix (works for uniform scale/rotation)
+    fragNormalWorld = normalize(mat3(model) * inNormal);
+
+    fragColor = inColor;
+    fragTexCoord = inTexCoord;
+    fragTangentWorld = mat3(model) * inTangent;
+}
@@ -0,0 +1,111 @@
+#include "AnimationBenchmark.h"
+#include "AnimationClip.h"
+#include "Skeleton.h"
+#include "scene/Components/AnimatorComponent.h"
+#include "core/JobSystem.h"
+#include "core/Log.h"
+
+#include <glm/gtc/quaternion.hpp>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+namespace VulkEng {
+
+    namespace {
+        std::shared_ptr<Skeleton> MakeBenchmarkSkeleton(uint32_t jointCount) {
+            auto skeleton = std::make_shared<Skeleton>();
+            skeleton->jointNames.resize(jointCount);
+            skeleton->parents.resize(jointCount);
+            skeleton->bindPose.Resize(jointCount);
+            for (uint32_t joint = 0; joint < jointCount; ++joint) {
+                skeleton->jointNames[joint] = "joint" + std::to_string(joint);
+                skeleton->parents[joint] = joint == 0 ? -1 : static_cast<int32_t>((joint - 1) / 2);
+                skeleton->bindPose.SetJoint(joint, glm::vec3(0.0f, joint == 0 ? 0.0f : 0.25f, 0.0f),
+                                            glm::quat(1.0f, 0.0f, 0.0f, 0.0f), glm::vec3(1.0f));
+            }
+            std::vector<glm::mat4> bindModel(jointCount);
+            ComputeModelMatrices(*skeleton, skeleton->bindPose, bindModel.data());
+            skeleton->inverseBindMatrices.resize(jointCount);
+            for (uint32_t joint = 0; joint < jointCount; ++joint) {
+                skeleton->inverseBindMatrices[joint] = glm::inverse(bindModel[joint]);
+            }
+            return skeleton;
+        }
+
+        // Every joint swings about its own axis; the root also bobs, so all channel kinds are exercised.
+        std::shared_ptr<AnimationClip> MakeBenchmarkClip(const Skeleton& skeleton, const char* name, float frequency) {
+            const float duration = 2.0f;
+            const uint32_t keyCount = 21;
+            std::vector<AnimationClip::JointKeys> joints(skeleton.GetJointCount());
+            for (uint32_t joint = 0; joint < joints.size(); ++joint) {
+                AnimationClip::JointKeys& keys = joints[joint];
+                glm::vec3 axis = glm::normalize(glm::vec3(std::sin(joint * 1.3f), 1.0f, std::cos(joint * 0.7f)));
+                for (uint32_t key = 0; key < keyCount; ++key) {
+                    float time = duration * key / (keyCount - 1);
+                    float phase = time * frequency * 6.2831853f + joint * 0.5f;
+                    keys.rotationTimes.push_back(time);
+                    keys.rotations.push_back(glm::angleAxis(0.4f * std::sin(phase), axis));
+                    if (joint == 0) {
+                        keys.translationTimes.push_back(time);
+                        keys.translations.push_back(glm::vec3(0.0f, 0.05f * std::sin(phase * 2.0f), 0.0f));
+                    }
+                }
+            }
+            return AnimationClip::Build(name, duration, joints, skeleton.bindPose);
+        }
+    }
+
+    AnimationBenchmarkResult RunAnimationBenchmark(JobSystem& jobs, uint32_t characters, uint32_t joints, uint32_t frames) {
+        using Clock = std::chrono::high_resolution_clock;
+
+        AnimationBenchmarkResult result;
+        result.characters = characters;
+        result.jointsPerCharacter = joints;
+        result.frames = frames;
+        if (characters == 0 || joints == 0 || frames == 0) return result;
+
+        std::shared_ptr<Skeleton> skeleton = MakeBenchmarkSkeleton(joints);
+        std::shared_ptr<AnimationClip> walk = MakeBenchmarkClip(*skeleton, "BenchWalk", 1.0f);
+        std::shared_ptr<AnimationClip> run = MakeBenchmarkClip(*skeleton, "BenchRun", 1.7f);
+        result.clipBytes = walk->GetMemoryBytes();
+
+        std::vector<std::unique_ptr<AnimatorComponent>> animators;
+        animators.reserve(characters);
+        for (uint32_t i = 0; i < characters; ++i) {
+            auto animator = std::make_unique<AnimatorComponent>(skeleton);
+            animator->Play(walk);
+            animator->Update(0.013f * i); // Desynchronize
+            animator->Play(run, true, 1.0e6f); // Keeps a crossfade (second sample + blend) active throughout
+            animators.push_back(std::move(animator));
+        }
+
+        const float deltaTime = 1.0f / 60.0f;
+        auto serialStart = Clock::now();
+        for (uint32_t frame = 0; frame < frames; ++frame) {
+            for (auto& animator : animators) animator->Update(deltaTime);
+        }
+        double serialMs = std::chrono::duration<double, std::milli>(Clock::now() - serialStart).count();
+
+        auto parallelStart = Clock::now();
+        for (uint32_t frame = 0; frame < frames; ++frame) {
+            jobs.ParallelFor(characters, 16, [&animators, deltaTime](uint32_t begin, uint32_t end) {
+                for (uint32_t i = begin; i < end; ++i) animators[i]->Update(deltaTime);
+            });
+        }
+        double parallelMs = std::chrono::duration<double, std::milli>(Clock::now() - parallelStart).count();
+
+        const double poses = static_cast<double>(characters) * frames;
+        result.msPerFrame = parallelMs / frames;
+        result.posesPerSecond = parallelMs > 0.0 ? poses / (parallelMs / 1000.0) : 0.0;
+        result.singleThreadPosesPerSecond = serialMs > 0.0 ? poses / (serialMs / 1000.0) : 0.0;
+
+        VKENG_INFO("Animation benchmark: {} characters x {} joints x {} frames: {:.3f} ms/frame, "
+                   "{:.0f} poses/s parallel, {:.0f} poses/s single-threaded, {} bytes per clip.",
+                   characters, joints, frames, result.msPerFrame, result.posesPerSecond,
+                   result.singleThreadPosesPerSecond, result.clipBytes);
+        return result;
+    }
+
+} // namespace VulkEng
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+
+namespace VulkEng {
+
+    class JobSystem;
+
+    // Results of RunAnimationBenchmark. A "pose" is one character's full evaluation:
+    // two clip samples, a crossfade blend, local-to-model and skinning matrices.
+    struct AnimationBenchmarkResult {
+        uint32_t characters = 0;
+        uint32_t jointsPerCharacter = 0;
+        uint32_t frames = 0;
+        double msPerFrame = 0.0;          // All characters, evaluated across the JobSystem
+        double posesPerSecond = 0.0;      // Parallel throughput
+        double singleThreadPosesPerSecond = 0.0;
+        uint64_t clipBytes = 0;           // Compressed size of one synthetic clip
+    };
+
+    // Animates `characters` AnimatorComponents with `joints`-joint synthetic skeletons for `frames`
+    // frames, first on the calling thread only, then in parallel chunks on `jobs`. Logs and returns
+    // the throughput. Debug/profiling aid; doesn't touch the active scene.
+    AnimationBenchmarkResult RunAnimationBenchmark(JobSystem& jobs, uint32_t characters, uint32_t joints, uint32_t frames);
+
+} // namespace VulkEng
@@ -0,0 +1,268 @@
+#include "AnimationClip.h"
+#include "core/Log.h"
+
+#include <algorithm> // For std::upper_bound, std::clamp, std::min
+#include <cmath>     // For std::ceil, std::fmod, std::lround, std::abs
+
+namespace VulkEng {
+
+    namespace {
+        constexpr float ConstantTolerance = 1e-5f;
+
+        // Index of the last key at or before `time` (clamped to the valid range) and the blend factor to the next.
+        size_t FindKey(const std::vector<float>& times, size_t keyCount, float time, float& outAlpha) {
+            outAlpha = 0.0f;
+            if (keyCount <= 1 || time <= times[0]) return 0;
+            if (time >= times[keyCount - 1]) return keyCount - 1;
+            size_t next = static_cast<size_t>(std::upper_bound(times.begin(), times.begin() + keyCount, time) - times.begin());
+            size_t key = next - 1;
+            float span = times[next] - times[key];
+            outAlpha = span > 0.0f ? (time - times[key]) / span : 0.0f;
+            return key;
+        }
+
+        glm::vec3 SampleKeys(const std::vector<float>& times, const std::vector<glm::vec3>& values, float time) {
+            size_t keyCount = std::min(times.size(), values.size());
+            float alpha;
+            size_t key = FindKey(times, keyCount, time, alpha);
+            if (alpha == 0.0f) return values[key];
+            return values[key] + (values[key + 1] - values[key]) * alpha;
+        }
+
+        glm::quat SampleKeys(const std::vector<float>& times, const std::vector<glm::quat>& values, float time) {
+            size_t keyCount = std::min(times.size(), values.size());
+            float alpha;
+            size_t key = FindKey(times, keyCount, time, alpha);
+            if (alpha == 0.0f) return values[key];
+            return glm::slerp(values[key], values[key + 1], alpha);
+        }
+
+        uint16_t QuantizeUnsigned(float value, float minValue, float extent) {
+            if (extent <= 0.0f) return 0;
+            float normalized = std::clamp((value - minValue) / extent, 0.0f, 1.0f);
+            return static_cast<uint16_t>(std::lround(normalized * 65535.0f));
+        }
+
+        uint16_t QuantizeSigned(float value) {
+            int16_t quantized = static_cast<int16_t>(std::lround(std::clamp(value, -1.0f, 1.0f) * 32767.0f));
+            return static_cast<uint16_t>(quantized);
+        }
+    }
+
+    std::shared_ptr<AnimationClip> AnimationClip::Build(const std::string& name, float durationSeconds,
+                                                        const std::vector<JointKeys>& joints, const Pose& bindPose,
+                                                        float sampleRate) {
+        std::shared_ptr<AnimationClip> clip(new AnimationClip());
+        clip->m_Name = name;
+        clip->m_Duration = std::max(durationSeconds, 0.0f);
+        clip->m_JointCount = bindPose.jointCount;
+        if (clip->m_Duration > 0.0f && sampleRate > 0.0f) {
+            clip->m_FrameCount = std::max(2u, static_cast<uint32_t>(std::ceil(clip->m_Duration * sampleRate)) + 1u);
+            clip->m_FramesPerSecond = static_cast<float>(clip->m_FrameCount - 1) / clip->m_Duration;
+        } else {
+            clip->m_FrameCount = 1;
+            clip->m_FramesPerSecond = sampleRate;
+        }
+        const uint32_t frameCount = clip->m_FrameCount;
+
+        // Resampled channels of the animated joints, quantized into frames once all are known.
+        std::vector<std::vector<glm::vec3>> translationSamples, scaleSamples;
+        std::vector<std::vector<glm::quat>> rotationSamples;
+        std::vector<glm::vec3> translationTrack(frameCount), scaleTrack(frameCount);
+        std::vector<glm::quat> rotationTrack(frameCount);
+
+        auto isConstant = [](const std::vector<glm::vec3>& track) {
+            for (const glm::vec3& value : track) {
+                glm::vec3 delta = glm::abs(value - track[0]);
+                if (delta.x > ConstantTolerance || delta.y > ConstantTolerance || delta.z > ConstantTolerance) return false;
+            }
+            return true;
+        };
+
+        for (uint32_t joint = 0; joint < clip->m_JointCount; ++joint) {
+            static const JointKeys noKeys;
+            const JointKeys& keys = joint < joints.size() ? joints[joint] : noKeys;
+            const uint16_t jointIndex = static_cast<uint16_t>(joint);
+
+            // Translation
+            if (keys.translationTimes.empty() || keys.translations.empty()) {
+                clip->m_ConstantTranslationJoints.push_back(jointIndex);
+                clip->m_ConstantTranslations.push_back(bindPose.GetTranslation(joint));
+            } else {
+                for (uint32_t frame = 0; frame < frameCount; ++frame) {
+                    translationTrack[frame] = SampleKeys(keys.translationTimes, keys.translations, frame / clip->m_FramesPerSecond);
+                }
+                if (isConstant(translationTrack)) {
+                    clip->m_ConstantTranslationJoints.push_back(jointIndex);
+                    clip->m_ConstantTranslations.push_back(translationTrack[0]);
+                } else {
+                    clip->m_AnimatedTranslationJoints.push_back(jointIndex);
+                    translationSamples.push_back(translationTrack);
+                }
+            }
+
+            // Rotation
+            if (keys.rotationTimes.empty() || keys.rotations.empty()) {
+                clip->m_ConstantRotationJoints.push_back(jointIndex);
+                clip->m_ConstantRotations.push_back(bindPose.GetRotation(joint));
+            } else {
+                bool constant = true;
+                for (uint32_t frame = 0; frame < frameCount; ++frame) {
+                    glm::quat q = glm::normalize(SampleKeys(keys.rotationTimes, keys.rotations, frame / clip->m_FramesPerSecond));
+                    // Keep consecutive frames on the same hemisphere so the runtime lerp never flips.
+                    if (frame > 0 && glm::dot(rotationTrack[frame - 1], q) < 0.0f) q = -q;
+                    rotationTrack[frame] = q;
+                    if (std::abs(glm::dot(rotationTrack[0], q)) < 1.0f - ConstantTolerance) constant = false;
+                }
+                if (constant) {
+                    clip->m_ConstantRotationJoints.push_back(jointIndex);
+                    clip->m_ConstantRotations.push_back(rotationTrack[0]);
+                } else {
+                    clip->m_AnimatedRotationJoints.push_back(jointIndex);
+                    rotationSamples.push_back(rotationTrack);
+                }
+            }
+
+            // Scale
+            if (keys.scaleTimes.empty() || keys.scales.empty()) {
+                clip->m_ConstantScaleJoints.push_back(jointIndex);
+                clip->m_ConstantScales.push_back(bindPose.GetScale(joint));
+            } else {
+                for (uint32_t frame = 0; frame < frameCount; ++frame) {
+                    scaleTrack[frame] = SampleKeys(keys.scaleTimes, keys.scales, frame / clip->m_FramesPerSecond);
+                }
+                if (isConstant(scaleTrack)) {
+                    clip->m_ConstantScaleJoints.push_back(jointIndex);
+                    clip->m_ConstantScales.push_back(scaleTrack[0]);
+                } else {
+                    clip->m_AnimatedScaleJoints.push_back(jointIndex);
+                    scaleSamples.push_back(scaleTrack);
+                }
+            }
+        }
+
+        // Per-channel ranges for the unsigned quantization.
+        auto computeRanges = [](const std::vector<std::vector<glm::vec3>>& samples,
+                                std::vector<glm::vec3>& outMin, std::vector<glm::vec3>& outExtent) {
+            for (const auto& track : samples) {
+                glm::vec3 minValue = track[0], maxValue = track[0];
+                for (const glm::vec3& value : track) {
+                    minValue = glm::min(minValue, value);
+                    maxValue = glm::max(maxValue, value);
+                }
+                outMin.push_back(minValue);
+                outExtent.push_back(maxValue - minValue);
+            }
+        };
+        computeRanges(translationSamples, clip->m_TranslationMin, clip->m_TranslationExtent);
+        computeRanges(scaleSamples, clip->m_ScaleMin, clip->m_ScaleExtent);
+
+        clip->m_FrameStride = static_cast<uint32_t>(translationSamples.size() * 3 + rotationSamples.size() * 4 + scaleSamples.size() * 3);
+        clip->m_FrameData.resize(static_cast<size_t>(clip->m_FrameStride) * frameCount);
+        for (uint32_t frame = 0; frame < frameCount; ++frame) {
+            uint16_t* out = clip->m_FrameData.data() + static_cast<size_t>(frame) * clip->m_FrameStride;
+            for (size_t track = 0; track < translationSamples.size(); ++track) {
+                for (int axis = 0; axis < 3; ++axis) {
+                    *out++ = QuantizeUnsigned(translationSamples[track][frame][axis], clip->m_TranslationMin[track][axis],
+                                              clip->m_TranslationExtent[track][axis]);
+                }
+            }
+            for (size_t track = 0; track < rotationSamples.size(); ++track) {
+                const glm::quat& q = rotationSamples[track][frame];
+                *out++ = QuantizeSigned(q.x);
+                *out++ = QuantizeSigned(q.y);
+                *out++ = QuantizeSigned(q.z);
+                *out++ = QuantizeSigned(q.w);
+            }
+            for (size_t track = 0; track < scaleSamples.size(); ++track) {
+                for (int axis = 0; axis < 3; ++axis) {
+                    *out++ = QuantizeUnsigned(scaleSamples[track][frame][axis], clip->m_ScaleMin[track][axis],
+                                              clip->m_ScaleExtent[track][axis]);
+                }
+            }
+        }
+
+        VKENG_TRACE("AnimationClip '{}': {:.2f}s, {} frames, {} joints, animated T/R/S {}/{}/{}, {} bytes.",
+                    name, clip->m_Duration, frameCount, clip->m_JointCount, translationSamples.size(),
+                    rotationSamples.size(), scaleSamples.size(), clip->GetMemoryBytes());
+        return clip;
+    }
+
+    void AnimationClip::Sample(float timeSeconds, bool loop, Pose& outPose, Pose& scratch) const {
+        if (outPose.jointCount != m_JointCount || scratch.jointCount != m_JointCount) {
+            VKENG_ERROR("AnimationClip::Sample: Pose has {} joints, clip '{}' expects {}.", outPose.jointCount, m_Name, m_JointCount);
+            return;
+        }
+
+        float time = timeSeconds;
+        if (loop && m_Duration > 0.0f) {
+            time = std::fmod(time, m_Duration);
+            if (time < 0.0f) time += m_Duration;
+        } else {
+            time = std::clamp(time, 0.0f, m_Duration);
+        }
+        float framePosition = time * m_FramesPerSecond;
+        uint32_t frame0 = std::min(static_cast<uint32_t>(framePosition), m_FrameCount - 1);
+        uint32_t frame1 = std::min(frame0 + 1, m_FrameCount - 1);
+        float alpha = std::clamp(framePosition - static_cast<float>(frame0), 0.0f, 1.0f);
+
+        DecodeFrame(frame0, outPose);
+        DecodeFrame(frame1, scratch);
+        BlendPoses(outPose, scratch, alpha, outPose);
+    }
+
+    void AnimationClip::DecodeFrame(uint32_t frame, Pose& outPose) const {
+        for (size_t i = 0; i < m_ConstantTranslationJoints.size(); ++i) {
+            uint16_t joint = m_ConstantTranslationJoints[i];
+            const glm::vec3& t = m_ConstantTranslations[i];
+            outPose.tx[joint] = t.x; outPose.ty[joint] = t.y; outPose.tz[joint] = t.z;
+        }
+        for (size_t i = 0; i < m_ConstantRotationJoints.size(); ++i) {
+            uint16_t joint = m_ConstantRotationJoints[i];
+            const glm::quat& q = m_ConstantRotations[i];
+            outPose.rx[joint] = q.x; outPose.ry[joint] = q.y; outPose.rz[joint] = q.z; outPose.rw[joint] = q.w;
+        }
+        for (size_t i = 0; i < m_ConstantScaleJoints.size(); ++i) {
+            uint16_t joint = m_ConstantScaleJoints[i];
+            const glm::vec3& s = m_ConstantScales[i];
+            outPose.sx[joint] = s.x; outPose.sy[joint] = s.y; outPose.sz[joint] = s.z;
+        }
+
+        if (m_FrameStride == 0) return;
+        const uint16_t* in = m_FrameData.data() + static_cast<size_t>(frame) * m_FrameStride;
+        constexpr float UnsignedScale = 1.0f / 65535.0f;
+        constexpr float SignedScale = 1.0f / 32767.0f;
+
+        for (size_t i = 0; i < m_AnimatedTranslationJoints.size(); ++i, in += 3) {
+            uint16_t joint = m_AnimatedTranslationJoints[i];
+            const glm::vec3 step = m_TranslationExtent[i] * UnsignedScale;
+            outPose.tx[joint] = m_TranslationMin[i].x + in[0] * step.x;
+            outPose.ty[joint] = m_TranslationMin[i].y + in[1] * step.y;
+            outPose.tz[joint] = m_TranslationMin[i].z + in[2] * step.z;
+        }
+        for (size_t i = 0; i < m_AnimatedRotationJoints.size(); ++i, in += 4) {
+            uint16_t joint = m_AnimatedRotationJoints[i];
+            outPose.rx[joint] = static_cast<int16_t>(in[0]) * SignedScale;
+            outPose.ry[joint] = static_cast<int16_t>(in[1]) * SignedScale;
+            outPose.rz[joint] = static_cast<int16_t>(in[2]) * SignedScale;
+            outPose.rw[joint] = static_cast<int16_t>(in[3]) * SignedScale;
+        }
+        for (size_t i = 0; i < m_AnimatedScaleJoints.size(); ++i, in += 3) {
+            uint16_t joint = m_AnimatedScaleJoints[i];
+            const glm::vec3 step = m_ScaleExtent[i] * UnsignedScale;
+            outPose.sx[joint] = m_ScaleMin[i].x + in[0] * step.x;
+            outPose.sy[joint] = m_ScaleMin[i].y + in[1] * step.y;
+            outPose.sz[joint] = m_ScaleMin[i].z + in[2] * step.z;
+        }
+    }
+
+    size_t AnimationClip::GetMemoryBytes() const {
+        return sizeof(AnimationClip) +
+               (m_ConstantTranslationJoints.size() + m_ConstantRotationJoints.size() + m_ConstantScaleJoints.size() +
+                m_AnimatedTranslationJoints.size() + m_AnimatedRotationJoints.size() + m_AnimatedScaleJoints.size()) * sizeof(uint16_t) +
+               (m_ConstantTranslations.size() + m_ConstantScales.size() + m_TranslationMin.size() * 2 + m_ScaleMin.size() * 2) * sizeof(glm::vec3) +
+               m_ConstantRotations.size() * sizeof(glm::quat) +
+               m_FrameData.size() * sizeof(uint16_t);
+    }
+
+} // namespace VulkEng
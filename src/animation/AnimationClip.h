@@ -0,0 +1,78 @@
+#pragma once
+
+#include "Pose.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace VulkEng {
+
+    // A skeletal animation stored compactly for fast sampling. At build time every joint channel is
+    // resampled to a fixed frame rate (so sampling is an index computation, not a key search), and
+    //  - channels that never change are stored once as floats,
+    //  - animated translations/scales are quantized to 16 bits per component within the channel's range,
+    //  - animated rotations are quantized to 16 bits per component (signed, normalized).
+    // Frames are stored contiguously, so a sample reads two small blocks of memory.
+    class AnimationClip {
+    public:
+        // Raw keys of one joint as imported. Times are in seconds; empty channels keep the bind pose.
+        struct JointKeys {
+            std::vector<float> translationTimes;
+            std::vector<glm::vec3> translations;
+            std::vector<float> rotationTimes;
+            std::vector<glm::quat> rotations;
+            std::vector<float> scaleTimes;
+            std::vector<glm::vec3> scales;
+        };
+
+        // `joints` is indexed like the skeleton (and `bindPose`); it may be shorter than the joint count.
+        static std::shared_ptr<AnimationClip> Build(const std::string& name, float durationSeconds,
+                                                    const std::vector<JointKeys>& joints, const Pose& bindPose,
+                                                    float sampleRate = 30.0f);
+
+        // Writes the local pose at `timeSeconds` into `outPose`. `scratch` holds the second frame;
+        // both must be sized for this clip's joint count (Pose::Resize) and may not alias.
+        void Sample(float timeSeconds, bool loop, Pose& outPose, Pose& scratch) const;
+
+        const std::string& GetName() const { return m_Name; }
+        float GetDuration() const { return m_Duration; }
+        uint32_t GetJointCount() const { return m_JointCount; }
+        uint32_t GetFrameCount() const { return m_FrameCount; }
+        size_t GetMemoryBytes() const;
+
+    private:
+        AnimationClip() = default;
+
+        void DecodeFrame(uint32_t frame, Pose& outPose) const;
+
+        std::string m_Name;
+        float m_Duration = 0.0f;
+        float m_FramesPerSecond = 30.0f; // Adjusted so the last frame lands exactly on the duration
+        uint32_t m_JointCount = 0;
+        uint32_t m_FrameCount = 0;
+
+        // Constant channels: value per joint, written into every sample.
+        std::vector<uint16_t> m_ConstantTranslationJoints;
+        std::vector<glm::vec3> m_ConstantTranslations;
+        std::vector<uint16_t> m_ConstantRotationJoints;
+        std::vector<glm::quat> m_ConstantRotations;
+        std::vector<uint16_t> m_ConstantScaleJoints;
+        std::vector<glm::vec3> m_ConstantScales;
+
+        // Animated channels: joint index plus dequantization range (value = min + q * extent / 65535).
+        std::vector<uint16_t> m_AnimatedTranslationJoints;
+        std::vector<glm::vec3> m_TranslationMin, m_TranslationExtent;
+        std::vector<uint16_t> m_AnimatedRotationJoints;
+        std::vector<uint16_t> m_AnimatedScaleJoints;
+        std::vector<glm::vec3> m_ScaleMin, m_ScaleExtent;
+
+        // Per frame: [3 x u16 per animated translation][4 x s16 per animated rotation][3 x u16 per animated scale]
+        uint32_t m_FrameStride = 0; // In uint16 values
+        std::vector<uint16_t> m_FrameData;
+    };
+
+} // namespace VulkEng
@@ -0,0 +1,102 @@
+#include "Pose.h"
+#include "Skeleton.h"
+#include "SimdFloat4.h"
+
+namespace VulkEng {
+
+    void Pose::Resize(uint32_t newJointCount) {
+        jointCount = newJointCount;
+        const size_t padded = PaddedCount(newJointCount);
+        for (std::vector<float>* channel : {&tx, &ty, &tz, &rx, &ry, &rz}) channel->assign(padded, 0.0f);
+        for (std::vector<float>* channel : {&rw, &sx, &sy, &sz}) channel->assign(padded, 1.0f);
+    }
+
+    void Pose::SetJoint(uint32_t joint, const glm::vec3& translation, const glm::quat& rotation, const glm::vec3& scale) {
+        tx[joint] = translation.x; ty[joint] = translation.y; tz[joint] = translation.z;
+        rx[joint] = rotation.x; ry[joint] = rotation.y; rz[joint] = rotation.z; rw[joint] = rotation.w;
+        sx[joint] = scale.x; sy[joint] = scale.y; sz[joint] = scale.z;
+    }
+
+    void BlendPoses(const Pose& a, const Pose& b, float weight, Pose& out) {
+        const uint32_t padded = a.GetPaddedCount();
+        const Float4 w = Float4::Splat(weight);
+
+        auto lerpChannel = [&](const std::vector<float>& ca, const std::vector<float>& cb, std::vector<float>& co) {
+            for (uint32_t i = 0; i < padded; i += 4) {
+                Float4 va = Float4::Load(&ca[i]);
+                (va + (Float4::Load(&cb[i]) - va) * w).Store(&co[i]);
+            }
+        };
+        lerpChannel(a.tx, b.tx, out.tx); lerpChannel(a.ty, b.ty, out.ty); lerpChannel(a.tz, b.tz, out.tz);
+        lerpChannel(a.sx, b.sx, out.sx); lerpChannel(a.sy, b.sy, out.sy); lerpChannel(a.sz, b.sz, out.sz);
+
+        for (uint32_t i = 0; i < padded; i += 4) {
+            Float4 ax = Float4::Load(&a.rx[i]), ay = Float4::Load(&a.ry[i]), az = Float4::Load(&a.rz[i]), aw = Float4::Load(&a.rw[i]);
+            Float4 bx = Float4::Load(&b.rx[i]), by = Float4::Load(&b.ry[i]), bz = Float4::Load(&b.rz[i]), bw = Float4::Load(&b.rw[i]);
+            // Flip b onto a's hemisphere so the blend takes the shortest arc.
+            Float4 sign = SignOf(ax * bx + ay * by + az * bz + aw * bw);
+            bx = bx * sign; by = by * sign; bz = bz * sign; bw = bw * sign;
+
+            Float4 qx = ax + (bx - ax) * w, qy = ay + (by - ay) * w, qz = az + (bz - az) * w, qw = aw + (bw - aw) * w;
+            Float4 invLength = Float4::Splat(1.0f) / Sqrt(qx * qx + qy * qy + qz * qz + qw * qw);
+            (qx * invLength).Store(&out.rx[i]); (qy * invLength).Store(&out.ry[i]);
+            (qz * invLength).Store(&out.rz[i]); (qw * invLength).Store(&out.rw[i]);
+        }
+    }
+
+    void ComputeModelMatrices(const Skeleton& skeleton, const Pose& localPose, glm::mat4* outModelMatrices) {
+        const uint32_t jointCount = skeleton.GetJointCount();
+        const uint32_t padded = localPose.GetPaddedCount();
+        const Float4 one = Float4::Splat(1.0f), two = Float4::Splat(2.0f);
+
+        // Local TRS -> matrix for four joints at a time.
+        alignas(16) float lanes[12][4];
+        for (uint32_t base = 0; base < padded; base += 4) {
+            Float4 x = Float4::Load(&localPose.rx[base]), y = Float4::Load(&localPose.ry[base]);
+            Float4 z = Float4::Load(&localPose.rz[base]), w = Float4::Load(&localPose.rw[base]);
+            Float4 sx = Float4::Load(&localPose.sx[base]), sy = Float4::Load(&localPose.sy[base]), sz = Float4::Load(&localPose.sz[base]);
+
+            Float4 xx = x * x, yy = y * y, zz = z * z;
+            Float4 xy = x * y, xz = x * z, yz = y * z;
+            Float4 wx = w * x, wy = w * y, wz = w * z;
+
+            // Column-major rotation scaled per axis (matches glm::mat4_cast(q) * scale).
+            (sx * (one - two * (yy + zz))).Store(lanes[0]);
+            (sx * (two * (xy + wz))).Store(lanes[1]);
+            (sx * (two * (xz - wy))).Store(lanes[2]);
+            (sy * (two * (xy - wz))).Store(lanes[3]);
+            (sy * (one - two * (xx + zz))).Store(lanes[4]);
+            (sy * (two * (yz + wx))).Store(lanes[5]);
+            (sz * (two * (xz + wy))).Store(lanes[6]);
+            (sz * (two * (yz - wx))).Store(lanes[7]);
+            (sz * (one - two * (xx + yy))).Store(lanes[8]);
+            Float4::Load(&localPose.tx[base]).Store(lanes[9]);
+            Float4::Load(&localPose.ty[base]).Store(lanes[10]);
+            Float4::Load(&localPose.tz[base]).Store(lanes[11]);
+
+            for (uint32_t lane = 0; lane < 4 && base + lane < jointCount; ++lane) {
+                glm::mat4& m = outModelMatrices[base + lane];
+                m[0] = glm::vec4(lanes[0][lane], lanes[1][lane], lanes[2][lane], 0.0f);
+                m[1] = glm::vec4(lanes[3][lane], lanes[4][lane], lanes[5][lane], 0.0f);
+                m[2] = glm::vec4(lanes[6][lane], lanes[7][lane], lanes[8][lane], 0.0f);
+                m[3] = glm::vec4(lanes[9][lane], lanes[10][lane], lanes[11][lane], 1.0f);
+            }
+        }
+
+        // Parents come first, so each parent is already in model space when its children are reached.
+        for (uint32_t joint = 0; joint < jointCount; ++joint) {
+            int32_t parent = skeleton.parents[joint];
+            if (parent >= 0) {
+                outModelMatrices[joint] = outModelMatrices[parent] * outModelMatrices[joint];
+            }
+        }
+    }
+
+    void ComputeSkinningMatrices(const Skeleton& skeleton, const glm::mat4* modelMatrices, glm::mat4* outSkinningMatrices) {
+        const uint32_t jointCount = skeleton.GetJointCount();
+        for (uint32_t joint = 0; joint < jointCount; ++joint) {
+            outSkinningMatrices[joint] = modelMatrices[joint] * skeleton.inverseBindMatrices[joint];
+        }
+    }
+
+} // namespace VulkEng
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace VulkEng {
+
+    struct Skeleton;
+
+    // Local (parent-relative) joint transforms in structure-of-arrays layout, so sampling and
+    // blending process four joints per SIMD instruction. Arrays are padded to a multiple of 4;
+    // padding lanes hold the identity transform.
+    struct Pose {
+        uint32_t jointCount = 0;
+        std::vector<float> tx, ty, tz;     // Translation
+        std::vector<float> rx, ry, rz, rw; // Rotation quaternion
+        std::vector<float> sx, sy, sz;     // Scale
+
+        static uint32_t PaddedCount(uint32_t jointCount) { return (jointCount + 3u) & ~3u; }
+
+        void Resize(uint32_t newJointCount);
+        uint32_t GetPaddedCount() const { return PaddedCount(jointCount); }
+
+        void SetJoint(uint32_t joint, const glm::vec3& translation, const glm::quat& rotation, const glm::vec3& scale);
+        glm::vec3 GetTranslation(uint32_t joint) const { return glm::vec3(tx[joint], ty[joint], tz[joint]); }
+        glm::quat GetRotation(uint32_t joint) const { return glm::quat(rw[joint], rx[joint], ry[joint], rz[joint]); }
+        glm::vec3 GetScale(uint32_t joint) const { return glm::vec3(sx[joint], sy[joint], sz[joint]); }
+    };
+
+    // out = a + (b - a) * weight, with normalized quaternion lerp along the shortest arc.
+    // `out` may alias `a` or `b`. All poses must have the same joint count.
+    void BlendPoses(const Pose& a, const Pose& b, float weight, Pose& out);
+
+    // Converts `localPose` to model-space joint matrices (parents are stored before children).
+    void ComputeModelMatrices(const Skeleton& skeleton, const Pose& localPose, glm::mat4* outModelMatrices);
+
+    // model * inverseBind per joint: the matrices the skinning shader applies to bind-pose vertices.
+    void ComputeSkinningMatrices(const Skeleton& skeleton, const glm::mat4* modelMatrices, glm::mat4* outSkinningMatrices);
+
+} // namespace VulkEng
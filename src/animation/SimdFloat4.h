@@ -0,0 +1,56 @@
+#pragma once
+
+// Minimal 4-wide float vector for the SoA animation kernels. Uses SSE2 on x86-64 (always available
+// there) and a plain array otherwise, so the kernels are written once and stay portable.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define VKENG_SIMD_SSE2 1
+    #include <emmintrin.h>
+#endif
+
+#include <cmath>
+
+namespace VulkEng {
+
+#if defined(VKENG_SIMD_SSE2)
+
+    struct Float4 {
+        __m128 v;
+
+        static Float4 Load(const float* p) { return {_mm_loadu_ps(p)}; }
+        static Float4 Splat(float s) { return {_mm_set1_ps(s)}; }
+        void Store(float* p) const { _mm_storeu_ps(p, v); }
+
+        friend Float4 operator+(Float4 a, Float4 b) { return {_mm_add_ps(a.v, b.v)}; }
+        friend Float4 operator-(Float4 a, Float4 b) { return {_mm_sub_ps(a.v, b.v)}; }
+        friend Float4 operator*(Float4 a, Float4 b) { return {_mm_mul_ps(a.v, b.v)}; }
+        friend Float4 operator/(Float4 a, Float4 b) { return {_mm_div_ps(a.v, b.v)}; }
+    };
+
+    inline Float4 Sqrt(Float4 a) { return {_mm_sqrt_ps(a.v)}; }
+    // +1 or -1 per lane, following the sign bit of `a`.
+    inline Float4 SignOf(Float4 a) {
+        const __m128 signMask = _mm_set1_ps(-0.0f);
+        return {_mm_or_ps(_mm_and_ps(a.v, signMask), _mm_set1_ps(1.0f))};
+    }
+
+#else
+
+    struct Float4 {
+        float v[4];
+
+        static Float4 Load(const float* p) { return {{p[0], p[1], p[2], p[3]}}; }
+        static Float4 Splat(float s) { return {{s, s, s, s}}; }
+        void Store(float* p) const { for (int i = 0; i < 4; ++i) p[i] = v[i]; }
+
+        friend Float4 operator+(Float4 a, Float4 b) { for (int i = 0; i < 4; ++i) a.v[i] += b.v[i]; return a; }
+        friend Float4 operator-(Float4 a, Float4 b) { for (int i = 0; i < 4; ++i) a.v[i] -= b.v[i]; return a; }
+        friend Float4 operator*(Float4 a, Float4 b) { for (int i = 0; i < 4; ++i) a.v[i] *= b.v[i]; return a; }
+        friend Float4 operator/(Float4 a, Float4 b) { for (int i = 0; i < 4; ++i) a.v[i] /= b.v[i]; return a; }
+    };
+
+    inline Float4 Sqrt(Float4 a) { for (int i = 0; i < 4; ++i) a.v[i] = std::sqrt(a.v[i]); return a; }
+    inline Float4 SignOf(Float4 a) { for (int i = 0; i < 4; ++i) a.v[i] = std::signbit(a.v[i]) ? -1.0f : 1.0f; return a; }
+
+#endif
+
+} // namespace VulkEng
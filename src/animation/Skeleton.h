@@ -0,0 +1,31 @@
+#pragma once
+
+#include "Pose.h"
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace VulkEng {
+
+    // Joint hierarchy of a skinned model. Joints are ordered so every parent precedes its children,
+    // which lets pose evaluation walk the hierarchy in a single forward pass.
+    struct Skeleton {
+        std::vector<std::string> jointNames;
+        std::vector<int32_t> parents;               // -1 for root joints
+        std::vector<glm::mat4> inverseBindMatrices; // Mesh space -> joint space in the bind pose
+        Pose bindPose;                              // Local transforms in the bind pose
+
+        uint32_t GetJointCount() const { return static_cast<uint32_t>(parents.size()); }
+
+        // Returns -1 if no joint has that name.
+        int32_t FindJoint(const std::string& name) const {
+            for (size_t i = 0; i < jointNames.size(); ++i) {
+                if (jointNames[i] == name) return static_cast<int32_t>(i);
+            }
+            return -1;
+        }
+    };
+
+} // namespace VulkEng
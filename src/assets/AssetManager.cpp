@@ -1,6 +1,7 @@
 #include "AssetManager.h"
 #include "graphics/VulkanContext.h"    // For device, physicalDevice
 #include "graphics/CommandManager.h"   // For command pool, queue
+#include "graphics/ImmediateContext.h" // For batched, non-blocking uploads
 #include "graphics/Buffer.h"           // For VulkanBuffer
 #include "graphics/VulkanUtils.h"      // For utility functions (copy, transition, mips)
 #include "graphics/SamplerCache.h"     // For managing samplers
@@ -8,11 +9,15 @@
 #include "ModelLoader.h"               // For LoadedModelData, MaterialDataSource
 #include "core/Log.h"
 #include "core/ServiceLocator.h"       // To get Renderer instance
+#include "core/Hash.h"                 // For content hashes
 
 #include <stdexcept>  // For std::runtime_error
 #include <filesystem> // For path manipulation (C++17)
 #include <algorithm>  // For std::replace, std::min, std::max
 #include <cmath>      // For std::floor, std::log2
+#include <fstream>    // For hashing file contents
+#include <iterator>   // For std::next
+#include <array>      // For the material descriptor writes
 
 // Define STB_IMAGE_IMPLEMENTATION in ONE .cpp file (this one is suitable)
 #define STB_IMAGE_IMPLEMENTATION
@@ -25,12 +30,19 @@ namespace VulkEng {
     {
         VKENG_INFO("AssetManager: Initializing...");
         m_SamplerCache = std::make_unique<SamplerCache>(m_Context.device, m_Context.physicalDevice);
+        // Each material's Set 1 binds its own slot, so slots follow the storage buffer offset alignment.
+        m_MaterialParamsBuffer = std::make_unique<VulkanBuffer>(
+            m_Context, sizeof(MaterialParams), MaxMaterials,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+            m_Context.physicalDeviceProperties.limits.minStorageBufferOffsetAlignment);
         CreateDefaultAssets(); // Create default white texture and material
         VKENG_INFO("AssetManager: Initialized.");
     }
 
     AssetManager::~AssetManager() {
         VKENG_INFO("AssetManager: Destroying...");
+        m_CommandManager.GetImmediateContext().WaitIdle(); // Uploads may still target these resources
 
         // Textures need to be cleaned up before SamplerCache (if samplers were unique per texture)
         // or if Texture struct held unique samplers.
@@ -49,12 +61,14 @@ namespace VulkEng {
         // When m_LoadedModels is cleared, these shared_ptrs decrement.
         // If a VulkanBuffer is no longer referenced, its destructor will free Vulkan memory.
         m_LoadedModels.clear();
+        m_PendingModelReleases.clear(); // Device is idle by now; release unloaded models' buffers too
         m_CachedModelData.clear(); // Clear CPU-side data cache
         VKENG_INFO("AssetManager: Models and cached data cleared.");
 
         // Materials: descriptorSet handles are freed when m_DescriptorPool in Renderer is destroyed.
         // No GPU resources owned directly by Material struct beyond the VkDescriptorSet handle.
         m_LoadedMaterials.clear();
+        m_MaterialParamsBuffer.reset();
         VKENG_INFO("AssetManager: Materials cleared.");
 
         VKENG_INFO("AssetManager: Destroyed.");
@@ -77,10 +91,10 @@ namespace VulkEng {
         // Note: CreateDeviceLocalBuffer creates a DEVICE_LOCAL buffer. For staging to image, we need a HOST_VISIBLE staging.
         // Let's refine the staging process here for textures.
 
-        VulkanBuffer pixelStagingBuffer(m_Context, imageSize, 1,
-                                       VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                                       VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-        pixelStagingBuffer.WriteToBuffer(whitePixel, imageSize);
+        auto pixelStagingBuffer = std::make_unique<VulkanBuffer>(m_Context, imageSize, 1,
+                                                                 VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                                                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        pixelStagingBuffer->WriteToBuffer(whitePixel, imageSize);
 
         VkFormat defaultTexFormat = VK_FORMAT_R8G8B8A8_UNORM; // Or SRGB if preferred for default
         Utils::createImage(m_Context.device, m_Context.physicalDevice, defaultTex.width, defaultTex.height, defaultTex.mipLevels,
@@ -89,12 +103,16 @@ namespace VulkEng {
                            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
                            defaultTex.image, defaultTex.imageMemory);
 
-        Utils::TransitionImageLayout(m_Context.device, m_CommandManager.GetCommandPool(), m_Context.graphicsQueue,
-                                     defaultTex.image, defaultTexFormat, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, defaultTex.mipLevels);
-        Utils::CopyBufferToImage(m_Context.device, m_CommandManager.GetCommandPool(), m_Context.graphicsQueue,
-                                 pixelStagingBuffer.GetBuffer(), defaultTex.image, defaultTex.width, defaultTex.height);
-        Utils::TransitionImageLayout(m_Context.device, m_CommandManager.GetCommandPool(), m_Context.graphicsQueue,
-                                     defaultTex.image, defaultTexFormat, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, defaultTex.mipLevels);
+        {
+            ImmediateContext::Recording recording = m_CommandManager.GetImmediateContext().Record();
+            VkCommandBuffer commandBuffer = recording.GetCommandBuffer();
+            Utils::RecordTransitionImageLayout(commandBuffer, defaultTex.image, defaultTexFormat,
+                                               VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, defaultTex.mipLevels);
+            Utils::RecordCopyBufferToImage(commandBuffer, pixelStagingBuffer->GetBuffer(), defaultTex.image, defaultTex.width, defaultTex.height);
+            Utils::RecordTransitionImageLayout(commandBuffer, defaultTex.image, defaultTexFormat,
+                                               VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, defaultTex.mipLevels);
+            recording.KeepAlive(std::move(pixelStagingBuffer));
+        }
 
         defaultTex.imageView = Utils::createImageView(m_Context.device, defaultTex.image, defaultTexFormat, VK_IMAGE_ASPECT_COLOR_BIT, defaultTex.mipLevels);
         defaultTex.sampler = m_SamplerCache->GetDefaultSampler(); // Get from cache
@@ -108,6 +126,7 @@ namespace VulkEng {
         Material defaultMat("DEFAULT_ENGINE_MATERIAL");
         defaultMat.diffuseTexture = m_DefaultWhiteTexture;
         defaultMat.baseColorFactor = glm::vec4(0.8f, 0.8f, 0.8f, 1.0f); // A light grey
+        defaultMat.metallicFactor = 0.0f; // Dielectric
 
         // Allocate a descriptor set for the default material
         Renderer& renderer = ServiceLocator::GetRenderer(); // Assumes Renderer is already provided
@@ -121,20 +140,7 @@ namespace VulkEng {
             allocInfo.descriptorSetCount = 1;
             allocInfo.pSetLayouts = &defaultMaterialLayout;
             VK_CHECK(vkAllocateDescriptorSets(m_Context.device, &allocInfo, &defaultMat.descriptorSet));
-
-            const Texture& boundTexture = GetTexture(defaultMat.diffuseTexture);
-            VkDescriptorImageInfo imageInfo{};
-            imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-            imageInfo.imageView = boundTexture.imageView;
-            imageInfo.sampler = boundTexture.sampler;
-
-            VkWriteDescriptorSet descriptorWrite{VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
-            descriptorWrite.dstSet = defaultMat.descriptorSet;
-            descriptorWrite.dstBinding = 0; // Binding 0 in Material Layout (Set 1)
-            descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-            descriptorWrite.descriptorCount = 1;
-            descriptorWrite.pImageInfo = &imageInfo;
-            vkUpdateDescriptorSets(m_Context.device, 1, &descriptorWrite, 0, nullptr);
+            WriteMaterialDescriptorSet(defaultMat, m_LoadedMaterials.size()); // Every map binding gets the white texture
         } else {
              VKENG_ERROR("AssetManager: Cannot create descriptor set for default material (layout or pool is null).");
         }
@@ -142,7 +148,8 @@ namespace VulkEng {
 
         m_DefaultMaterial = m_LoadedMaterials.size();
         m_LoadedMaterials.push_back(std::move(defaultMat));
-        m_MaterialNameToHandleMap[defaultMat.name] = m_DefaultMaterial;
+        m_MaterialNameToHandleMap[m_LoadedMaterials.back().name] = m_DefaultMaterial;
+        UploadMaterialParams(m_DefaultMaterial, 1);
         VKENG_INFO("AssetManager: Default material created (Handle: {}).", m_DefaultMaterial);
     }
 
@@ -151,33 +158,45 @@ namespace VulkEng {
     }
 
 
-    TextureHandle AssetManager::LoadTexture(const std::string& filepath, bool generateMips /*= true*/) {
-        std::filesystem::path canonicalPath;
-        try {
-            canonicalPath = std::filesystem::weakly_canonical(filepath); // More robust for relative paths
-        } catch (const std::filesystem::filesystem_error& e) {
-            VKENG_ERROR("AssetManager: Filesystem error for texture path '{}': {}. Using original.", filepath, e.what());
-            canonicalPath = filepath;
-        }
-        std::string canonicalPathStr = canonicalPath.string();
-        std::replace(canonicalPathStr.begin(), canonicalPathStr.end(), '\\', '/'); // Normalize
-
-        auto it = m_TexturePathToHandleMap.find(canonicalPathStr);
+    TextureHandle AssetManager::LoadTexture(const std::string& filepath, bool generateMips /*= true*/, bool srgb /*= true*/) {
+        auto it = m_TexturePathToHandleMap.find(TextureCacheKey(CanonicalizePath(filepath), srgb));
         if (it != m_TexturePathToHandleMap.end()) {
             return it->second;
         }
-        VKENG_INFO("AssetManager: Loading texture: {}", canonicalPathStr);
+        DecodedTexture decoded;
+        if (!DecodeTexture(filepath, decoded)) {
+            return InvalidTextureHandle;
+        }
+        return CreateTextureFromDecoded(filepath, decoded, generateMips, srgb);
+    }
 
+    bool AssetManager::DecodeTexture(const std::string& filepath, DecodedTexture& outTexture) {
         int texWidth, texHeight, texChannels;
         stbi_uc* pixels = stbi_load(filepath.c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
-        VkDeviceSize imageSize = static_cast<VkDeviceSize>(texWidth) * texHeight * 4; // 4 bytes for RGBA
-
         if (!pixels) {
             VKENG_ERROR("AssetManager: Failed to load texture image from '{}': {}", filepath, stbi_failure_reason());
-            return InvalidTextureHandle;
+            return false;
         }
+        outTexture.width = static_cast<uint32_t>(texWidth);
+        outTexture.height = static_cast<uint32_t>(texHeight);
+        outTexture.pixels.assign(pixels, pixels + static_cast<size_t>(texWidth) * texHeight * 4); // 4 bytes for RGBA
+        stbi_image_free(pixels);
+        return true;
+    }
 
-        VkFormat textureFormat = VK_FORMAT_R8G8B8A8_SRGB; // Common choice for color data
+    TextureHandle AssetManager::CreateTextureFromDecoded(const std::string& filepath, const DecodedTexture& decoded, bool generateMips /*= true*/, bool srgb /*= true*/) {
+        std::string canonicalPathStr = CanonicalizePath(filepath);
+        auto it = m_TexturePathToHandleMap.find(TextureCacheKey(canonicalPathStr, srgb));
+        if (it != m_TexturePathToHandleMap.end()) {
+            return it->second;
+        }
+        VKENG_INFO("AssetManager: Loading texture: {}", canonicalPathStr);
+
+        int texWidth = static_cast<int>(decoded.width);
+        int texHeight = static_cast<int>(decoded.height);
+        VkDeviceSize imageSize = static_cast<VkDeviceSize>(decoded.pixels.size());
+
+        VkFormat textureFormat = srgb ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM; // Data maps must not be gamma-decoded
         VkFormatProperties formatProperties;
         vkGetPhysicalDeviceFormatProperties(m_Context.physicalDevice, textureFormat, &formatProperties);
 
@@ -204,11 +223,10 @@ namespace VulkEng {
         newTexture.mipLevels = mipLevels;
         newTexture.path = canonicalPathStr;
 
-        VulkanBuffer stagingBuffer(m_Context, imageSize, 1,
-                                   VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                                   VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-        stagingBuffer.WriteToBuffer(pixels, imageSize);
-        stbi_image_free(pixels);
+        auto stagingBuffer = std::make_unique<VulkanBuffer>(m_Context, imageSize, 1,
+                                                            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                                            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        stagingBuffer->WriteToBuffer(decoded.pixels.data(), imageSize);
 
         Utils::createImage(m_Context.device, m_Context.physicalDevice, newTexture.width, newTexture.height, newTexture.mipLevels,
                            VK_SAMPLE_COUNT_1_BIT, textureFormat, VK_IMAGE_TILING_OPTIMAL,
@@ -216,27 +234,33 @@ namespace VulkEng {
                            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
                            newTexture.image, newTexture.imageMemory);
 
-        // Transition for initial copy
-        Utils::TransitionImageLayout(m_Context.device, m_CommandManager.GetCommandPool(), m_Context.graphicsQueue,
-                                     newTexture.image, textureFormat, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                                     newTexture.mipLevels, 0, 1, 0); // Transition all mips to DST for generation
-
-        // Copy mip level 0
-        Utils::CopyBufferToImage(m_Context.device, m_CommandManager.GetCommandPool(), m_Context.graphicsQueue,
-                                 stagingBuffer.GetBuffer(), newTexture.image, newTexture.width, newTexture.height);
-
-        // Generate mipmaps (Utils::GenerateMipmaps will handle further transitions)
-        if (generateMips && newTexture.mipLevels > 1) {
-            Utils::GenerateMipmaps(m_Context.device, m_Context.physicalDevice, m_CommandManager.GetCommandPool(), m_Context.graphicsQueue,
-                                   newTexture.image, textureFormat, texWidth, texHeight, newTexture.mipLevels);
-        } else { // If no mips or only 1 level, transition the whole image to SHADER_READ_ONLY
-            Utils::TransitionImageLayout(m_Context.device, m_CommandManager.GetCommandPool(), m_Context.graphicsQueue,
-                                         newTexture.image, textureFormat,
-                                         VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, // After copy
-                                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-                                         newTexture.mipLevels, 0, 1, 0); // Transition all mips
+        // Recorded into the shared upload batch: consecutive texture loads end up in one submission,
+        // which the renderer flushes ahead of the frame that first samples them.
+        {
+            ImmediateContext::Recording recording = m_CommandManager.GetImmediateContext().Record();
+            VkCommandBuffer commandBuffer = recording.GetCommandBuffer();
+
+            // Transition for initial copy
+            Utils::RecordTransitionImageLayout(commandBuffer, newTexture.image, textureFormat,
+                                               VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                               newTexture.mipLevels, 0, 1, 0); // Transition all mips to DST for generation
+
+            // Copy mip level 0
+            Utils::RecordCopyBufferToImage(commandBuffer, stagingBuffer->GetBuffer(), newTexture.image, newTexture.width, newTexture.height);
+
+            // Generate mipmaps (Utils::RecordGenerateMipmaps will handle further transitions)
+            if (generateMips && newTexture.mipLevels > 1) {
+                Utils::RecordGenerateMipmaps(commandBuffer, m_Context.physicalDevice,
+                                             newTexture.image, textureFormat, texWidth, texHeight, newTexture.mipLevels);
+            } else { // If no mips or only 1 level, transition the whole image to SHADER_READ_ONLY
+                Utils::RecordTransitionImageLayout(commandBuffer, newTexture.image, textureFormat,
+                                                   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, // After copy
+                                                   VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                                   newTexture.mipLevels, 0, 1, 0); // Transition all mips
+            }
+            // Note: RecordGenerateMipmaps leaves all mip levels in SHADER_READ_ONLY_OPTIMAL.
+            recording.KeepAlive(std::move(stagingBuffer));
         }
-        // Note: GenerateMipmaps should leave all mip levels in SHADER_READ_ONLY_OPTIMAL.
 
         newTexture.imageView = Utils::createImageView(m_Context.device, newTexture.image, textureFormat, VK_IMAGE_ASPECT_COLOR_BIT, newTexture.mipLevels);
 
@@ -249,7 +273,7 @@ namespace VulkEng {
 
         TextureHandle newHandle = m_LoadedTextures.size();
         m_LoadedTextures.push_back(newTexture); // No std::move for plain struct
-        m_TexturePathToHandleMap[canonicalPathStr] = newHandle;
+        m_TexturePathToHandleMap[TextureCacheKey(canonicalPathStr, srgb)] = newHandle;
         VKENG_INFO("AssetManager: Texture loaded: '{}' (Handle: {}, Mips: {}).", canonicalPathStr, newHandle, newTexture.mipLevels);
         return newHandle;
     }
@@ -270,27 +294,107 @@ namespace VulkEng {
         return m_LoadedMaterials[handle];
     }
 
-    ModelHandle AssetManager::LoadModel(const std::string& filepath) {
+    std::string AssetManager::TextureCacheKey(const std::string& canonicalPath, bool srgb) {
+        // The same image can be used as color (sRGB) and as data (UNORM); those are distinct textures.
+        return srgb ? canonicalPath : canonicalPath + "|linear";
+    }
+
+    std::string AssetManager::CanonicalizePath(const std::string& filepath) {
         std::filesystem::path canonicalPath;
         try { canonicalPath = std::filesystem::weakly_canonical(filepath); }
         catch (const std::filesystem::filesystem_error& e) {
-            VKENG_ERROR("AssetManager: Filesystem error for model path '{}': {}", filepath, e.what());
+            VKENG_ERROR("AssetManager: Filesystem error for path '{}': {}", filepath, e.what());
             canonicalPath = filepath;
         }
         std::string canonicalPathStr = canonicalPath.string();
         std::replace(canonicalPathStr.begin(), canonicalPathStr.end(), '\\', '/');
+        return canonicalPathStr;
+    }
 
-        auto it = m_ModelPathToHandleMap.find(canonicalPathStr);
-        if (it != m_ModelPathToHandleMap.end()) {
-            return it->second;
+    AssetHash AssetManager::HashFileContents(const std::string& filepath) {
+        std::ifstream file(filepath, std::ios::binary);
+        if (!file.is_open()) {
+            return InvalidAssetHash;
+        }
+        // Stream in fixed-size blocks so large assets don't need to be resident twice.
+        std::vector<char> buffer(64 * 1024);
+        uint64_t hash = FNV1aOffsetBasis;
+        while (file) {
+            file.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            std::streamsize bytesRead = file.gcount();
+            if (bytesRead <= 0) break;
+            hash = HashBytes(buffer.data(), static_cast<size_t>(bytesRead), hash);
         }
-        VKENG_INFO("AssetManager: Loading Model: {}", canonicalPathStr);
+        // Reserve 0 for "invalid".
+        return hash == InvalidAssetHash ? 1 : hash;
+    }
 
-        LoadedModelData loadedCpuData; // Data from ModelLoader
-        if (!ModelLoader::LoadModel(filepath, loadedCpuData)) {
+    bool AssetManager::ImportModel(const std::string& filepath, LoadedModelData& outModelData, AssetHash& outContentHash,
+                                   bool decodeTextures /*= false*/) {
+        outContentHash = HashFileContents(filepath);
+        if (outContentHash == InvalidAssetHash) {
+            VKENG_ERROR("AssetManager: Cannot read model file '{}'.", filepath);
+            return false;
+        }
+        if (!ModelLoader::LoadModel(filepath, outModelData)) {
             VKENG_ERROR("AssetManager: ModelLoader failed for: {}", filepath);
+            return false;
+        }
+        if (decodeTextures) {
+            // Materials sharing a texture share its pixels. A failed decode leaves the data null,
+            // and material creation falls back to LoadTexture (which reports the error).
+            std::unordered_map<std::string, std::shared_ptr<const DecodedTexture>> decodedByPath;
+            for (MaterialDataSource& material : outModelData.materialsFromFile) {
+                for (const std::string* path : {&material.diffuseTexturePath, &material.normalTexturePath, &material.metallicRoughnessTexturePath,
+                                                &material.aoTexturePath, &material.emissiveTexturePath}) {
+                    if (path->empty()) continue;
+                    auto [it, inserted] = decodedByPath.try_emplace(*path);
+                    if (inserted) {
+                        auto decoded = std::make_shared<DecodedTexture>();
+                        if (DecodeTexture(*path, *decoded)) it->second = std::move(decoded);
+                    }
+                    if (it->second) material.decodedTextures[*path] = it->second;
+                }
+            }
+        }
+        return true;
+    }
+
+    ModelHandle AssetManager::LoadModel(const std::string& filepath) {
+        ModelHandle existing = FindModelByPath(filepath);
+        if (existing != InvalidModelHandle) {
+            PinModel(existing); // May have been streamed in by a world cell
+            return existing;
+        }
+        VKENG_INFO("AssetManager: Loading Model: {}", filepath);
+
+        LoadedModelData loadedCpuData; // Data from ModelLoader
+        AssetHash contentHash = InvalidAssetHash;
+        if (!ImportModel(filepath, loadedCpuData, contentHash)) {
             return InvalidModelHandle;
         }
+        return CreateModelFromImport(filepath, std::move(loadedCpuData), contentHash);
+    }
+
+    ModelHandle AssetManager::CreateModelFromImport(const std::string& filepath, LoadedModelData&& loadedCpuData, AssetHash contentHash,
+                                                    ModelResidency residency /*= ModelResidency::Permanent*/) {
+        std::string canonicalPathStr = CanonicalizePath(filepath);
+        ModelHandle existing = InvalidModelHandle;
+        auto it = m_ModelPathToHandleMap.find(canonicalPathStr);
+        if (it != m_ModelPathToHandleMap.end()) {
+            existing = it->second;
+        } else {
+            // Same content under a different path: share the already-uploaded model.
+            auto hashIt = m_ModelHashToHandleMap.find(contentHash);
+            if (contentHash != InvalidAssetHash && hashIt != m_ModelHashToHandleMap.end()) {
+                m_ModelPathToHandleMap[canonicalPathStr] = hashIt->second;
+                existing = hashIt->second;
+            }
+        }
+        if (existing != InvalidModelHandle) {
+            if (residency == ModelResidency::Permanent) PinModel(existing);
+            return existing;
+        }
 
         std::vector<MaterialHandle> modelMaterialHandles;
         modelMaterialHandles.reserve(loadedCpuData.materialsFromFile.size());
@@ -299,9 +403,11 @@ namespace VulkEng {
         VkDescriptorSetLayout materialSetLayout = renderer.m_MaterialDescriptorSetLayout;
         VkDescriptorPool descriptorPool = renderer.m_DescriptorPool;
 
+        MaterialHandle firstNewMaterial = m_LoadedMaterials.size();
         for (const auto& matSource : loadedCpuData.materialsFromFile) {
             modelMaterialHandles.push_back(ProcessLoadedMaterial(matSource, materialSetLayout, descriptorPool));
         }
+        UploadMaterialParams(firstNewMaterial, m_LoadedMaterials.size() - firstNewMaterial); // One copy for the model's new materials
 
         std::vector<Mesh> gpuMeshes;
         gpuMeshes.reserve(loadedCpuData.meshesForRender.size());
@@ -310,15 +416,137 @@ namespace VulkEng {
             gpuMeshes.push_back(CreateGPUMeshFromData(meshData, modelMaterialHandles));
         }
 
-        ModelHandle newHandle = m_LoadedModels.size();
-        m_LoadedModels.push_back(std::move(gpuMeshes));
+        ModelHandle newHandle;
+        if (!m_FreeModelHandles.empty()) {
+            // Reuse the slot of an unloaded model so streaming doesn't grow the tables.
+            newHandle = m_FreeModelHandles.back();
+            m_FreeModelHandles.pop_back();
+            m_LoadedModels[newHandle] = std::move(gpuMeshes);
+            m_ModelPaths[newHandle] = filepath;
+            m_ModelContentHashes[newHandle] = contentHash;
+            m_ModelRefCounts[newHandle] = 0;
+            m_ModelPinned[newHandle] = residency == ModelResidency::Permanent ? 1 : 0;
+            m_CachedModelData[newHandle] = std::move(loadedCpuData);
+        } else {
+            newHandle = m_LoadedModels.size();
+            m_LoadedModels.push_back(std::move(gpuMeshes));
+            m_ModelPaths.push_back(filepath);
+            m_ModelContentHashes.push_back(contentHash);
+            m_ModelRefCounts.push_back(0);
+            m_ModelPinned.push_back(residency == ModelResidency::Permanent ? 1 : 0);
+            m_CachedModelData.push_back(std::move(loadedCpuData)); // Cache CPU data
+        }
         m_ModelPathToHandleMap[canonicalPathStr] = newHandle;
-        m_CachedModelData.push_back(std::move(loadedCpuData)); // Cache CPU data
+        if (contentHash != InvalidAssetHash) {
+            m_ModelHashToHandleMap[contentHash] = newHandle;
+        }
 
         VKENG_INFO("AssetManager: Successfully loaded model '{}' (Handle: {}).", canonicalPathStr, newHandle);
         return newHandle;
     }
 
+    ModelHandle AssetManager::FindModelByPath(const std::string& filepath) const {
+        auto it = m_ModelPathToHandleMap.find(CanonicalizePath(filepath));
+        return it != m_ModelPathToHandleMap.end() ? it->second : InvalidModelHandle;
+    }
+
+    ModelHandle AssetManager::FindModelByHash(AssetHash contentHash) const {
+        auto it = m_ModelHashToHandleMap.find(contentHash);
+        return it != m_ModelHashToHandleMap.end() ? it->second : InvalidModelHandle;
+    }
+
+    AssetHash AssetManager::GetModelContentHash(ModelHandle handle) const {
+        return handle < m_ModelContentHashes.size() ? m_ModelContentHashes[handle] : InvalidAssetHash;
+    }
+
+    const std::string& AssetManager::GetModelPath(ModelHandle handle) const {
+        static const std::string emptyPath;
+        return handle < m_ModelPaths.size() ? m_ModelPaths[handle] : emptyPath;
+    }
+
+    bool AssetManager::FindMeshSource(const Mesh* mesh, ModelHandle& outModel, uint32_t& outMeshIndex) const {
+        for (ModelHandle handle = 0; handle < m_LoadedModels.size(); ++handle) {
+            const std::vector<Mesh>& meshes = m_LoadedModels[handle];
+            if (!meshes.empty() && mesh >= meshes.data() && mesh < meshes.data() + meshes.size()) {
+                outModel = handle;
+                outMeshIndex = static_cast<uint32_t>(mesh - meshes.data());
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool AssetManager::FindSkeletonSource(const Skeleton* skeleton, ModelHandle& outModel) const {
+        if (!skeleton) return false;
+        for (ModelHandle handle = 0; handle < m_CachedModelData.size(); ++handle) {
+            if (m_CachedModelData[handle].skeleton.get() == skeleton) {
+                outModel = handle;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void AssetManager::AcquireModel(ModelHandle handle) {
+        if (handle >= m_ModelRefCounts.size()) {
+            VKENG_ERROR("AssetManager: Invalid model handle {} passed to AcquireModel.", handle);
+            return;
+        }
+        ++m_ModelRefCounts[handle];
+    }
+
+    void AssetManager::ReleaseModel(ModelHandle handle) {
+        if (handle >= m_ModelRefCounts.size() || m_ModelRefCounts[handle] == 0) {
+            VKENG_ERROR("AssetManager: ReleaseModel called for model handle {} without a matching AcquireModel.", handle);
+            return;
+        }
+        if (--m_ModelRefCounts[handle] == 0 && !m_ModelPinned[handle]) {
+            UnloadModel(handle);
+        }
+    }
+
+    void AssetManager::PinModel(ModelHandle handle) {
+        if (handle >= m_ModelPinned.size()) {
+            VKENG_ERROR("AssetManager: Invalid model handle {} passed to PinModel.", handle);
+            return;
+        }
+        m_ModelPinned[handle] = 1;
+    }
+
+    void AssetManager::UnloadModel(ModelHandle handle) {
+        VKENG_INFO("AssetManager: Unloading model '{}' (Handle: {}).", m_ModelPaths[handle], handle);
+
+        // Meshes may still be referenced by frames in flight; keep their buffers alive a little longer.
+        // Moving the vector keeps its storage, so Mesh pointers held by components stay valid meanwhile.
+        PendingModelRelease release;
+        release.meshes = std::move(m_LoadedModels[handle]);
+        release.retireFrame = m_Context.GetCurrentFrame();
+        m_PendingModelReleases.push_back(std::move(release));
+        m_LoadedModels[handle].clear();
+
+        for (auto it = m_ModelPathToHandleMap.begin(); it != m_ModelPathToHandleMap.end();) {
+            it = (it->second == handle) ? m_ModelPathToHandleMap.erase(it) : std::next(it);
+        }
+        auto hashIt = m_ModelHashToHandleMap.find(m_ModelContentHashes[handle]);
+        if (hashIt != m_ModelHashToHandleMap.end() && hashIt->second == handle) {
+            m_ModelHashToHandleMap.erase(hashIt);
+        }
+        m_ModelPaths[handle].clear();
+        m_ModelContentHashes[handle] = InvalidAssetHash;
+        m_CachedModelData[handle] = LoadedModelData{};
+        // Materials and textures are shared between models and stay resident.
+        m_FreeModelHandles.push_back(handle);
+    }
+
+    void AssetManager::CollectGarbage() {
+        if (m_PendingModelReleases.empty()) return;
+        uint64_t completedFrame = m_Context.GetCompletedFrame(); // One counter query, no waiting
+        m_PendingModelReleases.erase(
+            std::remove_if(m_PendingModelReleases.begin(), m_PendingModelReleases.end(),
+                           [completedFrame](const PendingModelRelease& release) { return release.retireFrame <= completedFrame; }),
+            m_PendingModelReleases.end());
+    }
+
     const std::vector<Mesh>& AssetManager::GetModelMeshes(ModelHandle handle) const {
         if (handle == InvalidModelHandle || handle >= m_LoadedModels.size()) {
             static const std::vector<Mesh> emptyResult;
@@ -348,20 +576,35 @@ namespace VulkEng {
             return matIt->second;
         }
 
+        if (m_LoadedMaterials.size() >= MaxMaterials) {
+            VKENG_ERROR("AssetManager: Material limit ({}) reached; '{}' uses the default material.", MaxMaterials, matDataSource.name);
+            return GetDefaultMaterial();
+        }
+        MaterialHandle newHandle = m_LoadedMaterials.size();
+
         Material newMaterial(matDataSource.name); // Use constructor with name
         newMaterial.baseColorFactor = matDataSource.baseColorFactor;
-
-        if (!matDataSource.diffuseTexturePath.empty()) {
-            newMaterial.diffuseTexture = LoadTexture(matDataSource.diffuseTexturePath, true); // Generate mips
-            if (newMaterial.diffuseTexture == InvalidTextureHandle) {
-                newMaterial.diffuseTexture = GetDefaultWhiteTexture();
-            }
-        } else {
+        newMaterial.metallicFactor = matDataSource.metallicFactor;
+        newMaterial.roughnessFactor = matDataSource.roughnessFactor;
+        newMaterial.emissiveFactor = matDataSource.emissiveFactor;
+        newMaterial.occlusionStrength = matDataSource.occlusionStrength;
+        newMaterial.normalScale = matDataSource.normalScale;
+
+        newMaterial.alphaMode = matDataSource.alphaMode;
+        newMaterial.alphaCutoff = matDataSource.alphaCutoff;
+        newMaterial.doubleSided = matDataSource.doubleSided;
+
+        newMaterial.diffuseTexture = LoadMaterialTexture(matDataSource, matDataSource.diffuseTexturePath, true);
+        if (newMaterial.diffuseTexture == InvalidTextureHandle) {
             newMaterial.diffuseTexture = GetDefaultWhiteTexture();
         }
-        // TODO: Process other textures (normal, metallicRoughness etc.) from matDataSource
+        // Optional maps stay invalid when missing, which leaves their feature (and its shader cost) out.
+        newMaterial.normalTexture = LoadMaterialTexture(matDataSource, matDataSource.normalTexturePath, false);
+        newMaterial.metallicRoughnessTexture = LoadMaterialTexture(matDataSource, matDataSource.metallicRoughnessTexturePath, false);
+        newMaterial.ambientOcclusionTexture = LoadMaterialTexture(matDataSource, matDataSource.aoTexturePath, false);
+        newMaterial.emissiveTexture = LoadMaterialTexture(matDataSource, matDataSource.emissiveTexturePath, true);
 
-        // Allocate and Update Descriptor Set for this Material's texture
+        // Allocate and Update Descriptor Set for this Material's textures
         if (materialSetLayout != VK_NULL_HANDLE && descriptorPool != VK_NULL_HANDLE) {
             VkDescriptorSetAllocateInfo allocInfo{VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO};
             allocInfo.descriptorPool = descriptorPool;
@@ -370,39 +613,93 @@ namespace VulkEng {
 
             VkResult result = vkAllocateDescriptorSets(m_Context.device, &allocInfo, &newMaterial.descriptorSet);
             if (result == VK_SUCCESS && newMaterial.descriptorSet != VK_NULL_HANDLE) {
-                const Texture& textureToBind = GetTexture(newMaterial.diffuseTexture);
-                VkDescriptorImageInfo imageInfo{};
-                imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-                imageInfo.imageView = textureToBind.imageView;
-                imageInfo.sampler = textureToBind.sampler;
-
-                VkWriteDescriptorSet write{VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
-                write.dstSet = newMaterial.descriptorSet;
-                write.dstBinding = 0; // Binding 0 in Material Layout (Set 1) for diffuse texture
-                write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-                write.descriptorCount = 1;
-                write.pImageInfo = &imageInfo;
-                vkUpdateDescriptorSets(m_Context.device, 1, &write, 0, nullptr);
+                WriteMaterialDescriptorSet(newMaterial, newHandle);
             } else {
                 VKENG_ERROR("AssetManager: Failed to allocate/update descriptor set for material '{}'. Result: {}", newMaterial.name, result);
-                newMaterial.descriptorSet = VK_NULL_HANDLE; // Mark as invalid
-                // Potentially assign default material's descriptor set if available
-                newMaterial.diffuseTexture = GetDefaultWhiteTexture(); // Fallback texture
+                // Fall back to the default material's set and textures (and so its features)
                 const Material& defaultMat = GetMaterial(GetDefaultMaterial());
+                newMaterial.diffuseTexture = defaultMat.diffuseTexture;
+                newMaterial.normalTexture = newMaterial.metallicRoughnessTexture = InvalidTextureHandle;
+                newMaterial.ambientOcclusionTexture = newMaterial.emissiveTexture = InvalidTextureHandle;
                 newMaterial.descriptorSet = defaultMat.descriptorSet;
             }
         } else {
              VKENG_ERROR("AssetManager: Material layout or descriptor pool is NULL for material '{}'.", newMaterial.name);
+             newMaterial.normalTexture = newMaterial.metallicRoughnessTexture = InvalidTextureHandle;
+             newMaterial.ambientOcclusionTexture = newMaterial.emissiveTexture = InvalidTextureHandle;
              newMaterial.descriptorSet = GetMaterial(GetDefaultMaterial()).descriptorSet; // Use default material's set
         }
 
-        MaterialHandle newHandle = m_LoadedMaterials.size();
         m_LoadedMaterials.push_back(std::move(newMaterial));
-        m_MaterialNameToHandleMap[newMaterial.name] = newHandle;
-        return newHandle;
+        m_MaterialNameToHandleMap[m_LoadedMaterials.back().name] = newHandle;
+        return newHandle; // Its params are uploaded by the caller, with the rest of the model's
     }
 
 
+    TextureHandle AssetManager::LoadMaterialTexture(const MaterialDataSource& matDataSource, const std::string& path, bool srgb) {
+        if (path.empty()) return InvalidTextureHandle;
+        auto decoded = matDataSource.decodedTextures.find(path);
+        return decoded != matDataSource.decodedTextures.end()
+            ? CreateTextureFromDecoded(path, *decoded->second, true, srgb)
+            : LoadTexture(path, true, srgb); // Generate mips
+    }
+
+    void AssetManager::WriteMaterialDescriptorSet(const Material& material, MaterialHandle handle) {
+        std::array<TextureHandle, MaterialTextureBindingCount> textures{};
+        textures[MaterialBaseColorBinding] = material.diffuseTexture;
+        textures[MaterialNormalBinding] = material.normalTexture;
+        textures[MaterialMetallicRoughnessBinding] = material.metallicRoughnessTexture;
+        textures[MaterialOcclusionBinding] = material.ambientOcclusionTexture;
+        textures[MaterialEmissiveBinding] = material.emissiveTexture;
+
+        std::array<VkDescriptorImageInfo, MaterialTextureBindingCount> imageInfos{};
+        std::array<VkWriteDescriptorSet, MaterialTextureBindingCount + 1> writes{};
+        for (uint32_t binding = 0; binding < MaterialTextureBindingCount; ++binding) {
+            // Variants without a map don't sample its binding, but it still needs a valid descriptor.
+            const Texture& texture = GetTexture(textures[binding] != InvalidTextureHandle ? textures[binding] : GetDefaultWhiteTexture());
+            imageInfos[binding].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            imageInfos[binding].imageView = texture.imageView;
+            imageInfos[binding].sampler = texture.sampler;
+
+            writes[binding] = {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
+            writes[binding].dstSet = material.descriptorSet;
+            writes[binding].dstBinding = binding;
+            writes[binding].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            writes[binding].descriptorCount = 1;
+            writes[binding].pImageInfo = &imageInfos[binding];
+        }
+
+        VkDescriptorBufferInfo paramsInfo = m_MaterialParamsBuffer->GetDescriptorInfo(
+            sizeof(MaterialParams), handle * m_MaterialParamsBuffer->GetAlignmentSize());
+        VkWriteDescriptorSet& paramsWrite = writes[MaterialParamsBinding];
+        paramsWrite = {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
+        paramsWrite.dstSet = material.descriptorSet;
+        paramsWrite.dstBinding = MaterialParamsBinding;
+        paramsWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        paramsWrite.descriptorCount = 1;
+        paramsWrite.pBufferInfo = &paramsInfo;
+        vkUpdateDescriptorSets(m_Context.device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+    }
+
+    void AssetManager::UploadMaterialParams(MaterialHandle first, size_t count) {
+        if (count == 0) return;
+        // Slots of new materials aren't read by any frame in flight yet, so they can be written directly.
+        VkDeviceSize stride = m_MaterialParamsBuffer->GetAlignmentSize();
+        auto stagingBuffer = std::make_unique<VulkanBuffer>(m_Context, stride * count, 1,
+                                                            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                                            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        stagingBuffer->Map();
+        for (size_t i = 0; i < count; ++i) {
+            MaterialParams params = m_LoadedMaterials[first + i].GetParams();
+            stagingBuffer->WriteToBuffer(&params, sizeof(params), stride * i);
+        }
+        stagingBuffer->Unmap();
+        ImmediateContext::Recording recording = m_CommandManager.GetImmediateContext().Record();
+        Utils::RecordCopyBuffer(recording.GetCommandBuffer(), stagingBuffer->GetBuffer(), m_MaterialParamsBuffer->GetBuffer(),
+                                stride * count, 0, stride * first);
+        recording.KeepAlive(std::move(stagingBuffer));
+    }
+
     Mesh AssetManager::CreateGPUMeshFromData(const MeshData& meshData, const std::vector<MaterialHandle>& materialHandlesForModel) {
         Mesh gpuMesh;
         gpuMesh.name = meshData.name;
@@ -411,12 +708,24 @@ namespace VulkEng {
         gpuMesh.vertexBuffer = CreateDeviceLocalBuffer(meshData.vertices.data(), vertexBufferSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
         gpuMesh.vertexCount = static_cast<uint32_t>(meshData.vertices.size());
         gpuMesh.vertexBufferOffset = 0;
+        if (!meshData.vertices.empty()) {
+            gpuMesh.boundsMin = gpuMesh.boundsMax = meshData.vertices[0].position;
+            for (const Vertex& vertex : meshData.vertices) {
+                gpuMesh.boundsMin = glm::min(gpuMesh.boundsMin, vertex.position);
+                gpuMesh.boundsMax = glm::max(gpuMesh.boundsMax, vertex.position);
+            }
+        }
 
         VkDeviceSize indexBufferSize = sizeof(uint32_t) * meshData.indices.size();
         gpuMesh.indexBuffer = CreateDeviceLocalBuffer(meshData.indices.data(), indexBufferSize, VK_BUFFER_USAGE_INDEX_BUFFER_BIT);
         gpuMesh.indexCount = static_cast<uint32_t>(meshData.indices.size());
         gpuMesh.indexBufferOffset = 0;
 
+        if (!meshData.skinVertices.empty()) {
+            gpuMesh.skinBuffer = CreateDeviceLocalBuffer(meshData.skinVertices.data(), sizeof(SkinVertex) * meshData.skinVertices.size(),
+                                                         VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
+        }
+
         if (meshData.materialIndex < materialHandlesForModel.size()) {
             gpuMesh.material = materialHandlesForModel[meshData.materialIndex];
         } else {
@@ -431,18 +740,62 @@ namespace VulkEng {
             VKENG_ERROR("AssetManager::CreateDeviceLocalBuffer: Invalid data or zero buffer size.");
             return nullptr; // Or throw
         }
-        VulkanBuffer stagingBuffer(m_Context, bufferSize, 1,
-                                   VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                                   VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-        stagingBuffer.WriteToBuffer(data, bufferSize);
+        // With resizable BAR (or unified memory) the CPU writes the GPU-local buffer directly: no staging
+        // allocation, no copy command. The buffer is new, so no in-flight work can be reading it.
+        if (m_Context.hostVisibleDeviceMemory) {
+            auto directBuffer = std::make_unique<VulkanBuffer>(
+                m_Context, bufferSize, 1,
+                usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+            directBuffer->WriteToBuffer(data, bufferSize); // Streaming stores for large meshes
+            return directBuffer;
+        }
+        auto stagingBuffer = std::make_unique<VulkanBuffer>(m_Context, bufferSize, 1,
+                                                            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                                            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        stagingBuffer->WriteToBuffer(data, bufferSize);
 
         auto deviceBuffer = std::make_unique<VulkanBuffer>(
             m_Context, bufferSize, 1,
             usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
             VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
 
-        Utils::CopyBuffer(m_Context.device, m_CommandManager.GetCommandPool(), m_Context.graphicsQueue,
-                          stagingBuffer.GetBuffer(), deviceBuffer->GetBuffer(), bufferSize);
+        // Geometry is copied on the dedicated transfer queue (DMA engine) when there is one, then handed
+        // over to the graphics queue, whose upload batch waits for the copy before acquiring it.
+        VkPipelineStageFlags acquireStages = 0;
+        VkAccessFlags acquireAccess = 0;
+        if (usage & VK_BUFFER_USAGE_VERTEX_BUFFER_BIT) {
+            acquireStages |= VK_PIPELINE_STAGE_VERTEX_INPUT_BIT;
+            acquireAccess |= VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT;
+        }
+        if (usage & VK_BUFFER_USAGE_INDEX_BUFFER_BIT) {
+            acquireStages |= VK_PIPELINE_STAGE_VERTEX_INPUT_BIT;
+            acquireAccess |= VK_ACCESS_INDEX_READ_BIT;
+        }
+        ImmediateContext* transferContext = acquireStages ? m_CommandManager.GetTransferContext() : nullptr;
+        if (transferContext) {
+            uint32_t transferFamily = m_Context.GetQueueFamily(QueueType::Transfer);
+            uint32_t graphicsFamily = m_Context.GetQueueFamily(QueueType::Graphics);
+            uint64_t transferBatch = 0;
+            {
+                ImmediateContext::Recording recording = transferContext->Record();
+                Utils::RecordCopyBuffer(recording.GetCommandBuffer(), stagingBuffer->GetBuffer(), deviceBuffer->GetBuffer(), bufferSize);
+                Utils::ReleaseBufferOwnership(recording.GetCommandBuffer(), deviceBuffer->GetBuffer(), transferFamily, graphicsFamily,
+                                              VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT);
+                recording.KeepAlive(std::move(stagingBuffer));
+                transferBatch = recording.GetBatch();
+            } // Unlocked before the graphics batch, which takes the transfer context's lock when submitted
+
+            ImmediateContext::Recording recording = m_CommandManager.GetImmediateContext().Record();
+            recording.WaitFor(*transferContext, transferBatch, acquireStages);
+            Utils::AcquireBufferOwnership(recording.GetCommandBuffer(), deviceBuffer->GetBuffer(), transferFamily, graphicsFamily,
+                                          acquireStages, acquireAccess);
+            return deviceBuffer;
+        }
+
+        ImmediateContext::Recording recording = m_CommandManager.GetImmediateContext().Record();
+        Utils::RecordCopyBuffer(recording.GetCommandBuffer(), stagingBuffer->GetBuffer(), deviceBuffer->GetBuffer(), bufferSize);
+        recording.KeepAlive(std::move(stagingBuffer));
         return deviceBuffer;
     }
 
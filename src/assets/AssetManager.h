@@ -11,6 +11,7 @@
 #include <memory>        // For std::unique_ptr
 #include <unordered_map> // For caching assets by path/name
 #include <filesystem>    // For path manipulation (C++17)
+#include <cstdint>       // For AssetHash
 
 namespace VulkEng {
 
@@ -19,14 +20,26 @@ namespace VulkEng {
     class CommandManager;
     class VulkanBuffer; // Used internally for GPU buffers
 
-    // Handle types (already defined in their respective headers, but good for context)
-    // using ModelHandle = size_t;
+    // Handle types (Material/Texture handles are defined in their respective headers)
+    using ModelHandle = size_t;
     // using MaterialHandle = size_t;
     // using TextureHandle = size_t;
-    // const ModelHandle InvalidModelHandle = static_cast<ModelHandle>(-1);
+    const ModelHandle InvalidModelHandle = static_cast<ModelHandle>(-1);
     // const MaterialHandle InvalidMaterialHandle = static_cast<MaterialHandle>(-1);
     // const TextureHandle InvalidTextureHandle = static_cast<TextureHandle>(-1);
 
+    // Content hash of an asset's source file (FNV-1a 64 of its bytes). Stable across runs and
+    // machines, so serialized scenes can reference assets independently of where they live on disk.
+    using AssetHash = uint64_t;
+    const AssetHash InvalidAssetHash = 0;
+
+    // Whether a model created by AssetManager::CreateModelFromImport stays resident for good or
+    // is unloaded once the references taken with AcquireModel are released.
+    enum class ModelResidency : uint8_t {
+        Permanent, // Pinned; Acquire/Release never unload it
+        Streamed,  // Lives while acquired; the caller must Acquire (or Pin) it
+    };
+
 
     // Manages loading, storage, and retrieval of game assets like models, textures, materials.
     // Handles GPU resource creation for these assets.
@@ -51,12 +64,56 @@ namespace VulkEng {
         // Retrieves the raw LoadedModelData (CPU-side) for a model, e.g., for physics.
         const LoadedModelData* GetLoadedModelData(ModelHandle handle) const;
 
+        // Split model loading for parallel resolution (used by scene streaming):
+        // ImportModel is the CPU half (Assimp import + content hash). It touches no AssetManager
+        // state and may run on worker threads. CreateModelFromImport is the GPU half and must
+        // run on the main thread; it returns the existing handle if the model is already loaded
+        // (pinning it when `residency` is Permanent).
+        // With `decodeTextures`, the import also decodes the materials' textures, so only the
+        // upload is left for the main thread.
+        static bool ImportModel(const std::string& filepath, LoadedModelData& outModelData, AssetHash& outContentHash,
+                                bool decodeTextures = false);
+        ModelHandle CreateModelFromImport(const std::string& filepath, LoadedModelData&& modelData, AssetHash contentHash,
+                                          ModelResidency residency = ModelResidency::Permanent);
+
+        // Lookups for already-loaded models. Return InvalidModelHandle if not loaded.
+        ModelHandle FindModelByPath(const std::string& filepath) const;
+        ModelHandle FindModelByHash(AssetHash contentHash) const;
+        AssetHash GetModelContentHash(ModelHandle handle) const;
+        const std::string& GetModelPath(ModelHandle handle) const;
+        // Finds which model (and which sub-mesh of it) a GPU Mesh pointer belongs to.
+        bool FindMeshSource(const Mesh* mesh, ModelHandle& outModel, uint32_t& outMeshIndex) const;
+        // Finds which model a Skeleton (shared with AnimatorComponents) was imported with.
+        bool FindSkeletonSource(const Skeleton* skeleton, ModelHandle& outModel) const;
+
+        // Hashes a file's contents. Returns InvalidAssetHash if the file cannot be read.
+        static AssetHash HashFileContents(const std::string& filepath);
+
+        // --- Model Lifetime (streaming) ---
+        // Pinned models (LoadModel, Permanent imports, PinModel) stay resident for the AssetManager's
+        // lifetime, however they are acquired and released. A Streamed model is unloaded when its last
+        // reference is released, freeing its handle for reuse. Its GPU buffers are kept until
+        // CollectGarbage sees that the frame being recorded at unload time (the last that could
+        // reference them) has completed on the GPU.
+        void AcquireModel(ModelHandle handle);
+        void ReleaseModel(ModelHandle handle);
+        // Keeps a resident model loaded for good, e.g. when content that is never unloaded uses it.
+        void PinModel(ModelHandle handle);
+        // Call once per frame (after the frame's commands have been submitted).
+        void CollectGarbage();
+        size_t GetResidentModelCount() const { return m_LoadedModels.size() - m_FreeModelHandles.size(); }
+
 
         // --- Texture Loading ---
         // Loads a texture from the specified file path.
         // `generateMips`: If true, mipmaps will be generated for the texture.
+        // `srgb`: Color data (sRGB format); false for data maps such as normals or roughness.
         // Returns a TextureHandle to reference the loaded texture.
-        TextureHandle LoadTexture(const std::string& filepath, bool generateMips = true);
+        TextureHandle LoadTexture(const std::string& filepath, bool generateMips = true, bool srgb = true);
+        // Split texture loading, like ImportModel/CreateModelFromImport: DecodeTexture is thread-safe,
+        // CreateTextureFromDecoded uploads on the main thread (or returns the already-loaded handle).
+        static bool DecodeTexture(const std::string& filepath, DecodedTexture& outTexture);
+        TextureHandle CreateTextureFromDecoded(const std::string& filepath, const DecodedTexture& decoded, bool generateMips = true, bool srgb = true);
         // Retrieves a reference to a loaded Texture struct by its handle.
         const Texture& GetTexture(TextureHandle handle) const;
 
@@ -87,13 +144,23 @@ namespace VulkEng {
             VkDescriptorPool descriptorPool         // Pool to allocate from
         );
 
+        // Loads one of a material's maps (from its decoded pixels if the import has them);
+        // InvalidTextureHandle if `path` is empty or fails to load.
+        TextureHandle LoadMaterialTexture(const MaterialDataSource& matDataSource, const std::string& path, bool srgb);
+        // Points every binding of the material's Set 1 at its textures (the default white texture
+        // for maps it doesn't have) and at the material buffer slot of `handle`.
+        void WriteMaterialDescriptorSet(const Material& material, MaterialHandle handle);
+        // Copies the MaterialParams of materials [first, first + count) to their material buffer slots.
+        void UploadMaterialParams(MaterialHandle first, size_t count);
+
         // Creates a GPU Mesh object from CPU-side MeshData.
         // This involves creating and populating vertex and index buffers.
         // `materialHandlesForModel` maps Assimp material indices to engine MaterialHandles.
         Mesh CreateGPUMeshFromData(const MeshData& meshData, const std::vector<MaterialHandle>& materialHandlesForModel);
 
-        // Creates a device-local GPU buffer (e.g., for vertices, indices)
-        // by first copying data to a host-visible staging buffer.
+        // Creates a device-local GPU buffer (e.g., for vertices, indices): written directly when the
+        // device exposes host-visible VRAM, else through a staging buffer and a batched copy (on the
+        // transfer queue for vertex and index data, if the device has one).
         std::unique_ptr<VulkanBuffer> CreateDeviceLocalBuffer(
             const void* data,            // Pointer to raw data
             VkDeviceSize bufferSize,     // Total size of the data
@@ -103,6 +170,14 @@ namespace VulkEng {
         // Initializes default assets like a 1x1 white texture and a default material.
         void CreateDefaultAssets();
 
+        // Normalizes a path for use as a cache key (weakly canonical, forward slashes).
+        static std::string CanonicalizePath(const std::string& filepath);
+        // Texture cache key: the canonical path, tagged when the texture is loaded as linear data.
+        static std::string TextureCacheKey(const std::string& canonicalPath, bool srgb);
+
+        // Drops a model from the caches and queues its GPU data for deferred destruction.
+        void UnloadModel(ModelHandle handle);
+
 
         // --- Member Variables ---
         VulkanContext& m_Context;         // Reference to the Vulkan context
@@ -116,12 +191,28 @@ namespace VulkEng {
         std::vector<LoadedModelData> m_CachedModelData;
         // All unique materials created by the engine.
         std::vector<Material> m_LoadedMaterials;
+        // MaterialParams of every material, one aligned slot per MaterialHandle (MaxMaterials slots).
+        std::unique_ptr<VulkanBuffer> m_MaterialParamsBuffer;
         // All unique textures loaded by the engine.
         std::vector<Texture> m_LoadedTextures;
 
         // --- Caching Maps (Path/Name to Handle) ---
         // Ensures assets are not loaded multiple times if requested by the same path/name.
         std::unordered_map<std::string, ModelHandle> m_ModelPathToHandleMap;
+        std::unordered_map<AssetHash, ModelHandle> m_ModelHashToHandleMap;
+        // Per-model source path and content hash, indexed by ModelHandle.
+        std::vector<std::string> m_ModelPaths;
+        std::vector<AssetHash> m_ModelContentHashes;
+        std::vector<uint32_t> m_ModelRefCounts;
+        std::vector<uint8_t> m_ModelPinned;          // Non-zero: never unloaded by ReleaseModel
+        std::vector<ModelHandle> m_FreeModelHandles; // Handles of unloaded models, reused first
+
+        // GPU meshes of unloaded models, destroyed once frame `retireFrame` has completed.
+        struct PendingModelRelease {
+            std::vector<Mesh> meshes;
+            uint64_t retireFrame = 0; // VulkanContext frame timeline value
+        };
+        std::vector<PendingModelRelease> m_PendingModelReleases;
         std::unordered_map<std::string, MaterialHandle> m_MaterialNameToHandleMap; // Assumes material names from file are somewhat unique
         std::unordered_map<std::string, TextureHandle> m_TexturePathToHandleMap;
 
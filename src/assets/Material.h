@@ -3,11 +3,56 @@
 #include "Texture.h" // For TextureHandle and InvalidTextureHandle
 #include <glm/glm.hpp>
 #include <vulkan/vulkan.h> // For VkDescriptorSet
+#include <cstdint>
 #include <string>
 #include <vector> // Potentially for multiple textures of the same type
 
 namespace VulkEng {
 
+    // Optional shading features of a material. Each combination selects a variant of simple.frag and
+    // a pipeline permutation (built on first use by the Renderer), so a material only pays for the
+    // maps it actually has.
+    using MaterialFeatureMask = uint32_t;
+    namespace MaterialFeature {
+        enum : MaterialFeatureMask {
+            NormalMap            = 1u << 0, // Shader define NORMAL_MAP
+            MetallicRoughnessMap = 1u << 1, // METALLIC_ROUGHNESS_MAP
+            OcclusionMap         = 1u << 2, // OCCLUSION_MAP
+            EmissiveMap          = 1u << 3, // EMISSIVE_MAP
+            AlphaMask            = 1u << 4, // ALPHA_MASK (cutoff is a specialization constant)
+            DoubleSided          = 1u << 5, // Pipeline state only: no back-face culling
+            AlphaBlend           = 1u << 6, // Pipeline state only: blended in the transparent pass, no depth writes
+        };
+        constexpr uint32_t ShaderFeatureCount = 5; // Features above that are shader defines
+    }
+
+    // Bindings of the material descriptor set (Set 1). Slots for maps a material doesn't have hold
+    // the default white texture, so every material shares one set layout.
+    enum MaterialTextureBinding : uint32_t {
+        MaterialBaseColorBinding = 0,
+        MaterialNormalBinding,
+        MaterialMetallicRoughnessBinding,
+        MaterialOcclusionBinding,
+        MaterialEmissiveBinding,
+        MaterialTextureBindingCount
+    };
+    // Set 1 also holds the material's MaterialParams: its slot of AssetManager's material buffer.
+    constexpr uint32_t MaterialParamsBinding = MaterialTextureBindingCount;
+    // Material descriptor sets and material buffer slots available (sizes the Renderer's descriptor pool).
+    constexpr uint32_t MaxMaterials = 1000;
+
+    // A material's factors as the shaders read them (MaterialParams in simple.frag, std430 layout).
+    // Packed once when the material is created; drawing never updates it.
+    struct MaterialParams {
+        glm::vec4 baseColorFactor;
+        glm::vec4 emissiveFactor; // rgb; w unused
+        float metallicFactor;
+        float roughnessFactor;
+        float occlusionStrength;
+        float normalScale;
+    };
+    static_assert(sizeof(MaterialParams) == 48, "MaterialParams must match the std430 layout in simple.frag");
+
     // Represents material properties for rendering a mesh.
     // This can include texture handles, color factors, and PBR parameters.
     struct Material {
@@ -18,7 +63,7 @@ namespace VulkEng {
         TextureHandle diffuseTexture = InvalidTextureHandle;    // Also known as Albedo or Base Color map
         TextureHandle normalTexture = InvalidTextureHandle;     // Normal map for surface detail
         // TextureHandle specularTexture = InvalidTextureHandle; // For older specular/gloss workflows
-        // TextureHandle emissiveTexture = InvalidTextureHandle;   // For self-illuminating parts
+        TextureHandle emissiveTexture = InvalidTextureHandle;   // For self-illuminating parts
 
         // --- PBR (Physically Based Rendering) Texture Handles & Factors ---
         // Often, metallic and roughness are packed into a single texture (e.g., GLTF standard).
@@ -29,10 +74,11 @@ namespace VulkEng {
         // --- Color Factors & Scalar Properties ---
         // These are used if corresponding textures are not provided, or to modulate texture values.
         glm::vec4 baseColorFactor = glm::vec4(1.0f, 1.0f, 1.0f, 1.0f); // RGBA, default white
-        float metallicFactor = 1.0f;    // Range [0, 1]. Default 1 for dielectrics if no map, or based on model.
-                                        // For metals, this is often 1.0.
-        float roughnessFactor = 1.0f;   // Range [0, 1]. Default 1 for rough if no map.
-        glm::vec3 emissiveFactor = glm::vec3(0.0f, 0.0f, 0.0f); // Emissive color if no emissive map
+        float metallicFactor = 1.0f;    // Range [0, 1]; glTF default. Multiplies the map's blue channel.
+        float roughnessFactor = 1.0f;   // Range [0, 1]; glTF default. Multiplies the map's green channel.
+        glm::vec3 emissiveFactor = glm::vec3(0.0f, 0.0f, 0.0f); // Multiplies the emissive map (if any)
+        float occlusionStrength = 1.0f; // How much of the occlusion map applies
+        float normalScale = 1.0f;       // Scales the normal map's tangent-space X and Y
 
         // Alpha properties
         enum class AlphaMode { OPAQUE, MASK, BLEND };
@@ -46,8 +92,22 @@ namespace VulkEng {
         // This set would typically be bound at Set Index 1 in the pipeline layout.
         VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
 
-        // Optional: Shader identifier or parameters to select/configure shader variations
-        // std::string shaderName = "PBR_MetallicRoughness";
+        // Shader and pipeline features this material needs; see MaterialFeature.
+        MaterialFeatureMask GetFeatures() const {
+            MaterialFeatureMask features = 0;
+            if (normalTexture != InvalidTextureHandle) features |= MaterialFeature::NormalMap;
+            if (metallicRoughnessTexture != InvalidTextureHandle) features |= MaterialFeature::MetallicRoughnessMap;
+            if (ambientOcclusionTexture != InvalidTextureHandle) features |= MaterialFeature::OcclusionMap;
+            if (emissiveTexture != InvalidTextureHandle) features |= MaterialFeature::EmissiveMap;
+            if (alphaMode == AlphaMode::MASK) features |= MaterialFeature::AlphaMask;
+            if (alphaMode == AlphaMode::BLEND) features |= MaterialFeature::AlphaBlend;
+            if (doubleSided) features |= MaterialFeature::DoubleSided;
+            return features;
+        }
+
+        MaterialParams GetParams() const {
+            return {baseColorFactor, glm::vec4(emissiveFactor, 0.0f), metallicFactor, roughnessFactor, occlusionStrength, normalScale};
+        }
 
         // Default constructor
         Material() = default;
@@ -60,6 +60,32 @@ namespace VulkEng {
         return attributeDescriptions;
     }
 
+    VkVertexInputBindingDescription SkinVertex::getBindingDescription() {
+        VkVertexInputBindingDescription bindingDescription{};
+        bindingDescription.binding = 1; // Second stream next to the regular Vertex data
+        bindingDescription.stride = sizeof(SkinVertex);
+        bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+        return bindingDescription;
+    }
+
+    std::vector<VkVertexInputAttributeDescription> SkinVertex::getAttributeDescriptions() {
+        std::vector<VkVertexInputAttributeDescription> attributeDescriptions(2);
+
+        // Attribute 5: Joint indices (uvec4 in shader)
+        attributeDescriptions[0].binding = 1;
+        attributeDescriptions[0].location = 5;
+        attributeDescriptions[0].format = VK_FORMAT_R8G8B8A8_UINT;
+        attributeDescriptions[0].offset = offsetof(SkinVertex, joints);
+
+        // Attribute 6: Joint weights (vec4 in shader, normalized to [0, 1])
+        attributeDescriptions[1].binding = 1;
+        attributeDescriptions[1].location = 6;
+        attributeDescriptions[1].format = VK_FORMAT_R8G8B8A8_UNORM;
+        attributeDescriptions[1].offset = offsetof(SkinVertex, weights);
+
+        return attributeDescriptions;
+    }
+
 } // namespace VulkEng
 
 
@@ -4,6 +4,7 @@
 
 #include <glm/glm.hpp>
 #include <vulkan/vulkan.h> // For Vulkan types (VkBuffer, VkDeviceSize, etc.)
+#include <cstdint>
 #include <vector>
 #include <memory>    // For std::shared_ptr (used for VulkanBuffer)
 #include <string>    // For potential mesh name
@@ -30,6 +31,16 @@ namespace VulkEng {
         static std::vector<VkVertexInputAttributeDescription> getAttributeDescriptions();
     };
 
+    // Per-vertex skinning data for skinned meshes, kept in its own vertex stream (binding 1 of the
+    // skinned pipeline) so static meshes don't pay for it. Up to four joints per vertex.
+    struct SkinVertex {
+        uint8_t joints[4] = {0, 0, 0, 0};  // Skeleton joint indices (so at most 256 joints per skeleton)
+        uint8_t weights[4] = {0, 0, 0, 0}; // Normalized to sum to 255
+
+        static VkVertexInputBindingDescription getBindingDescription();
+        static std::vector<VkVertexInputAttributeDescription> getAttributeDescriptions(); // Locations 5-6
+    };
+
     // Holds CPU-side mesh data as loaded from a model file (e.g., by Assimp).
     // This data is then used to create GPU buffers (VulkanBuffer).
     struct MeshData {
@@ -39,6 +50,7 @@ namespace VulkEng {
         unsigned int materialIndex = 0;        // Index into the model's original material list (used by ModelLoader/AssetManager)
                                                // This is an index from the source file (e.g. Assimp's material array).
                                                // AssetManager will convert this to an engine MaterialHandle.
+        std::vector<SkinVertex> skinVertices;  // Parallel to `vertices`; empty for static meshes
         // Optional: Bounding box calculated on CPU
         // glm::vec3 minBounds, maxBounds;
     };
@@ -59,15 +71,15 @@ namespace VulkEng {
         VkDeviceSize indexBufferOffset = 0;         // Offset into the indexBuffer
         uint32_t indexCount = 0;                    // Number of indices in this mesh
 
+        // Skinning stream (SkinVertex per vertex); null for static meshes
+        std::shared_ptr<VulkanBuffer> skinBuffer;
+
         // Material
         MaterialHandle material = InvalidMaterialHandle; // Handle to the Material used by this mesh
 
-        // Optional: Bounding box (Axis-Aligned Bounding Box) for frustum culling
-        // This would typically be calculated from vertex data.
-        // struct AABB {
-        //     glm::vec3 min = glm::vec3(std::numeric_limits<float>::max());
-        //     glm::vec3 max = glm::vec3(std::numeric_limits<float>::lowest());
-        // } boundingBox;
+        // Local-space axis-aligned bounds of the vertices, for culling.
+        glm::vec3 boundsMin = glm::vec3(0.0f);
+        glm::vec3 boundsMax = glm::vec3(0.0f);
     };
 
 } // namespace VulkEng
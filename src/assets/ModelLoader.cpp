@@ -1,13 +1,22 @@
 #include "ModelLoader.h"
 #include "core/Log.h"       // For logging loading progress and errors
+#include "animation/Skeleton.h"
+#include "animation/AnimationClip.h"
 
 #include <assimp/Importer.hpp>      // Assimp's C++ Importer interface
 #include <assimp/scene.h>           // For aiScene, aiNode, aiMesh, aiMaterial
 #include <assimp/postprocess.h>   // For post-processing flags
 #include <assimp/material.h>      // For aiMaterialKeys and aiGetMaterialTexture
+#include <assimp/GltfMaterial.h>  // For AI_MATKEY_GLTF_ALPHAMODE / ALPHACUTOFF / TEXTURE_SCALE
 
 #include <filesystem> // For robust path handling (C++17)
-#include <algorithm>  // For std::replace
+#include <algorithm>  // For std::replace, std::clamp
+#include <cmath>      // For std::pow
+#include <array>
+#include <functional> // For recursive node walks
+#include <unordered_map>
+#include <unordered_set>
+#include <glm/gtc/type_ptr.hpp> // For glm::make_mat4
 
 namespace VulkEng {
 
@@ -43,7 +52,8 @@ namespace VulkEng {
                                      aiProcess_SortByPType |
                                      aiProcess_ValidateDataStructure |
                                      aiProcess_OptimizeMeshes |
-                                     aiProcess_ImproveCacheLocality;
+                                     aiProcess_ImproveCacheLocality |
+                                     aiProcess_LimitBoneWeights; // At most 4 weights per vertex (SkinVertex)
 
         const aiScene* scene = importer.ReadFile(filepath, ppsteps);
 
@@ -69,6 +79,8 @@ namespace VulkEng {
         outModelData.materialsFromFile.clear();
         outModelData.allVerticesPhysics.clear();
         outModelData.allIndicesPhysics.clear();
+        outModelData.skeleton.reset();
+        outModelData.animations.clear();
 
         // 1. Process all materials defined in the scene
         if (scene->HasMaterials()) {
@@ -82,6 +94,18 @@ namespace VulkEng {
             VKENG_INFO("ModelLoader: Model has no embedded materials.");
         }
 
+        // Skeleton first: mesh processing maps bone weights to its joint indices.
+        std::shared_ptr<Skeleton> skeleton = ProcessAssimpSkeleton(scene);
+        outModelData.skeleton = skeleton;
+        if (skeleton && scene->HasAnimations()) {
+            for (unsigned int i = 0; i < scene->mNumAnimations; ++i) {
+                if (auto clip = ProcessAssimpAnimation(scene->mAnimations[i], *skeleton)) {
+                    outModelData.animations.push_back(std::move(clip));
+                }
+            }
+            VKENG_INFO("ModelLoader: Skeleton with {} joints, {} animation(s).", skeleton->GetJointCount(), outModelData.animations.size());
+        }
+
         // 2. Recursively process the scene graph starting from the root node
         VKENG_INFO("ModelLoader: Processing scene graph nodes...");
         ProcessAssimpNode(scene->mRootNode, scene, outModelData, modelDirectory);
@@ -101,6 +125,9 @@ namespace VulkEng {
             // node->mMeshes[i] is an index into scene->mMeshes.
             aiMesh* assimpMesh = scene->mMeshes[node->mMeshes[i]];
             MeshData engineMeshData = ProcessAssimpMesh(assimpMesh, scene, modelDirectory);
+            if (outModelData.skeleton && assimpMesh->HasBones()) {
+                ProcessAssimpSkinWeights(assimpMesh, *outModelData.skeleton, engineMeshData);
+            }
 
             // Aggregate vertices and indices for the physics shape
             // Ensure that indices are adjusted based on the current size of allVerticesPhysics
@@ -195,6 +222,183 @@ namespace VulkEng {
         return data;
     }
 
+    namespace {
+        // Assimp matrices are row-major, GLM's are column-major.
+        glm::mat4 ToGlm(const aiMatrix4x4& matrix) {
+            return glm::transpose(glm::make_mat4(&matrix.a1));
+        }
+    }
+
+    std::shared_ptr<Skeleton> ModelLoader::ProcessAssimpSkeleton(const aiScene* scene) {
+        std::unordered_map<std::string, aiMatrix4x4> boneOffsets;
+        for (unsigned int m = 0; m < scene->mNumMeshes; ++m) {
+            const aiMesh* mesh = scene->mMeshes[m];
+            for (unsigned int b = 0; b < mesh->mNumBones; ++b) {
+                boneOffsets.emplace(mesh->mBones[b]->mName.C_Str(), mesh->mBones[b]->mOffsetMatrix);
+            }
+        }
+        if (boneOffsets.empty()) return nullptr;
+
+        // Joints are the bone nodes plus their ancestors, whose transforms the bones inherit.
+        std::unordered_set<const aiNode*> jointNodes;
+        std::function<bool(const aiNode*)> markJoints = [&](const aiNode* node) {
+            bool isJoint = boneOffsets.count(node->mName.C_Str()) > 0;
+            for (unsigned int i = 0; i < node->mNumChildren; ++i) {
+                isJoint |= markJoints(node->mChildren[i]);
+            }
+            if (isJoint) jointNodes.insert(node);
+            return isJoint;
+        };
+        markJoints(scene->mRootNode);
+
+        auto skeleton = std::make_shared<Skeleton>();
+        std::vector<glm::vec3> translations, scales;
+        std::vector<glm::quat> rotations;
+        // Depth-first, so parents are emitted before their children.
+        std::function<void(const aiNode*, int32_t, const glm::mat4&)> addJoint =
+            [&](const aiNode* node, int32_t parent, const glm::mat4& parentBind) {
+            if (!jointNodes.count(node)) return;
+            int32_t index = static_cast<int32_t>(skeleton->parents.size());
+            glm::mat4 bind = parentBind * ToGlm(node->mTransformation);
+
+            aiVector3D scaling, position;
+            aiQuaternion rotation;
+            node->mTransformation.Decompose(scaling, rotation, position);
+            skeleton->jointNames.push_back(node->mName.C_Str());
+            skeleton->parents.push_back(parent);
+            translations.emplace_back(position.x, position.y, position.z);
+            rotations.emplace_back(rotation.w, rotation.x, rotation.y, rotation.z);
+            scales.emplace_back(scaling.x, scaling.y, scaling.z);
+            auto offsetIt = boneOffsets.find(node->mName.C_Str());
+            skeleton->inverseBindMatrices.push_back(offsetIt != boneOffsets.end() ? ToGlm(offsetIt->second) : glm::inverse(bind));
+
+            for (unsigned int i = 0; i < node->mNumChildren; ++i) {
+                addJoint(node->mChildren[i], index, bind);
+            }
+        };
+        addJoint(scene->mRootNode, -1, glm::mat4(1.0f));
+
+        if (skeleton->GetJointCount() > 256) {
+            VKENG_ERROR("ModelLoader: Skeleton has {} joints; at most 256 are supported. Skinning disabled.", skeleton->GetJointCount());
+            return nullptr;
+        }
+        skeleton->bindPose.Resize(skeleton->GetJointCount());
+        for (uint32_t joint = 0; joint < skeleton->GetJointCount(); ++joint) {
+            skeleton->bindPose.SetJoint(joint, translations[joint], rotations[joint], scales[joint]);
+        }
+        return skeleton;
+    }
+
+    void ModelLoader::ProcessAssimpSkinWeights(const aiMesh* mesh, const Skeleton& skeleton, MeshData& outMeshData) {
+        std::vector<std::array<float, 4>> weights(mesh->mNumVertices, {0.0f, 0.0f, 0.0f, 0.0f});
+        outMeshData.skinVertices.assign(mesh->mNumVertices, SkinVertex{});
+
+        for (unsigned int b = 0; b < mesh->mNumBones; ++b) {
+            const aiBone* bone = mesh->mBones[b];
+            int32_t joint = skeleton.FindJoint(bone->mName.C_Str());
+            if (joint < 0) continue;
+            for (unsigned int w = 0; w < bone->mNumWeights; ++w) {
+                const aiVertexWeight& vertexWeight = bone->mWeights[w];
+                if (vertexWeight.mVertexId >= mesh->mNumVertices) continue;
+                // Keep the four strongest influences (LimitBoneWeights normally guarantees four at most).
+                std::array<float, 4>& slots = weights[vertexWeight.mVertexId];
+                size_t weakest = static_cast<size_t>(std::min_element(slots.begin(), slots.end()) - slots.begin());
+                if (vertexWeight.mWeight > slots[weakest]) {
+                    slots[weakest] = vertexWeight.mWeight;
+                    outMeshData.skinVertices[vertexWeight.mVertexId].joints[weakest] = static_cast<uint8_t>(joint);
+                }
+            }
+        }
+
+        for (size_t v = 0; v < weights.size(); ++v) {
+            SkinVertex& skin = outMeshData.skinVertices[v];
+            const std::array<float, 4>& slots = weights[v];
+            float sum = slots[0] + slots[1] + slots[2] + slots[3];
+            if (sum <= 0.0f) {
+                skin.weights[0] = 255; // Unweighted vertex: follow joint 0
+                continue;
+            }
+            int total = 0;
+            size_t strongest = 0;
+            for (size_t i = 0; i < 4; ++i) {
+                skin.weights[i] = static_cast<uint8_t>(std::lround(slots[i] / sum * 255.0f));
+                total += skin.weights[i];
+                if (slots[i] > slots[strongest]) strongest = i;
+            }
+            // Rounding error goes to the strongest influence so the weights sum to exactly 255.
+            skin.weights[strongest] = static_cast<uint8_t>(skin.weights[strongest] + (255 - total));
+        }
+    }
+
+    std::shared_ptr<AnimationClip> ModelLoader::ProcessAssimpAnimation(const aiAnimation* animation, const Skeleton& skeleton) {
+        const double ticksPerSecond = animation->mTicksPerSecond > 0.0 ? animation->mTicksPerSecond : 25.0;
+        std::vector<AnimationClip::JointKeys> joints(skeleton.GetJointCount());
+
+        for (unsigned int c = 0; c < animation->mNumChannels; ++c) {
+            const aiNodeAnim* channel = animation->mChannels[c];
+            int32_t joint = skeleton.FindJoint(channel->mNodeName.C_Str());
+            if (joint < 0) continue;
+            AnimationClip::JointKeys& keys = joints[joint];
+            for (unsigned int k = 0; k < channel->mNumPositionKeys; ++k) {
+                const aiVectorKey& key = channel->mPositionKeys[k];
+                keys.translationTimes.push_back(static_cast<float>(key.mTime / ticksPerSecond));
+                keys.translations.emplace_back(key.mValue.x, key.mValue.y, key.mValue.z);
+            }
+            for (unsigned int k = 0; k < channel->mNumRotationKeys; ++k) {
+                const aiQuatKey& key = channel->mRotationKeys[k];
+                keys.rotationTimes.push_back(static_cast<float>(key.mTime / ticksPerSecond));
+                keys.rotations.emplace_back(key.mValue.w, key.mValue.x, key.mValue.y, key.mValue.z);
+            }
+            for (unsigned int k = 0; k < channel->mNumScalingKeys; ++k) {
+                const aiVectorKey& key = channel->mScalingKeys[k];
+                keys.scaleTimes.push_back(static_cast<float>(key.mTime / ticksPerSecond));
+                keys.scales.emplace_back(key.mValue.x, key.mValue.y, key.mValue.z);
+            }
+        }
+
+        std::string name = animation->mName.length > 0 ? animation->mName.C_Str() : "Animation";
+        return AnimationClip::Build(name, static_cast<float>(animation->mDuration / ticksPerSecond), joints, skeleton.bindPose);
+    }
+
+    std::string ModelLoader::ResolveTexturePath(aiMaterial* material, std::initializer_list<int> textureTypes, const aiScene* scene,
+                                                const std::string& modelDirectory, const std::string& materialName) {
+        for (int type : textureTypes) {
+            aiTextureType textureType = static_cast<aiTextureType>(type);
+            aiString aiPath;
+            if (material->GetTextureCount(textureType) == 0 || material->GetTexture(textureType, 0, &aiPath) != AI_SUCCESS) continue;
+
+            std::string texturePathStr = aiPath.C_Str();
+            if (texturePathStr.rfind('*', 0) == 0) { // Embedded texture (e.g., *0, *1)
+                int textureIndex = std::stoi(texturePathStr.substr(1));
+                if (scene->HasTextures() && textureIndex < static_cast<int>(scene->mNumTextures)) {
+                    aiTexture* embeddedTexture = scene->mTextures[textureIndex];
+                    // mHeight == 0 means compressed (e.g. jpg, png embedded as bytes)
+                    // mHeight > 0 means raw ARGB data
+                    if (embeddedTexture->mHeight == 0) {
+                         VKENG_WARN("ModelLoader: Material '{}' has embedded compressed texture '{}'. "
+                                   "Loading from embedded raw bytes not implemented yet. Path: '{}'",
+                                   materialName, embeddedTexture->mFilename.C_Str(), texturePathStr);
+                        // AssetManager would need to load this from memory (stbi_load_from_memory)
+                    } else {
+                         VKENG_WARN("ModelLoader: Material '{}' has embedded raw ARGB texture. Not supported yet.", materialName);
+                    }
+                } else {
+                     VKENG_ERROR("ModelLoader: Invalid embedded texture index '{}' for material '{}'.", texturePathStr, materialName);
+                }
+                return {};
+            }
+
+            // External texture file
+            std::filesystem::path texPath(texturePathStr);
+            std::filesystem::path fullPath = texPath.is_absolute() ? texPath : std::filesystem::path(modelDirectory) / texPath;
+            // Normalize and convert to string
+            std::string resolved = std::filesystem::lexically_normal(fullPath).string();
+            std::replace(resolved.begin(), resolved.end(), '\\', '/');
+            return resolved;
+        }
+        return {};
+    }
+
     MaterialDataSource ModelLoader::ProcessAssimpMaterial(aiMaterial* material, const aiScene* scene, const std::string& modelDirectory) {
         MaterialDataSource matData;
 
@@ -203,76 +407,64 @@ namespace VulkEng {
         material->Get(AI_MATKEY_NAME, name);
         matData.name = (name.length > 0) ? name.C_Str() : "UnnamedMaterial_" + std::to_string(reinterpret_cast<uintptr_t>(material));
 
-        // Get base color factor (diffuse color if not PBR)
-        aiColor4D diffuseColor;
-        if (material->Get(AI_MATKEY_COLOR_DIFFUSE, diffuseColor) == AI_SUCCESS) {
-            matData.baseColorFactor = {diffuseColor.r, diffuseColor.g, diffuseColor.b, diffuseColor.a};
+        // Get base color factor: glTF's PBR base color, else the diffuse color of classic formats
+        aiColor4D baseColor;
+        if (material->Get(AI_MATKEY_BASE_COLOR, baseColor) == AI_SUCCESS ||
+            material->Get(AI_MATKEY_COLOR_DIFFUSE, baseColor) == AI_SUCCESS) {
+            matData.baseColorFactor = {baseColor.r, baseColor.g, baseColor.b, baseColor.a};
         } else {
             matData.baseColorFactor = {1.0f, 1.0f, 1.0f, 1.0f}; // Default white
         }
-        // For PBR, AI_MATKEY_BASE_COLOR might be more appropriate if available from format (e.g. glTF)
-        // aiColor4D baseColorPBR;
-        // if (material->Get(AI_MATKEY_BASE_COLOR, baseColorPBR) == AI_SUCCESS) {
-        //     matData.baseColorFactor = {baseColorPBR.r, baseColorPBR.g, baseColorPBR.b, baseColorPBR.a};
-        // }
 
-
-        // --- Diffuse (Base Color) Texture ---
+        // --- Textures ---
         // Assimp uses aiTextureType_DIFFUSE for base color in many PBR workflows too
-        if (material->GetTextureCount(aiTextureType_DIFFUSE) > 0) {
-            aiString aiPath;
-            if (material->GetTexture(aiTextureType_DIFFUSE, 0, &aiPath) == AI_SUCCESS) {
-                std::string texturePathStr = aiPath.C_Str();
-                if (texturePathStr.rfind('*', 0) == 0) { // Embedded texture (e.g., *0, *1)
-                    int textureIndex = std::stoi(texturePathStr.substr(1));
-                    if (scene->HasTextures() && textureIndex < static_cast<int>(scene->mNumTextures)) {
-                        aiTexture* embeddedTexture = scene->mTextures[textureIndex];
-                        // mHeight == 0 means compressed (e.g. jpg, png embedded as bytes)
-                        // mHeight > 0 means raw ARGB data
-                        if (embeddedTexture->mHeight == 0) {
-                             VKENG_WARN("ModelLoader: Material '{}' has embedded compressed texture '{}'. "
-                                       "Loading from embedded raw bytes not implemented yet. Path: '{}'",
-                                       matData.name, embeddedTexture->mFilename.C_Str(), texturePathStr);
-                            // AssetManager would need to load this from memory (stbi_load_from_memory)
-                            // matData.diffuseTexturePath = "*EMBEDDED*" + texturePathStr; // Mark it
-                        } else {
-                             VKENG_WARN("ModelLoader: Material '{}' has embedded raw ARGB texture. Not supported yet.", matData.name);
-                        }
-                    } else {
-                         VKENG_ERROR("ModelLoader: Invalid embedded texture index '{}' for material '{}'.", texturePathStr, matData.name);
-                    }
-                } else { // External texture file
-                    std::filesystem::path texPath(texturePathStr);
-                    std::filesystem::path fullPath;
-                    if (texPath.is_absolute()) {
-                        fullPath = texPath;
-                    } else {
-                        fullPath = std::filesystem::path(modelDirectory) / texPath;
-                    }
-                    // Normalize and convert to string
-                    matData.diffuseTexturePath = std::filesystem::lexically_normal(fullPath).string();
-                    std::replace(matData.diffuseTexturePath.begin(), matData.diffuseTexturePath.end(), '\\', '/');
-                }
+        matData.diffuseTexturePath = ResolveTexturePath(material, {aiTextureType_DIFFUSE}, scene, modelDirectory, matData.name);
+        matData.normalTexturePath = ResolveTexturePath(material, {aiTextureType_NORMALS}, scene, modelDirectory, matData.name);
+        // glTF metallic-roughness: newer Assimp reports it as METALNESS (and DIFFUSE_ROUGHNESS, same file),
+        // older versions as UNKNOWN. Occlusion likewise moved from LIGHTMAP to AMBIENT_OCCLUSION.
+        matData.metallicRoughnessTexturePath = ResolveTexturePath(material, {aiTextureType_METALNESS, aiTextureType_UNKNOWN},
+                                                                  scene, modelDirectory, matData.name);
+        matData.aoTexturePath = ResolveTexturePath(material, {aiTextureType_AMBIENT_OCCLUSION, aiTextureType_LIGHTMAP},
+                                                   scene, modelDirectory, matData.name);
+        matData.emissiveTexturePath = ResolveTexturePath(material, {aiTextureType_EMISSIVE}, scene, modelDirectory, matData.name);
+
+        // --- Alpha & Culling ---
+        aiString alphaMode;
+        if (material->Get(AI_MATKEY_GLTF_ALPHAMODE, alphaMode) == AI_SUCCESS) {
+            std::string mode = alphaMode.C_Str();
+            if (mode == "MASK") matData.alphaMode = Material::AlphaMode::MASK;
+            else if (mode == "BLEND") matData.alphaMode = Material::AlphaMode::BLEND;
+        }
+        material->Get(AI_MATKEY_GLTF_ALPHACUTOFF, matData.alphaCutoff);
+        int twoSided = 0;
+        if (material->Get(AI_MATKEY_TWOSIDED, twoSided) == AI_SUCCESS) matData.doubleSided = twoSided != 0;
+
+        // --- PBR Factors ---
+        material->Get(AI_MATKEY_METALLIC_FACTOR, matData.metallicFactor);
+        if (material->Get(AI_MATKEY_ROUGHNESS_FACTOR, matData.roughnessFactor) != AI_SUCCESS) {
+            // Classic formats: map the Phong exponent to roughness (Blinn-Phong n = 2 / alpha^2 - 2, alpha = roughness^2)
+            float shininess = 0.0f;
+            if (material->Get(AI_MATKEY_SHININESS, shininess) == AI_SUCCESS && shininess > 0.0f) {
+                matData.roughnessFactor = std::clamp(std::pow(2.0f / (shininess + 2.0f), 0.25f), 0.0f, 1.0f);
+            }
+        }
+        aiColor3D emissive;
+        if (material->Get(AI_MATKEY_COLOR_EMISSIVE, emissive) == AI_SUCCESS) {
+            matData.emissiveFactor = {emissive.r, emissive.g, emissive.b};
+        }
+        float emissiveStrength = 1.0f; // KHR_materials_emissive_strength
+        if (material->Get(AI_MATKEY_EMISSIVE_INTENSITY, emissiveStrength) == AI_SUCCESS) {
+            matData.emissiveFactor *= emissiveStrength;
+        }
+        if (!matData.normalTexturePath.empty()) {
+            material->Get(AI_MATKEY_GLTF_TEXTURE_SCALE(aiTextureType_NORMALS, 0), matData.normalScale);
+        }
+        if (!matData.aoTexturePath.empty()) {
+            // glTF stores the strength on the occlusion texture, which older Assimp reports as LIGHTMAP.
+            if (material->Get(AI_MATKEY_GLTF_TEXTURE_STRENGTH(aiTextureType_AMBIENT_OCCLUSION, 0), matData.occlusionStrength) != AI_SUCCESS) {
+                material->Get(AI_MATKEY_GLTF_TEXTURE_STRENGTH(aiTextureType_LIGHTMAP, 0), matData.occlusionStrength);
             }
         }
-
-        // TODO: Load other PBR textures (Normal, MetallicRoughness, Emissive, AO)
-        // Normal Map: aiTextureType_NORMALS
-        // Metallic/Roughness: Often packed. GLTF uses aiTextureType_UNKNOWN with specific key hints or
-        // aiTextureType_METALNESS and aiTextureType_DIFFUSE_ROUGHNESS (or SHININESS for older specular).
-        // Ambient Occlusion: aiTextureType_AMBIENT_OCCLUSION or aiTextureType_LIGHTMAP (can vary by format)
-        // Emissive: aiTextureType_EMISSIVE
-
-        // Example for PBR scalar factors (if textures are not present)
-        // float metallic = 0.0f, roughness = 1.0f;
-        // material->Get(AI_MATKEY_METALLIC_FACTOR, metallic);
-        // material->Get(AI_MATKEY_ROUGHNESS_FACTOR, roughness);
-        // matData.metallicFactor = metallic;
-        // matData.roughnessFactor = roughness;
-        // aiColor3D emissive;
-        // if (material->Get(AI_MATKEY_COLOR_EMISSIVE, emissive) == AI_SUCCESS) {
-        //     matData.emissiveFactor = {emissive.r, emissive.g, emissive.b};
-        // }
 
         return matData;
     }
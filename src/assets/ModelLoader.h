@@ -1,7 +1,9 @@
 #pragma once
 
 #include "Mesh.h"     // For MeshData (CPU-side vertex/index data per mesh part)
+#include <initializer_list>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include <memory>      // Not strictly needed here, but often associated with asset management
 #include <glm/glm.hpp> // For glm::vec3 (used in allVerticesPhysics)
@@ -12,9 +14,14 @@ struct aiScene;
 struct aiNode;
 struct aiMesh;
 struct aiMaterial;
+struct aiAnimation;
 
 namespace VulkEng {
 
+    struct Skeleton;
+    class AnimationClip;
+    struct DecodedTexture;
+
     // Forward declaration (VulkanContext is not directly used by ModelLoader's public interface anymore,
     // as it focuses on extracting CPU data. AssetManager handles GPU upload).
     // class VulkanContext;
@@ -24,16 +31,24 @@ namespace VulkEng {
     struct MaterialDataSource { // Renamed to avoid conflict with engine's Material struct
         std::string name;                    // Name of the material from the model file
         std::string diffuseTexturePath;      // File path to the diffuse (base color) texture
-        // std::string normalTexturePath;
-        // std::string metallicRoughnessTexturePath;
-        // std::string emissiveTexturePath;
-        // std::string aoTexturePath;
+        // Pixels of the texture paths below, by path, if AssetManager::ImportModel was asked to decode textures.
+        std::unordered_map<std::string, std::shared_ptr<const DecodedTexture>> decodedTextures;
+        // Optional maps; empty if the material has none (each one is a MaterialFeature).
+        std::string normalTexturePath;
+        std::string metallicRoughnessTexturePath;
+        std::string emissiveTexturePath;
+        std::string aoTexturePath;
 
         glm::vec4 baseColorFactor = glm::vec4(1.0f); // Default if no texture or for modulation
-        // float metallicFactor = 1.0f;
-        // float roughnessFactor = 1.0f;
-        // glm::vec3 emissiveFactor = glm::vec3(0.0f);
-        // Add other PBR properties as needed
+        // PBR factors (see Material). Formats without them keep these dielectric defaults.
+        float metallicFactor = 0.0f;
+        float roughnessFactor = 1.0f;
+        glm::vec3 emissiveFactor = glm::vec3(0.0f);
+        float occlusionStrength = 1.0f;
+        float normalScale = 1.0f;
+        Material::AlphaMode alphaMode = Material::AlphaMode::OPAQUE;
+        float alphaCutoff = 0.5f;
+        bool doubleSided = false;
     };
 
     // Structure to hold all CPU-side data extracted from a loaded model file.
@@ -53,6 +68,11 @@ namespace VulkEng {
         // (e.g., a single btBvhTriangleMeshShape for the entire static model).
         std::vector<glm::vec3> allVerticesPhysics; // Only positions
         std::vector<uint32_t> allIndicesPhysics;   // Indices for the combined vertex list
+
+        // Skinned models only: the joint hierarchy the meshes' SkinVertex data refers to, and the
+        // model's animations (quantized at import, so this work stays on the loading thread).
+        std::shared_ptr<const Skeleton> skeleton;
+        std::vector<std::shared_ptr<const AnimationClip>> animations;
     };
 
     // Static class responsible for loading 3D model files using Assimp
@@ -82,12 +102,26 @@ namespace VulkEng {
             const std::string& modelDirectory
         );
 
+        // Builds the skeleton from every node that is a bone or an ancestor of one.
+        // Returns null if the model has no bones.
+        static std::shared_ptr<Skeleton> ProcessAssimpSkeleton(const aiScene* scene);
+
+        // Fills `outMeshData.skinVertices` from the mesh's bone weights (strongest four per vertex).
+        static void ProcessAssimpSkinWeights(const aiMesh* mesh, const Skeleton& skeleton, MeshData& outMeshData);
+
+        // Converts an animation's node channels to a quantized clip for `skeleton`.
+        static std::shared_ptr<AnimationClip> ProcessAssimpAnimation(const aiAnimation* animation, const Skeleton& skeleton);
+
         // Processes an Assimp material (aiMaterial) and extracts relevant information.
         static MaterialDataSource ProcessAssimpMaterial(
             aiMaterial* material,
             const aiScene* scene, // For embedded textures
             const std::string& modelDirectory
         );
+        // Full path of the material's first texture of the first of `textureTypes` (aiTextureType
+        // values) it has; empty if none, or if the texture is embedded (not supported yet).
+        static std::string ResolveTexturePath(aiMaterial* material, std::initializer_list<int> textureTypes, const aiScene* scene,
+                                              const std::string& modelDirectory, const std::string& materialName);
 
         // Helper to load texture paths from an Assimp material for a specific type.
         // static std::vector<std::string> LoadMaterialTexturePaths(
@@ -3,6 +3,8 @@
 #include <vulkan/vulkan.h> // For Vulkan types (VkImage, VkSampler, etc.)
 #include <string>          // For std::string (texture path)
 #include <memory>          // Not strictly needed here anymore unless sharing samplers via smart_ptr
+#include <vector>          // For DecodedTexture pixels
+#include <cstdint>
 #include "core/Log.h"      // For logging cleanup actions (optional)
 
 namespace VulkEng {
@@ -47,6 +49,14 @@ namespace VulkEng {
         }
     };
 
+    // An image file decoded to RGBA8 on the CPU, not yet uploaded. Decoding is the slow part of
+    // texture loading and needs no Vulkan, so it can run on worker threads (AssetManager::DecodeTexture).
+    struct DecodedTexture {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        std::vector<uint8_t> pixels; // width * height * 4 bytes
+    };
+
     // Handle type for referencing textures managed by the AssetManager.
     // Using size_t as a simple index into a vector.
     using TextureHandle = size_t;
@@ -7,9 +7,17 @@
 #include "scene/GameObject.h"
 #include "scene/Components/TransformComponent.h"
 #include "scene/Components/MeshComponent.h"
+#include "scene/Components/InstancedMeshComponent.h"
 #include "scene/Components/CameraComponent.h"
 #include "scene/Components/RigidBodyComponent.h"
+#include "scene/Components/AnimatorComponent.h"
+#include "scene/Components/ParticleEmitterComponent.h"
+#include "scene/SystemScheduler.h"
+#include "scene/SceneBenchmark.h"
+#include "animation/AnimationBenchmark.h"
 #include "assets/ModelLoader.h" // For LoadedModelData
+#include "core/StartupGraph.h"
+#include "core/PerfCounters.h"
 
 #include <GLFW/glfw3.h>   // For time and key codes
 #include <glm/gtc/constants.hpp> // For pi() in camera
@@ -18,8 +26,31 @@
 // For ImGui calls
 #include <imgui.h>
 
+#include <filesystem> // For checking/creating the saved scene path
+
 namespace VulkEng {
 
+    namespace {
+        const char* const DefaultScenePath = "assets/scenes/default.vksc";
+        const char* const WorldPartitionPath = "assets/world";
+        // Ensure path is correct relative to executable in build directory (CMake copies assets)
+        const char* const DefaultModelPath = "assets/models/viking_room.obj";
+        // Optional; without it the ambient stays a flat fraction of the sun.
+        const char* const DefaultEnvironmentPath = "assets/environments/default.hdr";
+        const char* const EnvironmentCacheDir = "cache"; // Baked lighting, keyed by the HDR's content
+        constexpr float WorldCellSize = 50.0f;
+        // Main-thread time per frame spent instantiating streamed objects.
+        constexpr double SceneStreamBudgetMs = 4.0;
+
+        // Once the world is baked, its placed objects stream in from the cells; only the rest of the
+        // scene is loaded up front.
+        std::string StartupScenePath() {
+            std::string persistentPath = WorldPartition::GetPersistentScenePath(WorldPartitionPath);
+            return WorldPartition::Exists(WorldPartitionPath) && std::filesystem::exists(persistentPath)
+                ? persistentPath : std::string(DefaultScenePath);
+        }
+    }
+
     Application::Application() {
         // Log::Init() is called in main.cpp before Application constructor
         Initialize();
@@ -32,28 +63,102 @@ namespace VulkEng {
     void Application::Initialize() {
         VKENG_INFO("Initializing Application Systems...");
 
-        // --- System Creation Order ---
-        m_Window = std::make_unique<Window>(1280, 720, "Vulkan Engine");
-        m_Renderer = std::make_unique<Renderer>(*m_Window);
-        // Assuming Renderer creates/owns its primary CommandManager.
-        // If App owned it: m_CommandManager = std::make_unique<CommandManager>(m_Renderer->GetContext(), MAX_FRAMES_IN_FLIGHT);
-        // And Renderer constructor would take CommandManager&.
+        // --- Startup Graph ---
+        // Independent steps overlap: workers import the default model (and decode its textures),
+        // set up the Bullet world, build the ImGui font atlas and bake the environment lighting while
+        // the main thread creates the window, device, swapchain and pipelines (which compile in
+        // parallel themselves).
+        m_JobSystem = std::make_unique<JobSystem>(JobSystem::DefaultWorkerCount());
+        ServiceLocator::Provide(m_JobSystem.get()); // Before the renderer, which compiles pipelines on it
+
+        const std::string scenePath = StartupScenePath();
+        const bool hasSavedScene = std::filesystem::exists(scenePath);
+        LoadedModelData defaultModelData;
+        AssetHash defaultModelHash = InvalidAssetHash;
+        bool defaultModelImported = false;
+        EnvironmentLightingData environmentData;
+        bool environmentBaked = false;
+
+        StartupGraph startup(*m_JobSystem);
+        using Affinity = StartupGraph::Affinity;
+        auto window = startup.Add("Window", Affinity::MainThread, [this]() {
+            m_Window = std::make_unique<Window>(1280, 720, "Vulkan Engine");
+        });
+        auto renderer = startup.Add("Renderer", Affinity::MainThread, [this]() {
+            m_Renderer = std::make_unique<Renderer>(*m_Window);
+        }, {window});
+        auto physics = startup.Add("Physics world", Affinity::AnyThread, [this]() {
+            m_PhysicsSystem = std::make_unique<PhysicsSystem>();
+        });
+        auto fontAtlas = startup.Add("ImGui font atlas", Affinity::AnyThread, []() {
+            UIManager::BuildFontAtlas();
+        });
+        auto modelImport = startup.Add("Default model import", Affinity::AnyThread, [&]() {
+            if (hasSavedScene) return; // The saved scene streams its own models
+            defaultModelImported = AssetManager::ImportModel(DefaultModelPath, defaultModelData, defaultModelHash, true);
+        });
+        auto environmentBake = startup.Add("Environment lighting bake", Affinity::AnyThread, [&]() {
+            if (!std::filesystem::exists(DefaultEnvironmentPath)) return;
+            environmentBaked = IblBaker::LoadOrBake(DefaultEnvironmentPath, EnvironmentCacheDir, environmentData);
+        });
+        startup.Add("Environment lighting upload", Affinity::MainThread, [&]() {
+            if (environmentBaked) m_Renderer->SetEnvironmentLighting(environmentData);
+        }, {renderer, environmentBake});
+        auto assets = startup.Add("Asset manager", Affinity::MainThread, [this]() {
+            m_AssetManager = std::make_unique<AssetManager>(m_Renderer->GetContext(), m_Renderer->GetCommandManagerInstance());
+        }, {renderer});
+        auto ui = startup.Add("UI manager", Affinity::MainThread, [this]() {
+            m_UIManager = std::make_unique<UIManager>(*m_Window, m_Renderer->GetContext(), m_Renderer->GetMainRenderPass());
+        }, {renderer, fontAtlas});
+        startup.Add("Scene", Affinity::MainThread, [&]() {
+            InputManager::Init(m_Window->GetGLFWwindow());
+
+            // --- Service Locator: Provide all created services ---
+            VKENG_INFO("Providing services to ServiceLocator...");
+            ServiceLocator::Provide(m_Renderer.get());
+            ServiceLocator::Provide(m_AssetManager.get());
+            ServiceLocator::Provide(m_PhysicsSystem.get());
+            ServiceLocator::Provide(m_UIManager.get());
+            VKENG_INFO("Services Provided.");
+
+            // --- Scene Setup ---
+            // Stream the saved scene if there is one; otherwise build the procedural default.
+            if (hasSavedScene) {
+                LoadScene(scenePath);
+            } else {
+                CreateEmptyScene();
+                ModelHandle roomModel = defaultModelImported
+                    ? m_AssetManager->CreateModelFromImport(DefaultModelPath, std::move(defaultModelData), defaultModelHash)
+                    : InvalidModelHandle;
+                BuildDefaultScene(roomModel);
+            }
+            OpenWorldPartition();
+            m_LastMousePos = InputManager::GetMousePosition(); // Initialize for camera controls
+        }, {assets, ui, physics, modelImport});
+        startup.Run();
 
-        m_AssetManager = std::make_unique<AssetManager>(m_Renderer->GetContext(), m_Renderer->GetCommandManagerInstance());
-        m_UIManager = std::make_unique<UIManager>(*m_Window, m_Renderer->GetContext(), m_Renderer->GetMainRenderPass());
-        m_PhysicsSystem = std::make_unique<PhysicsSystem>();
-        m_CurrentScene = std::make_unique<Scene>();
-        InputManager::Init(m_Window->GetGLFWwindow());
+        // --- Event Handling ---
+        m_Window->SetCloseCallback([this]() { m_IsRunning = false; });
+        m_Window->SetResizeCallback([this](int w, int h) {
+            if (w == 0 || h == 0) return;
+            m_Renderer->HandleResize(w, h);
+            if (auto* cam = m_CurrentScene->GetMainCamera()) {
+                cam->SetPerspective(cam->GetFov(), static_cast<float>(w) / static_cast<float>(h), cam->GetNearPlane(), cam->GetFarPlane());
+            }
+        });
+
+        VKENG_INFO("Application Initialized.");
+    }
 
-        // --- Service Locator: Provide all created services ---
-        VKENG_INFO("Providing services to ServiceLocator...");
-        ServiceLocator::Provide(m_Renderer.get());
-        ServiceLocator::Provide(m_AssetManager.get());
-        ServiceLocator::Provide(m_PhysicsSystem.get());
-        ServiceLocator::Provide(m_UIManager.get());
-        VKENG_INFO("Services Provided.");
+    void Application::CreateEmptyScene() {
+        m_CurrentScene = std::make_unique<Scene>();
+        // Rigid body updates only read back their own physics state, so chunks can run in parallel.
+        m_CurrentScene->GetSystemScheduler().AddSystem<ComponentUpdateSystem<RigidBodyComponent>>(true);
+        // Animators evaluate their own pose only; small chunks since each one is comparatively expensive.
+        m_CurrentScene->GetSystemScheduler().AddSystem<ComponentUpdateSystem<AnimatorComponent>>(true, 8);
+    }
 
-        // --- Scene Setup ---
+    void Application::BuildDefaultScene(ModelHandle modelHandle) {
         VKENG_INFO("Setting up initial scene...");
         // Create Camera
         auto cameraObject = m_CurrentScene->CreateGameObject("MainCamera");
@@ -65,7 +170,6 @@ namespace VulkEng {
         m_Window->GetFramebufferSize(width, height);
         camComponent->SetPerspective(glm::radians(45.0f), (float)width / (float)height, 0.1f, 100.0f);
         m_CurrentScene->SetMainCamera(cameraObject);
-        m_LastMousePos = InputManager::GetMousePosition(); // Initialize for camera controls
 
         // Create Floor
         auto floorObject = m_CurrentScene->CreateGameObject("Floor");
@@ -92,10 +196,14 @@ namespace VulkEng {
         auto* boxRb = boxObject->AddComponent<RigidBodyComponent>(boxSettings);
         boxRb->InitializePhysics(m_PhysicsSystem.get());
 
-        // Load Viking Room Model & Setup Physics
+        // Particle fountain; particles bounce off the floor and model through the depth buffer
+        auto fountainObject = m_CurrentScene->CreateGameObject("Fountain");
+        auto* fountainTransform = fountainObject->AddComponent<TransformComponent>();
+        fountainTransform->SetPosition({-1.5f, -0.5f, 1.5f});
+        fountainObject->AddComponent<ParticleEmitterComponent>();
+
+        // Viking Room Model (imported during startup) & Physics
         try {
-            // Ensure path is correct relative to executable in build directory (CMake copies assets)
-            ModelHandle modelHandle = m_AssetManager->LoadModel("assets/models/viking_room.obj");
             if (modelHandle != InvalidModelHandle) {
                 auto modelObject = m_CurrentScene->CreateGameObject("Viking Room");
                 auto* modelTransform = modelObject->AddComponent<TransformComponent>();
@@ -124,27 +232,59 @@ namespace VulkEng {
                 for (const auto& mesh : meshes) {
                     meshComp.AddMesh(&mesh);
                 }
+                if (loadedData && loadedData->skeleton) {
+                    auto* animator = modelObject->AddComponent<AnimatorComponent>(loadedData->skeleton);
+                    if (!loadedData->animations.empty()) animator->Play(loadedData->animations.front());
+                }
             }
         } catch (const std::exception& e) {
-            VKENG_ERROR("Model loading exception in Application::Initialize: {}", e.what());
+            VKENG_ERROR("Model loading exception in Application::BuildDefaultScene: {}", e.what());
         }
         VKENG_INFO("Initial scene setup complete.");
+    }
 
-        // --- Event Handling ---
-        m_Window->SetCloseCallback([this]() { m_IsRunning = false; });
-        m_Window->SetResizeCallback([this](int w, int h) {
-            if (w == 0 || h == 0) return;
-            m_Renderer->HandleResize(w, h);
-            if (auto* cam = m_CurrentScene->GetMainCamera()) {
-                cam->SetPerspective(cam->GetFov(), static_cast<float>(w) / static_cast<float>(h), cam->GetNearPlane(), cam->GetFarPlane());
-            }
-        });
+    void Application::LoadScene(const std::string& filepath) {
+        m_SceneLoader.reset(); // Waits for a previous load's background work before its scene goes away
+        bool reopenWorld = m_WorldPartition != nullptr;
+        m_WorldPartition.reset();
+        CleanupScenePhysics();
+        CreateEmptyScene();
+        m_SceneLoader = std::make_unique<SceneStreamLoader>(*m_CurrentScene, *m_AssetManager, m_PhysicsSystem.get(), *m_JobSystem);
+        m_SceneLoader->Begin(filepath);
+        if (reopenWorld) {
+            OpenWorldPartition();
+        }
+    }
 
-        VKENG_INFO("Application Initialized.");
+    void Application::OpenWorldPartition() {
+        m_WorldPartition.reset();
+        if (!WorldPartition::Exists(WorldPartitionPath)) {
+            return;
+        }
+        m_WorldPartition = std::make_unique<WorldPartition>(*m_CurrentScene, *m_AssetManager, m_PhysicsSystem.get(), *m_JobSystem);
+        if (!m_WorldPartition->Open(WorldPartitionPath)) {
+            m_WorldPartition.reset();
+        }
+    }
+
+    void Application::CleanupScenePhysics() {
+        if (!m_CurrentScene || !m_PhysicsSystem) return;
+        for (Component* component : m_CurrentScene->GetComponentsOfType<RigidBodyComponent>()) {
+            static_cast<RigidBodyComponent*>(component)->CleanupPhysics(m_PhysicsSystem.get());
+        }
+    }
+
+    void Application::ApplyWindowAspectToMainCamera() {
+        auto* cam = m_CurrentScene ? m_CurrentScene->GetMainCamera() : nullptr;
+        if (!cam || cam->IsOrthographic()) return;
+        int width, height;
+        m_Window->GetFramebufferSize(width, height);
+        if (width == 0 || height == 0) return;
+        cam->SetPerspective(cam->GetFov(), static_cast<float>(width) / static_cast<float>(height), cam->GetNearPlane(), cam->GetFarPlane());
     }
 
     void Application::Run() {
-        m_LastFrameTime = static_cast<float>(glfwGetTime()); // Initialize last frame time
+        m_LastFrameTime = glfwGetTime(); // Initialize last frame time
         while (m_IsRunning) {
             MainLoop();
         }
@@ -207,11 +347,15 @@ namespace VulkEng {
 
 
     void Application::MainLoop() {
-        float currentTime = static_cast<float>(glfwGetTime());
-        float deltaTime = currentTime - m_LastFrameTime;
+        // Timestamps stay double: a float of seconds since start loses sub-millisecond steps within the hour.
+        double currentTime = glfwGetTime();
+        float deltaTime = static_cast<float>(currentTime - m_LastFrameTime);
         m_LastFrameTime = currentTime;
         deltaTime = glm::min(deltaTime, 0.1f); // Clamp delta time
 
+        // Everything allocated from the frame arena last frame has been consumed by now.
+        m_FrameArena.Reset();
+
         // --- Poll Events (Must be first for input) ---
         m_Window->PollEvents();
         if (!m_IsRunning || m_Window->ShouldClose()) { // Check after polling
@@ -232,6 +376,23 @@ namespace VulkEng {
         }
         // Add other game-specific input checks here
 
+        // --- Scene Streaming ---
+        if (m_SceneLoader) {
+            m_SceneLoader->Update(SceneStreamBudgetMs);
+            // Saved cameras carry the aspect ratio of the window they were saved from.
+            ApplyWindowAspectToMainCamera();
+            if (!m_SceneLoader->IsLoading()) {
+                m_SceneLoader.reset();
+            }
+        }
+
+        // --- World Streaming ---
+        if (m_WorldPartition) {
+            if (auto* camT = m_CurrentScene->GetMainCameraTransform()) {
+                m_WorldPartition->Update(camT->GetPosition());
+            }
+        }
+
         // --- Physics Update ---
         if (m_PhysicsSystem) m_PhysicsSystem->Update(deltaTime);
 
@@ -239,60 +400,230 @@ namespace VulkEng {
         if (m_CurrentScene) m_CurrentScene->Update(deltaTime); // Updates camera view matrix, component logic
 
         // --- ImGui Frame ---
-        if (m_UIManager) {
-            m_UIManager->BeginUIRender();
+        // Skipped on frames where the UI is retained (see UIUpdateMode); its layer stays on screen.
+        if (m_UIManager && m_UIManager->BeginUIRender()) {
             // --- Build ImGui UI ---
             ImGui::Begin("Debug Info");
             ImGui::Text("Frame Time: %.3f ms (%.1f FPS)", deltaTime * 1000.0f, deltaTime > 0 ? (1.0f / deltaTime) : 0.0f);
             if(auto* camT = m_CurrentScene->GetMainCameraTransform()){
                 ImGui::Text("Camera Pos: %.2f, %.2f, %.2f", camT->GetPosition().x, camT->GetPosition().y, camT->GetPosition().z);
             }
+            if (ImGui::CollapsingHeader("Memory")) {
+                FrameArena::Stats arenaStats = m_FrameArena.GetStats();
+                ImGui::Text("Frame arena: %zu / %zu KB (peak %zu KB)", arenaStats.bytesUsed / 1024,
+                            arenaStats.capacity / 1024, arenaStats.peakBytesUsed / 1024);
+                PoolAllocator::ForEachPool([](const PoolAllocator& pool) {
+                    PoolAllocator::Stats stats = pool.GetStats();
+                    ImGui::Text("%s: %zu live / %zu blocks, %zu chunk(s), %.1f%% unused",
+                                stats.name.c_str(), stats.liveBlocks, stats.capacityBlocks,
+                                stats.chunkCount, stats.fragmentation * 100.0f);
+                });
+                if (ImGui::Button("Run spawn/despawn benchmark (10k x 20)")) {
+                    RunSpawnDespawnBenchmark(10000, 20); // Results go to the log
+                }
+                if (ImGui::Button("Run animation benchmark (500 characters x 64 joints)")) {
+                    RunAnimationBenchmark(*m_JobSystem, 500, 64, 120); // Results go to the log
+                }
+            }
+            if (ImGui::CollapsingHeader("Scene")) {
+                ImGui::Text("GameObjects: %zu", m_CurrentScene->GetGameObjectCount());
+                if (m_Renderer) {
+                    const InstancingStats& instancing = m_Renderer->GetInstancingStats();
+                    ImGui::Text("Instances: %llu drawn in %u draw(s) from %u batch(es), %u chunk(s) culled",
+                                static_cast<unsigned long long>(instancing.instancesDrawn), instancing.drawCalls,
+                                instancing.batches, instancing.chunksCulled);
+                    ParticleStats particles = m_Renderer->GetParticleStats();
+                    ImGui::Text("Particles: %llu alive in %u emitter(s) (%u sorted), %u dispatch(es)",
+                                static_cast<unsigned long long>(particles.aliveParticles), particles.emitters,
+                                particles.sortedEmitters, particles.dispatches);
+                    if (ImGui::Button("Validate GPU particles against the CPU reference")) {
+                        ParticleEmitParams validation; // Default gravity and lifetimes
+                        validation.positionRadius = glm::vec4(0.0f, 1.0f, 0.0f, 0.1f);
+                        validation.velocitySpread = glm::vec4(0.0f, 4.0f, 0.0f, 1.5f);
+                        validation.gravityDrag.w = 0.1f;
+                        validation.emitCount = 64;
+                        validation.deltaTime = 1.0f / 60.0f;
+                        validation.capacity = 8192;
+                        m_Renderer->ValidateParticles(validation, 240); // Results go to the log
+                    }
+                }
+                if (ImGui::Button("Spawn 1M particle emitter")) {
+                    auto emitterObject = m_CurrentScene->CreateGameObject("ParticleStress");
+                    auto* emitterTransform = emitterObject->AddComponent<TransformComponent>();
+                    emitterTransform->SetPosition({1.5f, 2.0f, -1.5f});
+                    ParticleEmitterSettings stress;
+                    stress.capacity = 1u << 20;
+                    stress.emitRate = 400000.0f; // ~1M alive at the mean lifetime
+                    stress.lifetimeMin = 2.0f;
+                    stress.lifetimeMax = 3.0f;
+                    stress.velocitySpread = 4.0f;
+                    emitterObject->AddComponent<ParticleEmitterComponent>(stress);
+                }
+                if (m_SceneLoader) {
+                    SceneStreamLoader::Progress progress = m_SceneLoader->GetProgress();
+                    ImGui::Text("Streaming: %zu / %zu objects, %zu / %zu models (%.0f ms)",
+                                progress.objectsLoaded, progress.objectCount,
+                                progress.assetsResolved, progress.assetCount, progress.elapsedMs);
+                } else {
+                    if (ImGui::Button("Save scene")) {
+                        std::filesystem::create_directories(std::filesystem::path(DefaultScenePath).parent_path());
+                        SceneSerializer::Save(*m_CurrentScene, *m_AssetManager, DefaultScenePath);
+                    }
+                    ImGui::SameLine();
+                    if (ImGui::Button("Reload scene")) {
+                        std::string reloadPath = StartupScenePath();
+                        if (std::filesystem::exists(reloadPath)) LoadScene(reloadPath);
+                    }
+                }
+                if (m_WorldPartition) {
+                    WorldPartition::Stats worldStats = m_WorldPartition->GetStats();
+                    ImGui::Text("World cells: %zu resident, %zu loading of %zu (%zu objects, %zu models)",
+                                worldStats.residentCells, worldStats.loadingCells, worldStats.cellCount,
+                                worldStats.residentObjects, m_AssetManager->GetResidentModelCount());
+                } else if (ImGui::Button("Bake world cells")) {
+                    // Writes the current scene's placed objects as streamable cells. The cells own them
+                    // from now on, so they leave the scene and stream back in as the camera moves.
+                    std::vector<EntityHandle> bakedObjects;
+                    if (WorldPartition::Bake(*m_CurrentScene, *m_AssetManager, WorldCellSize, WorldPartitionPath, &bakedObjects)) {
+                        for (EntityHandle handle : bakedObjects) {
+                            GameObject* gameObject = m_CurrentScene->GetGameObject(handle);
+                            if (!gameObject) continue;
+                            if (m_PhysicsSystem) {
+                                if (auto* rigidBody = gameObject->GetComponent<RigidBodyComponent>()) {
+                                    rigidBody->CleanupPhysics(m_PhysicsSystem.get());
+                                }
+                            }
+                            m_CurrentScene->DestroyGameObject(gameObject);
+                        }
+                        OpenWorldPartition();
+                    }
+                }
+            }
+            if (m_Renderer && ImGui::CollapsingHeader("Transparency")) {
+                int mode = static_cast<int>(m_Renderer->GetTransparencyMode());
+                // Switching builds the blended pipelines of the other mode on first use.
+                if (ImGui::Combo("Blending", &mode, "Sorted (back to front)\0Weighted blended OIT\0")) {
+                    m_Renderer->SetTransparencyMode(static_cast<TransparencyMode>(mode));
+                }
+            }
+            if (m_Renderer && ImGui::CollapsingHeader("Post-processing")) {
+                PostProcessSettings& post = m_Renderer->GetPostProcessSettings();
+                int msaaPreset = static_cast<int>(m_Renderer->GetMsaaPreset());
+                // Rebuilds the scene targets and pipelines; applied before this frame is recorded.
+                if (ImGui::Combo("MSAA", &msaaPreset, "Off\0Performance (2x)\0Balanced (4x)\0Quality (8x)\0")) {
+                    m_Renderer->SetMsaaPreset(static_cast<MsaaPreset>(msaaPreset));
+                }
+                ImGui::SameLine();
+                ImGui::Text("%ux (max %ux)", static_cast<uint32_t>(m_Renderer->GetMsaaSamples()), static_cast<uint32_t>(m_Renderer->GetMaxMsaaSamples()));
+                ImGui::Checkbox("Auto exposure", &post.autoExposure);
+                ImGui::SameLine();
+                ImGui::Checkbox("Bloom", &post.bloom);
+                ImGui::SameLine();
+                ImGui::Checkbox("Tonemap", &post.tonemap);
+                ImGui::SameLine();
+                ImGui::Checkbox("FXAA", &post.fxaa);
+                ImGui::SliderFloat("Exposure (EV)", &post.exposureCompensation, -4.0f, 4.0f);
+                if (!post.autoExposure) ImGui::SliderFloat("Manual exposure", &post.manualExposure, 0.01f, 16.0f, "%.2f", ImGuiSliderFlags_Logarithmic);
+                else ImGui::SliderFloat("Adaptation speed", &post.adaptationSpeed, 0.1f, 10.0f);
+                if (post.bloom) {
+                    ImGui::SliderFloat("Bloom threshold", &post.bloomThreshold, 0.0f, 8.0f);
+                    ImGui::SliderFloat("Bloom knee", &post.bloomKnee, 0.0f, 1.0f);
+                    ImGui::SliderFloat("Bloom intensity", &post.bloomIntensity, 0.0f, 0.5f);
+                }
+                PostProcessStats postStats = m_Renderer->GetPostProcessStats();
+                if (postStats.timestampsSupported) {
+                    for (uint32_t stage = 0; stage < static_cast<uint32_t>(PostProcessStage::Count); ++stage) {
+                        ImGui::Text("%s: %.3f ms", PostProcessStats::StageName(static_cast<PostProcessStage>(stage)), postStats.stageMs[stage]);
+                    }
+                    ImGui::Text("Total: %.3f ms (GPU)", postStats.totalMs);
+                } else {
+                    ImGui::TextUnformatted("GPU timings unavailable (no timestamp support).");
+                }
+            }
             // Add other ImGui elements
             ImGui::End();
+            m_PerfHud.Draw();
             // --- Finish UI ---
             m_UIManager->EndUIRender(); // Calls ImGui::Render()
         }
 
 
         // --- Rendering ---
+        if (m_Renderer && m_CurrentScene) {
+            if (CameraComponent* mainCamera = m_CurrentScene->GetMainCamera()) {
+                m_Renderer->SetReversedZ(mainCamera->IsReversedZ()); // No-op unless the convention changed
+            }
+        }
         if (m_Renderer && m_Renderer->BeginFrame()) {
-            // Collect Renderables
-            std::vector<RenderObjectInfo> renderables;
+            // Collect Renderables (storage comes from the frame arena)
+            RenderObjectList renderables{ArenaAllocator<RenderObjectInfo>(m_FrameArena)};
+            InstancedRenderList instancedBatches{ArenaAllocator<InstancedRenderInfo>(m_FrameArena)};
+            ParticleRenderList particleEmitters{ArenaAllocator<ParticleRenderInfo>(m_FrameArena)};
             CameraComponent* camera = m_CurrentScene ? m_CurrentScene->GetMainCamera() : nullptr;
             if (m_CurrentScene) {
-                for (const auto& go : m_CurrentScene->GetAllGameObjects()) {
-                    auto* meshComp = go->GetComponent<MeshComponent>();
-                    auto* transformComp = go->GetComponent<TransformComponent>();
-                    if (meshComp && transformComp) {
+                const auto& meshComponents = m_CurrentScene->GetComponentsOfType<MeshComponent>();
+                renderables.reserve(meshComponents.size());
+                for (Component* component : meshComponents) {
+                    auto* meshComp = static_cast<MeshComponent*>(component);
+                    auto* transformComp = meshComp->GetGameObject()->GetComponent<TransformComponent>();
+                    if (transformComp) {
+                        auto* animator = meshComp->GetGameObject()->GetComponent<AnimatorComponent>();
+                        const glm::mat4* skinning = animator && !animator->GetSkinningMatrices().empty()
+                                                        ? animator->GetSkinningMatrices().data() : nullptr;
+                        uint32_t jointCount = skinning ? static_cast<uint32_t>(animator->GetSkinningMatrices().size()) : 0;
                         // TODO: Add Culling
                         for (const auto* meshPtr : meshComp->GetMeshes()) {
-                            renderables.push_back({const_cast<Mesh*>(meshPtr), transformComp});
+                            renderables.push_back({const_cast<Mesh*>(meshPtr), transformComp, skinning, jointCount});
                         }
                     }
                 }
+                // Instance batches are culled per chunk by the renderer.
+                const auto& instancedComponents = m_CurrentScene->GetComponentsOfType<InstancedMeshComponent>();
+                instancedBatches.reserve(instancedComponents.size());
+                for (Component* component : instancedComponents) {
+                    auto* instancedComp = static_cast<InstancedMeshComponent*>(component);
+                    instancedBatches.push_back({instancedComp, instancedComp->GetGameObject()->GetComponent<TransformComponent>()});
+                }
+                // Particle emitters are simulated and drawn entirely on the GPU.
+                const auto& emitterComponents = m_CurrentScene->GetComponentsOfType<ParticleEmitterComponent>();
+                particleEmitters.reserve(emitterComponents.size());
+                for (Component* component : emitterComponents) {
+                    auto* emitter = static_cast<ParticleEmitterComponent*>(component);
+                    particleEmitters.push_back({emitter, emitter->GetGameObject()->GetComponent<TransformComponent>()});
+                }
             }
 
-            m_Renderer->RecordCommands(renderables, camera); // Renderer calls UIManager::RenderDrawData internally
+            m_Renderer->RecordCommands(renderables, instancedBatches, particleEmitters, camera); // Renderer calls UIManager::RenderDrawData internally
             m_Renderer->EndFrameAndPresent();
         }
+        // Frees GPU data of models unloaded by world streaming once no frame in flight can use it.
+        if (m_AssetManager) m_AssetManager->CollectGarbage();
 
         // --- Update Input Manager State (End of frame) ---
         InputManager::Update();
+
+        // --- Performance Counters (End of frame) ---
+        int64_t pendingLoads = 0;
+        if (m_SceneLoader && m_SceneLoader->IsLoading()) {
+            SceneStreamLoader::Progress progress = m_SceneLoader->GetProgress();
+            pendingLoads += static_cast<int64_t>(progress.assetCount - progress.assetsResolved);
+        }
+        if (m_WorldPartition) pendingLoads += static_cast<int64_t>(m_WorldPartition->GetStats().loadingCells);
+        PerfCounters::Set(PerfCounter_PendingAssetLoads, pendingLoads);
+        // Unclamped, and measured to here so the frame's own work and waits are all included.
+        PerfCounters::EndFrame(static_cast<float>(glfwGetTime() - currentTime));
     }
 
 
     void Application::Cleanup() {
         VKENG_INFO("Cleaning up Application...");
+        PerfCounters::StopCsvCapture(); // Flushes a capture still running
         if (m_Renderer) m_Renderer->WaitForDeviceIdle();
 
-        if (m_CurrentScene && m_PhysicsSystem) {
-            VKENG_INFO("Cleaning up RigidBody Components...");
-            for (const auto& go : m_CurrentScene->GetAllGameObjects()) {
-                if (auto* rbComp = go->GetComponent<RigidBodyComponent>()) {
-                    rbComp->CleanupPhysics(m_PhysicsSystem.get());
-                }
-            }
-        }
+        m_SceneLoader.reset();
+        m_WorldPartition.reset(); // Unloads its cells, including their physics bodies
+        VKENG_INFO("Cleaning up RigidBody Components...");
+        CleanupScenePhysics();
 
         m_UIManager.reset(); VKENG_INFO("UIManager destroyed.");
         m_CurrentScene.reset(); VKENG_INFO("Scene destroyed.");
@@ -302,6 +633,8 @@ namespace VulkEng {
 
         InputManager::Shutdown(); VKENG_INFO("InputManager shutdown.");
         m_Window.reset(); VKENG_INFO("Window destroyed.");
+        ServiceLocator::Provide(static_cast<JobSystem*>(nullptr));
+        m_JobSystem.reset(); VKENG_INFO("JobSystem destroyed.");
 
         // Only terminate GLFW if it was initialized (which it should be if Window wasn't skipped)
         // The static bool in Window.cpp can also be used here for a more robust check.
@@ -3,9 +3,14 @@
 #include "Window.h"
 #include "graphics/Renderer.h"
 #include "ui/UIManager.h"
+#include "ui/PerfHud.h"
 #include "assets/AssetManager.h"
 #include "scene/Scene.h"
 #include "physics/PhysicsSystem.h"
+#include "core/JobSystem.h"
+#include "core/FrameArena.h"
+#include "scene/SceneSerializer.h"
+#include "scene/WorldPartition.h"
 // #include "graphics/CommandManager.h" // If App owns it, not Renderer
 
 #include <memory> // For std::unique_ptr
@@ -31,16 +36,35 @@ namespace VulkEng {
 
         void HandleCameraInput(float deltaTime); // Helper for camera controls
 
+        // Replaces m_CurrentScene with an empty scene and registers its systems.
+        void CreateEmptyScene();
+        // Procedural fallback used when no saved scene exists. `modelHandle` is the default model
+        // imported during startup (InvalidModelHandle if that failed).
+        void BuildDefaultScene(ModelHandle modelHandle);
+        // Starts streaming `filepath` into a fresh scene.
+        void LoadScene(const std::string& filepath);
+        // Opens the baked world partition, if there is one, for the current scene.
+        void OpenWorldPartition();
+        void CleanupScenePhysics();
+        void ApplyWindowAspectToMainCamera();
+
+        std::unique_ptr<JobSystem> m_JobSystem;
         std::unique_ptr<Window> m_Window;
         std::unique_ptr<Renderer> m_Renderer;
         // std::unique_ptr<CommandManager> m_CommandManager; // If Application owns it
         std::unique_ptr<AssetManager> m_AssetManager;
         std::unique_ptr<UIManager> m_UIManager;
+        PerfHud m_PerfHud; // Counters, frame-time histograms and CSV capture (see PerfCounters)
         std::unique_ptr<PhysicsSystem> m_PhysicsSystem;
         std::unique_ptr<Scene> m_CurrentScene;
+        std::unique_ptr<SceneStreamLoader> m_SceneLoader; // Non-null while a scene is streaming in
+        std::unique_ptr<WorldPartition> m_WorldPartition; // Streams world cells around the camera into m_CurrentScene
+
+        // Scratch memory for per-frame temporaries (renderables list etc.), reset at the start of each frame.
+        FrameArena m_FrameArena;
 
         bool m_IsRunning = true;
-        float m_LastFrameTime = 0.0f;
+        double m_LastFrameTime = 0.0;
 
         // Camera Control Members
         float m_CameraMoveSpeed = 5.0f;
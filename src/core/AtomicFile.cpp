@@ -0,0 +1,34 @@
+#include "AtomicFile.h"
+
+#include <fstream>
+#include <system_error>
+
+namespace VulkEng {
+
+    bool WriteFileAtomically(const std::filesystem::path& path, const std::function<bool(std::ostream&)>& writeContents,
+                             std::string* outError /*= nullptr*/) {
+        std::error_code error;
+        if (path.has_parent_path()) {
+            std::filesystem::create_directories(path.parent_path(), error);
+        }
+        std::filesystem::path tempPath = path;
+        tempPath += ".tmp";
+        {
+            std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+            if (!file.is_open() || !writeContents(file) || !file.flush()) {
+                if (outError) *outError = "could not write '" + tempPath.string() + "'";
+                file.close();
+                std::filesystem::remove(tempPath, error);
+                return false;
+            }
+        }
+        std::filesystem::rename(tempPath, path, error);
+        if (error) {
+            if (outError) *outError = error.message();
+            std::filesystem::remove(tempPath, error);
+            return false;
+        }
+        return true;
+    }
+
+} // namespace VulkEng
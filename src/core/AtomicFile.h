@@ -0,0 +1,16 @@
+#pragma once
+
+#include <filesystem>
+#include <functional>
+#include <ostream>
+#include <string>
+
+namespace VulkEng {
+
+    // Writes `path` by calling `writeContents` on a stream to "<path>.tmp", then renaming it over `path`,
+    // so an interrupted write never leaves a truncated file behind. Creates missing parent directories.
+    // `writeContents` returns false to abandon the write. On failure, `outError` (if given) says why.
+    bool WriteFileAtomically(const std::filesystem::path& path, const std::function<bool(std::ostream&)>& writeContents,
+                             std::string* outError = nullptr);
+
+} // namespace VulkEng
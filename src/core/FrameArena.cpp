@@ -0,0 +1,87 @@
+#include "FrameArena.h"
+
+#include <algorithm> // For std::max
+#include <new>       // For operator new/delete
+
+namespace VulkEng {
+
+    FrameArena::FrameArena(size_t initialCapacity) {
+        AddBlock(std::max<size_t>(initialCapacity, 1024));
+    }
+
+    FrameArena::~FrameArena() {
+        FreeBlocks();
+    }
+
+    void* FrameArena::Allocate(size_t size, size_t alignment) {
+        if (size == 0) {
+            size = 1; // Keep returned pointers distinct
+        }
+
+        while (true) {
+            Block& block = m_Blocks[m_CurrentBlock];
+            const uintptr_t base = reinterpret_cast<uintptr_t>(block.memory);
+            const uintptr_t aligned = (base + m_Offset + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+            const size_t newOffset = static_cast<size_t>(aligned - base) + size;
+            if (newOffset <= block.size) {
+                m_BytesUsed += newOffset - m_Offset;
+                m_Offset = newOffset;
+                return reinterpret_cast<void*>(aligned);
+            }
+
+            // Move on to the next block, adding one if we're at the end of the chain.
+            if (m_CurrentBlock + 1 == m_Blocks.size()) {
+                AddBlock(std::max(size + alignment, block.size * 2));
+            }
+            ++m_CurrentBlock;
+            m_Offset = 0;
+        }
+    }
+
+    void FrameArena::Reset() {
+        m_PeakBytesUsed = std::max(m_PeakBytesUsed, m_BytesUsed);
+
+        // Overflowed into extra blocks this frame: replace the chain with one block that fits.
+        if (m_Blocks.size() > 1) {
+            size_t totalSize = 0;
+            for (const Block& block : m_Blocks) {
+                totalSize += block.size;
+            }
+            FreeBlocks();
+            AddBlock(totalSize);
+        }
+
+        m_CurrentBlock = 0;
+        m_Offset = 0;
+        m_BytesUsed = 0;
+        ++m_ResetCount;
+    }
+
+    FrameArena::Stats FrameArena::GetStats() const {
+        Stats stats;
+        stats.bytesUsed = m_BytesUsed;
+        stats.peakBytesUsed = std::max(m_PeakBytesUsed, m_BytesUsed);
+        for (const Block& block : m_Blocks) {
+            stats.capacity += block.size;
+        }
+        stats.heapAllocations = m_HeapAllocations;
+        stats.resetCount = m_ResetCount;
+        return stats;
+    }
+
+    void FrameArena::AddBlock(size_t minSize) {
+        Block block;
+        block.size = minSize;
+        block.memory = static_cast<char*>(::operator new(block.size, std::align_val_t(alignof(std::max_align_t))));
+        m_Blocks.push_back(block);
+        ++m_HeapAllocations;
+    }
+
+    void FrameArena::FreeBlocks() {
+        for (Block& block : m_Blocks) {
+            ::operator delete(block.memory, std::align_val_t(alignof(std::max_align_t)));
+        }
+        m_Blocks.clear();
+    }
+
+} // namespace VulkEng
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef> // For size_t
+#include <cstdint>
+#include <vector>
+
+namespace VulkEng {
+
+    // Linear (bump) allocator for per-frame scratch data such as the renderables list.
+    // Allocations are never freed individually; Reset() releases everything at once.
+    // If a frame overflows the current block, extra blocks are chained, and the next Reset()
+    // coalesces them into one block large enough for the peak, so steady state is allocation-free.
+    class FrameArena {
+    public:
+        struct Stats {
+            size_t bytesUsed = 0;        // Bytes handed out since the last Reset
+            size_t peakBytesUsed = 0;    // Highest bytesUsed seen at any Reset
+            size_t capacity = 0;         // Bytes currently reserved
+            uint64_t heapAllocations = 0;// Blocks allocated over the arena's lifetime
+            uint64_t resetCount = 0;
+        };
+
+        explicit FrameArena(size_t initialCapacity = 256 * 1024);
+        ~FrameArena();
+
+        FrameArena(const FrameArena&) = delete;
+        FrameArena& operator=(const FrameArena&) = delete;
+
+        void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+        // Invalidates every allocation made since the previous Reset.
+        void Reset();
+
+        Stats GetStats() const;
+
+    private:
+        struct Block {
+            char* memory = nullptr;
+            size_t size = 0;
+        };
+
+        void AddBlock(size_t minSize);
+        void FreeBlocks();
+
+        std::vector<Block> m_Blocks;
+        size_t m_CurrentBlock = 0;
+        size_t m_Offset = 0;       // Offset into m_Blocks[m_CurrentBlock]
+        size_t m_BytesUsed = 0;
+        size_t m_PeakBytesUsed = 0;
+        uint64_t m_HeapAllocations = 0;
+        uint64_t m_ResetCount = 0;
+    };
+
+    // STL allocator adapter over a FrameArena. deallocate is a no-op; memory is reclaimed on Reset.
+    template <typename T>
+    class ArenaAllocator {
+    public:
+        using value_type = T;
+
+        explicit ArenaAllocator(FrameArena& arena) noexcept : m_Arena(&arena) {}
+        template <typename U>
+        ArenaAllocator(const ArenaAllocator<U>& other) noexcept : m_Arena(other.GetArena()) {}
+
+        T* allocate(size_t count) {
+            return static_cast<T*>(m_Arena->Allocate(count * sizeof(T), alignof(T)));
+        }
+        void deallocate(T*, size_t) noexcept {}
+
+        FrameArena* GetArena() const noexcept { return m_Arena; }
+
+        template <typename U>
+        bool operator==(const ArenaAllocator<U>& other) const noexcept { return m_Arena == other.GetArena(); }
+        template <typename U>
+        bool operator!=(const ArenaAllocator<U>& other) const noexcept { return m_Arena != other.GetArena(); }
+
+    private:
+        FrameArena* m_Arena;
+    };
+
+    // Vector whose storage lives in a FrameArena. Reserve up front where possible:
+    // growth leaves the old buffer behind in the arena until the next Reset.
+    template <typename T>
+    using ScratchVector = std::vector<T, ArenaAllocator<T>>;
+
+} // namespace VulkEng
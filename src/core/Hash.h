@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef> // For size_t
+#include <cstdint>
+#include <string>
+
+namespace VulkEng {
+
+    // 64-bit FNV-1a. Fast, dependency-free, and stable across runs and platforms,
+    // which makes it suitable for content hashes written to disk (scene asset references, caches).
+    constexpr uint64_t FNV1aOffsetBasis = 14695981039346656037ull;
+    constexpr uint64_t FNV1aPrime = 1099511628211ull;
+
+    inline uint64_t HashBytes(const void* data, size_t size, uint64_t seed = FNV1aOffsetBasis) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        uint64_t hash = seed;
+        for (size_t i = 0; i < size; ++i) {
+            hash ^= bytes[i];
+            hash *= FNV1aPrime;
+        }
+        return hash;
+    }
+
+    inline uint64_t HashString(const std::string& text, uint64_t seed = FNV1aOffsetBasis) {
+        return HashBytes(text.data(), text.size(), seed);
+    }
+
+} // namespace VulkEng
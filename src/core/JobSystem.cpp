@@ -0,0 +1,140 @@
+#include "JobSystem.h"
+#include "Log.h"
+
+#include <algorithm> // For std::min, std::max, std::find_if
+
+namespace VulkEng {
+
+    namespace {
+        thread_local uint32_t t_ThreadIndex = 0;
+    }
+
+    JobSystem::JobSystem(uint32_t workerCount) {
+        m_Workers.reserve(workerCount);
+        for (uint32_t i = 0; i < workerCount; ++i) {
+            m_Workers.emplace_back([this, i]() { WorkerLoop(i + 1); });
+        }
+        VKENG_INFO("JobSystem: Started {} worker thread(s).", workerCount);
+    }
+
+    JobSystem::~JobSystem() {
+        {
+            std::lock_guard<std::mutex> lock(m_QueueMutex);
+            m_Stopping = true;
+        }
+        m_QueueCondition.notify_all();
+        for (std::thread& worker : m_Workers) {
+            if (worker.joinable()) {
+                worker.join();
+            }
+        }
+        // Workers drain the queue before exiting, but run anything left if there were none.
+        while (TryRunOneJob()) {}
+        VKENG_INFO("JobSystem: Shut down.");
+    }
+
+    uint32_t JobSystem::DefaultWorkerCount() {
+        uint32_t hardwareThreads = std::thread::hardware_concurrency();
+        return hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+    }
+
+    void JobSystem::Submit(Job job, JobCounter* counter) {
+        if (counter) {
+            counter->m_Pending.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        QueuedJob queuedJob{ std::move(job), counter };
+        if (m_Workers.empty()) {
+            RunJob(queuedJob); // Inline mode
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_QueueMutex);
+            m_Queue.push_back(std::move(queuedJob));
+        }
+        m_QueueCondition.notify_one();
+    }
+
+    void JobSystem::Wait(JobCounter& counter) {
+        while (!counter.IsDone()) {
+            if (!TryRunOneJob(&counter)) {
+                // Remaining jobs are in flight on other threads.
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    void JobSystem::ParallelFor(uint32_t count, uint32_t batchSize, const std::function<void(uint32_t, uint32_t)>& fn) {
+        if (count == 0) {
+            return;
+        }
+        batchSize = std::max(batchSize, 1u);
+
+        // Not worth the queue traffic for a single batch.
+        if (m_Workers.empty() || count <= batchSize) {
+            fn(0, count);
+            return;
+        }
+
+        JobCounter counter;
+        for (uint32_t begin = batchSize; begin < count; begin += batchSize) {
+            uint32_t end = std::min(begin + batchSize, count);
+            Submit([&fn, begin, end]() { fn(begin, end); }, &counter);
+        }
+        // The calling thread takes the first batch itself, then helps with the rest.
+        fn(0, std::min(batchSize, count));
+        Wait(counter);
+    }
+
+    uint32_t JobSystem::GetCurrentThreadIndex() {
+        return t_ThreadIndex;
+    }
+
+    void JobSystem::WorkerLoop(uint32_t threadIndex) {
+        t_ThreadIndex = threadIndex;
+        while (true) {
+            QueuedJob queuedJob;
+            {
+                std::unique_lock<std::mutex> lock(m_QueueMutex);
+                m_QueueCondition.wait(lock, [this]() { return m_Stopping || !m_Queue.empty(); });
+                if (m_Queue.empty()) {
+                    return; // Stopping and nothing left to do
+                }
+                queuedJob = std::move(m_Queue.front());
+                m_Queue.pop_front();
+            }
+            RunJob(queuedJob);
+        }
+    }
+
+    bool JobSystem::TryRunOneJob(const JobCounter* counter) {
+        QueuedJob queuedJob;
+        {
+            std::lock_guard<std::mutex> lock(m_QueueMutex);
+            auto it = counter ? std::find_if(m_Queue.begin(), m_Queue.end(),
+                                             [counter](const QueuedJob& queued) { return queued.counter == counter; })
+                              : m_Queue.begin();
+            if (it == m_Queue.end()) {
+                return false;
+            }
+            queuedJob = std::move(*it);
+            m_Queue.erase(it);
+        }
+        RunJob(queuedJob);
+        return true;
+    }
+
+    void JobSystem::RunJob(QueuedJob& queuedJob) {
+        try {
+            queuedJob.job();
+        } catch (const std::exception& e) {
+            // Jobs must not take the worker down with them.
+            VKENG_ERROR("JobSystem: Job threw an exception: {}", e.what());
+        }
+        if (queuedJob.counter) {
+            queuedJob.counter->m_Pending.fetch_sub(1, std::memory_order_acq_rel);
+        }
+    }
+
+} // namespace VulkEng
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <atomic>             // For std::atomic (JobCounter)
+#include <condition_variable> // For waking idle workers
+#include <cstdint>
+#include <deque>
+#include <functional>         // For std::function (Job)
+#include <future>             // For std::future (Async)
+#include <memory>             // For std::shared_ptr (packaged tasks)
+#include <mutex>
+#include <thread>
+#include <type_traits>        // For std::invoke_result_t
+#include <vector>
+
+namespace VulkEng {
+
+    // Tracks how many jobs submitted against it are still outstanding.
+    // Pass it to JobSystem::Submit and wait on it with JobSystem::Wait.
+    class JobCounter {
+    public:
+        bool IsDone() const { return m_Pending.load(std::memory_order_acquire) == 0; }
+
+    private:
+        friend class JobSystem;
+        std::atomic<uint32_t> m_Pending{0};
+    };
+
+    // Fixed-size pool of worker threads with a shared FIFO job queue.
+    // Threads that wait on a JobCounter help by executing the queued jobs of that counter, so nested
+    // parallelism (a job that itself calls ParallelFor) cannot deadlock the pool. They never pick up
+    // unrelated work, so a frame waiting on its own jobs isn't stalled by an asset import or a
+    // shader compile that happens to be next in the queue.
+    class JobSystem {
+    public:
+        using Job = std::function<void()>;
+
+        // workerCount == 0 creates no threads; every job then runs inline on the submitting thread.
+        explicit JobSystem(uint32_t workerCount);
+        // Drains the queue and joins all workers.
+        virtual ~JobSystem();
+
+        JobSystem(const JobSystem&) = delete;
+        JobSystem& operator=(const JobSystem&) = delete;
+
+        // One worker per hardware thread, minus the main thread (which participates while waiting).
+        static uint32_t DefaultWorkerCount();
+
+        // Queues a job. If `counter` is provided it is incremented now and decremented when the job finishes.
+        void Submit(Job job, JobCounter* counter = nullptr);
+
+        // Blocks until `counter` reaches zero, executing its queued jobs on the calling thread meanwhile.
+        void Wait(JobCounter& counter);
+
+        // Splits [0, count) into batches of `batchSize` and calls fn(begin, end) for each batch
+        // across the workers and the calling thread. Returns once every batch has completed.
+        void ParallelFor(uint32_t count, uint32_t batchSize, const std::function<void(uint32_t, uint32_t)>& fn);
+
+        // Runs `func` on a worker and returns a future for its result.
+        template <typename F>
+        auto Async(F&& func) -> std::future<std::invoke_result_t<std::decay_t<F>>> {
+            using ResultType = std::invoke_result_t<std::decay_t<F>>;
+            // std::function requires a copyable callable, so the task is shared.
+            auto task = std::make_shared<std::packaged_task<ResultType()>>(std::forward<F>(func));
+            std::future<ResultType> future = task->get_future();
+            Submit([task]() { (*task)(); });
+            return future;
+        }
+
+        uint32_t GetWorkerCount() const { return static_cast<uint32_t>(m_Workers.size()); }
+        // 1..GetWorkerCount() on this pool's workers, 0 on any other thread (the main thread). Lets
+        // systems keep per-thread state, like command pools, in GetWorkerCount() + 1 slots.
+        static uint32_t GetCurrentThreadIndex();
+
+    private:
+        struct QueuedJob {
+            Job job;
+            JobCounter* counter = nullptr;
+        };
+
+        void WorkerLoop(uint32_t threadIndex);
+        // Pops and runs one queued job on the calling thread: the oldest one, or with `counter` the
+        // oldest submitted against it. Returns false if there was none.
+        bool TryRunOneJob(const JobCounter* counter = nullptr);
+        static void RunJob(QueuedJob& queuedJob);
+
+        std::vector<std::thread> m_Workers;
+        std::deque<QueuedJob> m_Queue;
+        std::mutex m_QueueMutex;
+        std::condition_variable m_QueueCondition;
+        bool m_Stopping = false;
+    };
+
+} // namespace VulkEng
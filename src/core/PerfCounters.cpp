@@ -0,0 +1,253 @@
+#include "PerfCounters.h"
+#include "core/Log.h"
+
+#include <algorithm> // For std::sort, std::min, std::max
+#include <chrono>
+#include <cmath>     // For std::ceil
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <utility>   // For std::pair
+
+namespace VulkEng {
+
+    namespace {
+        constexpr size_t MaxHitches = 64;
+        constexpr float BaselineRate = 0.05f; // Moving average weight of each non-hitch frame
+
+        struct PerfState {
+            std::mutex registerMutex;
+            std::array<std::string, PerfCounters::MaxCounters> names;
+            std::array<PerfCounterKind, PerfCounters::MaxCounters> kinds{};
+            std::atomic<uint32_t> count{0}; // Published after the name and kind are written
+
+            // [counter * HistoryFrames + slot]; allocated by the first EndFrame.
+            std::vector<int64_t> counterHistory;
+            std::array<float, PerfCounters::HistoryFrames> frameMs{};
+            std::array<uint8_t, PerfCounters::HistoryFrames> frameHitch{};
+            uint32_t cursor = 0; // Slot of the next frame
+            uint32_t filled = 0;
+            uint64_t frameIndex = 0;
+
+            float baselineMs = 0.0f;
+            float hitchFactor = 2.0f;
+            float hitchMinExtraMs = 5.0f;
+            std::deque<PerfCounters::Hitch> hitches;
+
+            std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+            std::ofstream csv;
+            uint32_t csvColumns = 0; // Counters written per row
+            uint64_t csvRows = 0;
+
+            PerfState() {
+                // Same order as PerfCounterIds.
+                const std::pair<const char*, PerfCounterKind> builtIns[PerfCounter_BuiltInCount] = {
+                    {"Draw calls", PerfCounterKind::PerFrame},
+                    {"Descriptor binds", PerfCounterKind::PerFrame},
+                    {"Triangles", PerfCounterKind::PerFrame},
+                    {"Buffer uploads", PerfCounterKind::PerFrame},
+                    {"Buffer upload bytes", PerfCounterKind::PerFrame},
+                    {"Device allocations", PerfCounterKind::PerFrame},
+                    {"Physics bodies", PerfCounterKind::Gauge},
+                    {"Physics contacts", PerfCounterKind::Gauge},
+                    {"Pending asset loads", PerfCounterKind::Gauge},
+                };
+                for (uint32_t id = 0; id < PerfCounter_BuiltInCount; ++id) {
+                    names[id] = builtIns[id].first;
+                    kinds[id] = builtIns[id].second;
+                }
+                count.store(PerfCounter_BuiltInCount, std::memory_order_release);
+            }
+        };
+
+        PerfState& State() {
+            static PerfState state;
+            return state;
+        }
+
+        // Slot of the frame `age` frames before the most recent one.
+        uint32_t HistorySlot(const PerfState& state, uint32_t age) {
+            return (state.cursor + PerfCounters::HistoryFrames - 1 - age) % PerfCounters::HistoryFrames;
+        }
+
+        void WriteCsvName(std::ofstream& csv, const std::string& name) {
+            csv << ",\"";
+            for (char c : name) csv << (c == '"' ? "\"\"" : std::string(1, c));
+            csv << '"';
+        }
+    } // namespace
+
+    PerfCounterId PerfCounters::Register(const std::string& name, PerfCounterKind kind /*= PerfCounterKind::PerFrame*/) {
+        PerfState& state = State();
+        std::lock_guard<std::mutex> lock(state.registerMutex);
+        uint32_t count = state.count.load(std::memory_order_relaxed);
+        for (uint32_t id = 0; id < count; ++id) {
+            if (state.names[id] == name) return id;
+        }
+        if (count == MaxCounters) {
+            VKENG_WARN("PerfCounters: No room for counter '{}' ({} registered); its values are dropped.", name, MaxCounters);
+            return MaxCounters;
+        }
+        state.names[count] = name;
+        state.kinds[count] = kind;
+        s_Values[count].store(0, std::memory_order_relaxed);
+        state.count.store(count + 1, std::memory_order_release);
+        return count;
+    }
+
+    void PerfCounters::EndFrame(float frameSeconds) {
+        PerfState& state = State();
+        if (state.counterHistory.empty()) state.counterHistory.assign(static_cast<size_t>(MaxCounters) * HistoryFrames, 0);
+
+        uint32_t slot = state.cursor;
+        uint32_t count = state.count.load(std::memory_order_acquire);
+        for (uint32_t id = 0; id < count; ++id) {
+            int64_t value = state.kinds[id] == PerfCounterKind::PerFrame ? s_Values[id].exchange(0, std::memory_order_relaxed)
+                                                                         : s_Values[id].load(std::memory_order_relaxed);
+            state.counterHistory[static_cast<size_t>(id) * HistoryFrames + slot] = value;
+        }
+        s_Values[MaxCounters].store(0, std::memory_order_relaxed);
+
+        float frameMs = frameSeconds * 1000.0f;
+        bool hitch = state.baselineMs > 0.0f && frameMs > state.baselineMs * state.hitchFactor &&
+                     frameMs - state.baselineMs >= state.hitchMinExtraMs;
+        if (hitch) {
+            state.hitches.push_back({state.frameIndex, frameMs, state.baselineMs});
+            if (state.hitches.size() > MaxHitches) state.hitches.pop_front();
+        } else {
+            // Hitches stay out of the baseline, so a burst of them doesn't hide the next.
+            state.baselineMs = state.baselineMs > 0.0f ? state.baselineMs + (frameMs - state.baselineMs) * BaselineRate : frameMs;
+        }
+        state.frameMs[slot] = frameMs;
+        state.frameHitch[slot] = hitch ? 1 : 0;
+
+        if (state.csv.is_open()) {
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - state.startTime).count();
+            state.csv << state.frameIndex << ',' << seconds << ',' << frameMs << ',' << (hitch ? 1 : 0);
+            for (uint32_t id = 0; id < state.csvColumns; ++id) {
+                state.csv << ',' << state.counterHistory[static_cast<size_t>(id) * HistoryFrames + slot];
+            }
+            state.csv << '\n';
+            ++state.csvRows;
+        }
+
+        state.cursor = (state.cursor + 1) % HistoryFrames;
+        state.filled = std::min(state.filled + 1, HistoryFrames);
+        ++state.frameIndex;
+    }
+
+    void PerfCounters::SetHitchThreshold(float factor, float minExtraMs) {
+        PerfState& state = State();
+        state.hitchFactor = std::max(factor, 1.0f);
+        state.hitchMinExtraMs = std::max(minExtraMs, 0.0f);
+    }
+
+    uint32_t PerfCounters::GetCounterCount() {
+        return State().count.load(std::memory_order_acquire);
+    }
+
+    const std::string& PerfCounters::GetCounterName(PerfCounterId id) {
+        static const std::string dropped = "(dropped)";
+        return id < GetCounterCount() ? State().names[id] : dropped;
+    }
+
+    PerfCounterKind PerfCounters::GetCounterKind(PerfCounterId id) {
+        return id < GetCounterCount() ? State().kinds[id] : PerfCounterKind::PerFrame;
+    }
+
+    PerfCounters::CounterSummary PerfCounters::GetCounterSummary(PerfCounterId id) {
+        PerfState& state = State();
+        CounterSummary summary;
+        if (id >= GetCounterCount() || state.filled == 0) return summary;
+        const int64_t* history = state.counterHistory.data() + static_cast<size_t>(id) * HistoryFrames;
+        summary.last = history[HistorySlot(state, 0)];
+        summary.peak = summary.last;
+        double total = 0.0;
+        for (uint32_t age = 0; age < state.filled; ++age) {
+            int64_t value = history[HistorySlot(state, age)];
+            total += static_cast<double>(value);
+            summary.peak = std::max(summary.peak, value);
+        }
+        summary.average = total / state.filled;
+        return summary;
+    }
+
+    void PerfCounters::GetFrameTimes(std::vector<float>& outMs, std::vector<uint8_t>& outHitch) {
+        PerfState& state = State();
+        outMs.resize(state.filled);
+        outHitch.resize(state.filled);
+        for (uint32_t i = 0; i < state.filled; ++i) {
+            uint32_t slot = HistorySlot(state, state.filled - 1 - i);
+            outMs[i] = state.frameMs[slot];
+            outHitch[i] = state.frameHitch[slot];
+        }
+    }
+
+    PerfCounters::FrameTimeSummary PerfCounters::GetFrameTimeSummary() {
+        PerfState& state = State();
+        FrameTimeSummary summary;
+        summary.frames = state.filled;
+        if (state.filled == 0) return summary;
+
+        std::array<float, HistoryFrames> sorted;
+        double total = 0.0;
+        for (uint32_t i = 0; i < state.filled; ++i) {
+            sorted[i] = state.frameMs[HistorySlot(state, i)];
+            total += sorted[i];
+        }
+        std::sort(sorted.begin(), sorted.begin() + state.filled);
+        // Nearest rank: the smallest sample with at least `p` of the window at or below it.
+        auto percentile = [&](float p) {
+            uint32_t rank = static_cast<uint32_t>(std::ceil(p * state.filled));
+            return sorted[std::min(std::max(rank, 1u), state.filled) - 1];
+        };
+        summary.p50Ms = percentile(0.50f);
+        summary.p95Ms = percentile(0.95f);
+        summary.p99Ms = percentile(0.99f);
+        summary.maxMs = sorted[state.filled - 1];
+        summary.averageMs = static_cast<float>(total / state.filled);
+        return summary;
+    }
+
+    std::vector<PerfCounters::Hitch> PerfCounters::GetRecentHitches() {
+        const PerfState& state = State();
+        return std::vector<Hitch>(state.hitches.begin(), state.hitches.end());
+    }
+
+    uint64_t PerfCounters::GetFrameIndex() {
+        return State().frameIndex;
+    }
+
+    bool PerfCounters::StartCsvCapture(const std::string& path) {
+        PerfState& state = State();
+        StopCsvCapture();
+        state.csv.open(path, std::ios::out | std::ios::trunc);
+        if (!state.csv.is_open()) {
+            VKENG_ERROR("PerfCounters: Cannot open '{}' for the CSV capture.", path);
+            return false;
+        }
+        state.csvColumns = GetCounterCount();
+        state.csvRows = 0;
+        state.csv << "frame,time_s,frame_ms,hitch";
+        for (uint32_t id = 0; id < state.csvColumns; ++id) WriteCsvName(state.csv, state.names[id]);
+        state.csv << '\n';
+        VKENG_INFO("PerfCounters: Capturing frame counters to '{}'.", path);
+        return true;
+    }
+
+    void PerfCounters::StopCsvCapture() {
+        PerfState& state = State();
+        if (!state.csv.is_open()) return;
+        state.csv.close();
+        VKENG_INFO("PerfCounters: CSV capture stopped after {} frames.", state.csvRows);
+    }
+
+    bool PerfCounters::IsCsvCapturing() {
+        return State().csv.is_open();
+    }
+
+    uint64_t PerfCounters::GetCsvRowCount() {
+        return State().csvRows;
+    }
+
+} // namespace VulkEng
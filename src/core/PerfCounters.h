@@ -0,0 +1,105 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace VulkEng {
+
+    using PerfCounterId = uint32_t;
+
+    // Counters every module can rely on; others are added with PerfCounters::Register.
+    enum PerfCounterIds : PerfCounterId {
+        PerfCounter_DrawCalls,
+        PerfCounter_DescriptorBinds,
+        PerfCounter_Triangles,
+        PerfCounter_BufferUploads,     // Host writes into buffers (uniforms, staging, persistent maps)
+        PerfCounter_BufferUploadBytes,
+        PerfCounter_DeviceAllocations, // vkAllocateMemory calls for buffers and images
+        PerfCounter_PhysicsBodies,
+        PerfCounter_PhysicsContacts,
+        PerfCounter_PendingAssetLoads, // Scene loader imports and world cells still in flight
+        PerfCounter_BuiltInCount,
+    };
+
+    enum class PerfCounterKind : uint8_t {
+        PerFrame, // Summed over a frame, then reset (draw calls, uploads)
+        Gauge,    // A level that holds until set again (bodies, pending loads)
+    };
+
+    // Process-wide performance counters with a rolling per-frame history, frame-time percentiles and
+    // hitch detection, read by the performance HUD and optionally streamed to CSV for soak tests.
+    // Add/Set are lock-free and may be called from any thread; everything else is for the main thread.
+    class PerfCounters {
+    public:
+        static constexpr uint32_t MaxCounters = 64;
+        static constexpr uint32_t HistoryFrames = 1024; // Window of the histograms and percentiles
+
+        struct FrameTimeSummary {
+            float p50Ms = 0.0f;
+            float p95Ms = 0.0f;
+            float p99Ms = 0.0f;
+            float maxMs = 0.0f;
+            float averageMs = 0.0f;
+            uint32_t frames = 0; // Frames in the window
+        };
+
+        struct CounterSummary {
+            int64_t last = 0; // Value of the last completed frame
+            double average = 0.0;
+            int64_t peak = 0;
+        };
+
+        // A frame that took much longer than the recent baseline.
+        struct Hitch {
+            uint64_t frame = 0;
+            float frameMs = 0.0f;
+            float baselineMs = 0.0f;
+        };
+
+        PerfCounters() = delete;
+
+        // Returns the counter called `name`, adding it on first use. Thread-safe. Past MaxCounters,
+        // returns a sink that is never displayed.
+        static PerfCounterId Register(const std::string& name, PerfCounterKind kind = PerfCounterKind::PerFrame);
+
+        static void Add(PerfCounterId id, int64_t amount = 1) { s_Values[id].fetch_add(amount, std::memory_order_relaxed); }
+        static void Set(PerfCounterId id, int64_t value) { s_Values[id].store(value, std::memory_order_relaxed); }
+
+        // Closes the frame: snapshots every counter into the history (resetting per-frame ones),
+        // records the frame time, checks it for a hitch and appends a CSV row when capturing.
+        static void EndFrame(float frameSeconds);
+
+        // --- Hitch Detection ---
+        // A frame is a hitch when it takes more than `factor` times the baseline (a moving average of
+        // non-hitch frames) and at least `minExtraMs` longer than it.
+        static void SetHitchThreshold(float factor, float minExtraMs);
+
+        // --- Queries (main thread) ---
+        static uint32_t GetCounterCount();
+        static const std::string& GetCounterName(PerfCounterId id);
+        static PerfCounterKind GetCounterKind(PerfCounterId id);
+        static CounterSummary GetCounterSummary(PerfCounterId id);
+        // Frame times (and whether each was a hitch) of the window, oldest first.
+        static void GetFrameTimes(std::vector<float>& outMs, std::vector<uint8_t>& outHitch);
+        static FrameTimeSummary GetFrameTimeSummary();
+        // Most recent last; bounded.
+        static std::vector<Hitch> GetRecentHitches();
+        static uint64_t GetFrameIndex();
+
+        // --- CSV Export ---
+        // Streams one row per frame (frame, time, frame ms, hitch flag, then every counter) to `path`
+        // until stopped. Columns are fixed at start; counters registered later are left out.
+        static bool StartCsvCapture(const std::string& path);
+        static void StopCsvCapture();
+        static bool IsCsvCapturing();
+        static uint64_t GetCsvRowCount();
+
+    private:
+        // One more than MaxCounters: the sink for registrations past the limit.
+        inline static std::array<std::atomic<int64_t>, MaxCounters + 1> s_Values{};
+    };
+
+} // namespace VulkEng
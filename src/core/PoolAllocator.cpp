@@ -0,0 +1,124 @@
+#include "PoolAllocator.h"
+#include "Log.h"
+
+#include <algorithm> // For std::max, std::find
+#include <mutex>     // Pools may be created from worker threads (e.g. during scene loading)
+
+namespace VulkEng {
+
+    namespace {
+        // Registry of live pools for ForEachPool. Function-local so it is constructed
+        // before (and destroyed after) any pool that registers with it.
+        struct PoolRegistry {
+            std::mutex mutex;
+            std::vector<PoolAllocator*> pools;
+        };
+
+        PoolRegistry& GetPoolRegistry() {
+            static PoolRegistry s_Registry;
+            return s_Registry;
+        }
+
+        size_t AlignUp(size_t value, size_t alignment) {
+            return (value + alignment - 1) / alignment * alignment;
+        }
+    }
+
+    PoolAllocator::PoolAllocator(std::string name, size_t blockSize, size_t blockAlignment, size_t blocksPerChunk)
+        : m_Name(std::move(name)),
+          m_BlockAlignment(std::max(blockAlignment, alignof(FreeBlock))),
+          m_BlocksPerChunk(std::max<size_t>(blocksPerChunk, 1)) {
+        // Every block must be able to hold the free-list link and keep the next block aligned.
+        m_BlockSize = AlignUp(std::max(blockSize, sizeof(FreeBlock)), m_BlockAlignment);
+
+        PoolRegistry& registry = GetPoolRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        registry.pools.push_back(this);
+    }
+
+    PoolAllocator::~PoolAllocator() {
+        {
+            PoolRegistry& registry = GetPoolRegistry();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            registry.pools.erase(std::remove(registry.pools.begin(), registry.pools.end(), this), registry.pools.end());
+        }
+
+        if (m_LiveBlocks != 0) {
+            // Objects still referencing this memory will dangle; this indicates a leak upstream.
+            VKENG_WARN("PoolAllocator '{}': Destroyed with {} live block(s).", m_Name, m_LiveBlocks);
+        }
+        for (void* chunk : m_Chunks) {
+            ::operator delete(chunk, std::align_val_t(m_BlockAlignment));
+        }
+        m_Chunks.clear();
+        m_FreeList = nullptr;
+    }
+
+    void* PoolAllocator::Allocate() {
+        if (!m_FreeList) {
+            AllocateChunk(m_BlocksPerChunk);
+        }
+        FreeBlock* block = m_FreeList;
+        m_FreeList = block->next;
+        ++m_LiveBlocks;
+        ++m_TotalAllocations;
+        return block;
+    }
+
+    void PoolAllocator::Deallocate(void* block) {
+        if (!block) {
+            return;
+        }
+        FreeBlock* freeBlock = static_cast<FreeBlock*>(block);
+        freeBlock->next = m_FreeList;
+        m_FreeList = freeBlock;
+        --m_LiveBlocks;
+        ++m_TotalDeallocations;
+    }
+
+    void PoolAllocator::Reserve(size_t blockCount) {
+        const size_t freeBlocks = m_CapacityBlocks - m_LiveBlocks;
+        if (blockCount > freeBlocks) {
+            AllocateChunk(std::max(blockCount - freeBlocks, m_BlocksPerChunk));
+        }
+    }
+
+    void PoolAllocator::AllocateChunk(size_t blockCount) {
+        const size_t chunkBytes = m_BlockSize * blockCount;
+        char* chunk = static_cast<char*>(::operator new(chunkBytes, std::align_val_t(m_BlockAlignment)));
+        m_Chunks.push_back(chunk);
+        m_CapacityBlocks += blockCount;
+
+        // Thread the new blocks onto the free list in address order so consecutive
+        // allocations are contiguous in memory.
+        for (size_t i = blockCount; i-- > 0;) {
+            FreeBlock* block = reinterpret_cast<FreeBlock*>(chunk + i * m_BlockSize);
+            block->next = m_FreeList;
+            m_FreeList = block;
+        }
+    }
+
+    PoolAllocator::Stats PoolAllocator::GetStats() const {
+        Stats stats;
+        stats.name = m_Name;
+        stats.blockSize = m_BlockSize;
+        stats.chunkCount = m_Chunks.size();
+        stats.capacityBlocks = m_CapacityBlocks;
+        stats.liveBlocks = m_LiveBlocks;
+        stats.totalAllocations = m_TotalAllocations;
+        stats.totalDeallocations = m_TotalDeallocations;
+        stats.fragmentation = stats.capacityBlocks > 0
+            ? 1.0f - static_cast<float>(m_LiveBlocks) / static_cast<float>(stats.capacityBlocks)
+            : 0.0f;
+        return stats;
+    }
+
+    void PoolAllocator::ForEachPool(const std::function<void(const PoolAllocator&)>& visitor) {
+        PoolRegistry& registry = GetPoolRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        for (const PoolAllocator* pool : registry.pools) {
+            visitor(*pool);
+        }
+    }
+
+} // namespace VulkEng
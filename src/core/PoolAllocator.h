@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstddef>    // For size_t
+#include <cstdint>
+#include <functional> // For ForEachPool callback
+#include <memory>     // For std::unique_ptr
+#include <new>        // For placement new
+#include <string>
+#include <typeinfo>   // For typeid (pool names)
+#include <utility>    // For std::forward
+#include <vector>
+
+namespace VulkEng {
+
+    // Fixed-size block allocator. Memory is reserved in chunks of `blocksPerChunk` blocks and
+    // handed out through an intrusive free list, so Allocate/Deallocate are O(1) and never touch
+    // the heap once the pool has warmed up. Not thread-safe: allocate from the main thread only.
+    class PoolAllocator {
+    public:
+        struct Stats {
+            std::string name;
+            size_t blockSize = 0;
+            size_t chunkCount = 0;        // Heap allocations made by the pool itself
+            size_t capacityBlocks = 0;    // Blocks reserved across all chunks
+            size_t liveBlocks = 0;        // Blocks currently handed out
+            uint64_t totalAllocations = 0;
+            uint64_t totalDeallocations = 0;
+            // Share of reserved blocks currently unused (0 = fully packed).
+            float fragmentation = 0.0f;
+        };
+
+        PoolAllocator(std::string name, size_t blockSize, size_t blockAlignment, size_t blocksPerChunk = 256);
+        ~PoolAllocator();
+
+        PoolAllocator(const PoolAllocator&) = delete;
+        PoolAllocator& operator=(const PoolAllocator&) = delete;
+
+        void* Allocate();
+        void Deallocate(void* block);
+        // Ensures at least `blockCount` free blocks, reserving the shortfall as one chunk.
+        // Bulk loaders call this before creating many objects so they land contiguously.
+        void Reserve(size_t blockCount);
+
+        Stats GetStats() const;
+        const std::string& GetName() const { return m_Name; }
+
+        // Visits every live PoolAllocator (for debug UI and memory reports).
+        static void ForEachPool(const std::function<void(const PoolAllocator&)>& visitor);
+
+    private:
+        struct FreeBlock {
+            FreeBlock* next;
+        };
+
+        void AllocateChunk(size_t blockCount);
+
+        std::string m_Name;
+        size_t m_BlockSize;
+        size_t m_BlockAlignment;
+        size_t m_BlocksPerChunk;
+
+        std::vector<void*> m_Chunks;
+        FreeBlock* m_FreeList = nullptr;
+        size_t m_CapacityBlocks = 0;
+        size_t m_LiveBlocks = 0;
+        uint64_t m_TotalAllocations = 0;
+        uint64_t m_TotalDeallocations = 0;
+    };
+
+    // unique_ptr deleter for objects constructed in a PoolAllocator.
+    // `destroy` is instantiated for the concrete type, so deleting through a base pointer
+    // still runs the right destructor and returns the original block address to the pool.
+    template <typename Base>
+    struct PoolDeleter {
+        PoolAllocator* pool = nullptr;
+        void (*destroy)(Base*, PoolAllocator*) = nullptr;
+
+        void operator()(Base* object) const {
+            if (object && destroy) {
+                destroy(object, pool);
+            }
+        }
+    };
+
+    template <typename Base>
+    using PoolPtr = std::unique_ptr<Base, PoolDeleter<Base>>;
+
+    // Constructs a T inside `pool` and returns it as an owning pointer to Base.
+    template <typename Base, typename T, typename... Args>
+    PoolPtr<Base> MakePooled(PoolAllocator& pool, Args&&... args) {
+        void* block = pool.Allocate();
+        T* object = nullptr;
+        try {
+            object = new (block) T(std::forward<Args>(args)...);
+        } catch (...) {
+            pool.Deallocate(block);
+            throw;
+        }
+        PoolDeleter<Base> deleter;
+        deleter.pool = &pool;
+        deleter.destroy = [](Base* base, PoolAllocator* owner) {
+            T* derived = static_cast<T*>(base);
+            derived->~T();
+            owner->Deallocate(derived);
+        };
+        return PoolPtr<Base>(object, deleter);
+    }
+
+    // One shared pool per type, created on first use.
+    template <typename T>
+    PoolAllocator& GetTypePool(size_t blocksPerChunk = 256) {
+        static PoolAllocator s_Pool(typeid(T).name(), sizeof(T), alignof(T), blocksPerChunk);
+        return s_Pool;
+    }
+
+} // namespace VulkEng
@@ -14,6 +14,7 @@
 #include "core/Window.h"
 #include "graphics/VulkanContext.h"
 #include "graphics/CommandManager.h"
+#include "core/JobSystem.h"
 
 #include <stdexcept> // For std::runtime_error
 #include <cstddef>   // For nullptr_t (though not strictly needed with inline static init)
@@ -64,10 +65,11 @@ namespace VulkEng {
             VKENG_WARN_ONCE("NullRenderer instance created. Rendering will not function.");
         }
         bool BeginFrame() override { return false; }
-        void RecordCommands(const std::vector<RenderObjectInfo>&, CameraComponent*) override {}
+        void RecordCommands(const RenderObjectList&, const InstancedRenderList&, const ParticleRenderList&, CameraComponent*) override {}
         void EndFrameAndPresent() override {}
         void HandleResize(int, int) override {}
         void WaitForDeviceIdle() override {}
+        void SetReversedZ(bool) override {}
         VulkanContext& GetContext() override { return m_NullContextForServices; }
         VkCommandBuffer GetCurrentCommandBuffer() override { return VK_NULL_HANDLE; }
         VkRenderPass GetMainRenderPass() const override { return VK_NULL_HANDLE; }
@@ -108,8 +110,9 @@ namespace VulkEng {
         NullUIManager() : UIManager(NullRenderer::m_NullWindowForServices, NullRenderer::m_NullContextForServices, VK_NULL_HANDLE, true) {
             VKENG_WARN_ONCE("NullUIManager instance created. UI will not function.");
         }
-        void BeginUIRender() override {}
+        bool BeginUIRender() override { return false; }
         void EndUIRender() override {}
+        bool IsLayerDirty() const override { return false; } // The renderer still clears the layer once
         void RenderDrawData(VkCommandBuffer) override {}
     };
 
@@ -135,6 +138,9 @@ namespace VulkEng {
         static void Provide(UIManager* ui) {
             s_UIManager = (ui == nullptr) ? &m_StaticNullUIManager : ui;
         }
+        static void Provide(JobSystem* jobs) {
+            s_JobSystem = (jobs == nullptr) ? &m_StaticInlineJobSystem : jobs;
+        }
         // Add Provide methods for other services...
 
 
@@ -145,6 +151,7 @@ namespace VulkEng {
         static AssetManager& GetAssetManager() { return *s_AssetManager; }
         static PhysicsSystem& GetPhysicsSystem() { return *s_PhysicsSystem; }
         static UIManager& GetUIManager() { return *s_UIManager; }
+        static JobSystem& GetJobSystem() { return *s_JobSystem; }
         // Add Get methods for other services...
 
 
@@ -155,6 +162,7 @@ namespace VulkEng {
               s_AssetManager = &m_StaticNullAssetManager;
               s_PhysicsSystem = &m_StaticNullPhysicsSystem;
               s_UIManager = &m_StaticNullUIManager;
+              s_JobSystem = &m_StaticInlineJobSystem;
               // Reset other services...
               VKENG_INFO("ServiceLocator: Services reset to Null implementations.");
          }
@@ -166,6 +174,8 @@ namespace VulkEng {
         inline static NullAssetManager m_StaticNullAssetManager;
         inline static NullPhysicsSystem m_StaticNullPhysicsSystem;
         inline static NullUIManager m_StaticNullUIManager;
+        // A JobSystem without workers runs every job inline, so it doubles as the null service.
+        inline static JobSystem m_StaticInlineJobSystem{0};
         // Add instances for other Null services...
 
         // --- Static Service Pointers ---
@@ -175,6 +185,7 @@ namespace VulkEng {
         inline static AssetManager* s_AssetManager = &m_StaticNullAssetManager;
         inline static PhysicsSystem* s_PhysicsSystem = &m_StaticNullPhysicsSystem;
         inline static UIManager* s_UIManager = &m_StaticNullUIManager;
+        inline static JobSystem* s_JobSystem = &m_StaticInlineJobSystem;
         // Add pointers for other services...
     };
 
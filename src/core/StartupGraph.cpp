@@ -0,0 +1,121 @@
+#include "StartupGraph.h"
+#include "JobSystem.h"
+#include "Log.h"
+
+#include <stdexcept> // For std::invalid_argument
+#include <thread>    // For std::this_thread::get_id
+
+namespace VulkEng {
+
+    namespace {
+        double ToMilliseconds(std::chrono::steady_clock::duration duration) {
+            return std::chrono::duration<double, std::milli>(duration).count();
+        }
+    }
+
+    StartupGraph::TaskId StartupGraph::Add(std::string name, Affinity affinity, Task task, std::initializer_list<TaskId> dependencies) {
+        TaskId id = static_cast<TaskId>(m_Nodes.size());
+        Node node;
+        node.name = std::move(name);
+        node.affinity = affinity;
+        node.task = std::move(task);
+        for (TaskId dependency : dependencies) {
+            if (dependency >= id) {
+                throw std::invalid_argument("StartupGraph: Step '" + node.name + "' depends on a step added after it.");
+            }
+            m_Nodes[dependency].dependents.push_back(id);
+            ++node.pendingDependencies;
+        }
+        m_Nodes.push_back(std::move(node));
+        return id;
+    }
+
+    void StartupGraph::Run() {
+        m_MainThread = std::this_thread::get_id();
+        Clock::time_point graphStart = Clock::now();
+
+        std::vector<TaskId> ready;
+        for (TaskId id = 0; id < m_Nodes.size(); ++id) {
+            if (m_Nodes[id].pendingDependencies == 0) ready.push_back(id);
+        }
+        for (TaskId id : ready) Schedule(id);
+
+        // The main thread runs main-thread steps as they become ready and otherwise sleeps
+        // until a worker finishes something.
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        while (m_Finished < m_Nodes.size()) {
+            if (m_MainQueue.empty()) {
+                m_Condition.wait(lock);
+                continue;
+            }
+            TaskId id = m_MainQueue.front();
+            m_MainQueue.pop_front();
+            lock.unlock();
+            Execute(id);
+            lock.lock();
+        }
+        lock.unlock();
+
+        LogTimeline(graphStart, Clock::now());
+        if (m_FirstError) std::rethrow_exception(m_FirstError);
+    }
+
+    void StartupGraph::Schedule(TaskId id) {
+        if (m_Nodes[id].affinity == Affinity::MainThread) {
+            {
+                std::lock_guard<std::mutex> lock(m_Mutex);
+                m_MainQueue.push_back(id);
+            }
+            m_Condition.notify_all();
+        } else {
+            // Not under m_Mutex: without workers, Submit runs the job inline.
+            m_JobSystem.Submit([this, id]() { Execute(id); });
+        }
+    }
+
+    void StartupGraph::Execute(TaskId id) {
+        Node& node = m_Nodes[id];
+        node.ranOnMain = std::this_thread::get_id() == m_MainThread;
+        node.start = Clock::now();
+        bool failed = node.skipped;
+        if (!node.skipped) {
+            try {
+                node.task();
+            } catch (...) {
+                failed = true;
+                std::lock_guard<std::mutex> lock(m_Mutex);
+                if (!m_FirstError) m_FirstError = std::current_exception();
+                VKENG_ERROR("StartupGraph: Step '{}' failed; skipping the steps that depend on it.", node.name);
+            }
+        }
+        node.end = Clock::now();
+
+        std::vector<TaskId> ready;
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            for (TaskId dependent : node.dependents) {
+                if (failed) m_Nodes[dependent].skipped = true;
+                if (--m_Nodes[dependent].pendingDependencies == 0) ready.push_back(dependent);
+            }
+            ++m_Finished;
+        }
+        m_Condition.notify_all();
+        for (TaskId dependent : ready) Schedule(dependent);
+    }
+
+    void StartupGraph::LogTimeline(Clock::time_point graphStart, Clock::time_point graphEnd) const {
+        double busyMs = 0.0;
+        VKENG_INFO("Startup timeline (ms from start):");
+        for (const Node& node : m_Nodes) {
+            double durationMs = ToMilliseconds(node.end - node.start);
+            busyMs += durationMs;
+            VKENG_INFO("  {:<24} {:8.1f} -> {:8.1f} ({:7.1f}) {}{}", node.name,
+                       ToMilliseconds(node.start - graphStart), ToMilliseconds(node.end - graphStart), durationMs,
+                       node.ranOnMain ? "main" : "worker", node.skipped ? ", skipped" : "");
+        }
+        double wallMs = ToMilliseconds(graphEnd - graphStart);
+        VKENG_INFO("Startup took {:.1f} ms for {:.1f} ms of work ({:.2f}x overlap).", wallMs, busyMs,
+                   wallMs > 0.0 ? busyMs / wallMs : 1.0);
+    }
+
+} // namespace VulkEng
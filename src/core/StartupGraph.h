@@ -0,0 +1,76 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <initializer_list>
+#include <mutex>
+#include <string>
+#include <thread> // For std::thread::id
+#include <vector>
+
+namespace VulkEng {
+
+    class JobSystem;
+
+    // Dependency graph of initialization steps. Steps whose dependencies have finished run
+    // concurrently: worker-safe steps on the JobSystem, main-thread steps (window, device,
+    // anything touching GLFW or the ImGui backends) on the thread that calls Run().
+    // Run() logs when each step started and finished, so startup regressions show up in the log.
+    class StartupGraph {
+    public:
+        using TaskId = uint32_t;
+        using Task = std::function<void()>;
+
+        enum class Affinity {
+            AnyThread,
+            MainThread
+        };
+
+        explicit StartupGraph(JobSystem& jobSystem) : m_JobSystem(jobSystem) {}
+
+        StartupGraph(const StartupGraph&) = delete;
+        StartupGraph& operator=(const StartupGraph&) = delete;
+
+        // Dependencies must have been added before the step that names them.
+        TaskId Add(std::string name, Affinity affinity, Task task, std::initializer_list<TaskId> dependencies = {});
+
+        // Runs every step and returns once all have finished. If a step throws, steps depending on
+        // it are skipped, the others still finish, and the first exception is rethrown here.
+        void Run();
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        struct Node {
+            std::string name;
+            Affinity affinity = Affinity::AnyThread;
+            Task task;
+            std::vector<TaskId> dependents;
+            uint32_t pendingDependencies = 0;
+            bool skipped = false;   // A dependency failed
+            bool ranOnMain = false;
+            Clock::time_point start;
+            Clock::time_point end;
+        };
+
+        // Hands a step whose dependencies are done to the main thread or the workers.
+        void Schedule(TaskId id);
+        void Execute(TaskId id);
+        void LogTimeline(Clock::time_point graphStart, Clock::time_point graphEnd) const;
+
+        JobSystem& m_JobSystem;
+        std::vector<Node> m_Nodes;
+        std::thread::id m_MainThread;
+
+        std::mutex m_Mutex; // Guards everything below and the nodes' scheduling state
+        std::condition_variable m_Condition;
+        std::deque<TaskId> m_MainQueue;
+        uint32_t m_Finished = 0;
+        std::exception_ptr m_FirstError;
+    };
+
+} // namespace VulkEng
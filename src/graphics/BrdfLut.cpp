@@ -0,0 +1,117 @@
+#include "BrdfLut.h"
+#include "GgxSampling.h"
+#include "core/AtomicFile.h"
+#include "core/Log.h"
+#include "core/ServiceLocator.h" // For the JobSystem
+
+#include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp> // For glm::packHalf1x16
+
+#include <algorithm> // For std::max
+#include <cmath>
+#include <fstream>
+
+namespace VulkEng {
+
+    namespace {
+        constexpr uint32_t CacheMagic = 0x54554C42; // "BLUT"
+        constexpr uint32_t CacheVersion = 1;       // Bump when the integration below changes
+
+        struct CacheHeader {
+            uint32_t magic = CacheMagic;
+            uint32_t version = CacheVersion;
+            uint32_t size = 0;
+            uint32_t sampleCount = 0;
+        };
+
+        // Smith-Schlick G with k = alpha / 2, the remapping Karis uses for image-based lighting.
+        float GeometrySmith(float NdotV, float NdotL, float roughness) {
+            float k = roughness * roughness / 2.0f;
+            float gV = NdotV / (NdotV * (1.0f - k) + k);
+            float gL = NdotL / (NdotL * (1.0f - k) + k);
+            return gV * gL;
+        }
+
+        glm::vec2 IntegrateBrdf(float NdotV, float roughness, uint32_t sampleCount) {
+            glm::vec3 V(std::sqrt(1.0f - NdotV * NdotV), 0.0f, NdotV);
+            float scale = 0.0f;
+            float bias = 0.0f;
+            for (uint32_t i = 0; i < sampleCount; ++i) {
+                glm::vec3 H = GgxSampling::ImportanceSample(GgxSampling::Hammersley(i, sampleCount), roughness);
+                glm::vec3 L = 2.0f * glm::dot(V, H) * H - V;
+                float NdotL = std::max(L.z, 0.0f);
+                if (NdotL <= 0.0f) continue;
+                float NdotH = std::max(H.z, 0.0f);
+                float VdotH = std::max(glm::dot(V, H), 0.0f);
+                float visibility = GeometrySmith(NdotV, NdotL, roughness) * VdotH / (NdotH * NdotV);
+                float fresnel = std::pow(1.0f - VdotH, 5.0f);
+                scale += (1.0f - fresnel) * visibility;
+                bias += fresnel * visibility;
+            }
+            return glm::vec2(scale, bias) / static_cast<float>(sampleCount);
+        }
+    }
+
+    std::vector<uint16_t> BrdfLut::LoadOrGenerate(const std::filesystem::path& cachePath, uint32_t size, uint32_t sampleCount) {
+        std::vector<uint16_t> texels;
+        if (ReadCache(cachePath, size, sampleCount, texels)) {
+            VKENG_INFO("BrdfLut: Loaded {}x{} table from '{}'.", size, size, cachePath.string());
+            return texels;
+        }
+        VKENG_INFO("BrdfLut: Integrating {}x{} table ({} samples per texel)...", size, size, sampleCount);
+        texels = Generate(size, sampleCount);
+        if (WriteCache(cachePath, size, sampleCount, texels)) {
+            VKENG_INFO("BrdfLut: Cached table in '{}'.", cachePath.string());
+        }
+        return texels;
+    }
+
+    std::vector<uint16_t> BrdfLut::Generate(uint32_t size, uint32_t sampleCount) {
+        std::vector<uint16_t> texels(static_cast<size_t>(size) * size * 2);
+        // Rows are independent; one batch per few rows keeps every worker busy.
+        ServiceLocator::GetJobSystem().ParallelFor(size, 4, [&](uint32_t rowBegin, uint32_t rowEnd) {
+            for (uint32_t y = rowBegin; y < rowEnd; ++y) {
+                float roughness = (static_cast<float>(y) + 0.5f) / static_cast<float>(size);
+                for (uint32_t x = 0; x < size; ++x) {
+                    float NdotV = (static_cast<float>(x) + 0.5f) / static_cast<float>(size);
+                    glm::vec2 scaleBias = IntegrateBrdf(NdotV, roughness, sampleCount);
+                    size_t texel = (static_cast<size_t>(y) * size + x) * 2;
+                    texels[texel] = glm::packHalf1x16(scaleBias.x);
+                    texels[texel + 1] = glm::packHalf1x16(scaleBias.y);
+                }
+            }
+        });
+        return texels;
+    }
+
+    bool BrdfLut::ReadCache(const std::filesystem::path& cachePath, uint32_t size, uint32_t sampleCount, std::vector<uint16_t>& outTexels) {
+        std::ifstream file(cachePath, std::ios::binary);
+        if (!file.is_open()) return false;
+        CacheHeader header;
+        if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))) return false;
+        if (header.magic != CacheMagic || header.version != CacheVersion || header.size != size || header.sampleCount != sampleCount) {
+            VKENG_INFO("BrdfLut: Cache '{}' is stale; regenerating.", cachePath.string());
+            return false;
+        }
+        outTexels.resize(static_cast<size_t>(size) * size * 2);
+        if (!file.read(reinterpret_cast<char*>(outTexels.data()), outTexels.size() * sizeof(uint16_t))) {
+            VKENG_WARN("BrdfLut: Cache '{}' is truncated; regenerating.", cachePath.string());
+            return false;
+        }
+        return true;
+    }
+
+    bool BrdfLut::WriteCache(const std::filesystem::path& cachePath, uint32_t size, uint32_t sampleCount, const std::vector<uint16_t>& texels) {
+        CacheHeader header;
+        header.size = size;
+        header.sampleCount = sampleCount;
+        std::string error;
+        bool written = WriteFileAtomically(cachePath, [&](std::ostream& file) {
+            return file.write(reinterpret_cast<const char*>(&header), sizeof(header)) &&
+                   file.write(reinterpret_cast<const char*>(texels.data()), texels.size() * sizeof(uint16_t));
+        }, &error);
+        if (!written) VKENG_WARN("BrdfLut: Could not write cache '{}': {}", cachePath.string(), error);
+        return written;
+    }
+
+} // namespace VulkEng
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+namespace VulkEng {
+
+    // Split-sum environment BRDF table (Karis, "Real Shading in Unreal Engine 4"): for N.V (u) and
+    // roughness (v), the scale (R) and bias (G) the specular image-based term applies to F0. It only
+    // depends on the BRDF, so it is integrated once and cached on disk.
+    //
+    // Texels are RG16F (VK_FORMAT_R16G16_SFLOAT), row-major, two halfs per texel.
+    class BrdfLut {
+    public:
+        static constexpr uint32_t DefaultSize = 128;
+        static constexpr uint32_t DefaultSampleCount = 512; // GGX importance samples per texel
+
+        BrdfLut() = delete;
+
+        // Reads the table from `cachePath` if it holds one with these parameters; otherwise
+        // integrates it (in parallel on the JobSystem) and writes it there. Cache write failures
+        // are logged and otherwise ignored.
+        static std::vector<uint16_t> LoadOrGenerate(const std::filesystem::path& cachePath,
+                                                    uint32_t size = DefaultSize, uint32_t sampleCount = DefaultSampleCount);
+
+        static std::vector<uint16_t> Generate(uint32_t size, uint32_t sampleCount);
+
+    private:
+        static bool ReadCache(const std::filesystem::path& cachePath, uint32_t size, uint32_t sampleCount, std::vector<uint16_t>& outTexels);
+        static bool WriteCache(const std::filesystem::path& cachePath, uint32_t size, uint32_t sampleCount, const std::vector<uint16_t>& texels);
+    };
+
+} // namespace VulkEng
@@ -2,12 +2,51 @@
 #include "graphics/VulkanContext.h" // Needs full definition for device, physicalDevice
 #include "graphics/VulkanUtils.h"   // For VK_CHECK and findMemoryType
 #include "core/Log.h"
+#include "core/PerfCounters.h"
 
 #include <stdexcept> // For std::runtime_error
 #include <cstring>   // For memcpy
+#include <algorithm> // For std::min, std::max
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define VKENG_STREAMING_STORES 1
+#endif
 
 namespace VulkEng {
 
+    namespace {
+        // Writes at least this large bypass the CPU caches.
+        constexpr VkDeviceSize StreamingCopyThreshold = 64 * 1024;
+
+        // memcpy with non-temporal stores: the destination is write-combined mapped memory the CPU
+        // won't read, so filling the caches with it would only evict useful data.
+        void StreamingCopy(void* dst, const void* src, size_t size) {
+#ifdef VKENG_STREAMING_STORES
+            char* out = static_cast<char*>(dst);
+            const char* in = static_cast<const char*>(src);
+            size_t head = (16 - (reinterpret_cast<uintptr_t>(out) & 15)) & 15; // Up to 16-byte alignment
+            head = std::min(head, size);
+            memcpy(out, in, head);
+            out += head; in += head; size -= head;
+            for (; size >= 64; size -= 64, out += 64, in += 64) { // Full write-combining lines
+                __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+                __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 16));
+                __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 32));
+                __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 48));
+                _mm_stream_si128(reinterpret_cast<__m128i*>(out), a);
+                _mm_stream_si128(reinterpret_cast<__m128i*>(out + 16), b);
+                _mm_stream_si128(reinterpret_cast<__m128i*>(out + 32), c);
+                _mm_stream_si128(reinterpret_cast<__m128i*>(out + 48), d);
+            }
+            memcpy(out, in, size);
+            _mm_sfence(); // Order the streaming stores before the submit that hands the data to the GPU
+#else
+            memcpy(dst, src, size);
+#endif
+        }
+    } // namespace
+
     // --- Static Helper for Alignment Calculation ---
     VkDeviceSize VulkanBuffer::CalculateAlignment(VkDeviceSize instanceSize, VkDeviceSize minOffsetAlignment) {
         if (minOffsetAlignment > 0) {
@@ -24,11 +63,13 @@ namespace VulkEng {
         uint32_t instanceCount,
         VkBufferUsageFlags usageFlags,
         VkMemoryPropertyFlags memoryPropertyFlags,
-        VkDeviceSize minOffsetAlignment /*= 1*/)
+        VkDeviceSize minOffsetAlignment /*= 1*/,
+        BufferMapping mapping /*= BufferMapping::OnDemand*/)
         : m_Context(context),
           m_Buffer(VK_NULL_HANDLE),
           m_Memory(VK_NULL_HANDLE),
           m_MappedMemory(nullptr),
+          m_Mapping(mapping),
           m_InstanceCount(instanceCount),
           m_InstanceSize(instanceSize),
           m_UsageFlags(usageFlags),
@@ -84,15 +125,27 @@ namespace VulkEng {
         // }
 
         VK_CHECK(vkAllocateMemory(m_Context.device, &allocInfo, nullptr, &m_Memory));
+        PerfCounters::Add(PerfCounter_DeviceAllocations);
+        m_AllocationSize = memRequirements.size;
 
         // --- Bind Memory to Buffer ---
         VK_CHECK(vkBindBufferMemory(m_Context.device, m_Buffer, m_Memory, 0)); // 0 is the offset within the memory allocation
+
+        if (m_Mapping == BufferMapping::Persistent) {
+            if (!(memoryPropertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)) {
+                VKENG_WARN("VulkanBuffer: Persistent mapping requested for non-host-visible memory; ignored.");
+                m_Mapping = BufferMapping::OnDemand;
+            } else {
+                VK_CHECK(vkMapMemory(m_Context.device, m_Memory, 0, VK_WHOLE_SIZE, 0, &m_MappedMemory));
+            }
+        }
     }
 
     // --- Destructor ---
     VulkanBuffer::~VulkanBuffer() {
-        // Unmap memory if it was mapped
+        // Unmap memory if it was mapped (persistently or not)
         if (m_MappedMemory) {
+            m_Mapping = BufferMapping::OnDemand;
             Unmap(); // Calls vkUnmapMemory
         }
 
@@ -113,7 +166,12 @@ namespace VulkEng {
           m_Buffer(other.m_Buffer),
           m_Memory(other.m_Memory),
           m_MappedMemory(other.m_MappedMemory),
+          m_MappedOffset(other.m_MappedOffset),
+          m_Mapping(other.m_Mapping),
+          m_DirtyBegin(other.m_DirtyBegin),
+          m_DirtyEnd(other.m_DirtyEnd),
           m_BufferSize(other.m_BufferSize),
+          m_AllocationSize(other.m_AllocationSize),
           m_InstanceCount(other.m_InstanceCount),
           m_InstanceSize(other.m_InstanceSize),
           m_AlignmentSize(other.m_AlignmentSize),
@@ -133,7 +191,10 @@ namespace VulkEng {
     VulkanBuffer& VulkanBuffer::operator=(VulkanBuffer&& other) noexcept {
         if (this != &other) { // Prevent self-assignment
             // Release existing resources
-            if (m_MappedMemory) Unmap();
+            if (m_MappedMemory) {
+                m_Mapping = BufferMapping::OnDemand;
+                Unmap();
+            }
             if (m_Buffer != VK_NULL_HANDLE && m_Context.device != VK_NULL_HANDLE) vkDestroyBuffer(m_Context.device, m_Buffer, nullptr);
             if (m_Memory != VK_NULL_HANDLE && m_Context.device != VK_NULL_HANDLE) vkFreeMemory(m_Context.device, m_Memory, nullptr);
 
@@ -145,7 +206,12 @@ namespace VulkEng {
             m_Buffer = other.m_Buffer;
             m_Memory = other.m_Memory;
             m_MappedMemory = other.m_MappedMemory;
+            m_MappedOffset = other.m_MappedOffset;
+            m_Mapping = other.m_Mapping;
+            m_DirtyBegin = other.m_DirtyBegin;
+            m_DirtyEnd = other.m_DirtyEnd;
             m_BufferSize = other.m_BufferSize;
+            m_AllocationSize = other.m_AllocationSize;
             m_InstanceCount = other.m_InstanceCount;
             m_InstanceSize = other.m_InstanceSize;
             m_AlignmentSize = other.m_AlignmentSize;
@@ -175,19 +241,23 @@ namespace VulkEng {
             return VK_ERROR_MEMORY_MAP_FAILED;
         }
         if (m_MappedMemory != nullptr) {
-            VKENG_WARN("VulkanBuffer::Map: Buffer memory is already mapped.");
+            if (m_Mapping != BufferMapping::Persistent) VKENG_WARN("VulkanBuffer::Map: Buffer memory is already mapped.");
             return VK_SUCCESS; // Already mapped, consider this success or an error
         }
 
+        m_MappedOffset = offset;
         return vkMapMemory(m_Context.device, m_Memory, offset, size, 0, &m_MappedMemory);
     }
 
     void VulkanBuffer::Unmap() {
+        if (m_Mapping == BufferMapping::Persistent) return; // Stays mapped until destruction
         if (m_MappedMemory) {
+            FlushWrites();
              if (m_Context.device != VK_NULL_HANDLE && m_Memory != VK_NULL_HANDLE) { // Check validity
                 vkUnmapMemory(m_Context.device, m_Memory);
             }
             m_MappedMemory = nullptr;
+            m_MappedOffset = 0;
         }
     }
 
@@ -206,9 +276,15 @@ namespace VulkEng {
             return;
         }
 
+        if (size == VK_WHOLE_SIZE) size = m_BufferSize - offset;
+        if (offset + size > m_BufferSize) {
+            VKENG_ERROR("VulkanBuffer::WriteToBuffer: Write of {} bytes at {} exceeds buffer size {}.", size, offset, m_BufferSize);
+            return;
+        }
+
         bool needsTempMap = (m_MappedMemory == nullptr);
         if (needsTempMap) {
-            VkResult mapResult = Map(size == VK_WHOLE_SIZE ? m_BufferSize : size, offset);
+            VkResult mapResult = Map(); // Whole buffer, so `offset` stays relative to its start
             if (mapResult != VK_SUCCESS) {
                 VKENG_ERROR("VulkanBuffer::WriteToBuffer: Failed to map memory for writing. Error: {}", mapResult);
                 return;
@@ -216,26 +292,30 @@ namespace VulkEng {
         }
 
         // Ensure mapped memory is valid after potential map call
-        if (!m_MappedMemory) {
-             VKENG_ERROR("VulkanBuffer::WriteToBuffer: Memory not mapped after Map() call.");
+        if (!m_MappedMemory || offset < m_MappedOffset) {
+             VKENG_ERROR("VulkanBuffer::WriteToBuffer: Write at {} is outside the mapped range.", offset);
              return;
         }
 
-
-        char* mappedDataOffset = static_cast<char*>(m_MappedMemory) + offset;
-        if (size == VK_WHOLE_SIZE) {
-            if (offset > 0) { // If offset given with WHOLE_SIZE, adjust actual size
-                memcpy(mappedDataOffset, data, m_BufferSize - offset);
-            } else {
-                memcpy(m_MappedMemory, data, m_BufferSize);
-            }
+        char* mappedDataOffset = static_cast<char*>(m_MappedMemory) + (offset - m_MappedOffset);
+        if (size >= StreamingCopyThreshold) {
+            StreamingCopy(mappedDataOffset, data, static_cast<size_t>(size));
         } else {
-            memcpy(mappedDataOffset, data, size);
+            memcpy(mappedDataOffset, data, static_cast<size_t>(size));
         }
+        PerfCounters::Add(PerfCounter_BufferUploads);
+        PerfCounters::Add(PerfCounter_BufferUploadBytes, static_cast<int64_t>(size));
 
-        // If memory is not HOST_COHERENT, it needs to be flushed for device to see writes.
+        // If memory is not HOST_COHERENT, the device only sees flushed writes: collect the range and
+        // flush it once (FlushWrites, or Unmap below) instead of per write.
         if (!(m_MemoryPropertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)) {
-            Flush(size, offset); // Flush the written region
+            if (m_DirtyEnd == m_DirtyBegin) {
+                m_DirtyBegin = offset;
+                m_DirtyEnd = offset + size;
+            } else {
+                m_DirtyBegin = std::min(m_DirtyBegin, offset);
+                m_DirtyEnd = std::max(m_DirtyEnd, offset + size);
+            }
         }
 
         if (needsTempMap) {
@@ -243,6 +323,24 @@ namespace VulkEng {
         }
     }
 
+    VkResult VulkanBuffer::FlushWrites() {
+        if (m_DirtyEnd == m_DirtyBegin) return VK_SUCCESS;
+        VkResult result = Flush(m_DirtyEnd - m_DirtyBegin, m_DirtyBegin);
+        m_DirtyBegin = m_DirtyEnd = 0;
+        return result;
+    }
+
+    VkMappedMemoryRange VulkanBuffer::GetAlignedRange(VkDeviceSize size, VkDeviceSize offset) const {
+        VkDeviceSize atom = std::max<VkDeviceSize>(m_Context.physicalDeviceProperties.limits.nonCoherentAtomSize, 1);
+        VkDeviceSize end = (size == VK_WHOLE_SIZE) ? m_AllocationSize : offset + size;
+        VkMappedMemoryRange range{VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE};
+        range.memory = m_Memory;
+        range.offset = offset / atom * atom;
+        end = (end + atom - 1) / atom * atom;
+        range.size = end >= m_AllocationSize ? VK_WHOLE_SIZE : end - range.offset; // Past the end only as WHOLE_SIZE
+        return range;
+    }
+
     VkResult VulkanBuffer::Flush(VkDeviceSize size, VkDeviceSize offset) const {
         if (m_Memory == VK_NULL_HANDLE) return VK_ERROR_INITIALIZATION_FAILED;
         // Only flush if host-visible and not host-coherent
@@ -251,11 +349,7 @@ namespace VulkEng {
             return VK_SUCCESS; // No flush needed or possible
         }
 
-        VkMappedMemoryRange mappedRange{};
-        mappedRange.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
-        mappedRange.memory = m_Memory;
-        mappedRange.offset = offset;
-        mappedRange.size = (size == VK_WHOLE_SIZE) ? m_BufferSize - offset : size;
+        VkMappedMemoryRange mappedRange = GetAlignedRange(size, offset);
         return vkFlushMappedMemoryRanges(m_Context.device, 1, &mappedRange);
     }
 
@@ -267,11 +361,7 @@ namespace VulkEng {
             return VK_SUCCESS; // No invalidate needed or possible
         }
 
-        VkMappedMemoryRange mappedRange{};
-        mappedRange.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
-        mappedRange.memory = m_Memory;
-        mappedRange.offset = offset;
-        mappedRange.size = (size == VK_WHOLE_SIZE) ? m_BufferSize - offset : size;
+        VkMappedMemoryRange mappedRange = GetAlignedRange(size, offset);
         return vkInvalidateMappedMemoryRanges(m_Context.device, 1, &mappedRange);
     }
 
@@ -14,6 +14,13 @@ namespace VulkEng {
 
 namespace VulkEng {
 
+    // How a host-visible buffer's memory is mapped.
+    enum class BufferMapping {
+        OnDemand,  // Mapped by Map() (or temporarily by WriteToBuffer) and unmapped by Unmap()
+        Persistent // Mapped once at creation and kept mapped until destruction; Map()/Unmap() are no-ops.
+                   // On non-HOST_COHERENT memory the owner calls FlushWrites() before the device reads.
+    };
+
     // Wrapper class for Vulkan VkBuffer and its associated VkDeviceMemory.
     // This example uses manual memory management. For production, consider VMA (Vulkan Memory Allocator).
     class VulkanBuffer {
@@ -25,13 +32,15 @@ namespace VulkEng {
         // - usageFlags: VkBufferUsageFlags specifying how the buffer will be used (e.g., vertex, index, uniform, staging).
         // - memoryPropertyFlags: VkMemoryPropertyFlags specifying desired memory properties (e.g., host-visible, device-local).
         // - minOffsetAlignment: Minimum alignment requirement for dynamic uniform buffers (usually 1 if not dynamic UBO).
+        // - mapping: Persistent maps host-visible memory for the buffer's whole lifetime.
         VulkanBuffer(
             VulkanContext& context,
             VkDeviceSize instanceSize,
             uint32_t instanceCount,
             VkBufferUsageFlags usageFlags,
             VkMemoryPropertyFlags memoryPropertyFlags,
-            VkDeviceSize minOffsetAlignment = 1 // Default to 1 (no special alignment beyond instanceSize)
+            VkDeviceSize minOffsetAlignment = 1, // Default to 1 (no special alignment beyond instanceSize)
+            BufferMapping mapping = BufferMapping::OnDemand
         );
 
         // Destructor: Frees the VkDeviceMemory and destroys the VkBuffer.
@@ -51,18 +60,23 @@ namespace VulkEng {
         // Only valid for buffers created with VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT.
         // `size` and `offset` define the region to map. VK_WHOLE_SIZE maps the entire buffer.
         VkResult Map(VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0);
-        // Unmaps previously mapped memory. Must be called if Map was successful.
+        // Unmaps previously mapped memory (flushing pending writes first). Must be called if Map was successful.
         void Unmap();
 
         // --- Data Transfer ---
-        // Writes data directly to the mapped memory region.
-        // Assumes the buffer is already mapped or handles mapping internally if persistently mapped.
-        // If not persistently mapped and not HOST_COHERENT, requires Flush after writing.
+        // Writes data to the buffer's memory; `offset` is from the start of the buffer. An unmapped buffer
+        // is mapped for the duration of the call. Large writes use non-temporal (streaming) stores, since
+        // mapped memory is typically write-combined and the data is not read back by the CPU.
+        // On non-HOST_COHERENT memory, writes to a mapped buffer only grow a pending flush range: call
+        // FlushWrites() once before the device reads them, rather than flushing per write.
         void WriteToBuffer(const void* data, VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0);
 
+        // Flushes the range written since the last flush (no-op for HOST_COHERENT memory).
+        VkResult FlushWrites();
+
         // Flushes a mapped memory range to make host writes visible to the device.
         // Only necessary for HOST_VISIBLE memory that is NOT HOST_COHERENT.
-        // `size` and `offset` define the region to flush.
+        // `size` and `offset` define the region to flush; it is widened to nonCoherentAtomSize.
         VkResult Flush(VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0) const;
 
         // Invalidates a mapped memory range to make device writes visible to the host.
@@ -80,6 +94,7 @@ namespace VulkEng {
         VkBuffer GetBuffer() const { return m_Buffer; }
         VkDeviceMemory GetMemory() const { return m_Memory; } // Exposing memory handle directly
         void* GetMappedMemory() const { return m_MappedMemory; } // Returns nullptr if not mapped
+        bool IsPersistentlyMapped() const { return m_Mapping == BufferMapping::Persistent; }
 
         uint32_t GetInstanceCount() const { return m_InstanceCount; }
         VkDeviceSize GetInstanceSize() const { return m_InstanceSize; }     // Size of one element (unaligned)
@@ -92,6 +107,8 @@ namespace VulkEng {
     private:
         // Helper to calculate aligned size for dynamic UBOs or other aligned data.
         static VkDeviceSize CalculateAlignment(VkDeviceSize instanceSize, VkDeviceSize minOffsetAlignment);
+        // `size`/`offset` widened to whole nonCoherentAtomSize blocks, as vkFlush/InvalidateMappedMemoryRanges require.
+        VkMappedMemoryRange GetAlignedRange(VkDeviceSize size, VkDeviceSize offset) const;
 
         VulkanContext& m_Context; // Store reference to Vulkan context for device access
 
@@ -99,7 +116,12 @@ namespace VulkEng {
         VkDeviceMemory m_Memory = VK_NULL_HANDLE; // Handle to the allocated device memory
 
         void* m_MappedMemory = nullptr; // Pointer to mapped host memory (if HOST_VISIBLE and mapped)
+        VkDeviceSize m_MappedOffset = 0; // Buffer offset m_MappedMemory points at
+        BufferMapping m_Mapping = BufferMapping::OnDemand;
+        VkDeviceSize m_DirtyBegin = 0;  // Written but not yet flushed (non-coherent memory only)
+        VkDeviceSize m_DirtyEnd = 0;
         VkDeviceSize m_BufferSize = 0;  // Total size of the allocated buffer
+        VkDeviceSize m_AllocationSize = 0; // Size of m_Memory (may exceed m_BufferSize)
         uint32_t m_InstanceCount = 0;
         VkDeviceSize m_InstanceSize = 0;  // Requested size of a single instance/element
         VkDeviceSize m_AlignmentSize = 0; // Actual size of an instance after alignment
@@ -1,7 +1,10 @@
 #include "CommandManager.h"
 #include "VulkanContext.h" // Needs full definition for device, FindQueueFamilies
+#include "ImmediateContext.h"
 #include "VulkanUtils.h"   // For VK_CHECK
+#include "core/JobSystem.h"
 #include "core/Log.h"
+#include "core/ServiceLocator.h"
 
 #include <stdexcept> // For std::runtime_error, std::out_of_range
 
@@ -28,23 +31,32 @@ namespace VulkEng {
             throw std::invalid_argument("CommandManager frame count must be greater than zero.");
         }
 
-
-        VKENG_INFO("Creating Command Manager ({} command buffers for {} frames in flight)...", m_FrameCount, m_FrameCount);
+        m_ThreadCount = ServiceLocator::GetJobSystem().GetWorkerCount() + 1; // Workers + the main thread
+        VKENG_INFO("Creating Command Manager ({} frames in flight, {} thread pools each)...", m_FrameCount, m_ThreadCount);
         CreateCommandPool();
         if (m_CommandPool == VK_NULL_HANDLE) { // Should have been caught by VK_CHECK in CreateCommandPool
             throw std::runtime_error("Command pool creation failed in CommandManager constructor.");
         }
-        CreateCommandBuffers(); // Creates m_FrameCount primary command buffers
+        CreateFramePools();
+        m_ImmediateContext = std::make_unique<ImmediateContext>(m_Context, QueueType::Graphics);
+        if (m_Context.HasDedicatedQueue(QueueType::Transfer)) {
+            m_TransferContext = std::make_unique<ImmediateContext>(m_Context, QueueType::Transfer);
+        }
         VKENG_INFO("Command Manager Created.");
     }
 
     CommandManager::~CommandManager() {
-        // Command buffers are implicitly freed when the command pool is destroyed.
-        if (m_CommandPool != VK_NULL_HANDLE && m_Context.device != VK_NULL_HANDLE) {
-            // VKENG_TRACE("Destroying Command Pool and its Command Buffers...");
-            vkDestroyCommandPool(m_Context.device, m_CommandPool, nullptr);
-            m_CommandPool = VK_NULL_HANDLE;
+        m_ImmediateContext.reset(); // Waits for its outstanding batches, submitting the transfer batches they wait on
+        m_TransferContext.reset();
+        // Command buffers are implicitly freed when their command pool is destroyed.
+        if (m_Context.device != VK_NULL_HANDLE) {
+            for (ThreadCommandPool& framePool : m_FramePools) {
+                if (framePool.pool != VK_NULL_HANDLE) vkDestroyCommandPool(m_Context.device, framePool.pool, nullptr);
+            }
+            if (m_CommandPool != VK_NULL_HANDLE) vkDestroyCommandPool(m_Context.device, m_CommandPool, nullptr);
         }
+        m_FramePools.clear();
+        m_CommandPool = VK_NULL_HANDLE;
         VKENG_INFO("Command Manager Destroyed.");
     }
 
@@ -53,57 +65,79 @@ namespace VulkEng {
         if (!queueFamilyIndices.graphicsFamily.has_value()) {
             throw std::runtime_error("Failed to find graphics queue family for command pool creation.");
         }
+        m_QueueFamilyIndex = queueFamilyIndices.graphicsFamily.value();
 
         VkCommandPoolCreateInfo poolInfo{};
         poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-        poolInfo.queueFamilyIndex = queueFamilyIndices.graphicsFamily.value();
-        // VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT allows individual command buffers to be reset.
-        // VK_COMMAND_POOL_CREATE_TRANSIENT_BIT is for pools whose buffers are short-lived.
-        poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+        poolInfo.queueFamilyIndex = m_QueueFamilyIndex;
+        // Single-time command buffers are allocated, submitted once and freed.
+        poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
 
         VK_CHECK(vkCreateCommandPool(m_Context.device, &poolInfo, nullptr, &m_CommandPool));
         VKENG_INFO("Vulkan Command Pool Created.");
     }
 
-    void CommandManager::CreateCommandBuffers() {
-        if (m_CommandPool == VK_NULL_HANDLE) {
-            VKENG_ERROR("CommandManager::CreateCommandBuffers: Command pool is null!");
-            throw std::runtime_error("Cannot create command buffers without a command pool.");
-        }
+    void CommandManager::CreateFramePools() {
+        // No RESET_COMMAND_BUFFER_BIT: buffers are only ever reset together, with their pool.
+        VkCommandPoolCreateInfo poolInfo{VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO};
+        poolInfo.queueFamilyIndex = m_QueueFamilyIndex;
+        poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
 
-        m_CommandBuffers.resize(m_FrameCount); // Allocate space for the command buffer handles
+        m_FramePools.resize(static_cast<size_t>(m_FrameCount) * m_ThreadCount);
+        for (ThreadCommandPool& framePool : m_FramePools) {
+            VK_CHECK(vkCreateCommandPool(m_Context.device, &poolInfo, nullptr, &framePool.pool));
+        }
+        m_CommandBuffers.assign(m_FrameCount, VK_NULL_HANDLE);
+    }
 
-        VkCommandBufferAllocateInfo allocInfo{};
-        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-        allocInfo.commandPool = m_CommandPool;
-        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY; // Primary buffers can be submitted to a queue
-        allocInfo.commandBufferCount = static_cast<uint32_t>(m_CommandBuffers.size());
+    VkCommandBuffer CommandManager::AllocateCommandBuffer(uint32_t frameIndex, VkCommandBufferLevel level) {
+        uint32_t threadIndex = JobSystem::GetCurrentThreadIndex();
+        if (frameIndex >= m_FrameCount || threadIndex >= m_ThreadCount || m_FramePools.empty()) {
+            VKENG_ERROR("CommandManager::AllocateCommandBuffer: No pool for frame {} on thread {}.", frameIndex, threadIndex);
+            throw std::out_of_range("Invalid frame or thread index for command buffer allocation.");
+        }
 
-        VK_CHECK(vkAllocateCommandBuffers(m_Context.device, &allocInfo, m_CommandBuffers.data()));
-        VKENG_INFO("Allocated {} Primary Command Buffers.", m_CommandBuffers.size());
+        ThreadCommandPool& framePool = m_FramePools[static_cast<size_t>(frameIndex) * m_ThreadCount + threadIndex];
+        bool primary = level == VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        std::vector<VkCommandBuffer>& buffers = primary ? framePool.primaryBuffers : framePool.secondaryBuffers;
+        size_t& used = primary ? framePool.primaryUsed : framePool.secondaryUsed;
+        if (used == buffers.size()) { // Free list exhausted: grow it; kept across resets
+            VkCommandBufferAllocateInfo allocInfo{VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO};
+            allocInfo.commandPool = framePool.pool;
+            allocInfo.level = level;
+            allocInfo.commandBufferCount = 1;
+            VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+            VK_CHECK(vkAllocateCommandBuffers(m_Context.device, &allocInfo, &commandBuffer));
+            buffers.push_back(commandBuffer);
+        }
+        return buffers[used++];
     }
 
-    VkCommandBuffer CommandManager::BeginFrameRecording(uint32_t frameIndex) {
+    VkCommandBuffer CommandManager::BeginFrame(uint32_t frameIndex) {
         if (m_CommandPool == VK_NULL_HANDLE) { // Check if properly initialized
-            VKENG_ERROR("CommandManager::BeginFrameRecording: CommandManager not properly initialized (null pool).");
+            VKENG_ERROR("CommandManager::BeginFrame: CommandManager not properly initialized (null pool).");
             return VK_NULL_HANDLE;
         }
         if (frameIndex >= m_CommandBuffers.size()) {
-            VKENG_ERROR("CommandManager::BeginFrameRecording: Invalid frame index ({}) requested. Max is {}.", frameIndex, m_CommandBuffers.size() -1 );
+            VKENG_ERROR("CommandManager::BeginFrame: Invalid frame index ({}) requested. Max is {}.", frameIndex, m_CommandBuffers.size() -1 );
             throw std::out_of_range("Invalid frame index for command buffer begin.");
         }
 
-        VkCommandBuffer commandBuffer = m_CommandBuffers[frameIndex];
+        // One reset per pool returns every buffer recorded into it last time to the initial state.
+        for (uint32_t thread = 0; thread < m_ThreadCount; ++thread) {
+            ThreadCommandPool& framePool = m_FramePools[static_cast<size_t>(frameIndex) * m_ThreadCount + thread];
+            if (framePool.primaryUsed == 0 && framePool.secondaryUsed == 0) continue; // Nothing recorded
+            VK_CHECK(vkResetCommandPool(m_Context.device, framePool.pool, 0));
+            framePool.primaryUsed = 0;
+            framePool.secondaryUsed = 0;
+        }
 
-        // Reset the command buffer before starting to record new commands.
-        // This allows the command buffer to be reused.
-        VK_CHECK(vkResetCommandBuffer(commandBuffer, 0 /* Optional VkCommandBufferResetFlags */));
+        VkCommandBuffer commandBuffer = AllocateCommandBuffer(frameIndex);
+        m_CommandBuffers[frameIndex] = commandBuffer;
 
         VkCommandBufferBeginInfo beginInfo{};
         beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-        // VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT: Buffer will be submitted once and then reset.
-        // VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT: Buffer can be resubmitted while pending execution (requires careful synchronization).
-        // For per-frame buffers, ONE_TIME_SUBMIT is common as they are re-recorded each frame.
+        // Re-recorded every frame, so the driver can optimize for a single submission.
         beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
         beginInfo.pInheritanceInfo = nullptr; // Only for secondary command buffers
 
@@ -1,21 +1,27 @@
 #pragma once
 
 #include <vulkan/vulkan.h>
+#include <memory>
 #include <vector>
 #include <stdexcept> // For std::runtime_error (optional, can use assertions)
 #include <cstdint>   // For uint32_t
 
 namespace VulkEng {
 
-    // Forward declaration
+    // Forward declarations
     class VulkanContext;
+    class ImmediateContext;
 
-    // Manages command pools and command buffers, typically one set per frame in flight.
+    // Frame-scoped command allocation. Each frame in flight has one transient command pool per
+    // thread (the main thread and each JobSystem worker); BeginFrame resets all of that frame's pools
+    // at once with vkResetCommandPool instead of resetting buffers one by one. Buffers are kept in a
+    // per-pool free list and handed out again after the reset, so after warm-up a frame allocates
+    // any number of primary and secondary command buffers without creating Vulkan objects.
     class CommandManager {
     public:
         // Constructor:
         // - context: Reference to the initialized VulkanContext.
-        // - frameCount: Number of command buffers to create (usually MAX_FRAMES_IN_FLIGHT).
+        // - frameCount: Number of frames in flight (usually MAX_FRAMES_IN_FLIGHT).
         // - skipInit: Flag for dummy/null object construction.
         CommandManager(VulkanContext& context, uint32_t frameCount, bool skipInit = false);
         // Virtual destructor for potential inheritance (e.g., DummyCommandManagerSL).
@@ -26,21 +32,30 @@ namespace VulkEng {
         CommandManager& operator=(const CommandManager&) = delete;
 
         // --- Command Buffer Management ---
-        // Resets and begins recording on the command buffer for the given frame index.
-        // `frameIndex` should be between 0 and `frameCount - 1`.
+        // Resets the frame's pools and begins its main primary command buffer. The GPU must be done
+        // with the frame slot's previous submission. `frameIndex` is between 0 and `frameCount - 1`.
         // Returns the command buffer ready for recording.
-        virtual VkCommandBuffer BeginFrameRecording(uint32_t frameIndex); // Renamed for clarity
+        virtual VkCommandBuffer BeginFrame(uint32_t frameIndex);
 
-        // Ends recording on the command buffer for the given frame index.
+        // Ends recording on the frame's main command buffer.
         // This must be called before submitting the command buffer.
         virtual void EndFrameRecording(uint32_t frameIndex);
 
+        // A command buffer from the calling thread's pool for the frame (not begun), valid until the
+        // frame slot's next BeginFrame. Call from the main thread or a JobSystem worker only.
+        VkCommandBuffer AllocateCommandBuffer(uint32_t frameIndex, VkCommandBufferLevel level = VK_COMMAND_BUFFER_LEVEL_PRIMARY);
+
         // --- Accessors ---
-        // Gets the underlying command pool. Useful for allocating temporary/single-use command buffers.
+        // Gets the pool for temporary/single-use command buffers (allocated and freed by the caller,
+        // e.g., Utils::BeginSingleTimeCommands). Not reset per frame.
         virtual VkCommandPool GetCommandPool() const { return m_CommandPool; }
+        // Batched, non-blocking one-off commands on the graphics queue (uploads, transitions).
+        ImmediateContext& GetImmediateContext() { return *m_ImmediateContext; }
+        // The same on the dedicated transfer queue, or nullptr if the device has none. Resources it
+        // writes must be released to, and acquired by, the graphics queue (see Recording::WaitFor).
+        ImmediateContext* GetTransferContext() { return m_TransferContext.get(); }
 
-        // Gets the vector of primary command buffers (one per frame in flight).
-        // Useful for direct submission or access by other systems.
+        // Gets the main primary command buffer of each frame in flight (from its last BeginFrame).
         const std::vector<VkCommandBuffer>& GetCommandBuffers() const { return m_CommandBuffers; }
         // Gets a specific command buffer by frame index.
         VkCommandBuffer GetCommandBuffer(uint32_t frameIndex) const;
@@ -51,17 +66,32 @@ namespace VulkEng {
     protected:
         friend class DummyCommandManagerSL; // For NullServices, if it needs to access these
 
+        // A frame's pool for one thread, with the buffers allocated from it so far.
+        struct ThreadCommandPool {
+            VkCommandPool pool = VK_NULL_HANDLE;
+            std::vector<VkCommandBuffer> primaryBuffers;
+            std::vector<VkCommandBuffer> secondaryBuffers;
+            size_t primaryUsed = 0;   // Handed out since the last reset
+            size_t secondaryUsed = 0;
+        };
+
         // --- Internal Initialization ---
         void CreateCommandPool();
-        void CreateCommandBuffers(); // Creates primary command buffers
+        void CreateFramePools(); // m_FrameCount x m_ThreadCount transient pools
 
         VulkanContext& m_Context; // Reference to the Vulkan context
-        VkCommandPool m_CommandPool = VK_NULL_HANDLE; // Command pool for allocating buffers
+        VkCommandPool m_CommandPool = VK_NULL_HANDLE; // Pool for single-time command buffers
+        uint32_t m_QueueFamilyIndex = 0;
+        std::unique_ptr<ImmediateContext> m_ImmediateContext;
+        std::unique_ptr<ImmediateContext> m_TransferContext; // Graphics batches may depend on its batches
+
+        // [frame * m_ThreadCount + thread], thread as JobSystem::GetCurrentThreadIndex()
+        std::vector<ThreadCommandPool> m_FramePools;
+        uint32_t m_ThreadCount = 1;
 
-        // Primary command buffers, one for each frame that can be "in flight".
-        // Size is determined by `frameCount` (typically MAX_FRAMES_IN_FLIGHT).
+        // Main primary command buffer of each frame in flight.
         std::vector<VkCommandBuffer> m_CommandBuffers;
-        uint32_t m_FrameCount; // Number of command buffers created (matches constructor arg)
+        uint32_t m_FrameCount; // Number of frames in flight (matches constructor arg)
     };
 
 } // namespace VulkEng
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <array>
+#include <cmath> // For std::abs
+
+namespace VulkEng {
+
+    // View frustum as six planes (xyz = inward normal, w = distance), extracted from a
+    // projection * view matrix with Vulkan's [0, 1] clip-space depth. Works unchanged for
+    // reversed-Z, where planes 4 and 5 swap roles; an infinite far plane comes out as a
+    // degenerate (0, 0, 0, w > 0) plane that every box passes.
+    struct Frustum {
+        std::array<glm::vec4, 6> planes{};
+
+        static Frustum FromMatrix(const glm::mat4& viewProjection) {
+            // GLM is column-major; row i of the matrix is (m[0][i], m[1][i], m[2][i], m[3][i]).
+            auto row = [&viewProjection](int i) {
+                return glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+            };
+            const glm::vec4 r0 = row(0), r1 = row(1), r2 = row(2), r3 = row(3);
+
+            Frustum frustum;
+            frustum.planes[0] = r3 + r0; // Left
+            frustum.planes[1] = r3 - r0; // Right
+            frustum.planes[2] = r3 + r1; // Bottom
+            frustum.planes[3] = r3 - r1; // Top
+            frustum.planes[4] = r2;      // Near (z >= 0); far with reversed-Z
+            frustum.planes[5] = r3 - r2; // Far (z <= w); near with reversed-Z
+            for (glm::vec4& plane : frustum.planes) {
+                float length = glm::length(glm::vec3(plane));
+                if (length > 0.0f) plane /= length;
+            }
+            return frustum;
+        }
+
+        // Conservative: may report boxes just outside a corner as visible, never the reverse.
+        bool IntersectsAABB(const glm::vec3& boundsMin, const glm::vec3& boundsMax) const {
+            const glm::vec3 center = (boundsMin + boundsMax) * 0.5f;
+            const glm::vec3 extent = (boundsMax - boundsMin) * 0.5f;
+            for (const glm::vec4& plane : planes) {
+                float radius = extent.x * std::abs(plane.x) + extent.y * std::abs(plane.y) + extent.z * std::abs(plane.z);
+                if (glm::dot(glm::vec3(plane), center) + plane.w < -radius) return false;
+            }
+            return true;
+        }
+    };
+
+    // World-space bounds of a local-space box under an affine transform.
+    inline void TransformAABB(const glm::mat4& transform, const glm::vec3& localMin, const glm::vec3& localMax,
+                              glm::vec3& outMin, glm::vec3& outMax) {
+        const glm::vec3 center = glm::vec3(transform * glm::vec4((localMin + localMax) * 0.5f, 1.0f));
+        const glm::vec3 localExtent = (localMax - localMin) * 0.5f;
+        glm::vec3 extent(0.0f);
+        for (int axis = 0; axis < 3; ++axis) {
+            extent += glm::abs(glm::vec3(transform[axis])) * localExtent[axis];
+        }
+        outMin = center - extent;
+        outMax = center + extent;
+    }
+
+} // namespace VulkEng
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cmath>
+#include <cstdint>
+
+// Low-discrepancy GGX importance sampling shared by the offline lighting precomputes (BrdfLut, IblBaker).
+namespace VulkEng::GgxSampling {
+
+    constexpr float Pi = 3.14159265358979f;
+
+    // Point i of a count-point Hammersley set in [0, 1)^2.
+    inline glm::vec2 Hammersley(uint32_t i, uint32_t count) {
+        uint32_t bits = i;
+        bits = (bits << 16u) | (bits >> 16u);
+        bits = ((bits & 0x55555555u) << 1u) | ((bits & 0xAAAAAAAAu) >> 1u);
+        bits = ((bits & 0x33333333u) << 2u) | ((bits & 0xCCCCCCCCu) >> 2u);
+        bits = ((bits & 0x0F0F0F0Fu) << 4u) | ((bits & 0xF0F0F0F0u) >> 4u);
+        bits = ((bits & 0x00FF00FFu) << 8u) | ((bits & 0xFF00FF00u) >> 8u);
+        return {static_cast<float>(i) / static_cast<float>(count), static_cast<float>(bits) * 2.3283064365386963e-10f};
+    }
+
+    // Half vector around N = +Z, distributed like GGX with alpha = roughness^2.
+    inline glm::vec3 ImportanceSample(glm::vec2 xi, float roughness) {
+        float alpha = roughness * roughness;
+        float phi = 2.0f * Pi * xi.x;
+        float cosTheta = std::sqrt((1.0f - xi.y) / (1.0f + (alpha * alpha - 1.0f) * xi.y));
+        float sinTheta = std::sqrt(1.0f - cosTheta * cosTheta);
+        return {sinTheta * std::cos(phi), sinTheta * std::sin(phi), cosTheta};
+    }
+
+    // GGX normal distribution D(h) for the same alpha.
+    inline float Distribution(float NdotH, float roughness) {
+        float alpha2 = roughness * roughness * roughness * roughness;
+        float denom = NdotH * NdotH * (alpha2 - 1.0f) + 1.0f;
+        return alpha2 / (Pi * denom * denom);
+    }
+
+} // namespace VulkEng::GgxSampling
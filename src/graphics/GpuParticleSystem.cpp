@@ -0,0 +1,739 @@
+#include "GpuParticleSystem.h"
+#include "Renderer.h"      // For MAX_FRAMES_IN_FLIGHT
+#include "VulkanContext.h"
+#include "ImmediateContext.h"
+#include "ParticleReference.h" // For ValidateAgainstReference
+#include "VulkanUtils.h"   // For VK_CHECK, hasStencilComponent
+#include "core/Log.h"
+#include "core/ServiceLocator.h" // For the JobSystem (parallel pipeline creation)
+#include "scene/Components/ParticleEmitterComponent.h"
+#include "scene/Components/TransformComponent.h"
+
+#include <algorithm> // For std::max, std::min, std::find
+#include <cfloat>    // For FLT_MAX
+#include <exception> // For std::exception_ptr
+#include <stdexcept>
+
+namespace VulkEng {
+
+    namespace {
+        constexpr uint32_t EmitGroupSize = 64;      // local_size_x of particle_emit.comp
+        constexpr uint32_t SimulateGroupSize = 256; // particle_simulate.comp, particle_args.comp
+        constexpr uint32_t SortGroupSize = 512;     // particle_sort.comp; one group sorts 1024 entries
+        constexpr uint32_t SortBlockSize = 1024;
+
+        // Offsets into the counters buffer (see the Counters block in the shaders).
+        constexpr VkDeviceSize CountersSize = 48;
+        constexpr VkDeviceSize SimulateArgsOffset = 16;
+        constexpr VkDeviceSize DrawArgsOffset = 32;
+        constexpr VkDeviceSize DrawInstanceCountOffset = DrawArgsOffset + sizeof(uint32_t);
+        constexpr VkDeviceSize AliveListHeaderSize = 8; // uint count; uint pad;
+
+        enum ArgsMode : uint32_t { ArgsMode_Reset = 0, ArgsMode_PreSimulate = 1, ArgsMode_PostSimulate = 2 };
+        enum SortMode : uint32_t { SortMode_Pad = 0, SortMode_Global = 1, SortMode_LocalStage = 2, SortMode_LocalBlock = 3 };
+
+        struct ArgsPushConstants {
+            uint32_t mode;
+            uint32_t capacity;
+        };
+
+        struct SortPushConstants {
+            uint32_t mode;
+            uint32_t sortCount;
+            uint32_t k;
+            uint32_t j;
+        };
+
+        uint32_t NextPowerOfTwo(uint32_t value) {
+            uint32_t result = 1;
+            while (result < value) result <<= 1;
+            return result;
+        }
+    }
+
+    ParticleEmitterGpuState::~ParticleEmitterGpuState() {
+        if (device != VK_NULL_HANDLE && descriptorPool != VK_NULL_HANDLE && descriptorSets[0] != VK_NULL_HANDLE) {
+            vkFreeDescriptorSets(device, descriptorPool, static_cast<uint32_t>(descriptorSets.size()), descriptorSets.data());
+        }
+    }
+
+    GpuParticleSystem::GpuParticleSystem(VulkanContext& context, ShaderLibrary& shaderLibrary, VkDescriptorSetLayout frameSetLayout)
+        : m_Context(context), m_ShaderLibrary(shaderLibrary), m_CameraSetLayout(frameSetLayout) {
+        CreateLayouts();
+        CreateComputePipelines();
+        CreateFrameResources();
+        m_StatesInFlight.resize(MAX_FRAMES_IN_FLIGHT);
+        m_ReadbackCounts.assign(MAX_FRAMES_IN_FLIGHT, 0);
+        VKENG_INFO("GpuParticleSystem: Initialized (up to {} emitters).", MaxEmitters);
+    }
+
+    GpuParticleSystem::~GpuParticleSystem() {
+        VkDevice device = m_Context.device;
+        DestroyPipelines();
+        m_Steps.clear();
+        m_StatesInFlight.clear(); // Frees their descriptor sets before the pool goes
+        m_FrameUniformBuffers.clear();
+        m_ReadbackBuffers.clear();
+
+        vkDestroyPipeline(device, m_EmitPipeline, nullptr);
+        vkDestroyPipeline(device, m_ArgsPipeline, nullptr);
+        vkDestroyPipeline(device, m_SimulatePipeline, nullptr);
+        vkDestroyPipeline(device, m_SortPipeline, nullptr);
+        vkDestroyPipelineLayout(device, m_ComputeLayout, nullptr);
+        vkDestroyPipelineLayout(device, m_DrawLayout, nullptr);
+        vkDestroySampler(device, m_DepthSampler, nullptr);
+        vkDestroyDescriptorSetLayout(device, m_FrameSetLayout, nullptr);
+        vkDestroyDescriptorSetLayout(device, m_EmitterSetLayout, nullptr);
+        // Emitter states still held by components free their sets into a destroyed pool otherwise;
+        // the scene is destroyed before the renderer, so none are left at this point.
+        vkDestroyDescriptorPool(device, m_DescriptorPool, nullptr);
+    }
+
+    void GpuParticleSystem::CreateLayouts() {
+        VkDevice device = m_Context.device;
+
+        // Set 0 (compute): previous frame's camera + depth buffer
+        std::array<VkDescriptorSetLayoutBinding, 2> frameBindings = {};
+        frameBindings[0].binding = 0;
+        frameBindings[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        frameBindings[0].descriptorCount = 1;
+        frameBindings[0].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        frameBindings[1].binding = 1;
+        frameBindings[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        frameBindings[1].descriptorCount = 1;
+        frameBindings[1].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        VkDescriptorSetLayoutCreateInfo frameLayoutInfo{VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO};
+        frameLayoutInfo.bindingCount = static_cast<uint32_t>(frameBindings.size());
+        frameLayoutInfo.pBindings = frameBindings.data();
+        VK_CHECK(vkCreateDescriptorSetLayout(device, &frameLayoutInfo, nullptr, &m_FrameSetLayout));
+
+        // Set 1: particles, dead list, current list, next list, counters
+        std::array<VkDescriptorSetLayoutBinding, 5> emitterBindings = {};
+        for (uint32_t i = 0; i < emitterBindings.size(); ++i) {
+            emitterBindings[i].binding = i;
+            emitterBindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            emitterBindings[i].descriptorCount = 1;
+            emitterBindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_VERTEX_BIT;
+        }
+        VkDescriptorSetLayoutCreateInfo emitterLayoutInfo{VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO};
+        emitterLayoutInfo.bindingCount = static_cast<uint32_t>(emitterBindings.size());
+        emitterLayoutInfo.pBindings = emitterBindings.data();
+        VK_CHECK(vkCreateDescriptorSetLayout(device, &emitterLayoutInfo, nullptr, &m_EmitterSetLayout));
+
+        std::array<VkDescriptorPoolSize, 3> poolSizes = {{
+            {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, MaxEmitters * 2 * static_cast<uint32_t>(emitterBindings.size())},
+            {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT)},
+            {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT)},
+        }};
+        VkDescriptorPoolCreateInfo poolInfo{VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO};
+        poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
+        poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+        poolInfo.pPoolSizes = poolSizes.data();
+        poolInfo.maxSets = MaxEmitters * 2 + MAX_FRAMES_IN_FLIGHT;
+        VK_CHECK(vkCreateDescriptorPool(device, &poolInfo, nullptr, &m_DescriptorPool));
+
+        // Every pass pushes at most the 128-byte ParticleEmitParams.
+        std::array<VkDescriptorSetLayout, 2> computeSets = {m_FrameSetLayout, m_EmitterSetLayout};
+        VkPushConstantRange computeRange{VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(ParticleEmitParams)};
+        VkPipelineLayoutCreateInfo computeLayoutInfo{VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO};
+        computeLayoutInfo.setLayoutCount = static_cast<uint32_t>(computeSets.size());
+        computeLayoutInfo.pSetLayouts = computeSets.data();
+        computeLayoutInfo.pushConstantRangeCount = 1;
+        computeLayoutInfo.pPushConstantRanges = &computeRange;
+        VK_CHECK(vkCreatePipelineLayout(device, &computeLayoutInfo, nullptr, &m_ComputeLayout));
+
+        std::array<VkDescriptorSetLayout, 2> drawSets = {m_CameraSetLayout, m_EmitterSetLayout};
+        VkPushConstantRange drawRange{VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(ParticleEmitParams)};
+        VkPipelineLayoutCreateInfo drawLayoutInfo{VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO};
+        drawLayoutInfo.setLayoutCount = static_cast<uint32_t>(drawSets.size());
+        drawLayoutInfo.pSetLayouts = drawSets.data();
+        drawLayoutInfo.pushConstantRangeCount = 1;
+        drawLayoutInfo.pPushConstantRanges = &drawRange;
+        VK_CHECK(vkCreatePipelineLayout(device, &drawLayoutInfo, nullptr, &m_DrawLayout));
+
+        VkSamplerCreateInfo samplerInfo{VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO};
+        samplerInfo.magFilter = VK_FILTER_NEAREST; // Depth values must not be blended across edges
+        samplerInfo.minFilter = VK_FILTER_NEAREST;
+        samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+        samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerInfo.maxLod = 0.0f;
+        VK_CHECK(vkCreateSampler(device, &samplerInfo, nullptr, &m_DepthSampler));
+    }
+
+    std::array<std::pair<const char*, VkPipeline*>, 4> GpuParticleSystem::GetComputePipelineSlots() {
+        return {{
+            {"particle_emit.comp", &m_EmitPipeline},
+            {"particle_args.comp", &m_ArgsPipeline},
+            {"particle_simulate.comp", &m_SimulatePipeline},
+            {"particle_sort.comp", &m_SortPipeline},
+        }};
+    }
+
+    void GpuParticleSystem::CreateComputePipelines() {
+        const std::array<std::pair<const char*, VkPipeline*>, 4> pipelines = GetComputePipelineSlots();
+        // Compiled in parallel; jobs only log exceptions, so they are rethrown here.
+        std::array<std::exception_ptr, 4> errors{};
+        ServiceLocator::GetJobSystem().ParallelFor(static_cast<uint32_t>(pipelines.size()), 1, [&](uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end; ++i) {
+                try {
+                    *pipelines[i].second = BuildComputePipeline(pipelines[i].first);
+                } catch (...) { errors[i] = std::current_exception(); }
+            }
+        });
+        for (const std::exception_ptr& error : errors) {
+            if (error) std::rethrow_exception(error);
+        }
+    }
+
+    void GpuParticleSystem::CreateFrameResources() {
+        std::vector<VkDescriptorSetLayout> layouts(MAX_FRAMES_IN_FLIGHT, m_FrameSetLayout);
+        VkDescriptorSetAllocateInfo allocInfo{VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO};
+        allocInfo.descriptorPool = m_DescriptorPool;
+        allocInfo.descriptorSetCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
+        allocInfo.pSetLayouts = layouts.data();
+        m_FrameSets.resize(MAX_FRAMES_IN_FLIGHT);
+        VK_CHECK(vkAllocateDescriptorSets(m_Context.device, &allocInfo, m_FrameSets.data()));
+
+        m_FrameUniformBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+        m_ReadbackBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+        for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
+            m_FrameUniformBuffers[i] = std::make_unique<VulkanBuffer>(
+                m_Context, sizeof(ParticleFrameUBO), 1, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                1, BufferMapping::Persistent);
+            m_ReadbackBuffers[i] = std::make_unique<VulkanBuffer>(
+                m_Context, sizeof(uint32_t), MaxEmitters, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                1, BufferMapping::Persistent);
+
+            VkDescriptorBufferInfo uboInfo = m_FrameUniformBuffers[i]->GetDescriptorInfo(sizeof(ParticleFrameUBO));
+            VkWriteDescriptorSet write{VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
+            write.dstSet = m_FrameSets[i]; write.dstBinding = 0;
+            write.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+            write.descriptorCount = 1; write.pBufferInfo = &uboInfo;
+            vkUpdateDescriptorSets(m_Context.device, 1, &write, 0, nullptr);
+        }
+    }
+
+    VkPipeline GpuParticleSystem::BuildComputePipeline(const char* shaderName) const {
+        auto shader = m_ShaderLibrary.Load(shaderName);
+        VkComputePipelineCreateInfo pipelineInfo{VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO};
+        pipelineInfo.stage = {VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO};
+        pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+        pipelineInfo.stage.module = m_ShaderLibrary.CreateModule(*shader);
+        pipelineInfo.stage.pName = "main";
+        pipelineInfo.layout = m_ComputeLayout;
+        VkPipeline pipeline = VK_NULL_HANDLE;
+        VkResult result = vkCreateComputePipelines(m_Context.device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline);
+        vkDestroyShaderModule(m_Context.device, pipelineInfo.stage.module, nullptr);
+        VK_CHECK(result);
+        return pipeline;
+    }
+
+    void GpuParticleSystem::CreatePipelines(VkRenderPass renderPass, bool reversedZ, VkSampleCountFlagBits samples) {
+        m_RenderPass = renderPass;
+        m_ReversedZ = reversedZ;
+        m_Samples = samples;
+        m_DrawPipeline = BuildDrawPipeline();
+    }
+
+    VkPipeline GpuParticleSystem::BuildDrawPipeline() const {
+        auto vertexShader = m_ShaderLibrary.Load("particle.vert");
+        auto fragmentShader = m_ShaderLibrary.Load("particle.frag");
+        std::array<VkPipelineShaderStageCreateInfo, 2> stages = {};
+        stages[0] = {VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO};
+        stages[0].stage = VK_SHADER_STAGE_VERTEX_BIT; stages[0].module = m_ShaderLibrary.CreateModule(*vertexShader); stages[0].pName = "main";
+        stages[1] = {VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO};
+        stages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT; stages[1].pName = "main";
+        try {
+            stages[1].module = m_ShaderLibrary.CreateModule(*fragmentShader);
+        } catch (...) {
+            vkDestroyShaderModule(m_Context.device, stages[0].module, nullptr);
+            throw;
+        }
+
+        // Quads are generated from gl_VertexIndex / gl_InstanceIndex; no vertex buffers.
+        VkPipelineVertexInputStateCreateInfo vertexInputInfo{VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO};
+        VkPipelineInputAssemblyStateCreateInfo inputAssembly{VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO};
+        inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+        VkPipelineViewportStateCreateInfo viewportState{VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO};
+        viewportState.viewportCount = 1; viewportState.scissorCount = 1; // Dynamic states
+
+        VkPipelineRasterizationStateCreateInfo rasterizer{VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO};
+        rasterizer.polygonMode = VK_POLYGON_MODE_FILL; rasterizer.lineWidth = 1.0f;
+        rasterizer.cullMode = VK_CULL_MODE_NONE;
+        VkPipelineMultisampleStateCreateInfo multisampling{VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO};
+        multisampling.rasterizationSamples = m_Samples;
+
+        // Tested against the scene, but particles don't occlude each other (they are sorted instead).
+        VkPipelineDepthStencilStateCreateInfo depthStencil{VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO};
+        depthStencil.depthTestEnable = VK_TRUE; depthStencil.depthWriteEnable = VK_FALSE;
+        depthStencil.depthCompareOp = m_ReversedZ ? VK_COMPARE_OP_GREATER : VK_COMPARE_OP_LESS;
+
+        VkPipelineColorBlendAttachmentState colorBlendAttachment{};
+        colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+        colorBlendAttachment.blendEnable = VK_TRUE;
+        colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+        colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+        colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
+        colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+        colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+        colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
+        VkPipelineColorBlendStateCreateInfo colorBlending{VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO};
+        colorBlending.attachmentCount = 1; colorBlending.pAttachments = &colorBlendAttachment;
+
+        std::array<VkDynamicState, 2> dynamicStates = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+        VkPipelineDynamicStateCreateInfo dynamicStateInfo{VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO};
+        dynamicStateInfo.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
+        dynamicStateInfo.pDynamicStates = dynamicStates.data();
+
+        VkGraphicsPipelineCreateInfo pipelineInfo{VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO};
+        pipelineInfo.stageCount = static_cast<uint32_t>(stages.size()); pipelineInfo.pStages = stages.data();
+        pipelineInfo.pVertexInputState = &vertexInputInfo; pipelineInfo.pInputAssemblyState = &inputAssembly;
+        pipelineInfo.pViewportState = &viewportState; pipelineInfo.pRasterizationState = &rasterizer;
+        pipelineInfo.pMultisampleState = &multisampling; pipelineInfo.pDepthStencilState = &depthStencil;
+        pipelineInfo.pColorBlendState = &colorBlending; pipelineInfo.pDynamicState = &dynamicStateInfo;
+        pipelineInfo.layout = m_DrawLayout; pipelineInfo.renderPass = m_RenderPass; pipelineInfo.subpass = 0;
+        VkPipeline pipeline = VK_NULL_HANDLE;
+        VkResult result = vkCreateGraphicsPipelines(m_Context.device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline);
+        vkDestroyShaderModule(m_Context.device, stages[1].module, nullptr);
+        vkDestroyShaderModule(m_Context.device, stages[0].module, nullptr);
+        VK_CHECK(result);
+        return pipeline;
+    }
+
+    void GpuParticleSystem::DestroyPipelines() {
+        if (m_DrawPipeline != VK_NULL_HANDLE) vkDestroyPipeline(m_Context.device, m_DrawPipeline, nullptr);
+        m_DrawPipeline = VK_NULL_HANDLE;
+        m_RenderPass = VK_NULL_HANDLE;
+    }
+
+    std::vector<PipelineReplacement> GpuParticleSystem::BuildReloadedPipelines(const std::vector<std::string>& changedShaders) {
+        auto isChanged = [&](const char* name) { return std::find(changedShaders.begin(), changedShaders.end(), name) != changedShaders.end(); };
+        std::vector<PipelineReplacement> replacements;
+        for (const auto& [shaderName, slot] : GetComputePipelineSlots()) {
+            if (!isChanged(shaderName)) continue;
+            try {
+                replacements.push_back({slot, BuildComputePipeline(shaderName), shaderName});
+            } catch (const std::exception& e) {
+                VKENG_ERROR("GpuParticleSystem: Hot reload of {} failed, keeping the old pipeline: {}", shaderName, e.what());
+            }
+        }
+        if (m_RenderPass != VK_NULL_HANDLE && (isChanged("particle.vert") || isChanged("particle.frag"))) {
+            try {
+                replacements.push_back({&m_DrawPipeline, BuildDrawPipeline(), "particle.vert + particle.frag"});
+            } catch (const std::exception& e) {
+                VKENG_ERROR("GpuParticleSystem: Hot reload of particle.vert + particle.frag failed, keeping the old pipeline: {}", e.what());
+            }
+        }
+        return replacements;
+    }
+
+    void GpuParticleSystem::SetDepthImage(VkImage image, VkImageView view, VkFormat format, VkExtent2D extent) {
+        m_DepthImage = image;
+        m_DepthFormat = format;
+        VkDescriptorImageInfo depthInfo{m_DepthSampler, view, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL};
+        for (VkDescriptorSet set : m_FrameSets) {
+            VkWriteDescriptorSet write{VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
+            write.dstSet = set; write.dstBinding = 1;
+            write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            write.descriptorCount = 1; write.pImageInfo = &depthInfo;
+            vkUpdateDescriptorSets(m_Context.device, 1, &write, 0, nullptr);
+        }
+        (void)extent; // The shaders get the size through ParticleFrameUBO::depthSize
+    }
+
+    std::shared_ptr<ParticleEmitterGpuState> GpuParticleSystem::CreateEmitterState(uint32_t capacity) {
+        auto state = std::make_shared<ParticleEmitterGpuState>(m_Context.device, m_DescriptorPool);
+        std::array<VkDescriptorSetLayout, 2> layouts = {m_EmitterSetLayout, m_EmitterSetLayout};
+        VkDescriptorSetAllocateInfo allocInfo{VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO};
+        allocInfo.descriptorPool = m_DescriptorPool;
+        allocInfo.descriptorSetCount = static_cast<uint32_t>(layouts.size());
+        allocInfo.pSetLayouts = layouts.data();
+        if (vkAllocateDescriptorSets(m_Context.device, &allocInfo, state->descriptorSets.data()) != VK_SUCCESS) {
+            VKENG_ERROR("GpuParticleSystem: Out of emitter descriptor sets (max {} emitters).", MaxEmitters);
+            state->descriptorSets = {VK_NULL_HANDLE, VK_NULL_HANDLE};
+            return nullptr;
+        }
+
+        state->capacity = capacity;
+        state->listCapacity = std::max(NextPowerOfTwo(capacity), SortBlockSize);
+        const VkMemoryPropertyFlags deviceLocal = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+        // Transfer sources for ValidateAgainstReference's readback.
+        state->particles = std::make_unique<VulkanBuffer>(m_Context, sizeof(GpuParticle), capacity,
+                                                          VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT, deviceLocal);
+        state->deadList = std::make_unique<VulkanBuffer>(m_Context, sizeof(uint32_t), capacity,
+                                                         VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, deviceLocal);
+        for (auto& list : state->aliveLists) {
+            // One extra uvec2 holds the header
+            list = std::make_unique<VulkanBuffer>(m_Context, 2 * sizeof(uint32_t), state->listCapacity + 1,
+                                                  VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT, deviceLocal);
+        }
+        state->counters = std::make_unique<VulkanBuffer>(
+            m_Context, CountersSize, 1,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+            deviceLocal);
+
+        for (uint32_t current = 0; current < 2; ++current) {
+            std::array<VkDescriptorBufferInfo, 5> infos = {
+                state->particles->GetDescriptorInfo(),
+                state->deadList->GetDescriptorInfo(),
+                state->aliveLists[current]->GetDescriptorInfo(),
+                state->aliveLists[1 - current]->GetDescriptorInfo(),
+                state->counters->GetDescriptorInfo(),
+            };
+            std::array<VkWriteDescriptorSet, 5> writes{};
+            for (uint32_t binding = 0; binding < writes.size(); ++binding) {
+                writes[binding] = {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
+                writes[binding].dstSet = state->descriptorSets[current];
+                writes[binding].dstBinding = binding;
+                writes[binding].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+                writes[binding].descriptorCount = 1;
+                writes[binding].pBufferInfo = &infos[binding];
+            }
+            vkUpdateDescriptorSets(m_Context.device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+        }
+        VKENG_INFO("GpuParticleSystem: Created emitter pool for {} particles ({:.1f} MB).", capacity,
+                   (capacity * (sizeof(GpuParticle) + sizeof(uint32_t)) + 2.0 * state->listCapacity * 8) / (1024.0 * 1024.0));
+        return state;
+    }
+
+    void GpuParticleSystem::BeginFrame(uint32_t frameIndex) {
+        m_StatesInFlight[frameIndex].clear();
+        const uint32_t* counts = static_cast<const uint32_t*>(m_ReadbackBuffers[frameIndex]->GetMappedMemory());
+        uint64_t alive = 0;
+        for (uint32_t i = 0; i < m_ReadbackCounts[frameIndex]; ++i) {
+            alive += counts[i];
+        }
+        m_Stats.aliveParticles = alive;
+        m_ReadbackCounts[frameIndex] = 0;
+    }
+
+    void GpuParticleSystem::Dispatch(VkCommandBuffer commandBuffer, VkPipeline pipeline, VkDescriptorSet set,
+                                     const void* pushConstants, uint32_t pushSize, uint32_t groupCount) {
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_ComputeLayout, 1, 1, &set, 0, nullptr);
+        vkCmdPushConstants(commandBuffer, m_ComputeLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, pushSize, pushConstants);
+        vkCmdDispatch(commandBuffer, groupCount, 1, 1);
+        ++m_Stats.dispatches;
+    }
+
+    void GpuParticleSystem::ComputeBarrier(VkCommandBuffer commandBuffer, VkPipelineStageFlags dstStages, VkAccessFlags dstAccess) {
+        VkMemoryBarrier barrier{VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+        barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        barrier.dstAccessMask = dstAccess;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, dstStages, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+    }
+
+    void GpuParticleSystem::Simulate(VkCommandBuffer commandBuffer, uint32_t frameIndex, const ParticleRenderList& emitters,
+                                     const ParticleFrameUBO& frame) {
+        m_Stats.emitters = 0;
+        m_Stats.sortedEmitters = 0;
+        m_Stats.dispatches = 0;
+        m_Steps.clear();
+        if (emitters.empty()) return;
+
+        for (const ParticleRenderInfo& info : emitters) {
+            if (!info.emitter) continue;
+            if (m_Steps.size() == MaxEmitters) {
+                VKENG_WARN_ONCE("GpuParticleSystem: More than {} emitters; the rest are skipped.", MaxEmitters);
+                break;
+            }
+            ParticleEmitterComponent& emitter = *info.emitter;
+            uint32_t capacity = std::min(std::max(emitter.GetSettings().capacity, 1u), MaxCapacity);
+            if (!emitter.GetGpuState() || emitter.GetGpuState()->capacity != capacity) {
+                emitter.SetGpuState(CreateEmitterState(capacity)); // The old pool is kept alive by earlier frames' lists
+                if (!emitter.GetGpuState()) continue;
+            }
+
+            glm::vec3 position = info.transform ? glm::vec3(info.transform->GetWorldMatrix()[3]) : glm::vec3(0.0f);
+            EmitterStep step;
+            step.state = emitter.GetGpuState();
+            step.params = emitter.TakeStep(position);
+            step.params.capacity = capacity;
+            step.set = step.state->descriptorSets[step.state->currentList];
+            step.sorted = (step.params.flags & ParticleFlag_SortBackToFront) != 0;
+            step.state->currentList ^= 1u; // This frame's next list is the next frame's current
+            m_StatesInFlight[frameIndex].push_back(step.state);
+            m_Steps.push_back(std::move(step));
+        }
+        if (m_Steps.empty()) return;
+        m_Stats.emitters = static_cast<uint32_t>(m_Steps.size());
+
+        m_FrameUniformBuffers[frameIndex]->WriteToBuffer(&frame, sizeof(frame));
+        VK_CHECK(m_FrameUniformBuffers[frameIndex]->FlushWrites()); // Persistently mapped
+
+        // The previous frame's draws and readback copies still read the pools, and its depth writes
+        // (or the depth resolve, with MSAA) must land before the simulation samples them.
+        VkImageMemoryBarrier depthBarrier{VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER};
+        depthBarrier.srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        depthBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        depthBarrier.oldLayout = frame.cameraPosition.w > 0.0f ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL : VK_IMAGE_LAYOUT_UNDEFINED;
+        depthBarrier.newLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+        depthBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        depthBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        depthBarrier.image = m_DepthImage;
+        depthBarrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+        if (Utils::hasStencilComponent(m_DepthFormat)) depthBarrier.subresourceRange.aspectMask |= VK_IMAGE_ASPECT_STENCIL_BIT;
+        depthBarrier.subresourceRange.levelCount = 1;
+        depthBarrier.subresourceRange.layerCount = 1;
+        vkCmdPipelineBarrier(commandBuffer,
+                             VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT |
+                             VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT |
+                             VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &depthBarrier);
+
+        RecordSteps(commandBuffer, m_FrameSets[frameIndex]);
+
+        // Nothing samples the depth buffer after this, but the render pass clears (or resolves into) it:
+        // order that after our reads.
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT |
+                             VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                             0, 0, nullptr, 0, nullptr, 0, nullptr);
+
+        // Alive counts for the stats, read once this frame's fence has signaled.
+        for (uint32_t slot = 0; slot < m_Steps.size(); ++slot) {
+            VkBufferCopy region{DrawInstanceCountOffset, slot * sizeof(uint32_t), sizeof(uint32_t)};
+            vkCmdCopyBuffer(commandBuffer, m_Steps[slot].state->counters->GetBuffer(),
+                            m_ReadbackBuffers[frameIndex]->GetBuffer(), 1, &region);
+        }
+        VkMemoryBarrier hostBarrier{VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+        hostBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        hostBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT,
+                             0, 1, &hostBarrier, 0, nullptr, 0, nullptr);
+        m_ReadbackCounts[frameIndex] = static_cast<uint32_t>(m_Steps.size());
+    }
+
+    void GpuParticleSystem::RecordSteps(VkCommandBuffer commandBuffer, VkDescriptorSet frameSet) {
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_ComputeLayout,
+                                0, 1, &frameSet, 0, nullptr);
+
+        // Each phase runs for all emitters, so one barrier covers them all.
+        const VkAccessFlags readWrite = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+        bool anyReset = false;
+        for (EmitterStep& step : m_Steps) {
+            if (!step.state->needsReset) continue;
+            ArgsPushConstants push{ArgsMode_Reset, step.state->capacity};
+            Dispatch(commandBuffer, m_ArgsPipeline, step.set, &push, sizeof(push),
+                     (step.state->capacity + SimulateGroupSize - 1) / SimulateGroupSize);
+            step.state->needsReset = false;
+            anyReset = true;
+        }
+        if (anyReset) ComputeBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, readWrite);
+
+        bool anyEmit = false;
+        for (const EmitterStep& step : m_Steps) {
+            if (step.params.emitCount == 0) continue;
+            Dispatch(commandBuffer, m_EmitPipeline, step.set, &step.params, sizeof(step.params),
+                     (step.params.emitCount + EmitGroupSize - 1) / EmitGroupSize);
+            anyEmit = true;
+        }
+        if (anyEmit) ComputeBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, readWrite);
+
+        for (const EmitterStep& step : m_Steps) {
+            ArgsPushConstants push{ArgsMode_PreSimulate, step.state->capacity};
+            Dispatch(commandBuffer, m_ArgsPipeline, step.set, &push, sizeof(push), 1);
+        }
+        ComputeBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+                       readWrite | VK_ACCESS_INDIRECT_COMMAND_READ_BIT);
+
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_SimulatePipeline);
+        for (const EmitterStep& step : m_Steps) {
+            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_ComputeLayout, 1, 1, &step.set, 0, nullptr);
+            vkCmdPushConstants(commandBuffer, m_ComputeLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(step.params), &step.params);
+            vkCmdDispatchIndirect(commandBuffer, step.state->counters->GetBuffer(), SimulateArgsOffset);
+            ++m_Stats.dispatches;
+        }
+        ComputeBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, readWrite);
+
+        for (const EmitterStep& step : m_Steps) {
+            ArgsPushConstants push{ArgsMode_PostSimulate, step.state->capacity};
+            Dispatch(commandBuffer, m_ArgsPipeline, step.set, &push, sizeof(push), 1);
+        }
+
+        RecordSort(commandBuffer);
+
+        ComputeBarrier(commandBuffer,
+                       VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+                       VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT);
+    }
+
+    void GpuParticleSystem::RecordSort(VkCommandBuffer commandBuffer) {
+        uint32_t maxSortCount = 0;
+        for (const EmitterStep& step : m_Steps) {
+            if (step.sorted) {
+                maxSortCount = std::max(maxSortCount, step.state->listCapacity);
+                ++m_Stats.sortedEmitters;
+            }
+        }
+        if (maxSortCount == 0) return;
+        const VkAccessFlags readWrite = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+        ComputeBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, readWrite);
+
+        auto dispatchSorted = [&](uint32_t mode, uint32_t k, uint32_t j) {
+            for (const EmitterStep& step : m_Steps) {
+                uint32_t sortCount = step.state->listCapacity;
+                if (!step.sorted || k > sortCount) continue;
+                SortPushConstants push{mode, sortCount, k, j};
+                uint32_t groups = mode == SortMode_Pad ? sortCount / SortGroupSize : sortCount / SortBlockSize;
+                Dispatch(commandBuffer, m_SortPipeline, step.set, &push, sizeof(push), groups);
+            }
+            ComputeBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, readWrite);
+        };
+
+        dispatchSorted(SortMode_Pad, 0, 0);
+        dispatchSorted(SortMode_LocalBlock, 0, 0); // Stages up to 1024 stay in shared memory
+        for (uint32_t k = SortBlockSize * 2; k <= maxSortCount; k <<= 1) {
+            for (uint32_t j = k >> 1; j >= SortBlockSize; j >>= 1) {
+                dispatchSorted(SortMode_Global, k, j);
+            }
+            dispatchSorted(SortMode_LocalStage, k, 0);
+        }
+    }
+
+    void GpuParticleSystem::Draw(VkCommandBuffer commandBuffer, VkDescriptorSet frameSet) {
+        if (m_Steps.empty() || m_DrawPipeline == VK_NULL_HANDLE) return;
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_DrawPipeline);
+        // The push constant range differs from the mesh pipelines' layout, so Set 0 is bound again.
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_DrawLayout, 0, 1, &frameSet, 0, nullptr);
+        for (const EmitterStep& step : m_Steps) {
+            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_DrawLayout, 1, 1, &step.set, 0, nullptr);
+            vkCmdPushConstants(commandBuffer, m_DrawLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(step.params), &step.params);
+            vkCmdDrawIndirect(commandBuffer, step.state->counters->GetBuffer(), DrawArgsOffset, 1, 0);
+        }
+    }
+
+    ParticleValidationResult GpuParticleSystem::ValidateAgainstReference(ImmediateContext& immediate, ParticleEmitParams params,
+                                                                         uint32_t steps, float tolerance /*= 1e-3f*/) {
+        ParticleValidationResult result;
+        if (m_DepthImage == VK_NULL_HANDLE) {
+            VKENG_ERROR("GpuParticleSystem: Validation needs the depth image the frame set binds.");
+            return result;
+        }
+        params.capacity = std::min(std::max(params.capacity, 1u), MaxCapacity);
+        params.emitCount = std::min(params.emitCount, params.capacity);
+        // Sorted, so both draw orders are deterministic; no collisions, which would need a rendered depth buffer.
+        params.flags = ParticleFlag_SortBackToFront;
+        std::shared_ptr<ParticleEmitterGpuState> state = CreateEmitterState(params.capacity);
+        if (!state) return result;
+
+        ParticleFrameUBO frame; // cameraPosition.w = 0: the depth buffer is never sampled
+        frame.cameraPosition = glm::vec4(0.0f, 2.0f, 10.0f, 0.0f);
+
+        // Frame slot 0's uniform buffer and set are borrowed, so nothing may be in flight.
+        vkDeviceWaitIdle(m_Context.device);
+        m_FrameUniformBuffers[0]->WriteToBuffer(&frame, sizeof(frame));
+        VK_CHECK(m_FrameUniformBuffers[0]->FlushWrites());
+        ParticleStats savedStats = m_Stats;
+        std::vector<EmitterStep> savedSteps;
+        savedSteps.swap(m_Steps);
+
+        const VkMemoryPropertyFlags hostRead = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+        auto particleReadback = std::make_unique<VulkanBuffer>(m_Context, sizeof(GpuParticle), params.capacity,
+                                                               VK_BUFFER_USAGE_TRANSFER_DST_BIT, hostRead, 1, BufferMapping::Persistent);
+        auto listReadback = std::make_unique<VulkanBuffer>(m_Context, 2 * sizeof(uint32_t), state->listCapacity + 1,
+                                                           VK_BUFFER_USAGE_TRANSFER_DST_BIT, hostRead, 1, BufferMapping::Persistent);
+
+        ParticleReferenceSimulator reference(params.capacity);
+        uint64_t batch = 0;
+        {
+            ImmediateContext::Recording recording = immediate.Record();
+            VkCommandBuffer commandBuffer = recording.GetCommandBuffer();
+            batch = recording.GetBatch();
+
+            // The frame set binds the depth buffer as read-only; keep the contents for the next frame's collisions.
+            VkImageMemoryBarrier depthBarrier{VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER};
+            depthBarrier.srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+            depthBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+            depthBarrier.oldLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+            depthBarrier.newLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+            depthBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            depthBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            depthBarrier.image = m_DepthImage;
+            depthBarrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+            if (Utils::hasStencilComponent(m_DepthFormat)) depthBarrier.subresourceRange.aspectMask |= VK_IMAGE_ASPECT_STENCIL_BIT;
+            depthBarrier.subresourceRange.levelCount = 1;
+            depthBarrier.subresourceRange.layerCount = 1;
+            vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                 0, 0, nullptr, 0, nullptr, 1, &depthBarrier);
+
+            const VkAccessFlags readWrite = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+            for (uint32_t stepIndex = 0; stepIndex < steps; ++stepIndex) {
+                params.randomSeed = ParticleHash(stepIndex + 1);
+                EmitterStep step;
+                step.state = state;
+                step.params = params;
+                step.set = state->descriptorSets[state->currentList];
+                step.sorted = true;
+                state->currentList ^= 1u;
+                m_Steps.assign(1, step);
+                ComputeBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, readWrite); // After the previous step
+                RecordSteps(commandBuffer, m_FrameSets[0]);
+                reference.Step(params, frame);
+            }
+            m_Steps.clear();
+
+            // The last step's next list is now the current one.
+            VkBufferCopy particleRegion{0, 0, particleReadback->GetBufferSize()};
+            vkCmdCopyBuffer(commandBuffer, state->particles->GetBuffer(), particleReadback->GetBuffer(), 1, &particleRegion);
+            VkBufferCopy listRegion{0, 0, listReadback->GetBufferSize()};
+            vkCmdCopyBuffer(commandBuffer, state->aliveLists[state->currentList]->GetBuffer(), listReadback->GetBuffer(), 1, &listRegion);
+            VkMemoryBarrier hostBarrier{VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+            hostBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            hostBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+            vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT,
+                                 0, 1, &hostBarrier, 0, nullptr, 0, nullptr);
+
+            depthBarrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+            depthBarrier.dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+            std::swap(depthBarrier.oldLayout, depthBarrier.newLayout);
+            vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT,
+                                 0, 0, nullptr, 0, nullptr, 1, &depthBarrier);
+        }
+        immediate.Wait(batch);
+        m_Steps.swap(savedSteps);
+        m_Stats = savedStats;
+
+        const GpuParticle* gpuParticles = static_cast<const GpuParticle*>(particleReadback->GetMappedMemory());
+        const uint32_t* gpuListHeader = static_cast<const uint32_t*>(listReadback->GetMappedMemory());
+        const glm::uvec2* gpuList = reinterpret_cast<const glm::uvec2*>(gpuListHeader + 2);
+        const std::vector<glm::uvec2>& referenceList = reference.GetDrawList();
+        const std::vector<GpuParticle>& referenceParticles = reference.GetParticles();
+        result.steps = steps;
+        result.gpuAlive = std::min(gpuListHeader[0], state->listCapacity);
+        result.referenceAlive = reference.GetAliveCount();
+
+        // Draw order side by side; slots differ, positions shouldn't. Particles at nearly the same
+        // distance may sort either way, so an entry also matches its reference neighbours.
+        uint32_t compared = std::min(result.gpuAlive, result.referenceAlive);
+        for (uint32_t i = 0; i < compared; ++i) {
+            if (gpuList[i].y >= params.capacity) {
+                ++result.mismatches;
+                continue;
+            }
+            glm::vec3 position = gpuParticles[gpuList[i].y].position;
+            float error = FLT_MAX;
+            for (uint32_t j = i > 0 ? i - 1 : 0; j <= std::min(i + 1, compared - 1); ++j) {
+                error = std::min(error, glm::length(position - referenceParticles[referenceList[j].y].position));
+            }
+            result.maxPositionError = std::max(result.maxPositionError, error);
+            if (error > tolerance) ++result.mismatches;
+        }
+        result.passed = result.gpuAlive == result.referenceAlive && result.mismatches == 0;
+
+        if (result.passed) {
+            VKENG_INFO("GpuParticleSystem: Matches the CPU reference after {} steps ({} alive, max position error {:.2e}).",
+                       steps, result.gpuAlive, result.maxPositionError);
+        } else {
+            VKENG_ERROR("GpuParticleSystem: Differs from the CPU reference after {} steps: {} alive vs {}, {} position(s) off by more "
+                        "than {} (max {:.2e}).", steps, result.gpuAlive, result.referenceAlive, result.mismatches, tolerance,
+                        result.maxPositionError);
+        }
+        return result;
+    }
+
+} // namespace VulkEng
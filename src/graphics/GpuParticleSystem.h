@@ -0,0 +1,175 @@
+#pragma once
+
+#include "ParticleTypes.h"
+#include "graphics/Buffer.h" // For VulkanBuffer
+#include "graphics/ShaderLibrary.h" // For PipelineReplacement
+#include "core/FrameArena.h" // For ParticleRenderList storage
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility> // For std::pair
+#include <vector>
+#include <vulkan/vulkan.h>
+
+namespace VulkEng {
+
+    class VulkanContext;
+    class ImmediateContext;
+    class ParticleEmitterComponent;
+    class TransformComponent;
+
+    // An emitter to simulate and draw this frame; `transform` positions the emitter (origin if null).
+    struct ParticleRenderInfo {
+        ParticleEmitterComponent* emitter = nullptr;
+        TransformComponent* transform = nullptr;
+    };
+    using ParticleRenderList = ScratchVector<ParticleRenderInfo>;
+
+    // GPU resources of one emitter, created by GpuParticleSystem and held by the component.
+    // The two descriptor sets bind the alive lists in both orders, so swapping current/next
+    // between frames is just picking the other set.
+    struct ParticleEmitterGpuState {
+        ParticleEmitterGpuState(VkDevice device, VkDescriptorPool descriptorPool)
+            : device(device), descriptorPool(descriptorPool) {}
+        ~ParticleEmitterGpuState();
+
+        ParticleEmitterGpuState(const ParticleEmitterGpuState&) = delete;
+        ParticleEmitterGpuState& operator=(const ParticleEmitterGpuState&) = delete;
+
+        VkDevice device = VK_NULL_HANDLE;
+        VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+        uint32_t capacity = 0;
+        uint32_t listCapacity = 0; // Power of two >= max(capacity, 1024), the range the sort works on
+
+        std::unique_ptr<VulkanBuffer> particles;  // GpuParticle[capacity]
+        std::unique_ptr<VulkanBuffer> deadList;   // uint[capacity], stack of free slots
+        std::array<std::unique_ptr<VulkanBuffer>, 2> aliveLists; // {count, pad, uvec2 (key, index)[listCapacity]}
+        std::unique_ptr<VulkanBuffer> counters;   // Dead count + indirect dispatch/draw arguments
+        std::array<VkDescriptorSet, 2> descriptorSets = {VK_NULL_HANDLE, VK_NULL_HANDLE}; // [i]: list i is current
+        uint32_t currentList = 0;
+        bool needsReset = true;
+    };
+
+    // Particle counters for the last recorded frame (alive count as of the last frame the GPU finished).
+    struct ParticleStats {
+        uint32_t emitters = 0;
+        uint32_t sortedEmitters = 0;
+        uint32_t dispatches = 0;
+        uint64_t aliveParticles = 0;
+    };
+
+    // Outcome of GpuParticleSystem::ValidateAgainstReference.
+    struct ParticleValidationResult {
+        uint32_t steps = 0;
+        uint32_t gpuAlive = 0;
+        uint32_t referenceAlive = 0;
+        uint32_t mismatches = 0;      // Draw-order entries further than the tolerance from the reference
+        float maxPositionError = 0.0f;
+        bool passed = false;
+    };
+
+    // Simulates and draws ParticleEmitterComponents entirely on the GPU. Per frame, before the render
+    // pass, Simulate() records a fixed handful of compute dispatches per emitter (emit, simulate with
+    // depth-buffer collisions and in-place compaction, plus a bitonic sort for sorted emitters), all
+    // driven by indirect arguments the shaders write themselves; Draw() then issues one indirect
+    // instanced draw per emitter. The CPU never reads particle data, so its cost does not depend on
+    // the particle count. ParticleReferenceSimulator is the CPU counterpart, checked by ValidateAgainstReference.
+    class GpuParticleSystem {
+    public:
+        static constexpr uint32_t MaxEmitters = 256;
+        static constexpr uint32_t MaxCapacity = 1u << 22; // Per emitter
+
+        // `frameSetLayout` is the renderer's Set 0 (camera UBO), reused by the particle draw.
+        GpuParticleSystem(VulkanContext& context, ShaderLibrary& shaderLibrary, VkDescriptorSetLayout frameSetLayout);
+        ~GpuParticleSystem();
+
+        GpuParticleSystem(const GpuParticleSystem&) = delete;
+        GpuParticleSystem& operator=(const GpuParticleSystem&) = delete;
+
+        // Swapchain-dependent: the draw pipeline and the depth buffer collisions are read from.
+        // The device must be idle when these are called (as during swapchain recreation).
+        // `samples` is the scene pass's MSAA sample count; the depth image is always single-sampled.
+        void CreatePipelines(VkRenderPass renderPass, bool reversedZ, VkSampleCountFlagBits samples);
+        void DestroyPipelines();
+        void SetDepthImage(VkImage image, VkImageView view, VkFormat format, VkExtent2D extent);
+
+        // Replacements for the pipelines whose shaders are among `changedShaders`, built without
+        // touching the live ones (see PostProcessStack::BuildReloadedPipelines). Failures are logged and skipped.
+        std::vector<PipelineReplacement> BuildReloadedPipelines(const std::vector<std::string>& changedShaders);
+
+        // Call once the frame that last used this slot has completed: reads back alive counts, releases old buffers.
+        void BeginFrame(uint32_t frameIndex);
+        // Records the simulation; outside a render pass. `frame` describes the previous frame's camera
+        // and depth buffer (cameraPosition.w = 0 if the depth buffer holds nothing yet).
+        void Simulate(VkCommandBuffer commandBuffer, uint32_t frameIndex, const ParticleRenderList& emitters,
+                      const ParticleFrameUBO& frame);
+        // Draws what Simulate() recorded this frame; inside the render pass, after opaque geometry.
+        void Draw(VkCommandBuffer commandBuffer, VkDescriptorSet frameSet);
+
+        const ParticleStats& GetStats() const { return m_Stats; }
+
+        // Runs `steps` steps of one emitter with `params` (seeded per step) both on the GPU and in
+        // ParticleReferenceSimulator, then compares alive counts and positions in draw order. Sorting is
+        // forced on and depth collisions off. Waits for the device; a debug aid, results also go to the log.
+        ParticleValidationResult ValidateAgainstReference(ImmediateContext& immediate, ParticleEmitParams params,
+                                                          uint32_t steps, float tolerance = 1e-3f);
+
+    private:
+        struct EmitterStep {
+            std::shared_ptr<ParticleEmitterGpuState> state;
+            ParticleEmitParams params;
+            VkDescriptorSet set = VK_NULL_HANDLE; // Current -> next for this frame
+            bool sorted = false;
+        };
+
+        void CreateLayouts();
+        void CreateComputePipelines();
+        // Each compute shader and the pipeline member built from it.
+        std::array<std::pair<const char*, VkPipeline*>, 4> GetComputePipelineSlots();
+        VkPipeline BuildComputePipeline(const char* shaderName) const;
+        VkPipeline BuildDrawPipeline() const; // For the render pass and state of the last CreatePipelines
+        void CreateFrameResources();
+        std::shared_ptr<ParticleEmitterGpuState> CreateEmitterState(uint32_t capacity);
+        void Dispatch(VkCommandBuffer commandBuffer, VkPipeline pipeline, VkDescriptorSet set,
+                      const void* pushConstants, uint32_t pushSize, uint32_t groupCount);
+        void ComputeBarrier(VkCommandBuffer commandBuffer, VkPipelineStageFlags dstStages, VkAccessFlags dstAccess);
+        // Records the compute passes for m_Steps, from the pool resets to the sort.
+        void RecordSteps(VkCommandBuffer commandBuffer, VkDescriptorSet frameSet);
+        void RecordSort(VkCommandBuffer commandBuffer);
+
+        VulkanContext& m_Context;
+        ShaderLibrary& m_ShaderLibrary;
+        VkDescriptorSetLayout m_CameraSetLayout = VK_NULL_HANDLE; // Renderer's, not owned
+
+        VkDescriptorPool m_DescriptorPool = VK_NULL_HANDLE;
+        VkDescriptorSetLayout m_FrameSetLayout = VK_NULL_HANDLE;   // Set 0 of the compute passes (frame UBO + depth)
+        VkDescriptorSetLayout m_EmitterSetLayout = VK_NULL_HANDLE; // Set 1 (compute) / Set 1 (draw)
+        VkPipelineLayout m_ComputeLayout = VK_NULL_HANDLE;
+        VkPipelineLayout m_DrawLayout = VK_NULL_HANDLE;
+        VkPipeline m_EmitPipeline = VK_NULL_HANDLE;
+        VkPipeline m_ArgsPipeline = VK_NULL_HANDLE;
+        VkPipeline m_SimulatePipeline = VK_NULL_HANDLE;
+        VkPipeline m_SortPipeline = VK_NULL_HANDLE;
+        VkPipeline m_DrawPipeline = VK_NULL_HANDLE;
+        VkRenderPass m_RenderPass = VK_NULL_HANDLE; // Null while the swapchain-dependent pipeline is destroyed
+        bool m_ReversedZ = false;
+        VkSampleCountFlagBits m_Samples = VK_SAMPLE_COUNT_1_BIT;
+        VkSampler m_DepthSampler = VK_NULL_HANDLE;
+
+        VkImage m_DepthImage = VK_NULL_HANDLE;
+        VkFormat m_DepthFormat = VK_FORMAT_UNDEFINED;
+
+        // Per frame in flight
+        std::vector<std::unique_ptr<VulkanBuffer>> m_FrameUniformBuffers;
+        std::vector<VkDescriptorSet> m_FrameSets;
+        std::vector<std::unique_ptr<VulkanBuffer>> m_ReadbackBuffers; // Alive count per emitter slot
+        std::vector<uint32_t> m_ReadbackCounts;
+        std::vector<std::vector<std::shared_ptr<ParticleEmitterGpuState>>> m_StatesInFlight;
+
+        std::vector<EmitterStep> m_Steps; // Recorded by Simulate, drawn by Draw
+        ParticleStats m_Stats;
+    };
+
+} // namespace VulkEng
@@ -0,0 +1,371 @@
+#include "IblBaker.h"
+#include "GgxSampling.h"
+#include "core/AtomicFile.h"
+#include "core/Hash.h"
+#include "core/Log.h"
+#include "core/ServiceLocator.h" // For the JobSystem
+
+#include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp> // For glm::packHalf1x16
+#include <stb_image.h>         // Implementation lives in AssetManager.cpp
+
+#include <algorithm> // For std::clamp, std::max, std::min
+#include <array>
+#include <chrono>
+#include <cinttypes> // For PRIx64
+#include <cmath>
+#include <cstdio>    // For std::snprintf
+#include <fstream>
+#include <functional>
+
+namespace VulkEng {
+
+    namespace {
+        constexpr uint32_t CacheMagic = 0x4C424949; // "IIBL"
+        constexpr uint32_t CacheVersion = 1;       // Bump when the bake below changes
+
+        struct CacheHeader {
+            uint32_t magic = CacheMagic;
+            uint32_t version = CacheVersion;
+            uint32_t irradianceSize = 0;
+            uint32_t specularSize = 0;
+            uint32_t specularMipCount = 0;
+            uint32_t sampleCount = 0;
+            uint64_t contentHash = 0;
+        };
+
+        using GgxSampling::Pi;
+
+        // One mip of a cube map as linear RGB.
+        struct CubeLevel {
+            uint32_t size = 0;
+            std::vector<glm::vec3> texels; // 6 faces of size * size texels, row-major
+
+            explicit CubeLevel(uint32_t levelSize) : size(levelSize), texels(6ull * levelSize * levelSize) {}
+            glm::vec3& At(uint32_t face, uint32_t x, uint32_t y) { return texels[(static_cast<size_t>(face) * size + y) * size + x]; }
+            const glm::vec3& At(uint32_t face, uint32_t x, uint32_t y) const { return texels[(static_cast<size_t>(face) * size + y) * size + x]; }
+        };
+
+        // Direction through face coordinates (u, v) in [-1, 1] (Vulkan cube map conventions).
+        glm::vec3 FaceDirection(uint32_t face, float u, float v) {
+            switch (face) {
+                case 0:  return { 1.0f, -v, -u};
+                case 1:  return {-1.0f, -v,  u};
+                case 2:  return { u,  1.0f,  v};
+                case 3:  return { u, -1.0f, -v};
+                case 4:  return { u, -v,  1.0f};
+                default: return {-u, -v, -1.0f};
+            }
+        }
+
+        // Inverse of FaceDirection: the face `dir` hits and the (u, v) there, in [0, 1].
+        uint32_t DirectionToFace(const glm::vec3& dir, float& outU, float& outV) {
+            glm::vec3 a = glm::abs(dir);
+            uint32_t face;
+            float u, v, major;
+            if (a.x >= a.y && a.x >= a.z) {
+                face = dir.x > 0.0f ? 0 : 1; major = a.x;
+                u = dir.x > 0.0f ? -dir.z : dir.z; v = -dir.y;
+            } else if (a.y >= a.z) {
+                face = dir.y > 0.0f ? 2 : 3; major = a.y;
+                u = dir.x; v = dir.y > 0.0f ? dir.z : -dir.z;
+            } else {
+                face = dir.z > 0.0f ? 4 : 5; major = a.z;
+                u = dir.z > 0.0f ? dir.x : -dir.x; v = -dir.y;
+            }
+            outU = 0.5f * (u / major + 1.0f);
+            outV = 0.5f * (v / major + 1.0f);
+            return face;
+        }
+
+        // Face coordinates of a texel center, in [-1, 1].
+        glm::vec2 TexelFaceCoords(float x, float y, uint32_t size) {
+            return {2.0f * x / static_cast<float>(size) - 1.0f, 2.0f * y / static_cast<float>(size) - 1.0f};
+        }
+
+        // Bilinear sample of an equirectangular image (+Y up); u wraps around.
+        glm::vec3 SampleEquirect(const float* pixels, int width, int height, const glm::vec3& dir) {
+            float u = std::atan2(dir.z, dir.x) / (2.0f * Pi) + 0.5f;
+            float v = std::acos(std::clamp(dir.y, -1.0f, 1.0f)) / Pi;
+            float x = u * static_cast<float>(width) - 0.5f;
+            float y = v * static_cast<float>(height) - 0.5f;
+            int x0 = static_cast<int>(std::floor(x));
+            int y0 = static_cast<int>(std::floor(y));
+            float fx = x - static_cast<float>(x0);
+            float fy = y - static_cast<float>(y0);
+            auto texel = [&](int tx, int ty) {
+                tx = ((tx % width) + width) % width;
+                ty = std::clamp(ty, 0, height - 1);
+                const float* p = pixels + (static_cast<size_t>(ty) * width + tx) * 3;
+                return glm::vec3(p[0], p[1], p[2]);
+            };
+            return glm::mix(glm::mix(texel(x0, y0), texel(x0 + 1, y0), fx),
+                            glm::mix(texel(x0, y0 + 1), texel(x0 + 1, y0 + 1), fx), fy);
+        }
+
+        // Bilinear within the face `dir` hits (clamped at its edges, no filtering across seams).
+        glm::vec3 SampleCubeLevel(const CubeLevel& level, const glm::vec3& dir) {
+            float u, v;
+            uint32_t face = DirectionToFace(dir, u, v);
+            float maxCoord = static_cast<float>(level.size - 1);
+            float x = std::clamp(u * static_cast<float>(level.size) - 0.5f, 0.0f, maxCoord);
+            float y = std::clamp(v * static_cast<float>(level.size) - 0.5f, 0.0f, maxCoord);
+            uint32_t x0 = static_cast<uint32_t>(x);
+            uint32_t y0 = static_cast<uint32_t>(y);
+            uint32_t x1 = std::min(x0 + 1, level.size - 1);
+            uint32_t y1 = std::min(y0 + 1, level.size - 1);
+            float fx = x - static_cast<float>(x0);
+            float fy = y - static_cast<float>(y0);
+            return glm::mix(glm::mix(level.At(face, x0, y0), level.At(face, x1, y0), fx),
+                            glm::mix(level.At(face, x0, y1), level.At(face, x1, y1), fx), fy);
+        }
+
+        // Trilinear sample of a mip chain.
+        glm::vec3 SampleCube(const std::vector<CubeLevel>& levels, const glm::vec3& dir, float lod) {
+            lod = std::clamp(lod, 0.0f, static_cast<float>(levels.size() - 1));
+            size_t level0 = static_cast<size_t>(lod);
+            size_t level1 = std::min(level0 + 1, levels.size() - 1);
+            return glm::mix(SampleCubeLevel(levels[level0], dir), SampleCubeLevel(levels[level1], dir), lod - static_cast<float>(level0));
+        }
+
+        // Calls fn(face, y) for every texel row of a size-texel cube, across the workers.
+        void ForEachCubeRow(uint32_t size, const std::function<void(uint32_t, uint32_t)>& fn) {
+            ServiceLocator::GetJobSystem().ParallelFor(6 * size, std::max(1u, 64u / size), [&](uint32_t begin, uint32_t end) {
+                for (uint32_t row = begin; row < end; ++row) fn(row / size, row % size);
+            });
+        }
+
+        // Order-2 spherical harmonics projection of the radiance in `level` (Ramamoorthi & Hanrahan).
+        std::array<glm::vec3, 9> ProjectSh(const CubeLevel& level) {
+            std::array<glm::vec3, 9> coeffs{};
+            float weightSum = 0.0f;
+            for (uint32_t face = 0; face < 6; ++face) {
+                for (uint32_t y = 0; y < level.size; ++y) {
+                    for (uint32_t x = 0; x < level.size; ++x) {
+                        glm::vec2 uv = TexelFaceCoords(x + 0.5f, y + 0.5f, level.size);
+                        float solidAngle = 1.0f / std::pow(1.0f + uv.x * uv.x + uv.y * uv.y, 1.5f); // Up to a constant
+                        glm::vec3 d = glm::normalize(FaceDirection(face, uv.x, uv.y));
+                        const glm::vec3 radiance = level.At(face, x, y) * solidAngle;
+                        coeffs[0] += radiance * 0.282095f;
+                        coeffs[1] += radiance * (0.488603f * d.y);
+                        coeffs[2] += radiance * (0.488603f * d.z);
+                        coeffs[3] += radiance * (0.488603f * d.x);
+                        coeffs[4] += radiance * (1.092548f * d.x * d.y);
+                        coeffs[5] += radiance * (1.092548f * d.y * d.z);
+                        coeffs[6] += radiance * (0.315392f * (3.0f * d.z * d.z - 1.0f));
+                        coeffs[7] += radiance * (1.092548f * d.x * d.z);
+                        coeffs[8] += radiance * (0.546274f * (d.x * d.x - d.y * d.y));
+                        weightSum += solidAngle;
+                    }
+                }
+            }
+            for (glm::vec3& c : coeffs) c *= 4.0f * Pi / weightSum;
+            return coeffs;
+        }
+
+        // Irradiance around `n` divided by PI, i.e. the cosine-weighted mean radiance.
+        glm::vec3 EvaluateShIrradiance(const std::array<glm::vec3, 9>& c, const glm::vec3& n) {
+            // Convolution with the clamped cosine scales band l by A_l (PI, 2PI/3, PI/4); the 1/PI cancels it.
+            glm::vec3 result = c[0] * 0.282095f
+                + (2.0f / 3.0f) * (c[1] * (0.488603f * n.y) + c[2] * (0.488603f * n.z) + c[3] * (0.488603f * n.x))
+                + 0.25f * (c[4] * (1.092548f * n.x * n.y) + c[5] * (1.092548f * n.y * n.z)
+                           + c[6] * (0.315392f * (3.0f * n.z * n.z - 1.0f)) + c[7] * (1.092548f * n.x * n.z)
+                           + c[8] * (0.546274f * (n.x * n.x - n.y * n.y)));
+            return glm::max(result, glm::vec3(0.0f));
+        }
+
+        void AppendHalfTexels(const CubeLevel& level, std::vector<uint16_t>& out) {
+            for (const glm::vec3& color : level.texels) {
+                out.push_back(glm::packHalf1x16(color.r));
+                out.push_back(glm::packHalf1x16(color.g));
+                out.push_back(glm::packHalf1x16(color.b));
+                out.push_back(glm::packHalf1x16(1.0f));
+            }
+        }
+
+        size_t SpecularTexelCount() {
+            size_t count = 0;
+            for (uint32_t mip = 0; mip < IblBaker::SpecularMipCount; ++mip) {
+                size_t size = IblBaker::SpecularSize >> mip;
+                count += 6 * size * size;
+            }
+            return count;
+        }
+    }
+
+    bool IblBaker::LoadOrBake(const std::string& hdrPath, const std::filesystem::path& cacheDir, EnvironmentLightingData& outData) {
+        std::ifstream file(hdrPath, std::ios::binary | std::ios::ate);
+        if (!file.is_open()) {
+            VKENG_ERROR("IblBaker: Cannot read environment '{}'.", hdrPath);
+            return false;
+        }
+        std::vector<char> hdrFile(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        file.read(hdrFile.data(), static_cast<std::streamsize>(hdrFile.size()));
+
+        // Keyed by content, so moving or renaming the file keeps its bake and editing it invalidates it.
+        uint64_t contentHash = HashBytes(hdrFile.data(), hdrFile.size());
+        char cacheName[32];
+        std::snprintf(cacheName, sizeof(cacheName), "ibl-%016" PRIx64 ".bin", contentHash);
+        std::filesystem::path cachePath = cacheDir / cacheName;
+
+        if (ReadCache(cachePath, contentHash, outData)) {
+            VKENG_INFO("IblBaker: Loaded baked lighting for '{}' from '{}'.", hdrPath, cachePath.string());
+            return true;
+        }
+        if (!Bake(hdrFile, hdrPath, outData)) {
+            return false;
+        }
+        if (WriteCache(cachePath, contentHash, outData)) {
+            VKENG_INFO("IblBaker: Cached baked lighting in '{}'.", cachePath.string());
+        }
+        return true;
+    }
+
+    bool IblBaker::Bake(const std::vector<char>& hdrFile, const std::string& hdrPath, EnvironmentLightingData& outData) {
+        auto bakeStart = std::chrono::steady_clock::now();
+        int width = 0, height = 0, channels = 0;
+        float* pixels = stbi_loadf_from_memory(reinterpret_cast<const stbi_uc*>(hdrFile.data()), static_cast<int>(hdrFile.size()),
+                                               &width, &height, &channels, 3);
+        if (!pixels) {
+            VKENG_ERROR("IblBaker: Failed to decode environment '{}': {}", hdrPath, stbi_failure_reason());
+            return false;
+        }
+        VKENG_INFO("IblBaker: Baking '{}' ({}x{})...", hdrPath, width, height);
+
+        // The environment as a cube with a box-filtered mip chain: the source the prefiltering samples.
+        std::vector<CubeLevel> environment;
+        environment.emplace_back(SpecularSize);
+        ForEachCubeRow(SpecularSize, [&](uint32_t face, uint32_t y) {
+            for (uint32_t x = 0; x < SpecularSize; ++x) {
+                glm::vec3 sum(0.0f);
+                for (float sy : {0.25f, 0.75f}) { // 2x2 supersampling
+                    for (float sx : {0.25f, 0.75f}) {
+                        glm::vec2 uv = TexelFaceCoords(x + sx, y + sy, SpecularSize);
+                        sum += SampleEquirect(pixels, width, height, glm::normalize(FaceDirection(face, uv.x, uv.y)));
+                    }
+                }
+                environment[0].At(face, x, y) = sum * 0.25f;
+            }
+        });
+        stbi_image_free(pixels);
+        while (environment.back().size > 1) {
+            const CubeLevel& source = environment.back();
+            CubeLevel level(source.size / 2);
+            for (uint32_t face = 0; face < 6; ++face) {
+                for (uint32_t y = 0; y < level.size; ++y) {
+                    for (uint32_t x = 0; x < level.size; ++x) {
+                        level.At(face, x, y) = 0.25f * (source.At(face, 2 * x, 2 * y) + source.At(face, 2 * x + 1, 2 * y) +
+                                                        source.At(face, 2 * x, 2 * y + 1) + source.At(face, 2 * x + 1, 2 * y + 1));
+                    }
+                }
+            }
+            environment.push_back(std::move(level));
+        }
+
+        // Specular: mip 0 (roughness 0) is the environment itself; each further mip convolves it with
+        // the GGX lobe of its roughness, assuming N = V = R. Samples read the environment mip whose
+        // texels cover the sample's share of the lobe, which keeps low sample counts free of fireflies.
+        outData.specularSize = SpecularSize;
+        outData.specularMipCount = SpecularMipCount;
+        outData.specular.clear();
+        outData.specular.reserve(SpecularTexelCount() * 4);
+        AppendHalfTexels(environment[0], outData.specular);
+        const float environmentTexelSolidAngle = 4.0f * Pi / (6.0f * SpecularSize * SpecularSize);
+        for (uint32_t mip = 1; mip < SpecularMipCount; ++mip) {
+            float roughness = static_cast<float>(mip) / static_cast<float>(SpecularMipCount - 1);
+            CubeLevel level(SpecularSize >> mip);
+            ForEachCubeRow(level.size, [&](uint32_t face, uint32_t y) {
+                for (uint32_t x = 0; x < level.size; ++x) {
+                    glm::vec2 uv = TexelFaceCoords(x + 0.5f, y + 0.5f, level.size);
+                    glm::vec3 N = glm::normalize(FaceDirection(face, uv.x, uv.y));
+                    glm::vec3 up = std::abs(N.z) < 0.999f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(1.0f, 0.0f, 0.0f);
+                    glm::vec3 T = glm::normalize(glm::cross(up, N));
+                    glm::vec3 B = glm::cross(N, T);
+
+                    glm::vec3 color(0.0f);
+                    float weight = 0.0f;
+                    for (uint32_t i = 0; i < SpecularSampleCount; ++i) {
+                        glm::vec3 h = GgxSampling::ImportanceSample(GgxSampling::Hammersley(i, SpecularSampleCount), roughness);
+                        glm::vec3 H = T * h.x + B * h.y + N * h.z;
+                        glm::vec3 L = 2.0f * glm::dot(N, H) * H - N;
+                        float NdotL = glm::dot(N, L);
+                        if (NdotL <= 0.0f) continue;
+                        // pdf of L is D * NdotH / (4 * VdotH), which is D / 4 with V = N.
+                        float pdf = GgxSampling::Distribution(std::max(h.z, 0.0f), roughness) * 0.25f;
+                        float sampleSolidAngle = 1.0f / (static_cast<float>(SpecularSampleCount) * pdf + 1e-4f);
+                        float lod = 0.5f * std::log2(sampleSolidAngle / environmentTexelSolidAngle) + 1.0f;
+                        color += SampleCube(environment, L, lod) * NdotL;
+                        weight += NdotL;
+                    }
+                    level.At(face, x, y) = color / std::max(weight, 1e-4f);
+                }
+            });
+            AppendHalfTexels(level, outData.specular);
+        }
+
+        // Diffuse: irradiance is smooth enough for order-2 SH, projected from a low environment mip.
+        size_t shLevel = 0;
+        while (shLevel + 1 < environment.size() && environment[shLevel].size > IrradianceSize) ++shLevel;
+        std::array<glm::vec3, 9> sh = ProjectSh(environment[shLevel]);
+        CubeLevel irradiance(IrradianceSize);
+        for (uint32_t face = 0; face < 6; ++face) {
+            for (uint32_t y = 0; y < IrradianceSize; ++y) {
+                for (uint32_t x = 0; x < IrradianceSize; ++x) {
+                    glm::vec2 uv = TexelFaceCoords(x + 0.5f, y + 0.5f, IrradianceSize);
+                    irradiance.At(face, x, y) = EvaluateShIrradiance(sh, glm::normalize(FaceDirection(face, uv.x, uv.y)));
+                }
+            }
+        }
+        outData.irradianceSize = IrradianceSize;
+        outData.irradiance.clear();
+        outData.irradiance.reserve(irradiance.texels.size() * 4);
+        AppendHalfTexels(irradiance, outData.irradiance);
+
+        auto bakeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - bakeStart).count();
+        VKENG_INFO("IblBaker: Baked '{}' in {:.1f} ms.", hdrPath, bakeMs);
+        return true;
+    }
+
+    bool IblBaker::ReadCache(const std::filesystem::path& cachePath, uint64_t contentHash, EnvironmentLightingData& outData) {
+        std::ifstream file(cachePath, std::ios::binary);
+        if (!file.is_open()) return false;
+        CacheHeader header;
+        if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))) return false;
+        if (header.magic != CacheMagic || header.version != CacheVersion || header.contentHash != contentHash ||
+            header.irradianceSize != IrradianceSize || header.specularSize != SpecularSize ||
+            header.specularMipCount != SpecularMipCount || header.sampleCount != SpecularSampleCount) {
+            VKENG_INFO("IblBaker: Cache '{}' is stale; rebaking.", cachePath.string());
+            return false;
+        }
+        outData.irradianceSize = IrradianceSize;
+        outData.specularSize = SpecularSize;
+        outData.specularMipCount = SpecularMipCount;
+        outData.irradiance.resize(6ull * IrradianceSize * IrradianceSize * 4);
+        outData.specular.resize(SpecularTexelCount() * 4);
+        if (!file.read(reinterpret_cast<char*>(outData.irradiance.data()), outData.irradiance.size() * sizeof(uint16_t)) ||
+            !file.read(reinterpret_cast<char*>(outData.specular.data()), outData.specular.size() * sizeof(uint16_t))) {
+            VKENG_WARN("IblBaker: Cache '{}' is truncated; rebaking.", cachePath.string());
+            return false;
+        }
+        return true;
+    }
+
+    bool IblBaker::WriteCache(const std::filesystem::path& cachePath, uint64_t contentHash, const EnvironmentLightingData& data) {
+        CacheHeader header;
+        header.irradianceSize = data.irradianceSize;
+        header.specularSize = data.specularSize;
+        header.specularMipCount = data.specularMipCount;
+        header.sampleCount = SpecularSampleCount;
+        header.contentHash = contentHash;
+        std::string error;
+        bool written = WriteFileAtomically(cachePath, [&](std::ostream& file) {
+            return file.write(reinterpret_cast<const char*>(&header), sizeof(header)) &&
+                   file.write(reinterpret_cast<const char*>(data.irradiance.data()), data.irradiance.size() * sizeof(uint16_t)) &&
+                   file.write(reinterpret_cast<const char*>(data.specular.data()), data.specular.size() * sizeof(uint16_t));
+        }, &error);
+        if (!written) VKENG_WARN("IblBaker: Could not write cache '{}': {}", cachePath.string(), error);
+        return written;
+    }
+
+} // namespace VulkEng
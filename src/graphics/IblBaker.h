@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace VulkEng {
+
+    // Image-based lighting for an environment: a diffuse irradiance cube and a specular cube whose
+    // mips are prefiltered for increasing roughness (mip m is roughness m / (specularMipCount - 1)),
+    // for the split-sum approximation alongside BrdfLut.
+    //
+    // Texels are RGBA16F (VK_FORMAT_R16G16B16A16_SFLOAT), faces in Vulkan layer order
+    // (+X, -X, +Y, -Y, +Z, -Z). Both hold radiance; the irradiance cube is pre-divided by PI, so a
+    // uniform environment bakes to itself in both.
+    struct EnvironmentLightingData {
+        uint32_t irradianceSize = 0;
+        uint32_t specularSize = 0;     // Of mip 0
+        uint32_t specularMipCount = 0;
+        std::vector<uint16_t> irradiance; // 6 faces
+        std::vector<uint16_t> specular;   // Per mip, largest first: 6 faces each
+    };
+
+    // Bakes EnvironmentLightingData from an equirectangular HDR (Radiance .hdr, anything stb_image
+    // reads as float) on the JobSystem's workers, and keeps the result as a cooked file so later
+    // runs only read it back. Thread-safe; meant to run as a startup step off the main thread.
+    class IblBaker {
+    public:
+        static constexpr uint32_t IrradianceSize = 32;
+        static constexpr uint32_t SpecularSize = 128;
+        static constexpr uint32_t SpecularMipCount = 6;      // 128 down to 4 texels
+        static constexpr uint32_t SpecularSampleCount = 128; // GGX importance samples per texel
+
+        IblBaker() = delete;
+
+        // Loads the bake of `hdrPath` from `cacheDir` (keyed by the file's content hash and the bake
+        // parameters) or bakes it and writes it there. Returns false if the HDR can't be read.
+        static bool LoadOrBake(const std::string& hdrPath, const std::filesystem::path& cacheDir, EnvironmentLightingData& outData);
+
+    private:
+        static bool Bake(const std::vector<char>& hdrFile, const std::string& hdrPath, EnvironmentLightingData& outData);
+        static bool ReadCache(const std::filesystem::path& cachePath, uint64_t contentHash, EnvironmentLightingData& outData);
+        static bool WriteCache(const std::filesystem::path& cachePath, uint64_t contentHash, const EnvironmentLightingData& data);
+    };
+
+} // namespace VulkEng
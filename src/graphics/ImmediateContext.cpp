@@ -0,0 +1,141 @@
+#include "ImmediateContext.h"
+#include "VulkanUtils.h" // For VK_CHECK
+#include "core/Log.h"
+
+namespace VulkEng {
+
+    // --- Recording ---
+    ImmediateContext::Recording::Recording(ImmediateContext& owner)
+        : m_Lock(owner.m_Mutex), m_Owner(&owner)
+    {
+        if (!owner.m_HasOpen) owner.OpenBatch();
+        m_CommandBuffer = owner.m_Open.commandBuffer;
+        m_Batch = owner.m_Open.id;
+    }
+
+    ImmediateContext::Recording::~Recording() {
+        // Bounds the staging memory held by a batch nobody flushes (e.g., a long load before the first frame).
+        if (m_Owner->m_Open.stagingBytes >= MaxBatchStagingBytes) m_Owner->SubmitOpenBatch();
+    }
+
+    void ImmediateContext::Recording::KeepAlive(std::unique_ptr<VulkanBuffer> buffer) {
+        if (!buffer) return;
+        m_Owner->m_Open.stagingBytes += buffer->GetBufferSize();
+        m_Owner->m_Open.keepAlive.push_back(std::move(buffer));
+    }
+
+    void ImmediateContext::Recording::WaitFor(ImmediateContext& other, uint64_t batch, VkPipelineStageFlags stages) {
+        m_Owner->m_Open.dependencies.push_back({&other, batch, stages});
+    }
+
+    // --- ImmediateContext ---
+    ImmediateContext::ImmediateContext(VulkanContext& context, QueueType queue /*= QueueType::Graphics*/)
+        : m_Context(context), m_Queue(queue)
+    {
+        VkCommandPoolCreateInfo poolInfo{VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO};
+        poolInfo.queueFamilyIndex = m_Context.GetQueueFamily(m_Queue);
+        // Buffers are reset one by one as their batches retire, while later batches may still be in flight.
+        poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+        VK_CHECK(vkCreateCommandPool(m_Context.device, &poolInfo, nullptr, &m_CommandPool));
+    }
+
+    ImmediateContext::~ImmediateContext() {
+        if (m_CommandPool == VK_NULL_HANDLE) return;
+        WaitIdle();
+        m_InFlight.clear();
+        m_FreeCommandBuffers.clear();
+        vkDestroyCommandPool(m_Context.device, m_CommandPool, nullptr); // Frees its command buffers
+        m_CommandPool = VK_NULL_HANDLE;
+    }
+
+    ImmediateContext::Recording ImmediateContext::Record() {
+        return Recording(*this);
+    }
+
+    GpuTimelinePoint ImmediateContext::Flush() {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        if (m_HasOpen) SubmitOpenBatch();
+        RetireCompleted();
+        return m_LastSubmitted;
+    }
+
+    GpuTimelinePoint ImmediateContext::GetPoint(uint64_t batch) {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        if (m_HasOpen && m_Open.id == batch) SubmitOpenBatch();
+        RetireCompleted(); // The transfer context is only ever asked for points, never flushed
+        for (const Batch& inFlight : m_InFlight) {
+            if (inFlight.id == batch) return inFlight.point;
+        }
+        return {}; // Retired, so complete
+    }
+
+    void ImmediateContext::WaitIdle() {
+        m_Context.WaitFor(Flush());
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        RetireCompleted();
+    }
+
+    void ImmediateContext::OpenBatch() {
+        m_Open = Batch{};
+        m_Open.id = m_NextBatch++;
+        if (!m_FreeCommandBuffers.empty()) {
+            m_Open.commandBuffer = m_FreeCommandBuffers.back();
+            m_FreeCommandBuffers.pop_back();
+        } else {
+            VkCommandBufferAllocateInfo allocInfo{VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO};
+            allocInfo.commandPool = m_CommandPool;
+            allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+            allocInfo.commandBufferCount = 1;
+            VK_CHECK(vkAllocateCommandBuffers(m_Context.device, &allocInfo, &m_Open.commandBuffer));
+        }
+        VkCommandBufferBeginInfo beginInfo{VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        VK_CHECK(vkBeginCommandBuffer(m_Open.commandBuffer, &beginInfo));
+        m_HasOpen = true;
+    }
+
+    void ImmediateContext::SubmitOpenBatch() {
+        // Image uploads end in their own layout transitions; this makes plain buffer copies (vertex,
+        // index, parameter data) visible to whatever is submitted to the queue next.
+        VkMemoryBarrier barrier{VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+        vkCmdPipelineBarrier(m_Open.commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0,
+                             1, &barrier, 0, nullptr, 0, nullptr);
+        VK_CHECK(vkEndCommandBuffer(m_Open.commandBuffer));
+
+        // Staging buffers still mapped (persistently) hold unflushed writes on non-coherent memory.
+        for (const std::unique_ptr<VulkanBuffer>& buffer : m_Open.keepAlive) {
+            VK_CHECK(buffer->FlushWrites());
+        }
+
+        // Submits the other contexts' batches if they are still open. Their own batches never wait on
+        // this one, so taking their locks while holding ours can't deadlock.
+        std::vector<QueueWait> waits;
+        for (const Dependency& dependency : m_Open.dependencies) {
+            GpuTimelinePoint point = dependency.context->GetPoint(dependency.batch);
+            if (point.IsValid()) waits.push_back({point, dependency.stages}); // Invalid: already retired
+        }
+
+        QueueSubmitDesc submit;
+        submit.commandBuffers = &m_Open.commandBuffer;
+        submit.commandBufferCount = 1;
+        submit.waits = waits.data();
+        submit.waitCount = static_cast<uint32_t>(waits.size());
+        m_Open.point = m_Context.Submit(m_Queue, submit);
+        m_LastSubmitted = m_Open.point;
+        m_InFlight.push_back(std::move(m_Open));
+        m_Open = Batch{};
+        m_HasOpen = false;
+    }
+
+    void ImmediateContext::RetireCompleted() {
+        while (!m_InFlight.empty() && m_Context.IsComplete(m_InFlight.front().point)) {
+            Batch& batch = m_InFlight.front();
+            VK_CHECK(vkResetCommandBuffer(batch.commandBuffer, 0));
+            m_FreeCommandBuffers.push_back(batch.commandBuffer);
+            m_InFlight.pop_front(); // Releases the batch's staging buffers
+        }
+    }
+
+} // namespace VulkEng
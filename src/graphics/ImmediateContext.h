@@ -0,0 +1,111 @@
+#pragma once
+
+#include "Buffer.h"        // For VulkanBuffer (staging kept alive)
+#include "VulkanContext.h" // For GpuTimelinePoint, QueueType
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace VulkEng {
+
+    // Non-blocking replacement for blocking single-time submissions. One-off work (uploads, layout
+    // transitions, mip generation) is recorded into a shared command buffer, so consecutive requests
+    // batch into a single submission instead of one queue drain each. Flush() submits the batch and
+    // returns its timeline point; staging buffers handed to KeepAlive() are released once that point
+    // is reached. Work is only ordered before later submissions to the same queue: the renderer
+    // flushes before each frame submit, other queues wait on the returned point, and code that needs
+    // the result on the CPU waits explicitly.
+    class ImmediateContext {
+    public:
+        // Staging memory a batch may hold before it is submitted without waiting for a flush.
+        static constexpr VkDeviceSize MaxBatchStagingBytes = 64ull * 1024 * 1024;
+
+        // Exclusive access to the open batch's command buffer, for as long as the object lives.
+        // Don't call back into the ImmediateContext, or one the batch waits for, while holding one.
+        class Recording {
+        public:
+            Recording(const Recording&) = delete; // Returned by value through guaranteed copy elision
+            Recording& operator=(const Recording&) = delete;
+            ~Recording();
+
+            VkCommandBuffer GetCommandBuffer() const { return m_CommandBuffer; }
+            // Identifies the batch; pass to GetPoint() / Wait().
+            uint64_t GetBatch() const { return m_Batch; }
+            // Keeps `buffer` (e.g., the staging source of a copy) alive until the batch has executed.
+            void KeepAlive(std::unique_ptr<VulkanBuffer> buffer);
+            // Makes this batch's `stages` wait for `batch` of another context (on another queue), e.g.
+            // before acquiring ownership of what it uploaded. That batch is submitted along with this one
+            // at the latest, so uploads on both queues keep batching.
+            void WaitFor(ImmediateContext& other, uint64_t batch, VkPipelineStageFlags stages);
+
+        private:
+            friend class ImmediateContext;
+            explicit Recording(ImmediateContext& owner);
+
+            std::unique_lock<std::mutex> m_Lock;
+            ImmediateContext* m_Owner = nullptr;
+            VkCommandBuffer m_CommandBuffer = VK_NULL_HANDLE;
+            uint64_t m_Batch = 0;
+        };
+
+        ImmediateContext(VulkanContext& context, QueueType queue = QueueType::Graphics);
+        // Waits for all submitted work.
+        ~ImmediateContext();
+
+        ImmediateContext(const ImmediateContext&) = delete;
+        ImmediateContext& operator=(const ImmediateContext&) = delete;
+
+        // Opens a batch if none is open and locks it for recording. Thread-safe.
+        Recording Record();
+
+        // Submits the open batch (if any) and releases batches the GPU has finished. Returns the point
+        // of the most recently submitted batch. Cheap when nothing was recorded.
+        GpuTimelinePoint Flush();
+        // The point `batch` completes at, submitting it first if it is still open. Invalid (reads as
+        // complete) once the batch has been retired.
+        GpuTimelinePoint GetPoint(uint64_t batch);
+        bool IsComplete(uint64_t batch) { return m_Context.IsComplete(GetPoint(batch)); }
+        // Blocks until `batch` has executed, for callers that need synchronous behavior.
+        void Wait(uint64_t batch) { m_Context.WaitFor(GetPoint(batch)); }
+        // Submits and waits for everything recorded so far.
+        void WaitIdle();
+
+    private:
+        struct Dependency {
+            ImmediateContext* context = nullptr;
+            uint64_t batch = 0;
+            VkPipelineStageFlags stages = 0;
+        };
+
+        struct Batch {
+            uint64_t id = 0;
+            VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+            std::vector<std::unique_ptr<VulkanBuffer>> keepAlive;
+            VkDeviceSize stagingBytes = 0;
+            std::vector<Dependency> dependencies;
+            GpuTimelinePoint point; // Set on submit
+        };
+
+        // The following expect m_Mutex to be held.
+        void OpenBatch();
+        void SubmitOpenBatch();
+        void RetireCompleted();
+
+        VulkanContext& m_Context;
+        QueueType m_Queue;
+
+        std::mutex m_Mutex;
+        VkCommandPool m_CommandPool = VK_NULL_HANDLE;
+        std::vector<VkCommandBuffer> m_FreeCommandBuffers; // Reset and reused by later batches
+        Batch m_Open;
+        bool m_HasOpen = false;
+        std::deque<Batch> m_InFlight; // Submitted, oldest first
+        uint64_t m_NextBatch = 1;
+        GpuTimelinePoint m_LastSubmitted;
+    };
+
+} // namespace VulkEng
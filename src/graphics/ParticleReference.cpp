@@ -0,0 +1,119 @@
+#include "ParticleReference.h"
+
+#include <algorithm> // For std::sort
+#include <cstring>   // For std::memcpy
+
+namespace VulkEng {
+
+    namespace {
+        constexpr float CollisionThickness = 0.5f; // Same as COLLISION_THICKNESS in particle_simulate.comp
+
+        uint32_t FloatBits(float value) {
+            uint32_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            return bits;
+        }
+
+        glm::vec3 ReconstructPosition(const ParticleFrameUBO& frame, const glm::vec2& uv, float depth) {
+            glm::vec4 world = frame.invViewProj * glm::vec4(uv.x * 2.0f - 1.0f, uv.y * 2.0f - 1.0f, depth, 1.0f);
+            return glm::vec3(world) / world.w;
+        }
+    }
+
+    ParticleReferenceSimulator::ParticleReferenceSimulator(uint32_t capacity)
+        : m_Particles(capacity) {
+        // Same order as particle_args.comp (mode 0): slot 0 is popped first.
+        m_DeadIndices.resize(capacity);
+        for (uint32_t i = 0; i < capacity; ++i) {
+            m_DeadIndices[i] = capacity - 1 - i;
+        }
+    }
+
+    void ParticleReferenceSimulator::Step(const ParticleEmitParams& params, const ParticleFrameUBO& frame, const DepthSampler& depth) {
+        Emit(params);
+        Simulate(params, frame, depth);
+        if (params.flags & ParticleFlag_SortBackToFront) {
+            std::sort(m_DrawList.begin(), m_DrawList.end(),
+                      [](const glm::uvec2& a, const glm::uvec2& b) { return a.x > b.x; });
+        }
+    }
+
+    void ParticleReferenceSimulator::Emit(const ParticleEmitParams& params) {
+        for (uint32_t id = 0; id < params.emitCount && !m_DeadIndices.empty(); ++id) {
+            uint32_t index = m_DeadIndices.back();
+            m_DeadIndices.pop_back();
+
+            uint32_t state = params.randomSeed ^ (id * 2654435769u);
+            GpuParticle& particle = m_Particles[index];
+            particle.position = glm::vec3(params.positionRadius) + ParticleRandomInSphere(state) * params.positionRadius.w;
+            particle.velocity = glm::vec3(params.velocitySpread) + ParticleRandomInSphere(state) * params.velocitySpread.w;
+            float t = ParticleRandom(state);
+            particle.lifetime = params.lifeSize.x * (1.0f - t) + params.lifeSize.y * t; // GLSL mix()
+            particle.age = 0.0f;
+            m_DrawList.push_back(glm::uvec2(0u, index));
+        }
+    }
+
+    void ParticleReferenceSimulator::Simulate(const ParticleEmitParams& params, const ParticleFrameUBO& frame, const DepthSampler& depth) {
+        std::vector<glm::uvec2> current;
+        current.swap(m_DrawList);
+        m_DrawList.reserve(current.size());
+
+        const glm::vec3 gravity(params.gravityDrag);
+        const float damping = std::max(1.0f - params.gravityDrag.w * params.deltaTime, 0.0f);
+        const bool collide = (params.flags & ParticleFlag_CollideWithDepth) && frame.cameraPosition.w > 0.0f && depth;
+        const glm::vec3 cameraPosition(frame.cameraPosition);
+
+        for (const glm::uvec2& entry : current) {
+            uint32_t index = entry.y;
+            GpuParticle& particle = m_Particles[index];
+            particle.age += params.deltaTime;
+            if (particle.age >= particle.lifetime) {
+                m_DeadIndices.push_back(index);
+                continue;
+            }
+
+            particle.velocity += gravity * params.deltaTime;
+            particle.velocity *= damping;
+            particle.position += particle.velocity * params.deltaTime;
+            if (collide) {
+                CollideWithDepth(particle, params, frame, depth);
+            }
+
+            float distanceToCamera = std::max(glm::length(particle.position - cameraPosition), 1e-6f);
+            m_DrawList.push_back(glm::uvec2(FloatBits(distanceToCamera), index));
+        }
+    }
+
+    void ParticleReferenceSimulator::CollideWithDepth(GpuParticle& particle, const ParticleEmitParams& params,
+                                                      const ParticleFrameUBO& frame, const DepthSampler& depth) const {
+        glm::vec4 clip = frame.viewProj * glm::vec4(particle.position, 1.0f);
+        if (clip.w <= 0.0f) return;
+        glm::vec3 ndc = glm::vec3(clip) / clip.w;
+        glm::vec2 uv(ndc.x * 0.5f + 0.5f, ndc.y * 0.5f + 0.5f);
+        if (uv.x < 0.0f || uv.y < 0.0f || uv.x > 1.0f || uv.y > 1.0f) return;
+
+        float sceneDepth = depth(uv);
+        bool reversedZ = frame.depthParams.x < 0.5f;
+        if (sceneDepth == frame.depthParams.x) return;
+        if (reversedZ ? ndc.z >= sceneDepth : ndc.z <= sceneDepth) return;
+
+        glm::vec3 surface = ReconstructPosition(frame, uv, sceneDepth);
+        if (glm::length(surface - particle.position) > CollisionThickness) return;
+
+        glm::vec2 uvRight = uv + glm::vec2(frame.depthSize.z, 0.0f);
+        glm::vec2 uvDown = uv + glm::vec2(0.0f, frame.depthSize.w);
+        glm::vec3 right = ReconstructPosition(frame, uvRight, depth(uvRight));
+        glm::vec3 down = ReconstructPosition(frame, uvDown, depth(uvDown));
+        glm::vec3 normal = glm::cross(right - surface, down - surface);
+        glm::vec3 toCamera = glm::vec3(frame.cameraPosition) - surface;
+        normal = glm::dot(normal, normal) > 1e-12f ? glm::normalize(normal) : glm::normalize(toCamera);
+        if (glm::dot(normal, toCamera) < 0.0f) normal = -normal;
+
+        if (glm::dot(particle.velocity, normal) < 0.0f) {
+            particle.velocity = glm::reflect(particle.velocity, normal) * params.restitution;
+        }
+        particle.position = surface + normal * 0.01f;
+    }
+
+} // namespace VulkEng
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "ParticleTypes.h"
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace VulkEng {
+
+    // CPU implementation of the GPU particle passes (emit, simulate + compaction, sort), using the
+    // same data layouts, random numbers and math as the compute shaders. It exists to test the GPU
+    // path against: for the same inputs the alive set and the draw order match (slot assignment
+    // differs, since GPU threads claim dead slots in arbitrary order).
+    class ParticleReferenceSimulator {
+    public:
+        // Returns the depth buffer value at `uv` (0..1, Vulkan depth range) of the frame in `ParticleFrameUBO`.
+        using DepthSampler = std::function<float(const glm::vec2& uv)>;
+
+        explicit ParticleReferenceSimulator(uint32_t capacity);
+
+        // One frame: emits params.emitCount particles, then advances every alive particle by
+        // params.deltaTime. Depth collisions need both the flag in `params` and a sampler.
+        void Step(const ParticleEmitParams& params, const ParticleFrameUBO& frame, const DepthSampler& depth = {});
+
+        uint32_t GetCapacity() const { return static_cast<uint32_t>(m_Particles.size()); }
+        uint32_t GetAliveCount() const { return static_cast<uint32_t>(m_DrawList.size()); }
+        const std::vector<GpuParticle>& GetParticles() const { return m_Particles; }
+        // Alive entries (sort key, particle index) in draw order; back to front if the emitter sorts.
+        const std::vector<glm::uvec2>& GetDrawList() const { return m_DrawList; }
+
+    private:
+        void Emit(const ParticleEmitParams& params);
+        void Simulate(const ParticleEmitParams& params, const ParticleFrameUBO& frame, const DepthSampler& depth);
+        void CollideWithDepth(GpuParticle& particle, const ParticleEmitParams& params,
+                              const ParticleFrameUBO& frame, const DepthSampler& depth) const;
+
+        std::vector<GpuParticle> m_Particles;
+        std::vector<uint32_t> m_DeadIndices; // Stack of free slots
+        std::vector<glm::uvec2> m_DrawList;  // Alive list of the last step (current list of the next)
+    };
+
+} // namespace VulkEng
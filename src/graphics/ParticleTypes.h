@@ -0,0 +1,74 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <algorithm> // For std::max
+#include <cmath>
+#include <cstdint>
+
+namespace VulkEng {
+
+    // Data layouts shared by the particle compute shaders (assets/shaders/particle_*.comp),
+    // GpuParticleSystem and ParticleReferenceSimulator. Keep them in sync with the GLSL declarations.
+
+    // One particle in the persistent pool (std430, 32 bytes).
+    struct GpuParticle {
+        glm::vec3 position = glm::vec3(0.0f);
+        float age = 0.0f;
+        glm::vec3 velocity = glm::vec3(0.0f);
+        float lifetime = 0.0f;
+    };
+
+    enum ParticleEmitterFlags : uint32_t {
+        ParticleFlag_CollideWithDepth = 1u << 0,
+        ParticleFlag_SortBackToFront = 1u << 1,
+    };
+
+    // Per-emitter parameters, pushed as constants to every particle dispatch and the draw (128 bytes).
+    struct ParticleEmitParams {
+        glm::vec4 positionRadius = glm::vec4(0.0f); // World-space emitter position, spawn sphere radius
+        glm::vec4 velocitySpread = glm::vec4(0.0f); // Initial velocity, random spread added in a sphere
+        glm::vec4 gravityDrag = glm::vec4(0.0f, -9.81f, 0.0f, 0.0f); // Acceleration, linear drag per second
+        glm::vec4 lifeSize = glm::vec4(1.0f, 2.0f, 0.1f, 0.1f);       // Lifetime min/max, size at birth/death
+        glm::vec4 colorStart = glm::vec4(1.0f);
+        glm::vec4 colorEnd = glm::vec4(1.0f, 1.0f, 1.0f, 0.0f);
+        uint32_t emitCount = 0;   // Particles to spawn this step
+        uint32_t randomSeed = 0;  // Changes every step
+        uint32_t flags = 0;       // ParticleEmitterFlags
+        float restitution = 0.4f; // Velocity kept when bouncing off the depth buffer
+        float deltaTime = 0.0f;
+        uint32_t capacity = 0;
+        uint32_t padding[2] = {0, 0};
+    };
+    static_assert(sizeof(ParticleEmitParams) == 128, "ParticleEmitParams must fit the guaranteed push constant size");
+
+    // Camera data of the previous frame, whose depth buffer the simulation collides against.
+    struct ParticleFrameUBO {
+        glm::mat4 viewProj = glm::mat4(1.0f);
+        glm::mat4 invViewProj = glm::mat4(1.0f);
+        glm::vec4 cameraPosition = glm::vec4(0.0f); // w = 1 if the depth buffer holds a rendered frame
+        glm::vec4 depthSize = glm::vec4(0.0f);      // Width, height, 1/width, 1/height
+        glm::vec4 depthParams = glm::vec4(1.0f, 0.0f, 0.0f, 0.0f); // x = clear depth (0 with reversed-Z)
+    };
+
+    // Same hash as the shaders (PCG), so the CPU reference draws the same random numbers per particle.
+    inline uint32_t ParticleHash(uint32_t value) {
+        uint32_t state = value * 747796405u + 2891336453u;
+        uint32_t word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+        return (word >> 22u) ^ word;
+    }
+
+    inline float ParticleRandom(uint32_t& state) {
+        state = ParticleHash(state);
+        return static_cast<float>(state) * (1.0f / 4294967296.0f);
+    }
+
+    // Uniformly distributed point in the unit sphere (RandomInSphere in the shaders).
+    inline glm::vec3 ParticleRandomInSphere(uint32_t& state) {
+        float z = ParticleRandom(state) * 2.0f - 1.0f;
+        float phi = ParticleRandom(state) * 6.2831853f;
+        float radius = std::cbrt(ParticleRandom(state));
+        float ring = std::sqrt(std::max(0.0f, 1.0f - z * z));
+        return glm::vec3(ring * std::cos(phi), ring * std::sin(phi), z) * radius;
+    }
+
+} // namespace VulkEng
@@ -0,0 +1,619 @@
+#include "PostProcessStack.h"
+#include "Renderer.h"      // For MAX_FRAMES_IN_FLIGHT
+#include "ShaderLibrary.h"
+#include "VulkanContext.h"
+#include "VulkanUtils.h"   // For VK_CHECK, createImage, createImageView
+#include "core/Log.h"
+#include "core/ServiceLocator.h" // For the JobSystem (parallel pipeline creation)
+
+#include <glm/glm.hpp>
+
+#include <algorithm> // For std::find, std::max
+#include <cmath>
+#include <exception> // For std::exception_ptr
+#include <stdexcept>
+#include <string>
+#include <tuple>
+
+namespace VulkEng {
+
+    namespace {
+        constexpr uint32_t StageCount = static_cast<uint32_t>(PostProcessStage::Count);
+        constexpr uint32_t ResolveTileSize = 16; // TILE_SIZE in postprocess_resolve.comp; also the histogram's group size
+        constexpr uint32_t BloomGroupSize = 8;   // postprocess_bloom_*.comp
+
+        // Luminance range the exposure histogram covers, in log2 units (about 1e-3 to 4e3).
+        constexpr float MinLogLuminance = -10.0f;
+        constexpr float LogLuminanceRange = 22.0f;
+
+        // Must match EXPOSURE_STATE_BLOCK in postprocess_common.glsl.
+        struct ExposureState {
+            float adaptedLuminance;
+            float exposure;
+            uint32_t pad0, pad1;
+            uint32_t histogram[256];
+        };
+
+        // Must match the push constant blocks of the postprocess_*.comp shaders.
+        struct HistogramPushConstants {
+            float minLogLuminance;
+            float inverseLogLuminanceRange;
+        };
+        struct ExposurePushConstants {
+            float minLogLuminance;
+            float logLuminanceRange;
+            float adaptation;
+            float compensation;
+            uint32_t pixelCount;
+        };
+        struct DownsamplePushConstants {
+            glm::vec2 sourceTexelSize;
+            float threshold;
+            float knee;
+            uint32_t prefilter;
+        };
+        struct UpsamplePushConstants {
+            glm::vec2 sourceTexelSize;
+            float radius;
+        };
+        struct ResolvePushConstants {
+            float manualExposure;
+            float bloomIntensity;
+            uint32_t flags;
+        };
+
+        // Must match the Flag constants in postprocess_resolve.comp.
+        enum PostProcessFlags : uint32_t {
+            PostProcessFlag_AutoExposure = 1u << 0,
+            PostProcessFlag_Bloom = 1u << 1,
+            PostProcessFlag_Tonemap = 1u << 2,
+            PostProcessFlag_Fxaa = 1u << 3,
+        };
+
+        uint32_t GroupCount(uint32_t size, uint32_t groupSize) {
+            return (size + groupSize - 1) / groupSize;
+        }
+
+        bool IsSrgbFormat(VkFormat format) {
+            switch (format) {
+                case VK_FORMAT_B8G8R8A8_SRGB:
+                case VK_FORMAT_R8G8B8A8_SRGB:
+                case VK_FORMAT_A8B8G8R8_SRGB_PACK32:
+                    return true;
+                default:
+                    return false;
+            }
+        }
+
+        VkWriteDescriptorSet ImageWrite(uint32_t binding, VkDescriptorType type, const VkDescriptorImageInfo* info) {
+            VkWriteDescriptorSet write{VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
+            write.dstBinding = binding; write.descriptorType = type;
+            write.descriptorCount = 1; write.pImageInfo = info;
+            return write;
+        }
+
+        VkWriteDescriptorSet BufferWrite(uint32_t binding, const VkDescriptorBufferInfo* info) {
+            VkWriteDescriptorSet write{VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
+            write.dstBinding = binding; write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            write.descriptorCount = 1; write.pBufferInfo = info;
+            return write;
+        }
+
+        // Makes compute writes visible to the following dispatches.
+        void ComputeBarrier(VkCommandBuffer commandBuffer) {
+            VkMemoryBarrier barrier{VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+            barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+            barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+            vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                 0, 1, &barrier, 0, nullptr, 0, nullptr);
+        }
+    }
+
+    const char* PostProcessStats::StageName(PostProcessStage stage) {
+        switch (stage) {
+            case PostProcessStage::AutoExposure: return "Auto exposure";
+            case PostProcessStage::Bloom:        return "Bloom";
+            case PostProcessStage::Resolve:      return "Tonemap + FXAA (fused)";
+            default:                             return "Unknown";
+        }
+    }
+
+    PostProcessStack::PostProcessStack(VulkanContext& context, ShaderLibrary& shaderLibrary)
+        : m_Context(context), m_ShaderLibrary(shaderLibrary) {
+        VkDevice device = m_Context.device;
+
+        // Compiled in parallel; jobs only log exceptions, so they are rethrown here.
+        const std::array<std::tuple<const char*, uint32_t, ComputePass*>, 5> passes = {{
+            {"postprocess_histogram.comp", static_cast<uint32_t>(sizeof(HistogramPushConstants)), &m_HistogramPass},
+            {"postprocess_exposure.comp", static_cast<uint32_t>(sizeof(ExposurePushConstants)), &m_ExposurePass},
+            {"postprocess_bloom_downsample.comp", static_cast<uint32_t>(sizeof(DownsamplePushConstants)), &m_DownsamplePass},
+            {"postprocess_bloom_upsample.comp", static_cast<uint32_t>(sizeof(UpsamplePushConstants)), &m_UpsamplePass},
+            {"postprocess_resolve.comp", static_cast<uint32_t>(sizeof(ResolvePushConstants)), &m_ResolvePass},
+        }};
+        std::array<std::exception_ptr, 5> errors{};
+        ServiceLocator::GetJobSystem().ParallelFor(static_cast<uint32_t>(passes.size()), 1, [&](uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end; ++i) {
+                try { CreateComputePass(std::get<0>(passes[i]), std::get<1>(passes[i]), *std::get<2>(passes[i])); }
+                catch (...) { errors[i] = std::current_exception(); }
+            }
+        });
+        for (const std::exception_ptr& error : errors) {
+            if (error) std::rethrow_exception(error);
+        }
+
+        auto presentShader = m_ShaderLibrary.Load("present.frag");
+        m_PresentSetLayout = m_ShaderLibrary.CreateDescriptorSetLayout({presentShader.get()}, 0);
+        VkPipelineLayoutCreateInfo presentLayoutInfo{VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO};
+        presentLayoutInfo.setLayoutCount = 1;
+        presentLayoutInfo.pSetLayouts = &m_PresentSetLayout;
+        VK_CHECK(vkCreatePipelineLayout(device, &presentLayoutInfo, nullptr, &m_PresentLayout));
+
+        VkSamplerCreateInfo samplerInfo{VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO};
+        samplerInfo.magFilter = VK_FILTER_LINEAR; // The bloom filters rely on bilinear taps
+        samplerInfo.minFilter = VK_FILTER_LINEAR;
+        samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+        samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerInfo.maxLod = 0.0f; // Every view is a single mip
+        VK_CHECK(vkCreateSampler(device, &samplerInfo, nullptr, &m_LinearSampler));
+
+        m_ExposureState = std::make_unique<VulkanBuffer>(
+            m_Context, sizeof(ExposureState), 1,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, // Cleared by Record on first use
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+        // Sets are rewritten with the targets; the pool is reset rather than freeing them one by one.
+        std::array<VkDescriptorPoolSize, 3> poolSizes = {{
+            {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 2 * MaxBloomMips + 4}, // Histogram, bloom, resolve (2), present (2)
+            {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 2 * MaxBloomMips + 1},
+            {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 3},
+        }};
+        VkDescriptorPoolCreateInfo poolInfo{VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO};
+        poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+        poolInfo.pPoolSizes = poolSizes.data();
+        poolInfo.maxSets = 2 * MaxBloomMips + 4;
+        VK_CHECK(vkCreateDescriptorPool(device, &poolInfo, nullptr, &m_DescriptorPool));
+
+        // GPU timings need timestamps on the graphics queue.
+        uint32_t familyCount = 0;
+        vkGetPhysicalDeviceQueueFamilyProperties(m_Context.physicalDevice, &familyCount, nullptr);
+        std::vector<VkQueueFamilyProperties> families(familyCount);
+        vkGetPhysicalDeviceQueueFamilyProperties(m_Context.physicalDevice, &familyCount, families.data());
+        uint32_t validBits = m_Context.graphicsQueueFamily < familyCount ? families[m_Context.graphicsQueueFamily].timestampValidBits : 0;
+        m_TimestampPeriodNs = m_Context.physicalDeviceProperties.limits.timestampPeriod;
+        m_StagesWritten.assign(MAX_FRAMES_IN_FLIGHT, 0);
+        if (validBits > 0 && m_TimestampPeriodNs > 0.0) {
+            m_TimestampMask = validBits >= 64 ? ~0ull : (1ull << validBits) - 1;
+            m_QueryPools.resize(MAX_FRAMES_IN_FLIGHT);
+            VkQueryPoolCreateInfo queryInfo{VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO};
+            queryInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+            queryInfo.queryCount = StageCount * 2;
+            for (VkQueryPool& pool : m_QueryPools) VK_CHECK(vkCreateQueryPool(device, &queryInfo, nullptr, &pool));
+            m_Stats.timestampsSupported = true;
+        } else {
+            VKENG_WARN("PostProcessStack: The graphics queue has no timestamps; GPU timings are unavailable.");
+        }
+        VKENG_INFO("PostProcessStack: Initialized.");
+    }
+
+    PostProcessStack::~PostProcessStack() {
+        VkDevice device = m_Context.device;
+        DestroySwapchainDependents();
+        DestroyComputePass(m_HistogramPass);
+        DestroyComputePass(m_ExposurePass);
+        DestroyComputePass(m_DownsamplePass);
+        DestroyComputePass(m_UpsamplePass);
+        DestroyComputePass(m_ResolvePass);
+        vkDestroyPipelineLayout(device, m_PresentLayout, nullptr);
+        vkDestroyDescriptorSetLayout(device, m_PresentSetLayout, nullptr);
+        vkDestroyDescriptorPool(device, m_DescriptorPool, nullptr);
+        vkDestroySampler(device, m_LinearSampler, nullptr);
+        for (VkQueryPool pool : m_QueryPools) vkDestroyQueryPool(device, pool, nullptr);
+        m_ExposureState.reset();
+    }
+
+    void PostProcessStack::CreateComputePass(const char* shaderName, uint32_t pushConstantSize, ComputePass& outPass) {
+        VkDevice device = m_Context.device;
+        outPass.shaderName = shaderName;
+        outPass.pushConstantSize = pushConstantSize;
+        auto shader = m_ShaderLibrary.Load(shaderName);
+        outPass.setLayout = m_ShaderLibrary.CreateDescriptorSetLayout({shader.get()}, 0);
+
+        VkPushConstantRange pushRange{VK_SHADER_STAGE_COMPUTE_BIT, 0, pushConstantSize};
+        VkPipelineLayoutCreateInfo layoutInfo{VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO};
+        layoutInfo.setLayoutCount = 1;
+        layoutInfo.pSetLayouts = &outPass.setLayout;
+        layoutInfo.pushConstantRangeCount = 1;
+        layoutInfo.pPushConstantRanges = &pushRange;
+        VK_CHECK(vkCreatePipelineLayout(device, &layoutInfo, nullptr, &outPass.layout));
+        outPass.pipeline = BuildComputePipeline(outPass);
+    }
+
+    VkPipeline PostProcessStack::BuildComputePipeline(const ComputePass& pass) const {
+        VkDevice device = m_Context.device;
+        auto shader = m_ShaderLibrary.Load(pass.shaderName);
+        // A shader reading past the push constants pushed here would be invalid usage.
+        if (shader->reflection.pushConstantSize > pass.pushConstantSize) {
+            throw std::runtime_error(std::string("PostProcessStack: ") + pass.shaderName + " declares more push constants than are pushed.");
+        }
+
+        VkComputePipelineCreateInfo pipelineInfo{VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO};
+        pipelineInfo.stage = {VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO};
+        pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+        pipelineInfo.stage.module = m_ShaderLibrary.CreateModule(*shader);
+        pipelineInfo.stage.pName = "main";
+        pipelineInfo.layout = pass.layout;
+        VkPipeline pipeline = VK_NULL_HANDLE;
+        VkResult result = vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline);
+        vkDestroyShaderModule(device, pipelineInfo.stage.module, nullptr);
+        VK_CHECK(result);
+        return pipeline;
+    }
+
+    void PostProcessStack::DestroyComputePass(ComputePass& pass) {
+        VkDevice device = m_Context.device;
+        if (pass.pipeline != VK_NULL_HANDLE) vkDestroyPipeline(device, pass.pipeline, nullptr);
+        if (pass.layout != VK_NULL_HANDLE) vkDestroyPipelineLayout(device, pass.layout, nullptr);
+        if (pass.setLayout != VK_NULL_HANDLE) vkDestroyDescriptorSetLayout(device, pass.setLayout, nullptr);
+        pass = ComputePass{};
+    }
+
+    void PostProcessStack::DestroyImage(Image& image) {
+        VkDevice device = m_Context.device;
+        if (image.view != VK_NULL_HANDLE) vkDestroyImageView(device, image.view, nullptr);
+        if (image.image != VK_NULL_HANDLE) vkDestroyImage(device, image.image, nullptr);
+        if (image.memory != VK_NULL_HANDLE) vkFreeMemory(device, image.memory, nullptr);
+        image = Image{};
+    }
+
+    VkDescriptorSet PostProcessStack::AllocateSet(VkDescriptorSetLayout layout) {
+        VkDescriptorSetAllocateInfo allocInfo{VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO};
+        allocInfo.descriptorPool = m_DescriptorPool;
+        allocInfo.descriptorSetCount = 1;
+        allocInfo.pSetLayouts = &layout;
+        VkDescriptorSet set = VK_NULL_HANDLE;
+        VK_CHECK(vkAllocateDescriptorSets(m_Context.device, &allocInfo, &set));
+        return set;
+    }
+
+    void PostProcessStack::WriteSet(VkDescriptorSet set, std::initializer_list<VkWriteDescriptorSet> writes) {
+        std::vector<VkWriteDescriptorSet> setWrites(writes);
+        for (VkWriteDescriptorSet& write : setWrites) write.dstSet = set;
+        vkUpdateDescriptorSets(m_Context.device, static_cast<uint32_t>(setWrites.size()), setWrites.data(), 0, nullptr);
+    }
+
+    void PostProcessStack::CreateTargets(VkExtent2D extent) {
+        VKENG_INFO("PostProcessStack: Creating targets ({}x{})...", extent.width, extent.height);
+        VkDevice device = m_Context.device;
+        VkPhysicalDevice physicalDevice = m_Context.physicalDevice;
+        m_Extent = extent;
+
+        Utils::createImage(device, physicalDevice, extent.width, extent.height, 1, VK_SAMPLE_COUNT_1_BIT,
+                           HdrFormat, VK_IMAGE_TILING_OPTIMAL,
+                           VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+                           VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_Hdr.image, m_Hdr.memory);
+        m_Hdr.view = Utils::createImageView(device, m_Hdr.image, HdrFormat, VK_IMAGE_ASPECT_COLOR_BIT, 1);
+
+        // Bloom chain from half resolution down, stopping before levels get thinner than 2 texels.
+        uint32_t bloomWidth = std::max(extent.width / 2, 1u);
+        uint32_t bloomHeight = std::max(extent.height / 2, 1u);
+        m_BloomMipCount = 1;
+        while (m_BloomMipCount < MaxBloomMips && (bloomWidth >> m_BloomMipCount) >= 2 && (bloomHeight >> m_BloomMipCount) >= 2) {
+            ++m_BloomMipCount;
+        }
+        Utils::createImage(device, physicalDevice, bloomWidth, bloomHeight, m_BloomMipCount, VK_SAMPLE_COUNT_1_BIT,
+                           HdrFormat, VK_IMAGE_TILING_OPTIMAL,
+                           VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+                           VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_Bloom.image, m_Bloom.memory);
+        for (uint32_t mip = 0; mip < m_BloomMipCount; ++mip) {
+            m_BloomMipViews.push_back(Utils::createImageView(device, m_Bloom.image, HdrFormat, VK_IMAGE_ASPECT_COLOR_BIT, 1,
+                                                             VK_IMAGE_VIEW_TYPE_2D, 1, mip));
+        }
+
+        Utils::createImage(device, physicalDevice, extent.width, extent.height, 1, VK_SAMPLE_COUNT_1_BIT,
+                           HdrFormat, VK_IMAGE_TILING_OPTIMAL,
+                           VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+                           VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_Output.image, m_Output.memory);
+        m_Output.view = Utils::createImageView(device, m_Output.image, HdrFormat, VK_IMAGE_ASPECT_COLOR_BIT, 1);
+
+        Utils::createImage(device, physicalDevice, extent.width, extent.height, 1, VK_SAMPLE_COUNT_1_BIT,
+                           UiLayerFormat, VK_IMAGE_TILING_OPTIMAL,
+                           VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+                           VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_UiLayer.image, m_UiLayer.memory);
+        m_UiLayer.view = Utils::createImageView(device, m_UiLayer.image, UiLayerFormat, VK_IMAGE_ASPECT_COLOR_BIT, 1);
+
+        // The bloom chain and the output stay in GENERAL, where storage writes and sampling are both allowed.
+        VkDescriptorImageInfo hdrInfo{m_LinearSampler, m_Hdr.view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
+        VkDescriptorImageInfo outputInfo{m_LinearSampler, m_Output.view, VK_IMAGE_LAYOUT_GENERAL};
+        VkDescriptorImageInfo uiLayerInfo{m_LinearSampler, m_UiLayer.view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
+        std::vector<VkDescriptorImageInfo> bloomInfos;
+        for (VkImageView view : m_BloomMipViews) bloomInfos.push_back({m_LinearSampler, view, VK_IMAGE_LAYOUT_GENERAL});
+        VkDescriptorBufferInfo exposureInfo = m_ExposureState->GetDescriptorInfo();
+        const VkDescriptorType sampled = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        const VkDescriptorType storage = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+
+        m_HistogramSet = AllocateSet(m_HistogramPass.setLayout);
+        WriteSet(m_HistogramSet, {ImageWrite(0, sampled, &hdrInfo), BufferWrite(1, &exposureInfo)});
+        m_ExposureSet = AllocateSet(m_ExposurePass.setLayout);
+        WriteSet(m_ExposureSet, {BufferWrite(0, &exposureInfo)});
+        for (uint32_t mip = 0; mip < m_BloomMipCount; ++mip) {
+            m_DownsampleSets.push_back(AllocateSet(m_DownsamplePass.setLayout));
+            WriteSet(m_DownsampleSets.back(), {ImageWrite(0, sampled, mip == 0 ? &hdrInfo : &bloomInfos[mip - 1]),
+                                               ImageWrite(1, storage, &bloomInfos[mip])});
+        }
+        for (uint32_t mip = 0; mip + 1 < m_BloomMipCount; ++mip) {
+            m_UpsampleSets.push_back(AllocateSet(m_UpsamplePass.setLayout));
+            WriteSet(m_UpsampleSets.back(), {ImageWrite(0, sampled, &bloomInfos[mip + 1]), ImageWrite(1, storage, &bloomInfos[mip])});
+        }
+        m_ResolveSet = AllocateSet(m_ResolvePass.setLayout);
+        WriteSet(m_ResolveSet, {ImageWrite(0, sampled, &hdrInfo), ImageWrite(1, sampled, &bloomInfos[0]),
+                                BufferWrite(2, &exposureInfo), ImageWrite(3, storage, &outputInfo)});
+        m_PresentSet = AllocateSet(m_PresentSetLayout);
+        WriteSet(m_PresentSet, {ImageWrite(0, sampled, &outputInfo), ImageWrite(1, sampled, &uiLayerInfo)});
+    }
+
+    void PostProcessStack::CreatePresentPipeline(VkRenderPass presentPass, VkFormat presentFormat) {
+        m_PresentPass = presentPass;
+        m_PresentFormat = presentFormat;
+        m_PresentPipeline = BuildPresentPipeline();
+    }
+
+    VkPipeline PostProcessStack::BuildPresentPipeline() const {
+        VkDevice device = m_Context.device;
+        auto vertexShader = m_ShaderLibrary.Load("fullscreen.vert");
+        auto fragmentShader = m_ShaderLibrary.Load("present.frag");
+
+        VkBool32 encodeSrgb = IsSrgbFormat(m_PresentFormat) ? VK_FALSE : VK_TRUE;
+        VkSpecializationMapEntry encodeEntry{0, 0, sizeof(VkBool32)};
+        VkSpecializationInfo specialization{1, &encodeEntry, sizeof(VkBool32), &encodeSrgb};
+
+        std::array<VkPipelineShaderStageCreateInfo, 2> stages = {};
+        stages[0] = {VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO};
+        stages[0].stage = VK_SHADER_STAGE_VERTEX_BIT; stages[0].module = m_ShaderLibrary.CreateModule(*vertexShader); stages[0].pName = "main";
+        stages[1] = {VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO};
+        stages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT; stages[1].pName = "main"; stages[1].pSpecializationInfo = &specialization;
+        try {
+            stages[1].module = m_ShaderLibrary.CreateModule(*fragmentShader);
+        } catch (...) {
+            vkDestroyShaderModule(device, stages[0].module, nullptr);
+            throw;
+        }
+
+        // A single triangle generated from gl_VertexIndex; no vertex buffers, depth or blending.
+        VkPipelineVertexInputStateCreateInfo vertexInputInfo{VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO};
+        VkPipelineInputAssemblyStateCreateInfo inputAssembly{VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO};
+        inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+        VkPipelineViewportStateCreateInfo viewportState{VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO};
+        viewportState.viewportCount = 1; viewportState.scissorCount = 1; // Dynamic states
+        VkPipelineRasterizationStateCreateInfo rasterizer{VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO};
+        rasterizer.polygonMode = VK_POLYGON_MODE_FILL; rasterizer.lineWidth = 1.0f;
+        rasterizer.cullMode = VK_CULL_MODE_NONE;
+        VkPipelineMultisampleStateCreateInfo multisampling{VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO};
+        multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+        VkPipelineColorBlendAttachmentState colorBlendAttachment{};
+        colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+        VkPipelineColorBlendStateCreateInfo colorBlending{VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO};
+        colorBlending.attachmentCount = 1; colorBlending.pAttachments = &colorBlendAttachment;
+        std::array<VkDynamicState, 2> dynamicStates = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+        VkPipelineDynamicStateCreateInfo dynamicStateInfo{VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO};
+        dynamicStateInfo.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size()); dynamicStateInfo.pDynamicStates = dynamicStates.data();
+
+        VkGraphicsPipelineCreateInfo pipelineInfo{VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO};
+        pipelineInfo.stageCount = static_cast<uint32_t>(stages.size()); pipelineInfo.pStages = stages.data();
+        pipelineInfo.pVertexInputState = &vertexInputInfo; pipelineInfo.pInputAssemblyState = &inputAssembly;
+        pipelineInfo.pViewportState = &viewportState; pipelineInfo.pRasterizationState = &rasterizer;
+        pipelineInfo.pMultisampleState = &multisampling; pipelineInfo.pColorBlendState = &colorBlending;
+        pipelineInfo.pDynamicState = &dynamicStateInfo;
+        pipelineInfo.layout = m_PresentLayout;
+        pipelineInfo.renderPass = m_PresentPass; pipelineInfo.subpass = 0;
+        VkPipeline pipeline = VK_NULL_HANDLE;
+        VkResult result = vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline);
+        vkDestroyShaderModule(device, stages[0].module, nullptr);
+        vkDestroyShaderModule(device, stages[1].module, nullptr);
+        VK_CHECK(result);
+        return pipeline;
+    }
+
+    std::vector<PipelineReplacement> PostProcessStack::BuildReloadedPipelines(const std::vector<std::string>& changedShaders) {
+        auto isChanged = [&](const char* name) { return std::find(changedShaders.begin(), changedShaders.end(), name) != changedShaders.end(); };
+        std::vector<PipelineReplacement> replacements;
+        for (ComputePass* pass : {&m_HistogramPass, &m_ExposurePass, &m_DownsamplePass, &m_UpsamplePass, &m_ResolvePass}) {
+            if (!isChanged(pass->shaderName)) continue;
+            try {
+                replacements.push_back({&pass->pipeline, BuildComputePipeline(*pass), pass->shaderName});
+            } catch (const std::exception& e) {
+                VKENG_ERROR("PostProcessStack: Hot reload of {} failed, keeping the old pipeline: {}", pass->shaderName, e.what());
+            }
+        }
+        if (m_PresentPass != VK_NULL_HANDLE && (isChanged("fullscreen.vert") || isChanged("present.frag"))) {
+            try {
+                replacements.push_back({&m_PresentPipeline, BuildPresentPipeline(), "fullscreen.vert + present.frag"});
+            } catch (const std::exception& e) {
+                VKENG_ERROR("PostProcessStack: Hot reload of fullscreen.vert + present.frag failed, keeping the old pipeline: {}", e.what());
+            }
+        }
+        return replacements;
+    }
+
+    void PostProcessStack::DestroySwapchainDependents() {
+        VkDevice device = m_Context.device;
+        if (m_PresentPipeline != VK_NULL_HANDLE) vkDestroyPipeline(device, m_PresentPipeline, nullptr);
+        m_PresentPipeline = VK_NULL_HANDLE;
+        m_PresentPass = VK_NULL_HANDLE;
+
+        if (m_DescriptorPool != VK_NULL_HANDLE) vkResetDescriptorPool(device, m_DescriptorPool, 0);
+        m_HistogramSet = m_ExposureSet = m_ResolveSet = m_PresentSet = VK_NULL_HANDLE;
+        m_DownsampleSets.clear();
+        m_UpsampleSets.clear();
+
+        for (VkImageView view : m_BloomMipViews) vkDestroyImageView(device, view, nullptr);
+        m_BloomMipViews.clear();
+        m_BloomMipCount = 0;
+        DestroyImage(m_Hdr);
+        DestroyImage(m_Bloom);
+        DestroyImage(m_Output);
+        DestroyImage(m_UiLayer);
+        m_Extent = {0, 0};
+    }
+
+    void PostProcessStack::BeginFrame(uint32_t frameIndex) {
+        if (m_QueryPools.empty()) return;
+        uint32_t written = m_StagesWritten[frameIndex];
+        if (written == 0) return; // Slot not recorded yet
+
+        // A (value, availability) pair per query; stages switched off that frame were never written.
+        std::array<uint64_t, StageCount * 2 * 2> results{};
+        VkResult result = vkGetQueryPoolResults(m_Context.device, m_QueryPools[frameIndex], 0, StageCount * 2,
+                                                sizeof(results), results.data(), 2 * sizeof(uint64_t),
+                                                VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+        if (result != VK_SUCCESS && result != VK_NOT_READY) return;
+
+        m_Stats.stageMs = {};
+        m_Stats.totalMs = 0.0f;
+        for (uint32_t stage = 0; stage < StageCount; ++stage) {
+            if (!(written & (1u << stage))) continue;
+            const uint64_t* begin = &results[stage * 4];
+            const uint64_t* end = &results[stage * 4 + 2];
+            if (begin[1] == 0 || end[1] == 0) continue;
+            uint64_t ticks = (end[0] - begin[0]) & m_TimestampMask;
+            float ms = static_cast<float>(static_cast<double>(ticks) * m_TimestampPeriodNs * 1e-6);
+            m_Stats.stageMs[stage] = ms;
+            m_Stats.totalMs += ms;
+        }
+    }
+
+    void PostProcessStack::WriteTimestamp(VkCommandBuffer commandBuffer, uint32_t frameIndex, PostProcessStage stage, bool end) {
+        if (m_QueryPools.empty()) return;
+        uint32_t stageIndex = static_cast<uint32_t>(stage);
+        // Bottom of pipe: written once all earlier work has finished, so begin/end bracket the stage's dispatches.
+        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_QueryPools[frameIndex], stageIndex * 2 + (end ? 1 : 0));
+        if (end) m_StagesWritten[frameIndex] |= 1u << stageIndex;
+    }
+
+    void PostProcessStack::Dispatch(VkCommandBuffer commandBuffer, const ComputePass& pass, VkDescriptorSet set,
+                                    const void* pushConstants, uint32_t pushSize, uint32_t groupsX, uint32_t groupsY) {
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pass.pipeline);
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pass.layout, 0, 1, &set, 0, nullptr);
+        vkCmdPushConstants(commandBuffer, pass.layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, pushSize, pushConstants);
+        vkCmdDispatch(commandBuffer, groupsX, groupsY, 1);
+    }
+
+    void PostProcessStack::Record(VkCommandBuffer commandBuffer, uint32_t frameIndex) {
+        auto now = std::chrono::steady_clock::now();
+        float deltaTime = m_LastRecordTime.time_since_epoch().count() == 0 ? 0.0f
+                        : std::chrono::duration<float>(now - m_LastRecordTime).count();
+        m_LastRecordTime = now;
+        const PostProcessSettings& settings = m_Settings;
+
+        if (!m_QueryPools.empty()) vkCmdResetQueryPool(commandBuffer, m_QueryPools[frameIndex], 0, StageCount * 2);
+        m_StagesWritten[frameIndex] = 0;
+
+        // Every level of the bloom chain and the output are rewritten each frame, so their old
+        // contents are dropped; this also orders the writes after the previous frame's reads.
+        std::array<VkImageMemoryBarrier, 2> targetBarriers{};
+        for (VkImageMemoryBarrier& barrier : targetBarriers) {
+            barrier = {VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER};
+            barrier.srcAccessMask = 0;
+            barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+            barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+            barrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+            barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, VK_REMAINING_MIP_LEVELS, 0, 1};
+        }
+        targetBarriers[0].image = m_Bloom.image;
+        targetBarriers[1].image = m_Output.image;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0, nullptr,
+                             static_cast<uint32_t>(targetBarriers.size()), targetBarriers.data());
+
+        const uint32_t tileGroupsX = GroupCount(m_Extent.width, ResolveTileSize);
+        const uint32_t tileGroupsY = GroupCount(m_Extent.height, ResolveTileSize);
+
+        // --- Auto exposure: histogram, then one group averages it and adapts ---
+        if (settings.autoExposure) {
+            WriteTimestamp(commandBuffer, frameIndex, PostProcessStage::AutoExposure, false);
+            if (!m_ExposureValid) {
+                vkCmdFillBuffer(commandBuffer, m_ExposureState->GetBuffer(), 0, VK_WHOLE_SIZE, 0);
+                VkMemoryBarrier clearBarrier{VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+                clearBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+                clearBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+                vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                     0, 1, &clearBarrier, 0, nullptr, 0, nullptr);
+            }
+            HistogramPushConstants histogram{MinLogLuminance, 1.0f / LogLuminanceRange};
+            Dispatch(commandBuffer, m_HistogramPass, m_HistogramSet, &histogram, sizeof(histogram), tileGroupsX, tileGroupsY);
+            ComputeBarrier(commandBuffer);
+
+            ExposurePushConstants exposure{};
+            exposure.minLogLuminance = MinLogLuminance;
+            exposure.logLuminanceRange = LogLuminanceRange;
+            // Frame-rate independent easing; the first frame snaps to the scene.
+            exposure.adaptation = m_ExposureValid ? 1.0f - std::exp(-deltaTime * settings.adaptationSpeed) : 1.0f;
+            exposure.compensation = std::exp2(settings.exposureCompensation);
+            exposure.pixelCount = m_Extent.width * m_Extent.height;
+            Dispatch(commandBuffer, m_ExposurePass, m_ExposureSet, &exposure, sizeof(exposure), 1, 1);
+            ComputeBarrier(commandBuffer);
+            m_ExposureValid = true;
+            WriteTimestamp(commandBuffer, frameIndex, PostProcessStage::AutoExposure, true);
+        } else {
+            m_ExposureValid = false; // Snap again when switched back on
+        }
+
+        // --- Bloom: down the mip chain, then back up accumulating into mip 0 ---
+        if (settings.bloom) {
+            WriteTimestamp(commandBuffer, frameIndex, PostProcessStage::Bloom, false);
+            uint32_t bloomWidth = std::max(m_Extent.width / 2, 1u);
+            uint32_t bloomHeight = std::max(m_Extent.height / 2, 1u);
+            auto mipWidth = [&](uint32_t mip) { return std::max(bloomWidth >> mip, 1u); };
+            auto mipHeight = [&](uint32_t mip) { return std::max(bloomHeight >> mip, 1u); };
+            for (uint32_t mip = 0; mip < m_BloomMipCount; ++mip) {
+                uint32_t sourceWidth = mip == 0 ? m_Extent.width : mipWidth(mip - 1);
+                uint32_t sourceHeight = mip == 0 ? m_Extent.height : mipHeight(mip - 1);
+                DownsamplePushConstants downsample{};
+                downsample.sourceTexelSize = glm::vec2(1.0f / sourceWidth, 1.0f / sourceHeight);
+                downsample.threshold = settings.bloomThreshold;
+                downsample.knee = settings.bloomKnee;
+                downsample.prefilter = mip == 0 ? 1u : 0u;
+                Dispatch(commandBuffer, m_DownsamplePass, m_DownsampleSets[mip], &downsample, sizeof(downsample),
+                         GroupCount(mipWidth(mip), BloomGroupSize), GroupCount(mipHeight(mip), BloomGroupSize));
+                ComputeBarrier(commandBuffer);
+            }
+            for (uint32_t mip = m_BloomMipCount - 1; mip > 0; --mip) {
+                UpsamplePushConstants upsample{};
+                upsample.sourceTexelSize = glm::vec2(1.0f / mipWidth(mip), 1.0f / mipHeight(mip));
+                upsample.radius = 1.0f;
+                Dispatch(commandBuffer, m_UpsamplePass, m_UpsampleSets[mip - 1], &upsample, sizeof(upsample),
+                         GroupCount(mipWidth(mip - 1), BloomGroupSize), GroupCount(mipHeight(mip - 1), BloomGroupSize));
+                ComputeBarrier(commandBuffer);
+            }
+            WriteTimestamp(commandBuffer, frameIndex, PostProcessStage::Bloom, true);
+        }
+
+        // --- Resolve: bloom composite + exposure + tonemap + FXAA in one dispatch ---
+        WriteTimestamp(commandBuffer, frameIndex, PostProcessStage::Resolve, false);
+        ResolvePushConstants resolve{};
+        resolve.manualExposure = settings.manualExposure * std::exp2(settings.exposureCompensation);
+        resolve.bloomIntensity = settings.bloomIntensity;
+        resolve.flags = (settings.autoExposure ? PostProcessFlag_AutoExposure : 0u) | (settings.bloom ? PostProcessFlag_Bloom : 0u) |
+                        (settings.tonemap ? PostProcessFlag_Tonemap : 0u) | (settings.fxaa ? PostProcessFlag_Fxaa : 0u);
+        Dispatch(commandBuffer, m_ResolvePass, m_ResolveSet, &resolve, sizeof(resolve), tileGroupsX, tileGroupsY);
+        WriteTimestamp(commandBuffer, frameIndex, PostProcessStage::Resolve, true);
+
+        // The present pass samples the result.
+        VkMemoryBarrier outputBarrier{VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+        outputBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        outputBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                             0, 1, &outputBarrier, 0, nullptr, 0, nullptr);
+    }
+
+    void PostProcessStack::DrawPresent(VkCommandBuffer commandBuffer) {
+        if (m_PresentPipeline == VK_NULL_HANDLE) return;
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_PresentPipeline);
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_PresentLayout, 0, 1, &m_PresentSet, 0, nullptr);
+        vkCmdDraw(commandBuffer, 3, 1, 0, 0);
+    }
+
+} // namespace VulkEng
@@ -0,0 +1,169 @@
+#pragma once
+
+#include "graphics/Buffer.h"        // For VulkanBuffer
+#include "graphics/ShaderLibrary.h" // For PipelineReplacement
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+namespace VulkEng {
+
+    class VulkanContext;
+
+    // Runtime switches and parameters of the post-processing effects.
+    struct PostProcessSettings {
+        bool autoExposure = true;
+        bool bloom = true;
+        bool tonemap = true; // ACES filmic; off, the exposed color is clamped
+        bool fxaa = true;
+
+        float exposureCompensation = 0.0f; // EV, on top of auto exposure
+        float manualExposure = 1.0f;       // Multiplier while auto exposure is off
+        float adaptationSpeed = 1.5f;      // Auto exposure easing rate, per second
+        float bloomThreshold = 1.0f;       // Scene luminance where bloom starts
+        float bloomKnee = 0.5f;            // Soft transition width around the threshold
+        float bloomIntensity = 0.04f;
+    };
+
+    // Post-processing stages with their own GPU timings. Resolve is the fused bloom composite,
+    // exposure, tonemap and FXAA pass.
+    enum class PostProcessStage : uint32_t { AutoExposure, Bloom, Resolve, Count };
+
+    // GPU time per stage, from timestamp queries of the last frame the GPU finished (0 for stages
+    // that were switched off).
+    struct PostProcessStats {
+        std::array<float, static_cast<size_t>(PostProcessStage::Count)> stageMs{};
+        float totalMs = 0.0f;
+        bool timestampsSupported = false;
+
+        static const char* StageName(PostProcessStage stage);
+    };
+
+    // HDR post-processing between the scene render pass and presentation. The scene renders into
+    // an RGBA16F target owned here; Record() then runs auto exposure (a luminance histogram and an
+    // adaptation step), the bloom mip chain, and a single fused compute pass that composites bloom,
+    // applies exposure, tonemaps and runs FXAA out of shared memory. DrawPresent() copies the
+    // result into the swapchain image inside the present render pass, compositing the UI layer
+    // (also owned here, rendered by the renderer only when the UI changed) on top.
+    class PostProcessStack {
+    public:
+        static constexpr VkFormat HdrFormat = VK_FORMAT_R16G16B16A16_SFLOAT;
+        // Premultiplied UI colors, written as-is like they used to be into the swapchain image.
+        static constexpr VkFormat UiLayerFormat = VK_FORMAT_R8G8B8A8_UNORM;
+        static constexpr uint32_t MaxBloomMips = 6;
+
+        PostProcessStack(VulkanContext& context, ShaderLibrary& shaderLibrary);
+        ~PostProcessStack();
+
+        PostProcessStack(const PostProcessStack&) = delete;
+        PostProcessStack& operator=(const PostProcessStack&) = delete;
+
+        // Swapchain-dependent: the targets match the swapchain extent, the present pipeline its
+        // render pass. The device must be idle when these are called (as during swapchain recreation).
+        void CreateTargets(VkExtent2D extent);
+        void CreatePresentPipeline(VkRenderPass presentPass, VkFormat presentFormat);
+        void DestroySwapchainDependents();
+
+        // The scene render pass's color attachment; left in SHADER_READ_ONLY_OPTIMAL by that pass.
+        VkImageView GetHdrView() const { return m_Hdr.view; }
+        // The UI layer render pass's color attachment; must be left in SHADER_READ_ONLY_OPTIMAL by
+        // it before the first DrawPresent after CreateTargets.
+        VkImageView GetUiLayerView() const { return m_UiLayer.view; }
+
+        // Call once the frame that last used this slot has completed: reads back its timestamps.
+        void BeginFrame(uint32_t frameIndex);
+        // Records the enabled effects; outside a render pass, after the scene pass.
+        void Record(VkCommandBuffer commandBuffer, uint32_t frameIndex);
+        // Inside the present render pass.
+        void DrawPresent(VkCommandBuffer commandBuffer);
+
+        // --- Hot Reload ---
+        // Builds replacements for the pipelines whose shaders are among `changedShaders` (see
+        // ShaderLibrary::PollChangedShaders) without touching the live ones, so it may run on a worker
+        // while frames are recorded; the caller swaps them in and retires the old pipelines. Failures
+        // are logged and skipped. Edits that change a shader's bindings or push constants need a restart.
+        std::vector<PipelineReplacement> BuildReloadedPipelines(const std::vector<std::string>& changedShaders);
+
+        PostProcessSettings& GetSettings() { return m_Settings; }
+        const PostProcessStats& GetStats() const { return m_Stats; }
+
+    private:
+        // A compute shader with a pipeline layout and set layout reflected from it.
+        struct ComputePass {
+            const char* shaderName = nullptr;
+            uint32_t pushConstantSize = 0;
+            VkDescriptorSetLayout setLayout = VK_NULL_HANDLE;
+            VkPipelineLayout layout = VK_NULL_HANDLE;
+            VkPipeline pipeline = VK_NULL_HANDLE;
+        };
+
+        struct Image {
+            VkImage image = VK_NULL_HANDLE;
+            VkDeviceMemory memory = VK_NULL_HANDLE;
+            VkImageView view = VK_NULL_HANDLE;
+        };
+
+        void CreateComputePass(const char* shaderName, uint32_t pushConstantSize, ComputePass& outPass);
+        // Thread-safe; read only the shader library and the layouts (and the present pass and format).
+        VkPipeline BuildComputePipeline(const ComputePass& pass) const;
+        VkPipeline BuildPresentPipeline() const;
+        void DestroyComputePass(ComputePass& pass);
+        void DestroyImage(Image& image);
+        VkDescriptorSet AllocateSet(VkDescriptorSetLayout layout);
+        void WriteSet(VkDescriptorSet set, std::initializer_list<VkWriteDescriptorSet> writes);
+        void Dispatch(VkCommandBuffer commandBuffer, const ComputePass& pass, VkDescriptorSet set,
+                      const void* pushConstants, uint32_t pushSize, uint32_t groupsX, uint32_t groupsY);
+        void WriteTimestamp(VkCommandBuffer commandBuffer, uint32_t frameIndex, PostProcessStage stage, bool end);
+
+        VulkanContext& m_Context;
+        ShaderLibrary& m_ShaderLibrary;
+        PostProcessSettings m_Settings;
+        PostProcessStats m_Stats;
+
+        ComputePass m_HistogramPass;
+        ComputePass m_ExposurePass;
+        ComputePass m_DownsamplePass;
+        ComputePass m_UpsamplePass;
+        ComputePass m_ResolvePass;
+        VkSampler m_LinearSampler = VK_NULL_HANDLE;
+        std::unique_ptr<VulkanBuffer> m_ExposureState; // Histogram + adapted luminance, persists across frames
+        bool m_ExposureValid = false;                  // False until auto exposure has run once
+        std::chrono::steady_clock::time_point m_LastRecordTime;
+
+        // --- Swapchain-dependent ---
+        VkExtent2D m_Extent{0, 0};
+        VkDescriptorPool m_DescriptorPool = VK_NULL_HANDLE; // Reset wholesale with the targets
+        Image m_Hdr;
+        Image m_Bloom;                          // Half resolution, m_BloomMipCount mips
+        std::vector<VkImageView> m_BloomMipViews;
+        uint32_t m_BloomMipCount = 0;
+        Image m_Output;                         // Display-referred result, read by the present pass
+        Image m_UiLayer;                        // Retained across frames until the UI changes
+        VkDescriptorSet m_HistogramSet = VK_NULL_HANDLE;
+        VkDescriptorSet m_ExposureSet = VK_NULL_HANDLE;
+        std::vector<VkDescriptorSet> m_DownsampleSets; // [mip]: previous level (or scene) -> mip
+        std::vector<VkDescriptorSet> m_UpsampleSets;   // [mip]: mip + 1 -> mip
+        VkDescriptorSet m_ResolveSet = VK_NULL_HANDLE;
+
+        // --- Present ---
+        VkDescriptorSetLayout m_PresentSetLayout = VK_NULL_HANDLE;
+        VkPipelineLayout m_PresentLayout = VK_NULL_HANDLE;
+        VkPipeline m_PresentPipeline = VK_NULL_HANDLE;
+        VkRenderPass m_PresentPass = VK_NULL_HANDLE; // Not owned
+        VkFormat m_PresentFormat = VK_FORMAT_UNDEFINED;
+        VkDescriptorSet m_PresentSet = VK_NULL_HANDLE;
+
+        // --- GPU Timing (one query pool per frame in flight, a begin/end pair per stage) ---
+        std::vector<VkQueryPool> m_QueryPools;
+        std::vector<uint32_t> m_StagesWritten; // Per frame: bit per stage timed in its last recording
+        double m_TimestampPeriodNs = 0.0;
+        uint64_t m_TimestampMask = 0;
+    };
+
+} // namespace VulkEng
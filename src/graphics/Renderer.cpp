@@ -1,34 +1,91 @@
 #include "Renderer.h"
 #include "VulkanUtils.h"
+#include "ImmediateContext.h"
 #include "core/Window.h"
 #include "core/Log.h"
 #include "core/ServiceLocator.h" // For AssetManager, UIManager
+#include "core/Hash.h"           // For GraphicsPipelineKeyHash
+#include "core/PerfCounters.h"   // Draw call, bind and triangle counts
 #include "assets/Mesh.h"
 #include "assets/Material.h"
 #include "assets/Texture.h"
 #include "assets/AssetManager.h"
 #include "scene/Components/CameraComponent.h"
 #include "scene/Components/TransformComponent.h"
+#include "scene/Components/InstancedMeshComponent.h"
+#include "Frustum.h"
+#include "BrdfLut.h"
 #include "ui/UIManager.h"
 
 
 #include <GLFW/glfw3.h> // For glfwGetTime in UBO update (can be removed)
-#include <fstream>
 #include <stdexcept>
 #include <array>
 #include <vector>
 #include <chrono> // For UBO update example
+#include <algorithm> // For std::max
+#include <cstddef>   // For offsetof
+#include <exception> // For std::exception_ptr (parallel pipeline creation)
 #include <glm/gtc/type_ptr.hpp> // For glm::value_ptr
+#include <glm/gtc/packing.hpp>  // For glm::packHalf1x16 (default environment)
 
 namespace VulkEng {
 
+    namespace {
+        // Must match PushConstants in skinned.vert.
+        struct SkinnedPushConstants {
+            glm::mat4 model;
+            uint32_t jointOffset;
+        };
+
+        // Subpasses of the scene render pass.
+        constexpr uint32_t OpaqueSubpass = 0;        // Opaque, alpha-tested and sorted transparent geometry, particles
+        constexpr uint32_t OitAccumulateSubpass = 1; // TransparencyMode::WeightedBlended draws
+        constexpr uint32_t OitCompositeSubpass = 2;  // Resolves the accumulation over the scene color
+
+        // Scene pass attachments. With MSAA, color and depth are the multisampled targets and the
+        // resolve attachments follow.
+        enum SceneAttachment : uint32_t {
+            SceneColorAttachment, SceneDepthAttachment, OitAccumAttachment, OitRevealageAttachment,
+            SceneColorResolveAttachment, SceneDepthResolveAttachment
+        };
+        constexpr VkFormat OitAccumFormat = VK_FORMAT_R16G16B16A16_SFLOAT;
+        constexpr VkFormat OitRevealageFormat = VK_FORMAT_R16_SFLOAT;
+
+        bool IsDrawable(const RenderObjectInfo& info) {
+            return info.mesh && info.transform && info.mesh->vertexBuffer && info.mesh->indexBuffer;
+        }
+
+        bool IsDrawable(const InstancedRenderInfo& info) {
+            const Mesh* mesh = info.batch ? info.batch->GetMesh() : nullptr;
+            return mesh && mesh->vertexBuffer && mesh->indexBuffer && info.batch->GetGpuBuffer() && info.batch->GetInstanceCount() > 0;
+        }
+
+        bool IsTransparent(const Material& material) {
+            return material.alphaMode == Material::AlphaMode::BLEND;
+        }
+
+        VkSampleCountFlagBits PresetSamples(MsaaPreset preset) {
+            switch (preset) {
+                case MsaaPreset::Off: return VK_SAMPLE_COUNT_1_BIT;
+                case MsaaPreset::Performance: return VK_SAMPLE_COUNT_2_BIT;
+                case MsaaPreset::Balanced: return VK_SAMPLE_COUNT_4_BIT;
+                case MsaaPreset::Quality: return VK_SAMPLE_COUNT_8_BIT;
+            }
+            return VK_SAMPLE_COUNT_1_BIT;
+        }
+
+        // Relative to the working directory, like the shader cache.
+        const char* const BrdfLutCachePath = "cache/brdf_lut.bin";
+    }
+
     // --- Renderer Constructor / Destructor ---
     Renderer::Renderer(Window& window)
         : m_Window(window),
           m_VulkanContext(nullptr), m_Swapchain(nullptr), m_CommandManager(nullptr),
           m_RenderPass(VK_NULL_HANDLE),
           m_FrameDescriptorSetLayout(VK_NULL_HANDLE), m_MaterialDescriptorSetLayout(VK_NULL_HANDLE),
-          m_PipelineLayout(VK_NULL_HANDLE), m_GraphicsPipeline(VK_NULL_HANDLE),
+          m_PipelineLayout(VK_NULL_HANDLE),
           m_DepthImage(VK_NULL_HANDLE), m_DepthImageMemory(VK_NULL_HANDLE), m_DepthImageView(VK_NULL_HANDLE),
           m_DescriptorPool(VK_NULL_HANDLE),
           m_CurrentFrameIndex(0), m_CurrentImageIndex(0), m_FramebufferResized(false)
@@ -48,6 +105,11 @@ namespace VulkEng {
         m_UniformBuffers.clear();
         m_LightUniformBuffers.clear();
         VKENG_INFO("UBO Buffers destroyed.");
+        m_InstanceStagingBuffers.clear();
+        m_InstanceBuffersInFlight.clear();
+        m_BoneMatrixBuffers.clear();
+        m_ParticleSystem.reset(); // Uses the frame set layout
+        m_PostProcess.reset();
 
         // Descriptor Set Layouts
         if (m_VulkanContext && m_VulkanContext->device != VK_NULL_HANDLE) {
@@ -59,6 +121,12 @@ namespace VulkEng {
                 vkDestroyDescriptorSetLayout(m_VulkanContext->device, m_MaterialDescriptorSetLayout, nullptr);
                 m_MaterialDescriptorSetLayout = VK_NULL_HANDLE;
             }
+            if (m_SkinDescriptorSetLayout != VK_NULL_HANDLE) {
+                vkDestroyDescriptorSetLayout(m_VulkanContext->device, m_SkinDescriptorSetLayout, nullptr);
+                m_SkinDescriptorSetLayout = VK_NULL_HANDLE;
+            }
+            if (m_OitCompositeLayout != VK_NULL_HANDLE) vkDestroyPipelineLayout(m_VulkanContext->device, m_OitCompositeLayout, nullptr);
+            if (m_OitCompositeSetLayout != VK_NULL_HANDLE) vkDestroyDescriptorSetLayout(m_VulkanContext->device, m_OitCompositeSetLayout, nullptr);
             // Pipeline Layout is destroyed before pipeline usually (or with it)
             if (m_PipelineLayout != VK_NULL_HANDLE) { // Should be destroyed by CleanupSwapchainDependents
                  // vkDestroyPipelineLayout(m_VulkanContext->device, m_PipelineLayout, nullptr);
@@ -66,6 +134,17 @@ namespace VulkEng {
             }
              VKENG_INFO("Descriptor Set Layouts destroyed.");
 
+            // BRDF table
+            if (m_BrdfLutSampler != VK_NULL_HANDLE) vkDestroySampler(m_VulkanContext->device, m_BrdfLutSampler, nullptr);
+            if (m_BrdfLutImageView != VK_NULL_HANDLE) vkDestroyImageView(m_VulkanContext->device, m_BrdfLutImageView, nullptr);
+            if (m_BrdfLutImage != VK_NULL_HANDLE) vkDestroyImage(m_VulkanContext->device, m_BrdfLutImage, nullptr);
+            if (m_BrdfLutImageMemory != VK_NULL_HANDLE) vkFreeMemory(m_VulkanContext->device, m_BrdfLutImageMemory, nullptr);
+
+            // Environment lighting
+            DestroyEnvironmentCube(m_IrradianceCube);
+            DestroyEnvironmentCube(m_SpecularCube);
+            if (m_EnvironmentSampler != VK_NULL_HANDLE) vkDestroySampler(m_VulkanContext->device, m_EnvironmentSampler, nullptr);
+
             // Descriptor Pool (frees all sets allocated from it, including frame sets and material sets)
             if (m_DescriptorPool != VK_NULL_HANDLE) {
                 vkDestroyDescriptorPool(m_VulkanContext->device, m_DescriptorPool, nullptr);
@@ -80,14 +159,12 @@ namespace VulkEng {
                     vkDestroySemaphore(m_VulkanContext->device, m_RenderFinishedSemaphores[i], nullptr);
                 if (m_ImageAvailableSemaphores.size() > i && m_ImageAvailableSemaphores[i] != VK_NULL_HANDLE)
                     vkDestroySemaphore(m_VulkanContext->device, m_ImageAvailableSemaphores[i], nullptr);
-                if (m_InFlightFences.size() > i && m_InFlightFences[i] != VK_NULL_HANDLE)
-                    vkDestroyFence(m_VulkanContext->device, m_InFlightFences[i], nullptr);
             }
              VKENG_INFO("Synchronization objects destroyed.");
         }
         m_RenderFinishedSemaphores.clear();
         m_ImageAvailableSemaphores.clear();
-        m_InFlightFences.clear();
+        m_FrameSlotFrames.clear();
 
 
         // CommandManager unique_ptr handles its own cleanup
@@ -106,20 +183,35 @@ namespace VulkEng {
         // Pass MAX_FRAMES_IN_FLIGHT to command manager for buffer count
         m_CommandManager = std::make_unique<CommandManager>(*m_VulkanContext, MAX_FRAMES_IN_FLIGHT);
         m_Swapchain = std::make_unique<Swapchain>(*m_VulkanContext, m_Window.GetWidth(), m_Window.GetHeight());
+        m_ShaderLibrary = std::make_unique<ShaderLibrary>(*m_VulkanContext);
 
-        CreateDescriptorSetLayouts(); // For Frame UBOs (Set 0) and Material Textures (Set 1)
+        CreateDescriptorSetLayouts(); // Reflected from the mesh shaders: Frame (Set 0), Material (Set 1), Skin (Set 2)
         CreateUniformBuffers();       // Camera UBOs
         CreateLightUniformBuffers();  // Light UBOs
         CreateDescriptorPool();       // Pool for both frame and material sets
-        CreateFrameDescriptorSets();  // Sets for Set 0 (Camera + Light UBOs per frame)
+        CreateBrdfLut();              // Sampled through Set 0
+        CreateDefaultEnvironment();   // Sampled through Set 0 until SetEnvironmentLighting
+        CreateFrameDescriptorSets();  // Sets for Set 0 (Camera + Light UBOs per frame, BRDF table, environment)
                                       // Material descriptor sets (Set 1) are created by AssetManager
-        CreateSyncObjects();          // Semaphores & Fences
+        CreateSkinDescriptorSets();   // Sets for Set 2 (bone matrices per frame)
+        CreateOitCompositeLayout();   // Input attachments of the OIT composite subpass
+        const VkPhysicalDeviceLimits& limits = m_VulkanContext->physicalDeviceProperties.limits;
+        VkSampleCountFlags sampleCounts = limits.framebufferColorSampleCounts & limits.framebufferDepthSampleCounts;
+        for (VkSampleCountFlagBits samples : {VK_SAMPLE_COUNT_8_BIT, VK_SAMPLE_COUNT_4_BIT, VK_SAMPLE_COUNT_2_BIT}) {
+            if (sampleCounts & samples) { m_MaxMsaaSamples = samples; break; }
+        }
+        m_MsaaSamples = std::min(PresetSamples(m_MsaaPreset), m_MaxMsaaSamples);
+        m_ParticleSystem = std::make_unique<GpuParticleSystem>(*m_VulkanContext, *m_ShaderLibrary, m_FrameDescriptorSetLayout);
+        m_PostProcess = std::make_unique<PostProcessStack>(*m_VulkanContext, *m_ShaderLibrary);
+        CreateSyncObjects();          // Swapchain semaphores
+        m_InstanceStagingBuffers.resize(MAX_FRAMES_IN_FLIGHT); // Created on first instance upload
+        m_InstanceBuffersInFlight.resize(MAX_FRAMES_IN_FLIGHT);
 
         CreateSwapchainDependents();  // RenderPass, Pipeline, Framebuffers, Depth Buffer
                                       // Pipeline creation uses the descriptor set layouts
 
         // Update context with info needed by UIManager
-        m_VulkanContext->mainRenderPass = m_RenderPass;
+        m_VulkanContext->mainRenderPass = m_UiRenderPass;
         m_VulkanContext->imageCount = m_Swapchain->GetImageCount();
         m_VulkanContext->minImageCount = m_Context.minImageCount; // Set during swapchain creation based on capabilities
 
@@ -130,16 +222,13 @@ namespace VulkEng {
         VKENG_INFO("Creating Synchronization Objects ({} frames)...", MAX_FRAMES_IN_FLIGHT);
         m_ImageAvailableSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
         m_RenderFinishedSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-        m_InFlightFences.resize(MAX_FRAMES_IN_FLIGHT);
+        m_FrameSlotFrames.assign(MAX_FRAMES_IN_FLIGHT, 0); // Nothing submitted yet, so nothing to wait for
 
         VkSemaphoreCreateInfo semaphoreInfo{VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO};
-        VkFenceCreateInfo fenceInfo{VK_STRUCTURE_TYPE_FENCE_CREATE_INFO};
-        fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT; // Start signaled for first frame
 
         for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
             VK_CHECK(vkCreateSemaphore(m_VulkanContext->device, &semaphoreInfo, nullptr, &m_ImageAvailableSemaphores[i]));
             VK_CHECK(vkCreateSemaphore(m_VulkanContext->device, &semaphoreInfo, nullptr, &m_RenderFinishedSemaphores[i]));
-            VK_CHECK(vkCreateFence(m_VulkanContext->device, &fenceInfo, nullptr, &m_InFlightFences[i]));
         }
         VKENG_INFO("Synchronization Objects Created.");
     }
@@ -147,9 +236,21 @@ namespace VulkEng {
     void Renderer::CreateSwapchainDependents() {
         VKENG_INFO("Creating Swapchain Dependent Resources...");
         CreateDepthResources();
+        CreateMsaaResources();
+        CreateOitResources();
+        m_PostProcess->CreateTargets(m_Swapchain->GetExtent()); // The HDR scene target
         CreateRenderPass();
+        CreatePresentRenderPass();
+        CreateUiRenderPass();
         CreateGraphicsPipeline(); // Uses layouts, render pass
+        m_OitCompositePipeline = BuildOitCompositePipeline();
+        m_PostProcess->CreatePresentPipeline(m_PresentRenderPass, m_Swapchain->GetImageFormat());
         CreateFramebuffers();
+        if (m_ParticleSystem) {
+            m_ParticleSystem->SetDepthImage(m_DepthImage, m_DepthImageView, m_DepthFormat, m_Swapchain->GetExtent());
+        }
+        m_DepthHasContents = false;
+        m_UiLayerValid = false; // New image, rendered (or at least cleared) before its first use
         VKENG_INFO("Swapchain Dependent Resources Created.");
     }
 
@@ -160,18 +261,52 @@ namespace VulkEng {
             if (m_DepthImage != VK_NULL_HANDLE) vkDestroyImage(m_VulkanContext->device, m_DepthImage, nullptr);
             if (m_DepthImageMemory != VK_NULL_HANDLE) vkFreeMemory(m_VulkanContext->device, m_DepthImageMemory, nullptr);
             m_DepthImageView = VK_NULL_HANDLE; m_DepthImage = VK_NULL_HANDLE; m_DepthImageMemory = VK_NULL_HANDLE;
+            if (m_OitAccumImageView != VK_NULL_HANDLE) vkDestroyImageView(m_VulkanContext->device, m_OitAccumImageView, nullptr);
+            if (m_OitAccumImage != VK_NULL_HANDLE) vkDestroyImage(m_VulkanContext->device, m_OitAccumImage, nullptr);
+            if (m_OitAccumImageMemory != VK_NULL_HANDLE) vkFreeMemory(m_VulkanContext->device, m_OitAccumImageMemory, nullptr);
+            m_OitAccumImageView = VK_NULL_HANDLE; m_OitAccumImage = VK_NULL_HANDLE; m_OitAccumImageMemory = VK_NULL_HANDLE;
+            if (m_OitRevealageImageView != VK_NULL_HANDLE) vkDestroyImageView(m_VulkanContext->device, m_OitRevealageImageView, nullptr);
+            if (m_OitRevealageImage != VK_NULL_HANDLE) vkDestroyImage(m_VulkanContext->device, m_OitRevealageImage, nullptr);
+            if (m_OitRevealageImageMemory != VK_NULL_HANDLE) vkFreeMemory(m_VulkanContext->device, m_OitRevealageImageMemory, nullptr);
+            m_OitRevealageImageView = VK_NULL_HANDLE; m_OitRevealageImage = VK_NULL_HANDLE; m_OitRevealageImageMemory = VK_NULL_HANDLE;
+            if (m_MsaaColorImageView != VK_NULL_HANDLE) vkDestroyImageView(m_VulkanContext->device, m_MsaaColorImageView, nullptr);
+            if (m_MsaaColorImage != VK_NULL_HANDLE) vkDestroyImage(m_VulkanContext->device, m_MsaaColorImage, nullptr);
+            if (m_MsaaColorImageMemory != VK_NULL_HANDLE) vkFreeMemory(m_VulkanContext->device, m_MsaaColorImageMemory, nullptr);
+            m_MsaaColorImageView = VK_NULL_HANDLE; m_MsaaColorImage = VK_NULL_HANDLE; m_MsaaColorImageMemory = VK_NULL_HANDLE;
+            if (m_MsaaDepthImageView != VK_NULL_HANDLE) vkDestroyImageView(m_VulkanContext->device, m_MsaaDepthImageView, nullptr);
+            if (m_MsaaDepthImage != VK_NULL_HANDLE) vkDestroyImage(m_VulkanContext->device, m_MsaaDepthImage, nullptr);
+            if (m_MsaaDepthImageMemory != VK_NULL_HANDLE) vkFreeMemory(m_VulkanContext->device, m_MsaaDepthImageMemory, nullptr);
+            m_MsaaDepthImageView = VK_NULL_HANDLE; m_MsaaDepthImage = VK_NULL_HANDLE; m_MsaaDepthImageMemory = VK_NULL_HANDLE;
 
             for (auto framebuffer : m_SwapChainFramebuffers) {
                 if (framebuffer != VK_NULL_HANDLE) vkDestroyFramebuffer(m_VulkanContext->device, framebuffer, nullptr);
             }
             m_SwapChainFramebuffers.clear();
-
-            if (m_GraphicsPipeline != VK_NULL_HANDLE) vkDestroyPipeline(m_VulkanContext->device, m_GraphicsPipeline, nullptr);
+            if (m_UiFramebuffer != VK_NULL_HANDLE) vkDestroyFramebuffer(m_VulkanContext->device, m_UiFramebuffer, nullptr);
+            m_UiFramebuffer = VK_NULL_HANDLE;
+            if (m_SceneFramebuffer != VK_NULL_HANDLE) vkDestroyFramebuffer(m_VulkanContext->device, m_SceneFramebuffer, nullptr);
+            m_SceneFramebuffer = VK_NULL_HANDLE;
+
+            DestroyPendingShaderReloads();
+            for (auto& [key, pipeline] : m_GraphicsPipelines) { // Keys stay, to be rebuilt by CreateGraphicsPipeline
+                if (pipeline != VK_NULL_HANDLE) vkDestroyPipeline(m_VulkanContext->device, pipeline, nullptr);
+                pipeline = VK_NULL_HANDLE;
+            }
+            if (m_SkinnedPipelineLayout != VK_NULL_HANDLE) vkDestroyPipelineLayout(m_VulkanContext->device, m_SkinnedPipelineLayout, nullptr);
+            m_SkinnedPipelineLayout = VK_NULL_HANDLE;
             if (m_PipelineLayout != VK_NULL_HANDLE) vkDestroyPipelineLayout(m_VulkanContext->device, m_PipelineLayout, nullptr);
-            m_GraphicsPipeline = VK_NULL_HANDLE; m_PipelineLayout = VK_NULL_HANDLE;
+            m_PipelineLayout = VK_NULL_HANDLE;
+            if (m_ParticleSystem) m_ParticleSystem->DestroyPipelines();
+            if (m_PostProcess) m_PostProcess->DestroySwapchainDependents();
+            if (m_OitCompositePipeline != VK_NULL_HANDLE) vkDestroyPipeline(m_VulkanContext->device, m_OitCompositePipeline, nullptr);
+            m_OitCompositePipeline = VK_NULL_HANDLE;
 
             if (m_RenderPass != VK_NULL_HANDLE) vkDestroyRenderPass(m_VulkanContext->device, m_RenderPass, nullptr);
             m_RenderPass = VK_NULL_HANDLE;
+            if (m_PresentRenderPass != VK_NULL_HANDLE) vkDestroyRenderPass(m_VulkanContext->device, m_PresentRenderPass, nullptr);
+            m_PresentRenderPass = VK_NULL_HANDLE;
+            if (m_UiRenderPass != VK_NULL_HANDLE) vkDestroyRenderPass(m_VulkanContext->device, m_UiRenderPass, nullptr);
+            m_UiRenderPass = VK_NULL_HANDLE;
         }
         VKENG_INFO("Swapchain Dependent Resources Cleaned Up.");
     }
@@ -191,19 +326,56 @@ namespace VulkEng {
         // so they usually don't need recreation unless MAX_FRAMES_IN_FLIGHT changes.
         CreateSwapchainDependents();
         // Update context with new swapchain details
-        m_VulkanContext->mainRenderPass = m_RenderPass;
+        m_VulkanContext->mainRenderPass = m_UiRenderPass;
         m_VulkanContext->imageCount = m_Swapchain->GetImageCount();
         // m_VulkanContext->minImageCount was set by swapchain creation
         m_FramebufferResized = false;
         VKENG_INFO("Swapchain Recreated.");
     }
 
+    void Renderer::SetReversedZ(bool reversedZ) {
+        if (m_ReversedZ == reversedZ) return;
+        VKENG_INFO("Renderer: Switching to {} depth.", reversedZ ? "reversed-Z" : "standard");
+        WaitForDeviceIdle();
+        CleanupSwapchainDependents();
+        m_ReversedZ = reversedZ;
+        CreateSwapchainDependents(); // Pipelines pick up the new depth test; the depth image starts empty
+        m_VulkanContext->mainRenderPass = m_UiRenderPass;
+    }
+
+    void Renderer::SetMsaaPreset(MsaaPreset preset) {
+        m_MsaaPreset = preset;
+        VkSampleCountFlagBits samples = std::min(PresetSamples(preset), m_MaxMsaaSamples);
+        if (samples == m_MsaaSamples) return;
+        VKENG_INFO("Renderer: Switching to {}x MSAA.", static_cast<uint32_t>(samples));
+        WaitForDeviceIdle();
+        CleanupSwapchainDependents();
+        m_MsaaSamples = samples;
+        CreateSwapchainDependents(); // Targets, render pass and pipelines at the new sample count
+        m_VulkanContext->mainRenderPass = m_UiRenderPass;
+    }
+
+    void Renderer::WaitForQueueBeforeNextFrame(const GpuTimelinePoint& point, VkPipelineStageFlags stages) {
+        if (!point.IsValid()) return;
+        // Timeline values only grow, so one wait per queue (the latest point) covers all earlier ones.
+        for (QueueWait& wait : m_PendingQueueWaits) {
+            if (wait.point.semaphore == point.semaphore) {
+                wait.point.value = std::max(wait.point.value, point.value);
+                wait.stages |= stages;
+                return;
+            }
+        }
+        m_PendingQueueWaits.push_back({point, stages});
+    }
+
     void Renderer::HandleResize(int width, int height) {
         m_FramebufferResized = true;
     }
 
     bool Renderer::BeginFrame() {
-        VK_CHECK(vkWaitForFences(m_VulkanContext->device, 1, &m_InFlightFences[m_CurrentFrameIndex], VK_TRUE, UINT64_MAX));
+        // Pace the CPU: wait for the frame that last used this slot's command buffer and buffers.
+        m_VulkanContext->WaitFor(m_VulkanContext->GetFramePoint(m_FrameSlotFrames[m_CurrentFrameIndex]));
+        UpdateShaderHotReload();
 
         VkResult result = vkAcquireNextImageKHR(
             m_VulkanContext->device, m_Swapchain->GetSwapchain(), UINT64_MAX,
@@ -219,7 +391,10 @@ namespace VulkEng {
              m_FramebufferResized = true; // Recreate at next opportunity
         }
 
-        VK_CHECK(vkResetFences(m_VulkanContext->device, 1, &m_InFlightFences[m_CurrentFrameIndex]));
+        // The GPU is done with this frame slot, so instance buffers it kept alive can go.
+        m_InstanceBuffersInFlight[m_CurrentFrameIndex].clear();
+        m_ParticleSystem->BeginFrame(m_CurrentFrameIndex);
+        m_PostProcess->BeginFrame(m_CurrentFrameIndex);
         if (!m_CommandManager->BeginFrame(m_CurrentFrameIndex)) { // BeginFrame in CommandManager resets and begins
             VKENG_ERROR("Failed to begin command buffer for frame {}!", m_CurrentFrameIndex);
             return false;
@@ -227,26 +402,44 @@ namespace VulkEng {
         return true;
     }
 
-    void Renderer::RecordCommands(const std::vector<RenderObjectInfo>& renderables, CameraComponent* camera) {
+    void Renderer::RecordCommands(const RenderObjectList& renderables, const InstancedRenderList& instancedBatches,
+                                  const ParticleRenderList& particleEmitters, CameraComponent* camera) {
         VkCommandBuffer commandBuffer = GetCurrentCommandBuffer();
-        AssetManager& assetManager = ServiceLocator::GetAssetManager();
         UIManager& uiManager = ServiceLocator::GetUIManager();
 
-        std::array<VkClearValue, 2> clearValues{};
+        // Transfers can't be recorded inside a render pass.
+        UploadInstanceData(commandBuffer, instancedBatches);
+        ScratchVector<uint32_t> jointOffsets{ArenaAllocator<uint32_t>(*renderables.get_allocator().GetArena())};
+        UploadSkinningMatrices(renderables, jointOffsets);
+
+        // Particles collide with the depth buffer as the previous frame left it, seen through its camera.
+        VkExtent2D extent = m_Swapchain->GetExtent();
+        ParticleFrameUBO particleFrame;
+        particleFrame.viewProj = m_PrevViewProj;
+        particleFrame.invViewProj = m_PrevInvViewProj;
+        glm::vec3 cameraPosition = camera ? camera->GetPosition() : glm::vec3(0.0f);
+        particleFrame.cameraPosition = glm::vec4(cameraPosition, m_DepthHasContents ? 1.0f : 0.0f);
+        particleFrame.depthSize = glm::vec4(extent.width, extent.height, 1.0f / extent.width, 1.0f / extent.height);
+        particleFrame.depthParams.x = m_ReversedZ ? 0.0f : 1.0f;
+        m_ParticleSystem->Simulate(commandBuffer, m_CurrentFrameIndex, particleEmitters, particleFrame);
+
+        // Scene color, depth, then the OIT accumulation (nothing) and revealage (fully revealed).
+        std::array<VkClearValue, 4> clearValues{};
         clearValues[0].color = {{0.01f, 0.01f, 0.01f, 1.0f}};
-        clearValues[1].depthStencil = {1.0f, 0};
+        clearValues[1].depthStencil = {m_ReversedZ ? 0.0f : 1.0f, 0};
+        clearValues[2].color = {{0.0f, 0.0f, 0.0f, 0.0f}};
+        clearValues[3].color = {{1.0f, 0.0f, 0.0f, 0.0f}};
 
         VkRenderPassBeginInfo renderPassInfo{};
         renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
         renderPassInfo.renderPass = m_RenderPass;
-        renderPassInfo.framebuffer = m_SwapChainFramebuffers[m_CurrentImageIndex];
+        renderPassInfo.framebuffer = m_SceneFramebuffer;
         renderPassInfo.renderArea.offset = {0, 0};
         renderPassInfo.renderArea.extent = m_Swapchain->GetExtent();
         renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
         renderPassInfo.pClearValues = clearValues.data();
 
         vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
-        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_GraphicsPipeline);
 
         VkViewport viewport{}; /* ... set viewport based on swapchain extent ... */
         viewport.x = 0.0f; viewport.y = 0.0f;
@@ -263,57 +456,427 @@ namespace VulkEng {
         else UpdateCameraUBO(m_CurrentFrameIndex, glm::mat4(1.0f), glm::mat4(1.0f)); // Default if no camera
         UpdateLightUBO(m_CurrentFrameIndex);
 
-        // Bind Frame Descriptor Set (Set 0: Camera + Light)
-        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_PipelineLayout,
-                                0, 1, &m_FrameDescriptorSets[m_CurrentFrameIndex], 0, nullptr);
+        Frustum cameraFrustum;
+        if (camera) cameraFrustum = camera->GetFrustum();
+        const Frustum* frustum = camera ? &cameraFrustum : nullptr; // No culling without a camera
+
+        // --- Opaque subpass: opaque and alpha-tested geometry, sorted transparents, particles ---
+        DrawState drawState; // Set 0 is bound with the first pipeline
+        DrawRenderObjects(commandBuffer, renderables, jointOffsets, RenderQueue::Opaque, drawState);
+        DrawInstancedBatches(commandBuffer, instancedBatches, frustum, RenderQueue::Opaque, drawState);
+        if (m_TransparencyMode == TransparencyMode::Sorted) {
+            DrawSortedTransparents(commandBuffer, renderables, jointOffsets, instancedBatches, frustum, camera, drawState);
+        }
+        m_ParticleSystem->Draw(commandBuffer, m_FrameDescriptorSets[m_CurrentFrameIndex]); // Blended, after opaque geometry
+
+        // --- OIT subpasses: accumulate the transparent queue unsorted, then composite it once ---
+        vkCmdNextSubpass(commandBuffer, VK_SUBPASS_CONTENTS_INLINE);
+        uint32_t oitDraws = 0;
+        if (m_TransparencyMode == TransparencyMode::WeightedBlended) {
+            drawState = {}; // The particle draw replaced the pipeline and layout
+            oitDraws += DrawRenderObjects(commandBuffer, renderables, jointOffsets, RenderQueue::Transparent, drawState);
+            oitDraws += DrawInstancedBatches(commandBuffer, instancedBatches, frustum, RenderQueue::Transparent, drawState);
+        }
+        vkCmdNextSubpass(commandBuffer, VK_SUBPASS_CONTENTS_INLINE);
+        if (oitDraws > 0 && m_OitCompositePipeline != VK_NULL_HANDLE) {
+            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_OitCompositePipeline);
+            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_OitCompositeLayout, 0, 1, &m_OitCompositeSet, 0, nullptr);
+            vkCmdDraw(commandBuffer, 3, 1, 0, 0); // Fullscreen triangle
+            PerfCounters::Add(PerfCounter_DescriptorBinds);
+            PerfCounters::Add(PerfCounter_DrawCalls);
+            PerfCounters::Add(PerfCounter_Triangles);
+        }
+
+        vkCmdEndRenderPass(commandBuffer);
+
+        // Exposure, bloom, tonemapping and FXAA on the HDR scene (compute, between the passes).
+        m_PostProcess->Record(commandBuffer, m_CurrentFrameIndex);
+
+        // The UI layer is retained across frames and only re-rendered when the UI's draw data changed.
+        if (!m_UiLayerValid || uiManager.IsLayerDirty()) {
+            VkClearValue uiClear{}; // Transparent
+            VkRenderPassBeginInfo uiPassInfo{VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO};
+            uiPassInfo.renderPass = m_UiRenderPass;
+            uiPassInfo.framebuffer = m_UiFramebuffer;
+            uiPassInfo.renderArea.offset = {0, 0};
+            uiPassInfo.renderArea.extent = m_Swapchain->GetExtent();
+            uiPassInfo.clearValueCount = 1;
+            uiPassInfo.pClearValues = &uiClear;
+            vkCmdBeginRenderPass(commandBuffer, &uiPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+            uiManager.RenderDrawData(commandBuffer);
+            vkCmdEndRenderPass(commandBuffer);
+            m_UiLayerValid = true;
+        }
+
+        // The swapchain image gets the post-processed scene with the UI layer composited on top.
+        VkRenderPassBeginInfo presentPassInfo{VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO};
+        presentPassInfo.renderPass = m_PresentRenderPass;
+        presentPassInfo.framebuffer = m_SwapChainFramebuffers[m_CurrentImageIndex];
+        presentPassInfo.renderArea.offset = {0, 0};
+        presentPassInfo.renderArea.extent = m_Swapchain->GetExtent();
+        vkCmdBeginRenderPass(commandBuffer, &presentPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+        vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+        vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+        m_PostProcess->DrawPresent(commandBuffer);
+        vkCmdEndRenderPass(commandBuffer);
+
+        m_PrevViewProj = camera ? camera->GetViewProjectionMatrix() : glm::mat4(1.0f);
+        m_PrevInvViewProj = camera ? camera->GetInverseViewProjectionMatrix() : glm::mat4(1.0f);
+        m_DepthHasContents = true;
+    }
+
+    void Renderer::UploadInstanceData(VkCommandBuffer commandBuffer, const InstancedRenderList& instancedBatches) {
+        m_InstancingStats = {};
+        if (instancedBatches.empty()) return;
+
+        struct PendingUpload {
+            InstancedMeshComponent* batch;
+            size_t first;
+            size_t count;
+            VkDeviceSize stagingOffset;
+        };
+        std::vector<PendingUpload> uploads;
+        VkDeviceSize stagingSize = 0;
+
+        for (const InstancedRenderInfo& info : instancedBatches) {
+            InstancedMeshComponent* batch = info.batch;
+            if (!batch || batch->GetInstanceCount() == 0) continue;
+
+            size_t first = 0, count = 0;
+            size_t instanceCount = batch->GetInstanceCount();
+            if (instanceCount > batch->GetGpuCapacity()) {
+                // Grow by at least half so steady AddInstance calls don't reallocate every frame.
+                size_t capacity = std::max(instanceCount, batch->GetGpuCapacity() + batch->GetGpuCapacity() / 2);
+                capacity = (capacity + InstancedMeshComponent::InstancesPerChunk - 1) / InstancedMeshComponent::InstancesPerChunk
+                           * InstancedMeshComponent::InstancesPerChunk;
+                batch->SetGpuBuffer(std::make_shared<VulkanBuffer>(
+                    *m_VulkanContext, sizeof(InstanceData), static_cast<uint32_t>(capacity),
+                    VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT), capacity);
+                count = instanceCount; // The new buffer needs everything
+            } else {
+                batch->GetDirtyRange(first, count);
+            }
+            m_InstanceBuffersInFlight[m_CurrentFrameIndex].push_back(batch->GetGpuBuffer());
+            if (count == 0) continue;
+
+            uploads.push_back({batch, first, count, stagingSize});
+            stagingSize += count * sizeof(InstanceData);
+        }
+        if (uploads.empty()) return;
+
+        // This frame's fence has been waited on, so its staging buffer can be rewritten or replaced.
+        std::unique_ptr<VulkanBuffer>& staging = m_InstanceStagingBuffers[m_CurrentFrameIndex];
+        if (!staging || staging->GetBufferSize() < stagingSize) {
+            staging = std::make_unique<VulkanBuffer>(
+                *m_VulkanContext, stagingSize + stagingSize / 2, 1,
+                VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                1, BufferMapping::Persistent);
+        }
+
+        // Earlier frames may still be reading the instance buffers as vertex input.
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             0, 0, nullptr, 0, nullptr, 0, nullptr);
+
+        for (const PendingUpload& upload : uploads) {
+            VkDeviceSize byteSize = upload.count * sizeof(InstanceData);
+            staging->WriteToBuffer(upload.batch->GetInstanceData() + upload.first, byteSize, upload.stagingOffset);
+
+            VkBufferCopy region{};
+            region.srcOffset = upload.stagingOffset;
+            region.dstOffset = upload.first * sizeof(InstanceData);
+            region.size = byteSize;
+            vkCmdCopyBuffer(commandBuffer, staging->GetBuffer(), upload.batch->GetGpuBuffer()->GetBuffer(), 1, &region);
+
+            upload.batch->ClearDirtyRange();
+            m_InstancingStats.bytesUploaded += byteSize;
+        }
+
+        VkMemoryBarrier barrier{VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+                             0, 1, &barrier, 0, nullptr, 0, nullptr);
+    }
+
+    void Renderer::UploadSkinningMatrices(const RenderObjectList& renderables, ScratchVector<uint32_t>& outJointOffsets) {
+        outJointOffsets.assign(renderables.size(), 0);
+        uint32_t totalJoints = 0;
+        for (size_t i = 0; i < renderables.size(); ++i) {
+            const RenderObjectInfo& renderInfo = renderables[i];
+            if (!renderInfo.skinningMatrices || !renderInfo.mesh || !renderInfo.mesh->skinBuffer) continue;
+            outJointOffsets[i] = totalJoints;
+            totalJoints += renderInfo.jointCount;
+        }
+        if (totalJoints == 0) return;
+
+        // This frame's fence has been waited on, so its bone buffer and Set 2 can be rewritten or replaced.
+        std::unique_ptr<VulkanBuffer>& bones = m_BoneMatrixBuffers[m_CurrentFrameIndex];
+        if (!bones || bones->GetInstanceCount() < totalJoints) {
+            bones = std::make_unique<VulkanBuffer>(
+                *m_VulkanContext, sizeof(glm::mat4), totalJoints + totalJoints / 2,
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                1, BufferMapping::Persistent);
+            VkDescriptorBufferInfo boneInfo = bones->GetDescriptorInfo();
+            VkWriteDescriptorSet write{VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
+            write.dstSet = m_SkinDescriptorSets[m_CurrentFrameIndex]; write.dstBinding = 0;
+            write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            write.descriptorCount = 1; write.pBufferInfo = &boneInfo;
+            vkUpdateDescriptorSets(m_VulkanContext->device, 1, &write, 0, nullptr);
+        }
+        for (size_t i = 0; i < renderables.size(); ++i) {
+            const RenderObjectInfo& renderInfo = renderables[i];
+            if (!renderInfo.skinningMatrices || !renderInfo.mesh || !renderInfo.mesh->skinBuffer) continue;
+            bones->WriteToBuffer(renderInfo.skinningMatrices, renderInfo.jointCount * sizeof(glm::mat4), outJointOffsets[i] * sizeof(glm::mat4));
+        }
+    }
+
+    VkPipelineLayout Renderer::BindDrawState(VkCommandBuffer commandBuffer, DrawState& state, VkPipeline pipeline, GraphicsPipelineId id) {
+        VkPipelineLayout layout = id == SkinnedPipeline ? m_SkinnedPipelineLayout : m_PipelineLayout;
+        if (layout != state.layout) {
+            // The push constant ranges differ between the layouts, so switching disturbs Set 0.
+            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, layout,
+                                    0, 1, &m_FrameDescriptorSets[m_CurrentFrameIndex], 0, nullptr);
+            if (id == SkinnedPipeline) {
+                vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, layout,
+                                        2, 1, &m_SkinDescriptorSets[m_CurrentFrameIndex], 0, nullptr);
+            }
+            PerfCounters::Add(PerfCounter_DescriptorBinds, id == SkinnedPipeline ? 2 : 1);
+            state.layout = layout;
+        }
+        if (pipeline != state.pipeline) {
+            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+            state.pipeline = pipeline;
+        }
+        return layout;
+    }
+
+    bool Renderer::DrawRenderObject(VkCommandBuffer commandBuffer, const RenderObjectInfo& info, const Material& material,
+                                    uint32_t jointOffset, DrawState& state) {
+        bool skinned = info.skinningMatrices && info.mesh->skinBuffer;
+        GraphicsPipelineId id = skinned ? SkinnedPipeline : StandardPipeline;
+        VkPipeline pipeline = GetGraphicsPipeline(id, material);
+        if (pipeline == VK_NULL_HANDLE) return false;
+        VkPipelineLayout layout = BindDrawState(commandBuffer, state, pipeline, id);
+
+        glm::mat4 modelMatrix = info.transform->GetWorldMatrix();
+        if (skinned) {
+            SkinnedPushConstants pushConstants{modelMatrix, jointOffset};
+            vkCmdPushConstants(commandBuffer, layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(pushConstants), &pushConstants);
+        } else {
+            vkCmdPushConstants(commandBuffer, layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(glm::mat4), glm::value_ptr(modelMatrix));
+        }
+
+        if (material.descriptorSet != VK_NULL_HANDLE) {
+            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, layout,
+                                    1, 1, &material.descriptorSet, 0, nullptr);
+            PerfCounters::Add(PerfCounter_DescriptorBinds);
+        } else {
+             VKENG_WARN_ONCE("Material '{}' (Handle {}) has NULL descriptor set. Object might render incorrectly.", material.name, info.mesh->material);
+             // Optionally bind a default material descriptor set here
+        }
 
-        // Draw Scene Objects
-        for (const auto& renderInfo : renderables) {
-            if (!renderInfo.mesh || !renderInfo.transform || !renderInfo.mesh->vertexBuffer || !renderInfo.mesh->indexBuffer) continue;
+        VkBuffer vertexBuffers[] = {info.mesh->vertexBuffer->GetBuffer(), skinned ? info.mesh->skinBuffer->GetBuffer() : VK_NULL_HANDLE};
+        VkDeviceSize offsets[] = {info.mesh->vertexBufferOffset, 0};
+        vkCmdBindVertexBuffers(commandBuffer, 0, skinned ? 2 : 1, vertexBuffers, offsets);
+        vkCmdBindIndexBuffer(commandBuffer, info.mesh->indexBuffer->GetBuffer(), info.mesh->indexBufferOffset, VK_INDEX_TYPE_UINT32);
+        vkCmdDrawIndexed(commandBuffer, info.mesh->indexCount, 1, 0, 0, 0);
+        PerfCounters::Add(PerfCounter_DrawCalls);
+        PerfCounters::Add(PerfCounter_Triangles, info.mesh->indexCount / 3);
+        return true;
+    }
 
-            glm::mat4 modelMatrix = renderInfo.transform->GetWorldMatrix();
-            vkCmdPushConstants(commandBuffer, m_PipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(glm::mat4), glm::value_ptr(modelMatrix));
+    uint32_t Renderer::DrawRenderObjects(VkCommandBuffer commandBuffer, const RenderObjectList& renderables,
+                                         const ScratchVector<uint32_t>& jointOffsets, RenderQueue queue, DrawState& state) {
+        AssetManager& assetManager = ServiceLocator::GetAssetManager();
+        uint32_t draws = 0;
+        // Skinned objects use another layout; drawing them after the rest keeps the switch to one.
+        for (bool skinnedPass : {false, true}) {
+            for (size_t i = 0; i < renderables.size(); ++i) {
+                const RenderObjectInfo& renderInfo = renderables[i];
+                if (!IsDrawable(renderInfo)) continue;
+                if ((renderInfo.skinningMatrices && renderInfo.mesh->skinBuffer) != skinnedPass) continue;
+                const Material& material = assetManager.GetMaterial(renderInfo.mesh->material);
+                if (IsTransparent(material) != (queue == RenderQueue::Transparent)) continue;
+                if (DrawRenderObject(commandBuffer, renderInfo, material, jointOffsets[i], state)) ++draws;
+            }
+        }
+        return draws;
+    }
 
-            const Material& material = assetManager.GetMaterial(renderInfo.mesh->material);
+    uint32_t Renderer::DrawInstancedBatch(VkCommandBuffer commandBuffer, const InstancedRenderInfo& info, const Material& material,
+                                          const Frustum* frustum, size_t chunkBegin, size_t chunkEnd, DrawState& state) {
+        InstancedMeshComponent* batch = info.batch;
+        const Mesh* mesh = batch->GetMesh();
+        size_t instanceCount = batch->GetInstanceCount();
+        VkPipeline pipeline = GetGraphicsPipeline(InstancedPipeline, material);
+        if (pipeline == VK_NULL_HANDLE) return 0;
+
+        glm::mat4 modelMatrix = info.transform ? info.transform->GetWorldMatrix() : glm::mat4(1.0f);
+        batch->UpdateChunkBounds();
+        const auto& chunks = batch->GetChunks();
+        chunkEnd = std::min(chunkEnd, chunks.size());
+
+        bool stateBound = false;
+        auto bindBatchState = [&]() {
+            VkPipelineLayout layout = BindDrawState(commandBuffer, state, pipeline, InstancedPipeline);
+            vkCmdPushConstants(commandBuffer, layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(glm::mat4), glm::value_ptr(modelMatrix));
             if (material.descriptorSet != VK_NULL_HANDLE) {
-                vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_PipelineLayout,
+                vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, layout,
                                         1, 1, &material.descriptorSet, 0, nullptr);
+                PerfCounters::Add(PerfCounter_DescriptorBinds);
+            }
+            VkBuffer vertexBuffers[] = {mesh->vertexBuffer->GetBuffer(), batch->GetGpuBuffer()->GetBuffer()};
+            VkDeviceSize offsets[] = {mesh->vertexBufferOffset, 0};
+            vkCmdBindVertexBuffers(commandBuffer, 0, 2, vertexBuffers, offsets);
+            vkCmdBindIndexBuffer(commandBuffer, mesh->indexBuffer->GetBuffer(), mesh->indexBufferOffset, VK_INDEX_TYPE_UINT32);
+            stateBound = true;
+        };
+
+        // Consecutive visible chunks are contiguous in the instance buffer, so each run is one draw;
+        // with nothing culled the whole batch is a single instanced draw.
+        uint32_t draws = 0;
+        size_t runBegin = 0, runEnd = 0;
+        auto flushRun = [&]() {
+            if (runEnd == runBegin) return;
+            if (!stateBound) bindBatchState();
+            vkCmdDrawIndexed(commandBuffer, mesh->indexCount, static_cast<uint32_t>(runEnd - runBegin), 0, 0,
+                             static_cast<uint32_t>(runBegin));
+            m_InstancingStats.drawCalls++;
+            m_InstancingStats.instancesDrawn += runEnd - runBegin;
+            PerfCounters::Add(PerfCounter_DrawCalls);
+            PerfCounters::Add(PerfCounter_Triangles, static_cast<int64_t>(mesh->indexCount / 3) * static_cast<int64_t>(runEnd - runBegin));
+            ++draws;
+        };
+        for (size_t chunkIndex = chunkBegin; chunkIndex < chunkEnd; ++chunkIndex) {
+            bool visible = true;
+            if (frustum) {
+                glm::vec3 worldMin, worldMax;
+                TransformAABB(modelMatrix, chunks[chunkIndex].boundsMin, chunks[chunkIndex].boundsMax, worldMin, worldMax);
+                visible = frustum->IntersectsAABB(worldMin, worldMax);
+            }
+            size_t instanceBegin = chunkIndex * InstancedMeshComponent::InstancesPerChunk;
+            size_t instanceEnd = std::min(instanceBegin + InstancedMeshComponent::InstancesPerChunk, instanceCount);
+            if (visible) {
+                if (runEnd != instanceBegin) { flushRun(); runBegin = instanceBegin; }
+                runEnd = instanceEnd;
             } else {
-                 VKENG_WARN_ONCE("Material '{}' (Handle {}) has NULL descriptor set. Object might render incorrectly.", material.name, renderInfo.mesh->material);
-                 // Optionally bind a default material descriptor set here
+                m_InstancingStats.chunksCulled++;
             }
+        }
+        flushRun();
+        return draws;
+    }
 
-            VkBuffer vertexBuffers[] = {renderInfo.mesh->vertexBuffer->GetBuffer()};
-            VkDeviceSize offsets[] = {renderInfo.mesh->vertexBufferOffset};
-            vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
-            vkCmdBindIndexBuffer(commandBuffer, renderInfo.mesh->indexBuffer->GetBuffer(), renderInfo.mesh->indexBufferOffset, VK_INDEX_TYPE_UINT32);
-            vkCmdDrawIndexed(commandBuffer, renderInfo.mesh->indexCount, 1, 0, 0, 0);
+    uint32_t Renderer::DrawInstancedBatches(VkCommandBuffer commandBuffer, const InstancedRenderList& instancedBatches,
+                                            const Frustum* frustum, RenderQueue queue, DrawState& state) {
+        if (instancedBatches.empty()) return 0;
+        AssetManager& assetManager = ServiceLocator::GetAssetManager();
+        uint32_t draws = 0;
+        for (const InstancedRenderInfo& info : instancedBatches) {
+            if (!IsDrawable(info)) continue;
+            const Material& material = assetManager.GetMaterial(info.batch->GetMesh()->material);
+            if (IsTransparent(material) != (queue == RenderQueue::Transparent)) continue;
+            draws += DrawInstancedBatch(commandBuffer, info, material, frustum, 0, SIZE_MAX, state);
+            m_InstancingStats.batches++;
         }
+        return draws;
+    }
 
-        // Render ImGui
-        uiManager.RenderDrawData(commandBuffer);
+    uint32_t Renderer::DrawSortedTransparents(VkCommandBuffer commandBuffer, const RenderObjectList& renderables,
+                                              const ScratchVector<uint32_t>& jointOffsets, const InstancedRenderList& instancedBatches,
+                                              const Frustum* frustum, CameraComponent* camera, DrawState& state) {
+        AssetManager& assetManager = ServiceLocator::GetAssetManager();
+        // Objects sort by their bounds' center, instance batches per chunk, so a batch spread
+        // through the scene interleaves with what is around it.
+        struct SortedDraw {
+            float distanceSquared;
+            uint32_t index; // Into renderables, or instancedBatches when chunk is set
+            uint32_t chunk;
+        };
+        constexpr uint32_t NoChunk = UINT32_MAX;
+        ScratchVector<SortedDraw> sorted{ArenaAllocator<SortedDraw>(*renderables.get_allocator().GetArena())};
+        glm::vec3 eye = camera ? camera->GetPosition() : glm::vec3(0.0f);
+        auto distanceSquared = [&](const glm::vec3& point) { glm::vec3 d = point - eye; return glm::dot(d, d); };
+
+        for (size_t i = 0; i < renderables.size(); ++i) {
+            const RenderObjectInfo& renderInfo = renderables[i];
+            if (!IsDrawable(renderInfo) || !IsTransparent(assetManager.GetMaterial(renderInfo.mesh->material))) continue;
+            glm::vec3 localCenter = (renderInfo.mesh->boundsMin + renderInfo.mesh->boundsMax) * 0.5f;
+            glm::vec3 center = glm::vec3(renderInfo.transform->GetWorldMatrix() * glm::vec4(localCenter, 1.0f));
+            sorted.push_back({distanceSquared(center), static_cast<uint32_t>(i), NoChunk});
+        }
+        for (size_t i = 0; i < instancedBatches.size(); ++i) {
+            const InstancedRenderInfo& info = instancedBatches[i];
+            if (!IsDrawable(info) || !IsTransparent(assetManager.GetMaterial(info.batch->GetMesh()->material))) continue;
+            glm::mat4 modelMatrix = info.transform ? info.transform->GetWorldMatrix() : glm::mat4(1.0f);
+            info.batch->UpdateChunkBounds();
+            const auto& chunks = info.batch->GetChunks();
+            for (size_t chunkIndex = 0; chunkIndex < chunks.size(); ++chunkIndex) {
+                glm::vec3 worldMin, worldMax;
+                TransformAABB(modelMatrix, chunks[chunkIndex].boundsMin, chunks[chunkIndex].boundsMax, worldMin, worldMax);
+                if (frustum && !frustum->IntersectsAABB(worldMin, worldMax)) {
+                    m_InstancingStats.chunksCulled++;
+                    continue;
+                }
+                sorted.push_back({distanceSquared((worldMin + worldMax) * 0.5f), static_cast<uint32_t>(i), static_cast<uint32_t>(chunkIndex)});
+            }
+            m_InstancingStats.batches++;
+        }
 
-        vkCmdEndRenderPass(commandBuffer);
+        // Farthest first, so each layer blends over what is behind it.
+        std::sort(sorted.begin(), sorted.end(), [](const SortedDraw& a, const SortedDraw& b) {
+            return a.distanceSquared > b.distanceSquared;
+        });
+        uint32_t draws = 0;
+        for (const SortedDraw& draw : sorted) {
+            if (draw.chunk == NoChunk) {
+                const RenderObjectInfo& renderInfo = renderables[draw.index];
+                const Material& material = assetManager.GetMaterial(renderInfo.mesh->material);
+                if (DrawRenderObject(commandBuffer, renderInfo, material, jointOffsets[draw.index], state)) ++draws;
+            } else {
+                const InstancedRenderInfo& info = instancedBatches[draw.index];
+                const Material& material = assetManager.GetMaterial(info.batch->GetMesh()->material);
+                // Already culled above
+                draws += DrawInstancedBatch(commandBuffer, info, material, nullptr, draw.chunk, draw.chunk + 1, state);
+            }
+        }
+        return draws;
     }
 
     void Renderer::EndFrameAndPresent() {
         m_CommandManager->EndFrameRecording(m_CurrentFrameIndex); // Finalize command buffer recording
         VkCommandBuffer commandBuffer = m_CommandManager->GetCommandBuffers()[m_CurrentFrameIndex];
+        // Uploads recorded since the last frame go first on the same queue; their batch ends in a
+        // barrier, so submission order alone makes them visible to this frame. Copies on the transfer
+        // queue are submitted with it, and its wait and ownership acquires order them before the frame.
+        m_CommandManager->GetImmediateContext().Flush();
+
+        // This frame's persistently mapped buffers collect their writes; flush them once, before the GPU reads.
+        for (const std::vector<std::unique_ptr<VulkanBuffer>>* buffers :
+             {&m_UniformBuffers, &m_LightUniformBuffers, &m_InstanceStagingBuffers, &m_BoneMatrixBuffers}) {
+            const std::unique_ptr<VulkanBuffer>& buffer = (*buffers)[m_CurrentFrameIndex];
+            if (buffer) VK_CHECK(buffer->FlushWrites());
+        }
 
-        VkSubmitInfo submitInfo{};
-        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-        VkSemaphore waitSemaphores[] = {m_ImageAvailableSemaphores[m_CurrentFrameIndex]};
-        VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
-        submitInfo.waitSemaphoreCount = 1;
-        submitInfo.pWaitSemaphores = waitSemaphores;
-        submitInfo.pWaitDstStageMask = waitStages;
-        submitInfo.commandBufferCount = 1;
-        submitInfo.pCommandBuffers = &commandBuffer;
+        // Frame waits on the image acquire and on anything other queues were asked to finish first
+        // (work another queue produces for this frame, registered through WaitForQueueBeforeNextFrame).
+        QueueSubmitDesc submit;
+        submit.commandBuffers = &commandBuffer;
+        submit.commandBufferCount = 1;
+        submit.waits = m_PendingQueueWaits.data();
+        submit.waitCount = static_cast<uint32_t>(m_PendingQueueWaits.size());
+        submit.binaryWait = m_ImageAvailableSemaphores[m_CurrentFrameIndex];
+        submit.binaryWaitStages = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        submit.binarySignal = m_RenderFinishedSemaphores[m_CurrentFrameIndex];
+        submit.signal = m_VulkanContext->GetFramePoint(m_VulkanContext->GetCurrentFrame());
+        m_VulkanContext->Submit(QueueType::Graphics, submit);
+        m_PendingQueueWaits.clear();
+        m_FrameSlotFrames[m_CurrentFrameIndex] = submit.signal.value;
+        m_VulkanContext->AdvanceFrame();
         VkSemaphore signalSemaphores[] = {m_RenderFinishedSemaphores[m_CurrentFrameIndex]};
-        submitInfo.signalSemaphoreCount = 1;
-        submitInfo.pSignalSemaphores = signalSemaphores;
-
-        VK_CHECK(vkQueueSubmit(m_VulkanContext->graphicsQueue, 1, &submitInfo, m_InFlightFences[m_CurrentFrameIndex]));
 
         VkPresentInfoKHR presentInfo{};
         presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
@@ -324,7 +887,13 @@ namespace VulkEng {
         presentInfo.pSwapchains = swapChains;
         presentInfo.pImageIndices = &m_CurrentImageIndex;
 
-        VkResult result = vkQueuePresentKHR(m_VulkanContext->presentQueue, &presentInfo);
+        VkResult result;
+        if (m_VulkanContext->presentQueue == m_VulkanContext->graphicsQueue) {
+            auto queueLock = m_VulkanContext->LockQueue(QueueType::Graphics); // Other threads may submit to it
+            result = vkQueuePresentKHR(m_VulkanContext->presentQueue, &presentInfo);
+        } else {
+            result = vkQueuePresentKHR(m_VulkanContext->presentQueue, &presentInfo);
+        }
 
         if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || m_FramebufferResized) {
             m_FramebufferResized = true; // Ensure flag is set for next BeginFrame to handle
@@ -339,6 +908,8 @@ namespace VulkEng {
 
     void Renderer::WaitForDeviceIdle() {
         if (m_VulkanContext && m_VulkanContext->device != VK_NULL_HANDLE) {
+            // Submits pending one-off work too (and releases its staging), so nothing recorded is left unsubmitted.
+            if (m_CommandManager) m_CommandManager->GetImmediateContext().WaitIdle();
             vkDeviceWaitIdle(m_VulkanContext->device);
         }
     }
@@ -357,11 +928,12 @@ namespace VulkEng {
         m_DepthFormat = Utils::findSupportedFormat(
             m_VulkanContext->physicalDevice,
             {VK_FORMAT_D32_SFLOAT, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT},
-            VK_IMAGE_TILING_OPTIMAL, VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT);
+            VK_IMAGE_TILING_OPTIMAL, VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT);
 
         Utils::createImage(m_VulkanContext->device, m_VulkanContext->physicalDevice,
                            m_Swapchain->GetExtent().width, m_Swapchain->GetExtent().height, 1, VK_SAMPLE_COUNT_1_BIT,
-                           m_DepthFormat, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
+                           m_DepthFormat, VK_IMAGE_TILING_OPTIMAL,
+                           VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, // Sampled by particle collisions
                            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_DepthImage, m_DepthImageMemory);
         if(m_DepthImage == VK_NULL_HANDLE) throw std::runtime_error("Failed to create depth image.");
 
@@ -371,113 +943,530 @@ namespace VulkEng {
         VKENG_INFO("Depth Resources Created (Format: {}).", m_DepthFormat);
     }
 
+    void Renderer::CreateMsaaResources() {
+        if (m_MsaaSamples == VK_SAMPLE_COUNT_1_BIT) return; // The pass renders into the HDR target and m_DepthImage directly
+        VkExtent2D extent = m_Swapchain->GetExtent();
+        // Samples never leave the pass: only the resolved color and depth are stored.
+        Utils::createTransientImage(m_VulkanContext->device, m_VulkanContext->physicalDevice, extent.width, extent.height, m_MsaaSamples,
+                                    PostProcessStack::HdrFormat, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, m_MsaaColorImage, m_MsaaColorImageMemory);
+        m_MsaaColorImageView = Utils::createImageView(m_VulkanContext->device, m_MsaaColorImage, PostProcessStack::HdrFormat, VK_IMAGE_ASPECT_COLOR_BIT, 1);
+        Utils::createTransientImage(m_VulkanContext->device, m_VulkanContext->physicalDevice, extent.width, extent.height, m_MsaaSamples,
+                                    m_DepthFormat, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, m_MsaaDepthImage, m_MsaaDepthImageMemory);
+        m_MsaaDepthImageView = Utils::createImageView(m_VulkanContext->device, m_MsaaDepthImage, m_DepthFormat, VK_IMAGE_ASPECT_DEPTH_BIT, 1);
+        VKENG_INFO("MSAA Resources Created ({}x).", static_cast<uint32_t>(m_MsaaSamples));
+    }
+
+    void Renderer::CreateOitResources() {
+        VkExtent2D extent = m_Swapchain->GetExtent();
+        // Written and read within the scene pass only, so tile-based GPUs may never back them with memory.
+        // They share the depth buffer's sample count, as attachments of the same subpass.
+        VkImageUsageFlags usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT;
+        Utils::createTransientImage(m_VulkanContext->device, m_VulkanContext->physicalDevice, extent.width, extent.height, m_MsaaSamples,
+                                    OitAccumFormat, usage, m_OitAccumImage, m_OitAccumImageMemory);
+        m_OitAccumImageView = Utils::createImageView(m_VulkanContext->device, m_OitAccumImage, OitAccumFormat, VK_IMAGE_ASPECT_COLOR_BIT, 1);
+        Utils::createTransientImage(m_VulkanContext->device, m_VulkanContext->physicalDevice, extent.width, extent.height, m_MsaaSamples,
+                                    OitRevealageFormat, usage, m_OitRevealageImage, m_OitRevealageImageMemory);
+        m_OitRevealageImageView = Utils::createImageView(m_VulkanContext->device, m_OitRevealageImage, OitRevealageFormat, VK_IMAGE_ASPECT_COLOR_BIT, 1);
+
+        std::array<VkDescriptorImageInfo, 2> inputInfos = {{
+            {VK_NULL_HANDLE, m_OitAccumImageView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL},
+            {VK_NULL_HANDLE, m_OitRevealageImageView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL}}};
+        std::array<VkWriteDescriptorSet, 2> writes{};
+        for (uint32_t binding = 0; binding < writes.size(); ++binding) {
+            writes[binding] = {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
+            writes[binding].dstSet = m_OitCompositeSet; writes[binding].dstBinding = binding;
+            writes[binding].descriptorType = VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+            writes[binding].descriptorCount = 1; writes[binding].pImageInfo = &inputInfos[binding];
+        }
+        vkUpdateDescriptorSets(m_VulkanContext->device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+    }
+
+    VkPipeline Renderer::BuildOitCompositePipeline() const {
+        auto vertexShader = m_ShaderLibrary->Load("fullscreen.vert");
+        bool multisampled = m_MsaaSamples != VK_SAMPLE_COUNT_1_BIT;
+        auto fragmentShader = m_ShaderLibrary->Load("oit_composite.frag", multisampled ? std::vector<std::string>{"MULTISAMPLED"} : std::vector<std::string>{});
+        VkPipelineShaderStageCreateInfo shaderStages[2] = {
+            {VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO}, {VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO}};
+        shaderStages[0].stage = VK_SHADER_STAGE_VERTEX_BIT; shaderStages[0].module = m_ShaderLibrary->CreateModule(*vertexShader); shaderStages[0].pName = "main";
+        shaderStages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT; shaderStages[1].pName = "main";
+        uint32_t sampleCount = static_cast<uint32_t>(m_MsaaSamples);
+        VkSpecializationMapEntry sampleCountEntry{0, 0, sizeof(uint32_t)};
+        VkSpecializationInfo specialization{1, &sampleCountEntry, sizeof(uint32_t), &sampleCount};
+        if (multisampled) shaderStages[1].pSpecializationInfo = &specialization;
+        try {
+            shaderStages[1].module = m_ShaderLibrary->CreateModule(*fragmentShader);
+        } catch (...) {
+            vkDestroyShaderModule(m_VulkanContext->device, shaderStages[0].module, nullptr);
+            throw;
+        }
+
+        VkPipelineVertexInputStateCreateInfo vertexInputInfo{VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO}; // Fullscreen triangle from gl_VertexIndex
+        VkPipelineInputAssemblyStateCreateInfo inputAssembly{VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO};
+        inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+        VkPipelineViewportStateCreateInfo viewportState{VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO};
+        viewportState.viewportCount = 1; viewportState.scissorCount = 1; // Dynamic states
+        VkPipelineRasterizationStateCreateInfo rasterizer{VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO};
+        rasterizer.polygonMode = VK_POLYGON_MODE_FILL; rasterizer.lineWidth = 1.0f; rasterizer.cullMode = VK_CULL_MODE_NONE;
+        VkPipelineMultisampleStateCreateInfo multisampling{VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO};
+        multisampling.rasterizationSamples = m_MsaaSamples;
+        // The shader outputs the layers' average color with their combined coverage as alpha.
+        VkPipelineColorBlendAttachmentState colorBlendAttachment{};
+        colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+        colorBlendAttachment.blendEnable = VK_TRUE;
+        colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+        colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+        colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
+        colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+        colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+        colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
+        VkPipelineColorBlendStateCreateInfo colorBlending{VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO};
+        colorBlending.attachmentCount = 1; colorBlending.pAttachments = &colorBlendAttachment;
+        std::array<VkDynamicState, 2> dynamicStates = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+        VkPipelineDynamicStateCreateInfo dynamicStateInfo{VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO};
+        dynamicStateInfo.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size()); dynamicStateInfo.pDynamicStates = dynamicStates.data();
+
+        VkGraphicsPipelineCreateInfo pipelineInfo{VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO};
+        pipelineInfo.stageCount = 2; pipelineInfo.pStages = shaderStages;
+        pipelineInfo.pVertexInputState = &vertexInputInfo; pipelineInfo.pInputAssemblyState = &inputAssembly;
+        pipelineInfo.pViewportState = &viewportState; pipelineInfo.pRasterizationState = &rasterizer;
+        pipelineInfo.pMultisampleState = &multisampling; pipelineInfo.pColorBlendState = &colorBlending;
+        pipelineInfo.pDynamicState = &dynamicStateInfo;
+        pipelineInfo.layout = m_OitCompositeLayout;
+        pipelineInfo.renderPass = m_RenderPass; pipelineInfo.subpass = OitCompositeSubpass;
+        VkPipeline pipeline = VK_NULL_HANDLE;
+        VkResult result = vkCreateGraphicsPipelines(m_VulkanContext->device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline);
+        vkDestroyShaderModule(m_VulkanContext->device, shaderStages[0].module, nullptr);
+        vkDestroyShaderModule(m_VulkanContext->device, shaderStages[1].module, nullptr);
+        VK_CHECK(result);
+        return pipeline;
+    }
+
     void Renderer::CreateRenderPass() {
         VKENG_INFO("Creating Render Pass...");
-        VkAttachmentDescription colorAttachment{}; /* ... setup ... */
-        colorAttachment.format = m_Swapchain->GetImageFormat();
-        colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+        // Created through the render pass 2 entry points (core in Vulkan 1.2) for the depth resolve.
+        bool multisampled = m_MsaaSamples != VK_SAMPLE_COUNT_1_BIT;
+        VkAttachmentDescription2 colorAttachment{VK_STRUCTURE_TYPE_ATTACHMENT_DESCRIPTION_2};
+        colorAttachment.format = PostProcessStack::HdrFormat;
+        colorAttachment.samples = m_MsaaSamples;
         colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-        colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+        colorAttachment.storeOp = multisampled ? VK_ATTACHMENT_STORE_OP_DONT_CARE : VK_ATTACHMENT_STORE_OP_STORE; // Samples stay on-chip
         colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
         colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
         colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-        colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR; // For presentation after UI
+        colorAttachment.finalLayout = multisampled ? VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL
+                                                   : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL; // Sampled by post-processing
 
-        VkAttachmentReference colorAttachmentRef{}; /* ... setup ... */
-        colorAttachmentRef.attachment = 0;
+        VkAttachmentReference2 colorAttachmentRef{VK_STRUCTURE_TYPE_ATTACHMENT_REFERENCE_2};
+        colorAttachmentRef.attachment = SceneColorAttachment;
         colorAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        colorAttachmentRef.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
 
-        VkAttachmentDescription depthAttachment{}; /* ... setup ... */
+        VkAttachmentDescription2 depthAttachment{VK_STRUCTURE_TYPE_ATTACHMENT_DESCRIPTION_2};
         depthAttachment.format = m_DepthFormat;
-        depthAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+        depthAttachment.samples = m_MsaaSamples;
         depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-        depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE; // Don't need depth after pass for now
+        // Next frame's particle simulation collides against it (the resolved copy, with MSAA)
+        depthAttachment.storeOp = multisampled ? VK_ATTACHMENT_STORE_OP_DONT_CARE : VK_ATTACHMENT_STORE_OP_STORE;
         depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
         depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
         depthAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
         depthAttachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
 
-        VkAttachmentReference depthAttachmentRef{}; /* ... setup ... */
-        depthAttachmentRef.attachment = 1;
+        VkAttachmentReference2 depthAttachmentRef{VK_STRUCTURE_TYPE_ATTACHMENT_REFERENCE_2};
+        depthAttachmentRef.attachment = SceneDepthAttachment;
         depthAttachmentRef.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+        depthAttachmentRef.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+
+        // Weighted blended OIT targets only live within the pass.
+        VkAttachmentDescription2 oitAccumAttachment{VK_STRUCTURE_TYPE_ATTACHMENT_DESCRIPTION_2};
+        oitAccumAttachment.format = OitAccumFormat;
+        oitAccumAttachment.samples = m_MsaaSamples;
+        oitAccumAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+        oitAccumAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        oitAccumAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        oitAccumAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        oitAccumAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        oitAccumAttachment.finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        VkAttachmentDescription2 oitRevealageAttachment = oitAccumAttachment;
+        oitRevealageAttachment.format = OitRevealageFormat;
+
+        // MSAA only: single-sampled targets the last subpass using each attachment resolves into.
+        VkAttachmentDescription2 colorResolveAttachment{VK_STRUCTURE_TYPE_ATTACHMENT_DESCRIPTION_2};
+        colorResolveAttachment.format = PostProcessStack::HdrFormat;
+        colorResolveAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+        colorResolveAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        colorResolveAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+        colorResolveAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        colorResolveAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        colorResolveAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        colorResolveAttachment.finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL; // Sampled by post-processing
+        VkAttachmentDescription2 depthResolveAttachment = colorResolveAttachment;
+        depthResolveAttachment.format = m_DepthFormat;
+        depthResolveAttachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+        VkAttachmentReference2 colorResolveRef{VK_STRUCTURE_TYPE_ATTACHMENT_REFERENCE_2};
+        colorResolveRef.attachment = SceneColorResolveAttachment;
+        colorResolveRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        colorResolveRef.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        VkAttachmentReference2 depthResolveRef{VK_STRUCTURE_TYPE_ATTACHMENT_REFERENCE_2};
+        depthResolveRef.attachment = SceneDepthResolveAttachment;
+        depthResolveRef.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+        depthResolveRef.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+        // Sample zero is always supported, and exact for collisions (no averaged depths at edges).
+        VkSubpassDescriptionDepthStencilResolve depthResolve{VK_STRUCTURE_TYPE_SUBPASS_DESCRIPTION_DEPTH_STENCIL_RESOLVE};
+        depthResolve.depthResolveMode = VK_RESOLVE_MODE_SAMPLE_ZERO_BIT;
+        depthResolve.stencilResolveMode = VK_RESOLVE_MODE_NONE;
+        depthResolve.pDepthStencilResolveAttachment = &depthResolveRef;
+
+        std::array<VkAttachmentReference2, 2> oitOutputRefs{};
+        std::array<VkAttachmentReference2, 2> oitInputRefs{};
+        for (uint32_t i = 0; i < 2; ++i) {
+            uint32_t attachment = i == 0 ? OitAccumAttachment : OitRevealageAttachment;
+            oitOutputRefs[i] = {VK_STRUCTURE_TYPE_ATTACHMENT_REFERENCE_2, nullptr, attachment, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_ASPECT_COLOR_BIT};
+            oitInputRefs[i] = {VK_STRUCTURE_TYPE_ATTACHMENT_REFERENCE_2, nullptr, attachment, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_ASPECT_COLOR_BIT};
+        }
+        uint32_t preservedColor = SceneColorAttachment;
 
-        VkSubpassDescription subpass{}; /* ... setup ... */
-        subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+        std::array<VkSubpassDescription2, 3> subpasses{};
+        for (VkSubpassDescription2& description : subpasses) {
+            description.sType = VK_STRUCTURE_TYPE_SUBPASS_DESCRIPTION_2;
+            description.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+        }
+        VkSubpassDescription2& subpass = subpasses[OpaqueSubpass];
         subpass.colorAttachmentCount = 1;
         subpass.pColorAttachments = &colorAttachmentRef;
         subpass.pDepthStencilAttachment = &depthAttachmentRef;
-
-        VkSubpassDependency dependency{}; /* ... setup ... */
+        // Depth-tested against the opaque geometry; the pipelines don't write it.
+        VkSubpassDescription2& accumulateSubpass = subpasses[OitAccumulateSubpass];
+        accumulateSubpass.colorAttachmentCount = static_cast<uint32_t>(oitOutputRefs.size());
+        accumulateSubpass.pColorAttachments = oitOutputRefs.data();
+        accumulateSubpass.pDepthStencilAttachment = &depthAttachmentRef;
+        accumulateSubpass.preserveAttachmentCount = 1;
+        accumulateSubpass.pPreserveAttachments = &preservedColor;
+        if (multisampled) accumulateSubpass.pNext = &depthResolve; // Last use of depth
+        VkSubpassDescription2& compositeSubpass = subpasses[OitCompositeSubpass];
+        compositeSubpass.inputAttachmentCount = static_cast<uint32_t>(oitInputRefs.size());
+        compositeSubpass.pInputAttachments = oitInputRefs.data();
+        compositeSubpass.colorAttachmentCount = 1;
+        compositeSubpass.pColorAttachments = &colorAttachmentRef;
+        if (multisampled) compositeSubpass.pResolveAttachments = &colorResolveRef; // Last use of color
+
+        VkSubpassDependency2 dependency{VK_STRUCTURE_TYPE_SUBPASS_DEPENDENCY_2};
         dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
         dependency.dstSubpass = 0;
-        dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+        // The previous frame's post-processing reads the HDR target before it is cleared (or resolved into) again.
+        dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
         dependency.srcAccessMask = 0;
         dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
         dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
 
-
-        std::array<VkAttachmentDescription, 2> attachments = {colorAttachment, depthAttachment};
-        VkRenderPassCreateInfo renderPassInfo{}; /* ... setup ... */
-        renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-        renderPassInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
+        // The OIT draws test against the opaque depth.
+        VkSubpassDependency2 depthDependency{VK_STRUCTURE_TYPE_SUBPASS_DEPENDENCY_2};
+        depthDependency.srcSubpass = OpaqueSubpass;
+        depthDependency.dstSubpass = OitAccumulateSubpass;
+        depthDependency.srcStageMask = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+        depthDependency.srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+        depthDependency.dstStageMask = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+        depthDependency.dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT;
+        depthDependency.dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
+
+        // The composite reads the accumulation per pixel and blends onto the opaque color.
+        VkSubpassDependency2 accumulateDependency{VK_STRUCTURE_TYPE_SUBPASS_DEPENDENCY_2};
+        accumulateDependency.srcSubpass = OitAccumulateSubpass;
+        accumulateDependency.dstSubpass = OitCompositeSubpass;
+        accumulateDependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        accumulateDependency.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        accumulateDependency.dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+        accumulateDependency.dstAccessMask = VK_ACCESS_INPUT_ATTACHMENT_READ_BIT;
+        accumulateDependency.dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
+        VkSubpassDependency2 colorDependency{VK_STRUCTURE_TYPE_SUBPASS_DEPENDENCY_2};
+        colorDependency.srcSubpass = OpaqueSubpass;
+        colorDependency.dstSubpass = OitCompositeSubpass;
+        colorDependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        colorDependency.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        colorDependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        colorDependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        colorDependency.dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
+
+        // Scene color (written or resolved) is complete before the compute passes sample it
+        VkSubpassDependency2 postProcessDependency{VK_STRUCTURE_TYPE_SUBPASS_DEPENDENCY_2};
+        postProcessDependency.srcSubpass = OitCompositeSubpass;
+        postProcessDependency.dstSubpass = VK_SUBPASS_EXTERNAL;
+        postProcessDependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        postProcessDependency.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        postProcessDependency.dstStageMask = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+        postProcessDependency.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+        std::array<VkSubpassDependency2, 5> dependencies = {dependency, depthDependency, accumulateDependency, colorDependency, postProcessDependency};
+        std::array<VkAttachmentDescription2, 6> attachments = {colorAttachment, depthAttachment, oitAccumAttachment, oitRevealageAttachment,
+                                                               colorResolveAttachment, depthResolveAttachment};
+        VkRenderPassCreateInfo2 renderPassInfo{VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO_2};
+        renderPassInfo.attachmentCount = multisampled ? SceneDepthResolveAttachment + 1 : OitRevealageAttachment + 1;
         renderPassInfo.pAttachments = attachments.data();
+        renderPassInfo.subpassCount = static_cast<uint32_t>(subpasses.size());
+        renderPassInfo.pSubpasses = subpasses.data();
+        renderPassInfo.dependencyCount = static_cast<uint32_t>(dependencies.size());
+        renderPassInfo.pDependencies = dependencies.data();
+
+        VK_CHECK(vkCreateRenderPass2(m_VulkanContext->device, &renderPassInfo, nullptr, &m_RenderPass));
+        VKENG_INFO("Render Pass Created ({}x MSAA).", static_cast<uint32_t>(m_MsaaSamples));
+    }
+
+    void Renderer::CreatePresentRenderPass() {
+        VkAttachmentDescription colorAttachment{};
+        colorAttachment.format = m_Swapchain->GetImageFormat();
+        colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+        colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE; // The fullscreen triangle covers every pixel
+        colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+        colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+
+        VkAttachmentReference colorAttachmentRef{0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL};
+        VkSubpassDescription subpass{};
+        subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+        subpass.colorAttachmentCount = 1;
+        subpass.pColorAttachments = &colorAttachmentRef;
+
+        // Waits for the acquired image (the submit's semaphore wait is at color attachment output).
+        VkSubpassDependency dependency{};
+        dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
+        dependency.dstSubpass = 0;
+        dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        dependency.srcAccessMask = 0;
+        dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+
+        VkRenderPassCreateInfo renderPassInfo{VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO};
+        renderPassInfo.attachmentCount = 1;
+        renderPassInfo.pAttachments = &colorAttachment;
         renderPassInfo.subpassCount = 1;
         renderPassInfo.pSubpasses = &subpass;
         renderPassInfo.dependencyCount = 1;
         renderPassInfo.pDependencies = &dependency;
+        VK_CHECK(vkCreateRenderPass(m_VulkanContext->device, &renderPassInfo, nullptr, &m_PresentRenderPass));
+        VKENG_INFO("Present Render Pass Created.");
+    }
+
+    void Renderer::CreateUiRenderPass() {
+        VkAttachmentDescription colorAttachment{};
+        colorAttachment.format = PostProcessStack::UiLayerFormat;
+        colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+        colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR; // To transparent; ImGui only covers its windows
+        colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+        colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED; // Fully redrawn
+        colorAttachment.finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL; // Sampled by the present pass, this frame and later ones
+
+        VkAttachmentReference colorAttachmentRef{0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL};
+        VkSubpassDescription subpass{};
+        subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+        subpass.colorAttachmentCount = 1;
+        subpass.pColorAttachments = &colorAttachmentRef;
 
-        VK_CHECK(vkCreateRenderPass(m_VulkanContext->device, &renderPassInfo, nullptr, &m_RenderPass));
-        VKENG_INFO("Render Pass Created.");
+        // In: earlier frames' present passes may still be sampling the layer. Out: this frame's does.
+        std::array<VkSubpassDependency, 2> dependencies{};
+        dependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
+        dependencies[0].dstSubpass = 0;
+        dependencies[0].srcStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+        dependencies[0].srcAccessMask = 0; // Write-after-read only needs the execution dependency
+        dependencies[0].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        dependencies[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        dependencies[1].srcSubpass = 0;
+        dependencies[1].dstSubpass = VK_SUBPASS_EXTERNAL;
+        dependencies[1].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        dependencies[1].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        dependencies[1].dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+        dependencies[1].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+        VkRenderPassCreateInfo renderPassInfo{VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO};
+        renderPassInfo.attachmentCount = 1;
+        renderPassInfo.pAttachments = &colorAttachment;
+        renderPassInfo.subpassCount = 1;
+        renderPassInfo.pSubpasses = &subpass;
+        renderPassInfo.dependencyCount = static_cast<uint32_t>(dependencies.size());
+        renderPassInfo.pDependencies = dependencies.data();
+        VK_CHECK(vkCreateRenderPass(m_VulkanContext->device, &renderPassInfo, nullptr, &m_UiRenderPass));
+        VKENG_INFO("UI Render Pass Created.");
     }
 
     void Renderer::CreateDescriptorSetLayouts() {
-        VKENG_INFO("Creating Descriptor Set Layouts...");
-        // Layout 0: Frame Data (Camera UBO + Light UBO)
-        std::array<VkDescriptorSetLayoutBinding, 2> frameBindings = {};
-        frameBindings[0].binding = 0; // Camera UBO
-        frameBindings[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-        frameBindings[0].descriptorCount = 1;
-        frameBindings[0].stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
-        frameBindings[1].binding = 1; // Light UBO
-        frameBindings[1].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-        frameBindings[1].descriptorCount = 1;
-        frameBindings[1].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
-        VkDescriptorSetLayoutCreateInfo frameLayoutInfo{VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO};
-        frameLayoutInfo.bindingCount = static_cast<uint32_t>(frameBindings.size());
-        frameLayoutInfo.pBindings = frameBindings.data();
-        VK_CHECK(vkCreateDescriptorSetLayout(m_VulkanContext->device, &frameLayoutInfo, nullptr, &m_FrameDescriptorSetLayout));
-
-        // Layout 1: Material Texture Sampler
-        VkDescriptorSetLayoutBinding samplerLayoutBinding{};
-        samplerLayoutBinding.binding = 0; // Binding 0 within Set 1
-        samplerLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-        samplerLayoutBinding.descriptorCount = 1;
-        samplerLayoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
-        VkDescriptorSetLayoutCreateInfo materialLayoutInfo{VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO};
-        materialLayoutInfo.bindingCount = 1;
-        materialLayoutInfo.pBindings = &samplerLayoutBinding;
-        VK_CHECK(vkCreateDescriptorSetLayout(m_VulkanContext->device, &materialLayoutInfo, nullptr, &m_MaterialDescriptorSetLayout));
-        VKENG_INFO("Descriptor Set Layouts Created (Set0: Frame, Set1: Material).");
+        VKENG_INFO("Creating Descriptor Set Layouts from shader reflection...");
+        // Layouts are what the mesh shaders declare; the material variant with every feature covers
+        // all of Set 1. Hot reload keeps them, so shader edits that change a set's bindings need a restart.
+        auto simpleVert = m_ShaderLibrary->Load("simple.vert");
+        auto simpleFrag = m_ShaderLibrary->Load("simple.frag", MaterialShaderDefines(~MaterialFeatureMask(0)));
+        auto skinnedVert = m_ShaderLibrary->Load("skinned.vert");
+        // Layout 0: Frame Data (Camera UBO + Light UBO + BRDF table)
+        m_FrameDescriptorSetLayout = m_ShaderLibrary->CreateDescriptorSetLayout({simpleVert.get(), simpleFrag.get()}, 0);
+        // Layout 1: Material Textures (MaterialTextureBinding) + MaterialParams slot
+        m_MaterialDescriptorSetLayout = m_ShaderLibrary->CreateDescriptorSetLayout({simpleFrag.get()}, 1);
+        // Layout 2: Skinning matrices (storage buffer, read by the skinned vertex shader)
+        m_SkinDescriptorSetLayout = m_ShaderLibrary->CreateDescriptorSetLayout({skinnedVert.get()}, 2);
+        VKENG_INFO("Descriptor Set Layouts Created (Set0: Frame, Set1: Material, Set2: Skin).");
+    }
+
+    size_t Renderer::GraphicsPipelineKeyHash::operator()(const GraphicsPipelineKey& key) const {
+        uint64_t hash = HashBytes(&key.id, sizeof(key.id));
+        hash = HashBytes(&key.features, sizeof(key.features), hash);
+        hash = HashBytes(&key.alphaCutoff, sizeof(key.alphaCutoff), hash);
+        return static_cast<size_t>(HashBytes(&key.transparency, sizeof(key.transparency), hash));
+    }
+
+    const char* Renderer::GraphicsPipelineVertexShader(GraphicsPipelineId id) {
+        switch (id) {
+            case InstancedPipeline: return "instanced.vert";
+            case SkinnedPipeline:   return "skinned.vert";
+            default:                return "simple.vert";
+        }
+    }
+
+    std::vector<std::string> Renderer::MaterialShaderDefines(MaterialFeatureMask features) {
+        // Indexed by feature bit, see MaterialFeature.
+        static const char* const featureDefines[MaterialFeature::ShaderFeatureCount] = {
+            "NORMAL_MAP", "METALLIC_ROUGHNESS_MAP", "OCCLUSION_MAP", "EMISSIVE_MAP", "ALPHA_MASK"};
+        std::vector<std::string> defines;
+        for (uint32_t bit = 0; bit < MaterialFeature::ShaderFeatureCount; ++bit) {
+            if (features & (1u << bit)) defines.push_back(featureDefines[bit]);
+        }
+        return defines;
+    }
+
+    VkPipeline Renderer::GetGraphicsPipeline(GraphicsPipelineId id, const Material& material) {
+        GraphicsPipelineKey key{id, material.GetFeatures(), 0.0f};
+        if (key.features & MaterialFeature::AlphaMask) key.alphaCutoff = material.alphaCutoff;
+        if (key.features & MaterialFeature::AlphaBlend) key.transparency = m_TransparencyMode;
+        auto it = m_GraphicsPipelines.find(key);
+        if (it != m_GraphicsPipelines.end()) return it->second;
+
+        // First use of this permutation. Its shader variant comes from the library's cache when it
+        // has been compiled before, so this is mostly pipeline creation.
+        VkPipeline pipeline = VK_NULL_HANDLE;
+        try {
+            pipeline = BuildGraphicsPipeline(key);
+            VKENG_INFO("Renderer: Built pipeline permutation {} (features 0x{:x}) for material '{}'.",
+                       GraphicsPipelineVertexShader(id), key.features, material.name);
+        } catch (const std::exception& e) {
+            VKENG_ERROR("Renderer: Pipeline permutation {} (features 0x{:x}) failed: {}",
+                        GraphicsPipelineVertexShader(id), key.features, e.what());
+        }
+        m_GraphicsPipelines.emplace(key, pipeline); // Failures are cached too, rather than retried every frame
+        return pipeline;
     }
 
     void Renderer::CreateGraphicsPipeline() {
         VKENG_INFO("Creating Graphics Pipeline...");
-        auto vertShaderCode = ReadFile(SHADER_PATH_DEFINITION "simple.vert.spv");
-        auto fragShaderCode = ReadFile(SHADER_PATH_DEFINITION "simple.frag.spv");
-        VkShaderModule vertModule = CreateShaderModule(vertShaderCode);
-        VkShaderModule fragModule = CreateShaderModule(fragShaderCode);
-
-        VkPipelineShaderStageCreateInfo vertStageInfo{VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO}; /* ... setup ... */
-        vertStageInfo.stage = VK_SHADER_STAGE_VERTEX_BIT; vertStageInfo.module = vertModule; vertStageInfo.pName = "main";
-        VkPipelineShaderStageCreateInfo fragStageInfo{VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO}; /* ... setup ... */
-        fragStageInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT; fragStageInfo.module = fragModule; fragStageInfo.pName = "main";
-        VkPipelineShaderStageCreateInfo shaderStages[] = {vertStageInfo, fragStageInfo};
-
-        auto bindingDesc = Vertex::getBindingDescription();
+        std::array<VkDescriptorSetLayout, 2> setLayouts = {m_FrameDescriptorSetLayout, m_MaterialDescriptorSetLayout};
+        VkPushConstantRange pushConstantRange{};
+        pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT; pushConstantRange.offset = 0; pushConstantRange.size = sizeof(glm::mat4);
+        VkPipelineLayoutCreateInfo pipelineLayoutInfo{VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO}; /* ... setup ... */
+        pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(setLayouts.size());
+        pipelineLayoutInfo.pSetLayouts = setLayouts.data();
+        pipelineLayoutInfo.pushConstantRangeCount = 1; pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+        VK_CHECK(vkCreatePipelineLayout(m_VulkanContext->device, &pipelineLayoutInfo, nullptr, &m_PipelineLayout));
+
+        // Skinned layout: bone matrices in Set 2 and a joint offset after the model matrix.
+        std::array<VkDescriptorSetLayout, 3> skinnedSetLayouts = {m_FrameDescriptorSetLayout, m_MaterialDescriptorSetLayout, m_SkinDescriptorSetLayout};
+        VkPushConstantRange skinnedPushConstantRange{};
+        skinnedPushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT; skinnedPushConstantRange.offset = 0;
+        skinnedPushConstantRange.size = sizeof(SkinnedPushConstants);
+        VkPipelineLayoutCreateInfo skinnedLayoutInfo{VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO};
+        skinnedLayoutInfo.setLayoutCount = static_cast<uint32_t>(skinnedSetLayouts.size());
+        skinnedLayoutInfo.pSetLayouts = skinnedSetLayouts.data();
+        skinnedLayoutInfo.pushConstantRangeCount = 1; skinnedLayoutInfo.pPushConstantRanges = &skinnedPushConstantRange;
+        VK_CHECK(vkCreatePipelineLayout(m_VulkanContext->device, &skinnedLayoutInfo, nullptr, &m_SkinnedPipelineLayout));
+
+        // The featureless permutations always exist; others are rebuilt if they were in use before
+        // a swapchain recreation.
+        for (uint32_t i = 0; i < GraphicsPipelineCount; ++i) {
+            m_GraphicsPipelines.try_emplace(GraphicsPipelineKey{static_cast<GraphicsPipelineId>(i)}, VK_NULL_HANDLE);
+        }
+        std::vector<std::pair<const GraphicsPipelineKey*, VkPipeline*>> pipelines;
+        pipelines.reserve(m_GraphicsPipelines.size());
+        for (auto& [key, pipeline] : m_GraphicsPipelines) pipelines.push_back({&key, &pipeline});
+
+        // The pipelines (and the particle pipelines, last index) compile in parallel: pipeline
+        // creation is thread-safe on a device and the bulk of the renderer's startup time.
+        // Jobs only log exceptions, so they are carried back and rethrown on this thread.
+        const uint32_t jobCount = static_cast<uint32_t>(pipelines.size()) + 1;
+        std::vector<std::exception_ptr> errors(jobCount);
+        ServiceLocator::GetJobSystem().ParallelFor(jobCount, 1, [&](uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end; ++i) {
+                try {
+                    if (i < pipelines.size()) {
+                        *pipelines[i].second = BuildGraphicsPipeline(*pipelines[i].first);
+                    } else if (m_ParticleSystem) {
+                        m_ParticleSystem->CreatePipelines(m_RenderPass, m_ReversedZ, m_MsaaSamples);
+                    }
+                } catch (...) { errors[i] = std::current_exception(); }
+            }
+        });
+        // Only the featureless permutations and the particles are fatal; a broken material permutation
+        // just leaves its draws out, as on first use.
+        for (uint32_t i = 0; i < jobCount; ++i) {
+            if (!errors[i]) continue;
+            if (i == pipelines.size() || pipelines[i].first->features == 0) std::rethrow_exception(errors[i]);
+            try { std::rethrow_exception(errors[i]); }
+            catch (const std::exception& e) {
+                VKENG_ERROR("Renderer: Pipeline permutation {} (features 0x{:x}) failed: {}",
+                            GraphicsPipelineVertexShader(pipelines[i].first->id), pipelines[i].first->features, e.what());
+            }
+        }
+        VKENG_INFO("Graphics Pipelines Created ({} mesh permutations + particles).", pipelines.size());
+    }
+
+    VkPipeline Renderer::BuildGraphicsPipeline(const GraphicsPipelineKey& key) const {
+        auto vertexShader = m_ShaderLibrary->Load(GraphicsPipelineVertexShader(key.id));
+        // Weighted blended OIT writes accumulation and revealage instead of a color.
+        bool weightedOit = (key.features & MaterialFeature::AlphaBlend) && key.transparency == TransparencyMode::WeightedBlended;
+        std::vector<std::string> fragmentDefines = MaterialShaderDefines(key.features);
+        if (weightedOit) fragmentDefines.push_back("OIT_WEIGHTED");
+        auto fragmentShader = m_ShaderLibrary->Load("simple.frag", fragmentDefines);
+        // A shader reading past the push constants the renderer pushes would be invalid usage.
+        uint32_t pushConstantSize = key.id == SkinnedPipeline ? sizeof(SkinnedPushConstants) : sizeof(glm::mat4);
+        if (vertexShader->reflection.pushConstantSize > pushConstantSize || fragmentShader->reflection.pushConstantSize > pushConstantSize) {
+            throw std::runtime_error("Renderer: " + vertexShader->name + "/" + fragmentShader->name +
+                                     " declare more push constants than the renderer provides.");
+        }
+
+        // The alpha cutoff is a specialization constant, so masked materials share a shader variant.
+        VkSpecializationMapEntry cutoffEntry{0, 0, sizeof(float)};
+        VkSpecializationInfo specialization{1, &cutoffEntry, sizeof(float), &key.alphaCutoff};
+
+        VkPipelineShaderStageCreateInfo shaderStages[2] = {
+            {VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO}, {VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO}};
+        shaderStages[0].stage = VK_SHADER_STAGE_VERTEX_BIT; shaderStages[0].module = m_ShaderLibrary->CreateModule(*vertexShader); shaderStages[0].pName = "main";
+        shaderStages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT; shaderStages[1].pName = "main";
+        shaderStages[1].pSpecializationInfo = (key.features & MaterialFeature::AlphaMask) ? &specialization : nullptr;
+        try {
+            shaderStages[1].module = m_ShaderLibrary->CreateModule(*fragmentShader);
+        } catch (...) {
+            vkDestroyShaderModule(m_VulkanContext->device, shaderStages[0].module, nullptr);
+            throw;
+        }
+
+        // Vertex input: Vertex on binding 0, plus InstanceData (instanced) or SkinVertex (skinned) on binding 1.
+        std::vector<VkVertexInputBindingDescription> bindings = {Vertex::getBindingDescription()};
         auto attributeDesc = Vertex::getAttributeDescriptions();
+        std::vector<VkVertexInputAttributeDescription> attributes(attributeDesc.begin(), attributeDesc.end());
+        if (key.id == InstancedPipeline) {
+            bindings.push_back({1, sizeof(InstanceData), VK_VERTEX_INPUT_RATE_INSTANCE});
+            uint32_t nextLocation = static_cast<uint32_t>(attributes.size());
+            for (uint32_t row = 0; row < 3; ++row) {
+                attributes.push_back({nextLocation++, 1, VK_FORMAT_R32G32B32A32_SFLOAT,
+                                      static_cast<uint32_t>(offsetof(InstanceData, rows) + row * sizeof(glm::vec4))});
+            }
+            attributes.push_back({nextLocation++, 1, VK_FORMAT_R8G8B8A8_UNORM, static_cast<uint32_t>(offsetof(InstanceData, color))});
+        } else if (key.id == SkinnedPipeline) {
+            bindings.push_back(SkinVertex::getBindingDescription());
+            auto skinAttributeDesc = SkinVertex::getAttributeDescriptions();
+            attributes.insert(attributes.end(), skinAttributeDesc.begin(), skinAttributeDesc.end());
+        }
         VkPipelineVertexInputStateCreateInfo vertexInputInfo{VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO}; /* ... setup ... */
-        vertexInputInfo.vertexBindingDescriptionCount = 1; vertexInputInfo.pVertexBindingDescriptions = &bindingDesc;
-        vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDesc.size()); vertexInputInfo.pVertexAttributeDescriptions = attributeDesc.data();
+        vertexInputInfo.vertexBindingDescriptionCount = static_cast<uint32_t>(bindings.size()); vertexInputInfo.pVertexBindingDescriptions = bindings.data();
+        vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributes.size()); vertexInputInfo.pVertexAttributeDescriptions = attributes.data();
 
         VkPipelineInputAssemblyStateCreateInfo inputAssembly{VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO}; /* ... setup ... */
         inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST; inputAssembly.primitiveRestartEnable = VK_FALSE;
@@ -488,74 +1477,202 @@ namespace VulkEng {
         VkPipelineRasterizationStateCreateInfo rasterizer{VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO}; /* ... setup ... */
         rasterizer.depthClampEnable = VK_FALSE; rasterizer.rasterizerDiscardEnable = VK_FALSE;
         rasterizer.polygonMode = VK_POLYGON_MODE_FILL; rasterizer.lineWidth = 1.0f;
-        rasterizer.cullMode = VK_CULL_MODE_BACK_BIT; rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE; // Match GLM default
+        rasterizer.cullMode = (key.features & MaterialFeature::DoubleSided) ? VK_CULL_MODE_NONE : VK_CULL_MODE_BACK_BIT; rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE; // Match GLM default
         rasterizer.depthBiasEnable = VK_FALSE;
 
         VkPipelineMultisampleStateCreateInfo multisampling{VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO}; /* ... setup ... */
-        multisampling.sampleShadingEnable = VK_FALSE; multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+        multisampling.sampleShadingEnable = VK_FALSE; multisampling.rasterizationSamples = m_MsaaSamples;
 
         VkPipelineDepthStencilStateCreateInfo depthStencil{VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO}; /* ... setup ... */
-        depthStencil.depthTestEnable = VK_TRUE; depthStencil.depthWriteEnable = VK_TRUE;
-        depthStencil.depthCompareOp = VK_COMPARE_OP_LESS; depthStencil.depthBoundsTestEnable = VK_FALSE;
+        // Blended surfaces are tested against the opaque depth but don't occlude each other.
+        depthStencil.depthTestEnable = VK_TRUE; depthStencil.depthWriteEnable = (key.features & MaterialFeature::AlphaBlend) ? VK_FALSE : VK_TRUE;
+        depthStencil.depthCompareOp = m_ReversedZ ? VK_COMPARE_OP_GREATER : VK_COMPARE_OP_LESS;
+        depthStencil.depthBoundsTestEnable = VK_FALSE;
         depthStencil.stencilTestEnable = VK_FALSE;
 
-        VkPipelineColorBlendAttachmentState colorBlendAttachment{}; /* ... setup ... */
+        std::array<VkPipelineColorBlendAttachmentState, 2> colorBlendAttachments{}; /* ... setup ... */
+        VkPipelineColorBlendAttachmentState& colorBlendAttachment = colorBlendAttachments[0];
         colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
         colorBlendAttachment.blendEnable = VK_FALSE; // No blending for opaque
-        // For alpha blending:
-        // colorBlendAttachment.blendEnable = VK_TRUE;
-        // colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
-        // colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
-        // colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
-        // colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
-        // colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
-        // colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
-
+        if (weightedOit) {
+            // Accumulation adds up; revealage multiplies by (1 - alpha), the shader writing alpha.
+            colorBlendAttachment.blendEnable = VK_TRUE;
+            colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
+            colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE;
+            colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
+            colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+            colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+            colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
+            VkPipelineColorBlendAttachmentState& revealageAttachment = colorBlendAttachments[1];
+            revealageAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT;
+            revealageAttachment.blendEnable = VK_TRUE;
+            revealageAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_ZERO;
+            revealageAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_COLOR;
+            revealageAttachment.colorBlendOp = VK_BLEND_OP_ADD;
+            revealageAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+            revealageAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+            revealageAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
+        } else if (key.features & MaterialFeature::AlphaBlend) {
+            colorBlendAttachment.blendEnable = VK_TRUE;
+            colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+            colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+            colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
+            colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+            colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+            colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
+        }
 
         VkPipelineColorBlendStateCreateInfo colorBlending{VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO}; /* ... setup ... */
-        colorBlending.logicOpEnable = VK_FALSE; colorBlending.attachmentCount = 1; colorBlending.pAttachments = &colorBlendAttachment;
+        colorBlending.logicOpEnable = VK_FALSE; colorBlending.attachmentCount = weightedOit ? 2 : 1; colorBlending.pAttachments = colorBlendAttachments.data();
 
         std::vector<VkDynamicState> dynamicStates = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
         VkPipelineDynamicStateCreateInfo dynamicStateInfo{VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO}; /* ... setup ... */
         dynamicStateInfo.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size()); dynamicStateInfo.pDynamicStates = dynamicStates.data();
 
-        std::array<VkDescriptorSetLayout, 2> setLayouts = {m_FrameDescriptorSetLayout, m_MaterialDescriptorSetLayout};
-        VkPushConstantRange pushConstantRange{};
-        pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT; pushConstantRange.offset = 0; pushConstantRange.size = sizeof(glm::mat4);
-        VkPipelineLayoutCreateInfo pipelineLayoutInfo{VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO}; /* ... setup ... */
-        pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(setLayouts.size());
-        pipelineLayoutInfo.pSetLayouts = setLayouts.data();
-        pipelineLayoutInfo.pushConstantRangeCount = 1; pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
-        VK_CHECK(vkCreatePipelineLayout(m_VulkanContext->device, &pipelineLayoutInfo, nullptr, &m_PipelineLayout));
-
         VkGraphicsPipelineCreateInfo pipelineInfo{VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO}; /* ... setup ... */
         pipelineInfo.stageCount = 2; pipelineInfo.pStages = shaderStages;
         pipelineInfo.pVertexInputState = &vertexInputInfo; pipelineInfo.pInputAssemblyState = &inputAssembly;
         pipelineInfo.pViewportState = &viewportState; pipelineInfo.pRasterizationState = &rasterizer;
         pipelineInfo.pMultisampleState = &multisampling; pipelineInfo.pDepthStencilState = &depthStencil;
         pipelineInfo.pColorBlendState = &colorBlending; pipelineInfo.pDynamicState = &dynamicStateInfo;
-        pipelineInfo.layout = m_PipelineLayout; pipelineInfo.renderPass = m_RenderPass; pipelineInfo.subpass = 0;
-        VK_CHECK(vkCreateGraphicsPipelines(m_VulkanContext->device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_GraphicsPipeline));
+        pipelineInfo.layout = key.id == SkinnedPipeline ? m_SkinnedPipelineLayout : m_PipelineLayout;
+        pipelineInfo.renderPass = m_RenderPass; pipelineInfo.subpass = weightedOit ? OitAccumulateSubpass : OpaqueSubpass;
+
+        VkPipeline pipeline = VK_NULL_HANDLE;
+        VkResult result = vkCreateGraphicsPipelines(m_VulkanContext->device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline);
+        vkDestroyShaderModule(m_VulkanContext->device, shaderStages[0].module, nullptr);
+        vkDestroyShaderModule(m_VulkanContext->device, shaderStages[1].module, nullptr);
+        VK_CHECK(result);
+        return pipeline;
+    }
+
+    void Renderer::UpdateShaderHotReload() {
+        {
+            std::lock_guard<std::mutex> lock(m_ShaderReloadMutex);
+            for (const auto& [key, pipeline] : m_ReloadedPipelines) {
+                // Frames still in flight may use the old pipeline.
+                VkPipeline& slot = m_GraphicsPipelines[key];
+                if (slot != VK_NULL_HANDLE) m_RetiredPipelines.push_back({slot, m_VulkanContext->GetCurrentFrame()});
+                slot = pipeline;
+                VKENG_INFO("Renderer: Hot-reloaded {} + simple.frag (features 0x{:x}).", GraphicsPipelineVertexShader(key.id), key.features);
+            }
+            m_ReloadedPipelines.clear();
+            for (const PipelineReplacement& replacement : m_ReloadedFixedPipelines) {
+                if (*replacement.slot != VK_NULL_HANDLE) m_RetiredPipelines.push_back({*replacement.slot, m_VulkanContext->GetCurrentFrame()});
+                *replacement.slot = replacement.pipeline;
+                VKENG_INFO("Renderer: Hot-reloaded {}.", replacement.name);
+            }
+            m_ReloadedFixedPipelines.clear();
+        }
+        m_RetiredPipelines.erase(std::remove_if(m_RetiredPipelines.begin(), m_RetiredPipelines.end(), [&](const RetiredPipeline& retired) {
+            if (!m_VulkanContext->IsFrameComplete(retired.retireFrame)) return false;
+            vkDestroyPipeline(m_VulkanContext->device, retired.pipeline, nullptr);
+            return true;
+        }), m_RetiredPipelines.end());
+
+        // Polling only checks timestamps, but there is no need to do it every frame. While a
+        // rebuild is running, edits are left for the next poll.
+        auto now = std::chrono::steady_clock::now();
+        if (!m_ShaderLibrary->CanCompile() || !m_ShaderReloadJobs.IsDone() ||
+            now - m_LastShaderPoll < std::chrono::milliseconds(250)) {
+            return;
+        }
+        m_LastShaderPoll = now;
+        std::vector<std::string> changed = m_ShaderLibrary->PollChangedShaders();
+        if (changed.empty()) return;
+
+        auto isChanged = [&](const char* name) { return std::find(changed.begin(), changed.end(), name) != changed.end(); };
+        std::vector<GraphicsPipelineKey> affected;
+        for (const auto& [key, pipeline] : m_GraphicsPipelines) {
+            if (isChanged(GraphicsPipelineVertexShader(key.id)) || isChanged("simple.frag")) affected.push_back(key);
+        }
+        bool oitAffected = isChanged("fullscreen.vert") || isChanged("oit_composite.frag");
+
+        // Compiling and building happen off the main thread; frames keep using the old pipelines.
+        ServiceLocator::GetJobSystem().Submit([this, affected, oitAffected, changed]() {
+            // The post-processing passes, the present pass, the particle passes and the OIT composite take the same path.
+            std::vector<PipelineReplacement> fixed = m_PostProcess->BuildReloadedPipelines(changed);
+            if (m_ParticleSystem) {
+                std::vector<PipelineReplacement> particles = m_ParticleSystem->BuildReloadedPipelines(changed);
+                fixed.insert(fixed.end(), particles.begin(), particles.end());
+            }
+            if (oitAffected) {
+                try {
+                    fixed.push_back({&m_OitCompositePipeline, BuildOitCompositePipeline(), "fullscreen.vert + oit_composite.frag"});
+                } catch (const std::exception& e) {
+                    VKENG_ERROR("Renderer: Hot reload of fullscreen.vert + oit_composite.frag failed, keeping the old pipeline: {}", e.what());
+                }
+            }
+            if (!fixed.empty()) {
+                std::lock_guard<std::mutex> lock(m_ShaderReloadMutex);
+                m_ReloadedFixedPipelines.insert(m_ReloadedFixedPipelines.end(), fixed.begin(), fixed.end());
+            }
 
-        vkDestroyShaderModule(m_VulkanContext->device, fragModule, nullptr);
-        vkDestroyShaderModule(m_VulkanContext->device, vertModule, nullptr);
-        VKENG_INFO("Graphics Pipeline Created.");
+            for (const GraphicsPipelineKey& key : affected) {
+                try {
+                    VkPipeline pipeline = BuildGraphicsPipeline(key);
+                    std::lock_guard<std::mutex> lock(m_ShaderReloadMutex);
+                    m_ReloadedPipelines.push_back({key, pipeline});
+                } catch (const std::exception& e) {
+                    VKENG_ERROR("Renderer: Hot reload of {} + simple.frag (features 0x{:x}) failed, keeping the old pipeline: {}",
+                                GraphicsPipelineVertexShader(key.id), key.features, e.what());
+                }
+            }
+        }, &m_ShaderReloadJobs);
+    }
+
+    void Renderer::DestroyPendingShaderReloads() {
+        ServiceLocator::GetJobSystem().Wait(m_ShaderReloadJobs); // Reload jobs read the render pass and layouts
+        std::lock_guard<std::mutex> lock(m_ShaderReloadMutex);
+        for (const auto& [key, pipeline] : m_ReloadedPipelines) vkDestroyPipeline(m_VulkanContext->device, pipeline, nullptr);
+        m_ReloadedPipelines.clear();
+        // Swapped in rather than dropped, so compute pass edits aren't lost; the swapchain-dependent
+        // ones are rebuilt from the same sources next anyway.
+        for (const PipelineReplacement& replacement : m_ReloadedFixedPipelines) {
+            if (*replacement.slot != VK_NULL_HANDLE) vkDestroyPipeline(m_VulkanContext->device, *replacement.slot, nullptr);
+            *replacement.slot = replacement.pipeline;
+        }
+        m_ReloadedFixedPipelines.clear();
+        for (const RetiredPipeline& retired : m_RetiredPipelines) vkDestroyPipeline(m_VulkanContext->device, retired.pipeline, nullptr);
+        m_RetiredPipelines.clear();
     }
 
     void Renderer::CreateFramebuffers() {
         VKENG_INFO("Creating Framebuffers...");
+        bool multisampled = m_MsaaSamples != VK_SAMPLE_COUNT_1_BIT;
+        std::array<VkImageView, 6> sceneAttachments = {
+            multisampled ? m_MsaaColorImageView : m_PostProcess->GetHdrView(), multisampled ? m_MsaaDepthImageView : m_DepthImageView,
+            m_OitAccumImageView, m_OitRevealageImageView, m_PostProcess->GetHdrView(), m_DepthImageView};
+        VkFramebufferCreateInfo sceneFramebufferInfo{VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO};
+        sceneFramebufferInfo.renderPass = m_RenderPass;
+        sceneFramebufferInfo.attachmentCount = multisampled ? SceneDepthResolveAttachment + 1 : OitRevealageAttachment + 1;
+        sceneFramebufferInfo.pAttachments = sceneAttachments.data();
+        sceneFramebufferInfo.width = m_Swapchain->GetExtent().width;
+        sceneFramebufferInfo.height = m_Swapchain->GetExtent().height;
+        sceneFramebufferInfo.layers = 1;
+        VK_CHECK(vkCreateFramebuffer(m_VulkanContext->device, &sceneFramebufferInfo, nullptr, &m_SceneFramebuffer));
+
         m_SwapChainFramebuffers.resize(m_Swapchain->GetImageViews().size());
         for (size_t i = 0; i < m_Swapchain->GetImageViews().size(); i++) {
-            std::array<VkImageView, 2> attachments = {m_Swapchain->GetImageViews()[i], m_DepthImageView};
+            VkImageView attachment = m_Swapchain->GetImageViews()[i];
             VkFramebufferCreateInfo framebufferInfo{VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO}; /* ... setup ... */
-            framebufferInfo.renderPass = m_RenderPass;
-            framebufferInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
-            framebufferInfo.pAttachments = attachments.data();
+            framebufferInfo.renderPass = m_PresentRenderPass;
+            framebufferInfo.attachmentCount = 1;
+            framebufferInfo.pAttachments = &attachment;
             framebufferInfo.width = m_Swapchain->GetExtent().width;
             framebufferInfo.height = m_Swapchain->GetExtent().height;
             framebufferInfo.layers = 1;
             VK_CHECK(vkCreateFramebuffer(m_VulkanContext->device, &framebufferInfo, nullptr, &m_SwapChainFramebuffers[i]));
         }
+        VkImageView uiAttachment = m_PostProcess->GetUiLayerView();
+        VkFramebufferCreateInfo uiFramebufferInfo{VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO};
+        uiFramebufferInfo.renderPass = m_UiRenderPass;
+        uiFramebufferInfo.attachmentCount = 1;
+        uiFramebufferInfo.pAttachments = &uiAttachment;
+        uiFramebufferInfo.width = m_Swapchain->GetExtent().width;
+        uiFramebufferInfo.height = m_Swapchain->GetExtent().height;
+        uiFramebufferInfo.layers = 1;
+        VK_CHECK(vkCreateFramebuffer(m_VulkanContext->device, &uiFramebufferInfo, nullptr, &m_UiFramebuffer));
         VKENG_INFO("{} Framebuffers Created.", m_SwapChainFramebuffers.size());
     }
 
@@ -567,8 +1684,8 @@ namespace VulkEng {
             m_UniformBuffers[i] = std::make_unique<VulkanBuffer>(
                 *m_VulkanContext, bufferSize, 1,
                 VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-            VK_CHECK(m_UniformBuffers[i]->Map());
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                1, BufferMapping::Persistent);
         }
     }
     void Renderer::CreateLightUniformBuffers() { /* ... As in previous "Create Light Uniform Buffers" section ... */
@@ -579,8 +1696,8 @@ namespace VulkEng {
             m_LightUniformBuffers[i] = std::make_unique<VulkanBuffer>(
                 *m_VulkanContext, bufferSize, 1,
                 VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-            VK_CHECK(m_LightUniformBuffers[i]->Map());
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                1, BufferMapping::Persistent);
         }
     }
 
@@ -588,9 +1705,11 @@ namespace VulkEng {
         VKENG_INFO("Creating Descriptor Pool (Frame + Material)...");
         std::vector<VkDescriptorPoolSize> poolSizes = {
             {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT * 2)}, // Camera + Light
-            {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1000} // For materials
+            {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, MaxMaterials * MaterialTextureBindingCount + MAX_FRAMES_IN_FLIGHT * 3}, // Materials + BRDF table + environment
+            {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT) + MaxMaterials}, // Bone matrices + material params
+            {VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, 2} // OIT accumulation + revealage
         };
-        uint32_t maxTotalSets = MAX_FRAMES_IN_FLIGHT + 1000;
+        uint32_t maxTotalSets = MAX_FRAMES_IN_FLIGHT * 2 + MaxMaterials + 1;
         VkDescriptorPoolCreateInfo poolInfo{VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO};
         poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
         poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
@@ -600,6 +1719,46 @@ namespace VulkEng {
         VKENG_INFO("Descriptor Pool Created.");
     }
 
+    void Renderer::CreateBrdfLut() {
+        const uint32_t size = BrdfLut::DefaultSize;
+        std::vector<uint16_t> texels = BrdfLut::LoadOrGenerate(BrdfLutCachePath, size);
+        const VkFormat format = VK_FORMAT_R16G16_SFLOAT; // Sampled with linear filtering on every device
+        VkDeviceSize imageSize = texels.size() * sizeof(uint16_t);
+
+        auto stagingBuffer = std::make_unique<VulkanBuffer>(*m_VulkanContext, imageSize, 1,
+                                                            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                                            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        stagingBuffer->WriteToBuffer(texels.data(), imageSize);
+
+        VkDevice device = m_VulkanContext->device;
+        Utils::createImage(device, m_VulkanContext->physicalDevice, size, size, 1, VK_SAMPLE_COUNT_1_BIT,
+                           format, VK_IMAGE_TILING_OPTIMAL,
+                           VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+                           VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_BrdfLutImage, m_BrdfLutImageMemory);
+        {
+            ImmediateContext::Recording recording = m_CommandManager->GetImmediateContext().Record();
+            VkCommandBuffer commandBuffer = recording.GetCommandBuffer();
+            Utils::RecordTransitionImageLayout(commandBuffer, m_BrdfLutImage, format,
+                                               VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+            Utils::RecordCopyBufferToImage(commandBuffer, stagingBuffer->GetBuffer(), m_BrdfLutImage, size, size);
+            Utils::RecordTransitionImageLayout(commandBuffer, m_BrdfLutImage, format,
+                                               VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+            recording.KeepAlive(std::move(stagingBuffer));
+        }
+        m_BrdfLutImageView = Utils::createImageView(device, m_BrdfLutImage, format, VK_IMAGE_ASPECT_COLOR_BIT, 1);
+
+        VkSamplerCreateInfo samplerInfo{VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO};
+        samplerInfo.magFilter = VK_FILTER_LINEAR;
+        samplerInfo.minFilter = VK_FILTER_LINEAR;
+        samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+        samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE; // N.V and roughness end at the edges
+        samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerInfo.maxLod = 0.0f;
+        VK_CHECK(vkCreateSampler(device, &samplerInfo, nullptr, &m_BrdfLutSampler));
+        VKENG_INFO("BRDF Table Created ({}x{}).", size, size);
+    }
+
     void Renderer::CreateFrameDescriptorSets() { /* ... As in previous "CreateFrameDescriptorSets" for Camera + Light UBOs ... */
         VKENG_INFO("Creating Frame Descriptor Sets (Set 0 - Camera UBO + Light UBO)...");
         std::vector<VkDescriptorSetLayout> layouts(MAX_FRAMES_IN_FLIGHT, m_FrameDescriptorSetLayout);
@@ -611,20 +1770,152 @@ namespace VulkEng {
         VK_CHECK(vkAllocateDescriptorSets(m_VulkanContext->device, &allocInfo, m_FrameDescriptorSets.data()));
 
         for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-            VkDescriptorBufferInfo cameraInfo = m_UniformBuffers[i]->DescriptorInfo(sizeof(CameraMatricesUBO));
-            VkDescriptorBufferInfo lightInfo = m_LightUniformBuffers[i]->DescriptorInfo(sizeof(LightDataUBO));
-            std::array<VkWriteDescriptorSet, 2> writes{};
+            VkDescriptorBufferInfo cameraInfo = m_UniformBuffers[i]->GetDescriptorInfo(sizeof(CameraMatricesUBO));
+            VkDescriptorBufferInfo lightInfo = m_LightUniformBuffers[i]->GetDescriptorInfo(sizeof(LightDataUBO));
+            VkDescriptorImageInfo brdfLutInfo{m_BrdfLutSampler, m_BrdfLutImageView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
+            std::array<VkWriteDescriptorSet, 3> writes{};
             writes[0] = {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET}; /* ... setup for camera UBO binding 0 ... */
             writes[0].dstSet = m_FrameDescriptorSets[i]; writes[0].dstBinding = 0; writes[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
             writes[0].descriptorCount = 1; writes[0].pBufferInfo = &cameraInfo;
             writes[1] = {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET}; /* ... setup for light UBO binding 1 ... */
             writes[1].dstSet = m_FrameDescriptorSets[i]; writes[1].dstBinding = 1; writes[1].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
             writes[1].descriptorCount = 1; writes[1].pBufferInfo = &lightInfo;
+            writes[2] = {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
+            writes[2].dstSet = m_FrameDescriptorSets[i]; writes[2].dstBinding = 2; writes[2].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            writes[2].descriptorCount = 1; writes[2].pImageInfo = &brdfLutInfo;
             vkUpdateDescriptorSets(m_VulkanContext->device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
         }
+        WriteEnvironmentDescriptors();
         VKENG_INFO("Frame Descriptor Sets Updated.");
     }
 
+    void Renderer::CreateDefaultEnvironment() {
+        // One white texel per face: the shader's ambient scale alone then gives the flat ambient.
+        const uint16_t one = glm::packHalf1x16(1.0f);
+        std::vector<uint16_t> white(6 * 4, one);
+        CreateEnvironmentCube(1, 1, white, m_IrradianceCube);
+        CreateEnvironmentCube(1, 1, white, m_SpecularCube);
+
+        VkSamplerCreateInfo samplerInfo{VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO};
+        samplerInfo.magFilter = VK_FILTER_LINEAR;
+        samplerInfo.minFilter = VK_FILTER_LINEAR;
+        samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR; // Blends between prefiltered roughness levels
+        samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerInfo.maxLod = VK_LOD_CLAMP_NONE;
+        VK_CHECK(vkCreateSampler(m_VulkanContext->device, &samplerInfo, nullptr, &m_EnvironmentSampler));
+    }
+
+    void Renderer::SetEnvironmentLighting(const EnvironmentLightingData& data, float intensity) {
+        WaitForDeviceIdle(); // The old cubes may still be sampled by frames in flight
+        DestroyEnvironmentCube(m_IrradianceCube);
+        DestroyEnvironmentCube(m_SpecularCube);
+        CreateEnvironmentCube(data.irradianceSize, 1, data.irradiance, m_IrradianceCube);
+        CreateEnvironmentCube(data.specularSize, data.specularMipCount, data.specular, m_SpecularCube);
+        WriteEnvironmentDescriptors();
+        m_HasEnvironment = true;
+        m_EnvironmentIntensity = intensity;
+        m_SpecularMipCount = data.specularMipCount;
+        VKENG_INFO("Renderer: Environment lighting set ({} irradiance, {} specular, {} mips).",
+                   data.irradianceSize, data.specularSize, data.specularMipCount);
+    }
+
+    void Renderer::CreateEnvironmentCube(uint32_t size, uint32_t mipCount, const std::vector<uint16_t>& texels, EnvironmentCube& outCube) {
+        const VkFormat format = VK_FORMAT_R16G16B16A16_SFLOAT;
+        const VkDeviceSize texelSize = 4 * sizeof(uint16_t);
+        VkDeviceSize imageSize = texels.size() * sizeof(uint16_t);
+
+        auto stagingBuffer = std::make_unique<VulkanBuffer>(*m_VulkanContext, imageSize, 1,
+                                                            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                                            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        stagingBuffer->WriteToBuffer(texels.data(), imageSize);
+
+        VkDevice device = m_VulkanContext->device;
+        Utils::createImage(device, m_VulkanContext->physicalDevice, size, size, mipCount, VK_SAMPLE_COUNT_1_BIT,
+                           format, VK_IMAGE_TILING_OPTIMAL,
+                           VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+                           VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, outCube.image, outCube.memory,
+                           6, VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT);
+
+        // The texels are mip after mip, each holding its six faces back to back: one region per mip.
+        std::vector<VkBufferImageCopy> regions(mipCount);
+        VkDeviceSize offset = 0;
+        for (uint32_t mip = 0; mip < mipCount; ++mip) {
+            uint32_t mipSize = std::max(size >> mip, 1u);
+            VkBufferImageCopy& region = regions[mip];
+            region.bufferOffset = offset;
+            region.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, mip, 0, 6};
+            region.imageExtent = {mipSize, mipSize, 1};
+            offset += 6 * static_cast<VkDeviceSize>(mipSize) * mipSize * texelSize;
+        }
+        if (offset != imageSize) {
+            VKENG_ERROR("Renderer: Environment cube data is {} bytes, expected {}.", imageSize, offset);
+        }
+        {
+            ImmediateContext::Recording recording = m_CommandManager->GetImmediateContext().Record();
+            VkCommandBuffer commandBuffer = recording.GetCommandBuffer();
+            Utils::RecordTransitionImageLayout(commandBuffer, outCube.image, format,
+                                               VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, mipCount, 0, 6);
+            vkCmdCopyBufferToImage(commandBuffer, stagingBuffer->GetBuffer(), outCube.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                   static_cast<uint32_t>(regions.size()), regions.data());
+            Utils::RecordTransitionImageLayout(commandBuffer, outCube.image, format,
+                                               VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, mipCount, 0, 6);
+            recording.KeepAlive(std::move(stagingBuffer));
+        }
+        outCube.view = Utils::createImageView(device, outCube.image, format, VK_IMAGE_ASPECT_COLOR_BIT, mipCount,
+                                              VK_IMAGE_VIEW_TYPE_CUBE, 6);
+    }
+
+    void Renderer::DestroyEnvironmentCube(EnvironmentCube& cube) {
+        VkDevice device = m_VulkanContext->device;
+        if (cube.view != VK_NULL_HANDLE) vkDestroyImageView(device, cube.view, nullptr);
+        if (cube.image != VK_NULL_HANDLE) vkDestroyImage(device, cube.image, nullptr);
+        if (cube.memory != VK_NULL_HANDLE) vkFreeMemory(device, cube.memory, nullptr);
+        cube = EnvironmentCube{};
+    }
+
+    void Renderer::WriteEnvironmentDescriptors() {
+        VkDescriptorImageInfo irradianceInfo{m_EnvironmentSampler, m_IrradianceCube.view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
+        VkDescriptorImageInfo specularInfo{m_EnvironmentSampler, m_SpecularCube.view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
+        for (VkDescriptorSet frameSet : m_FrameDescriptorSets) {
+            std::array<VkWriteDescriptorSet, 2> writes{};
+            writes[0] = {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
+            writes[0].dstSet = frameSet; writes[0].dstBinding = 3; writes[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            writes[0].descriptorCount = 1; writes[0].pImageInfo = &irradianceInfo;
+            writes[1] = {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
+            writes[1].dstSet = frameSet; writes[1].dstBinding = 4; writes[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            writes[1].descriptorCount = 1; writes[1].pImageInfo = &specularInfo;
+            vkUpdateDescriptorSets(m_VulkanContext->device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+        }
+    }
+
+    void Renderer::CreateSkinDescriptorSets() {
+        std::vector<VkDescriptorSetLayout> layouts(MAX_FRAMES_IN_FLIGHT, m_SkinDescriptorSetLayout);
+        VkDescriptorSetAllocateInfo allocInfo{VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO};
+        allocInfo.descriptorPool = m_DescriptorPool;
+        allocInfo.descriptorSetCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
+        allocInfo.pSetLayouts = layouts.data();
+        m_SkinDescriptorSets.resize(MAX_FRAMES_IN_FLIGHT);
+        VK_CHECK(vkAllocateDescriptorSets(m_VulkanContext->device, &allocInfo, m_SkinDescriptorSets.data()));
+        m_BoneMatrixBuffers.resize(MAX_FRAMES_IN_FLIGHT); // Written when the buffers are created (UploadSkinningMatrices)
+    }
+
+    void Renderer::CreateOitCompositeLayout() {
+        auto compositeShader = m_ShaderLibrary->Load("oit_composite.frag");
+        m_OitCompositeSetLayout = m_ShaderLibrary->CreateDescriptorSetLayout({compositeShader.get()}, 0);
+        VkPipelineLayoutCreateInfo layoutInfo{VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO};
+        layoutInfo.setLayoutCount = 1;
+        layoutInfo.pSetLayouts = &m_OitCompositeSetLayout;
+        VK_CHECK(vkCreatePipelineLayout(m_VulkanContext->device, &layoutInfo, nullptr, &m_OitCompositeLayout));
+
+        VkDescriptorSetAllocateInfo allocInfo{VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO};
+        allocInfo.descriptorPool = m_DescriptorPool;
+        allocInfo.descriptorSetCount = 1;
+        allocInfo.pSetLayouts = &m_OitCompositeSetLayout;
+        VK_CHECK(vkAllocateDescriptorSets(m_VulkanContext->device, &allocInfo, &m_OitCompositeSet)); // Written by CreateOitResources
+    }
+
 
     // --- Per-Frame Updates ---
     void Renderer::UpdateCameraUBO(uint32_t currentFrameIndex, const glm::mat4& view, const glm::mat4& proj) {
@@ -635,27 +1926,12 @@ namespace VulkEng {
         LightDataUBO ubo{};
         ubo.direction = glm::vec4(m_LightDirection, 0.0f);
         ubo.color = glm::vec4(m_LightColor * m_LightIntensity, m_LightIntensity); // Store intensity in alpha too
+        if (m_HasEnvironment) {
+            ubo.ambient = glm::vec4(glm::vec3(m_EnvironmentIntensity), static_cast<float>(m_SpecularMipCount - 1));
+        } else {
+            ubo.ambient = glm::vec4(0.15f * m_LightColor * m_LightIntensity, 0.0f); // Flat ambient through the white cubes
+        }
         m_LightUniformBuffers[currentFrameIndex]->WriteToBuffer(&ubo, sizeof(ubo));
     }
 
-    // --- Shader Loading Helpers ---
-    std::vector<char> Renderer::ReadFile(const std::string& filename) {
-        std::ifstream file(filename, std::ios::ate | std::ios::binary);
-        if (!file.is_open()) throw std::runtime_error("failed to open file: " + filename);
-        size_t fileSize = static_cast<size_t>(file.tellg());
-        std::vector<char> buffer(fileSize);
-        file.seekg(0);
-        file.read(buffer.data(), fileSize);
-        file.close();
-        return buffer;
-    }
-    VkShaderModule Renderer::CreateShaderModule(const std::vector<char>& code) {
-        VkShaderModuleCreateInfo createInfo{VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO};
-        createInfo.codeSize = code.size();
-        createInfo.pCode = reinterpret_cast<const uint32_t*>(code.data());
-        VkShaderModule shaderModule;
-        VK_CHECK(vkCreateShaderModule(m_VulkanContext->device, &createInfo, nullptr, &shaderModule));
-        return shaderModule;
-    }
-
 } // namespace VulkEng
@@ -4,9 +4,21 @@
 #include "Swapchain.h"
 #include "CommandManager.h"
 #include "graphics/Buffer.h" // For VulkanBuffer (used for UBOs)
+#include "core/FrameArena.h"   // For RenderObjectList storage
+#include "GpuParticleSystem.h" // For ParticleRenderList, ParticleStats
+#include "ShaderLibrary.h"
+#include "assets/Material.h"   // For MaterialFeatureMask (pipeline permutations)
+#include "core/JobSystem.h"    // For JobCounter (shader hot reload)
+#include "IblBaker.h"          // For EnvironmentLightingData
+#include "PostProcessStack.h"  // For PostProcessSettings, PostProcessStats
 
 #include <glm/glm.hpp>
+#include <array>
+#include <chrono>
 #include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility> // For std::pair
 #include <vector>
 #include <string>
 #include <vulkan/vulkan.h>
@@ -17,6 +29,8 @@ namespace VulkEng {
     struct Mesh;        // For RenderObjectInfo
     class CameraComponent; // For camera data
     class TransformComponent; // For RenderObjectInfo
+    class InstancedMeshComponent; // For InstancedRenderInfo
+    struct Frustum;               // For instanced chunk culling
     // class AssetManager; // If Renderer needs to interact directly (usually not for drawing)
     // class UIManager;    // If Renderer needs to interact directly (usually Application orchestrates)
 }
@@ -39,14 +53,52 @@ namespace VulkEng {
     struct LightDataUBO {
          alignas(16) glm::vec4 direction; // w component often unused, or for type/intensity flag
          alignas(16) glm::vec4 color;     // rgb for color, a for intensity
+         alignas(16) glm::vec4 ambient;   // rgb scales the environment maps, a is the specular map's last mip
     };
 
     // Struct to pass necessary information for rendering an object
     struct RenderObjectInfo {
         Mesh* mesh = nullptr;                // Pointer to the mesh data (vertices, indices, material handle)
         TransformComponent* transform = nullptr; // Pointer to the object's transform for model matrix
+        // Skinned meshes only: the AnimatorComponent's skinning matrices, valid until RecordCommands returns.
+        const glm::mat4* skinningMatrices = nullptr;
+        uint32_t jointCount = 0;
     };
 
+    // Per-frame list of renderables. Storage comes from the caller's FrameArena, so building it
+    // each frame does not touch the heap.
+    using RenderObjectList = ScratchVector<RenderObjectInfo>;
+
+    // An instance batch to draw; `transform` places the whole batch (identity if null).
+    struct InstancedRenderInfo {
+        InstancedMeshComponent* batch = nullptr;
+        TransformComponent* transform = nullptr;
+    };
+    using InstancedRenderList = ScratchVector<InstancedRenderInfo>;
+
+    // Instanced drawing counters for the last recorded frame.
+    struct InstancingStats {
+        uint32_t batches = 0;
+        uint32_t drawCalls = 0;
+        uint32_t chunksCulled = 0;
+        uint64_t instancesDrawn = 0;
+        uint64_t bytesUploaded = 0;
+    };
+
+    // How blended materials (Material::AlphaMode::BLEND) are composited over the opaque scene.
+    enum class TransparencyMode : uint32_t {
+        // Drawn back to front after the opaque geometry. Ordered per object and per instance chunk;
+        // instances within a chunk are not sorted.
+        Sorted,
+        // Weighted blended order-independent transparency: no sorting, accumulated in a subpass and
+        // composited once. Approximate where many similar layers overlap.
+        WeightedBlended,
+    };
+
+    // Multisample anti-aliasing presets, cheapest first: 1x, 2x, 4x and 8x samples, clamped to the
+    // most the device supports for both color and depth attachments.
+    enum class MsaaPreset : uint32_t { Off, Performance, Balanced, Quality };
+
 
     class Renderer {
     public:
@@ -64,8 +116,9 @@ namespace VulkEng {
         virtual bool BeginFrame();
 
         // Records all draw commands for the current frame.
-        // Takes a list of objects to render and the active camera.
-        virtual void RecordCommands(const std::vector<RenderObjectInfo>& renderables, CameraComponent* camera);
+        // Takes a list of objects to render, the instance batches, the particle emitters and the active camera.
+        virtual void RecordCommands(const RenderObjectList& renderables, const InstancedRenderList& instancedBatches,
+                                    const ParticleRenderList& particleEmitters, CameraComponent* camera);
 
         // Submits the recorded command buffer and presents the frame.
         virtual void EndFrameAndPresent();
@@ -76,15 +129,46 @@ namespace VulkEng {
         virtual void HandleResize(int width, int height);
         // Waits for the GPU to finish all pending operations.
         virtual void WaitForDeviceIdle();
+        // Depth convention of the camera being rendered (CameraComponent::IsReversedZ). Changing it
+        // rebuilds the pipelines (waits for the GPU), so call it before BeginFrame.
+        virtual void SetReversedZ(bool reversedZ);
+        bool IsReversedZ() const { return m_ReversedZ; }
+        // Makes the next frame's graphics work (from `stages` on) wait for work on another queue,
+        // e.g., a transfer-queue upload or async compute whose results the frame reads.
+        void WaitForQueueBeforeNextFrame(const GpuTimelinePoint& point, VkPipelineStageFlags stages);
+        // Replaces the ambient term with image-based lighting from a baked environment (see IblBaker),
+        // scaled by `intensity`. Uploads the maps and waits for the GPU, so call it between frames.
+        void SetEnvironmentLighting(const EnvironmentLightingData& data, float intensity = 1.0f);
+        // Applies from the next recorded frame; the other mode's pipelines are built on first use.
+        void SetTransparencyMode(TransparencyMode mode) { m_TransparencyMode = mode; }
+        TransparencyMode GetTransparencyMode() const { return m_TransparencyMode; }
+        // Rebuilds the scene targets and pipelines for the preset's sample count (waits for the GPU),
+        // so call it before BeginFrame. No-op if the effective sample count doesn't change.
+        void SetMsaaPreset(MsaaPreset preset);
+        MsaaPreset GetMsaaPreset() const { return m_MsaaPreset; }
+        VkSampleCountFlagBits GetMsaaSamples() const { return m_MsaaSamples; }
+        VkSampleCountFlagBits GetMaxMsaaSamples() const { return m_MaxMsaaSamples; }
 
         VulkanContext& GetContext() { return *m_VulkanContext; } // Allow access to Vulkan context
         // Provides the current command buffer (for systems like UIManager to record into)
         virtual VkCommandBuffer GetCurrentCommandBuffer();
-        // Provides the main render pass (needed by UIManager for ImGui integration)
-        virtual VkRenderPass GetMainRenderPass() const { return m_RenderPass; }
+        // Provides the render pass the UI draws in (needed by UIManager for ImGui integration): the
+        // UI layer pass, composited over the post-processed scene by the present pass
+        virtual VkRenderPass GetMainRenderPass() const { return m_UiRenderPass; }
         // Provides the command manager instance (e.g., for AssetManager buffer creation)
         virtual CommandManager& GetCommandManagerInstance() { return *m_CommandManager; }
 
+        const InstancingStats& GetInstancingStats() const { return m_InstancingStats; }
+        ParticleStats GetParticleStats() const { return m_ParticleSystem ? m_ParticleSystem->GetStats() : ParticleStats{}; }
+        // Checks the GPU particle passes against the CPU reference (see GpuParticleSystem::ValidateAgainstReference).
+        ParticleValidationResult ValidateParticles(const ParticleEmitParams& params, uint32_t steps) {
+            return m_ParticleSystem ? m_ParticleSystem->ValidateAgainstReference(m_CommandManager->GetImmediateContext(), params, steps)
+                                    : ParticleValidationResult{};
+        }
+        // Post-processing switches, applied from the next recorded frame.
+        PostProcessSettings& GetPostProcessSettings() { return m_PostProcess->GetSettings(); }
+        PostProcessStats GetPostProcessStats() const { return m_PostProcess ? m_PostProcess->GetStats() : PostProcessStats{}; }
+
 
     // Make members protected if derived classes (like NullRenderer) need direct access
     // Or provide protected getters. For now, keeping private as NullRenderer uses skipInit logic.
@@ -94,19 +178,29 @@ namespace VulkEng {
         void InitVulkan(); // Main initialization sequence
 
         // --- Resource Creation ---
-        void CreateSyncObjects();         // Semaphores and Fences for frame synchronization
-        void CreateDescriptorSetLayouts();// For Set 0 (Frame: Camera, Light) and Set 1 (Material: Texture)
+        void CreateSyncObjects();         // Swapchain semaphores (frame pacing uses the context's frame timeline)
+        void CreateDescriptorSetLayouts();// For Set 0 (Frame: Camera, Light, BRDF table), Set 1 (Material: Textures, params) and Set 2 (Skin: bone matrices)
         void CreateUniformBuffers();      // For CameraMatricesUBO
         void CreateLightUniformBuffers(); // For LightDataUBO
         void CreateDescriptorPool();      // Pool for allocating descriptor sets
+        void CreateBrdfLut();             // Split-sum BRDF table for Set 0, from the disk cache (or integrated once)
+        void CreateDefaultEnvironment();  // 1x1 white cubes for Set 0 until an environment is set
         void CreateFrameDescriptorSets(); // Descriptor sets for Set 0 (per frame in flight)
                                           // Material descriptor sets (Set 1) are created by AssetManager
+        void CreateSkinDescriptorSets();  // Set 2 (per frame in flight); buffers are created on first use
+        void CreateOitCompositeLayout();  // Input attachment set + pipeline layout for the OIT composite
 
         // Swapchain-dependent resources (recreated on resize)
         void CreateSwapchainDependents();
-        void CreateRenderPass();
-        void CreateGraphicsPipeline();    // Uses both descriptor set layouts for its pipeline layout
+        void CreateRenderPass();          // Scene pass into the HDR target
+        void CreatePresentRenderPass();   // Post-processed image + UI layer into the swapchain image
+        void CreateUiRenderPass();        // ImGui into the retained UI layer
+        void CreateGraphicsPipeline();    // Pipeline layouts, then every known mesh pipeline permutation (in parallel)
         void CreateDepthResources();
+        void CreateOitResources();        // Accumulation targets, and points the composite set at them
+        void CreateMsaaResources();       // Multisampled color and depth, resolved into the HDR target and depth image
+        // Thread-safe, like BuildGraphicsPipeline.
+        VkPipeline BuildOitCompositePipeline() const;
         void CreateFramebuffers();
 
         // --- Resource Cleanup ---
@@ -116,10 +210,72 @@ namespace VulkEng {
         // --- Per-Frame Updates ---
         void UpdateCameraUBO(uint32_t currentFrameIndex, const glm::mat4& view, const glm::mat4& proj);
         void UpdateLightUBO(uint32_t currentFrameIndex);
-
-        // Shader loading helpers
-        static std::vector<char> ReadFile(const std::string& filename);
-        VkShaderModule CreateShaderModule(const std::vector<char>& code);
+        // Copies dirty instance ranges to the batches' GPU buffers; recorded before the render pass.
+        void UploadInstanceData(VkCommandBuffer commandBuffer, const InstancedRenderList& instancedBatches);
+        // Copies every skinned object's matrices into this frame's bone buffer; outJointOffsets gets
+        // each renderable's first joint (parallel to `renderables`), so skinned draws can come in any order.
+        void UploadSkinningMatrices(const RenderObjectList& renderables, ScratchVector<uint32_t>& outJointOffsets);
+
+        // --- Mesh Pipelines ---
+        // A pipeline is a permutation of a geometry kind and a material's features (MaterialFeature).
+        // Permutations are built on first use and cached; each is built on its own, so hot reload only
+        // rebuilds the ones using an edited shader.
+        enum GraphicsPipelineId : uint32_t { StandardPipeline, InstancedPipeline, SkinnedPipeline, GraphicsPipelineCount };
+        struct GraphicsPipelineKey {
+            GraphicsPipelineId id = StandardPipeline;
+            MaterialFeatureMask features = 0;
+            float alphaCutoff = 0.0f; // Specialization constant; only set with MaterialFeature::AlphaMask
+            // Only set with MaterialFeature::AlphaBlend: WeightedBlended draws into the OIT subpass.
+            TransparencyMode transparency = TransparencyMode::Sorted;
+            bool operator==(const GraphicsPipelineKey& other) const {
+                return id == other.id && features == other.features && alphaCutoff == other.alphaCutoff &&
+                       transparency == other.transparency;
+            }
+        };
+        struct GraphicsPipelineKeyHash {
+            size_t operator()(const GraphicsPipelineKey& key) const;
+        };
+        static const char* GraphicsPipelineVertexShader(GraphicsPipelineId id); // All use simple.frag
+        static std::vector<std::string> MaterialShaderDefines(MaterialFeatureMask features);
+        // The permutation for drawing `material` as `id`, built now if this is its first use.
+        // VK_NULL_HANDLE if it failed to build (logged); such draws are skipped.
+        VkPipeline GetGraphicsPipeline(GraphicsPipelineId id, const Material& material);
+        // Thread-safe; reads only the shader library, the render pass, the pipeline layouts and the depth convention.
+        VkPipeline BuildGraphicsPipeline(const GraphicsPipelineKey& key) const;
+
+        // --- Drawing ---
+        // Opaque and alpha-tested materials are drawn first; blended ones make up the transparent queue.
+        enum class RenderQueue { Opaque, Transparent };
+        // What the previous draw left bound, so consecutive draws only rebind what changed.
+        struct DrawState {
+            VkPipeline pipeline = VK_NULL_HANDLE;
+            VkPipelineLayout layout = VK_NULL_HANDLE;
+        };
+        // Binds `pipeline`, and the frame (and skin) sets when the layout changes. Returns the layout.
+        VkPipelineLayout BindDrawState(VkCommandBuffer commandBuffer, DrawState& state, VkPipeline pipeline, GraphicsPipelineId id);
+        // One standard or skinned object. False if its pipeline is unavailable.
+        bool DrawRenderObject(VkCommandBuffer commandBuffer, const RenderObjectInfo& info, const Material& material,
+                              uint32_t jointOffset, DrawState& state);
+        // The renderables in `queue`; standard objects first, then skinned. Returns the draws recorded.
+        uint32_t DrawRenderObjects(VkCommandBuffer commandBuffer, const RenderObjectList& renderables,
+                                   const ScratchVector<uint32_t>& jointOffsets, RenderQueue queue, DrawState& state);
+        // Chunks [chunkBegin, chunkEnd) of a batch, culled against `frustum` when given; consecutive
+        // visible chunks are merged into one draw. Returns the draws recorded.
+        uint32_t DrawInstancedBatch(VkCommandBuffer commandBuffer, const InstancedRenderInfo& info, const Material& material,
+                                    const Frustum* frustum, size_t chunkBegin, size_t chunkEnd, DrawState& state);
+        uint32_t DrawInstancedBatches(VkCommandBuffer commandBuffer, const InstancedRenderList& instancedBatches,
+                                      const Frustum* frustum, RenderQueue queue, DrawState& state);
+        // TransparencyMode::Sorted: the transparent queue back to front, objects and instance chunks interleaved.
+        uint32_t DrawSortedTransparents(VkCommandBuffer commandBuffer, const RenderObjectList& renderables,
+                                        const ScratchVector<uint32_t>& jointOffsets, const InstancedRenderList& instancedBatches,
+                                        const Frustum* frustum, CameraComponent* camera, DrawState& state);
+
+        // --- Shader Hot Reload ---
+        // Called in BeginFrame: swaps in pipelines rebuilt since the last frame, destroys replaced
+        // ones the GPU has finished with, and starts a rebuild job when shader sources changed: mesh
+        // pipelines, the OIT composite and the post-processing compute and present pipelines.
+        void UpdateShaderHotReload();
+        void DestroyPendingShaderReloads(); // Device must be idle
 
 
         // --- Core Vulkan Members ---
@@ -127,18 +283,28 @@ namespace VulkEng {
         std::unique_ptr<VulkanContext> m_VulkanContext;
         std::unique_ptr<Swapchain> m_Swapchain;
         std::unique_ptr<CommandManager> m_CommandManager; // Renderer owns its CommandManager
+        std::unique_ptr<ShaderLibrary> m_ShaderLibrary;
 
         // --- Descriptor Set Layouts ---
-        VkDescriptorSetLayout m_FrameDescriptorSetLayout = VK_NULL_HANDLE;    // For Set 0 (Camera + Light UBOs)
-        VkDescriptorSetLayout m_MaterialDescriptorSetLayout = VK_NULL_HANDLE; // For Set 1 (Texture Sampler)
+        VkDescriptorSetLayout m_FrameDescriptorSetLayout = VK_NULL_HANDLE;    // For Set 0 (Camera + Light UBOs, BRDF table)
+        VkDescriptorSetLayout m_MaterialDescriptorSetLayout = VK_NULL_HANDLE; // For Set 1 (Material textures + params)
+        VkDescriptorSetLayout m_SkinDescriptorSetLayout = VK_NULL_HANDLE;     // For Set 2 (Bone matrix storage buffer)
 
         // --- Pipeline Resources ---
-        VkPipelineLayout m_PipelineLayout = VK_NULL_HANDLE; // Uses both frame and material layouts
-        VkPipeline m_GraphicsPipeline = VK_NULL_HANDLE;
+        VkPipelineLayout m_PipelineLayout = VK_NULL_HANDLE; // Uses both frame and material layouts (standard + instanced)
+        VkPipelineLayout m_SkinnedPipelineLayout = VK_NULL_HANDLE; // Frame + material + skin sets, push constant adds the joint offset
+        // Every permutation used so far. Swapchain cleanup destroys the pipelines but keeps the keys,
+        // so CreateGraphicsPipeline rebuilds them all up front.
+        std::unordered_map<GraphicsPipelineKey, VkPipeline, GraphicsPipelineKeyHash> m_GraphicsPipelines;
 
         // --- Render Pass & Framebuffers ---
-        VkRenderPass m_RenderPass = VK_NULL_HANDLE;
+        VkRenderPass m_RenderPass = VK_NULL_HANDLE;        // Scene: HDR color (PostProcessStack) + depth, resolved from MSAA targets if enabled
+        VkFramebuffer m_SceneFramebuffer = VK_NULL_HANDLE;
+        VkRenderPass m_PresentRenderPass = VK_NULL_HANDLE; // Swapchain image: post-processed scene under the UI layer
         std::vector<VkFramebuffer> m_SwapChainFramebuffers;
+        VkRenderPass m_UiRenderPass = VK_NULL_HANDLE;      // UI layer (PostProcessStack), only when the UI changed
+        VkFramebuffer m_UiFramebuffer = VK_NULL_HANDLE;
+        bool m_UiLayerValid = false; // False until the layer is first rendered after (re)creation
 
         // --- Depth Buffer Resources ---
         VkImage m_DepthImage = VK_NULL_HANDLE;
@@ -146,24 +312,111 @@ namespace VulkEng {
         VkImageView m_DepthImageView = VK_NULL_HANDLE;
         VkFormat m_DepthFormat;
 
+        // --- Multisampling ---
+        // With more than one sample the scene renders into transient multisampled color and depth;
+        // the pass resolves them into the HDR target and m_DepthImage (sample zero, for particle collisions).
+        MsaaPreset m_MsaaPreset = MsaaPreset::Balanced;
+        VkSampleCountFlagBits m_MsaaSamples = VK_SAMPLE_COUNT_1_BIT;    // Effective count for m_MsaaPreset
+        VkSampleCountFlagBits m_MaxMsaaSamples = VK_SAMPLE_COUNT_1_BIT; // Device limit, queried at init
+        VkImage m_MsaaColorImage = VK_NULL_HANDLE;
+        VkDeviceMemory m_MsaaColorImageMemory = VK_NULL_HANDLE;
+        VkImageView m_MsaaColorImageView = VK_NULL_HANDLE;
+        VkImage m_MsaaDepthImage = VK_NULL_HANDLE;
+        VkDeviceMemory m_MsaaDepthImageMemory = VK_NULL_HANDLE;
+        VkImageView m_MsaaDepthImageView = VK_NULL_HANDLE;
+
         // --- Uniform Buffers (one set per frame in flight for Set 0) ---
         std::vector<std::unique_ptr<VulkanBuffer>> m_UniformBuffers;      // For CameraMatricesUBO
         std::vector<std::unique_ptr<VulkanBuffer>> m_LightUniformBuffers; // For LightDataUBO
 
+        // --- Split-Sum BRDF Table (Set 0, binding 2; see BrdfLut) ---
+        VkImage m_BrdfLutImage = VK_NULL_HANDLE;
+        VkDeviceMemory m_BrdfLutImageMemory = VK_NULL_HANDLE;
+        VkImageView m_BrdfLutImageView = VK_NULL_HANDLE;
+        VkSampler m_BrdfLutSampler = VK_NULL_HANDLE;
+
+        // --- Environment Lighting (Set 0, bindings 3 and 4; see IblBaker) ---
+        struct EnvironmentCube {
+            VkImage image = VK_NULL_HANDLE;
+            VkDeviceMemory memory = VK_NULL_HANDLE;
+            VkImageView view = VK_NULL_HANDLE;
+        };
+        void CreateEnvironmentCube(uint32_t size, uint32_t mipCount, const std::vector<uint16_t>& texels, EnvironmentCube& outCube);
+        void DestroyEnvironmentCube(EnvironmentCube& cube);
+        void WriteEnvironmentDescriptors(); // Points every frame set at the current cubes
+        EnvironmentCube m_IrradianceCube;
+        EnvironmentCube m_SpecularCube;
+        VkSampler m_EnvironmentSampler = VK_NULL_HANDLE;
+        bool m_HasEnvironment = false;  // False: the cubes are white and the ambient is a flat fraction of the light
+        float m_EnvironmentIntensity = 1.0f;
+        uint32_t m_SpecularMipCount = 1;
+
         // --- Descriptor Pool & Sets for Frame Data (Set 0) ---
         VkDescriptorPool m_DescriptorPool = VK_NULL_HANDLE; // Shared pool for frame and material sets
         std::vector<VkDescriptorSet> m_FrameDescriptorSets; // One set per frame in flight (for Set 0)
 
+        // --- Instanced Batches ---
+        // Staging memory for instance uploads, grown on demand (one per frame in flight).
+        std::vector<std::unique_ptr<VulkanBuffer>> m_InstanceStagingBuffers;
+        // Instance buffers referenced by each frame in flight, released once its fence has signaled.
+        std::vector<std::vector<std::shared_ptr<VulkanBuffer>>> m_InstanceBuffersInFlight;
+        InstancingStats m_InstancingStats;
+
+        // --- Skinned Meshes ---
+        // Persistently mapped bone matrices (one buffer and Set 2 per frame in flight), grown on demand.
+        std::vector<std::unique_ptr<VulkanBuffer>> m_BoneMatrixBuffers;
+        std::vector<VkDescriptorSet> m_SkinDescriptorSets;
+
+        // --- GPU Particles ---
+        // Simulated before the render pass against the previous frame's depth buffer and camera.
+        std::unique_ptr<GpuParticleSystem> m_ParticleSystem;
+        glm::mat4 m_PrevViewProj = glm::mat4(1.0f);
+        glm::mat4 m_PrevInvViewProj = glm::mat4(1.0f);
+        bool m_DepthHasContents = false; // False until a frame has been rendered into the current depth image
+
+        // --- Transparency ---
+        TransparencyMode m_TransparencyMode = TransparencyMode::Sorted;
+        // Weighted blended OIT targets: accumulation (RGBA16F: weighted premultiplied color, weighted
+        // coverage) and revealage (R16F: product of (1 - alpha)), read by the composite as input attachments.
+        VkImage m_OitAccumImage = VK_NULL_HANDLE;
+        VkDeviceMemory m_OitAccumImageMemory = VK_NULL_HANDLE;
+        VkImageView m_OitAccumImageView = VK_NULL_HANDLE;
+        VkImage m_OitRevealageImage = VK_NULL_HANDLE;
+        VkDeviceMemory m_OitRevealageImageMemory = VK_NULL_HANDLE;
+        VkImageView m_OitRevealageImageView = VK_NULL_HANDLE;
+        VkDescriptorSetLayout m_OitCompositeSetLayout = VK_NULL_HANDLE;
+        VkPipelineLayout m_OitCompositeLayout = VK_NULL_HANDLE;
+        VkDescriptorSet m_OitCompositeSet = VK_NULL_HANDLE; // From m_DescriptorPool; rewritten with the targets
+        VkPipeline m_OitCompositePipeline = VK_NULL_HANDLE;
+
+        // --- Post-processing ---
+        // Owns the HDR scene target; runs between the scene pass and the present pass.
+        std::unique_ptr<PostProcessStack> m_PostProcess;
+
+        // --- Shader Hot Reload ---
+        struct RetiredPipeline {
+            VkPipeline pipeline = VK_NULL_HANDLE;
+            uint64_t retireFrame = 0; // Destroyed once this frame has completed on the GPU
+        };
+        JobCounter m_ShaderReloadJobs;
+        std::mutex m_ShaderReloadMutex; // Guards the reloaded pipelines (written by the reload job)
+        std::vector<std::pair<GraphicsPipelineKey, VkPipeline>> m_ReloadedPipelines;
+        std::vector<PipelineReplacement> m_ReloadedFixedPipelines; // OIT composite, post-processing and particles
+        std::vector<RetiredPipeline> m_RetiredPipelines;
+        std::chrono::steady_clock::time_point m_LastShaderPoll;
+
 
         // --- Synchronization Primitives ---
         std::vector<VkSemaphore> m_ImageAvailableSemaphores;
         std::vector<VkSemaphore> m_RenderFinishedSemaphores;
-        std::vector<VkFence> m_InFlightFences;
+        std::vector<uint64_t> m_FrameSlotFrames; // Frame timeline value last submitted from each slot (0 = none)
 
         // --- Frame State ---
         uint32_t m_CurrentFrameIndex = 0; // Index for sync objects (0 to MAX_FRAMES_IN_FLIGHT-1)
         uint32_t m_CurrentImageIndex = 0; // Index of the currently acquired swapchain image
         bool m_FramebufferResized = false;
+        std::vector<QueueWait> m_PendingQueueWaits; // Cross-queue waits for the next graphics submit
+        bool m_ReversedZ = true; // Depth test GREATER, cleared to 0; matches CameraComponent's default
 
         // --- Lighting State (Simple example) ---
         glm::vec3 m_LightDirection = glm::normalize(glm::vec3(0.5f, -1.0f, -0.3f));
@@ -0,0 +1,417 @@
+#include "ShaderLibrary.h"
+#include "VulkanContext.h"
+#include "VulkanUtils.h" // For VK_CHECK
+#include "core/Hash.h"
+#include "core/Log.h"
+
+#include <algorithm> // For std::sort, std::max
+#include <cstdio>    // For std::snprintf
+#include <cstdlib>   // For std::system
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <thread>    // For unique temporary file names
+
+#ifndef SHADER_PATH_DEFINITION
+#define SHADER_PATH_DEFINITION "shaders/"
+#endif
+
+namespace VulkEng {
+
+    namespace {
+        constexpr uint32_t SpirvMagic = 0x07230203;
+
+        // The subset of SPIR-V opcodes, decorations and enums reflection needs.
+        enum SpirvOp : uint32_t {
+            OpEntryPoint = 15,
+            OpTypeInt = 21, OpTypeFloat = 22, OpTypeVector = 23, OpTypeMatrix = 24, OpTypeImage = 25,
+            OpTypeSampler = 26, OpTypeSampledImage = 27, OpTypeArray = 28, OpTypeRuntimeArray = 29,
+            OpTypeStruct = 30, OpTypePointer = 32, OpConstant = 43, OpVariable = 59,
+            OpDecorate = 71, OpMemberDecorate = 72,
+            OpTypeAccelerationStructureKHR = 5341,
+        };
+        enum SpirvDecoration : uint32_t {
+            DecorationBlock = 2, DecorationBufferBlock = 3, DecorationArrayStride = 6, DecorationMatrixStride = 7,
+            DecorationBinding = 33, DecorationDescriptorSet = 34, DecorationOffset = 35,
+        };
+        enum SpirvStorageClass : uint32_t {
+            StorageUniformConstant = 0, StorageUniform = 2, StoragePushConstant = 9, StorageStorageBuffer = 12,
+        };
+
+        struct SpirvType {
+            uint32_t op = 0;
+            std::vector<uint32_t> operands; // Instruction words after the result id
+        };
+
+        struct SpirvIds {
+            std::unordered_map<uint32_t, SpirvType> types;
+            std::unordered_map<uint32_t, uint32_t> constants; // Id -> 32-bit value
+            std::unordered_map<uint32_t, uint32_t> sets, bindings, arrayStrides;
+            std::unordered_map<uint32_t, bool> blocks, bufferBlocks;
+            std::map<std::pair<uint32_t, uint32_t>, uint32_t> memberOffsets, memberMatrixStrides;
+        };
+
+        VkShaderStageFlagBits StageFromExecutionModel(uint32_t model) {
+            switch (model) {
+                case 0: return VK_SHADER_STAGE_VERTEX_BIT;
+                case 1: return VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT;
+                case 2: return VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT;
+                case 3: return VK_SHADER_STAGE_GEOMETRY_BIT;
+                case 4: return VK_SHADER_STAGE_FRAGMENT_BIT;
+                case 5: return VK_SHADER_STAGE_COMPUTE_BIT;
+                default: return VK_SHADER_STAGE_ALL;
+            }
+        }
+
+        // Size in bytes of a type inside a block, using its layout decorations.
+        uint32_t TypeSize(const SpirvIds& ids, uint32_t typeId, uint32_t matrixStride = 0) {
+            auto it = ids.types.find(typeId);
+            if (it == ids.types.end()) return 0;
+            const SpirvType& type = it->second;
+            switch (type.op) {
+                case OpTypeInt:
+                case OpTypeFloat:
+                    return type.operands[0] / 8;
+                case OpTypeVector:
+                    return type.operands[1] * TypeSize(ids, type.operands[0]);
+                case OpTypeMatrix:
+                    return type.operands[1] * (matrixStride != 0 ? matrixStride : TypeSize(ids, type.operands[0]));
+                case OpTypeArray: {
+                    auto stride = ids.arrayStrides.find(typeId);
+                    auto length = ids.constants.find(type.operands[1]);
+                    uint32_t count = length != ids.constants.end() ? length->second : 1;
+                    uint32_t elementSize = stride != ids.arrayStrides.end() ? stride->second : TypeSize(ids, type.operands[0]);
+                    return count * elementSize;
+                }
+                case OpTypeStruct: {
+                    uint32_t size = 0;
+                    for (uint32_t member = 0; member < type.operands.size(); ++member) {
+                        auto offset = ids.memberOffsets.find({typeId, member});
+                        auto stride = ids.memberMatrixStrides.find({typeId, member});
+                        uint32_t memberSize = TypeSize(ids, type.operands[member],
+                                                       stride != ids.memberMatrixStrides.end() ? stride->second : 0);
+                        size = std::max(size, (offset != ids.memberOffsets.end() ? offset->second : size) + memberSize);
+                    }
+                    return size;
+                }
+                default:
+                    return 0;
+            }
+        }
+
+        // Descriptor type and array size of a resource variable's (pointee) type.
+        bool DescriptorTypeOf(const SpirvIds& ids, uint32_t typeId, uint32_t storageClass,
+                              VkDescriptorType& outType, uint32_t& outCount) {
+            outCount = 1;
+            auto it = ids.types.find(typeId);
+            while (it != ids.types.end() && (it->second.op == OpTypeArray || it->second.op == OpTypeRuntimeArray)) {
+                if (it->second.op == OpTypeArray) {
+                    auto length = ids.constants.find(it->second.operands[1]);
+                    outCount *= length != ids.constants.end() ? length->second : 1;
+                }
+                typeId = it->second.operands[0];
+                it = ids.types.find(typeId);
+            }
+            if (it == ids.types.end()) return false;
+
+            const SpirvType& type = it->second;
+            if (storageClass == StorageStorageBuffer) {
+                outType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+                return true;
+            }
+            if (storageClass == StorageUniform) {
+                outType = ids.bufferBlocks.count(typeId) ? VK_DESCRIPTOR_TYPE_STORAGE_BUFFER : VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+                return true;
+            }
+            switch (type.op) {
+                case OpTypeSampledImage: outType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER; return true;
+                case OpTypeSampler:      outType = VK_DESCRIPTOR_TYPE_SAMPLER; return true;
+                case OpTypeAccelerationStructureKHR: outType = VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR; return true;
+                case OpTypeImage: {
+                    uint32_t dim = type.operands[1];
+                    uint32_t sampled = type.operands[5];
+                    if (dim == 6) outType = VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT; // SubpassData
+                    else if (dim == 5) outType = sampled == 2 ? VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER : VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER;
+                    else outType = sampled == 2 ? VK_DESCRIPTOR_TYPE_STORAGE_IMAGE : VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+                    return true;
+                }
+                default:
+                    return false;
+            }
+        }
+
+        std::string ReadTextFile(const std::filesystem::path& path) {
+            std::ifstream file(path, std::ios::binary);
+            std::ostringstream text;
+            text << file.rdbuf();
+            return text.str();
+        }
+    }
+
+    bool ReflectSpirv(const std::vector<uint32_t>& code, ShaderReflection& outReflection) {
+        outReflection = ShaderReflection{};
+        if (code.size() < 5 || code[0] != SpirvMagic) return false;
+
+        SpirvIds ids;
+        std::vector<std::pair<uint32_t, std::pair<uint32_t, uint32_t>>> variables; // Id -> (pointer type, storage class)
+        for (size_t word = 5; word < code.size();) {
+            uint32_t wordCount = code[word] >> 16;
+            uint32_t op = code[word] & 0xFFFFu;
+            if (wordCount == 0 || word + wordCount > code.size()) return false;
+            const uint32_t* operands = &code[word + 1];
+            uint32_t operandCount = wordCount - 1;
+
+            switch (op) {
+                case OpEntryPoint:
+                    outReflection.stage = StageFromExecutionModel(operands[0]);
+                    break;
+                case OpDecorate:
+                    if (operands[1] == DecorationDescriptorSet) ids.sets[operands[0]] = operands[2];
+                    else if (operands[1] == DecorationBinding) ids.bindings[operands[0]] = operands[2];
+                    else if (operands[1] == DecorationBlock) ids.blocks[operands[0]] = true;
+                    else if (operands[1] == DecorationBufferBlock) ids.bufferBlocks[operands[0]] = true;
+                    else if (operands[1] == DecorationArrayStride) ids.arrayStrides[operands[0]] = operands[2];
+                    break;
+                case OpMemberDecorate:
+                    if (operands[2] == DecorationOffset) ids.memberOffsets[{operands[0], operands[1]}] = operands[3];
+                    else if (operands[2] == DecorationMatrixStride) ids.memberMatrixStrides[{operands[0], operands[1]}] = operands[3];
+                    break;
+                case OpTypeInt: case OpTypeFloat: case OpTypeVector: case OpTypeMatrix: case OpTypeImage:
+                case OpTypeSampler: case OpTypeSampledImage: case OpTypeArray: case OpTypeRuntimeArray:
+                case OpTypeStruct: case OpTypePointer: case OpTypeAccelerationStructureKHR:
+                    ids.types[operands[0]] = {op, std::vector<uint32_t>(operands + 1, operands + operandCount)};
+                    break;
+                case OpConstant:
+                    if (operandCount >= 3) ids.constants[operands[1]] = operands[2];
+                    break;
+                case OpVariable:
+                    variables.push_back({operands[1], {operands[0], operands[2]}});
+                    break;
+                default:
+                    break;
+            }
+            word += wordCount;
+        }
+
+        for (const auto& [id, typeAndStorage] : variables) {
+            auto [pointerType, storageClass] = typeAndStorage;
+            auto pointer = ids.types.find(pointerType);
+            if (pointer == ids.types.end() || pointer->second.op != OpTypePointer) continue;
+            uint32_t pointeeType = pointer->second.operands[1];
+
+            if (storageClass == StoragePushConstant) {
+                outReflection.pushConstantSize = std::max(outReflection.pushConstantSize, TypeSize(ids, pointeeType));
+                continue;
+            }
+            if (storageClass != StorageUniformConstant && storageClass != StorageUniform && storageClass != StorageStorageBuffer) continue;
+            auto set = ids.sets.find(id);
+            auto binding = ids.bindings.find(id);
+            if (set == ids.sets.end() || binding == ids.bindings.end()) continue;
+
+            ShaderResourceBinding resource;
+            resource.set = set->second;
+            resource.binding = binding->second;
+            resource.stages = outReflection.stage;
+            if (DescriptorTypeOf(ids, pointeeType, storageClass, resource.type, resource.count)) {
+                outReflection.bindings.push_back(resource);
+            }
+        }
+        std::sort(outReflection.bindings.begin(), outReflection.bindings.end(),
+                  [](const ShaderResourceBinding& a, const ShaderResourceBinding& b) {
+                      return a.set != b.set ? a.set < b.set : a.binding < b.binding;
+                  });
+        return true;
+    }
+
+    ShaderLibrary::ShaderLibrary(VulkanContext& context) : m_Context(context) {
+#if defined(VKENG_SHADER_HOT_RELOAD) && defined(SHADER_SOURCE_PATH_DEFINITION) && defined(SHADER_COMPILER_PATH_DEFINITION)
+        std::error_code error;
+        if (std::filesystem::is_directory(SHADER_SOURCE_PATH_DEFINITION, error)) {
+            m_SourceDir = SHADER_SOURCE_PATH_DEFINITION;
+            m_CacheDir = "shader_cache";
+            std::filesystem::create_directories(m_CacheDir, error);
+            VKENG_INFO("ShaderLibrary: Compiling shaders from '{}' (cache: '{}'); hot reload enabled.",
+                       m_SourceDir.string(), m_CacheDir.string());
+        } else {
+            VKENG_WARN("ShaderLibrary: Shader sources not found at '{}'; using prebuilt SPIR-V, hot reload disabled.",
+                       SHADER_SOURCE_PATH_DEFINITION);
+        }
+#endif
+    }
+
+    std::string ShaderLibrary::VariantName(const std::string& name, const std::vector<std::string>& defines) {
+        std::string variant = name;
+        for (const std::string& define : defines) {
+            variant += '-';
+            for (char c : define) variant += (c == '=') ? '_' : c;
+        }
+        return variant;
+    }
+
+    bool ShaderLibrary::CanCompile() const {
+        return !m_SourceDir.empty();
+    }
+
+    std::shared_ptr<const ShaderBinary> ShaderLibrary::Load(const std::string& name, std::vector<std::string> defines) {
+        std::sort(defines.begin(), defines.end());
+        std::string variant = VariantName(name, defines);
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            auto it = m_Variants.find(variant);
+            if (it != m_Variants.end()) return it->second;
+        }
+
+        // Not under the lock: compiling takes a while and other variants can load meanwhile.
+        auto binary = std::make_shared<ShaderBinary>();
+        binary->name = name;
+        binary->defines = defines;
+        SourceState sources;
+        bool compiled = false;
+        if (CanCompile() && std::filesystem::exists(m_SourceDir / name)) {
+            if (!CompileVariant(name, defines, binary->code, sources)) {
+                throw std::runtime_error("ShaderLibrary: Failed to compile " + variant);
+            }
+            compiled = true;
+        } else if (!ReadSpirvFile(std::filesystem::path(SHADER_PATH_DEFINITION) / (variant + ".spv"), binary->code)) {
+            throw std::runtime_error("ShaderLibrary: No SPIR-V for " + variant);
+        }
+        if (!ReflectSpirv(binary->code, binary->reflection)) {
+            throw std::runtime_error("ShaderLibrary: Invalid SPIR-V for " + variant);
+        }
+
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        if (compiled) m_Sources[name] = std::move(sources);
+        auto [it, inserted] = m_Variants.emplace(variant, std::move(binary));
+        return it->second; // Another thread may have loaded it first; either copy is identical
+    }
+
+    VkShaderModule ShaderLibrary::CreateModule(const ShaderBinary& binary) const {
+        VkShaderModuleCreateInfo createInfo{VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO};
+        createInfo.codeSize = binary.code.size() * sizeof(uint32_t);
+        createInfo.pCode = binary.code.data();
+        VkShaderModule module = VK_NULL_HANDLE;
+        VK_CHECK(vkCreateShaderModule(m_Context.device, &createInfo, nullptr, &module));
+        return module;
+    }
+
+    VkDescriptorSetLayout ShaderLibrary::CreateDescriptorSetLayout(std::initializer_list<const ShaderBinary*> shaders, uint32_t set) const {
+        std::map<uint32_t, VkDescriptorSetLayoutBinding> merged;
+        for (const ShaderBinary* shader : shaders) {
+            for (const ShaderResourceBinding& resource : shader->reflection.bindings) {
+                if (resource.set != set) continue;
+                auto [it, inserted] = merged.try_emplace(resource.binding);
+                VkDescriptorSetLayoutBinding& binding = it->second;
+                if (inserted) {
+                    binding.binding = resource.binding;
+                    binding.descriptorType = resource.type;
+                    binding.descriptorCount = resource.count;
+                } else if (binding.descriptorType != resource.type || binding.descriptorCount != resource.count) {
+                    VKENG_ERROR("ShaderLibrary: {} declares set {} binding {} differently from the other shaders.",
+                                shader->name, set, resource.binding);
+                }
+                binding.stageFlags |= resource.stages;
+            }
+        }
+
+        std::vector<VkDescriptorSetLayoutBinding> bindings;
+        bindings.reserve(merged.size());
+        for (const auto& [index, binding] : merged) bindings.push_back(binding);
+        VkDescriptorSetLayoutCreateInfo layoutInfo{VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO};
+        layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+        layoutInfo.pBindings = bindings.data();
+        VkDescriptorSetLayout layout = VK_NULL_HANDLE;
+        VK_CHECK(vkCreateDescriptorSetLayout(m_Context.device, &layoutInfo, nullptr, &layout));
+        return layout;
+    }
+
+    std::vector<std::string> ShaderLibrary::PollChangedShaders() {
+        std::vector<std::string> changed;
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        for (auto& [name, sources] : m_Sources) {
+            bool modified = false;
+            for (size_t i = 0; i < sources.files.size(); ++i) {
+                std::error_code error;
+                auto writeTime = std::filesystem::last_write_time(sources.files[i], error);
+                if (!error && writeTime != sources.writeTimes[i]) {
+                    sources.writeTimes[i] = writeTime; // Report each edit once, even if it fails to compile
+                    modified = true;
+                }
+            }
+            if (!modified) continue;
+            changed.push_back(name);
+            for (auto it = m_Variants.begin(); it != m_Variants.end();) {
+                it = (it->second->name == name) ? m_Variants.erase(it) : std::next(it);
+            }
+        }
+        return changed;
+    }
+
+    bool ShaderLibrary::CompileVariant(const std::string& name, const std::vector<std::string>& defines,
+                                       std::vector<uint32_t>& outCode, SourceState& outSources) const {
+#if defined(SHADER_COMPILER_PATH_DEFINITION)
+        // The cache key covers the source, everything it #includes and the defines.
+        uint64_t key = FNV1aOffsetBasis;
+        std::vector<std::filesystem::path> pending = {m_SourceDir / name};
+        while (!pending.empty()) {
+            std::filesystem::path file = pending.back();
+            pending.pop_back();
+            if (std::find(outSources.files.begin(), outSources.files.end(), file) != outSources.files.end()) continue;
+            std::error_code error;
+            outSources.files.push_back(file);
+            outSources.writeTimes.push_back(std::filesystem::last_write_time(file, error));
+
+            std::string text = ReadTextFile(file);
+            key = HashString(text, key);
+            std::istringstream lines(text);
+            for (std::string line; std::getline(lines, line);) {
+                size_t include = line.find("#include");
+                size_t open = line.find('"', include);
+                size_t close = open != std::string::npos ? line.find('"', open + 1) : std::string::npos;
+                if (include == std::string::npos || close == std::string::npos) continue;
+                std::string included = line.substr(open + 1, close - open - 1);
+                pending.push_back(std::filesystem::exists(file.parent_path() / included) ? file.parent_path() / included
+                                                                                           : m_SourceDir / included);
+            }
+        }
+        for (const std::string& define : defines) key = HashString(define + '\n', key);
+
+        char keyText[17];
+        std::snprintf(keyText, sizeof(keyText), "%016llx", static_cast<unsigned long long>(key));
+        std::filesystem::path cachePath = m_CacheDir / (VariantName(name, defines) + "-" + keyText + ".spv");
+        if (ReadSpirvFile(cachePath, outCode)) {
+            return true;
+        }
+
+        // Compile to a temporary name first, so concurrent compiles never read a partial file.
+        std::filesystem::path tempPath = cachePath;
+        tempPath += "." + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id())) + ".tmp";
+        std::string command = std::string("\"") + SHADER_COMPILER_PATH_DEFINITION + "\" -I \"" + m_SourceDir.string() + "\"";
+        for (const std::string& define : defines) command += " -D" + define;
+        command += " \"" + (m_SourceDir / name).string() + "\" -o \"" + tempPath.string() + "\"";
+        VKENG_INFO("ShaderLibrary: Compiling {}...", VariantName(name, defines));
+        if (std::system(command.c_str()) != 0) {
+            VKENG_ERROR("ShaderLibrary: glslc failed for {} (see its output above).", VariantName(name, defines));
+            return false;
+        }
+        std::error_code error;
+        std::filesystem::rename(tempPath, cachePath, error);
+        return ReadSpirvFile(error ? tempPath : cachePath, outCode);
+#else
+        (void)name; (void)defines; (void)outCode; (void)outSources;
+        return false;
+#endif
+    }
+
+    bool ShaderLibrary::ReadSpirvFile(const std::filesystem::path& path, std::vector<uint32_t>& outCode) {
+        std::ifstream file(path, std::ios::ate | std::ios::binary);
+        if (!file.is_open()) return false;
+        size_t fileSize = static_cast<size_t>(file.tellg());
+        if (fileSize == 0 || fileSize % sizeof(uint32_t) != 0) return false;
+        outCode.resize(fileSize / sizeof(uint32_t));
+        file.seekg(0);
+        file.read(reinterpret_cast<char*>(outCode.data()), static_cast<std::streamsize>(fileSize));
+        return static_cast<bool>(file) && outCode[0] == SpirvMagic;
+    }
+
+} // namespace VulkEng
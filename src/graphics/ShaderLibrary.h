@@ -0,0 +1,106 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <filesystem>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace VulkEng {
+
+    class VulkanContext;
+
+    // A descriptor binding a shader declares, as found in its SPIR-V.
+    struct ShaderResourceBinding {
+        uint32_t set = 0;
+        uint32_t binding = 0;
+        VkDescriptorType type = VK_DESCRIPTOR_TYPE_MAX_ENUM;
+        uint32_t count = 1;
+        VkShaderStageFlags stages = 0;
+    };
+
+    // What a SPIR-V module declares: its stage, descriptor bindings and push constant block size.
+    struct ShaderReflection {
+        VkShaderStageFlagBits stage = VK_SHADER_STAGE_ALL;
+        std::vector<ShaderResourceBinding> bindings;
+        uint32_t pushConstantSize = 0; // 0 if the shader has no push constants
+    };
+
+    // Reads descriptor bindings and push constants out of a SPIR-V module. Returns false if the
+    // code is not valid SPIR-V.
+    bool ReflectSpirv(const std::vector<uint32_t>& code, ShaderReflection& outReflection);
+
+    // One compiled shader variant.
+    struct ShaderBinary {
+        std::string name;                 // Source file name, e.g. "simple.vert"
+        std::vector<std::string> defines; // Sorted, e.g. {"SKINNED", "MAX_LIGHTS=4"}
+        std::vector<uint32_t> code;
+        ShaderReflection reflection;
+    };
+
+    // A pipeline rebuilt by hot reload, and the member it replaces once swapped in on the main thread.
+    struct PipelineReplacement {
+        VkPipeline* slot = nullptr;
+        VkPipeline pipeline = VK_NULL_HANDLE;
+        std::string name; // Its shaders, for the log
+    };
+
+    // Loads SPIR-V for shader sources in assets/shaders, by source name plus preprocessor defines.
+    //
+    // Development builds (VKENG_SHADER_HOT_RELOAD) compile the GLSL sources themselves with glslc and
+    // keep the results in an on-disk cache keyed by a hash of the source, its includes and the
+    // defines, so unchanged shaders are never recompiled across runs. PollChangedShaders() reports
+    // sources edited since they were loaded, for hot reload. Other builds load the SPIR-V that the
+    // CompileShaders build target produced (CompileShader() in CMakeLists.txt), named
+    // "<name>[-<DEFINE>...].spv".
+    //
+    // Load and CreateModule are thread-safe.
+    class ShaderLibrary {
+    public:
+        explicit ShaderLibrary(VulkanContext& context);
+
+        ShaderLibrary(const ShaderLibrary&) = delete;
+        ShaderLibrary& operator=(const ShaderLibrary&) = delete;
+
+        // Returns the cached variant, loading or compiling it on first use. Throws std::runtime_error
+        // if there is neither a compilable source nor prebuilt SPIR-V, or if compilation fails.
+        std::shared_ptr<const ShaderBinary> Load(const std::string& name, std::vector<std::string> defines = {});
+        VkShaderModule CreateModule(const ShaderBinary& binary) const;
+
+        // Merges the bindings of `set` declared by `shaders` (stage flags are combined) into a layout.
+        VkDescriptorSetLayout CreateDescriptorSetLayout(std::initializer_list<const ShaderBinary*> shaders, uint32_t set) const;
+
+        // True if GLSL sources can be compiled at runtime, i.e. hot reload is available.
+        bool CanCompile() const;
+        // Names of loaded shaders whose source or includes changed since they were loaded. Their
+        // cached variants are dropped, so the next Load picks up the edit. Only file timestamps are
+        // checked, so this is cheap enough to call every frame.
+        std::vector<std::string> PollChangedShaders();
+
+        // "simple.frag" + {"A", "B=2"} -> "simple.frag-A-B_2", the prebuilt SPIR-V file stem.
+        static std::string VariantName(const std::string& name, const std::vector<std::string>& defines);
+
+    private:
+        struct SourceState {
+            std::vector<std::filesystem::path> files; // The source and every file it includes
+            std::vector<std::filesystem::file_time_type> writeTimes;
+        };
+
+        bool CompileVariant(const std::string& name, const std::vector<std::string>& defines,
+                            std::vector<uint32_t>& outCode, SourceState& outSources) const;
+        static bool ReadSpirvFile(const std::filesystem::path& path, std::vector<uint32_t>& outCode);
+
+        VulkanContext& m_Context;
+        std::filesystem::path m_SourceDir; // Empty unless runtime compilation is enabled
+        std::filesystem::path m_CacheDir;
+
+        std::mutex m_Mutex; // Guards the maps below
+        std::unordered_map<std::string, std::shared_ptr<const ShaderBinary>> m_Variants; // By VariantName
+        std::unordered_map<std::string, SourceState> m_Sources;                          // By source name
+    };
+
+} // namespace VulkEng
@@ -8,6 +8,7 @@
 #include <set>       // For checking required extensions
 #include <cstring>   // For strcmp (used in extension/layer checking)
 #include <algorithm> // For std::find
+#include <array>
 
 // --- Configuration ---
 #ifdef NDEBUG
@@ -79,7 +80,9 @@ namespace VulkEng {
           instance(VK_NULL_HANDLE), debugMessenger(VK_NULL_HANDLE), surface(VK_NULL_HANDLE),
           physicalDevice(VK_NULL_HANDLE), device(VK_NULL_HANDLE),
           graphicsQueue(VK_NULL_HANDLE), presentQueue(VK_NULL_HANDLE),
+          computeQueue(VK_NULL_HANDLE), transferQueue(VK_NULL_HANDLE),
           graphicsQueueFamily(UINT32_MAX), presentQueueFamily(UINT32_MAX),
+          computeQueueFamily(UINT32_MAX), transferQueueFamily(UINT32_MAX),
           mainRenderPass(VK_NULL_HANDLE), imageCount(0), minImageCount(0)
           // physicalDeviceProperties and physicalDeviceFeatures are default-initialized
     {
@@ -97,6 +100,7 @@ namespace VulkEng {
         }
         PickPhysicalDevice(); // Throws on failure
         CreateLogicalDevice(); // Throws on failure
+        CreateQueueTimelines();
         VKENG_INFO("Vulkan Context Initialized Successfully.");
     }
 
@@ -104,6 +108,12 @@ namespace VulkEng {
         VKENG_INFO("Destroying Vulkan Context...");
         // Resources are destroyed in reverse order of creation.
         if (device != VK_NULL_HANDLE) {
+            for (QueueSlot& slot : m_Queues) {
+                if (slot.timeline != VK_NULL_HANDLE) vkDestroySemaphore(device, slot.timeline, nullptr);
+                slot.timeline = VK_NULL_HANDLE;
+            }
+            if (m_FrameTimeline != VK_NULL_HANDLE) vkDestroySemaphore(device, m_FrameTimeline, nullptr);
+            m_FrameTimeline = VK_NULL_HANDLE;
             vkDestroyDevice(device, nullptr);
             device = VK_NULL_HANDLE;
         }
@@ -261,6 +271,20 @@ namespace VulkEng {
                 vkGetPhysicalDeviceProperties(physicalDevice, &physicalDeviceProperties); // Cache properties
                 vkGetPhysicalDeviceFeatures(physicalDevice, &physicalDeviceFeatures);   // Cache features
                 VKENG_INFO("Selected Physical Device: {}", physicalDeviceProperties.deviceName);
+
+                VkPhysicalDeviceMemoryProperties memoryProperties;
+                vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
+                const VkMemoryPropertyFlags directFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT |
+                                                          VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+                for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; ++i) {
+                    const VkMemoryType& type = memoryProperties.memoryTypes[i];
+                    if ((type.propertyFlags & directFlags) == directFlags &&
+                        memoryProperties.memoryHeaps[type.heapIndex].size > 256ull * 1024 * 1024) {
+                        hostVisibleDeviceMemory = true;
+                        break;
+                    }
+                }
+                VKENG_INFO("Host-visible device-local memory (ReBAR/UMA): {}", hostVisibleDeviceMemory ? "yes" : "no");
                 return; // Found a suitable device
             }
         }
@@ -296,6 +320,16 @@ namespace VulkEng {
         // Add other feature checks: featuresSupported = featuresSupported && supportedFeatures.geometryShader;
         if (!featuresSupported) VKENG_INFO("Device skipped: Lacks required features (e.g., samplerAnisotropy).");
 
+        // Timeline semaphores (core in 1.2) express cross-queue dependencies in VulkanContext::Submit.
+        VkPhysicalDeviceVulkan12Features supportedFeatures12{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES};
+        VkPhysicalDeviceFeatures2 supportedFeatures2{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2};
+        supportedFeatures2.pNext = &supportedFeatures12;
+        vkGetPhysicalDeviceFeatures2(currentDevice, &supportedFeatures2);
+        if (!supportedFeatures12.timelineSemaphore) {
+            VKENG_INFO("Device skipped: No timeline semaphore support.");
+            featuresSupported = false;
+        }
+
         // Check for Blit support
         VkFormatProperties formatProps;
         vkGetPhysicalDeviceFormatProperties(currentDevice, VK_FORMAT_R8G8B8A8_SRGB, &formatProps);
@@ -315,22 +349,33 @@ namespace VulkEng {
         std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
         vkGetPhysicalDeviceQueueFamilyProperties(currentDevice, &queueFamilyCount, queueFamilies.data());
 
-        int i = 0;
+        uint32_t i = 0;
         for (const auto& queueFamily : queueFamilies) {
-            if (queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) {
+            const VkQueueFlags flags = queueFamily.queueFlags;
+            if ((flags & VK_QUEUE_GRAPHICS_BIT) && !indices.graphicsFamily.has_value()) {
                 indices.graphicsFamily = i;
             }
             if (surface != VK_NULL_HANDLE) { // Only check present if we have a surface
                 VkBool32 presentSupport = false;
                 vkGetPhysicalDeviceSurfaceSupportKHR(currentDevice, i, surface, &presentSupport);
-                if (presentSupport) {
+                // Prefer presenting from the graphics family (no ownership transfer of swapchain images)
+                if (presentSupport && (!indices.presentFamily.has_value() || indices.graphicsFamily == i)) {
                     indices.presentFamily = i;
                 }
             } else { // If no surface (dummy context), assume graphics queue can present or pick first one
                 indices.presentFamily = indices.graphicsFamily;
             }
 
-            if (indices.IsComplete()) break;
+            // Async compute: a compute family without graphics
+            if ((flags & VK_QUEUE_COMPUTE_BIT) && !(flags & VK_QUEUE_GRAPHICS_BIT) && !indices.computeFamily.has_value()) {
+                indices.computeFamily = i;
+                indices.computeQueueCount = queueFamily.queueCount;
+            }
+            // DMA engine: transfer only (compute and graphics queues support transfers implicitly)
+            if ((flags & VK_QUEUE_TRANSFER_BIT) && !(flags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)) &&
+                !indices.transferFamily.has_value()) {
+                indices.transferFamily = i;
+            }
             i++;
         }
         return indices;
@@ -410,17 +455,28 @@ namespace VulkEng {
 
         graphicsQueueFamily = indices.graphicsFamily.value();
         presentQueueFamily = indices.presentFamily.value();
+        computeQueueFamily = indices.computeFamily.value_or(graphicsQueueFamily);
+        // Without a DMA family, transfers use a second queue of the async compute family if it has one.
+        uint32_t transferQueueIndex = 0;
+        if (indices.transferFamily.has_value()) {
+            transferQueueFamily = indices.transferFamily.value();
+        } else if (indices.computeFamily.has_value() && indices.computeQueueCount > 1) {
+            transferQueueFamily = computeQueueFamily;
+            transferQueueIndex = 1;
+        } else {
+            transferQueueFamily = computeQueueFamily;
+        }
 
         std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
-        std::set<uint32_t> uniqueQueueFamilies = {graphicsQueueFamily, presentQueueFamily};
+        std::set<uint32_t> uniqueQueueFamilies = {graphicsQueueFamily, presentQueueFamily, computeQueueFamily, transferQueueFamily};
 
-        float queuePriority = 1.0f;
+        const float queuePriorities[] = {1.0f, 1.0f};
         for (uint32_t queueFamilyIndex : uniqueQueueFamilies) {
             VkDeviceQueueCreateInfo queueCreateInfo{};
             queueCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
             queueCreateInfo.queueFamilyIndex = queueFamilyIndex;
-            queueCreateInfo.queueCount = 1;
-            queueCreateInfo.pQueuePriorities = &queuePriority;
+            queueCreateInfo.queueCount = (queueFamilyIndex == transferQueueFamily) ? transferQueueIndex + 1 : 1;
+            queueCreateInfo.pQueuePriorities = queuePriorities;
             queueCreateInfos.push_back(queueCreateInfo);
         }
 
@@ -477,6 +533,10 @@ namespace VulkEng {
             createInfo.enabledLayerCount = 0;
         }
 
+        VkPhysicalDeviceVulkan12Features features12{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES};
+        features12.timelineSemaphore = VK_TRUE; // Checked in IsDeviceSuitable
+        createInfo.pNext = &features12;
+
         // Chain Vulkan 1.1/1.2/1.3 features if needed
         // VkPhysicalDeviceVulkan13Features features13{};
         // features13.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
@@ -489,7 +549,126 @@ namespace VulkEng {
 
         vkGetDeviceQueue(device, graphicsQueueFamily, 0, &graphicsQueue);
         vkGetDeviceQueue(device, presentQueueFamily, 0, &presentQueue);
-        VKENG_INFO("Logical Device and Queues Created.");
+        vkGetDeviceQueue(device, computeQueueFamily, 0, &computeQueue);
+        vkGetDeviceQueue(device, transferQueueFamily, transferQueueIndex, &transferQueue);
+        VKENG_INFO("Logical Device and Queues Created (graphics family {}, compute family {}{}, transfer family {}{}).",
+                   graphicsQueueFamily, computeQueueFamily, indices.computeFamily ? "" : " (shared)",
+                   transferQueueFamily, transferQueue != graphicsQueue && transferQueue != computeQueue ? "" : " (shared)");
+    }
+
+    void VulkanContext::CreateQueueTimelines() {
+        const std::array<VkQueue, static_cast<size_t>(QueueType::Count)> queues = {graphicsQueue, computeQueue, transferQueue};
+        const std::array<uint32_t, static_cast<size_t>(QueueType::Count)> families = {graphicsQueueFamily, computeQueueFamily, transferQueueFamily};
+
+        VkSemaphoreTypeCreateInfo typeInfo{VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO};
+        typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+        typeInfo.initialValue = 0;
+        VkSemaphoreCreateInfo semaphoreInfo{VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO};
+        semaphoreInfo.pNext = &typeInfo;
+
+        uint32_t slotCount = 0;
+        for (size_t type = 0; type < queues.size(); ++type) {
+            // Types that ended up on the same VkQueue share its slot (one lock, one timeline).
+            uint32_t slot = slotCount;
+            for (uint32_t existing = 0; existing < slotCount; ++existing) {
+                if (m_Queues[existing].queue == queues[type]) slot = existing;
+            }
+            if (slot == slotCount) {
+                m_Queues[slot].queue = queues[type];
+                m_Queues[slot].family = families[type];
+                VK_CHECK(vkCreateSemaphore(device, &semaphoreInfo, nullptr, &m_Queues[slot].timeline));
+                ++slotCount;
+            }
+            m_QueueSlot[type] = slot;
+        }
+        VK_CHECK(vkCreateSemaphore(device, &semaphoreInfo, nullptr, &m_FrameTimeline));
+    }
+
+    GpuTimelinePoint VulkanContext::Submit(QueueType type, const QueueSubmitDesc& desc) {
+        QueueSlot& slot = m_Queues[m_QueueSlot[static_cast<size_t>(type)]];
+
+        // Waits: the timeline points, then the optional binary semaphore (its value is ignored).
+        constexpr uint32_t MaxWaits = 8;
+        if (desc.waitCount + 1 > MaxWaits) throw std::runtime_error("VulkanContext::Submit: Too many waits.");
+        std::array<VkSemaphore, MaxWaits> waitSemaphores{};
+        std::array<uint64_t, MaxWaits> waitValues{};
+        std::array<VkPipelineStageFlags, MaxWaits> waitStages{};
+        uint32_t waitCount = 0;
+        for (uint32_t i = 0; i < desc.waitCount; ++i) {
+            const QueueWait& wait = desc.waits[i];
+            if (!wait.point.IsValid() || wait.point.value == 0) continue;
+            waitSemaphores[waitCount] = wait.point.semaphore;
+            waitValues[waitCount] = wait.point.value;
+            waitStages[waitCount] = wait.stages;
+            ++waitCount;
+        }
+        if (desc.binaryWait != VK_NULL_HANDLE) {
+            waitSemaphores[waitCount] = desc.binaryWait;
+            waitStages[waitCount] = desc.binaryWaitStages;
+            ++waitCount;
+        }
+
+        std::lock_guard<std::mutex> lock(slot.mutex);
+        GpuTimelinePoint point{slot.timeline, slot.lastSubmitted + 1};
+        std::array<VkSemaphore, 3> signalSemaphores = {slot.timeline};
+        std::array<uint64_t, 3> signalValues = {point.value};
+        uint32_t signalCount = 1;
+        if (desc.signal.IsValid()) {
+            signalSemaphores[signalCount] = desc.signal.semaphore;
+            signalValues[signalCount++] = desc.signal.value;
+        }
+        if (desc.binarySignal != VK_NULL_HANDLE) {
+            signalSemaphores[signalCount] = desc.binarySignal;
+            signalValues[signalCount++] = 0;
+        }
+
+        VkTimelineSemaphoreSubmitInfo timelineInfo{VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO};
+        timelineInfo.waitSemaphoreValueCount = waitCount;
+        timelineInfo.pWaitSemaphoreValues = waitValues.data();
+        timelineInfo.signalSemaphoreValueCount = signalCount;
+        timelineInfo.pSignalSemaphoreValues = signalValues.data();
+
+        VkSubmitInfo submitInfo{VK_STRUCTURE_TYPE_SUBMIT_INFO};
+        submitInfo.pNext = &timelineInfo;
+        submitInfo.waitSemaphoreCount = waitCount;
+        submitInfo.pWaitSemaphores = waitSemaphores.data();
+        submitInfo.pWaitDstStageMask = waitStages.data();
+        submitInfo.commandBufferCount = desc.commandBufferCount;
+        submitInfo.pCommandBuffers = desc.commandBuffers;
+        submitInfo.signalSemaphoreCount = signalCount;
+        submitInfo.pSignalSemaphores = signalSemaphores.data();
+        VK_CHECK(vkQueueSubmit(slot.queue, 1, &submitInfo, desc.fence));
+        slot.lastSubmitted = point.value;
+        return point;
+    }
+
+    GpuTimelinePoint VulkanContext::GetLastSubmitted(QueueType type) const {
+        const QueueSlot& slot = m_Queues[m_QueueSlot[static_cast<size_t>(type)]];
+        std::lock_guard<std::mutex> lock(slot.mutex);
+        return {slot.timeline, slot.lastSubmitted};
+    }
+
+    bool VulkanContext::IsComplete(const GpuTimelinePoint& point) const {
+        if (!point.IsValid() || point.value == 0) return true;
+        uint64_t value = 0;
+        VK_CHECK(vkGetSemaphoreCounterValue(device, point.semaphore, &value));
+        return value >= point.value;
+    }
+
+    uint64_t VulkanContext::GetCompletedFrame() const {
+        if (m_FrameTimeline == VK_NULL_HANDLE) return m_CurrentFrame - 1;
+        uint64_t value = 0;
+        VK_CHECK(vkGetSemaphoreCounterValue(device, m_FrameTimeline, &value));
+        return value;
+    }
+
+    void VulkanContext::WaitFor(const GpuTimelinePoint& point) const {
+        if (!point.IsValid() || point.value == 0) return;
+        VkSemaphoreWaitInfo waitInfo{VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO};
+        waitInfo.semaphoreCount = 1;
+        waitInfo.pSemaphores = &point.semaphore;
+        waitInfo.pValues = &point.value;
+        VK_CHECK(vkWaitSemaphores(device, &waitInfo, UINT64_MAX));
     }
 
 } // namespace VulkEng
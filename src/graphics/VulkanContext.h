@@ -5,6 +5,9 @@
 #include <vector>
 #include <string>
 #include <optional> // For std::optional in QueueFamilyIndices
+#include <array>
+#include <cstdint>
+#include <mutex>
 
 namespace VulkEng {
 
@@ -12,9 +15,11 @@ namespace VulkEng {
     struct QueueFamilyIndices {
         std::optional<uint32_t> graphicsFamily;
         std::optional<uint32_t> presentFamily;
-        // Optional: Add computeFamily, transferFamily if needed later
-        // std::optional<uint32_t> computeFamily;
-        // std::optional<uint32_t> transferFamily;
+        // Dedicated families only (compute without graphics; transfer without graphics or compute).
+        // If missing, that work goes to the graphics queue.
+        std::optional<uint32_t> computeFamily;
+        std::optional<uint32_t> transferFamily;
+        uint32_t computeQueueCount = 0; // Queues available in computeFamily
 
         bool IsComplete() const {
             // For basic rendering, graphics and present are essential
@@ -22,6 +27,44 @@ namespace VulkEng {
         }
     };
 
+    // The kinds of work the engine submits. Compute and Transfer map to dedicated queues when the
+    // device has them (async compute, DMA engine) and to the graphics queue otherwise.
+    enum class QueueType : uint32_t {
+        Graphics = 0,
+        Compute,
+        Transfer,
+        Count
+    };
+
+    // A point on a queue's timeline semaphore. Work submitted to that queue up to here is complete
+    // once the semaphore's counter reaches `value`.
+    struct GpuTimelinePoint {
+        VkSemaphore semaphore = VK_NULL_HANDLE;
+        uint64_t value = 0;
+
+        bool IsValid() const { return semaphore != VK_NULL_HANDLE; }
+    };
+
+    // A cross-queue dependency: the submission's `stages` wait until `point` is reached.
+    struct QueueWait {
+        GpuTimelinePoint point;
+        VkPipelineStageFlags stages = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+    };
+
+    // Arguments of VulkanContext::Submit. Arrays are borrowed for the duration of the call.
+    struct QueueSubmitDesc {
+        const VkCommandBuffer* commandBuffers = nullptr;
+        uint32_t commandBufferCount = 0;
+        const QueueWait* waits = nullptr;
+        uint32_t waitCount = 0;
+        // Binary semaphores for the swapchain (acquire / present), alongside the timeline.
+        VkSemaphore binaryWait = VK_NULL_HANDLE;
+        VkPipelineStageFlags binaryWaitStages = 0;
+        VkSemaphore binarySignal = VK_NULL_HANDLE;
+        GpuTimelinePoint signal; // Optional extra timeline point to signal (e.g., the frame timeline)
+        VkFence fence = VK_NULL_HANDLE; // Optional, for code that still waits on fences
+    };
+
     // Structure to hold details about swap chain support for a physical device
     struct SwapChainSupportDetails {
         VkSurfaceCapabilitiesKHR capabilities{}; // Initialize to default
@@ -53,6 +96,37 @@ namespace VulkEng {
         // VkCommandBuffer BeginSingleTimeCommandsHelper(VkCommandPool utilityCommandPool);
         // void EndSingleTimeCommandsHelper(VkCommandPool utilityCommandPool, VkCommandBuffer commandBuffer);
 
+        // --- Queues and Timeline Submission ---
+        VkQueue GetQueue(QueueType type) const { return m_Queues[m_QueueSlot[static_cast<size_t>(type)]].queue; }
+        uint32_t GetQueueFamily(QueueType type) const { return m_Queues[m_QueueSlot[static_cast<size_t>(type)]].family; }
+        // True if `type` has its own queue, so its work can overlap with graphics work.
+        bool HasDedicatedQueue(QueueType type) const {
+            return type == QueueType::Graphics || m_QueueSlot[static_cast<size_t>(type)] != m_QueueSlot[0];
+        }
+
+        // Submits to the queue for `type` (thread-safe) and returns the timeline point that is
+        // reached when the submitted work completes. Waits on other queues' points express
+        // cross-queue dependencies without fences or CPU round trips.
+        GpuTimelinePoint Submit(QueueType type, const QueueSubmitDesc& desc);
+        // Most recent point submitted to `type` (completed or not).
+        GpuTimelinePoint GetLastSubmitted(QueueType type) const;
+        bool IsComplete(const GpuTimelinePoint& point) const;
+        // Blocks the calling thread until `point` is reached.
+        void WaitFor(const GpuTimelinePoint& point) const;
+        // For direct vkQueue* calls (present, third-party uploads): queues must be externally synchronized.
+        std::unique_lock<std::mutex> LockQueue(QueueType type) { return std::unique_lock<std::mutex>(m_Queues[m_QueueSlot[static_cast<size_t>(type)]].mutex); }
+
+        // --- Frame Timeline ---
+        // One timeline semaphore counting rendered frames: the renderer's frame submit signals it with
+        // the frame number. Anything used by the frame being recorded (GetCurrentFrame) can be
+        // recycled once IsFrameComplete() says so, a non-blocking counter query.
+        uint64_t GetCurrentFrame() const { return m_CurrentFrame; }
+        GpuTimelinePoint GetFramePoint(uint64_t frame) const { return {m_FrameTimeline, frame}; }
+        bool IsFrameComplete(uint64_t frame) const { return IsComplete(GetFramePoint(frame)); }
+        uint64_t GetCompletedFrame() const;
+        // Called by the renderer once the current frame's submit (signaling GetFramePoint(GetCurrentFrame())) is queued.
+        void AdvanceFrame() { ++m_CurrentFrame; }
+
 
         // --- Public Vulkan Handles and Members ---
         // (Consider making these private with const getters for better encapsulation)
@@ -65,15 +139,22 @@ namespace VulkEng {
 
         VkQueue graphicsQueue = VK_NULL_HANDLE;
         VkQueue presentQueue = VK_NULL_HANDLE;
-        // Optional: computeQueue, transferQueue
+        VkQueue computeQueue = VK_NULL_HANDLE;  // Same as graphicsQueue without a dedicated compute family
+        VkQueue transferQueue = VK_NULL_HANDLE; // Same as graphicsQueue (or computeQueue) without a dedicated transfer family
 
         // Store queue family indices
         uint32_t graphicsQueueFamily = UINT32_MAX; // Use an invalid default
         uint32_t presentQueueFamily = UINT32_MAX;
+        uint32_t computeQueueFamily = UINT32_MAX;
+        uint32_t transferQueueFamily = UINT32_MAX;
 
         // Cached properties and features of the selected physical device
         VkPhysicalDeviceProperties physicalDeviceProperties{};
         VkPhysicalDeviceFeatures physicalDeviceFeatures{};
+        // True if a DEVICE_LOCAL | HOST_VISIBLE | HOST_COHERENT memory type sits on a heap larger than
+        // the legacy 256 MiB BAR window (resizable BAR, or unified memory on integrated GPUs): the CPU can
+        // then write GPU-local buffers directly instead of going through a staging copy.
+        bool hostVisibleDeviceMemory = false;
         // Add VkPhysicalDeviceVulkan11Features, VkPhysicalDeviceVulkan12Features,
         // VkPhysicalDeviceVulkan13Features if specific features are queried and used.
 
@@ -99,9 +180,24 @@ namespace VulkEng {
         bool IsDeviceSuitable(VkPhysicalDevice device); // Helper for PickPhysicalDevice
         bool CheckDeviceExtensionSupport(VkPhysicalDevice device); // Helper for IsDeviceSuitable
         void CreateLogicalDevice();
+        void CreateQueueTimelines(); // After CreateLogicalDevice
 
         // Reference to the application window for surface creation.
         Window& m_Window;
+
+        // One entry per distinct VkQueue; QueueTypes sharing a queue share its entry (lock and timeline).
+        struct QueueSlot {
+            VkQueue queue = VK_NULL_HANDLE;
+            uint32_t family = UINT32_MAX;
+            VkSemaphore timeline = VK_NULL_HANDLE;
+            uint64_t lastSubmitted = 0; // Guarded by `mutex`
+            mutable std::mutex mutex;
+        };
+        std::array<QueueSlot, static_cast<size_t>(QueueType::Count)> m_Queues;
+        std::array<uint32_t, static_cast<size_t>(QueueType::Count)> m_QueueSlot = {0, 0, 0};
+
+        VkSemaphore m_FrameTimeline = VK_NULL_HANDLE;
+        uint64_t m_CurrentFrame = 1; // Frame being recorded; frame N signals value N
     };
 
 } // namespace VulkEng
@@ -1,5 +1,6 @@
 #include "VulkanUtils.h"
 #include "core/Log.h" // For logging within utilities (e.g., warnings)
+#include "core/PerfCounters.h"
 
 #include <vector>
 #include <stdexcept> // For std::runtime_error, std::invalid_argument
@@ -100,7 +101,8 @@ namespace Utils {
         uint32_t width, uint32_t height, uint32_t mipLevels,
         VkSampleCountFlagBits numSamples, VkFormat format, VkImageTiling tiling,
         VkImageUsageFlags usage, VkMemoryPropertyFlags properties,
-        VkImage& outImage, VkDeviceMemory& outImageMemory)
+        VkImage& outImage, VkDeviceMemory& outImageMemory,
+        uint32_t arrayLayers, VkImageCreateFlags flags)
     {
         VkImageCreateInfo imageInfo{};
         imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
@@ -109,7 +111,8 @@ namespace Utils {
         imageInfo.extent.height = height;
         imageInfo.extent.depth = 1;
         imageInfo.mipLevels = mipLevels;
-        imageInfo.arrayLayers = 1;
+        imageInfo.arrayLayers = arrayLayers;
+        imageInfo.flags = flags;
         imageInfo.format = format;
         imageInfo.tiling = tiling;
         imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
@@ -128,13 +131,61 @@ namespace Utils {
         allocInfo.memoryTypeIndex = findMemoryType(physicalDevice, memRequirements.memoryTypeBits, properties);
 
         VK_CHECK(vkAllocateMemory(device, &allocInfo, nullptr, &outImageMemory));
+        PerfCounters::Add(PerfCounter_DeviceAllocations);
+        VK_CHECK(vkBindImageMemory(device, outImage, outImageMemory, 0));
+    }
+
+    // --- createTransientImage Implementation ---
+    void createTransientImage(
+        VkDevice device, VkPhysicalDevice physicalDevice,
+        uint32_t width, uint32_t height, VkSampleCountFlagBits numSamples,
+        VkFormat format, VkImageUsageFlags usage,
+        VkImage& outImage, VkDeviceMemory& outImageMemory)
+    {
+        VkImageCreateInfo imageInfo{VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO};
+        imageInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageInfo.extent = {width, height, 1};
+        imageInfo.mipLevels = 1;
+        imageInfo.arrayLayers = 1;
+        imageInfo.format = format;
+        imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        imageInfo.usage = usage | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+        imageInfo.samples = numSamples;
+        imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        VK_CHECK(vkCreateImage(device, &imageInfo, nullptr, &outImage));
+
+        VkMemoryRequirements memRequirements;
+        vkGetImageMemoryRequirements(device, outImage, &memRequirements);
+
+        // Lazily allocated memory is only committed if the attachment ever has to leave tile memory.
+        VkPhysicalDeviceMemoryProperties memProperties;
+        vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memProperties);
+        const VkMemoryPropertyFlags lazy = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT;
+        uint32_t memoryTypeIndex = UINT32_MAX;
+        for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++) {
+            if ((memRequirements.memoryTypeBits & (1 << i)) && (memProperties.memoryTypes[i].propertyFlags & lazy) == lazy) {
+                memoryTypeIndex = i;
+                break;
+            }
+        }
+        if (memoryTypeIndex == UINT32_MAX) {
+            memoryTypeIndex = findMemoryType(physicalDevice, memRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        }
+
+        VkMemoryAllocateInfo allocInfo{VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO};
+        allocInfo.allocationSize = memRequirements.size;
+        allocInfo.memoryTypeIndex = memoryTypeIndex;
+        VK_CHECK(vkAllocateMemory(device, &allocInfo, nullptr, &outImageMemory));
+        PerfCounters::Add(PerfCounter_DeviceAllocations);
         VK_CHECK(vkBindImageMemory(device, outImage, outImageMemory, 0));
     }
 
     // --- createImageView Implementation ---
     VkImageView createImageView(
         VkDevice device, VkImage image, VkFormat format,
-        VkImageAspectFlags aspectFlags, uint32_t mipLevels)
+        VkImageAspectFlags aspectFlags, uint32_t mipLevels,
+        VkImageViewType viewType, uint32_t layerCount, uint32_t baseMipLevel)
     {
         if (image == VK_NULL_HANDLE) {
              VKENG_ERROR("Utils::createImageView: Attempted to create view for a NULL image.");
@@ -144,17 +195,17 @@ namespace Utils {
         VkImageViewCreateInfo viewInfo{};
         viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
         viewInfo.image = image;
-        viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D; // Assuming 2D, could be param for 1D/3D/Cube
+        viewInfo.viewType = viewType;
         viewInfo.format = format;
         viewInfo.components.r = VK_COMPONENT_SWIZZLE_IDENTITY;
         viewInfo.components.g = VK_COMPONENT_SWIZZLE_IDENTITY;
         viewInfo.components.b = VK_COMPONENT_SWIZZLE_IDENTITY;
         viewInfo.components.a = VK_COMPONENT_SWIZZLE_IDENTITY;
         viewInfo.subresourceRange.aspectMask = aspectFlags;
-        viewInfo.subresourceRange.baseMipLevel = 0;
+        viewInfo.subresourceRange.baseMipLevel = baseMipLevel;
         viewInfo.subresourceRange.levelCount = mipLevels;
         viewInfo.subresourceRange.baseArrayLayer = 0;
-        viewInfo.subresourceRange.layerCount = 1; // Assuming single layer image
+        viewInfo.subresourceRange.layerCount = layerCount;
 
         VkImageView imageView;
         VK_CHECK(vkCreateImageView(device, &viewInfo, nullptr, &imageView));
@@ -182,42 +233,13 @@ namespace Utils {
         return commandBuffer;
     }
 
-    void EndSingleTimeCommands(VkDevice device, VkCommandPool commandPool, VkQueue queue, VkCommandBuffer commandBuffer) {
-        if (device == VK_NULL_HANDLE || commandPool == VK_NULL_HANDLE || queue == VK_NULL_HANDLE || commandBuffer == VK_NULL_HANDLE) {
-            VKENG_ERROR("EndSingleTimeCommands: Invalid device, pool, queue, or command buffer.");
-            // Attempt to free command buffer if possible to avoid leak, though state is bad.
-            if (device != VK_NULL_HANDLE && commandPool != VK_NULL_HANDLE && commandBuffer != VK_NULL_HANDLE) {
-                 vkFreeCommandBuffers(device, commandPool, 1, &commandBuffer);
-            }
-            throw std::runtime_error("Null arguments for ending single time commands.");
-        }
-        VK_CHECK(vkEndCommandBuffer(commandBuffer));
-
-        VkSubmitInfo submitInfo{};
-        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-        submitInfo.commandBufferCount = 1;
-        submitInfo.pCommandBuffers = &commandBuffer;
-
-        VkFence fence;
-        VkFenceCreateInfo fenceInfo{VK_STRUCTURE_TYPE_FENCE_CREATE_INFO};
-        VK_CHECK(vkCreateFence(device, &fenceInfo, nullptr, &fence));
-
-        VK_CHECK(vkQueueSubmit(queue, 1, &submitInfo, fence));
-        VK_CHECK(vkWaitForFences(device, 1, &fence, VK_TRUE, UINT64_MAX)); // Wait indefinitely
-
-        vkDestroyFence(device, fence, nullptr);
-        vkFreeCommandBuffers(device, commandPool, 1, &commandBuffer);
-    }
-
     // --- Resource Transition and Copy Implementations ---
-    void TransitionImageLayout(
-        VkDevice device, VkCommandPool commandPool, VkQueue queue,
+    void RecordTransitionImageLayout(
+        VkCommandBuffer commandBuffer,
         VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout,
         uint32_t mipLevels /*= 1*/, uint32_t baseMipLevel /*= 0*/,
         uint32_t layerCount /*= 1*/, uint32_t baseArrayLayer /*= 0*/)
     {
-        VkCommandBuffer commandBuffer = BeginSingleTimeCommands(device, commandPool);
-
         VkImageMemoryBarrier barrier{};
         barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
         barrier.oldLayout = oldLayout;
@@ -284,30 +306,25 @@ namespace Utils {
             0, nullptr, // Buffer memory barriers
             1, &barrier  // Image memory barriers
         );
-
-        EndSingleTimeCommands(device, commandPool, queue, commandBuffer);
     }
 
-    void CopyBuffer(
-        VkDevice device, VkCommandPool commandPool, VkQueue queue,
+    void RecordCopyBuffer(
+        VkCommandBuffer commandBuffer,
         VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size,
         VkDeviceSize srcOffset /*= 0*/, VkDeviceSize dstOffset /*= 0*/)
     {
-        VkCommandBuffer commandBuffer = BeginSingleTimeCommands(device, commandPool);
         VkBufferCopy copyRegion{};
         copyRegion.srcOffset = srcOffset;
         copyRegion.dstOffset = dstOffset;
         copyRegion.size = size;
-        vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, 1, ©Region);
-        EndSingleTimeCommands(device, commandPool, queue, commandBuffer);
+        vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
     }
 
-    void CopyBufferToImage(
-        VkDevice device, VkCommandPool commandPool, VkQueue queue,
+    void RecordCopyBufferToImage(
+        VkCommandBuffer commandBuffer,
         VkBuffer buffer, VkImage image, uint32_t width, uint32_t height,
         uint32_t layerCount /*= 1*/, uint32_t baseArrayLayer /*= 0*/)
     {
-        VkCommandBuffer commandBuffer = BeginSingleTimeCommands(device, commandPool);
         VkBufferImageCopy region{};
         region.bufferOffset = 0;      // Tightly packed pixel data in buffer
         region.bufferRowLength = 0;   // 0 means texels are tightly packed based on imageExtent.width
@@ -327,13 +344,12 @@ namespace Utils {
             image,
             VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, // Image must be in this layout for copy
             1, // regionCount
-            ®ion
+            &region
         );
-        EndSingleTimeCommands(device, commandPool, queue, commandBuffer);
     }
 
-    void GenerateMipmaps(
-        VkDevice device, VkPhysicalDevice physicalDevice, VkCommandPool commandPool, VkQueue queue,
+    void RecordGenerateMipmaps(
+        VkCommandBuffer commandBuffer, VkPhysicalDevice physicalDevice,
         VkImage image, VkFormat imageFormat, int32_t texWidth, int32_t texHeight, uint32_t mipLevels)
     {
         if (mipLevels <= 1) return; // No mips to generate
@@ -351,9 +367,6 @@ namespace Utils {
             return; // Cannot proceed
         }
 
-
-        VkCommandBuffer commandBuffer = BeginSingleTimeCommands(device, commandPool);
-
         VkImageMemoryBarrier barrier{};
         barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
         barrier.image = image;
@@ -474,10 +487,79 @@ namespace Utils {
                                                                        // Let's assume AssetManager handles the final transition if mipLevels = 1.
                                                                        // This function should ensure all its generated mips end up SHADER_READ_ONLY.
         }
+    }
+
+    // --- Queue Family Ownership Transfer ---
+    // Per the spec, the release's dstAccessMask and the acquire's srcAccessMask are ignored; the
+    // semaphore between the two submissions provides the memory dependency.
+    void ReleaseBufferOwnership(VkCommandBuffer commandBuffer, VkBuffer buffer,
+                                uint32_t srcFamily, uint32_t dstFamily,
+                                VkPipelineStageFlags srcStages, VkAccessFlags srcAccess,
+                                VkDeviceSize offset, VkDeviceSize size) {
+        if (srcFamily == dstFamily) return;
+        VkBufferMemoryBarrier barrier{VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER};
+        barrier.srcAccessMask = srcAccess;
+        barrier.dstAccessMask = 0;
+        barrier.srcQueueFamilyIndex = srcFamily;
+        barrier.dstQueueFamilyIndex = dstFamily;
+        barrier.buffer = buffer;
+        barrier.offset = offset;
+        barrier.size = size;
+        vkCmdPipelineBarrier(commandBuffer, srcStages, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                             0, 0, nullptr, 1, &barrier, 0, nullptr);
+    }
 
+    void AcquireBufferOwnership(VkCommandBuffer commandBuffer, VkBuffer buffer,
+                                uint32_t srcFamily, uint32_t dstFamily,
+                                VkPipelineStageFlags dstStages, VkAccessFlags dstAccess,
+                                VkDeviceSize offset, VkDeviceSize size) {
+        if (srcFamily == dstFamily) return; // The semaphore wait already made the writes visible
+        VkBufferMemoryBarrier barrier{VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER};
+        barrier.srcAccessMask = 0;
+        barrier.dstAccessMask = dstAccess;
+        barrier.srcQueueFamilyIndex = srcFamily;
+        barrier.dstQueueFamilyIndex = dstFamily;
+        barrier.buffer = buffer;
+        barrier.offset = offset;
+        barrier.size = size;
+        vkCmdPipelineBarrier(commandBuffer, dstStages, dstStages, 0, 0, nullptr, 1, &barrier, 0, nullptr);
+    }
+
+    void ReleaseImageOwnership(VkCommandBuffer commandBuffer, VkImage image, const VkImageSubresourceRange& range,
+                               VkImageLayout oldLayout, VkImageLayout newLayout,
+                               uint32_t srcFamily, uint32_t dstFamily,
+                               VkPipelineStageFlags srcStages, VkAccessFlags srcAccess) {
+        if (srcFamily == dstFamily) return; // The acquire does the layout transition
+        VkImageMemoryBarrier barrier{VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER};
+        barrier.srcAccessMask = srcAccess;
+        barrier.dstAccessMask = 0;
+        barrier.oldLayout = oldLayout;
+        barrier.newLayout = newLayout;
+        barrier.srcQueueFamilyIndex = srcFamily;
+        barrier.dstQueueFamilyIndex = dstFamily;
+        barrier.image = image;
+        barrier.subresourceRange = range;
+        vkCmdPipelineBarrier(commandBuffer, srcStages, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                             0, 0, nullptr, 0, nullptr, 1, &barrier);
+    }
 
-        EndSingleTimeCommands(device, commandPool, queue, commandBuffer);
-        VKENG_INFO("Mipmaps generated and layouts transitioned to SHADER_READ_ONLY_OPTIMAL.");
+    void AcquireImageOwnership(VkCommandBuffer commandBuffer, VkImage image, const VkImageSubresourceRange& range,
+                               VkImageLayout oldLayout, VkImageLayout newLayout,
+                               uint32_t srcFamily, uint32_t dstFamily,
+                               VkPipelineStageFlags dstStages, VkAccessFlags dstAccess) {
+        const bool transfer = srcFamily != dstFamily;
+        if (!transfer && oldLayout == newLayout) return;
+        VkImageMemoryBarrier barrier{VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER};
+        barrier.srcAccessMask = 0;
+        barrier.dstAccessMask = dstAccess;
+        barrier.oldLayout = oldLayout;
+        barrier.newLayout = newLayout;
+        barrier.srcQueueFamilyIndex = transfer ? srcFamily : VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = transfer ? dstFamily : VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = image;
+        barrier.subresourceRange = range;
+        // Source stages = the semaphore wait's stages, so the transition happens after the wait.
+        vkCmdPipelineBarrier(commandBuffer, dstStages, dstStages, 0, 0, nullptr, 0, nullptr, 1, &barrier);
     }
 
 
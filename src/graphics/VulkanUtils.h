@@ -64,7 +64,24 @@ namespace Utils {
         VkImageUsageFlags usage,
         VkMemoryPropertyFlags properties, // Memory properties for allocation
         VkImage& outImage,                // Output image handle
-        VkDeviceMemory& outImageMemory    // Output memory handle
+        VkDeviceMemory& outImageMemory,   // Output memory handle
+        uint32_t arrayLayers = 1,         // 6 for cube maps
+        VkImageCreateFlags flags = 0      // e.g., VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT
+    );
+
+    // Creates an attachment image that only lives within a render pass (MSAA samples, subpass
+    // intermediates): adds TRANSIENT_ATTACHMENT usage and backs it with lazily allocated memory where
+    // the device offers it (tile-based GPUs), else with device-local memory.
+    void createTransientImage(
+        VkDevice device,
+        VkPhysicalDevice physicalDevice,
+        uint32_t width,
+        uint32_t height,
+        VkSampleCountFlagBits numSamples,
+        VkFormat format,
+        VkImageUsageFlags usage,
+        VkImage& outImage,
+        VkDeviceMemory& outImageMemory
     );
 
     // Creates a VkImageView for a given VkImage.
@@ -73,27 +90,25 @@ namespace Utils {
         VkImage image,
         VkFormat format,
         VkImageAspectFlags aspectFlags, // e.g., VK_IMAGE_ASPECT_COLOR_BIT, VK_IMAGE_ASPECT_DEPTH_BIT
-        uint32_t mipLevels
+        uint32_t mipLevels,
+        VkImageViewType viewType = VK_IMAGE_VIEW_TYPE_2D, // VK_IMAGE_VIEW_TYPE_CUBE for cube maps
+        uint32_t layerCount = 1,
+        uint32_t baseMipLevel = 0 // With mipLevels = 1, a view of a single mip (e.g., for storage writes)
     );
 
     // --- Command Buffer Utility Functions ---
-    // (These require VkDevice, VkCommandPool, and VkQueue, so they are good utilities)
 
-    // Begins a single-time command buffer from the given pool.
-    // The caller is responsible for ending and submitting it using EndSingleTimeCommands.
+    // Allocates and begins a one-time-submit command buffer from the given pool. The caller ends it and
+    // submits it through VulkanContext::Submit; engine one-off work should use the ImmediateContext instead.
     VkCommandBuffer BeginSingleTimeCommands(VkDevice device, VkCommandPool commandPool);
 
-    // Ends, submits, waits for, and frees a single-time command buffer.
-    void EndSingleTimeCommands(VkDevice device, VkCommandPool commandPool, VkQueue queue, VkCommandBuffer commandBuffer);
-
 
     // --- Resource Transition and Copy Utility Functions ---
+    // These only record into a command buffer in the recording state, typically an ImmediateContext::Recording's.
 
     // Transitions the layout of a VkImage using a pipeline barrier.
-    void TransitionImageLayout(
-        VkDevice device,
-        VkCommandPool commandPool,
-        VkQueue queue,
+    void RecordTransitionImageLayout(
+        VkCommandBuffer commandBuffer,
         VkImage image,
         VkFormat format, // Needed for stencil aspect if applicable
         VkImageLayout oldLayout,
@@ -105,10 +120,8 @@ namespace Utils {
     );
 
     // Copies data from one VkBuffer to another.
-    void CopyBuffer(
-        VkDevice device,
-        VkCommandPool commandPool,
-        VkQueue queue,
+    void RecordCopyBuffer(
+        VkCommandBuffer commandBuffer,
         VkBuffer srcBuffer,
         VkBuffer dstBuffer,
         VkDeviceSize size,
@@ -118,10 +131,8 @@ namespace Utils {
 
     // Copies data from a VkBuffer to a VkImage.
     // Assumes the image is already in VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL.
-    void CopyBufferToImage(
-        VkDevice device,
-        VkCommandPool commandPool,
-        VkQueue queue,
+    void RecordCopyBufferToImage(
+        VkCommandBuffer commandBuffer,
         VkBuffer buffer,
         VkImage image,
         uint32_t width,
@@ -134,11 +145,9 @@ namespace Utils {
     // Image must be in VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL initially for mip 0 copy.
     // Image usage must include VK_IMAGE_USAGE_TRANSFER_SRC_BIT and VK_IMAGE_USAGE_TRANSFER_DST_BIT.
     // Final layout of all mip levels will be VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL.
-    void GenerateMipmaps(
-        VkDevice device,
+    void RecordGenerateMipmaps(
+        VkCommandBuffer commandBuffer,
         VkPhysicalDevice physicalDevice, // Needed to check blit support
-        VkCommandPool commandPool,
-        VkQueue queue,
         VkImage image,
         VkFormat imageFormat,
         int32_t texWidth,
@@ -147,5 +156,29 @@ namespace Utils {
     );
 
 
+    // --- Queue Family Ownership Transfer ---
+    // Moves an exclusive-sharing resource between queue families (e.g., transfer -> graphics).
+    // Record the release on the source queue and the acquire on the destination queue, with
+    // matching families (and layouts, for images); the destination submission must wait on the
+    // source's timeline point with `dstStages`. The release is a no-op when the families match,
+    // and the acquire then only does the layout transition (if any).
+    void ReleaseBufferOwnership(VkCommandBuffer commandBuffer, VkBuffer buffer,
+                                uint32_t srcFamily, uint32_t dstFamily,
+                                VkPipelineStageFlags srcStages, VkAccessFlags srcAccess,
+                                VkDeviceSize offset = 0, VkDeviceSize size = VK_WHOLE_SIZE);
+    void AcquireBufferOwnership(VkCommandBuffer commandBuffer, VkBuffer buffer,
+                                uint32_t srcFamily, uint32_t dstFamily,
+                                VkPipelineStageFlags dstStages, VkAccessFlags dstAccess,
+                                VkDeviceSize offset = 0, VkDeviceSize size = VK_WHOLE_SIZE);
+    void ReleaseImageOwnership(VkCommandBuffer commandBuffer, VkImage image, const VkImageSubresourceRange& range,
+                               VkImageLayout oldLayout, VkImageLayout newLayout,
+                               uint32_t srcFamily, uint32_t dstFamily,
+                               VkPipelineStageFlags srcStages, VkAccessFlags srcAccess);
+    void AcquireImageOwnership(VkCommandBuffer commandBuffer, VkImage image, const VkImageSubresourceRange& range,
+                               VkImageLayout oldLayout, VkImageLayout newLayout,
+                               uint32_t srcFamily, uint32_t dstFamily,
+                               VkPipelineStageFlags dstStages, VkAccessFlags dstAccess);
+
+
 } // namespace Utils
 } // namespace VulkEng
@@ -1,6 +1,7 @@
 #include "PhysicsSystem.h"
 #include "CustomTickCallback.h" // For our custom collision processing
 #include "core/Log.h"           // For logging
+#include "core/PerfCounters.h"
 
 // --- Include Actual Bullet Headers ---
 // This includes most of what's needed for a basic discrete dynamics world.
@@ -122,6 +123,15 @@ namespace VulkEng {
         // if (numSteps > 0) {
         //     VKENG_TRACE("Physics world stepped {} times.", numSteps); // Can be noisy
         // }
+
+        // Contacts as the last substep left them.
+        int contacts = 0;
+        btCollisionDispatcher* dispatcher = m_Dispatcher.get();
+        for (int i = 0; i < dispatcher->getNumManifolds(); ++i) {
+            contacts += dispatcher->getManifoldByIndexInternal(i)->getNumContacts();
+        }
+        PerfCounters::Set(PerfCounter_PhysicsBodies, m_DynamicsWorld->getNumCollisionObjects());
+        PerfCounters::Set(PerfCounter_PhysicsContacts, contacts);
     }
 
     void PhysicsSystem::AddRigidBody(btRigidBody* body) {
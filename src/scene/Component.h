@@ -1,6 +1,7 @@
 #pragma once
 
-#include <string> // For potential component naming or identification
+#include <string>  // For potential component naming or identification
+#include <cstdint> // For uint32_t
 
 namespace VulkEng {
 
@@ -55,6 +56,10 @@ namespace VulkEng {
         friend class GameObject;
         GameObject* m_GameObject = nullptr; // Pointer to the owning GameObject
 
+        // Position in the owning Scene's per-type component list (for O(1) removal).
+        friend class Scene;
+        uint32_t m_SceneListIndex = UINT32_MAX;
+
         // bool m_IsEnabled = true; // Optional enabled state
     };
 
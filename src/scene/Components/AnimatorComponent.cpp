@@ -0,0 +1,88 @@
+#include "AnimatorComponent.h"
+#include "animation/AnimationClip.h"
+#include "animation/Skeleton.h"
+#include "core/Log.h"
+
+#include <algorithm> // For std::min
+
+namespace VulkEng {
+
+    AnimatorComponent::AnimatorComponent(std::shared_ptr<const Skeleton> skeleton) {
+        SetSkeleton(std::move(skeleton));
+    }
+
+    void AnimatorComponent::SetSkeleton(std::shared_ptr<const Skeleton> skeleton) {
+        m_Skeleton = std::move(skeleton);
+        m_Current = {};
+        m_Previous = {};
+        m_CrossfadeDuration = m_CrossfadeElapsed = 0.0f;
+
+        uint32_t jointCount = m_Skeleton ? m_Skeleton->GetJointCount() : 0;
+        m_Pose.Resize(jointCount);
+        m_BlendPose.Resize(jointCount);
+        m_Scratch.Resize(jointCount);
+        m_ModelMatrices.assign(jointCount, glm::mat4(1.0f));
+        m_SkinningMatrices.assign(jointCount, glm::mat4(1.0f));
+        if (m_Skeleton) {
+            m_Pose = m_Skeleton->bindPose;
+            ComputeModelMatrices(*m_Skeleton, m_Pose, m_ModelMatrices.data());
+            ComputeSkinningMatrices(*m_Skeleton, m_ModelMatrices.data(), m_SkinningMatrices.data());
+        }
+    }
+
+    void AnimatorComponent::Play(std::shared_ptr<const AnimationClip> clip, bool loop, float crossfadeSeconds) {
+        if (clip && !IsCompatible(*clip)) {
+            VKENG_ERROR("AnimatorComponent: Clip '{}' animates {} joints but the skeleton has {}.",
+                        clip->GetName(), clip->GetJointCount(), m_Skeleton ? m_Skeleton->GetJointCount() : 0);
+            return;
+        }
+        if (crossfadeSeconds > 0.0f && m_Current.clip) {
+            m_Previous = m_Current;
+            m_CrossfadeDuration = crossfadeSeconds;
+            m_CrossfadeElapsed = 0.0f;
+        } else {
+            m_Previous = {};
+            m_CrossfadeDuration = 0.0f;
+        }
+        m_Current.clip = std::move(clip);
+        m_Current.time = 0.0f;
+        m_Current.loop = loop;
+    }
+
+    void AnimatorComponent::Stop() {
+        m_Current = {};
+        m_Previous = {};
+        m_CrossfadeDuration = 0.0f;
+    }
+
+    void AnimatorComponent::Update(float deltaTime) {
+        if (!m_Skeleton || !m_Current.clip) return;
+
+        float step = deltaTime * m_Speed;
+        m_Current.time += step;
+        if (m_Previous.clip) {
+            m_Previous.time += step;
+            m_CrossfadeElapsed += deltaTime;
+            if (m_CrossfadeElapsed >= m_CrossfadeDuration) {
+                m_Previous = {};
+            }
+        }
+        Evaluate();
+    }
+
+    void AnimatorComponent::Evaluate() {
+        m_Current.clip->Sample(m_Current.time, m_Current.loop, m_Pose, m_Scratch);
+        if (m_Previous.clip) {
+            m_Previous.clip->Sample(m_Previous.time, m_Previous.loop, m_BlendPose, m_Scratch);
+            float weight = std::min(m_CrossfadeElapsed / m_CrossfadeDuration, 1.0f);
+            BlendPoses(m_BlendPose, m_Pose, weight, m_Pose);
+        }
+        ComputeModelMatrices(*m_Skeleton, m_Pose, m_ModelMatrices.data());
+        ComputeSkinningMatrices(*m_Skeleton, m_ModelMatrices.data(), m_SkinningMatrices.data());
+    }
+
+    bool AnimatorComponent::IsCompatible(const AnimationClip& clip) const {
+        return m_Skeleton && clip.GetJointCount() == m_Skeleton->GetJointCount();
+    }
+
+} // namespace VulkEng
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "scene/Component.h" // Base class for components
+#include "animation/Pose.h"
+
+#include <glm/glm.hpp>
+#include <memory>
+#include <vector>
+
+namespace VulkEng {
+
+    struct Skeleton;
+    class AnimationClip;
+
+    // Plays AnimationClips on a skeleton and produces the skinning matrices the renderer uploads
+    // for the GameObject's skinned meshes. Update() only touches this component's own state, so
+    // animators are updated in parallel chunks by a ComponentUpdateSystem.
+    class AnimatorComponent : public Component {
+    public:
+        AnimatorComponent() = default;
+        explicit AnimatorComponent(std::shared_ptr<const Skeleton> skeleton);
+        virtual ~AnimatorComponent() = default;
+
+        // Resets playback and sizes the pose buffers; skinning matrices start at the bind pose.
+        void SetSkeleton(std::shared_ptr<const Skeleton> skeleton);
+        const std::shared_ptr<const Skeleton>& GetSkeleton() const { return m_Skeleton; }
+
+        // Starts `clip` from the beginning. With `crossfadeSeconds` > 0 the previous clip keeps
+        // playing and is blended out over that time.
+        void Play(std::shared_ptr<const AnimationClip> clip, bool loop = true, float crossfadeSeconds = 0.0f);
+        void Stop();
+        bool IsPlaying() const { return m_Current.clip != nullptr; }
+        const std::shared_ptr<const AnimationClip>& GetClip() const { return m_Current.clip; }
+        bool IsLooping() const { return m_Current.loop; }
+
+        void SetSpeed(float speed) { m_Speed = speed; }
+        float GetSpeed() const { return m_Speed; }
+        float GetTime() const { return m_Current.time; }
+        // Seeks the current clip, e.g. to restore saved playback; takes effect on the next Update.
+        void SetTime(float time) { m_Current.time = time; }
+
+        // Advances playback by `deltaTime` and evaluates the pose.
+        void Update(float deltaTime) override;
+
+        // Model-space joint matrices (e.g. for attaching objects to bones) and their skinning counterparts.
+        const std::vector<glm::mat4>& GetJointModelMatrices() const { return m_ModelMatrices; }
+        const std::vector<glm::mat4>& GetSkinningMatrices() const { return m_SkinningMatrices; }
+
+    private:
+        struct PlaybackState {
+            std::shared_ptr<const AnimationClip> clip;
+            float time = 0.0f;
+            bool loop = true;
+        };
+
+        void Evaluate();
+        bool IsCompatible(const AnimationClip& clip) const;
+
+        std::shared_ptr<const Skeleton> m_Skeleton;
+        PlaybackState m_Current;
+        PlaybackState m_Previous; // Fading out
+        float m_CrossfadeDuration = 0.0f;
+        float m_CrossfadeElapsed = 0.0f;
+        float m_Speed = 1.0f;
+
+        Pose m_Pose;
+        Pose m_BlendPose;
+        Pose m_Scratch;
+        std::vector<glm::mat4> m_ModelMatrices;
+        std::vector<glm::mat4> m_SkinningMatrices;
+    };
+
+} // namespace VulkEng
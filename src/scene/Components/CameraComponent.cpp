@@ -2,6 +2,8 @@
 #include "scene/GameObject.h" // Optional: If OnAttach/OnDetach needed to interact with GameObject
 #include "core/Log.h"         // Optional: For logging camera-specific events
 
+#include <cmath> // For std::tan
+
 namespace VulkEng {
 
     // --- Constructor (if not defaulted or inlined in header) ---
@@ -19,30 +21,80 @@ namespace VulkEng {
     // }
 
 
-    // --- Method Implementations (if moved from header) ---
-    // SetPerspective, SetOrthographic, SetOrthographicSize, UpdateViewMatrix,
-    // RecalculateProjectionMatrix, and getters are currently inline in CameraComponent.h.
-    // If any of these become significantly complex, their implementations would be moved here.
-
-    /* Example if UpdateViewMatrix was moved here:
+    // --- Method Implementations ---
     void CameraComponent::UpdateViewMatrix(const TransformComponent& transform) {
         const glm::vec3& position = transform.GetPosition();
-        glm::vec3 target = position + transform.GetForward();
-        glm::vec3 up = transform.GetUp();
-        m_ViewMatrix = glm::lookAt(position, target, up);
+        const glm::quat& rotation = transform.GetRotation();
+        if (m_HasView && position == m_ViewPosition && rotation == m_ViewRotation) return;
+        m_ViewPosition = position;
+        m_ViewRotation = rotation;
+        m_HasView = true;
+
+        // The camera looks down its local -Z with +Y up, so the view matrix is simply the inverse
+        // of its rigid transform (scale ignored): the transposed rotation and the rotated, negated
+        // position. Same result as glm::lookAt(position, position + forward, up), without the
+        // cross products and normalizations. The rotation is kept normalized by TransformComponent.
+        glm::mat3 rotationMatrix = glm::mat3_cast(rotation);
+        m_InverseViewMatrix = glm::mat4(rotationMatrix);
+        m_InverseViewMatrix[3] = glm::vec4(position, 1.0f);
+
+        glm::mat3 inverseRotation = glm::transpose(rotationMatrix);
+        m_ViewMatrix = glm::mat4(inverseRotation);
+        m_ViewMatrix[3] = glm::vec4(-(inverseRotation * position), 1.0f);
+
+        RecalculateDerivedMatrices();
     }
-    */
 
-    /* Example if RecalculateProjectionMatrix was moved here:
     void CameraComponent::RecalculateProjectionMatrix() {
+        m_ProjectionMatrix = glm::mat4(0.0f);
         if (m_IsOrthographic) {
-            m_ProjectionMatrix = glm::ortho(m_OrthoLeft, m_OrthoRight, m_OrthoBottom, m_OrthoTop, m_NearPlane, m_FarPlane);
+            float width = m_OrthoRight - m_OrthoLeft;
+            float height = m_OrthoTop - m_OrthoBottom;
+            float depth = m_FarPlane - m_NearPlane;
+            m_ProjectionMatrix[0][0] = 2.0f / width;
+            m_ProjectionMatrix[1][1] = -2.0f / height; // Vulkan Y-flip
+            m_ProjectionMatrix[3][0] = -(m_OrthoRight + m_OrthoLeft) / width;
+            m_ProjectionMatrix[3][1] = (m_OrthoTop + m_OrthoBottom) / height;
+            if (m_ReversedZ) { // Near -> 1, far -> 0
+                m_ProjectionMatrix[2][2] = 1.0f / depth;
+                m_ProjectionMatrix[3][2] = m_FarPlane / depth;
+            } else {           // Near -> 0, far -> 1
+                m_ProjectionMatrix[2][2] = -1.0f / depth;
+                m_ProjectionMatrix[3][2] = -m_NearPlane / depth;
+            }
+            m_ProjectionMatrix[3][3] = 1.0f;
         } else {
-            m_ProjectionMatrix = glm::perspective(m_FovRadians, m_AspectRatio, m_NearPlane, m_FarPlane);
+            float focalLength = 1.0f / std::tan(m_FovRadians * 0.5f);
+            m_ProjectionMatrix[0][0] = focalLength / m_AspectRatio;
+            m_ProjectionMatrix[1][1] = -focalLength; // Vulkan Y-flip
+            m_ProjectionMatrix[2][3] = -1.0f;        // clip.w = -viewZ
+            if (m_ReversedZ) {
+                // Infinite far plane: depth = near / -viewZ, 1 at the near plane, 0 at infinity.
+                m_ProjectionMatrix[3][2] = m_NearPlane;
+            } else {
+                m_ProjectionMatrix[2][2] = m_FarPlane / (m_NearPlane - m_FarPlane);
+                m_ProjectionMatrix[3][2] = m_NearPlane * m_FarPlane / (m_NearPlane - m_FarPlane);
+            }
         }
-        m_ProjectionMatrix[1][1] *= -1; // Vulkan Y-flip
+        // Only happens on projection changes (resize, FOV), so the general inverse is fine here.
+        m_InverseProjectionMatrix = glm::inverse(m_ProjectionMatrix);
+        RecalculateDerivedMatrices();
+    }
+
+    void CameraComponent::RecalculateDerivedMatrices() {
+        m_ViewProjectionMatrix = m_ProjectionMatrix * m_ViewMatrix;
+        m_InverseViewProjectionMatrix = m_InverseViewMatrix * m_InverseProjectionMatrix;
+        m_Frustum = Frustum::FromMatrix(m_ViewProjectionMatrix);
+        ++m_Version;
+    }
+
+    void CameraComponent::GetPickRay(const glm::vec2& ndc, glm::vec3& outOrigin, glm::vec3& outDirection) const {
+        // Near plane point and one halfway into the depth range (the far plane may be at infinity).
+        glm::vec4 nearPoint = m_InverseViewProjectionMatrix * glm::vec4(ndc, m_ReversedZ ? 1.0f : 0.0f, 1.0f);
+        glm::vec4 midPoint = m_InverseViewProjectionMatrix * glm::vec4(ndc, 0.5f, 1.0f);
+        outOrigin = glm::vec3(nearPoint) / nearPoint.w;
+        outDirection = glm::normalize(glm::vec3(midPoint) / midPoint.w - outOrigin);
     }
-    */
 
 
     // --- Optional: Component Lifecycle Methods Implementation ---
@@ -73,7 +125,4 @@ namespace VulkEng {
     // }
 
 
-    // This .cpp file primarily serves as a placeholder for non-inline implementations
-    // if the methods in CameraComponent.h become more complex.
-
 } // namespace VulkEng
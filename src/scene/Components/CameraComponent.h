@@ -2,10 +2,11 @@
 
 #include "scene/Component.h" // Base class for components
 #include "scene/Components/TransformComponent.h" // Often needed to calculate view matrix
+#include "graphics/Frustum.h"                    // Cached frustum planes
 
 #include <glm/glm.hpp>
-#include <glm/gtc/matrix_transform.hpp> // For glm::lookAt, glm::perspective, glm::ortho
-#include <glm/gtc/quaternion.hpp>       // For potential orientation if not using LookAt directly
+#include <glm/gtc/quaternion.hpp>       // View matrix is built from the transform's rotation
+#include <cstdint>
 
 namespace VulkEng {
 
@@ -67,66 +68,76 @@ namespace VulkEng {
         }
 
 
-        // --- View Matrix Calculation ---
-        // Updates the view matrix based on the provided TransformComponent's state.
-        // This is typically called by the Scene before rendering or by the camera controller.
-        void UpdateViewMatrix(const TransformComponent& transform) {
-            const glm::vec3& position = transform.GetPosition();
-            // Use GetForward() from TransformComponent, which is calculated from its rotation.
-            // The target for lookAt is position + forward.
-            glm::vec3 target = position + transform.GetForward();
-            glm::vec3 up = transform.GetUp(); // GetUp is also calculated from rotation
-
-            m_ViewMatrix = glm::lookAt(position, target, up);
+        // Reversed-Z maps the near plane to depth 1 and (for perspective) an infinite far plane to 0.
+        // With a float depth buffer this spreads precision evenly over distance; the renderer
+        // switches its depth test and clear value to match the main camera.
+        void SetReversedZ(bool reversedZ) {
+            if (m_ReversedZ == reversedZ) return;
+            m_ReversedZ = reversedZ;
+            RecalculateProjectionMatrix();
         }
+        bool IsReversedZ() const { return m_ReversedZ; }
+        // Depth of a pixel nothing was drawn to (the depth buffer's clear value).
+        float GetClearDepth() const { return m_ReversedZ ? 0.0f : 1.0f; }
+
+
+        // --- View Matrix Calculation ---
+        // Updates the view matrix (and everything derived from it) from the transform's position
+        // and rotation. Does nothing if neither changed since the last call, so it is cheap to call
+        // every frame. Called by Scene::Update for the main camera.
+        void UpdateViewMatrix(const TransformComponent& transform);
 
 
         // --- Accessors ---
+        // All cached; recomputed only when the transform or the projection changes.
         const glm::mat4& GetViewMatrix() const { return m_ViewMatrix; }
         const glm::mat4& GetProjectionMatrix() const { return m_ProjectionMatrix; }
+        const glm::mat4& GetViewProjectionMatrix() const { return m_ViewProjectionMatrix; }
+        const glm::mat4& GetInverseViewMatrix() const { return m_InverseViewMatrix; } // Camera-to-world
+        const glm::mat4& GetInverseProjectionMatrix() const { return m_InverseProjectionMatrix; }
+        const glm::mat4& GetInverseViewProjectionMatrix() const { return m_InverseViewProjectionMatrix; }
+        const Frustum& GetFrustum() const { return m_Frustum; } // World space
+        glm::vec3 GetPosition() const { return glm::vec3(m_InverseViewMatrix[3]); }
+        // Incremented whenever any cached matrix changes, for consumers that cache results per camera state.
+        uint32_t GetVersion() const { return m_Version; }
+
+        // World-space ray through a point in normalized device coordinates ([-1, 1], +Y down as in Vulkan).
+        void GetPickRay(const glm::vec2& ndc, glm::vec3& outOrigin, glm::vec3& outDirection) const;
 
         float GetNearPlane() const { return m_NearPlane; }
-        float GetFarPlane() const { return m_FarPlane; }
+        float GetFarPlane() const { return m_FarPlane; } // Unused by reversed-Z perspective (infinite)
         float GetFov() const { return m_IsOrthographic ? 0.0f : m_FovRadians; } // FOV only for perspective
         float GetAspectRatio() const { return m_AspectRatio; }
         bool IsOrthographic() const { return m_IsOrthographic; }
+        // Orthographic view box as (left, right, bottom, top). Only meaningful if IsOrthographic().
+        glm::vec4 GetOrthographicBounds() const { return glm::vec4(m_OrthoLeft, m_OrthoRight, m_OrthoBottom, m_OrthoTop); }
 
         // --- Component Lifecycle (Optional) ---
         // void OnAttach() override;
         // void Update(float deltaTime) override; // e.g., for camera shake, smooth follow, etc.
 
     private:
-        void RecalculateProjectionMatrix() {
-            if (m_IsOrthographic) {
-                m_ProjectionMatrix = glm::ortho(m_OrthoLeft, m_OrthoRight, m_OrthoBottom, m_OrthoTop, m_NearPlane, m_FarPlane);
-            } else {
-                m_ProjectionMatrix = glm::perspective(m_FovRadians, m_AspectRatio, m_NearPlane, m_FarPlane);
-            }
-            // Apply Vulkan NDC correction (Y-flip and potentially depth range adjustment if not using 0-1)
-            // GLM's perspective and ortho are designed for OpenGL's NDC (-1 to 1 depth, Y up).
-            // Vulkan NDC: Y down, Depth 0 to 1.
-            // The Y-flip is common:
-            m_ProjectionMatrix[1][1] *= -1;
-
-            // If depth range was -1 to 1 and Vulkan needs 0 to 1:
-            // (This is often handled by viewport settings or depth clear values,
-            // but some prefer to bake it into the projection matrix).
-            // For GLM_FORCE_DEPTH_ZERO_TO_ONE defined, glm::perspective already does this.
-            // If not, manual adjustment might look like:
-            // glm::mat4 vulkanClip = glm::mat4(1.0f,  0.0f, 0.0f, 0.0f,
-            //                                0.0f, -1.0f, 0.0f, 0.0f, // Y-flip
-            //                                0.0f,  0.0f, 0.5f, 0.0f, // Depth remap
-            //                                0.0f,  0.0f, 0.5f, 1.0f);
-            // m_ProjectionMatrix = vulkanClip * m_ProjectionMatrix;
-            // For simplicity, we only apply the Y-flip, assuming GLM_FORCE_DEPTH_ZERO_TO_ONE
-            // is defined or Vulkan's depth handling (clear to 1.0, compare op LESS) works correctly.
-        }
-
-        // View Matrix (World to Camera Space)
-        glm::mat4 m_ViewMatrix = glm::mat4(1.0f); // Initialized to identity
-
-        // Projection Matrix (Camera Space to Clip Space)
-        glm::mat4 m_ProjectionMatrix = glm::mat4(1.0f);
+        // Builds the projection directly in Vulkan clip space (Y down, depth [0, 1]).
+        void RecalculateProjectionMatrix();
+        // View-projection, its inverse and the frustum, from the current view and projection.
+        void RecalculateDerivedMatrices();
+
+        // Cached matrices
+        glm::mat4 m_ViewMatrix = glm::mat4(1.0f);           // World to camera space
+        glm::mat4 m_InverseViewMatrix = glm::mat4(1.0f);
+        glm::mat4 m_ProjectionMatrix = glm::mat4(1.0f);     // Camera space to clip space
+        glm::mat4 m_InverseProjectionMatrix = glm::mat4(1.0f);
+        glm::mat4 m_ViewProjectionMatrix = glm::mat4(1.0f);
+        glm::mat4 m_InverseViewProjectionMatrix = glm::mat4(1.0f);
+        Frustum m_Frustum;
+        uint32_t m_Version = 0;
+
+        // Transform state the view matrix was built from
+        glm::vec3 m_ViewPosition = glm::vec3(0.0f);
+        glm::quat m_ViewRotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+        bool m_HasView = false;
+
+        bool m_ReversedZ = true;
 
         // Projection Parameters
         bool m_IsOrthographic = false;
@@ -0,0 +1,206 @@
+#include "InstancedMeshComponent.h"
+#include "assets/Mesh.h"
+#include "graphics/Buffer.h" // For VulkanBuffer (destroyed through m_GpuBuffer)
+#include "core/Log.h"
+
+#include <glm/gtc/packing.hpp> // For packUnorm4x8
+#include <algorithm> // For std::min, std::max, std::copy
+#include <cmath>     // For std::abs
+#include <limits>
+
+namespace VulkEng {
+
+    void InstancedMeshComponent::SetMesh(const Mesh* mesh) {
+        m_Mesh = mesh;
+        // Chunk bounds include the mesh extent.
+        for (Chunk& chunk : m_Chunks) chunk.boundsDirty = true;
+    }
+
+    InstanceData InstancedMeshComponent::PackInstance(const InstanceTransform& transform, const glm::vec4& color) {
+        glm::mat3 basis = glm::mat3_cast(transform.rotation);
+        basis[0] *= transform.scale.x;
+        basis[1] *= transform.scale.y;
+        basis[2] *= transform.scale.z;
+
+        InstanceData data;
+        for (int row = 0; row < 3; ++row) {
+            data.rows[row] = glm::vec4(basis[0][row], basis[1][row], basis[2][row], transform.position[row]);
+        }
+        data.color = glm::packUnorm4x8(color);
+        return data;
+    }
+
+    InstanceData InstancedMeshComponent::PackInstance(const glm::mat4& transform, const glm::vec4& color) {
+        InstanceData data;
+        for (int row = 0; row < 3; ++row) {
+            data.rows[row] = glm::vec4(transform[0][row], transform[1][row], transform[2][row], transform[3][row]);
+        }
+        data.color = glm::packUnorm4x8(color);
+        return data;
+    }
+
+    void InstancedMeshComponent::SetInstances(const InstanceData* instances, size_t count) {
+        m_Instances.assign(instances, instances + count);
+        ResizeChunks();
+        m_DirtyBegin = m_DirtyEnd = 0; // Anything beyond `count` no longer exists
+        MarkDirty(0, count);
+    }
+
+    void InstancedMeshComponent::SetInstances(const InstanceTransform* transforms, size_t count) {
+        m_Instances.resize(count);
+        for (size_t i = 0; i < count; ++i) {
+            m_Instances[i] = PackInstance(transforms[i]);
+        }
+        ResizeChunks();
+        m_DirtyBegin = m_DirtyEnd = 0; // Anything beyond `count` no longer exists
+        MarkDirty(0, count);
+    }
+
+    void InstancedMeshComponent::AddInstances(const InstanceData* instances, size_t count) {
+        size_t first = m_Instances.size();
+        m_Instances.insert(m_Instances.end(), instances, instances + count);
+        ResizeChunks();
+        MarkDirty(first, count);
+    }
+
+    void InstancedMeshComponent::UpdateInstances(size_t first, const InstanceData* instances, size_t count) {
+        if (first + count > m_Instances.size()) {
+            VKENG_ERROR("InstancedMeshComponent::UpdateInstances: Range [{}, {}) exceeds instance count {}.",
+                        first, first + count, m_Instances.size());
+            return;
+        }
+        std::copy(instances, instances + count, m_Instances.begin() + first);
+        MarkDirty(first, count);
+    }
+
+    void InstancedMeshComponent::UpdateTransforms(size_t first, const InstanceTransform* transforms, size_t count) {
+        if (first + count > m_Instances.size()) {
+            VKENG_ERROR("InstancedMeshComponent::UpdateTransforms: Range [{}, {}) exceeds instance count {}.",
+                        first, first + count, m_Instances.size());
+            return;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            uint32_t color = m_Instances[first + i].color;
+            m_Instances[first + i] = PackInstance(transforms[i]);
+            m_Instances[first + i].color = color;
+        }
+        MarkDirty(first, count);
+    }
+
+    InstanceData* InstancedMeshComponent::MapInstances(size_t first, size_t count) {
+        if (first + count > m_Instances.size()) {
+            VKENG_ERROR("InstancedMeshComponent::MapInstances: Range [{}, {}) exceeds instance count {}.",
+                        first, first + count, m_Instances.size());
+            return nullptr;
+        }
+        MarkDirty(first, count);
+        return m_Instances.data() + first;
+    }
+
+    void InstancedMeshComponent::Clear() {
+        m_Instances.clear();
+        m_Chunks.clear();
+        m_DirtyBegin = m_DirtyEnd = 0;
+    }
+
+    size_t InstancedMeshComponent::AddInstance(const InstanceTransform& transform, const glm::vec4& color) {
+        InstanceData data = PackInstance(transform, color);
+        AddInstances(&data, 1);
+        return m_Instances.size() - 1;
+    }
+
+    void InstancedMeshComponent::SetInstanceTransform(size_t index, const InstanceTransform& transform) {
+        UpdateTransforms(index, &transform, 1);
+    }
+
+    void InstancedMeshComponent::SetInstanceColor(size_t index, const glm::vec4& color) {
+        if (index >= m_Instances.size()) return;
+        m_Instances[index].color = glm::packUnorm4x8(color);
+        MarkDirty(index, 1);
+    }
+
+    void InstancedMeshComponent::RemoveInstance(size_t index) {
+        if (index >= m_Instances.size()) return;
+        size_t last = m_Instances.size() - 1;
+        if (index != last) {
+            m_Instances[index] = m_Instances[last];
+            MarkDirty(index, 1);
+        }
+        m_Instances.pop_back();
+        // The chunk that lost its last instance needs new bounds too.
+        if (!m_Chunks.empty()) m_Chunks[last / InstancesPerChunk].boundsDirty = true;
+        ResizeChunks();
+        m_DirtyEnd = std::min(m_DirtyEnd, m_Instances.size());
+        if (m_DirtyBegin >= m_DirtyEnd) m_DirtyBegin = m_DirtyEnd = 0;
+    }
+
+    void InstancedMeshComponent::UpdateChunkBounds() {
+        glm::vec3 meshMin(0.0f), meshMax(0.0f);
+        if (m_Mesh) {
+            meshMin = m_Mesh->boundsMin;
+            meshMax = m_Mesh->boundsMax;
+        }
+        const glm::vec3 meshCenter = (meshMin + meshMax) * 0.5f;
+        const glm::vec3 meshExtent = (meshMax - meshMin) * 0.5f;
+
+        for (size_t chunkIndex = 0; chunkIndex < m_Chunks.size(); ++chunkIndex) {
+            Chunk& chunk = m_Chunks[chunkIndex];
+            if (!chunk.boundsDirty) continue;
+
+            size_t begin = chunkIndex * InstancesPerChunk;
+            size_t end = std::min(begin + InstancesPerChunk, m_Instances.size());
+            glm::vec3 chunkMin(std::numeric_limits<float>::max());
+            glm::vec3 chunkMax(std::numeric_limits<float>::lowest());
+            for (size_t i = begin; i < end; ++i) {
+                const glm::vec4* rows = m_Instances[i].rows;
+                // Mesh box under the instance's affine transform (center + absolute-basis extent).
+                glm::vec3 center, extent;
+                for (int axis = 0; axis < 3; ++axis) {
+                    const glm::vec4& r = rows[axis];
+                    center[axis] = r.x * meshCenter.x + r.y * meshCenter.y + r.z * meshCenter.z + r.w;
+                    extent[axis] = std::abs(r.x) * meshExtent.x + std::abs(r.y) * meshExtent.y + std::abs(r.z) * meshExtent.z;
+                }
+                chunkMin = glm::min(chunkMin, center - extent);
+                chunkMax = glm::max(chunkMax, center + extent);
+            }
+            chunk.boundsMin = chunkMin;
+            chunk.boundsMax = chunkMax;
+            chunk.boundsDirty = false;
+        }
+    }
+
+    void InstancedMeshComponent::GetDirtyRange(size_t& first, size_t& count) const {
+        first = m_DirtyBegin;
+        count = m_DirtyEnd - m_DirtyBegin;
+    }
+
+    void InstancedMeshComponent::ClearDirtyRange() {
+        m_DirtyBegin = m_DirtyEnd = 0;
+    }
+
+    void InstancedMeshComponent::SetGpuBuffer(std::shared_ptr<VulkanBuffer> buffer, size_t capacity) {
+        m_GpuBuffer = std::move(buffer);
+        m_GpuCapacity = m_GpuBuffer ? capacity : 0;
+    }
+
+    void InstancedMeshComponent::MarkDirty(size_t first, size_t count) {
+        if (count == 0) return;
+        if (m_DirtyBegin == m_DirtyEnd) {
+            m_DirtyBegin = first;
+            m_DirtyEnd = first + count;
+        } else {
+            m_DirtyBegin = std::min(m_DirtyBegin, first);
+            m_DirtyEnd = std::max(m_DirtyEnd, first + count);
+        }
+        size_t firstChunk = first / InstancesPerChunk;
+        size_t lastChunk = (first + count - 1) / InstancesPerChunk;
+        for (size_t chunkIndex = firstChunk; chunkIndex <= lastChunk && chunkIndex < m_Chunks.size(); ++chunkIndex) {
+            m_Chunks[chunkIndex].boundsDirty = true;
+        }
+    }
+
+    void InstancedMeshComponent::ResizeChunks() {
+        m_Chunks.resize((m_Instances.size() + InstancesPerChunk - 1) / InstancesPerChunk);
+    }
+
+} // namespace VulkEng
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "scene/Component.h" // Base class for components
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace VulkEng {
+
+    struct Mesh;
+    class VulkanBuffer;
+
+    // Per-instance vertex data, exactly as uploaded to the GPU (binding 1 of the instanced pipeline).
+    // The transform is relative to the owning GameObject's TransformComponent.
+    struct InstanceData {
+        glm::vec4 rows[3];  // Top three rows of the affine instance matrix (translation in w)
+        uint32_t color = 0xFFFFFFFFu; // RGBA8, multiplied with the vertex color
+    };
+
+    struct InstanceTransform {
+        glm::vec3 position = glm::vec3(0.0f);
+        glm::quat rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+        glm::vec3 scale = glm::vec3(1.0f);
+    };
+
+    // Draws one mesh many times from a compact instance array instead of one GameObject per copy,
+    // for foliage, debris and other static props. Instances are grouped into fixed-size chunks
+    // with cached bounds; the renderer culls whole chunks and draws the visible ones with one
+    // instanced draw per contiguous run. Edits mark a dirty range that is uploaded on the next frame,
+    // so bulk updates should go through the range functions (or MapInstances) rather than per-instance calls.
+    class InstancedMeshComponent : public Component {
+    public:
+        static constexpr uint32_t InstancesPerChunk = 1024;
+
+        struct Chunk {
+            glm::vec3 boundsMin = glm::vec3(0.0f); // Local space, includes the mesh extent
+            glm::vec3 boundsMax = glm::vec3(0.0f);
+            bool boundsDirty = true;
+        };
+
+        InstancedMeshComponent() = default;
+        explicit InstancedMeshComponent(const Mesh* mesh) : m_Mesh(mesh) {}
+        virtual ~InstancedMeshComponent() = default;
+
+        // `mesh` is owned by the AssetManager, as for MeshComponent.
+        void SetMesh(const Mesh* mesh);
+        const Mesh* GetMesh() const { return m_Mesh; }
+
+        static InstanceData PackInstance(const InstanceTransform& transform, const glm::vec4& color = glm::vec4(1.0f));
+        static InstanceData PackInstance(const glm::mat4& transform, const glm::vec4& color = glm::vec4(1.0f));
+
+        // --- Bulk editing ---
+        void Reserve(size_t count) { m_Instances.reserve(count); }
+        void SetInstances(const InstanceData* instances, size_t count);
+        void SetInstances(const InstanceTransform* transforms, size_t count);
+        void AddInstances(const InstanceData* instances, size_t count);
+        // Overwrites `count` instances starting at `first` (which must already exist).
+        void UpdateInstances(size_t first, const InstanceData* instances, size_t count);
+        void UpdateTransforms(size_t first, const InstanceTransform* transforms, size_t count);
+        // Grants direct write access to [first, first + count), e.g. to fill from JobSystem workers.
+        // The range is marked dirty; the pointer is valid until the instance count changes.
+        InstanceData* MapInstances(size_t first, size_t count);
+        void Clear();
+
+        // --- Single instances ---
+        size_t AddInstance(const InstanceTransform& transform, const glm::vec4& color = glm::vec4(1.0f));
+        void SetInstanceTransform(size_t index, const InstanceTransform& transform);
+        void SetInstanceColor(size_t index, const glm::vec4& color);
+        // Moves the last instance into `index`, so indices of other instances are not stable across removals.
+        void RemoveInstance(size_t index);
+
+        size_t GetInstanceCount() const { return m_Instances.size(); }
+        const InstanceData* GetInstanceData() const { return m_Instances.data(); }
+
+        // --- Renderer interface ---
+        // Recomputes the bounds of chunks edited since the last call.
+        void UpdateChunkBounds();
+        const std::vector<Chunk>& GetChunks() const { return m_Chunks; }
+
+        // Instance range not yet uploaded to the GPU buffer; empty when count is 0.
+        void GetDirtyRange(size_t& first, size_t& count) const;
+        void ClearDirtyRange();
+
+        // GPU copy of the instance array, created and resized by the Renderer. Shared so a frame
+        // still in flight keeps it alive after this component is destroyed.
+        const std::shared_ptr<VulkanBuffer>& GetGpuBuffer() const { return m_GpuBuffer; }
+        void SetGpuBuffer(std::shared_ptr<VulkanBuffer> buffer, size_t capacity);
+        size_t GetGpuCapacity() const { return m_GpuCapacity; }
+
+    private:
+        void MarkDirty(size_t first, size_t count);
+        void ResizeChunks();
+
+        const Mesh* m_Mesh = nullptr;
+        std::vector<InstanceData> m_Instances;
+        std::vector<Chunk> m_Chunks;
+
+        size_t m_DirtyBegin = 0; // Half-open range of instances changed since the last upload
+        size_t m_DirtyEnd = 0;
+
+        std::shared_ptr<VulkanBuffer> m_GpuBuffer;
+        size_t m_GpuCapacity = 0; // In instances
+    };
+
+} // namespace VulkEng
@@ -0,0 +1,45 @@
+#include "ParticleEmitterComponent.h"
+
+#include <algorithm> // For std::min
+#include <cmath>     // For std::floor
+
+namespace VulkEng {
+
+    namespace {
+        // Larger gaps (hitches, breakpoints) are simulated as this much time, so particles don't tunnel.
+        constexpr float MaxStepSeconds = 0.1f;
+    }
+
+    void ParticleEmitterComponent::Update(float deltaTime) {
+        m_PendingTime += deltaTime;
+        if (m_Emitting) {
+            m_EmitAccumulator += m_Settings.emitRate * deltaTime;
+        }
+    }
+
+    ParticleEmitParams ParticleEmitterComponent::TakeStep(const glm::vec3& worldPosition) {
+        ParticleEmitParams params;
+        params.positionRadius = glm::vec4(worldPosition, m_Settings.emitRadius);
+        params.velocitySpread = glm::vec4(m_Settings.velocity, m_Settings.velocitySpread);
+        params.gravityDrag = glm::vec4(m_Settings.gravity, m_Settings.drag);
+        params.lifeSize = glm::vec4(m_Settings.lifetimeMin, m_Settings.lifetimeMax, m_Settings.sizeStart, m_Settings.sizeEnd);
+        params.colorStart = m_Settings.colorStart;
+        params.colorEnd = m_Settings.colorEnd;
+        params.restitution = m_Settings.restitution;
+        params.capacity = m_Settings.capacity;
+        params.flags = (m_Settings.collideWithDepth ? ParticleFlag_CollideWithDepth : 0u) |
+                       (m_Settings.sortBackToFront ? ParticleFlag_SortBackToFront : 0u);
+
+        float emitWhole = std::floor(m_EmitAccumulator);
+        m_EmitAccumulator -= emitWhole;
+        uint64_t emitCount = static_cast<uint64_t>(emitWhole) + m_PendingBurst;
+        params.emitCount = static_cast<uint32_t>(std::min<uint64_t>(emitCount, m_Settings.capacity));
+        params.deltaTime = std::min(m_PendingTime, MaxStepSeconds);
+        params.randomSeed = ParticleHash(++m_StepIndex);
+
+        m_PendingBurst = 0;
+        m_PendingTime = 0.0f;
+        return params;
+    }
+
+} // namespace VulkEng
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "scene/Component.h" // Base class for components
+#include "graphics/ParticleTypes.h" // For ParticleEmitParams
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <memory>
+
+namespace VulkEng {
+
+    struct ParticleEmitterGpuState; // Owned by GpuParticleSystem's resources, see GpuParticleSystem.h
+
+    // Initial settings of a ParticleEmitterComponent.
+    struct ParticleEmitterSettings {
+        uint32_t capacity = 65536;    // Maximum live particles (GPU pool size)
+        float emitRate = 2000.0f;     // Particles per second while emitting
+        float emitRadius = 0.1f;      // Particles spawn in a sphere around the GameObject
+        glm::vec3 velocity = glm::vec3(0.0f, 4.0f, 0.0f);
+        float velocitySpread = 1.5f;  // Random velocity added in a sphere of this radius
+        glm::vec3 gravity = glm::vec3(0.0f, -9.81f, 0.0f);
+        float drag = 0.1f;            // Fraction of velocity lost per second
+        float lifetimeMin = 1.5f;
+        float lifetimeMax = 3.0f;
+        float sizeStart = 0.05f;
+        float sizeEnd = 0.02f;
+        glm::vec4 colorStart = glm::vec4(1.0f, 0.8f, 0.4f, 1.0f);
+        glm::vec4 colorEnd = glm::vec4(1.0f, 0.2f, 0.1f, 0.0f);
+        bool collideWithDepth = true; // Bounce off whatever was rendered last frame
+        float restitution = 0.4f;
+        bool sortBackToFront = true;  // Needed for correct alpha blending; costs a GPU sort per frame
+    };
+
+    // A GPU-simulated particle emitter. The component only accumulates emission and time on the CPU;
+    // the renderer turns that into one ParticleEmitParams step per frame and runs emission,
+    // simulation, compaction and sorting in compute shaders over a persistent particle pool.
+    class ParticleEmitterComponent : public Component {
+    public:
+        ParticleEmitterComponent() = default;
+        explicit ParticleEmitterComponent(const ParticleEmitterSettings& settings) : m_Settings(settings) {}
+        virtual ~ParticleEmitterComponent() = default;
+
+        // Changing the capacity recreates the GPU pool (alive particles are lost).
+        void SetSettings(const ParticleEmitterSettings& settings) { m_Settings = settings; }
+        const ParticleEmitterSettings& GetSettings() const { return m_Settings; }
+
+        void SetEmitting(bool emitting) { m_Emitting = emitting; }
+        bool IsEmitting() const { return m_Emitting; }
+        // Spawns `count` particles on the next step, in addition to the rate.
+        void Burst(uint32_t count) { m_PendingBurst += count; }
+
+        void Update(float deltaTime) override;
+
+        // --- Renderer interface ---
+        // Consumes the time and emission accumulated since the last step.
+        ParticleEmitParams TakeStep(const glm::vec3& worldPosition);
+        const std::shared_ptr<ParticleEmitterGpuState>& GetGpuState() const { return m_GpuState; }
+        void SetGpuState(std::shared_ptr<ParticleEmitterGpuState> state) { m_GpuState = std::move(state); }
+
+    private:
+        ParticleEmitterSettings m_Settings;
+        bool m_Emitting = true;
+        float m_PendingTime = 0.0f;
+        float m_EmitAccumulator = 0.0f; // Fractional particles carried over between steps
+        uint32_t m_PendingBurst = 0;
+        uint32_t m_StepIndex = 0;       // Seeds each step's random numbers
+        std::shared_ptr<ParticleEmitterGpuState> m_GpuState;
+    };
+
+} // namespace VulkEng
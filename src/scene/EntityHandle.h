@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>    // For uint32_t
+#include <functional> // For std::hash
+
+namespace VulkEng {
+
+    // Stable, generational reference to a GameObject owned by a Scene.
+    // `index` addresses a slot in the Scene's slot table; `generation` is bumped every
+    // time that slot is freed, so handles to destroyed objects resolve to nullptr
+    // instead of dangling (unlike raw GameObject pointers).
+    struct EntityHandle {
+        uint32_t index = UINT32_MAX;
+        uint32_t generation = 0;
+
+        bool IsNull() const { return index == UINT32_MAX; }
+
+        bool operator==(const EntityHandle& other) const {
+            return index == other.index && generation == other.generation;
+        }
+        bool operator!=(const EntityHandle& other) const { return !(*this == other); }
+    };
+
+    // A handle that never refers to a live GameObject.
+    const EntityHandle InvalidEntityHandle{};
+
+} // namespace VulkEng
+
+// Allows EntityHandle to be used as a key in unordered containers.
+namespace std {
+    template <>
+    struct hash<VulkEng::EntityHandle> {
+        size_t operator()(const VulkEng::EntityHandle& handle) const noexcept {
+            const uint64_t packed = (static_cast<uint64_t>(handle.generation) << 32) | handle.index;
+            return std::hash<uint64_t>{}(packed);
+        }
+    };
+} // namespace std
@@ -3,7 +3,8 @@
 #include "core/Log.h" // For logging GameObject lifecycle events
 #include "Component.h"// For the base Component class (used in UpdateComponents)
 
-#include <utility> // For std::move
+#include <utility>   // For std::move
+#include <algorithm> // For std::find (tags), std::find_if (components)
 
 namespace VulkEng {
 
@@ -20,15 +21,16 @@ namespace VulkEng {
     GameObject::~GameObject() {
         // VKENG_TRACE("GameObject '{}' (ID: {}) destructing...", m_Name, static_cast<void*>(this));
 
-        // Components are stored as unique_ptrs in m_Components map.
+        // Components are stored as pooled owning pointers in m_Components.
         // When m_Components is cleared (or GameObject is destroyed),
-        // the unique_ptrs will automatically delete the Component objects,
-        // calling their destructors.
+        // the pool deleters destroy the Component objects and return
+        // their memory to the per-type pools.
         // It's good practice to call OnDetach for any remaining components explicitly,
         // though unique_ptr destruction handles memory.
-        for (auto& pair : m_Components) {
-            if (pair.second) {
-                pair.second->OnDetach(); // Ensure lifecycle method is called
+        for (auto& entry : m_Components) {
+            if (entry.component) {
+                entry.component->OnDetach(); // Ensure lifecycle method is called
+                UnregisterComponentFromScene(entry.type, entry.component.get());
             }
         }
         m_Components.clear(); // Explicitly clear, though destructor would do it.
@@ -44,8 +46,14 @@ namespace VulkEng {
     GameObject::GameObject(GameObject&& other) noexcept
         : m_Name(std::move(other.m_Name)),
           m_OwnerScene(other.m_OwnerScene), // Copy scene pointer
+          m_Handle(other.m_Handle),
+          m_PendingDestroy(other.m_PendingDestroy),
+          m_NameId(other.m_NameId),
+          m_Tags(std::move(other.m_Tags)),
+          m_NameBucketIndex(other.m_NameBucketIndex),
+          m_TagBucketIndices(std::move(other.m_TagBucketIndices)),
           // m_IsActive(other.m_IsActive),
-          m_Components(std::move(other.m_Components)) // Move the component map
+          m_Components(std::move(other.m_Components)) // Move the component list
           // m_Parent(other.m_Parent), // Move parent
           // m_Children(std::move(other.m_Children)) // Move children
     {
@@ -61,6 +69,7 @@ namespace VulkEng {
 
         // Nullify other's pointers to avoid double management if it's not fully destructed.
         other.m_OwnerScene = nullptr;
+        other.m_Handle = InvalidEntityHandle;
         // other.m_Parent = nullptr;
         // other.m_Children.clear();
         // The component map in 'other' is now empty due to std::move.
@@ -72,9 +81,10 @@ namespace VulkEng {
             // VKENG_TRACE("GameObject '{}' move assigned from GameObject '{}'.", m_Name, static_cast<void*>(&other));
 
             // 1. Release current resources (components)
-            for (auto& pair : m_Components) {
-                if (pair.second) {
-                    pair.second->OnDetach();
+            for (auto& entry : m_Components) {
+                if (entry.component) {
+                    entry.component->OnDetach();
+                    UnregisterComponentFromScene(entry.type, entry.component.get());
                 }
             }
             m_Components.clear();
@@ -83,8 +93,14 @@ namespace VulkEng {
             // 2. Steal resources from 'other'
             m_Name = std::move(other.m_Name);
             m_OwnerScene = other.m_OwnerScene;
+            m_Handle = other.m_Handle;
+            m_PendingDestroy = other.m_PendingDestroy;
+            m_NameId = other.m_NameId;
+            m_Tags = std::move(other.m_Tags);
+            m_NameBucketIndex = other.m_NameBucketIndex;
+            m_TagBucketIndices = std::move(other.m_TagBucketIndices);
             // m_IsActive = other.m_IsActive;
-            m_Components = std::move(other.m_Components); // Move component map
+            m_Components = std::move(other.m_Components); // Move component list
             // m_Parent = other.m_Parent;
             // m_Children = std::move(other.m_Children);
 
@@ -97,6 +113,7 @@ namespace VulkEng {
 
             // 4. Nullify 'other's relevant members
             other.m_OwnerScene = nullptr;
+            other.m_Handle = InvalidEntityHandle;
             // other.m_IsActive = false; // Or some default
             // other.m_Parent = nullptr;
             // other.m_Children.clear();
@@ -106,6 +123,102 @@ namespace VulkEng {
     }
 
 
+    // --- Name and Tags ---
+    void GameObject::SetName(const std::string& name) {
+        if (name == m_Name) {
+            return;
+        }
+        m_Name = name;
+        // Re-index under the new name. The Scene updates m_NameId.
+        if (m_OwnerScene) {
+            m_OwnerScene->OnGameObjectRenamed(*this);
+        }
+    }
+
+    void GameObject::AddTag(const std::string& tag) {
+        if (!m_OwnerScene) {
+            VKENG_WARN("GameObject '{}': Cannot add tag '{}' without an owning scene.", m_Name, tag);
+            return;
+        }
+        NameId tagId = m_OwnerScene->InternName(tag);
+        if (HasTag(tagId)) {
+            return;
+        }
+        m_Tags.push_back(tagId);
+        m_TagBucketIndices.push_back(UINT32_MAX);
+        m_OwnerScene->OnGameObjectTagAdded(*this, static_cast<uint32_t>(m_Tags.size() - 1));
+    }
+
+    void GameObject::RemoveTag(const std::string& tag) {
+        if (!m_OwnerScene) {
+            return;
+        }
+        NameId tagId = m_OwnerScene->FindNameId(tag);
+        auto it = std::find(m_Tags.begin(), m_Tags.end(), tagId);
+        if (tagId == InvalidNameId || it == m_Tags.end()) {
+            return;
+        }
+        // The scene needs the tag's bucket position, so it is told before the tag is dropped.
+        const size_t tagSlot = static_cast<size_t>(it - m_Tags.begin());
+        m_OwnerScene->OnGameObjectTagRemoved(*this, static_cast<uint32_t>(tagSlot));
+        m_Tags[tagSlot] = m_Tags.back();
+        m_Tags.pop_back();
+        m_TagBucketIndices[tagSlot] = m_TagBucketIndices.back();
+        m_TagBucketIndices.pop_back();
+    }
+
+    bool GameObject::HasTag(const std::string& tag) const {
+        return m_OwnerScene && HasTag(m_OwnerScene->FindNameId(tag));
+    }
+
+    bool GameObject::HasTag(NameId tagId) const {
+        // Objects carry only a handful of tags; a linear scan beats hashing here.
+        return tagId != InvalidNameId && std::find(m_Tags.begin(), m_Tags.end(), tagId) != m_Tags.end();
+    }
+
+
+    // --- Component Storage ---
+    GameObject::ComponentEntry* GameObject::FindComponentEntry(const std::type_index& type) {
+        for (ComponentEntry& entry : m_Components) {
+            if (entry.type == type) {
+                return &entry;
+            }
+        }
+        return nullptr;
+    }
+
+    const GameObject::ComponentEntry* GameObject::FindComponentEntry(const std::type_index& type) const {
+        for (const ComponentEntry& entry : m_Components) {
+            if (entry.type == type) {
+                return &entry;
+            }
+        }
+        return nullptr;
+    }
+
+    void GameObject::EraseComponentEntry(const std::type_index& type) {
+        auto it = std::find_if(m_Components.begin(), m_Components.end(),
+                               [&type](const ComponentEntry& entry) { return entry.type == type; });
+        if (it != m_Components.end()) {
+            m_Components.erase(it);
+        }
+    }
+
+
+    // --- Scene Component Registration ---
+    void GameObject::RegisterComponentWithScene(const std::type_index& type, Component* component) {
+        if (m_OwnerScene) {
+            m_OwnerScene->RegisterComponent(type, component);
+        }
+    }
+
+    void GameObject::UnregisterComponentFromScene(const std::type_index& type, Component* component) {
+        if (m_OwnerScene) {
+            m_OwnerScene->UnregisterComponent(type, component);
+        }
+    }
+
+
     // --- UpdateComponents Implementation ---
     // Called by the Scene to update all components of this GameObject.
     void GameObject::UpdateComponents(float deltaTime) {
@@ -1,12 +1,14 @@
 #pragma once
 
 #include "Component.h" // Base class for all components
+#include "EntityHandle.h" // Stable handle assigned by the owning Scene
+#include "NameId.h"       // Interned name/tag IDs
 #include "core/Log.h"    // For logging component operations
+#include "core/PoolAllocator.h" // Components live in per-type pools
 
 #include <string>
 #include <vector>
 #include <memory>        // For std::unique_ptr to manage component ownership
-#include <unordered_map> // For efficient component lookup by type
 #include <typeindex>     // For using type_info as map keys
 #include <stdexcept>     // For std::runtime_error (e.g., if component already exists)
 #include <algorithm>     // For std::find_if (potentially)
@@ -39,10 +41,26 @@ namespace VulkEng {
 
         // --- Accessors ---
         const std::string& GetName() const { return m_Name; }
-        void SetName(const std::string& name) { m_Name = name; }
+        // Renames the GameObject and updates the owning Scene's name index.
+        void SetName(const std::string& name);
+        // Interned ID of the current name (assigned by the owning Scene).
+        NameId GetNameId() const { return m_NameId; }
+
+        // --- Tags ---
+        // Tags are interned by the owning Scene and indexed for Scene::FindGameObjectsWithTag.
+        void AddTag(const std::string& tag);
+        void RemoveTag(const std::string& tag);
+        bool HasTag(const std::string& tag) const;
+        bool HasTag(NameId tagId) const;
+        const std::vector<NameId>& GetTagIds() const { return m_Tags; }
 
         Scene* GetScene() const { return m_OwnerScene; } // Get the scene this GameObject belongs to
 
+        // Stable generational handle assigned by the owning Scene. Prefer storing this over raw pointers.
+        EntityHandle GetHandle() const { return m_Handle; }
+        // True once Scene::DestroyGameObject has been called; the object is removed on the next Scene::Update.
+        bool IsPendingDestroy() const { return m_PendingDestroy; }
+
         // Optional: Active state for the GameObject
         // bool IsActive() const { return m_IsActive; }
         // void SetActive(bool active) { m_IsActive = active; }
@@ -62,26 +80,28 @@ namespace VulkEng {
             std::type_index typeIndex(typeid(T));
 
             // Check if a component of this type already exists.
-            if (m_Components.count(typeIndex)) {
+            if (ComponentEntry* existing = FindComponentEntry(typeIndex)) {
                 // Behavior on adding duplicate: replace, error, or return existing?
                 // For now, log a warning and replace.
                 VKENG_WARN("GameObject '{}': Component of type '{}' already exists. Replacing.", m_Name, typeid(T).name());
                 // Explicitly detach and destroy the old one before replacing
-                m_Components[typeIndex]->OnDetach(); // Call lifecycle method
-                m_Components.erase(typeIndex);
+                existing->component->OnDetach(); // Call lifecycle method
+                UnregisterComponentFromScene(typeIndex, existing->component.get());
+                EraseComponentEntry(typeIndex);
             }
 
-            // Create the new component using perfect forwarding for arguments.
-            auto newComponent = std::make_unique<T>(std::forward<Args>(args)...);
-            T* rawPtr = newComponent.get(); // Get raw pointer before moving unique_ptr
+            // Construct the new component in its type's pool using perfect forwarding for arguments.
+            PoolPtr<Component> newComponent = MakePooled<Component, T>(GetTypePool<T>(), std::forward<Args>(args)...);
+            T* rawPtr = static_cast<T*>(newComponent.get()); // Get raw pointer before moving the owning pointer
 
             // Assign this GameObject as the owner of the component.
             rawPtr->m_GameObject = this;
 
-            // Store the component in the map.
-            m_Components[typeIndex] = std::move(newComponent);
+            // Store the component and register it in the scene's per-type list.
+            m_Components.push_back({ typeIndex, std::move(newComponent) });
+            RegisterComponentWithScene(typeIndex, rawPtr);
 
-            VKENG_INFO("GameObject '{}': Added component '{}'.", m_Name, typeid(T).name());
+            VKENG_TRACE("GameObject '{}': Added component '{}'.", m_Name, typeid(T).name());
 
             // Call the component's OnAttach lifecycle method.
             rawPtr->OnAttach();
@@ -94,22 +114,19 @@ namespace VulkEng {
         template <typename T>
         T* GetComponent() const {
             static_assert(std::is_base_of<Component, T>::value, "T must derive from Component.");
-            std::type_index typeIndex(typeid(T));
-
-            auto it = m_Components.find(typeIndex);
-            if (it != m_Components.end() && it->second) {
-                // Safely cast the base Component pointer to the derived type T*.
-                return static_cast<T*>(it->second.get());
-            }
-            return nullptr; // Component not found
+            const ComponentEntry* entry = FindComponentEntry(std::type_index(typeid(T)));
+            // Safely cast the base Component pointer to the derived type T*.
+            return entry ? static_cast<T*>(entry->component.get()) : nullptr;
         }
 
+        // Number of components attached, of any type.
+        size_t GetComponentCount() const { return m_Components.size(); }
+
         // Checks if this GameObject has a component of type T.
         template <typename T>
         bool HasComponent() const {
             static_assert(std::is_base_of<Component, T>::value, "T must derive from Component.");
-            std::type_index typeIndex(typeid(T));
-            return m_Components.count(typeIndex) > 0;
+            return FindComponentEntry(std::type_index(typeid(T))) != nullptr;
         }
 
         // Removes a component of type T from this GameObject.
@@ -119,18 +136,19 @@ namespace VulkEng {
             static_assert(std::is_base_of<Component, T>::value, "T must derive from Component.");
             std::type_index typeIndex(typeid(T));
 
-            auto it = m_Components.find(typeIndex);
-            if (it != m_Components.end() && it->second) {
-                VKENG_INFO("GameObject '{}': Removing component '{}'.", m_Name, typeid(T).name());
-                it->second->OnDetach(); // Call lifecycle method
-                m_Components.erase(it); // unique_ptr destructor handles component deletion
+            if (ComponentEntry* entry = FindComponentEntry(typeIndex)) {
+                VKENG_TRACE("GameObject '{}': Removing component '{}'.", m_Name, typeid(T).name());
+                entry->component->OnDetach(); // Call lifecycle method
+                UnregisterComponentFromScene(typeIndex, entry->component.get());
+                EraseComponentEntry(typeIndex); // Pool deleter destroys the component and frees its block
             } else {
                 VKENG_WARN("GameObject '{}': Attempted to remove non-existent component '{}'.", m_Name, typeid(T).name());
             }
         }
 
         // --- Update ---
-        // Called by the Scene to update all components of this GameObject.
+        // Updates all components of this GameObject directly.
+        // Scene::Update does not use this; it updates components grouped by type instead.
         void UpdateComponents(float deltaTime);
 
         // Optional: Transform hierarchy
@@ -142,13 +160,38 @@ namespace VulkEng {
 
 
     private:
+        // Scene assigns the handle and tracks pending destruction.
+        friend class Scene;
+
+        // A GameObject rarely holds more than a handful of components, so a flat vector
+        // searched linearly beats a hash map and costs one allocation instead of one per node.
+        struct ComponentEntry {
+            std::type_index type;
+            PoolPtr<Component> component;
+        };
+        ComponentEntry* FindComponentEntry(const std::type_index& type);
+        const ComponentEntry* FindComponentEntry(const std::type_index& type) const;
+        void EraseComponentEntry(const std::type_index& type);
+
+        // Keep the owning Scene's per-type component lists in sync (no-ops without a scene).
+        void RegisterComponentWithScene(const std::type_index& type, Component* component);
+        void UnregisterComponentFromScene(const std::type_index& type, Component* component);
+
         std::string m_Name;
         Scene* m_OwnerScene = nullptr; // Non-owning pointer to the scene it belongs to
+        EntityHandle m_Handle;         // Slot index + generation within m_OwnerScene
+        bool m_PendingDestroy = false; // Set by Scene::DestroyGameObject, avoids searching the pending list
+        NameId m_NameId = InvalidNameId; // Interned m_Name, key into the Scene's name index
+        std::vector<NameId> m_Tags;      // Interned tags, keys into the Scene's tag index
+        // Position of this object in its name bucket and in each tag's bucket (parallel to m_Tags),
+        // maintained by the Scene so removal from the indices needs no search.
+        uint32_t m_NameBucketIndex = UINT32_MAX;
+        std::vector<uint32_t> m_TagBucketIndices;
         // bool m_IsActive = true;     // To enable/disable updates and rendering for this GO
 
-        // Stores components mapped by their std::type_index for efficient lookup.
-        // unique_ptr manages the lifetime of the components.
-        std::unordered_map<std::type_index, std::unique_ptr<Component>> m_Components;
+        // Components keyed by their std::type_index. The pooled owning pointers
+        // destroy the components and return their memory to the type's pool.
+        std::vector<ComponentEntry> m_Components;
 
         // Transform hierarchy members (example)
         // GameObject* m_Parent = nullptr;
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstdint> // For uint32_t
+
+namespace VulkEng {
+
+    // Interned string identifier (GameObject names and tags).
+    // IDs are issued densely by Scene::InternName and are only meaningful within that Scene.
+    using NameId = uint32_t;
+    // A special value indicating a string that has never been interned.
+    const NameId InvalidNameId = UINT32_MAX;
+
+} // namespace VulkEng
@@ -2,13 +2,18 @@
 #include "GameObject.h"
 #include "Components/CameraComponent.h"   // For checking if a GO has a camera
 #include "Components/TransformComponent.h" // For getting camera transform
+#include "SystemScheduler.h"              // For running registered systems
 #include "core/Log.h"                   // For logging scene events
+#include "core/ServiceLocator.h"        // For the JobSystem
 
-#include <algorithm> // For std::find_if, std::remove_if
+#include <utility>   // For std::move
+#include <algorithm> // For std::find
 
 namespace VulkEng {
 
-    Scene::Scene() {
+    Scene::Scene()
+        : m_GameObjectArena(std::make_unique<PoolAllocator>("GameObject", sizeof(GameObject), alignof(GameObject), 256)),
+          m_Scheduler(std::make_unique<SystemScheduler>()) {
         VKENG_INFO("Scene Created (Instance: {}).", static_cast<void*>(this));
         // OnLoad(); // Optionally call OnLoad here or let the application manage it
     }
@@ -20,31 +25,192 @@ namespace VulkEng {
         // Ensure all objects marked for destruction are processed
         ProcessDestructionList();
 
-        // Clear GameObjects. unique_ptr destructors will handle individual GameObject cleanup.
+        // Invalidate all handles first so any lookups made from component OnDetach
+        // during teardown resolve to nullptr instead of half-destroyed objects.
+        m_Slots.clear();
+        m_FreeSlots.clear();
+        m_ObjectsToDestroy.clear();
+        m_MainCamera = InvalidEntityHandle;
+
+        // Clear GameObjects. The pooled owning pointers will handle individual GameObject cleanup.
         // This will trigger GameObject destructors, which in turn trigger component destruction.
-        m_GameObjects.clear();
-        m_MainCameraObject = nullptr; // Clear camera reference
+        auto objects = std::move(m_GameObjects);
+        objects.clear();
         VKENG_INFO("Scene Destroyed.");
     }
 
     GameObject* Scene::CreateGameObject(const std::string& name /*= "GameObject"*/) {
-        // Create a new GameObject and add it to the scene's list.
-        // The scene takes ownership via unique_ptr.
-        m_GameObjects.emplace_back(std::make_unique<GameObject>(name, this));
+        // Reuse a freed slot if available; its generation was bumped on release,
+        // so stale handles to the previous occupant stay invalid.
+        uint32_t slotIndex;
+        if (!m_FreeSlots.empty()) {
+            slotIndex = m_FreeSlots.back();
+            m_FreeSlots.pop_back();
+        } else {
+            slotIndex = static_cast<uint32_t>(m_Slots.size());
+            m_Slots.emplace_back();
+        }
+
+        // Create a new GameObject in the scene's arena and add it to the scene's list.
+        // The scene takes ownership via the pooled owning pointer.
+        EntitySlot& slot = m_Slots[slotIndex];
+        slot.denseIndex = static_cast<uint32_t>(m_GameObjects.size());
+        m_GameObjects.push_back(MakePooled<GameObject, GameObject>(*m_GameObjectArena, name, this));
         GameObject* newGameObject = m_GameObjects.back().get(); // Get raw pointer to return
+        newGameObject->m_Handle = EntityHandle{ slotIndex, slot.generation };
+        IndexGameObject(*newGameObject);
 
-        VKENG_INFO("Scene: Created GameObject '{}' (ID: {}).", newGameObject->GetName(), static_cast<void*>(newGameObject));
+        VKENG_TRACE("Scene: Created GameObject '{}' (Handle: {}:{}).", newGameObject->GetName(), slotIndex, slot.generation);
         return newGameObject;
     }
 
+    void Scene::ReserveGameObjects(size_t count) {
+        m_GameObjectArena->Reserve(count);
+        m_GameObjects.reserve(m_GameObjects.size() + count);
+        if (count > m_FreeSlots.size()) {
+            m_Slots.reserve(m_Slots.size() + (count - m_FreeSlots.size()));
+        }
+    }
+
     GameObject* Scene::FindGameObjectByName(const std::string& name) const {
-        for (const auto& go : m_GameObjects) {
-            if (go && go->GetName() == name) { // Check for nullptr just in case
-                return go.get();
+        // Misses are expected for per-frame script lookups, so they are not logged.
+        return FindGameObjectByName(FindNameId(name));
+    }
+
+    GameObject* Scene::FindGameObjectByName(NameId nameId) const {
+        if (nameId >= m_NameIndex.size() || m_NameIndex[nameId].empty()) {
+            return nullptr;
+        }
+        return GetGameObject(m_NameIndex[nameId].front());
+    }
+
+    const std::vector<EntityHandle>& Scene::GetGameObjectsWithTag(NameId tagId) const {
+        static const std::vector<EntityHandle> s_Empty;
+        if (tagId >= m_TagIndex.size()) {
+            return s_Empty;
+        }
+        return m_TagIndex[tagId];
+    }
+
+    std::vector<GameObject*> Scene::FindGameObjectsWithTag(const std::string& tag) const {
+        const std::vector<EntityHandle>& handles = GetGameObjectsWithTag(FindNameId(tag));
+        std::vector<GameObject*> result;
+        result.reserve(handles.size());
+        for (EntityHandle handle : handles) {
+            if (GameObject* go = GetGameObject(handle)) {
+                result.push_back(go);
             }
         }
-        VKENG_WARN("Scene: GameObject with name '{}' not found.", name);
-        return nullptr;
+        return result;
+    }
+
+    NameId Scene::InternName(const std::string& name) {
+        auto it = m_NameToId.find(name);
+        if (it != m_NameToId.end()) {
+            return it->second;
+        }
+        NameId newId = static_cast<NameId>(m_InternedNames.size());
+        m_InternedNames.push_back(name);
+        m_NameToId.emplace(name, newId);
+        return newId;
+    }
+
+    NameId Scene::FindNameId(const std::string& name) const {
+        auto it = m_NameToId.find(name);
+        return it != m_NameToId.end() ? it->second : InvalidNameId;
+    }
+
+    const std::string& Scene::GetNameString(NameId nameId) const {
+        static const std::string s_Empty;
+        return nameId < m_InternedNames.size() ? m_InternedNames[nameId] : s_Empty;
+    }
+
+    EntityHandle Scene::RemoveFromBucket(std::vector<EntityHandle>& bucket, uint32_t index, EntityHandle handle) {
+        if (index >= bucket.size() || bucket[index] != handle) {
+            return InvalidEntityHandle; // Not in this bucket
+        }
+        // Buckets are unordered; swap-and-pop keeps removal cheap.
+        const EntityHandle moved = bucket.back();
+        bucket[index] = moved;
+        bucket.pop_back();
+        return moved != handle ? moved : InvalidEntityHandle;
+    }
+
+    void Scene::AddToNameIndex(GameObject& gameObject) {
+        gameObject.m_NameId = InternName(gameObject.m_Name);
+        if (gameObject.m_NameId >= m_NameIndex.size()) {
+            m_NameIndex.resize(static_cast<size_t>(gameObject.m_NameId) + 1);
+        }
+        std::vector<EntityHandle>& bucket = m_NameIndex[gameObject.m_NameId];
+        gameObject.m_NameBucketIndex = static_cast<uint32_t>(bucket.size());
+        bucket.push_back(gameObject.m_Handle);
+    }
+
+    void Scene::RemoveFromNameIndex(GameObject& gameObject) {
+        if (gameObject.m_NameId < m_NameIndex.size()) {
+            const uint32_t index = gameObject.m_NameBucketIndex;
+            EntityHandle moved = RemoveFromBucket(m_NameIndex[gameObject.m_NameId], index, gameObject.m_Handle);
+            if (GameObject* movedObject = GetGameObject(moved)) {
+                movedObject->m_NameBucketIndex = index;
+            }
+        }
+        gameObject.m_NameBucketIndex = UINT32_MAX;
+    }
+
+    void Scene::IndexGameObject(GameObject& gameObject) {
+        AddToNameIndex(gameObject);
+        gameObject.m_TagBucketIndices.assign(gameObject.m_Tags.size(), UINT32_MAX);
+        for (uint32_t tagSlot = 0; tagSlot < gameObject.m_Tags.size(); ++tagSlot) {
+            OnGameObjectTagAdded(gameObject, tagSlot);
+        }
+    }
+
+    void Scene::UnindexGameObject(GameObject& gameObject) {
+        RemoveFromNameIndex(gameObject);
+        for (uint32_t tagSlot = 0; tagSlot < gameObject.m_Tags.size(); ++tagSlot) {
+            OnGameObjectTagRemoved(gameObject, tagSlot);
+        }
+    }
+
+    void Scene::OnGameObjectRenamed(GameObject& gameObject) {
+        RemoveFromNameIndex(gameObject);
+        AddToNameIndex(gameObject);
+    }
+
+    void Scene::OnGameObjectTagAdded(GameObject& gameObject, uint32_t tagSlot) {
+        const NameId tagId = gameObject.m_Tags[tagSlot];
+        if (tagId >= m_TagIndex.size()) {
+            m_TagIndex.resize(static_cast<size_t>(tagId) + 1);
+        }
+        std::vector<EntityHandle>& bucket = m_TagIndex[tagId];
+        gameObject.m_TagBucketIndices[tagSlot] = static_cast<uint32_t>(bucket.size());
+        bucket.push_back(gameObject.m_Handle);
+    }
+
+    void Scene::OnGameObjectTagRemoved(GameObject& gameObject, uint32_t tagSlot) {
+        const NameId tagId = gameObject.m_Tags[tagSlot];
+        if (tagId >= m_TagIndex.size()) {
+            return;
+        }
+        const uint32_t index = gameObject.m_TagBucketIndices[tagSlot];
+        EntityHandle moved = RemoveFromBucket(m_TagIndex[tagId], index, gameObject.m_Handle);
+        if (GameObject* movedObject = GetGameObject(moved)) {
+            // Objects carry only a handful of tags, so finding the moved entry's slot is cheap.
+            auto it = std::find(movedObject->m_Tags.begin(), movedObject->m_Tags.end(), tagId);
+            movedObject->m_TagBucketIndices[it - movedObject->m_Tags.begin()] = index;
+        }
+        gameObject.m_TagBucketIndices[tagSlot] = UINT32_MAX;
+    }
+
+    GameObject* Scene::GetGameObject(EntityHandle handle) const {
+        if (handle.index >= m_Slots.size()) {
+            return nullptr;
+        }
+        const EntitySlot& slot = m_Slots[handle.index];
+        if (slot.generation != handle.generation || slot.denseIndex == UINT32_MAX) {
+            return nullptr; // Slot was freed (and possibly reused) since the handle was issued
+        }
+        return m_GameObjects[slot.denseIndex].get();
     }
 
     void Scene::DestroyGameObject(GameObject* gameObject) {
@@ -52,13 +218,50 @@ namespace VulkEng {
             VKENG_WARN("Scene: Attempted to destroy a null GameObject.");
             return;
         }
+        if (gameObject->GetScene() != this) {
+            VKENG_WARN("Scene: Attempted to destroy GameObject '{}' which belongs to another scene.", gameObject->GetName());
+            return;
+        }
 
         // Add to a deferred destruction list to avoid issues if called during iteration (e.g., in Update loop).
-        // Check if it's already marked to prevent duplicates.
-        if (std::find(m_ObjectsToDestroy.begin(), m_ObjectsToDestroy.end(), gameObject) == m_ObjectsToDestroy.end()) {
-            m_ObjectsToDestroy.push_back(gameObject);
-            VKENG_INFO("Scene: GameObject '{}' (ID: {}) marked for destruction.", gameObject->GetName(), static_cast<void*>(gameObject));
+        // The per-object flag prevents duplicates without searching the list.
+        std::lock_guard<std::mutex> lock(m_DestroyMutex);
+        if (!gameObject->m_PendingDestroy) {
+            gameObject->m_PendingDestroy = true;
+            m_ObjectsToDestroy.push_back(gameObject->m_Handle);
+        }
+    }
+
+    void Scene::DestroyGameObject(EntityHandle handle) {
+        GameObject* gameObject = GetGameObject(handle);
+        if (!gameObject) {
+            VKENG_WARN("Scene: Attempted to destroy a stale or invalid GameObject handle ({}:{}).", handle.index, handle.generation);
+            return;
+        }
+        DestroyGameObject(gameObject);
+    }
+
+    void Scene::RemoveGameObjectAt(uint32_t denseIndex) {
+        // Take ownership out of the dense array first so the containers are consistent
+        // before the GameObject destructor (and component OnDetach) runs.
+        GameObjectPtr removed = std::move(m_GameObjects[denseIndex]);
+        const uint32_t lastIndex = static_cast<uint32_t>(m_GameObjects.size() - 1);
+        if (denseIndex != lastIndex) {
+            m_GameObjects[denseIndex] = std::move(m_GameObjects[lastIndex]);
+            m_Slots[m_GameObjects[denseIndex]->m_Handle.index].denseIndex = denseIndex;
         }
+        m_GameObjects.pop_back();
+
+        UnindexGameObject(*removed);
+
+        // Release the slot; bumping the generation invalidates every outstanding handle.
+        const uint32_t slotIndex = removed->m_Handle.index;
+        EntitySlot& slot = m_Slots[slotIndex];
+        slot.denseIndex = UINT32_MAX;
+        ++slot.generation;
+        m_FreeSlots.push_back(slotIndex);
+
+        removed.reset();
     }
 
     void Scene::ProcessDestructionList() {
@@ -66,33 +269,27 @@ namespace VulkEng {
             return;
         }
 
-        VKENG_INFO("Scene: Processing {} GameObjects for destruction...", m_ObjectsToDestroy.size());
-        for (GameObject* goPtr : m_ObjectsToDestroy) {
-            // Find and remove the GameObject from the main list.
-            // std::remove_if moves elements to be erased to the end and returns an iterator to the new end.
-            auto it = std::remove_if(m_GameObjects.begin(), m_GameObjects.end(),
-                                     [goPtr](const std::unique_ptr<GameObject>& uPtr) {
-                                         return uPtr.get() == goPtr;
-                                     });
-
-            if (it != m_GameObjects.end()) {
-                 // Actual erasure (unique_ptr destructor will be called)
-                 // We can iterate and erase unique_ptrs directly if we are careful or use erase-remove idiom.
-                 // For simplicity here, we'll just erase the found range.
-                 // Note: This loop might erase multiple if pointers were duplicated in m_ObjectsToDestroy (shouldn't happen).
-                 VKENG_INFO("Scene: Actually destroying GameObject '{}' (ID: {}).", goPtr->GetName(), static_cast<void*>(goPtr));
-                 m_GameObjects.erase(it, m_GameObjects.end()); // Erase elements from 'it' to end
-            } else {
-                 VKENG_WARN("Scene: GameObject marked for destruction was not found in the main list (already destroyed?).");
-            }
-
-            // If the destroyed object was the main camera, nullify the reference.
-            if (m_MainCameraObject == goPtr) {
-                m_MainCameraObject = nullptr;
-                VKENG_INFO("Scene: Main camera GameObject was destroyed.");
+        // Component OnDetach may destroy further objects, so drain in batches until nothing is pending.
+        // Each removal is O(1), making the whole pass O(k) for k destroyed objects.
+        std::vector<EntityHandle> batch;
+        size_t destroyedCount = 0;
+        while (!m_ObjectsToDestroy.empty()) {
+            batch.swap(m_ObjectsToDestroy);
+            for (EntityHandle handle : batch) {
+                if (handle.index >= m_Slots.size()) {
+                    continue;
+                }
+                const EntitySlot& slot = m_Slots[handle.index];
+                if (slot.generation != handle.generation || slot.denseIndex == UINT32_MAX) {
+                    continue; // Already removed
+                }
+                RemoveGameObjectAt(slot.denseIndex);
+                ++destroyedCount;
             }
+            batch.clear();
         }
-        m_ObjectsToDestroy.clear(); // Clear the list after processing
+
+        VKENG_TRACE("Scene: Destroyed {} GameObjects ({} remaining).", destroyedCount, m_GameObjects.size());
     }
 
 
@@ -101,49 +298,87 @@ namespace VulkEng {
         ProcessDestructionList();
 
         // 2. Update Camera View Matrix (if camera exists and has transform)
-        if (m_MainCameraObject) {
-            CameraComponent* camComponent = m_MainCameraObject->GetComponent<CameraComponent>();
-            TransformComponent* camTransform = m_MainCameraObject->GetComponent<TransformComponent>();
+        if (GameObject* cameraObject = GetMainCameraObject()) {
+            CameraComponent* camComponent = cameraObject->GetComponent<CameraComponent>();
+            TransformComponent* camTransform = cameraObject->GetComponent<TransformComponent>();
             if (camComponent && camTransform) {
                 camComponent->UpdateViewMatrix(*camTransform); // Camera updates its view based on its transform
             }
         }
 
-        // 3. Update all active GameObjects and their components.
-        // Iterate by index to allow safe removal if ProcessDestructionList wasn't perfectly safe or if components self-destruct.
-        // However, direct removal during this loop is generally unsafe. Deferred destruction is better.
-        for (const auto& go : m_GameObjects) {
-            if (go) { // Check if unique_ptr is not null (should always be true if managed correctly)
-                // Call the GameObject's own update loop, which will update its components.
-                go->UpdateComponents(deltaTime);
+        // 3. Run registered systems (per component type, parallel where access sets allow).
+        m_Scheduler->Run(*this, ServiceLocator::GetJobSystem(), deltaTime);
+
+        // 4. Component types without a system: still update them grouped by type so each
+        // loop walks one contiguous list and hits the same Update implementation.
+        // Collect the lists first; a component added during Update may insert a new type.
+        std::vector<std::vector<Component*>*> unhandledLists;
+        for (auto& [type, components] : m_ComponentsByType) {
+            if (!m_Scheduler->IsComponentTypeHandled(type)) {
+                unhandledLists.push_back(&components);
+            }
+        }
+        for (std::vector<Component*>* components : unhandledLists) {
+            // Index each time; Update may add components (reallocating the vector).
+            for (size_t i = 0; i < components->size(); ++i) {
+                (*components)[i]->Update(deltaTime);
             }
         }
     }
 
+    const std::vector<Component*>& Scene::GetComponentsOfType(const std::type_index& type) const {
+        static const std::vector<Component*> s_Empty;
+        auto it = m_ComponentsByType.find(type);
+        return it != m_ComponentsByType.end() ? it->second : s_Empty;
+    }
+
+    void Scene::RegisterComponent(const std::type_index& type, Component* component) {
+        std::vector<Component*>& components = m_ComponentsByType[type];
+        component->m_SceneListIndex = static_cast<uint32_t>(components.size());
+        components.push_back(component);
+    }
+
+    void Scene::UnregisterComponent(const std::type_index& type, Component* component) {
+        auto it = m_ComponentsByType.find(type);
+        if (it == m_ComponentsByType.end()) {
+            return;
+        }
+        std::vector<Component*>& components = it->second;
+        const uint32_t index = component->m_SceneListIndex;
+        if (index >= components.size() || components[index] != component) {
+            return; // Not registered with this scene
+        }
+        // Swap-and-pop, fixing up the moved component's index.
+        components[index] = components.back();
+        components[index]->m_SceneListIndex = index;
+        components.pop_back();
+        component->m_SceneListIndex = UINT32_MAX;
+    }
+
     void Scene::SetMainCamera(GameObject* cameraObject) {
         // Basic validation: check if the provided GameObject has a CameraComponent and TransformComponent.
         if (cameraObject &&
             cameraObject->GetComponent<CameraComponent>() &&
             cameraObject->GetComponent<TransformComponent>()) {
-            m_MainCameraObject = cameraObject;
+            m_MainCamera = cameraObject->GetHandle();
             VKENG_INFO("Scene: Main camera set to GameObject '{}'.", cameraObject->GetName());
         } else {
-            // m_MainCameraObject = nullptr; // Or keep previous? Clear for safety.
+            // m_MainCamera = InvalidEntityHandle; // Or keep previous? Clear for safety.
             VKENG_WARN("Scene: Attempted to set main camera to GameObject '{}' which lacks CameraComponent or TransformComponent.",
                        cameraObject ? cameraObject->GetName() : "nullptr");
         }
     }
 
     CameraComponent* Scene::GetMainCamera() const {
-        if (m_MainCameraObject) {
-            return m_MainCameraObject->GetComponent<CameraComponent>();
+        if (GameObject* cameraObject = GetMainCameraObject()) {
+            return cameraObject->GetComponent<CameraComponent>();
         }
         return nullptr;
     }
 
     TransformComponent* Scene::GetMainCameraTransform() const {
-        if (m_MainCameraObject) {
-            return m_MainCameraObject->GetComponent<TransformComponent>();
+        if (GameObject* cameraObject = GetMainCameraObject()) {
+            return cameraObject->GetComponent<TransformComponent>();
         }
         return nullptr;
     }
@@ -3,20 +3,33 @@
 #include <vector>
 #include <string>
 #include <memory>    // For std::unique_ptr
-#include <cstdint>   // For uint32_t (if using for entity IDs with an ECS)
+#include <cstdint>   // For uint32_t slot indices
 #include <algorithm> // For std::remove_if
+#include <unordered_map> // For the name interning table and per-type component lists
+#include <typeindex>     // For component type keys
+#include <typeinfo>
+#include <mutex>         // For DestroyGameObject from parallel systems
+
+#include "EntityHandle.h" // Generational handles for GameObjects
+#include "NameId.h"       // Interned name/tag IDs
+#include "core/PoolAllocator.h" // GameObjects live in a per-scene chunked arena
 
 // Forward Declarations to avoid circular dependencies or heavy includes
 namespace VulkEng {
     class GameObject;       // GameObjects are managed by the Scene
     class CameraComponent;  // A Scene typically has a main camera
     class TransformComponent; // Often needed for camera transform access
+    class Component;
+    class SystemScheduler;    // Runs per-component-type systems each Update
     // If using an Entity-Component-System (ECS) library like EnTT:
     // #include <entt/entt.hpp>
 }
 
 namespace VulkEng {
 
+    // Owning pointer to a GameObject allocated from its Scene's arena.
+    using GameObjectPtr = PoolPtr<GameObject>;
+
     // Represents a collection of GameObjects and manages their lifecycle and updates.
     // A game can have multiple scenes (e.g., main menu, level 1, level 2).
     class Scene {
@@ -31,15 +44,52 @@ namespace VulkEng {
         // --- GameObject Management ---
         // Creates a new GameObject within this scene.
         // Returns a raw pointer to the created GameObject (owned by the scene).
+        // The pointer stays valid until the object is destroyed; use GetHandle() for long-lived references.
         GameObject* CreateGameObject(const std::string& name = "GameObject");
 
-        // Finds a GameObject by its name (can be slow for many objects).
+        // Finds a GameObject by its name via the name index (O(1)). Returns nullptr on a miss.
+        // If several objects share the name, any one of them may be returned.
         GameObject* FindGameObjectByName(const std::string& name) const;
+        // Faster variant for hot paths: intern the name once with InternName and reuse the ID.
+        GameObject* FindGameObjectByName(NameId nameId) const;
+
+        // All live GameObjects carrying a tag. The handle list is owned by the scene and
+        // is invalidated by the next create/destroy/tag change; copy it if you need to keep it.
+        const std::vector<EntityHandle>& GetGameObjectsWithTag(NameId tagId) const;
+        // Convenience wrapper returning resolved pointers.
+        std::vector<GameObject*> FindGameObjectsWithTag(const std::string& tag) const;
+
+        // --- Name Interning ---
+        // Returns the ID for `name`, interning it if it has not been seen before.
+        NameId InternName(const std::string& name);
+        // Returns the ID for `name`, or InvalidNameId if it was never interned (does not allocate).
+        NameId FindNameId(const std::string& name) const;
+        const std::string& GetNameString(NameId nameId) const;
+
+        // Resolves a handle to its GameObject. Returns nullptr if the object has been destroyed.
+        GameObject* GetGameObject(EntityHandle handle) const;
+        // True if the handle still refers to a live GameObject in this scene.
+        bool IsValid(EntityHandle handle) const { return GetGameObject(handle) != nullptr; }
+        size_t GetGameObjectCount() const { return m_GameObjects.size(); }
+        // Allocation counters for the GameObject arena.
+        PoolAllocator::Stats GetGameObjectArenaStats() const { return m_GameObjectArena->GetStats(); }
+
+        // --- Bulk Reservation ---
+        // Pre-sizes storage for `count` more GameObjects (arena, dense list, slots) so bulk
+        // creation (e.g. scene loading) does no incremental growth.
+        void ReserveGameObjects(size_t count);
+        // Same for `count` more components of type T (type pool and per-type list).
+        template <typename T>
+        void ReserveComponents(size_t count) {
+            GetTypePool<T>().Reserve(count);
+            std::vector<Component*>& components = m_ComponentsByType[std::type_index(typeid(T))];
+            components.reserve(components.size() + count);
+        }
 
-        // Destroys a GameObject. This will also trigger OnDetach for its components.
-        // This needs careful implementation to handle dependencies and iteration.
+        // Marks a GameObject for destruction. It is removed (and its components receive OnDetach)
+        // at the start of the next Update. Marking is O(1); repeated calls are ignored.
         void DestroyGameObject(GameObject* gameObject);
-        // void DestroyGameObject(EntityID entity); // If using an ECS
+        void DestroyGameObject(EntityHandle handle);
 
 
         // --- Scene Lifecycle ---
@@ -62,29 +112,87 @@ namespace VulkEng {
 
         // --- Accessing GameObjects (for rendering, physics, etc.) ---
         // Provides access to all GameObjects in the scene.
-        // Note: Iterating this vector directly can be problematic if GameObjects are destroyed during iteration.
-        // Consider providing iterators or a safer access method.
-        const std::vector<std::unique_ptr<GameObject>>& GetAllGameObjects() const {
+        // The vector is densely packed and unordered: destruction swaps the last object into the freed spot.
+        // Destruction is deferred to Update, so iterating between updates is safe.
+        const std::vector<GameObjectPtr>& GetAllGameObjects() const {
             return m_GameObjects;
         }
 
+        // All live components of one type, densely packed in no particular order.
+        // Used by systems to update a component type in one tight loop.
+        template <typename T>
+        const std::vector<Component*>& GetComponentsOfType() const {
+            return GetComponentsOfType(std::type_index(typeid(T)));
+        }
+        const std::vector<Component*>& GetComponentsOfType(const std::type_index& type) const;
+
+        // --- Systems ---
+        // Systems registered here run during Update, in parallel where their access sets allow.
+        // Component types without a system are still updated each frame (serially, grouped by type).
+        SystemScheduler& GetSystemScheduler() { return *m_Scheduler; }
+
         // If using an ECS like EnTT:
         // entt::registry& GetRegistry() { return m_Registry; }
         // const entt::registry& GetRegistry() const { return m_Registry; }
 
     private:
-        // Storage for GameObjects. Using unique_ptr ensures they are automatically
-        // deleted when the scene is destroyed or when explicitly removed.
-        std::vector<std::unique_ptr<GameObject>> m_GameObjects;
-        // For efficient removal, consider std::list or mark-and-sweep if frequent deletions.
-
-        // Pointer to the GameObject designated as the main camera.
-        // This is a raw pointer; the GameObject itself is owned by m_GameObjects.
-        GameObject* m_MainCameraObject = nullptr;
-
-        // Flag to mark objects for deferred destruction to avoid iterator invalidation issues.
-        std::vector<GameObject*> m_ObjectsToDestroy;
+        // GameObject notifies the scene when its name or tags change so the indices stay current.
+        friend class GameObject;
+        void OnGameObjectRenamed(GameObject& gameObject);
+        // `tagSlot` is the tag's position in the object's tag list.
+        void OnGameObjectTagAdded(GameObject& gameObject, uint32_t tagSlot);
+        void OnGameObjectTagRemoved(GameObject& gameObject, uint32_t tagSlot);
+        // Adds/removes an object's name and tags to/from the indices.
+        void IndexGameObject(GameObject& gameObject);
+        void UnindexGameObject(GameObject& gameObject);
+        void AddToNameIndex(GameObject& gameObject);
+        void RemoveFromNameIndex(GameObject& gameObject);
+        // Swap-and-pop of bucket[index] if it holds `handle`; returns the handle moved into `index`,
+        // or InvalidEntityHandle if none was.
+        static EntityHandle RemoveFromBucket(std::vector<EntityHandle>& bucket, uint32_t index, EntityHandle handle);
+        // GameObject keeps the per-type component lists current on add/remove/destroy.
+        void RegisterComponent(const std::type_index& type, Component* component);
+        void UnregisterComponent(const std::type_index& type, Component* component);
+
+        // Slot map entry: where a handle's GameObject currently lives in m_GameObjects.
+        struct EntitySlot {
+            uint32_t denseIndex = UINT32_MAX; // UINT32_MAX while the slot is free
+            uint32_t generation = 0;          // Incremented each time the slot is freed
+        };
+
+        // Chunked arena backing every GameObject in this scene. Declared before m_GameObjects
+        // so it outlives them.
+        std::unique_ptr<PoolAllocator> m_GameObjectArena;
+        // Dense storage for GameObjects. The pooled owning pointers ensure they are automatically
+        // destroyed (and their memory returned to the arena) when the scene is destroyed or when
+        // explicitly removed. Removal is swap-and-pop, so the order is not stable.
+        std::vector<GameObjectPtr> m_GameObjects;
+        // Handle index -> dense index. Freed slots are recycled through m_FreeSlots.
+        std::vector<EntitySlot> m_Slots;
+        std::vector<uint32_t> m_FreeSlots;
+
+        // Interned strings: ID -> string and string -> ID. IDs are never recycled.
+        std::vector<std::string> m_InternedNames;
+        std::unordered_map<std::string, NameId> m_NameToId;
+        // Indices keyed directly by NameId (dense), so a lookup is a single vector access.
+        std::vector<std::vector<EntityHandle>> m_NameIndex;
+        std::vector<std::vector<EntityHandle>> m_TagIndex;
+
+        // Component type -> every live component of that type in this scene.
+        std::unordered_map<std::type_index, std::vector<Component*>> m_ComponentsByType;
+        std::unique_ptr<SystemScheduler> m_Scheduler;
+
+        // Handle of the GameObject designated as the main camera (resolves to nullptr once destroyed).
+        EntityHandle m_MainCamera = InvalidEntityHandle;
+
+        // Objects marked for deferred destruction to avoid iterator invalidation issues.
+        // Duplicates are prevented by GameObject::m_PendingDestroy.
+        std::vector<EntityHandle> m_ObjectsToDestroy;
+        std::mutex m_DestroyMutex; // Systems may call DestroyGameObject from worker threads
         void ProcessDestructionList();
+        // Swap-and-pop removal of a single live object. O(1).
+        void RemoveGameObjectAt(uint32_t denseIndex);
+        GameObject* GetMainCameraObject() const { return GetGameObject(m_MainCamera); }
 
 
         // If using an Entity-Component-System (ECS) like EnTT:
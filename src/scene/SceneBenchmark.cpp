@@ -0,0 +1,66 @@
+#include "SceneBenchmark.h"
+#include "Scene.h"
+#include "GameObject.h"
+#include "Components/TransformComponent.h"
+#include "Components/MeshComponent.h"
+#include "core/Log.h"
+
+#include <algorithm> // For std::max
+#include <chrono>
+#include <vector>
+
+namespace VulkEng {
+
+    SpawnBenchmarkResult RunSpawnDespawnBenchmark(uint32_t objectsPerWave, uint32_t waves) {
+        using Clock = std::chrono::high_resolution_clock;
+
+        SpawnBenchmarkResult result;
+        result.objectsPerWave = objectsPerWave;
+        result.waves = waves;
+
+        Scene scene;
+        std::vector<GameObject*> spawned;
+        spawned.reserve(objectsPerWave);
+        double totalSpawnMs = 0.0;
+        double totalDespawnMs = 0.0;
+
+        for (uint32_t wave = 0; wave < waves; ++wave) {
+            auto spawnStart = Clock::now();
+            for (uint32_t i = 0; i < objectsPerWave; ++i) {
+                GameObject* projectile = scene.CreateGameObject("Projectile");
+                auto* transform = projectile->AddComponent<TransformComponent>();
+                transform->SetPosition(glm::vec3(static_cast<float>(i), 0.0f, static_cast<float>(wave)));
+                projectile->AddComponent<MeshComponent>();
+                spawned.push_back(projectile);
+            }
+            auto spawnEnd = Clock::now();
+
+            result.peakFragmentation = std::max(result.peakFragmentation, scene.GetGameObjectArenaStats().fragmentation);
+
+            for (GameObject* projectile : spawned) {
+                scene.DestroyGameObject(projectile);
+            }
+            scene.Update(0.0f); // Processes the destruction list
+            auto despawnEnd = Clock::now();
+            spawned.clear();
+
+            totalSpawnMs += std::chrono::duration<double, std::milli>(spawnEnd - spawnStart).count();
+            totalDespawnMs += std::chrono::duration<double, std::milli>(despawnEnd - spawnEnd).count();
+        }
+
+        PoolAllocator::Stats arenaStats = scene.GetGameObjectArenaStats();
+        result.poolAllocations = arenaStats.totalAllocations;
+        result.heapAllocations = arenaStats.chunkCount;
+        if (waves > 0) {
+            result.spawnMsPerWave = totalSpawnMs / waves;
+            result.despawnMsPerWave = totalDespawnMs / waves;
+        }
+
+        VKENG_INFO("Spawn/despawn benchmark: {} objects x {} waves: spawn {:.3f} ms/wave, despawn {:.3f} ms/wave, "
+                   "{} arena allocations served by {} heap chunk(s), peak fragmentation {:.1f}%.",
+                   objectsPerWave, waves, result.spawnMsPerWave, result.despawnMsPerWave,
+                   result.poolAllocations, result.heapAllocations, result.peakFragmentation * 100.0f);
+        return result;
+    }
+
+} // namespace VulkEng
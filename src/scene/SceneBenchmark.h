@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdint>
+
+namespace VulkEng {
+
+    // Results of RunSpawnDespawnBenchmark. Times are averages per wave.
+    struct SpawnBenchmarkResult {
+        uint32_t objectsPerWave = 0;
+        uint32_t waves = 0;
+        double spawnMsPerWave = 0.0;   // CreateGameObject + AddComponent for every object
+        double despawnMsPerWave = 0.0; // DestroyGameObject for every object + the Update that removes them
+        uint64_t poolAllocations = 0;  // Allocate() calls served by the GameObject arena
+        uint64_t heapAllocations = 0;  // Chunks the GameObject arena had to request from the heap
+        float peakFragmentation = 0.0f;
+    };
+
+    // Spawns and despawns `objectsPerWave` GameObjects (Transform + Mesh components) `waves` times
+    // in a private Scene, mimicking wave-based projectile spawning. Logs and returns the timings.
+    // Debug/profiling aid; safe to call at runtime since it doesn't touch the active scene.
+    SpawnBenchmarkResult RunSpawnDespawnBenchmark(uint32_t objectsPerWave, uint32_t waves);
+
+} // namespace VulkEng
@@ -0,0 +1,1115 @@
+#include "SceneSerializer.h"
+#include "Scene.h"
+#include "GameObject.h"
+#include "Components/TransformComponent.h"
+#include "Components/CameraComponent.h"
+#include "Components/MeshComponent.h"
+#include "Components/RigidBodyComponent.h"
+#include "Components/ParticleEmitterComponent.h"
+#include "Components/AnimatorComponent.h"
+#include "Components/InstancedMeshComponent.h"
+#include "animation/AnimationClip.h"
+#include "core/AtomicFile.h"
+#include "core/JobSystem.h"
+#include "core/Log.h"
+
+#include <algorithm>     // For std::min, std::find
+#include <cstring>       // For std::memcpy, std::memcmp
+#include <fstream>
+#include <type_traits>   // For std::is_trivially_copyable
+#include <unordered_map>
+
+namespace VulkEng {
+
+    namespace {
+        // Per-object flags: which components follow, in this order.
+        enum ObjectFlags : uint8_t {
+            HasTransform = 1 << 0,
+            HasCamera    = 1 << 1,
+            HasMesh      = 1 << 2,
+            HasRigidBody = 1 << 3,
+            IsMainCamera = 1 << 4,
+            HasParticleEmitter = 1 << 5, // Version 2
+            HasAnimator        = 1 << 6, // Version 3
+            HasInstancedMesh   = 1 << 7, // Version 4
+        };
+
+        // Where a rigid body's triangle/hull geometry comes from.
+        enum class GeometrySource : uint8_t {
+            None   = 0,
+            Asset  = 1, // The physics geometry of a model in the asset table
+            Inline = 2, // Stored in the file
+        };
+
+        struct FileHeader {
+            uint32_t magic = SceneFormat::Magic;
+            uint32_t version = SceneFormat::Version;
+            uint32_t objectCount = 0;
+            uint32_t chunkCount = 0;
+            uint32_t stringCount = 0;
+            uint32_t assetCount = 0;
+            // Component totals, so the loader can reserve all storage up front.
+            uint32_t transformCount = 0;
+            uint32_t cameraCount = 0;
+            uint32_t meshCount = 0;
+            uint32_t rigidBodyCount = 0;
+        };
+        static_assert(std::is_trivially_copyable<FileHeader>::value, "FileHeader is written as raw bytes.");
+
+        struct MeshRef {
+            uint32_t assetIndex = 0;
+            uint32_t meshIndex = 0;
+        };
+
+        // Smallest encoded size of each table entry, used to reject counts the file cannot hold
+        // before anything is sized from them.
+        constexpr size_t MinStringSize = sizeof(uint32_t);                  // Length
+        constexpr size_t MinAssetSize = sizeof(AssetHash) + MinStringSize; // Hash, path
+        constexpr size_t MinChunkSize = 2 * sizeof(uint32_t);              // Object count, byte size
+        constexpr uint32_t NoClip = UINT32_MAX; // Animator that isn't playing
+        constexpr size_t MinObjectSize = sizeof(uint32_t) + sizeof(uint16_t) + sizeof(uint8_t); // Name, tag count, flags
+
+        class BinaryWriter {
+        public:
+            template <typename T>
+            void Write(const T& value) {
+                static_assert(std::is_trivially_copyable<T>::value, "BinaryWriter::Write needs a trivially copyable type.");
+                WriteBytes(&value, sizeof(T));
+            }
+            void WriteBytes(const void* data, size_t size) {
+                const uint8_t* bytes = static_cast<const uint8_t*>(data);
+                m_Buffer.insert(m_Buffer.end(), bytes, bytes + size);
+            }
+            void WriteString(const std::string& text) {
+                Write(static_cast<uint32_t>(text.size()));
+                WriteBytes(text.data(), text.size());
+            }
+            template <typename T>
+            void WriteArray(const std::vector<T>& values) {
+                static_assert(std::is_trivially_copyable<T>::value, "BinaryWriter::WriteArray needs a trivially copyable type.");
+                Write(static_cast<uint32_t>(values.size()));
+                WriteBytes(values.data(), values.size() * sizeof(T));
+            }
+            std::vector<uint8_t>& GetBuffer() { return m_Buffer; }
+
+        private:
+            std::vector<uint8_t> m_Buffer;
+        };
+
+        // Bounds-checked reader over a byte range. Any overrun sets the failed flag and every
+        // subsequent read returns false, so callers can check once at the end of a record.
+        class BinaryReader {
+        public:
+            BinaryReader(const uint8_t* data, size_t size) : m_Data(data), m_Size(size) {}
+
+            template <typename T>
+            bool Read(T& out) {
+                static_assert(std::is_trivially_copyable<T>::value, "BinaryReader::Read needs a trivially copyable type.");
+                if (!Has(sizeof(T))) return false;
+                std::memcpy(&out, m_Data + m_Offset, sizeof(T));
+                m_Offset += sizeof(T);
+                return true;
+            }
+            bool ReadString(std::string& out) {
+                uint32_t length = 0;
+                if (!Read(length) || !Has(length)) return false;
+                out.assign(reinterpret_cast<const char*>(m_Data + m_Offset), length);
+                m_Offset += length;
+                return true;
+            }
+            template <typename T>
+            bool ReadArray(std::vector<T>& out) {
+                static_assert(std::is_trivially_copyable<T>::value, "BinaryReader::ReadArray needs a trivially copyable type.");
+                uint32_t count = 0;
+                if (!Read(count) || !Has(static_cast<size_t>(count) * sizeof(T))) return false;
+                out.resize(count);
+                std::memcpy(out.data(), m_Data + m_Offset, static_cast<size_t>(count) * sizeof(T));
+                m_Offset += static_cast<size_t>(count) * sizeof(T);
+                return true;
+            }
+            bool Skip(size_t size) {
+                if (!Has(size)) return false;
+                m_Offset += size;
+                return true;
+            }
+            // True if `count` records of at least `minRecordSize` bytes each could still follow.
+            // Doesn't consume anything or set the failed flag.
+            bool CanHold(uint64_t count, size_t minRecordSize) const {
+                return !m_Failed && count <= (m_Size - m_Offset) / minRecordSize;
+            }
+
+            size_t GetOffset() const { return m_Offset; }
+            bool HasFailed() const { return m_Failed; }
+
+        private:
+            bool Has(size_t size) {
+                if (m_Failed || size > m_Size - m_Offset) {
+                    m_Failed = true;
+                    return false;
+                }
+                return true;
+            }
+
+            const uint8_t* m_Data;
+            size_t m_Size;
+            size_t m_Offset = 0;
+            bool m_Failed = false;
+        };
+
+        double MillisecondsSince(std::chrono::steady_clock::time_point start) {
+            return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        }
+
+        bool SamePhysicsGeometry(const RigidBodySettings& settings, const LoadedModelData& modelData) {
+            return settings.physicsVertices.size() == modelData.allVerticesPhysics.size() &&
+                   settings.physicsIndices.size() == modelData.allIndicesPhysics.size() &&
+                   std::memcmp(settings.physicsVertices.data(), modelData.allVerticesPhysics.data(),
+                               settings.physicsVertices.size() * sizeof(glm::vec3)) == 0 &&
+                   std::memcmp(settings.physicsIndices.data(), modelData.allIndicesPhysics.data(),
+                               settings.physicsIndices.size() * sizeof(uint32_t)) == 0;
+        }
+
+        template <typename... ComponentTypes>
+        size_t CountComponents(const GameObject& gameObject) {
+            return (static_cast<size_t>(gameObject.HasComponent<ComponentTypes>()) + ...);
+        }
+
+        // Components of the types Save writes; any others on an object are lost.
+        size_t CountSerializedComponents(const GameObject& gameObject) {
+            return CountComponents<TransformComponent, CameraComponent, MeshComponent, RigidBodyComponent,
+                                   ParticleEmitterComponent, AnimatorComponent, InstancedMeshComponent>(gameObject);
+        }
+
+        // Like AssetManager::FindMeshSource, but only for meshes of models a scene file can reference.
+        bool FindSavableMeshSource(const Mesh* mesh, const AssetManager& assetManager, ModelHandle& outModel, uint32_t& outMeshIndex) {
+            return assetManager.FindMeshSource(mesh, outModel, outMeshIndex) &&
+                   assetManager.GetModelContentHash(outModel) != InvalidAssetHash;
+        }
+
+        // Locates an animator's skeleton and current clip in the model they were imported with.
+        bool FindAnimatorSource(const AnimatorComponent& animator, const AssetManager& assetManager,
+                                ModelHandle& outModel, uint32_t& outClipIndex) {
+            if (!assetManager.FindSkeletonSource(animator.GetSkeleton().get(), outModel) ||
+                assetManager.GetModelContentHash(outModel) == InvalidAssetHash) {
+                return false;
+            }
+            outClipIndex = NoClip;
+            if (!animator.GetClip()) return true;
+            const std::vector<std::shared_ptr<const AnimationClip>>& clips = assetManager.GetLoadedModelData(outModel)->animations;
+            auto clip = std::find(clips.begin(), clips.end(), animator.GetClip());
+            if (clip == clips.end()) return false;
+            outClipIndex = static_cast<uint32_t>(clip - clips.begin());
+            return true;
+        }
+    }
+
+    bool SceneSerializer::CanRepresent(const GameObject& gameObject, const AssetManager& assetManager) {
+        if (gameObject.GetComponentCount() > CountSerializedComponents(gameObject)) {
+            return false;
+        }
+        if (const auto* meshComp = gameObject.GetComponent<MeshComponent>()) {
+            for (const Mesh* mesh : meshComp->GetMeshes()) {
+                ModelHandle model = InvalidModelHandle;
+                uint32_t meshIndex = 0;
+                if (!assetManager.FindMeshSource(mesh, model, meshIndex) ||
+                    assetManager.GetModelContentHash(model) == InvalidAssetHash) {
+                    return false;
+                }
+            }
+        }
+        if (const auto* animator = gameObject.GetComponent<AnimatorComponent>()) {
+            ModelHandle model = InvalidModelHandle;
+            uint32_t clipIndex = NoClip;
+            if (!FindAnimatorSource(*animator, assetManager, model, clipIndex)) {
+                return false;
+            }
+        }
+        const auto* instanced = gameObject.GetComponent<InstancedMeshComponent>();
+        if (instanced && instanced->GetMesh()) {
+            ModelHandle model = InvalidModelHandle;
+            uint32_t meshIndex = 0;
+            if (!FindSavableMeshSource(instanced->GetMesh(), assetManager, model, meshIndex)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // =====================================================================
+    // Saving
+    // =====================================================================
+
+    bool SceneSerializer::Save(const Scene& scene, const AssetManager& assetManager, const std::string& filepath) {
+        std::vector<const GameObject*> gameObjects;
+        gameObjects.reserve(scene.GetGameObjectCount());
+        for (const GameObjectPtr& gameObject : scene.GetAllGameObjects()) {
+            gameObjects.push_back(gameObject.get());
+        }
+        return Save(scene, gameObjects, assetManager, filepath);
+    }
+
+    bool SceneSerializer::Save(const Scene& scene, const std::vector<const GameObject*>& gameObjects,
+                               const AssetManager& assetManager, const std::string& filepath) {
+        auto startTime = std::chrono::steady_clock::now();
+
+        FileHeader header;
+        std::vector<std::string> strings;
+        std::unordered_map<std::string, uint32_t> stringIndices;
+        std::vector<ModelHandle> assets;
+        std::unordered_map<ModelHandle, uint32_t> assetIndices;
+
+        auto internString = [&](const std::string& text) -> uint32_t {
+            auto [it, inserted] = stringIndices.try_emplace(text, static_cast<uint32_t>(strings.size()));
+            if (inserted) strings.push_back(text);
+            return it->second;
+        };
+        auto referenceAsset = [&](ModelHandle handle) -> uint32_t {
+            auto [it, inserted] = assetIndices.try_emplace(handle, static_cast<uint32_t>(assets.size()));
+            if (inserted) assets.push_back(handle);
+            return it->second;
+        };
+
+        const CameraComponent* mainCamera = scene.GetMainCamera();
+
+        BinaryWriter chunkWriter;
+        for (size_t chunkStart = 0; chunkStart < gameObjects.size(); chunkStart += SceneFormat::ObjectsPerChunk) {
+            const size_t chunkEnd = std::min(gameObjects.size(), chunkStart + SceneFormat::ObjectsPerChunk);
+            BinaryWriter payload;
+            uint32_t objectsInChunk = 0;
+
+            for (size_t i = chunkStart; i < chunkEnd; ++i) {
+                const GameObject& gameObject = *gameObjects[i];
+                if (gameObject.IsPendingDestroy()) continue;
+
+                const auto* transform = gameObject.GetComponent<TransformComponent>();
+                const auto* camera = gameObject.GetComponent<CameraComponent>();
+                const auto* meshComp = gameObject.GetComponent<MeshComponent>();
+                const auto* rigidBody = gameObject.GetComponent<RigidBodyComponent>();
+                const auto* emitter = gameObject.GetComponent<ParticleEmitterComponent>();
+                const auto* animator = gameObject.GetComponent<AnimatorComponent>();
+                const auto* instanced = gameObject.GetComponent<InstancedMeshComponent>();
+                ModelHandle animatorModel = InvalidModelHandle;
+                uint32_t animatorClip = NoClip;
+                if (animator && !FindAnimatorSource(*animator, assetManager, animatorModel, animatorClip)) {
+                    VKENG_WARN("SceneSerializer: GameObject '{}' has an animator whose skeleton or clip isn't from a loaded model; skipping it.",
+                               gameObject.GetName());
+                    animator = nullptr;
+                }
+                if (gameObject.GetComponentCount() > CountSerializedComponents(gameObject)) {
+                    VKENG_WARN("SceneSerializer: GameObject '{}' has components the scene format doesn't store; they are not saved.",
+                               gameObject.GetName());
+                }
+
+                uint8_t flags = 0;
+                if (transform) flags |= HasTransform;
+                if (camera) flags |= HasCamera;
+                if (meshComp) flags |= HasMesh;
+                if (rigidBody) flags |= HasRigidBody;
+                if (camera && camera == mainCamera) flags |= IsMainCamera;
+                if (emitter) flags |= HasParticleEmitter;
+                if (animator) flags |= HasAnimator;
+                if (instanced) flags |= HasInstancedMesh;
+
+                payload.Write(internString(gameObject.GetName()));
+                const std::vector<NameId>& tagIds = gameObject.GetTagIds();
+                payload.Write(static_cast<uint16_t>(tagIds.size()));
+                for (NameId tagId : tagIds) {
+                    payload.Write(internString(scene.GetNameString(tagId)));
+                }
+                payload.Write(flags);
+
+                if (transform) {
+                    payload.Write(transform->GetPosition());
+                    payload.Write(transform->GetRotation());
+                    payload.Write(transform->GetScale());
+                    ++header.transformCount;
+                }
+
+                if (camera) {
+                    payload.Write(static_cast<uint8_t>(camera->IsOrthographic() ? 1 : 0));
+                    if (camera->IsOrthographic()) {
+                        payload.Write(camera->GetOrthographicBounds());
+                    } else {
+                        payload.Write(camera->GetFov());
+                        payload.Write(camera->GetAspectRatio());
+                    }
+                    payload.Write(camera->GetNearPlane());
+                    payload.Write(camera->GetFarPlane());
+                    ++header.cameraCount;
+                }
+
+                // Models this object draws; rigid body geometry is matched against them below.
+                std::vector<ModelHandle> objectModels;
+                if (meshComp) {
+                    std::vector<MeshRef> meshRefs;
+                    meshRefs.reserve(meshComp->GetMeshes().size());
+                    for (const Mesh* mesh : meshComp->GetMeshes()) {
+                        ModelHandle model = InvalidModelHandle;
+                        uint32_t meshIndex = 0;
+                        if (!assetManager.FindMeshSource(mesh, model, meshIndex) ||
+                            assetManager.GetModelContentHash(model) == InvalidAssetHash) {
+                            VKENG_WARN("SceneSerializer: GameObject '{}' has a mesh not owned by a loaded model; skipping it.", gameObject.GetName());
+                            continue;
+                        }
+                        meshRefs.push_back({ referenceAsset(model), meshIndex });
+                        if (std::find(objectModels.begin(), objectModels.end(), model) == objectModels.end()) {
+                            objectModels.push_back(model);
+                        }
+                    }
+                    payload.WriteArray(meshRefs);
+                    ++header.meshCount;
+                }
+
+                if (rigidBody) {
+                    const RigidBodySettings& settings = rigidBody->GetSettings();
+                    payload.Write(settings.mass);
+                    payload.Write(static_cast<uint8_t>(settings.shapeType));
+                    payload.Write(settings.dimensions);
+                    payload.Write(static_cast<uint8_t>(settings.isKinematic ? 1 : 0));
+                    payload.Write(settings.friction);
+                    payload.Write(settings.restitution);
+                    payload.Write(settings.linearDamping);
+                    payload.Write(settings.angularDamping);
+
+                    if (settings.physicsVertices.empty()) {
+                        payload.Write(GeometrySource::None);
+                    } else {
+                        // Collision geometry built from one of the object's own models is stored as a
+                        // reference; it is usually by far the largest part of the object.
+                        auto sourceModel = std::find_if(objectModels.begin(), objectModels.end(), [&](ModelHandle model) {
+                            const LoadedModelData* modelData = assetManager.GetLoadedModelData(model);
+                            return modelData && SamePhysicsGeometry(settings, *modelData);
+                        });
+                        if (sourceModel != objectModels.end()) {
+                            payload.Write(GeometrySource::Asset);
+                            payload.Write(referenceAsset(*sourceModel));
+                        } else {
+                            payload.Write(GeometrySource::Inline);
+                            payload.WriteArray(settings.physicsVertices);
+                            payload.WriteArray(settings.physicsIndices);
+                        }
+                    }
+                    ++header.rigidBodyCount;
+                }
+
+                if (emitter) {
+                    const ParticleEmitterSettings& settings = emitter->GetSettings();
+                    payload.Write(settings.capacity);
+                    payload.Write(settings.emitRate);
+                    payload.Write(settings.emitRadius);
+                    payload.Write(settings.velocity);
+                    payload.Write(settings.velocitySpread);
+                    payload.Write(settings.gravity);
+                    payload.Write(settings.drag);
+                    payload.Write(settings.lifetimeMin);
+                    payload.Write(settings.lifetimeMax);
+                    payload.Write(settings.sizeStart);
+                    payload.Write(settings.sizeEnd);
+                    payload.Write(settings.colorStart);
+                    payload.Write(settings.colorEnd);
+                    payload.Write(static_cast<uint8_t>(settings.collideWithDepth ? 1 : 0));
+                    payload.Write(settings.restitution);
+                    payload.Write(static_cast<uint8_t>(settings.sortBackToFront ? 1 : 0));
+                    payload.Write(static_cast<uint8_t>(emitter->IsEmitting() ? 1 : 0));
+                }
+
+                if (animator) {
+                    payload.Write(referenceAsset(animatorModel));
+                    payload.Write(animatorClip);
+                    payload.Write(animator->GetTime());
+                    payload.Write(animator->GetSpeed());
+                    payload.Write(static_cast<uint8_t>(animator->IsLooping() ? 1 : 0));
+                }
+
+                if (instanced) {
+                    ModelHandle model = InvalidModelHandle;
+                    uint32_t meshIndex = 0;
+                    bool hasMesh = instanced->GetMesh() != nullptr;
+                    if (hasMesh && !FindSavableMeshSource(instanced->GetMesh(), assetManager, model, meshIndex)) {
+                        VKENG_WARN("SceneSerializer: GameObject '{}' instances a mesh not owned by a loaded model; saving the instances without it.",
+                                   gameObject.GetName());
+                        hasMesh = false;
+                    }
+                    payload.Write(static_cast<uint8_t>(hasMesh ? 1 : 0));
+                    if (hasMesh) {
+                        payload.Write(MeshRef{ referenceAsset(model), meshIndex });
+                    }
+                    payload.Write(static_cast<uint32_t>(instanced->GetInstanceCount()));
+                    payload.WriteBytes(instanced->GetInstanceData(), instanced->GetInstanceCount() * sizeof(InstanceData));
+                }
+                ++objectsInChunk;
+            }
+
+            if (objectsInChunk == 0) continue;
+            chunkWriter.Write(objectsInChunk);
+            chunkWriter.Write(static_cast<uint32_t>(payload.GetBuffer().size()));
+            chunkWriter.WriteBytes(payload.GetBuffer().data(), payload.GetBuffer().size());
+            header.objectCount += objectsInChunk;
+            ++header.chunkCount;
+        }
+
+        header.stringCount = static_cast<uint32_t>(strings.size());
+        header.assetCount = static_cast<uint32_t>(assets.size());
+
+        BinaryWriter fileWriter;
+        fileWriter.Write(header);
+        for (const std::string& text : strings) {
+            fileWriter.WriteString(text);
+        }
+        for (ModelHandle model : assets) {
+            fileWriter.Write(assetManager.GetModelContentHash(model));
+            fileWriter.WriteString(assetManager.GetModelPath(model));
+        }
+
+        // Written next to the target and renamed over it, so a failed save leaves the previous scene intact.
+        const std::vector<uint8_t>& headerBytes = fileWriter.GetBuffer();
+        const std::vector<uint8_t>& chunkBytes = chunkWriter.GetBuffer();
+        std::string error;
+        bool written = WriteFileAtomically(filepath, [&](std::ostream& file) {
+            return file.write(reinterpret_cast<const char*>(headerBytes.data()), static_cast<std::streamsize>(headerBytes.size())) &&
+                   file.write(reinterpret_cast<const char*>(chunkBytes.data()), static_cast<std::streamsize>(chunkBytes.size()));
+        }, &error);
+        if (!written) {
+            VKENG_ERROR("SceneSerializer: Failed to write '{}': {}", filepath, error);
+            return false;
+        }
+
+        VKENG_INFO("SceneSerializer: Saved {} GameObject(s), {} asset reference(s) to '{}' ({} KB) in {:.2f} ms.",
+                   header.objectCount, header.assetCount, filepath,
+                   (headerBytes.size() + chunkBytes.size()) / 1024, MillisecondsSince(startTime));
+        return true;
+    }
+
+    // =====================================================================
+    // Streaming load
+    // =====================================================================
+
+    struct SceneStreamLoader::ObjectRecord {
+        uint32_t nameIndex = 0;
+        std::vector<uint32_t> tagIndices;
+        uint8_t flags = 0;
+
+        glm::vec3 position = glm::vec3(0.0f);
+        glm::quat rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+        glm::vec3 scale = glm::vec3(1.0f);
+
+        bool cameraOrthographic = false;
+        glm::vec4 orthoBounds = glm::vec4(0.0f);
+        float fovRadians = 0.0f;
+        float aspectRatio = 1.0f;
+        float nearPlane = 0.1f;
+        float farPlane = 1000.0f;
+
+        std::vector<MeshRef> meshes;
+
+        RigidBodySettings rigidBody;
+        GeometrySource geometrySource = GeometrySource::None;
+        uint32_t geometryAssetIndex = 0;
+
+        ParticleEmitterSettings emitter;
+        bool emitterEmitting = true;
+
+        uint32_t animatorAssetIndex = 0; // Model holding the skeleton and clips
+        uint32_t animatorClip = NoClip;
+        float animatorTime = 0.0f;
+        float animatorSpeed = 1.0f;
+        bool animatorLoop = true;
+
+        bool instancedHasMesh = false;
+        MeshRef instancedMesh;
+        std::vector<InstanceData> instances;
+    };
+
+    struct SceneStreamLoader::ParsedFile {
+        struct AssetEntry {
+            AssetHash hash = InvalidAssetHash;
+            std::string path;
+        };
+        struct ChunkView {
+            uint32_t objectCount = 0;
+            size_t offset = 0;
+            size_t size = 0;
+        };
+
+        FileHeader header;
+        std::vector<std::string> strings;
+        std::vector<AssetEntry> assets;
+        std::vector<ChunkView> chunks;
+        std::vector<uint8_t> bytes; // Whole file; chunk payloads are decoded from here
+        std::string error;          // Non-empty if reading or parsing failed
+    };
+
+    struct SceneStreamLoader::AssetSlot {
+        struct ImportResult {
+            bool success = false;
+            AssetHash contentHash = InvalidAssetHash;
+            LoadedModelData modelData;
+        };
+
+        AssetHash hash = InvalidAssetHash;
+        std::string path;
+        ModelHandle handle = InvalidModelHandle;
+        bool resolved = false; // Loaded or failed; either way objects no longer wait on it
+        std::future<ImportResult> import;
+    };
+
+    struct SceneStreamLoader::ChunkSlot {
+        std::vector<ObjectRecord> objects; // Filled by the decode job
+        std::future<bool> decode;
+        bool decoded = false;
+    };
+
+    namespace {
+        using ParsedFile = SceneStreamLoader::ParsedFile;
+        using ObjectRecord = SceneStreamLoader::ObjectRecord;
+
+        // Reads the file and walks its header, tables and chunk directory. Chunk payloads are
+        // only located here; decoding them is left to per-chunk jobs.
+        std::shared_ptr<ParsedFile> ReadSceneFile(const std::string& filepath) {
+            auto parsed = std::make_shared<ParsedFile>();
+
+            std::ifstream file(filepath, std::ios::binary | std::ios::ate);
+            if (!file.is_open()) {
+                parsed->error = "cannot open file";
+                return parsed;
+            }
+            const std::streamsize fileSize = file.tellg();
+            if (fileSize < 0) {
+                parsed->error = "cannot determine file size";
+                return parsed;
+            }
+            file.seekg(0, std::ios::beg);
+            parsed->bytes.resize(static_cast<size_t>(fileSize));
+            if (!file.read(reinterpret_cast<char*>(parsed->bytes.data()), fileSize)) {
+                parsed->error = "read failed";
+                return parsed;
+            }
+
+            BinaryReader reader(parsed->bytes.data(), parsed->bytes.size());
+            FileHeader& header = parsed->header;
+            if (!reader.Read(header) || header.magic != SceneFormat::Magic) {
+                parsed->error = "not a scene file";
+                return parsed;
+            }
+            if (header.version < SceneFormat::MinVersion || header.version > SceneFormat::Version) {
+                parsed->error = "unsupported version " + std::to_string(header.version);
+                return parsed;
+            }
+
+            // Every table is sized from a header count; check it against the bytes left first, so
+            // a corrupt count fails the load instead of throwing from the allocation.
+            if (!reader.CanHold(header.stringCount, MinStringSize)) {
+                parsed->error = "string count " + std::to_string(header.stringCount) + " exceeds the file size";
+                return parsed;
+            }
+            parsed->strings.resize(header.stringCount);
+            for (std::string& text : parsed->strings) {
+                reader.ReadString(text);
+            }
+            if (!reader.CanHold(header.assetCount, MinAssetSize)) {
+                parsed->error = "asset count " + std::to_string(header.assetCount) + " exceeds the file size";
+                return parsed;
+            }
+            parsed->assets.resize(header.assetCount);
+            for (ParsedFile::AssetEntry& asset : parsed->assets) {
+                reader.Read(asset.hash);
+                reader.ReadString(asset.path);
+            }
+            if (!reader.CanHold(header.chunkCount, MinChunkSize)) {
+                parsed->error = "chunk count " + std::to_string(header.chunkCount) + " exceeds the file size";
+                return parsed;
+            }
+            parsed->chunks.resize(header.chunkCount);
+            uint64_t chunkObjects = 0;
+            for (ParsedFile::ChunkView& chunk : parsed->chunks) {
+                uint32_t byteSize = 0;
+                reader.Read(chunk.objectCount);
+                reader.Read(byteSize);
+                chunk.offset = reader.GetOffset();
+                chunk.size = byteSize;
+                reader.Skip(byteSize);
+                // The decode job sizes its records from the chunk's count.
+                if (chunk.objectCount > chunk.size / MinObjectSize) {
+                    parsed->error = "chunk object count " + std::to_string(chunk.objectCount) + " exceeds the chunk size";
+                    return parsed;
+                }
+                chunkObjects += chunk.objectCount;
+            }
+            if (reader.HasFailed()) {
+                parsed->error = "file is truncated or corrupt";
+                return parsed;
+            }
+
+            // The loader reserves objects and components from the header totals.
+            if (header.objectCount != chunkObjects) {
+                parsed->error = "object count " + std::to_string(header.objectCount) + " does not match the chunks (" +
+                                std::to_string(chunkObjects) + ")";
+                return parsed;
+            }
+            for (uint32_t componentCount : {header.transformCount, header.cameraCount, header.meshCount, header.rigidBodyCount}) {
+                if (componentCount > header.objectCount) {
+                    parsed->error = "component count " + std::to_string(componentCount) + " exceeds the object count";
+                    return parsed;
+                }
+            }
+            return parsed;
+        }
+
+        bool DecodeObject(BinaryReader& reader, const FileHeader& header, ObjectRecord& record) {
+            reader.Read(record.nameIndex);
+            uint16_t tagCount = 0;
+            reader.Read(tagCount);
+            record.tagIndices.resize(tagCount);
+            for (uint32_t& tagIndex : record.tagIndices) {
+                reader.Read(tagIndex);
+            }
+            reader.Read(record.flags);
+
+            if (record.flags & HasTransform) {
+                reader.Read(record.position);
+                reader.Read(record.rotation);
+                reader.Read(record.scale);
+            }
+
+            if (record.flags & HasCamera) {
+                uint8_t orthographic = 0;
+                reader.Read(orthographic);
+                record.cameraOrthographic = orthographic != 0;
+                if (record.cameraOrthographic) {
+                    reader.Read(record.orthoBounds);
+                } else {
+                    reader.Read(record.fovRadians);
+                    reader.Read(record.aspectRatio);
+                }
+                reader.Read(record.nearPlane);
+                reader.Read(record.farPlane);
+            }
+
+            if (record.flags & HasMesh) {
+                reader.ReadArray(record.meshes);
+            }
+
+            if (record.flags & HasRigidBody) {
+                RigidBodySettings& settings = record.rigidBody;
+                uint8_t shapeType = 0;
+                uint8_t kinematic = 0;
+                reader.Read(settings.mass);
+                reader.Read(shapeType);
+                reader.Read(settings.dimensions);
+                reader.Read(kinematic);
+                reader.Read(settings.friction);
+                reader.Read(settings.restitution);
+                reader.Read(settings.linearDamping);
+                reader.Read(settings.angularDamping);
+                settings.shapeType = static_cast<CollisionShapeType>(shapeType);
+                settings.isKinematic = kinematic != 0;
+
+                reader.Read(record.geometrySource);
+                if (record.geometrySource == GeometrySource::Asset) {
+                    reader.Read(record.geometryAssetIndex);
+                } else if (record.geometrySource == GeometrySource::Inline) {
+                    reader.ReadArray(settings.physicsVertices);
+                    reader.ReadArray(settings.physicsIndices);
+                }
+            }
+
+            if (record.flags & HasParticleEmitter) {
+                ParticleEmitterSettings& settings = record.emitter;
+                uint8_t collideWithDepth = 0;
+                uint8_t sortBackToFront = 0;
+                uint8_t emitting = 0;
+                reader.Read(settings.capacity);
+                reader.Read(settings.emitRate);
+                reader.Read(settings.emitRadius);
+                reader.Read(settings.velocity);
+                reader.Read(settings.velocitySpread);
+                reader.Read(settings.gravity);
+                reader.Read(settings.drag);
+                reader.Read(settings.lifetimeMin);
+                reader.Read(settings.lifetimeMax);
+                reader.Read(settings.sizeStart);
+                reader.Read(settings.sizeEnd);
+                reader.Read(settings.colorStart);
+                reader.Read(settings.colorEnd);
+                reader.Read(collideWithDepth);
+                reader.Read(settings.restitution);
+                reader.Read(sortBackToFront);
+                reader.Read(emitting);
+                settings.collideWithDepth = collideWithDepth != 0;
+                settings.sortBackToFront = sortBackToFront != 0;
+                record.emitterEmitting = emitting != 0;
+            }
+
+            if (record.flags & HasAnimator) {
+                uint8_t loop = 0;
+                reader.Read(record.animatorAssetIndex);
+                reader.Read(record.animatorClip);
+                reader.Read(record.animatorTime);
+                reader.Read(record.animatorSpeed);
+                reader.Read(loop);
+                record.animatorLoop = loop != 0;
+            }
+
+            if (record.flags & HasInstancedMesh) {
+                uint8_t hasMesh = 0;
+                reader.Read(hasMesh);
+                record.instancedHasMesh = hasMesh != 0;
+                if (record.instancedHasMesh) {
+                    reader.Read(record.instancedMesh);
+                }
+                reader.ReadArray(record.instances);
+            }
+
+            if (reader.HasFailed()) return false;
+
+            // Validate table references so instantiation can index without checks.
+            if (record.nameIndex >= header.stringCount) return false;
+            for (uint32_t tagIndex : record.tagIndices) {
+                if (tagIndex >= header.stringCount) return false;
+            }
+            for (const MeshRef& meshRef : record.meshes) {
+                if (meshRef.assetIndex >= header.assetCount) return false;
+            }
+            if (record.geometrySource == GeometrySource::Asset && record.geometryAssetIndex >= header.assetCount) return false;
+            if ((record.flags & HasParticleEmitter) && record.emitter.capacity == 0) return false; // Would size an empty GPU pool
+            if ((record.flags & HasAnimator) && record.animatorAssetIndex >= header.assetCount) return false;
+            if (record.instancedHasMesh && record.instancedMesh.assetIndex >= header.assetCount) return false;
+            return record.geometrySource <= GeometrySource::Inline;
+        }
+    }
+
+    SceneStreamLoader::SceneStreamLoader(Scene& scene, AssetManager& assetManager, PhysicsSystem* physicsSystem, JobSystem& jobSystem)
+        : m_Scene(scene), m_AssetManager(assetManager), m_PhysicsSystem(physicsSystem), m_JobSystem(jobSystem) {}
+
+    SceneStreamLoader::~SceneStreamLoader() {
+        WaitForBackgroundWork();
+        for (ModelHandle model : m_RetainedModels) {
+            m_AssetManager.ReleaseModel(model);
+        }
+    }
+
+    void SceneStreamLoader::OnModelResolved(ModelHandle handle) {
+        if (handle == InvalidModelHandle) return;
+        if (m_RetainModels) {
+            m_AssetManager.AcquireModel(handle);
+            m_RetainedModels.push_back(handle);
+        } else {
+            m_AssetManager.PinModel(handle);
+        }
+    }
+
+    void SceneStreamLoader::Cancel() {
+        if (!IsLoading()) return;
+        // In-flight jobs are left to finish; Begin() and the destructor wait for them.
+        VKENG_INFO("SceneStreamLoader: Cancelled '{}' after {} object(s).", m_FilePath, m_ObjectsLoaded);
+        Finish(State::Cancelled);
+    }
+
+    bool SceneStreamLoader::HasBackgroundWork() const {
+        auto running = [](const auto& future) {
+            return future.valid() && future.wait_for(std::chrono::seconds(0)) != std::future_status::ready;
+        };
+        if (running(m_ParseFuture)) return true;
+        for (const auto& chunk : m_Chunks) {
+            if (running(chunk->decode)) return true;
+        }
+        for (const auto& asset : m_Assets) {
+            if (running(asset->import)) return true;
+        }
+        return false;
+    }
+
+    void SceneStreamLoader::WaitForBackgroundWork() {
+        // Decode jobs write into m_Chunks; let them (and any imports) finish before it is cleared.
+        if (m_ParseFuture.valid()) m_ParseFuture.wait();
+        for (auto& chunk : m_Chunks) {
+            if (chunk->decode.valid()) chunk->decode.wait();
+        }
+        for (auto& asset : m_Assets) {
+            if (asset->import.valid()) asset->import.wait();
+        }
+    }
+
+    bool SceneStreamLoader::Begin(const std::string& filepath) {
+        if (IsLoading()) {
+            VKENG_WARN("SceneStreamLoader: Already loading '{}'; ignoring request for '{}'.", m_FilePath, filepath);
+            return false;
+        }
+
+        WaitForBackgroundWork(); // A previous load may have failed with jobs still in flight
+        m_FilePath = filepath;
+        m_StartTime = std::chrono::steady_clock::now();
+        m_File.reset();
+        m_Assets.clear();
+        m_Chunks.clear();
+        m_Strings.clear();
+        m_NextChunk = 0;
+        m_NextObjectInChunk = 0;
+        m_ObjectsLoaded = 0;
+        m_AssetsResolved = 0;
+        m_CreatedObjects.clear();
+
+        VKENG_INFO("SceneStreamLoader: Loading scene '{}'...", filepath);
+        m_State = State::Reading;
+        m_ParseFuture = m_JobSystem.Async([filepath]() { return ReadSceneFile(filepath); });
+        return true;
+    }
+
+    void SceneStreamLoader::OnFileParsed() {
+        const FileHeader& header = m_File->header;
+        m_Strings = std::move(m_File->strings);
+
+        // Reserve everything the file will create so streaming does no incremental growth.
+        m_CreatedObjects.reserve(header.objectCount);
+        m_Scene.ReserveGameObjects(header.objectCount);
+        m_Scene.ReserveComponents<TransformComponent>(header.transformCount);
+        m_Scene.ReserveComponents<CameraComponent>(header.cameraCount);
+        m_Scene.ReserveComponents<MeshComponent>(header.meshCount);
+        m_Scene.ReserveComponents<RigidBodyComponent>(header.rigidBodyCount);
+
+        // Kick off imports for every model that isn't resident yet; they run in parallel.
+        m_Assets.reserve(m_File->assets.size());
+        for (const ParsedFile::AssetEntry& entry : m_File->assets) {
+            auto slot = std::make_unique<AssetSlot>();
+            slot->hash = entry.hash;
+            slot->path = entry.path;
+            slot->handle = m_AssetManager.FindModelByHash(entry.hash);
+            if (slot->handle != InvalidModelHandle) {
+                OnModelResolved(slot->handle);
+                slot->resolved = true;
+                ++m_AssetsResolved;
+            } else {
+                std::string path = entry.path;
+                slot->import = m_JobSystem.Async([path]() {
+                    AssetSlot::ImportResult result;
+                    result.success = AssetManager::ImportModel(path, result.modelData, result.contentHash);
+                    return result;
+                });
+            }
+            m_Assets.push_back(std::move(slot));
+        }
+
+        // Decode every chunk in parallel. Jobs keep the file alive through their own reference.
+        m_Chunks.reserve(m_File->chunks.size());
+        for (const ParsedFile::ChunkView& view : m_File->chunks) {
+            auto slot = std::make_unique<ChunkSlot>();
+            ChunkSlot* chunk = slot.get();
+            std::shared_ptr<ParsedFile> file = m_File;
+            slot->decode = m_JobSystem.Async([file, view, chunk]() {
+                BinaryReader reader(file->bytes.data() + view.offset, view.size);
+                chunk->objects.resize(view.objectCount);
+                for (ObjectRecord& record : chunk->objects) {
+                    if (!DecodeObject(reader, file->header, record)) return false;
+                }
+                return true;
+            });
+            m_Chunks.push_back(std::move(slot));
+        }
+
+        m_State = State::Streaming;
+    }
+
+    void SceneStreamLoader::ResolveAssets() {
+        for (auto& asset : m_Assets) {
+            if (asset->resolved || asset->import.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+                continue;
+            }
+            AssetSlot::ImportResult result = asset->import.get();
+            if (result.success) {
+                if (result.contentHash != asset->hash) {
+                    VKENG_WARN("SceneStreamLoader: Model '{}' changed since the scene was saved; using the current file.", asset->path);
+                }
+                // GPU upload; must happen on the main thread.
+                // OnModelResolved acquires or pins it, depending on whether this content is streamed.
+                asset->handle = m_AssetManager.CreateModelFromImport(asset->path, std::move(result.modelData), result.contentHash,
+                                                                     ModelResidency::Streamed);
+                OnModelResolved(asset->handle);
+            } else {
+                VKENG_ERROR("SceneStreamLoader: Could not load model '{}' (hash {:016x}); objects using it will have no mesh.",
+                            asset->path, asset->hash);
+            }
+            asset->resolved = true;
+            ++m_AssetsResolved;
+        }
+    }
+
+    bool SceneStreamLoader::AreAssetsReady(const ObjectRecord& record) const {
+        for (const MeshRef& meshRef : record.meshes) {
+            if (!m_Assets[meshRef.assetIndex]->resolved) return false;
+        }
+        if ((record.flags & HasAnimator) && !m_Assets[record.animatorAssetIndex]->resolved) return false;
+        if (record.instancedHasMesh && !m_Assets[record.instancedMesh.assetIndex]->resolved) return false;
+        return record.geometrySource != GeometrySource::Asset || m_Assets[record.geometryAssetIndex]->resolved;
+    }
+
+    void SceneStreamLoader::Update(double timeBudgetMs /*= 4.0*/) {
+        if (m_State == State::Reading) {
+            if (m_ParseFuture.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+                return;
+            }
+            m_File = m_ParseFuture.get();
+            if (!m_File->error.empty()) {
+                VKENG_ERROR("SceneStreamLoader: Failed to load '{}': {}.", m_FilePath, m_File->error);
+                Finish(State::Failed);
+                return;
+            }
+            OnFileParsed();
+        }
+        if (m_State != State::Streaming) {
+            return;
+        }
+
+        auto frameStart = std::chrono::steady_clock::now();
+        ResolveAssets();
+
+        while (m_NextChunk < m_Chunks.size()) {
+            ChunkSlot& chunk = *m_Chunks[m_NextChunk];
+            if (!chunk.decoded) {
+                if (chunk.decode.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+                    return; // Still decoding; pick up next frame
+                }
+                if (!chunk.decode.get()) {
+                    VKENG_ERROR("SceneStreamLoader: Chunk {} of '{}' is corrupt; stopping after {} object(s).",
+                                m_NextChunk, m_FilePath, m_ObjectsLoaded);
+                    Finish(State::Failed);
+                    return;
+                }
+                chunk.decoded = true;
+            }
+
+            while (m_NextObjectInChunk < chunk.objects.size()) {
+                ObjectRecord& record = chunk.objects[m_NextObjectInChunk];
+                if (!AreAssetsReady(record)) {
+                    return; // Keep file order; wait for the model import
+                }
+                InstantiateObject(record);
+                ++m_NextObjectInChunk;
+                ++m_ObjectsLoaded;
+                // Checking the clock per object would cost more than creating one.
+                if ((m_ObjectsLoaded & 63) == 0 && MillisecondsSince(frameStart) > timeBudgetMs) {
+                    return;
+                }
+            }
+
+            chunk.objects = std::vector<ObjectRecord>(); // Release the decoded records
+            ++m_NextChunk;
+            m_NextObjectInChunk = 0;
+        }
+
+        Finish(State::Done);
+    }
+
+    void SceneStreamLoader::InstantiateObject(ObjectRecord& record) {
+        GameObject* gameObject = m_Scene.CreateGameObject(m_Strings[record.nameIndex]);
+        m_CreatedObjects.push_back(gameObject->GetHandle());
+        for (uint32_t tagIndex : record.tagIndices) {
+            gameObject->AddTag(m_Strings[tagIndex]);
+        }
+
+        if (record.flags & HasTransform) {
+            auto* transform = gameObject->AddComponent<TransformComponent>();
+            transform->SetPosition(record.position);
+            transform->SetRotation(record.rotation);
+            transform->SetScale(record.scale);
+        }
+
+        if (record.flags & HasCamera) {
+            auto* camera = gameObject->AddComponent<CameraComponent>();
+            if (record.cameraOrthographic) {
+                const glm::vec4& bounds = record.orthoBounds;
+                camera->SetOrthographic(bounds.x, bounds.y, bounds.z, bounds.w, record.nearPlane, record.farPlane);
+            } else {
+                camera->SetPerspective(record.fovRadians, record.aspectRatio, record.nearPlane, record.farPlane);
+            }
+            if (record.flags & IsMainCamera) {
+                m_Scene.SetMainCamera(gameObject);
+            }
+        }
+
+        if (record.flags & HasMesh) {
+            auto* meshComp = gameObject->AddComponent<MeshComponent>();
+            for (const MeshRef& meshRef : record.meshes) {
+                ModelHandle model = m_Assets[meshRef.assetIndex]->handle;
+                if (model == InvalidModelHandle) continue;
+                const std::vector<Mesh>& meshes = m_AssetManager.GetModelMeshes(model);
+                if (meshRef.meshIndex < meshes.size()) {
+                    meshComp->AddMesh(&meshes[meshRef.meshIndex]);
+                }
+            }
+        }
+
+        if (record.flags & HasRigidBody) {
+            RigidBodySettings& settings = record.rigidBody;
+            if (record.geometrySource == GeometrySource::Asset) {
+                ModelHandle model = m_Assets[record.geometryAssetIndex]->handle;
+                if (const LoadedModelData* modelData = m_AssetManager.GetLoadedModelData(model)) {
+                    settings.physicsVertices = modelData->allVerticesPhysics;
+                    settings.physicsIndices = modelData->allIndicesPhysics;
+                }
+            }
+            auto* rigidBody = gameObject->AddComponent<RigidBodyComponent>(settings);
+            if (m_PhysicsSystem) {
+                rigidBody->InitializePhysics(m_PhysicsSystem);
+            }
+            // The record is released after this chunk; drop inline geometry now rather than hold two copies.
+            settings.physicsVertices = std::vector<glm::vec3>();
+            settings.physicsIndices = std::vector<uint32_t>();
+        }
+
+        if (record.flags & HasParticleEmitter) {
+            auto* emitter = gameObject->AddComponent<ParticleEmitterComponent>(record.emitter);
+            emitter->SetEmitting(record.emitterEmitting);
+        }
+
+        if (record.flags & HasAnimator) {
+            ModelHandle model = m_Assets[record.animatorAssetIndex]->handle;
+            const LoadedModelData* modelData = model != InvalidModelHandle ? m_AssetManager.GetLoadedModelData(model) : nullptr;
+            if (modelData && modelData->skeleton) {
+                auto* animator = gameObject->AddComponent<AnimatorComponent>(modelData->skeleton);
+                animator->SetSpeed(record.animatorSpeed);
+                if (record.animatorClip < modelData->animations.size()) {
+                    animator->Play(modelData->animations[record.animatorClip], record.animatorLoop);
+                    animator->SetTime(record.animatorTime);
+                }
+            } else {
+                VKENG_WARN("SceneStreamLoader: GameObject '{}' lost its animator; its model has no skeleton.", gameObject->GetName());
+            }
+        }
+
+        if (record.flags & HasInstancedMesh) {
+            const Mesh* mesh = nullptr;
+            if (record.instancedHasMesh) {
+                ModelHandle model = m_Assets[record.instancedMesh.assetIndex]->handle;
+                if (model != InvalidModelHandle) {
+                    const std::vector<Mesh>& meshes = m_AssetManager.GetModelMeshes(model);
+                    if (record.instancedMesh.meshIndex < meshes.size()) mesh = &meshes[record.instancedMesh.meshIndex];
+                }
+            }
+            auto* instanced = gameObject->AddComponent<InstancedMeshComponent>(mesh);
+            instanced->SetInstances(record.instances.data(), record.instances.size());
+            record.instances = std::vector<InstanceData>(); // Copied into the component
+        }
+    }
+
+    void SceneStreamLoader::Finish(State finalState) {
+        m_State = finalState;
+        m_TotalMs = MillisecondsSince(m_StartTime);
+        m_File.reset();
+        if (finalState == State::Done) {
+            VKENG_INFO("SceneStreamLoader: Loaded {} GameObject(s) and {} model(s) from '{}' in {:.2f} ms.",
+                       m_ObjectsLoaded, m_Assets.size(), m_FilePath, m_TotalMs);
+        }
+    }
+
+    SceneStreamLoader::Progress SceneStreamLoader::GetProgress() const {
+        Progress progress;
+        progress.state = m_State;
+        progress.objectsLoaded = m_ObjectsLoaded;
+        progress.objectCount = m_File ? m_File->header.objectCount : m_ObjectsLoaded;
+        progress.assetsResolved = m_AssetsResolved;
+        progress.assetCount = m_Assets.size();
+        progress.elapsedMs = IsLoading() ? MillisecondsSince(m_StartTime) : m_TotalMs;
+        return progress;
+    }
+
+} // namespace VulkEng
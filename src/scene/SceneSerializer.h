@@ -0,0 +1,143 @@
+#pragma once
+
+#include "assets/AssetManager.h" // For ModelHandle, AssetHash, LoadedModelData
+#include "EntityHandle.h"
+
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace VulkEng {
+
+    class Scene;
+    class GameObject;
+    class PhysicsSystem;
+    class JobSystem;
+
+    // Binary scene format (".vksc"). Little-endian, laid out as:
+    //   Header         magic, version, object/asset/chunk/string counts, per-component-type counts
+    //   String table   every object name and tag, stored once
+    //   Asset table    per referenced model: content hash (identity) + path (location hint)
+    //   Object chunks  [objectCount, byteSize, payload] x chunkCount; each chunk decodes independently
+    // Assets are referenced by content hash, so moving a file on disk doesn't break scenes,
+    // and a model already loaded under another path is reused.
+    // Each version only adds component types, so files from MinVersion on still load.
+    namespace SceneFormat {
+        constexpr uint32_t Magic = 0x43534B56; // "VKSC"
+        constexpr uint32_t Version = 4;        // 2: particle emitters, 3: animators, 4: instanced meshes
+        constexpr uint32_t MinVersion = 1;
+        constexpr uint32_t ObjectsPerChunk = 256;
+    }
+
+    class SceneSerializer {
+    public:
+        // Writes every live GameObject in `scene` with its Transform, Camera, Mesh, RigidBody,
+        // ParticleEmitter, Animator and InstancedMesh data. Meshes, skeletons and clips must come from models loaded
+        // through `assetManager`; others are skipped, as are components of other types, with a warning.
+        static bool Save(const Scene& scene, const AssetManager& assetManager, const std::string& filepath);
+        // Writes only `gameObjects` (all owned by `scene`), e.g. one world partition cell.
+        static bool Save(const Scene& scene, const std::vector<const GameObject*>& gameObjects,
+                         const AssetManager& assetManager, const std::string& filepath);
+        // True if Save would store `gameObject` completely: every component is of a type the format
+        // covers and every mesh, skeleton and clip belongs to a model loaded through `assetManager`.
+        static bool CanRepresent(const GameObject& gameObject, const AssetManager& assetManager);
+    };
+
+    // Loads a .vksc file into a Scene incrementally so rendering continues while a level streams in.
+    // File reading, chunk decoding and model imports run on the JobSystem; GPU uploads and object
+    // creation stay on the main thread inside Update(), which is bounded by a per-frame time budget.
+    // Objects are created in file order, each as soon as the models it references are resident.
+    class SceneStreamLoader {
+    public:
+        enum class State { Idle, Reading, Streaming, Done, Failed, Cancelled };
+
+        struct Progress {
+            State state = State::Idle;
+            size_t objectsLoaded = 0;
+            size_t objectCount = 0;
+            size_t assetsResolved = 0;
+            size_t assetCount = 0;
+            double elapsedMs = 0.0; // Since Begin
+        };
+
+        // `physicsSystem` may be null, in which case rigid bodies are created but not added to a world.
+        SceneStreamLoader(Scene& scene, AssetManager& assetManager, PhysicsSystem* physicsSystem, JobSystem& jobSystem);
+        // Waits for any in-flight background work (it references this loader's state).
+        ~SceneStreamLoader();
+
+        SceneStreamLoader(const SceneStreamLoader&) = delete;
+        SceneStreamLoader& operator=(const SceneStreamLoader&) = delete;
+
+        // Starts loading `filepath` in the background. Returns false if a load is already running.
+        bool Begin(const std::string& filepath);
+        // Main thread, once per frame: finalizes imported models and instantiates ready objects
+        // until `timeBudgetMs` has been spent.
+        void Update(double timeBudgetMs = 4.0);
+        // Stops loading. Objects created so far stay in the scene (see GetCreatedObjects).
+        void Cancel();
+
+        bool IsLoading() const { return m_State == State::Reading || m_State == State::Streaming; }
+        // True while a parse, decode or import job still references this loader, e.g. after Cancel().
+        // Destroying the loader waits for them; check this first to avoid blocking.
+        bool HasBackgroundWork() const;
+        bool IsDone() const { return m_State == State::Done; }
+        bool HasFailed() const { return m_State == State::Failed; }
+        Progress GetProgress() const;
+
+        // Every GameObject this loader has created, in creation order.
+        const std::vector<EntityHandle>& GetCreatedObjects() const { return m_CreatedObjects; }
+
+        // When enabled, the loader takes a reference (AssetManager::AcquireModel) on each model
+        // it resolves, so streamed models can be unloaded once nothing uses them. The caller takes
+        // ownership of the references with TakeModelReferences(); any left are released on destruction.
+        // Otherwise the loaded content is permanent and every model it uses is pinned, including
+        // ones a retaining loader streamed in earlier.
+        void SetRetainModels(bool retain) { m_RetainModels = retain; }
+        std::vector<ModelHandle> TakeModelReferences() { return std::move(m_RetainedModels); }
+
+        // Decoded file contents (defined in the .cpp, where the decoding helpers fill them in).
+        struct ObjectRecord;
+        struct ParsedFile;
+        struct AssetSlot;
+        struct ChunkSlot;
+
+    private:
+        void OnFileParsed();
+        void ResolveAssets();
+        bool AreAssetsReady(const ObjectRecord& record) const;
+        void InstantiateObject(ObjectRecord& record);
+        void Finish(State finalState);
+        void WaitForBackgroundWork();
+        void OnModelResolved(ModelHandle handle);
+
+        Scene& m_Scene;
+        AssetManager& m_AssetManager;
+        PhysicsSystem* m_PhysicsSystem;
+        JobSystem& m_JobSystem;
+
+        State m_State = State::Idle;
+        std::string m_FilePath;
+        std::chrono::steady_clock::time_point m_StartTime;
+        double m_TotalMs = 0.0;
+
+        std::future<std::shared_ptr<ParsedFile>> m_ParseFuture;
+        std::shared_ptr<ParsedFile> m_File;
+        std::vector<std::unique_ptr<AssetSlot>> m_Assets;
+        std::vector<std::unique_ptr<ChunkSlot>> m_Chunks;
+        std::vector<std::string> m_Strings;
+
+        // Streaming cursor: next chunk / object within it to instantiate.
+        size_t m_NextChunk = 0;
+        size_t m_NextObjectInChunk = 0;
+        size_t m_ObjectsLoaded = 0;
+        size_t m_AssetsResolved = 0;
+
+        std::vector<EntityHandle> m_CreatedObjects;
+        bool m_RetainModels = false;
+        std::vector<ModelHandle> m_RetainedModels;
+    };
+
+} // namespace VulkEng
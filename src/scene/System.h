@@ -0,0 +1,140 @@
+#pragma once
+
+#include "Component.h"
+#include "Scene.h"          // For Scene::GetComponentsOfType
+#include "core/JobSystem.h" // For chunked parallel updates
+
+#include <algorithm>
+#include <optional>  // For the component type a system claims
+#include <string>
+#include <typeindex> // For component type identities
+#include <typeinfo>
+#include <vector>
+
+namespace VulkEng {
+
+    // Declares which component types (and shared state) a System touches.
+    // The SystemScheduler runs two systems concurrently only if their access sets do not conflict.
+    class SystemAccess {
+    public:
+        template <typename T>
+        SystemAccess& Read() {
+            AddUnique(m_Reads, std::type_index(typeid(T)));
+            return *this;
+        }
+
+        template <typename T>
+        SystemAccess& Write() {
+            AddUnique(m_Writes, std::type_index(typeid(T)));
+            return *this;
+        }
+
+        // Marks the system as touching state not expressible as component types
+        // (physics world, renderer, scene structure). Exclusive systems never run concurrently with others.
+        SystemAccess& Exclusive() {
+            m_Exclusive = true;
+            return *this;
+        }
+
+        // True if running both systems at the same time could race.
+        bool ConflictsWith(const SystemAccess& other) const {
+            if (m_Exclusive || other.m_Exclusive) {
+                return true;
+            }
+            for (const std::type_index& type : m_Writes) {
+                if (Contains(other.m_Writes, type) || Contains(other.m_Reads, type)) {
+                    return true;
+                }
+            }
+            for (const std::type_index& type : m_Reads) {
+                if (Contains(other.m_Writes, type)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        const std::vector<std::type_index>& GetReads() const { return m_Reads; }
+        const std::vector<std::type_index>& GetWrites() const { return m_Writes; }
+        bool IsExclusive() const { return m_Exclusive; }
+
+    private:
+        static bool Contains(const std::vector<std::type_index>& list, const std::type_index& type) {
+            return std::find(list.begin(), list.end(), type) != list.end();
+        }
+        static void AddUnique(std::vector<std::type_index>& list, const std::type_index& type) {
+            if (!Contains(list, type)) {
+                list.push_back(type);
+            }
+        }
+
+        std::vector<std::type_index> m_Reads;
+        std::vector<std::type_index> m_Writes;
+        bool m_Exclusive = false;
+    };
+
+    // A unit of per-frame logic scheduled by the Scene's SystemScheduler.
+    // Systems must not create or destroy GameObjects or components while running
+    // (Scene::DestroyGameObject is the exception; it is safe to call from any system).
+    class System {
+    public:
+        virtual ~System() = default;
+
+        virtual const char* GetName() const = 0;
+        // Called once when the system is added to a scheduler.
+        virtual void DeclareAccess(SystemAccess& access) const = 0;
+        // Runs the system for one frame. `jobs` may be used to split work across workers.
+        virtual void Update(Scene& scene, JobSystem& jobs, float deltaTime) = 0;
+
+        // If set, the Scene stops calling Component::Update for this type itself;
+        // the system takes over updating it.
+        virtual std::optional<std::type_index> GetUpdatedComponentType() const { return std::nullopt; }
+    };
+
+    // Updates every component of type T in one tight loop over the scene's per-type list.
+    // The call is non-virtual (qualified T::Update), and when `parallelChunks` is set the list is split
+    // into chunks of `chunkSize` that run on worker threads. Only enable that for components whose
+    // Update touches nothing but their own state (plus declared reads).
+    template <typename T>
+    class ComponentUpdateSystem : public System {
+    public:
+        static_assert(std::is_base_of<Component, T>::value, "T must derive from Component.");
+
+        explicit ComponentUpdateSystem(bool parallelChunks = false, uint32_t chunkSize = 256)
+            : m_Name(std::string("Update<") + typeid(T).name() + ">"),
+              m_ParallelChunks(parallelChunks), m_ChunkSize(chunkSize) {
+            m_Access.template Write<T>();
+        }
+
+        // Additional access declarations, e.g. GetAccess().Read<TransformComponent>().
+        // Must be called before the system is added to a scheduler.
+        SystemAccess& GetAccess() { return m_Access; }
+
+        const char* GetName() const override { return m_Name.c_str(); }
+        void DeclareAccess(SystemAccess& access) const override { access = m_Access; }
+        std::optional<std::type_index> GetUpdatedComponentType() const override { return std::type_index(typeid(T)); }
+
+        void Update(Scene& scene, JobSystem& jobs, float deltaTime) override {
+            const std::vector<Component*>& components = scene.GetComponentsOfType<T>();
+            const uint32_t count = static_cast<uint32_t>(components.size());
+            auto updateRange = [&components, deltaTime](uint32_t begin, uint32_t end) {
+                for (uint32_t i = begin; i < end; ++i) {
+                    static_cast<T*>(components[i])->T::Update(deltaTime);
+                }
+            };
+
+            if (m_ParallelChunks) {
+                jobs.ParallelFor(count, m_ChunkSize, updateRange);
+            } else {
+                updateRange(0, count);
+            }
+        }
+
+    private:
+        std::string m_Name;
+        SystemAccess m_Access;
+        bool m_ParallelChunks;
+        uint32_t m_ChunkSize;
+    };
+
+} // namespace VulkEng
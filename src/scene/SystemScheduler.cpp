@@ -0,0 +1,62 @@
+#include "SystemScheduler.h"
+#include "Scene.h"
+#include "core/JobSystem.h"
+#include "core/Log.h"
+
+#include <algorithm> // For std::max
+
+namespace VulkEng {
+
+    System* SystemScheduler::AddSystem(std::unique_ptr<System> system) {
+        if (!system) {
+            VKENG_WARN("SystemScheduler: Attempted to add a null system.");
+            return nullptr;
+        }
+
+        SystemEntry entry;
+        system->DeclareAccess(entry.access);
+        if (auto updatedType = system->GetUpdatedComponentType()) {
+            m_HandledTypes.insert(*updatedType);
+        }
+        entry.system = std::move(system);
+        m_Systems.push_back(std::move(entry));
+        AssignStage(m_Systems.size() - 1);
+
+        const SystemEntry& added = m_Systems.back();
+        VKENG_INFO("SystemScheduler: Added system '{}' (stage {}).", added.system->GetName(), added.stage);
+        return added.system.get();
+    }
+
+    void SystemScheduler::AssignStage(size_t systemIndex) {
+        SystemEntry& entry = m_Systems[systemIndex];
+        size_t stage = 0;
+        for (size_t i = 0; i < systemIndex; ++i) {
+            if (entry.access.ConflictsWith(m_Systems[i].access)) {
+                stage = std::max(stage, m_Systems[i].stage + 1);
+            }
+        }
+        entry.stage = stage;
+        if (stage >= m_Stages.size()) {
+            m_Stages.resize(stage + 1);
+        }
+        m_Stages[stage].push_back(systemIndex);
+    }
+
+    void SystemScheduler::Run(Scene& scene, JobSystem& jobs, float deltaTime) {
+        for (const std::vector<size_t>& stage : m_Stages) {
+            if (stage.size() == 1) {
+                // No point going through the queue; the system may still fan out via ParallelFor.
+                m_Systems[stage.front()].system->Update(scene, jobs, deltaTime);
+                continue;
+            }
+
+            JobCounter stageCounter;
+            for (size_t systemIndex : stage) {
+                System* system = m_Systems[systemIndex].system.get();
+                jobs.Submit([system, &scene, &jobs, deltaTime]() { system->Update(scene, jobs, deltaTime); }, &stageCounter);
+            }
+            jobs.Wait(stageCounter);
+        }
+    }
+
+} // namespace VulkEng
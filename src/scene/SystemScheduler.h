@@ -0,0 +1,62 @@
+#pragma once
+
+#include "System.h"
+
+#include <memory>        // For std::unique_ptr
+#include <typeindex>
+#include <unordered_set> // For component types claimed by systems
+#include <utility>
+#include <vector>
+
+namespace VulkEng {
+
+    class Scene;
+    class JobSystem;
+
+    // Orders registered Systems into stages. Systems in the same stage have non-conflicting
+    // access sets and run concurrently; a system always runs after every earlier-registered
+    // system it conflicts with, so registration order defines the order of dependent systems.
+    class SystemScheduler {
+    public:
+        SystemScheduler() = default;
+        ~SystemScheduler() = default;
+
+        SystemScheduler(const SystemScheduler&) = delete;
+        SystemScheduler& operator=(const SystemScheduler&) = delete;
+
+        // Takes ownership of the system and returns a raw pointer to it.
+        System* AddSystem(std::unique_ptr<System> system);
+
+        template <typename T, typename... Args>
+        T* AddSystem(Args&&... args) {
+            auto system = std::make_unique<T>(std::forward<Args>(args)...);
+            T* rawPtr = system.get();
+            AddSystem(std::move(system));
+            return rawPtr;
+        }
+
+        // Runs all systems, stage by stage. Blocks until every stage has finished.
+        void Run(Scene& scene, JobSystem& jobs, float deltaTime);
+
+        // True if a registered system updates components of this type.
+        bool IsComponentTypeHandled(const std::type_index& type) const { return m_HandledTypes.count(type) > 0; }
+
+        size_t GetSystemCount() const { return m_Systems.size(); }
+        size_t GetStageCount() const { return m_Stages.size(); }
+
+    private:
+        struct SystemEntry {
+            std::unique_ptr<System> system;
+            SystemAccess access;
+            size_t stage = 0;
+        };
+
+        // Places the newest system in the first stage after all conflicting predecessors.
+        void AssignStage(size_t systemIndex);
+
+        std::vector<SystemEntry> m_Systems;
+        std::vector<std::vector<size_t>> m_Stages; // Stage -> indices into m_Systems
+        std::unordered_set<std::type_index> m_HandledTypes;
+    };
+
+} // namespace VulkEng
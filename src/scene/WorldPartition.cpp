@@ -0,0 +1,337 @@
+#include "WorldPartition.h"
+#include "Scene.h"
+#include "GameObject.h"
+#include "Components/TransformComponent.h"
+#include "Components/CameraComponent.h"
+#include "Components/RigidBodyComponent.h"
+#include "core/AtomicFile.h"
+#include "core/Log.h"
+
+#include <algorithm>  // For std::sort, std::min, std::remove_if
+#include <chrono>
+#include <cmath>      // For std::floor
+#include <filesystem>
+#include <fstream>
+
+namespace VulkEng {
+
+    namespace {
+        constexpr uint32_t IndexMagic = 0x50574B56; // "VKWP"
+        constexpr uint32_t IndexVersion = 1;
+        const char* const IndexFileName = "world.vkwp";
+        const char* const PersistentSceneFileName = "persistent.vksc";
+
+        int32_t CellIndex(float coordinate, float cellSize) {
+            return static_cast<int32_t>(std::floor(coordinate / cellSize));
+        }
+    }
+
+    WorldPartition::WorldPartition(Scene& scene, AssetManager& assetManager, PhysicsSystem* physicsSystem, JobSystem& jobSystem)
+        : WorldPartition(scene, assetManager, physicsSystem, jobSystem, Settings()) {}
+
+    WorldPartition::WorldPartition(Scene& scene, AssetManager& assetManager, PhysicsSystem* physicsSystem,
+                                   JobSystem& jobSystem, const Settings& settings)
+        : m_Scene(scene), m_AssetManager(assetManager), m_PhysicsSystem(physicsSystem), m_JobSystem(jobSystem),
+          m_Settings(settings) {
+        if (m_Settings.unloadRadius < m_Settings.loadRadius) {
+            VKENG_WARN("WorldPartition: unloadRadius ({}) is smaller than loadRadius ({}); using loadRadius.",
+                       m_Settings.unloadRadius, m_Settings.loadRadius);
+            m_Settings.unloadRadius = m_Settings.loadRadius;
+        }
+    }
+
+    WorldPartition::~WorldPartition() {
+        // Must run while the scene is still alive: cell objects are destroyed and their bodies removed.
+        for (auto& [key, cell] : m_ActiveCells) {
+            UnloadCell(cell);
+        }
+        m_ActiveCells.clear();
+        m_RetiredLoaders.clear(); // Waits for their jobs; acceptable on teardown
+    }
+
+    std::string WorldPartition::CellFileName(const CellCoord& coord) {
+        return "cell_" + std::to_string(coord.x) + "_" + std::to_string(coord.z) + ".vksc";
+    }
+
+    float WorldPartition::DistanceToCell(const glm::vec3& position, const CellCoord& coord) const {
+        const float minX = static_cast<float>(coord.x) * m_CellSize;
+        const float minZ = static_cast<float>(coord.z) * m_CellSize;
+        const float dx = std::max({ minX - position.x, 0.0f, position.x - (minX + m_CellSize) });
+        const float dz = std::max({ minZ - position.z, 0.0f, position.z - (minZ + m_CellSize) });
+        return std::sqrt(dx * dx + dz * dz);
+    }
+
+    bool WorldPartition::Open(const std::string& directory) {
+        const std::string indexPath = (std::filesystem::path(directory) / IndexFileName).string();
+        std::ifstream file(indexPath, std::ios::binary);
+        if (!file.is_open()) {
+            VKENG_ERROR("WorldPartition: Cannot open index '{}'.", indexPath);
+            return false;
+        }
+
+        uint32_t magic = 0, version = 0, cellCount = 0;
+        float cellSize = 0.0f;
+        file.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+        file.read(reinterpret_cast<char*>(&version), sizeof(version));
+        file.read(reinterpret_cast<char*>(&cellSize), sizeof(cellSize));
+        file.read(reinterpret_cast<char*>(&cellCount), sizeof(cellCount));
+        if (!file || magic != IndexMagic || version != IndexVersion || !(cellSize > 0.0f)) {
+            VKENG_ERROR("WorldPartition: '{}' is not a valid partition index.", indexPath);
+            return false;
+        }
+
+        std::unordered_set<uint64_t> cells;
+        cells.reserve(cellCount);
+        for (uint32_t i = 0; i < cellCount; ++i) {
+            CellCoord coord;
+            file.read(reinterpret_cast<char*>(&coord.x), sizeof(coord.x));
+            file.read(reinterpret_cast<char*>(&coord.z), sizeof(coord.z));
+            cells.insert(PackCoord(coord));
+        }
+        if (!file) {
+            VKENG_ERROR("WorldPartition: Index '{}' is truncated.", indexPath);
+            return false;
+        }
+
+        m_Directory = directory;
+        m_CellSize = cellSize;
+        m_NonEmptyCells = std::move(cells);
+        VKENG_INFO("WorldPartition: Opened '{}' ({} cell(s) of {} units).", directory, m_NonEmptyCells.size(), m_CellSize);
+        return true;
+    }
+
+    void WorldPartition::Update(const glm::vec3& focusPosition) {
+        if (!IsOpen()) return;
+        UnloadDistantCells(focusPosition);
+        RequestLoads(focusPosition);
+        PumpLoaders();
+        FreeRetiredLoaders();
+    }
+
+    void WorldPartition::FreeRetiredLoaders() {
+        m_RetiredLoaders.erase(
+            std::remove_if(m_RetiredLoaders.begin(), m_RetiredLoaders.end(),
+                           [](const std::unique_ptr<SceneStreamLoader>& loader) { return !loader->HasBackgroundWork(); }),
+            m_RetiredLoaders.end());
+    }
+
+    void WorldPartition::UnloadDistantCells(const glm::vec3& focusPosition) {
+        for (auto it = m_ActiveCells.begin(); it != m_ActiveCells.end();) {
+            if (DistanceToCell(focusPosition, it->second.coord) > m_Settings.unloadRadius) {
+                UnloadCell(it->second);
+                it = m_ActiveCells.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    void WorldPartition::RequestLoads(const glm::vec3& focusPosition) {
+        size_t loadingCount = 0;
+        for (const auto& [key, cell] : m_ActiveCells) {
+            if (cell.state == CellState::Loading) ++loadingCount;
+        }
+        if (loadingCount >= m_Settings.maxConcurrentLoads) return;
+
+        // Only the square of cells covering the load radius is scanned, independent of world size.
+        struct Candidate {
+            float distance;
+            CellCoord coord;
+        };
+        std::vector<Candidate> candidates;
+        const float radius = m_Settings.loadRadius;
+        const int32_t minX = CellIndex(focusPosition.x - radius, m_CellSize);
+        const int32_t maxX = CellIndex(focusPosition.x + radius, m_CellSize);
+        const int32_t minZ = CellIndex(focusPosition.z - radius, m_CellSize);
+        const int32_t maxZ = CellIndex(focusPosition.z + radius, m_CellSize);
+        for (int32_t z = minZ; z <= maxZ; ++z) {
+            for (int32_t x = minX; x <= maxX; ++x) {
+                CellCoord coord{ x, z };
+                uint64_t key = PackCoord(coord);
+                if (m_ActiveCells.count(key) || !m_NonEmptyCells.count(key)) continue;
+                float distance = DistanceToCell(focusPosition, coord);
+                if (distance <= radius) {
+                    candidates.push_back({ distance, coord });
+                }
+            }
+        }
+
+        // Nearest cells first.
+        std::sort(candidates.begin(), candidates.end(),
+                  [](const Candidate& a, const Candidate& b) { return a.distance < b.distance; });
+        const size_t slots = m_Settings.maxConcurrentLoads - loadingCount;
+        for (size_t i = 0; i < std::min(slots, candidates.size()); ++i) {
+            Cell& cell = m_ActiveCells[PackCoord(candidates[i].coord)];
+            cell.coord = candidates[i].coord;
+            cell.state = CellState::Loading;
+            cell.loader = std::make_unique<SceneStreamLoader>(m_Scene, m_AssetManager, m_PhysicsSystem, m_JobSystem);
+            cell.loader->SetRetainModels(true);
+            cell.loader->Begin((std::filesystem::path(m_Directory) / CellFileName(cell.coord)).string());
+        }
+    }
+
+    void WorldPartition::PumpLoaders() {
+        auto frameStart = std::chrono::steady_clock::now();
+        for (auto& [key, cell] : m_ActiveCells) {
+            if (cell.state != CellState::Loading) continue;
+
+            double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count();
+            double remainingMs = m_Settings.activationBudgetMs - elapsedMs;
+            if (remainingMs <= 0.0) break;
+
+            cell.loader->Update(remainingMs);
+            if (cell.loader->IsLoading()) continue;
+
+            // A failed cell keeps whatever it created and is not retried until it unloads.
+            cell.objects = cell.loader->GetCreatedObjects();
+            cell.models = cell.loader->TakeModelReferences();
+            cell.loader.reset();
+            cell.state = CellState::Resident;
+            ++m_CellsLoaded;
+        }
+    }
+
+    void WorldPartition::UnloadCell(Cell& cell) {
+        if (cell.loader) {
+            // A cancelled loader resolves no further models, so the references taken here are all it
+            // will ever hold. Its in-flight jobs are left to finish off the main thread.
+            cell.loader->Cancel();
+            cell.objects = cell.loader->GetCreatedObjects();
+            cell.models = cell.loader->TakeModelReferences();
+            m_RetiredLoaders.push_back(std::move(cell.loader));
+        }
+
+        for (EntityHandle handle : cell.objects) {
+            GameObject* gameObject = m_Scene.GetGameObject(handle);
+            if (!gameObject) continue; // Destroyed by gameplay code meanwhile
+            if (m_PhysicsSystem) {
+                if (auto* rigidBody = gameObject->GetComponent<RigidBodyComponent>()) {
+                    rigidBody->CleanupPhysics(m_PhysicsSystem);
+                }
+            }
+            m_Scene.DestroyGameObject(gameObject);
+        }
+        // Safe before the objects are actually removed: AssetManager defers freeing mesh data.
+        for (ModelHandle model : cell.models) {
+            m_AssetManager.ReleaseModel(model);
+        }
+        cell.objects.clear();
+        cell.models.clear();
+        ++m_CellsUnloaded;
+    }
+
+    WorldPartition::Stats WorldPartition::GetStats() const {
+        Stats stats;
+        stats.cellCount = m_NonEmptyCells.size();
+        for (const auto& [key, cell] : m_ActiveCells) {
+            if (cell.state == CellState::Loading) {
+                ++stats.loadingCells;
+                stats.residentObjects += cell.loader->GetCreatedObjects().size();
+            } else {
+                ++stats.residentCells;
+                stats.residentObjects += cell.objects.size();
+            }
+        }
+        stats.cellsLoaded = m_CellsLoaded;
+        stats.cellsUnloaded = m_CellsUnloaded;
+        return stats;
+    }
+
+    bool WorldPartition::Exists(const std::string& directory) {
+        return std::filesystem::exists(std::filesystem::path(directory) / IndexFileName);
+    }
+
+    std::string WorldPartition::GetPersistentScenePath(const std::string& directory) {
+        return (std::filesystem::path(directory) / PersistentSceneFileName).string();
+    }
+
+    bool WorldPartition::Bake(const Scene& scene, const AssetManager& assetManager, float cellSize, const std::string& directory,
+                              std::vector<EntityHandle>* outBakedObjects /*= nullptr*/) {
+        if (!(cellSize > 0.0f)) {
+            VKENG_ERROR("WorldPartition: Cell size must be positive (got {}).", cellSize);
+            return false;
+        }
+
+        struct BakeCell {
+            CellCoord coord;
+            std::vector<const GameObject*> objects;
+        };
+        std::unordered_map<uint64_t, BakeCell> cells;
+        std::vector<const GameObject*> persistentObjects;
+        size_t skipped = 0;
+        for (const GameObjectPtr& gameObject : scene.GetAllGameObjects()) {
+            const auto* transform = gameObject->GetComponent<TransformComponent>();
+            if (gameObject->IsPendingDestroy()) {
+                ++skipped;
+                continue;
+            }
+            // Cameras and objects without a position belong in the persistent scene. So do objects the
+            // scene format can't fully store: a cell would bring them back without some of their state.
+            if (!transform || gameObject->HasComponent<CameraComponent>() ||
+                !SceneSerializer::CanRepresent(*gameObject, assetManager)) {
+                persistentObjects.push_back(gameObject.get());
+                ++skipped;
+                continue;
+            }
+            CellCoord coord{ CellIndex(transform->GetPosition().x, cellSize), CellIndex(transform->GetPosition().z, cellSize) };
+            BakeCell& cell = cells[PackCoord(coord)];
+            cell.coord = coord;
+            cell.objects.push_back(gameObject.get());
+        }
+
+        std::error_code error;
+        std::filesystem::create_directories(directory, error);
+        if (error) {
+            VKENG_ERROR("WorldPartition: Cannot create '{}': {}", directory, error.message());
+            return false;
+        }
+
+        std::vector<CellCoord> written;
+        written.reserve(cells.size());
+        for (const auto& [key, cell] : cells) {
+            const std::string cellPath = (std::filesystem::path(directory) / CellFileName(cell.coord)).string();
+            if (!SceneSerializer::Save(scene, cell.objects, assetManager, cellPath)) {
+                return false;
+            }
+            written.push_back(cell.coord);
+        }
+        if (!SceneSerializer::Save(scene, persistentObjects, assetManager, GetPersistentScenePath(directory))) {
+            return false;
+        }
+
+        // The index goes last and replaces the old one in a single rename: until then a previous bake
+        // stays usable, and a bake that fails part-way never leaves an index naming missing cells.
+        const std::string indexPath = (std::filesystem::path(directory) / IndexFileName).string();
+        const uint32_t cellCount = static_cast<uint32_t>(written.size());
+        std::string indexError;
+        bool indexWritten = WriteFileAtomically(indexPath, [&](std::ostream& file) {
+            file.write(reinterpret_cast<const char*>(&IndexMagic), sizeof(IndexMagic));
+            file.write(reinterpret_cast<const char*>(&IndexVersion), sizeof(IndexVersion));
+            file.write(reinterpret_cast<const char*>(&cellSize), sizeof(cellSize));
+            file.write(reinterpret_cast<const char*>(&cellCount), sizeof(cellCount));
+            for (const CellCoord& coord : written) {
+                file.write(reinterpret_cast<const char*>(&coord.x), sizeof(coord.x));
+                file.write(reinterpret_cast<const char*>(&coord.z), sizeof(coord.z));
+            }
+            return static_cast<bool>(file);
+        }, &indexError);
+        if (!indexWritten) {
+            VKENG_ERROR("WorldPartition: Failed to write index '{}': {}", indexPath, indexError);
+            return false;
+        }
+
+        if (outBakedObjects) {
+            outBakedObjects->clear();
+            for (const auto& [key, cell] : cells) {
+                for (const GameObject* gameObject : cell.objects) {
+                    outBakedObjects->push_back(gameObject->GetHandle());
+                }
+            }
+        }
+
+        VKENG_INFO("WorldPartition: Baked {} object(s) into {} cell(s) of {} units in '{}' ({} left in the persistent scene).",
+                   scene.GetGameObjectCount() - skipped, written.size(), cellSize, directory, skipped);
+        return true;
+    }
+
+} // namespace VulkEng
@@ -0,0 +1,127 @@
+#pragma once
+
+#include "EntityHandle.h"
+#include "SceneSerializer.h" // For SceneStreamLoader
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace VulkEng {
+
+    class Scene;
+    class AssetManager;
+    class PhysicsSystem;
+    class JobSystem;
+
+    // Splits a world into square cells on the XZ plane, each stored as its own .vksc file, and keeps
+    // only the cells around the camera resident. Cells load through SceneStreamLoader (background
+    // decode and model import, budgeted activation) and unload by destroying their GameObjects,
+    // removing their physics bodies and releasing their models. Memory therefore scales with the
+    // streaming radius, not with the size of the world.
+    //
+    // On disk a partition is a directory holding "world.vkwp" (cell size and the list of non-empty
+    // cells) plus one "cell_<x>_<z>.vksc" per cell. Bake() produces it from a regular scene.
+    class WorldPartition {
+    public:
+        struct Settings {
+            float loadRadius = 150.0f;   // Cells whose nearest point is within this distance are loaded
+            float unloadRadius = 200.0f; // ...and unloaded once beyond this one (> loadRadius, avoids thrash)
+            uint32_t maxConcurrentLoads = 4;
+            double activationBudgetMs = 2.0; // Main-thread time per frame spent instantiating cell content
+        };
+
+        struct Stats {
+            size_t cellCount = 0;     // Non-empty cells in the partition
+            size_t residentCells = 0; // Fully loaded
+            size_t loadingCells = 0;
+            size_t residentObjects = 0;
+            uint64_t cellsLoaded = 0;   // Lifetime counters
+            uint64_t cellsUnloaded = 0;
+        };
+
+        WorldPartition(Scene& scene, AssetManager& assetManager, PhysicsSystem* physicsSystem, JobSystem& jobSystem);
+        WorldPartition(Scene& scene, AssetManager& assetManager, PhysicsSystem* physicsSystem, JobSystem& jobSystem,
+                       const Settings& settings);
+        // Unloads every active cell, so it must be destroyed before its Scene.
+        ~WorldPartition();
+
+        WorldPartition(const WorldPartition&) = delete;
+        WorldPartition& operator=(const WorldPartition&) = delete;
+
+        // Reads the partition index from `directory`. Returns false if it is missing or invalid.
+        bool Open(const std::string& directory);
+        bool IsOpen() const { return m_CellSize > 0.0f; }
+
+        // Call once per frame before Scene::Update with the streaming focus (usually the camera position).
+        void Update(const glm::vec3& focusPosition);
+
+        Stats GetStats() const;
+        const Settings& GetSettings() const { return m_Settings; }
+        float GetCellSize() const { return m_CellSize; }
+
+        // Writes every GameObject of `scene` that has a TransformComponent (cameras, and objects
+        // SceneSerializer can't fully represent, excepted) into cells of `cellSize` by position, plus
+        // the index, to `directory`. The remaining objects are
+        // saved as the persistent scene (GetPersistentScenePath), which is what to load alongside the
+        // partition. `outBakedObjects` receives the objects now owned by cells, so the caller can
+        // remove them from `scene` instead of having them twice once the cells stream in.
+        static bool Bake(const Scene& scene, const AssetManager& assetManager, float cellSize, const std::string& directory,
+                         std::vector<EntityHandle>* outBakedObjects = nullptr);
+        static std::string GetPersistentScenePath(const std::string& directory);
+        // True if `directory` holds a baked partition (its index).
+        static bool Exists(const std::string& directory);
+
+    private:
+        struct CellCoord {
+            int32_t x = 0;
+            int32_t z = 0;
+        };
+
+        enum class CellState { Loading, Resident };
+
+        struct Cell {
+            CellCoord coord;
+            CellState state = CellState::Loading;
+            std::unique_ptr<SceneStreamLoader> loader; // Only while loading
+            std::vector<EntityHandle> objects;
+            std::vector<ModelHandle> models;          // References held while resident
+        };
+
+        static uint64_t PackCoord(const CellCoord& coord) {
+            return (static_cast<uint64_t>(static_cast<uint32_t>(coord.x)) << 32) | static_cast<uint32_t>(coord.z);
+        }
+        static std::string CellFileName(const CellCoord& coord);
+        // Distance on the XZ plane from `position` to the nearest point of the cell.
+        float DistanceToCell(const glm::vec3& position, const CellCoord& coord) const;
+
+        void RequestLoads(const glm::vec3& focusPosition);
+        void UnloadDistantCells(const glm::vec3& focusPosition);
+        void PumpLoaders();
+        void FreeRetiredLoaders();
+        void UnloadCell(Cell& cell);
+
+        Scene& m_Scene;
+        AssetManager& m_AssetManager;
+        PhysicsSystem* m_PhysicsSystem;
+        JobSystem& m_JobSystem;
+        Settings m_Settings;
+
+        std::string m_Directory;
+        float m_CellSize = 0.0f;
+        std::unordered_set<uint64_t> m_NonEmptyCells; // From the index; tiny compared to cell contents
+        // Cells that are loading or resident, keyed by PackCoord.
+        std::unordered_map<uint64_t, Cell> m_ActiveCells;
+        // Loaders of cells unloaded mid-load, kept until their background jobs finish so that
+        // destroying them doesn't block the frame.
+        std::vector<std::unique_ptr<SceneStreamLoader>> m_RetiredLoaders;
+
+        uint64_t m_CellsLoaded = 0;
+        uint64_t m_CellsUnloaded = 0;
+    };
+
+} // namespace VulkEng
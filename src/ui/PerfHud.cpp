@@ -0,0 +1,127 @@
+#include "PerfHud.h"
+#include "core/PerfCounters.h"
+
+#include <imgui.h>
+
+#include <algorithm> // For std::max, std::min
+#include <cfloat>    // For FLT_MAX
+#include <cinttypes> // For PRId64, PRIu64
+#include <cstdio>    // For std::snprintf
+
+namespace VulkEng {
+
+    namespace {
+        constexpr float FrameBudgetMs = 1000.0f / 60.0f;
+        constexpr float GraphHeight = 90.0f;
+    } // namespace
+
+    void PerfHud::Draw() {
+        if (!ImGui::Begin("Performance")) {
+            ImGui::End();
+            return;
+        }
+
+        // --- Frame Time ---
+        PerfCounters::FrameTimeSummary summary = PerfCounters::GetFrameTimeSummary();
+        ImGui::Text("Frame time (last %u frames): avg %.2f ms (%.1f FPS)", summary.frames, summary.averageMs,
+                    summary.averageMs > 0.0f ? 1000.0f / summary.averageMs : 0.0f);
+        ImGui::Text("p50 %.2f  p95 %.2f  p99 %.2f  max %.2f ms", summary.p50Ms, summary.p95Ms, summary.p99Ms, summary.maxMs);
+
+        PerfCounters::GetFrameTimes(m_FrameMs, m_FrameHitch);
+        // Scaled to the tail rather than the worst frame, so one hitch doesn't flatten the graph.
+        float scaleMs = std::max(summary.p99Ms * 1.25f, 2.0f * FrameBudgetMs);
+        DrawFrameGraph(scaleMs);
+
+        // Distribution over the same window, up to the graph's scale (slower frames land in the last bucket).
+        m_Distribution.fill(0.0f);
+        for (float ms : m_FrameMs) {
+            uint32_t bucket = static_cast<uint32_t>(ms / scaleMs * DistributionBuckets);
+            m_Distribution[std::min(bucket, DistributionBuckets - 1)] += 1.0f;
+        }
+        char overlay[64];
+        std::snprintf(overlay, sizeof(overlay), "0 - %.1f ms", scaleMs);
+        ImGui::PlotHistogram("##FrameTimeDistribution", m_Distribution.data(), static_cast<int>(DistributionBuckets), 0, overlay,
+                             0.0f, FLT_MAX, ImVec2(ImGui::GetContentRegionAvail().x, 50.0f));
+
+        std::vector<PerfCounters::Hitch> hitches = PerfCounters::GetRecentHitches();
+        if (ImGui::CollapsingHeader("Hitches")) {
+            if (hitches.empty()) ImGui::TextUnformatted("None so far.");
+            for (auto it = hitches.rbegin(); it != hitches.rend(); ++it) {
+                ImGui::Text("Frame %" PRIu64 ": %.2f ms (baseline %.2f ms)", it->frame, it->frameMs, it->baselineMs);
+            }
+        }
+
+        // --- Counters ---
+        if (ImGui::BeginTable("PerfCounters", 4, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV | ImGuiTableFlags_SizingStretchProp)) {
+            ImGui::TableSetupColumn("Counter");
+            ImGui::TableSetupColumn("Last");
+            ImGui::TableSetupColumn("Avg");
+            ImGui::TableSetupColumn("Peak");
+            ImGui::TableHeadersRow();
+            uint32_t counterCount = PerfCounters::GetCounterCount();
+            for (PerfCounterId id = 0; id < counterCount; ++id) {
+                PerfCounters::CounterSummary counter = PerfCounters::GetCounterSummary(id);
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn(); ImGui::TextUnformatted(PerfCounters::GetCounterName(id).c_str());
+                ImGui::TableNextColumn(); ImGui::Text("%" PRId64, counter.last);
+                ImGui::TableNextColumn(); ImGui::Text("%.1f", counter.average);
+                ImGui::TableNextColumn(); ImGui::Text("%" PRId64, counter.peak);
+            }
+            ImGui::EndTable();
+        }
+
+        // --- CSV Export ---
+        if (PerfCounters::IsCsvCapturing()) {
+            ImGui::Text("Capturing to %s: %" PRIu64 " frames", m_CsvPath, PerfCounters::GetCsvRowCount());
+            if (ImGui::Button("Stop CSV capture")) PerfCounters::StopCsvCapture();
+        } else {
+            ImGui::InputText("CSV path", m_CsvPath, sizeof(m_CsvPath));
+            if (ImGui::Button("Start CSV capture")) PerfCounters::StartCsvCapture(m_CsvPath);
+        }
+
+        ImGui::End();
+    }
+
+    void PerfHud::DrawFrameGraph(float scaleMs) {
+        ImVec2 origin = ImGui::GetCursorScreenPos();
+        float width = std::max(ImGui::GetContentRegionAvail().x, 1.0f);
+        ImGui::Dummy(ImVec2(width, GraphHeight)); // Reserves the area and lets the window size to it
+        ImDrawList* drawList = ImGui::GetWindowDrawList();
+        ImVec2 end(origin.x + width, origin.y + GraphHeight);
+        drawList->AddRectFilled(origin, end, IM_COL32(20, 20, 20, 200));
+
+        auto heightOf = [&](float ms) { return std::min(ms / scaleMs, 1.0f) * GraphHeight; };
+        size_t count = m_FrameMs.size();
+        if (count > 0) {
+            // Newest on the right; with more frames than pixels, each column shows its slowest frame.
+            float columnWidth = std::max(width / PerfCounters::HistoryFrames, 1.0f);
+            size_t columns = std::min(count, std::max(static_cast<size_t>(width / columnWidth), size_t(1)));
+            for (size_t column = 0; column < columns; ++column) {
+                size_t begin = count * column / columns;
+                size_t stop = count * (column + 1) / columns;
+                float ms = 0.0f;
+                bool hitch = false;
+                for (size_t frame = begin; frame < stop; ++frame) {
+                    ms = std::max(ms, m_FrameMs[frame]);
+                    hitch = hitch || m_FrameHitch[frame] != 0;
+                }
+                float x = end.x - (columns - column) * columnWidth;
+                ImU32 color = hitch ? IM_COL32(230, 60, 50, 255)
+                            : ms > FrameBudgetMs ? IM_COL32(230, 190, 50, 255) : IM_COL32(80, 200, 90, 255);
+                drawList->AddRectFilled(ImVec2(x, end.y - heightOf(ms)), ImVec2(x + columnWidth, end.y), color);
+                if (hitch) {
+                    drawList->AddTriangleFilled(ImVec2(x + columnWidth * 0.5f, origin.y + 6.0f), ImVec2(x + columnWidth * 0.5f - 4.0f, origin.y),
+                                                ImVec2(x + columnWidth * 0.5f + 4.0f, origin.y), IM_COL32(230, 60, 50, 255));
+                }
+            }
+        }
+
+        // Budget lines for 60 and 30 FPS.
+        for (float budget : {FrameBudgetMs, 2.0f * FrameBudgetMs}) {
+            if (budget >= scaleMs) continue;
+            float y = end.y - heightOf(budget);
+            drawList->AddLine(ImVec2(origin.x, y), ImVec2(end.x, y), IM_COL32(255, 255, 255, 90));
+        }
+    }
+
+} // namespace VulkEng
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace VulkEng {
+
+    // ImGui window over PerfCounters: frame-time percentiles, a rolling frame-time graph with hitch
+    // markers, the frame-time distribution, every registered counter and the CSV capture controls.
+    // Call Draw() while a UI frame is being built.
+    class PerfHud {
+    public:
+        static constexpr uint32_t DistributionBuckets = 48;
+
+        void Draw();
+
+    private:
+        // Bars of the last PerfCounters::HistoryFrames frames; hitches in red with a marker on top.
+        void DrawFrameGraph(float scaleMs);
+
+        // Reused between draws.
+        std::vector<float> m_FrameMs;
+        std::vector<uint8_t> m_FrameHitch;
+        std::array<float, DistributionBuckets> m_Distribution{};
+        char m_CsvPath[256] = "perf_capture.csv";
+    };
+
+} // namespace VulkEng
@@ -7,9 +7,12 @@
 // --- ImGui Backend Headers ---
 // These must be included after imgui.h (which is typically included by UIManager.h or directly here)
 #include <imgui.h> // Should be included by UIManager.h or here
+#include <imgui_internal.h> // For the pending input event queue
 #include <backends/imgui_impl_glfw.h>
 #include <backends/imgui_impl_vulkan.h>
 
+#include <cstring> // For memcmp, memcpy
+
 // For font upload (single time command)
 // #include "graphics/CommandManager.h" // Or use helpers from VulkanContext/Utils
 
@@ -56,6 +59,7 @@ namespace VulkEng {
             if (m_Context.device != VK_NULL_HANDLE) {
                 vkDeviceWaitIdle(m_Context.device);
             }
+            ReleaseFontUpload(true);
 
             // Check if ImGui context exists before shutdown.
             // ImGui::GetCurrentContext() returns nullptr if no context is active.
@@ -74,9 +78,8 @@ namespace VulkEng {
     void UIManager::InitImGui(Window& window, VulkanContext& context, VkRenderPass renderPass) {
         VKENG_INFO("UIManager: Initializing ImGui context and backends...");
 
-        // 1. Create ImGui Context & Setup IO
-        IMGUI_CHECKVERSION();
-        ImGui::CreateContext();
+        // 1. Create ImGui Context & Setup IO (unless startup already did, along with the font atlas)
+        BuildFontAtlas();
         ImGuiIO& io = ImGui::GetIO(); (void)io;
         io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard; // Enable Keyboard Controls
         //io.ConfigFlags |= ImGuiConfigFlags_NavEnableGamepad;      // Enable Gamepad Controls
@@ -134,35 +137,60 @@ namespace VulkEng {
 
 
         // 5. Upload Fonts
-        // This needs a command buffer. Use a utility function for single-time commands.
-        // Assuming VulkanContext has such helpers, or CommandManager does.
-        // For now, using VulkanContext's helpers with a temporary pool.
+        // Submitted on the graphics queue without waiting: the first frame is queued behind it,
+        // and BeginUIRender releases the staging objects once the timeline shows it finished.
         VKENG_INFO("UIManager: Uploading ImGui fonts...");
-        VkCommandPool tempCommandPool = VK_NULL_HANDLE; // Create a temporary pool for font upload
         VkCommandPoolCreateInfo poolInfo{VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO};
-        poolInfo.queueFamilyIndex = context.graphicsQueueFamily;
+        poolInfo.queueFamilyIndex = context.GetQueueFamily(QueueType::Graphics);
         poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT; // For short-lived command buffers
-        VK_CHECK(vkCreateCommandPool(context.device, &poolInfo, nullptr, &tempCommandPool));
-
-        VkCommandBuffer commandBuffer = Utils::BeginSingleTimeCommands(context.device, tempCommandPool);
-        if (commandBuffer != VK_NULL_HANDLE) {
-            if (!ImGui_ImplVulkan_CreateFontsTexture(commandBuffer)) {
-                Utils::EndSingleTimeCommands(context.device, tempCommandPool, context.graphicsQueue, commandBuffer);
-                vkDestroyCommandPool(context.device, tempCommandPool, nullptr);
-                throw std::runtime_error("Failed to create ImGui font textures!");
-            }
-            Utils::EndSingleTimeCommands(context.device, tempCommandPool, context.graphicsQueue, commandBuffer);
-            ImGui_ImplVulkan_DestroyFontUploadObjects(); // Clean up staging buffers used by ImGui
-            VKENG_INFO("UIManager: ImGui fonts uploaded and staging resources destroyed.");
-        } else {
-             vkDestroyCommandPool(context.device, tempCommandPool, nullptr);
-             throw std::runtime_error("Failed to begin single time command buffer for ImGui font upload.");
+        VK_CHECK(vkCreateCommandPool(context.device, &poolInfo, nullptr, &m_FontUploadPool));
+
+        VkCommandBuffer commandBuffer = Utils::BeginSingleTimeCommands(context.device, m_FontUploadPool);
+        if (commandBuffer == VK_NULL_HANDLE) {
+            vkDestroyCommandPool(context.device, m_FontUploadPool, nullptr);
+            m_FontUploadPool = VK_NULL_HANDLE;
+            throw std::runtime_error("Failed to begin single time command buffer for ImGui font upload.");
+        }
+        bool fontsRecorded = ImGui_ImplVulkan_CreateFontsTexture(commandBuffer);
+        VK_CHECK(vkEndCommandBuffer(commandBuffer));
+        if (!fontsRecorded) {
+            vkDestroyCommandPool(context.device, m_FontUploadPool, nullptr);
+            m_FontUploadPool = VK_NULL_HANDLE;
+            throw std::runtime_error("Failed to create ImGui font textures!");
         }
-        vkDestroyCommandPool(context.device, tempCommandPool, nullptr); // Destroy temporary pool
+        QueueSubmitDesc submit;
+        submit.commandBuffers = &commandBuffer;
+        submit.commandBufferCount = 1;
+        m_FontUploadDone = context.Submit(QueueType::Graphics, submit);
 
         VKENG_INFO("UIManager: ImGui fully initialized.");
     }
 
+    void UIManager::BuildFontAtlas() {
+        if (ImGui::GetCurrentContext() != nullptr) return; // Already built
+
+        IMGUI_CHECKVERSION();
+        ImGui::CreateContext();
+        ImGuiIO& io = ImGui::GetIO();
+        unsigned char* pixels = nullptr;
+        int width = 0, height = 0;
+        io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height); // Rasterizes and caches the atlas
+        VKENG_INFO("UIManager: ImGui font atlas built ({}x{}).", width, height);
+    }
+
+    void UIManager::ReleaseFontUpload(bool wait) {
+        if (m_FontUploadPool == VK_NULL_HANDLE) return;
+        if (wait) {
+            m_Context.WaitFor(m_FontUploadDone);
+        } else if (!m_Context.IsComplete(m_FontUploadDone)) {
+            return;
+        }
+        ImGui_ImplVulkan_DestroyFontUploadObjects(); // Clean up staging buffers used by ImGui
+        vkDestroyCommandPool(m_Context.device, m_FontUploadPool, nullptr); // Frees the upload command buffer
+        m_FontUploadPool = VK_NULL_HANDLE;
+        VKENG_INFO("UIManager: ImGui font upload finished; staging resources destroyed.");
+    }
+
     void UIManager::CreateImGuiVulkanResources(VulkanContext& context) {
         // Create a descriptor pool for ImGui's own needs.
         // Sizes copied from ImGui Vulkan example, adjust if needed.
@@ -203,12 +231,39 @@ namespace VulkEng {
         }
     }
 
-    void UIManager::BeginUIRender() {
-        if (!m_IsInitialized) return; // Do nothing if not initialized
+    bool UIManager::BeginUIRender() {
+        if (!m_IsInitialized) return false; // Do nothing if not initialized
+        ReleaseFontUpload(false);
         ImGui_ImplVulkan_NewFrame(); // Must be called before ImGui_ImplGlfw_NewFrame
-        ImGui_ImplGlfw_NewFrame();   // Handles input for ImGui
+        ImGui_ImplGlfw_NewFrame();   // Queues input events, updates display size and time
+        if (!ShouldBuildFrame()) return false;
         ImGui::NewFrame();           // Starts a new ImGui frame for UI definition
         m_FrameBegun = true;
+        m_LastBuildTime = std::chrono::steady_clock::now();
+        return true;
+    }
+
+    bool UIManager::ShouldBuildFrame() {
+        // ImGui needs a few frames after input to settle hover highlights, window sizes and focus.
+        constexpr uint32_t SettleFrameCount = 3;
+
+        if (m_UpdateMode == UIUpdateMode::Continuous) return true;
+        const ImGuiIO& io = ImGui::GetIO();
+        // Events queued by the GLFW callbacks and ImGui_ImplGlfw_NewFrame; duplicates are filtered there.
+        bool input = ImGui::GetCurrentContext()->InputEventsQueue.Size > 0;
+        // Held buttons drag without new events; active text fields blink their cursor.
+        input = input || ImGui::IsAnyMouseDown() || io.WantTextInput;
+        // ImGui_ImplGlfw_NewFrame picked up a window resize.
+        ImDrawData* lastDrawData = ImGui::GetDrawData();
+        input = input || !lastDrawData || lastDrawData->DisplaySize.x != io.DisplaySize.x || lastDrawData->DisplaySize.y != io.DisplaySize.y;
+        if (input) m_SettleFrames = SettleFrameCount;
+
+        bool refreshDue = m_RefreshInterval > 0.0f &&
+                          std::chrono::duration<float>(std::chrono::steady_clock::now() - m_LastBuildTime).count() >= m_RefreshInterval;
+        if (m_SettleFrames == 0 && !m_RefreshRequested && !refreshDue) return false;
+        if (m_SettleFrames > 0) --m_SettleFrames;
+        m_RefreshRequested = false;
+        return true;
     }
 
     void UIManager::EndUIRender() {
@@ -218,26 +273,68 @@ namespace VulkEng {
         }
         ImGui::Render(); // Finalizes ImGui's internal draw data list.
         m_FrameBegun = false;
+        // A rebuilt UI often tessellates to exactly the same geometry (nothing moved, same text).
+        if (DrawDataChanged()) m_LayerDirty = true;
+
+        // Update and Render additional Platform Windows (if ImGuiConfigFlags_ViewportsEnable is set).
+        // Needed after every ImGui::Render, whether or not the main layer is re-rendered.
+        ImGuiIO& io = ImGui::GetIO();
+        if (io.ConfigFlags & ImGuiConfigFlags_ViewportsEnable) {
+            ImGui::UpdatePlatformWindows();
+            ImGui::RenderPlatformWindowsDefault(); // This uses its own Vulkan contexts for other windows
+        }
+    }
+
+    bool UIManager::DrawDataChanged() {
+        ImDrawData* drawData = ImGui::GetDrawData();
+        if (!drawData) return false;
+
+        // Compares and refreshes the snapshot in one pass; once a difference is found the rest is copied.
+        size_t cursor = 0;
+        bool changed = false;
+        auto compare = [&](const void* data, size_t size) {
+            if (size == 0) return;
+            if (!changed && cursor + size <= m_DrawSnapshot.size() && std::memcmp(m_DrawSnapshot.data() + cursor, data, size) == 0) {
+                cursor += size;
+                return;
+            }
+            changed = true;
+            if (m_DrawSnapshot.size() < cursor + size) m_DrawSnapshot.resize(cursor + size);
+            std::memcpy(m_DrawSnapshot.data() + cursor, data, size);
+            cursor += size;
+        };
+
+        compare(&drawData->DisplayPos, sizeof(drawData->DisplayPos));
+        compare(&drawData->DisplaySize, sizeof(drawData->DisplaySize));
+        compare(&drawData->FramebufferScale, sizeof(drawData->FramebufferScale));
+        compare(&drawData->CmdListsCount, sizeof(drawData->CmdListsCount));
+        for (int i = 0; i < drawData->CmdListsCount; ++i) {
+            const ImDrawList* list = drawData->CmdLists[i];
+            // ImDrawCmd is zero-initialized, so its padding compares equal too.
+            int counts[3] = {list->CmdBuffer.Size, list->VtxBuffer.Size, list->IdxBuffer.Size};
+            compare(counts, sizeof(counts));
+            compare(list->CmdBuffer.Data, list->CmdBuffer.Size * sizeof(ImDrawCmd));
+            compare(list->VtxBuffer.Data, list->VtxBuffer.Size * sizeof(ImDrawVert));
+            compare(list->IdxBuffer.Data, list->IdxBuffer.Size * sizeof(ImDrawIdx));
+        }
+        changed = changed || cursor != m_DrawSnapshot.size();
+        m_DrawSnapshot.resize(cursor); // Keeps its capacity
+        return changed;
     }
 
     void UIManager::RenderDrawData(VkCommandBuffer commandBuffer) {
         if (!m_IsInitialized) return;
+        m_LayerDirty = false;
 
         ImDrawData* draw_data = ImGui::GetDrawData();
         // Check if draw_data is valid and has commands
         if (!draw_data || draw_data->CmdListsCount == 0) {
-            return; // Nothing to render
+            return; // Nothing to render; the layer pass cleared it
         }
 
-        // Record ImGui draw commands into the provided command buffer.
+        // Record ImGui draw commands into the provided command buffer. The backend streams the
+        // vertices and indices through its own per-frame buffers, only on frames that redraw.
         ImGui_ImplVulkan_RenderDrawData(draw_data, commandBuffer);
-
-        // Update and Render additional Platform Windows (if ImGuiConfigFlags_ViewportsEnable is set)
-        ImGuiIO& io = ImGui::GetIO();
-        if (io.ConfigFlags & ImGuiConfigFlags_ViewportsEnable) {
-            ImGui::UpdatePlatformWindows();
-            ImGui::RenderPlatformWindowsDefault(); // This uses its own Vulkan contexts for other windows
-        }
     }
 
 } // namespace VulkEng
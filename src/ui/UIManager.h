@@ -1,6 +1,11 @@
 #pragma once
 
 #include <vulkan/vulkan.h> // For VkCommandBuffer, VkRenderPass, VkDescriptorPool
+#include "graphics/VulkanContext.h" // For GpuTimelinePoint (pending font upload)
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
 
 // Forward declare ImGui types if not including imgui.h here (though it's often included)
 // struct ImDrawData; // Included by imgui_impl_vulkan.h which UIManager.cpp will include
@@ -11,13 +16,21 @@ namespace VulkEng {
     class Window;
     class VulkanContext;
 
+    // When the UI is rebuilt (ImGui::NewFrame through ImGui::Render).
+    enum class UIUpdateMode {
+        Continuous, // Every frame
+        OnInput,    // After input, on RequestRefresh(), and at the refresh interval (for live values)
+    };
+
     // Manages the ImGui user interface integration with Vulkan and GLFW.
+    // The UI is rendered into its own layer, which the renderer composites over the scene every
+    // frame but only re-renders when the draw data actually changed.
     class UIManager {
     public:
         // Constructor:
         // - window: Reference to the application's main window (for GLFW backend).
         // - context: Reference to the Vulkan context (for Vulkan backend).
-        // - renderPass: The main render pass into which ImGui will render. ImGui's pipeline
+        // - renderPass: The UI layer render pass into which ImGui will render. ImGui's pipeline
         //               must be compatible with this render pass.
         // - skipInit: Flag for dummy/null object construction.
         UIManager(Window& window, VulkanContext& context, VkRenderPass renderPass, bool skipInit = false);
@@ -28,25 +41,41 @@ namespace VulkEng {
         UIManager(const UIManager&) = delete;
         UIManager& operator=(const UIManager&) = delete;
 
+        // Creates the ImGui context and rasterizes the font atlas. Needs neither Vulkan nor GLFW,
+        // so startup runs it on a worker while the device is created; the constructor does it
+        // otherwise. Must not run concurrently with other ImGui calls.
+        static void BuildFontAtlas();
+
 
         // --- ImGui Frame Management (called from Application's main loop) ---
 
-        // Begins a new ImGui frame. Call this after polling events and before building UI.
-        // This calls ImGui_ImplVulkan_NewFrame, ImGui_ImplGlfw_NewFrame, and ImGui::NewFrame.
-        virtual void BeginUIRender();
+        // Begins a new ImGui frame if the update mode calls for one. Call this after polling events;
+        // only when it returns true, build the UI and call EndUIRender. Otherwise the last frame's
+        // draw data (and the layer rendered from it) stays on screen.
+        virtual bool BeginUIRender();
 
         // Ends the current ImGui frame. Call this after all ImGui UI elements have been defined.
-        // This primarily calls ImGui::Render() to finalize ImGui's internal draw data.
+        // This calls ImGui::Render() and compares the new draw data with the last rendered one.
         // The actual Vulkan draw commands are recorded by RenderDrawData.
         virtual void EndUIRender();
 
+        void SetUpdateMode(UIUpdateMode mode) { m_UpdateMode = mode; }
+        UIUpdateMode GetUpdateMode() const { return m_UpdateMode; }
+        // How often OnInput rebuilds the UI without input; 0 rebuilds only on input and requests.
+        void SetRefreshInterval(float seconds) { m_RefreshInterval = seconds; }
+        // Rebuilds the UI on the next BeginUIRender regardless of the update mode.
+        void RequestRefresh() { m_RefreshRequested = true; }
+
+        // True when the draw data differs from what the UI layer was last rendered from.
+        virtual bool IsLayerDirty() const { return m_LayerDirty; }
+
 
         // --- Vulkan Draw Command Recording ---
 
-        // Records ImGui's draw commands into the provided Vulkan command buffer.
-        // This should be called by the Renderer within its main render pass,
-        // after scene objects have been drawn but before the render pass ends.
-        // `commandBuffer` is the active primary command buffer for the current frame.
+        // Records ImGui's draw commands into the provided Vulkan command buffer and marks the layer
+        // clean. The Renderer calls this inside its UI layer render pass, which it only begins when
+        // the layer is dirty (or lost its contents). `commandBuffer` is the active primary command
+        // buffer for the current frame.
         virtual void RenderDrawData(VkCommandBuffer commandBuffer);
 
 
@@ -55,6 +84,12 @@ namespace VulkEng {
         void InitImGui(Window& window, VulkanContext& context, VkRenderPass renderPass);
         void CreateImGuiVulkanResources(VulkanContext& context); // Renamed from CreateImGuiResources
         void DestroyImGuiVulkanResources(); // Renamed
+        // Frees the font upload's staging objects once the GPU has consumed them (`wait`: block for it).
+        void ReleaseFontUpload(bool wait);
+        // Whether BeginUIRender should build a frame under the current update mode.
+        bool ShouldBuildFrame();
+        // Compares the current draw data with the snapshot of the last one, updating the snapshot.
+        bool DrawDataChanged();
 
         // --- Member Variables ---
         VulkanContext& m_Context; // Store a reference to the Vulkan context
@@ -62,6 +97,24 @@ namespace VulkEng {
         // Vulkan resources owned by ImGui's Vulkan backend (or managed by us for it)
         VkDescriptorPool m_ImGuiDescriptorPool = VK_NULL_HANDLE; // Dedicated pool for ImGui's descriptor sets
 
+        // The font texture upload is submitted without waiting; frames on the same queue are ordered
+        // after it, and its staging objects are released once it completes.
+        VkCommandPool m_FontUploadPool = VK_NULL_HANDLE;
+        GpuTimelinePoint m_FontUploadDone;
+
+        // --- Retained UI ---
+#ifdef NDEBUG
+        UIUpdateMode m_UpdateMode = UIUpdateMode::OnInput; // Production overlays are mostly static
+#else
+        UIUpdateMode m_UpdateMode = UIUpdateMode::Continuous;
+#endif
+        float m_RefreshInterval = 0.25f;
+        bool m_RefreshRequested = true;
+        uint32_t m_SettleFrames = 0; // Frames still built after the last input, for hover and layout to catch up
+        std::chrono::steady_clock::time_point m_LastBuildTime;
+        std::vector<uint8_t> m_DrawSnapshot; // Draw data the layer was last rendered from, compared bytewise
+        bool m_LayerDirty = true;
+
         bool m_FrameBegun = false; // Tracks if ImGui::NewFrame has been called without a corresponding ImGui::Render
         bool m_IsInitialized = false; // Tracks if InitImGui was successful (or skipped)
     };